@@ -0,0 +1,176 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_DEVSTONE_ATOMIC_HPP
+#define CADMIUM_DEVSTONE_ATOMIC_HPP
+
+#include <atomic>
+#include <limits>
+#include <cstdint>
+#include <ostream>
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+
+namespace cadmium {
+    namespace benchmark {
+
+        /**
+         * @brief The ports of the DEVStone models, the atomic models have in and out, the coupled models in1,
+         * in2, out1 and out2.
+         */
+        struct devstone_defs {
+            struct in : public cadmium::in_port<int> {};
+            struct out : public cadmium::out_port<int> {};
+
+            struct in1 : public cadmium::in_port<int> {};
+            struct in2 : public cadmium::in_port<int> {};
+            struct out1 : public cadmium::out_port<int> {};
+            struct out2 : public cadmium::out_port<int> {};
+        };
+
+        /**
+         * @brief The transition workload of the DEVStone atomic models and the transitions count, shared by
+         * all of them.
+         */
+        struct devstone_workload {
+            static inline std::size_t internal_cycles = 0;
+            static inline std::size_t external_cycles = 0;
+
+            static inline std::atomic<std::uint64_t> internal_transitions{0};
+            static inline std::atomic<std::uint64_t> external_transitions{0};
+
+            // a synthetic computation the compiler cannot remove
+            static void work(std::size_t cycles) {
+                volatile std::uint64_t acc = 0;
+                for (std::size_t i = 0; i < cycles; i++) {
+                    acc = acc * 31 + i;
+                }
+            }
+
+            static void reset() {
+                internal_transitions.store(0);
+                external_transitions.store(0);
+            }
+
+            static std::uint64_t events() {
+                return internal_transitions.load() + external_transitions.load();
+            }
+        };
+
+        struct devstone_state {
+            bool pending = false;
+        };
+
+        inline std::ostream& operator<<(std::ostream& os, const devstone_state& s) {
+            return os << (s.pending ? "pending" : "passive");
+        }
+
+        /**
+         * @brief The DEVStone atomic model, it outputs one message right after receiving messages.
+         *
+         * - external: external_cycles of work, becomes pending.
+         * - output: one message in out.
+         * - internal: internal_cycles of work, becomes passive.
+         *
+         * @tparam ID - Makes the atomic models of a static coupled model distinct types.
+         */
+        template<typename TIME, int ID = 0>
+        class devstone_atomic {
+        public:
+            using input_ports = std::tuple<devstone_defs::in>;
+            using output_ports = std::tuple<devstone_defs::out>;
+
+            using state_type = devstone_state;
+            state_type state;
+
+            void internal_transition() {
+                devstone_workload::work(devstone_workload::internal_cycles);
+                devstone_workload::internal_transitions.fetch_add(1, std::memory_order_relaxed);
+                state.pending = false;
+            }
+
+            void external_transition(TIME, typename make_message_bags<input_ports>::type) {
+                devstone_workload::work(devstone_workload::external_cycles);
+                devstone_workload::external_transitions.fetch_add(1, std::memory_order_relaxed);
+                state.pending = true;
+            }
+
+            void confluence_transition(TIME e, typename make_message_bags<input_ports>::type mbs) {
+                internal_transition();
+                external_transition(e, std::move(mbs));
+            }
+
+            typename make_message_bags<output_ports>::type output() const {
+                typename make_message_bags<output_ports>::type bags;
+                get_messages<devstone_defs::out>(bags).emplace_back(ID);
+                return bags;
+            }
+
+            TIME time_advance() const {
+                return state.pending ? TIME{} : std::numeric_limits<TIME>::infinity();
+            }
+        };
+
+        template<typename TIME>
+        using devstone_dynamic_atomic = devstone_atomic<TIME>;
+
+        /**
+         * @brief Outputs one message at the start of the simulation, the input of the DEVStone model.
+         */
+        template<typename TIME>
+        class devstone_seed {
+        public:
+            using input_ports = std::tuple<>;
+            using output_ports = std::tuple<devstone_defs::out>;
+
+            using state_type = devstone_state;
+            state_type state{true};
+
+            void internal_transition() {
+                state.pending = false;
+            }
+
+            void external_transition(TIME, typename make_message_bags<input_ports>::type) {}
+
+            void confluence_transition(TIME, typename make_message_bags<input_ports>::type) {
+                internal_transition();
+            }
+
+            typename make_message_bags<output_ports>::type output() const {
+                typename make_message_bags<output_ports>::type bags;
+                get_messages<devstone_defs::out>(bags).emplace_back(0);
+                return bags;
+            }
+
+            TIME time_advance() const {
+                return state.pending ? TIME{} : std::numeric_limits<TIME>::infinity();
+            }
+        };
+    }
+}
+
+#endif // CADMIUM_DEVSTONE_ATOMIC_HPP
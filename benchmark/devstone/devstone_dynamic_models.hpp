@@ -0,0 +1,185 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_DEVSTONE_DYNAMIC_MODELS_HPP
+#define CADMIUM_DEVSTONE_DYNAMIC_MODELS_HPP
+
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_atomic.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include "devstone_atomic.hpp"
+
+/**
+ * The DEVStone models for the dynamic engine, built at runtime with the same couplings than the static ones
+ * in devstone_static_models.hpp.
+ */
+
+namespace cadmium {
+    namespace benchmark {
+
+        enum class devstone_type { li, hi, ho, homod };
+
+        inline devstone_type devstone_type_of(const std::string& name) {
+            if (name == "LI") return devstone_type::li;
+            if (name == "HI") return devstone_type::hi;
+            if (name == "HO") return devstone_type::ho;
+            if (name == "HOmod") return devstone_type::homod;
+            throw std::domain_error("Unknown DEVStone type " + name + ", expected LI, HI, HO or HOmod");
+        }
+
+        inline bool has_two_inputs(devstone_type type) {
+            return type == devstone_type::ho || type == devstone_type::homod;
+        }
+
+        template<typename TIME>
+        class devstone_dynamic_builder {
+            using defs = devstone_defs;
+
+            devstone_type _type;
+            int _width;
+
+            static std::shared_ptr<cadmium::dynamic::modeling::model> atomic(const std::string& id) {
+                return cadmium::dynamic::translate::make_dynamic_atomic_model<devstone_dynamic_atomic, TIME>(id);
+            }
+
+            static std::string atomic_id(int depth, int i) {
+                return "A_" + std::to_string(depth) + "_" + std::to_string(i);
+            }
+
+            std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> level(int depth) const {
+                namespace translate = cadmium::dynamic::translate;
+                bool two_inputs = has_two_inputs(_type);
+                std::string id = "C_" + std::to_string(depth);
+
+                cadmium::dynamic::modeling::Ports iports = two_inputs ?
+                        cadmium::dynamic::modeling::create_dynamic_ports<std::tuple<defs::in1, defs::in2>>() :
+                        cadmium::dynamic::modeling::create_dynamic_ports<std::tuple<defs::in1>>();
+                cadmium::dynamic::modeling::Ports oports = _type == devstone_type::ho ?
+                        cadmium::dynamic::modeling::create_dynamic_ports<std::tuple<defs::out1, defs::out2>>() :
+                        cadmium::dynamic::modeling::create_dynamic_ports<std::tuple<defs::out1>>();
+
+                cadmium::dynamic::modeling::Models models;
+                cadmium::dynamic::modeling::EICs eics;
+                cadmium::dynamic::modeling::EOCs eocs;
+                cadmium::dynamic::modeling::ICs ics;
+
+                if (depth == 1) {
+                    std::string a = atomic_id(depth, 0);
+                    models.push_back(atomic(a));
+                    eics.push_back(translate::make_EIC<defs::in1, defs::in>(a));
+                    eocs.push_back(translate::make_EOC<defs::out, defs::out1>(a));
+                    if (two_inputs) {
+                        eics.push_back(translate::make_EIC<defs::in2, defs::in>(a));
+                    }
+                    if (_type == devstone_type::ho) {
+                        eocs.push_back(translate::make_EOC<defs::out, defs::out2>(a));
+                    }
+                    return std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(id, models, iports, oports, eics, eocs, ics);
+                }
+
+                auto inner = level(depth - 1);
+                std::string inner_id = inner->get_id();
+                models.push_back(inner);
+                eics.push_back(translate::make_EIC<defs::in1, defs::in1>(inner_id));
+                eocs.push_back(translate::make_EOC<defs::out1, defs::out1>(inner_id));
+
+                for (int i = 1; i < _width; i++) {
+                    std::string a = atomic_id(depth, i);
+                    models.push_back(atomic(a));
+                    switch (_type) {
+                        case devstone_type::li:
+                            eics.push_back(translate::make_EIC<defs::in1, defs::in>(a));
+                            break;
+                        case devstone_type::hi:
+                            eics.push_back(translate::make_EIC<defs::in1, defs::in>(a));
+                            if (i + 1 < _width) {
+                                ics.push_back(translate::make_IC<defs::out, defs::in>(a, atomic_id(depth, i + 1)));
+                            }
+                            break;
+                        case devstone_type::ho:
+                            eics.push_back(translate::make_EIC<defs::in2, defs::in>(a));
+                            eocs.push_back(translate::make_EOC<defs::out, defs::out2>(a));
+                            if (i + 1 < _width) {
+                                ics.push_back(translate::make_IC<defs::out, defs::in>(a, atomic_id(depth, i + 1)));
+                            }
+                            break;
+                        case devstone_type::homod: {
+                            std::string b = atomic_id(depth, i + _width - 1);
+                            models.push_back(atomic(b));
+                            eics.push_back(translate::make_EIC<defs::in2, defs::in>(a));
+                            ics.push_back(translate::make_IC<defs::out, defs::in2>(a, inner_id));
+                            ics.push_back(translate::make_IC<defs::out, defs::in>(a, b));
+                            ics.push_back(translate::make_IC<defs::out, defs::in2>(b, inner_id));
+                            break;
+                        }
+                    }
+                }
+                if (_type == devstone_type::ho) {
+                    eics.push_back(translate::make_EIC<defs::in2, defs::in2>(inner_id));
+                    eocs.push_back(translate::make_EOC<defs::out2, defs::out2>(inner_id));
+                }
+                return std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(id, models, iports, oports, eics, eocs, ics);
+            }
+
+        public:
+            devstone_dynamic_builder(devstone_type type, int width)
+            : _type(type), _width(width) {
+                if (width < 1) {
+                    throw std::domain_error("The DEVStone width must be positive");
+                }
+            }
+
+            /**
+             * @return the model run by the benchmark, the seed sending one message to the inputs of the DEVStone
+             * model of depth levels.
+             */
+            std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> top(int depth) const {
+                namespace translate = cadmium::dynamic::translate;
+                if (depth < 1) {
+                    throw std::domain_error("The DEVStone depth must be positive");
+                }
+                auto devstone = level(depth);
+                auto seed = cadmium::dynamic::translate::make_dynamic_atomic_model<devstone_seed, TIME>("seed");
+
+                cadmium::dynamic::modeling::ICs ics;
+                ics.push_back(translate::make_IC<devstone_defs::out, devstone_defs::in1>("seed", devstone->get_id()));
+                if (has_two_inputs(_type)) {
+                    ics.push_back(translate::make_IC<devstone_defs::out, devstone_defs::in2>("seed", devstone->get_id()));
+                }
+                return std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
+                        "top", cadmium::dynamic::modeling::Models{seed, devstone},
+                        cadmium::dynamic::modeling::Ports{}, cadmium::dynamic::modeling::Ports{},
+                        cadmium::dynamic::modeling::EICs{}, cadmium::dynamic::modeling::EOCs{}, ics);
+            }
+        };
+    }
+}
+
+#endif // CADMIUM_DEVSTONE_DYNAMIC_MODELS_HPP
@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_DEVSTONE_REPORT_HPP
+#define CADMIUM_DEVSTONE_REPORT_HPP
+
+#include <chrono>
+#include <string>
+#include <ostream>
+#include <sys/resource.h>
+#include "devstone_atomic.hpp"
+
+namespace cadmium {
+    namespace benchmark {
+
+        /**
+         * @return the peak resident set size of the process in kilobytes.
+         */
+        inline long peak_rss_kb() {
+            rusage usage;
+            getrusage(RUSAGE_SELF, &usage);
+            return usage.ru_maxrss;
+        }
+
+        struct devstone_run {
+            std::string engine;
+            std::string type;
+            int depth;
+            int width;
+            double build_seconds;
+            double run_seconds;
+        };
+
+        /**
+         * @brief Prints a run in a single line of key=value fields, easy to collect by scripts.
+         */
+        inline void report(std::ostream& os, const devstone_run& run) {
+            std::uint64_t events = devstone_workload::events();
+            os << "engine=" << run.engine
+               << " model=" << run.type
+               << " depth=" << run.depth
+               << " width=" << run.width
+               << " internal_cycles=" << devstone_workload::internal_cycles
+               << " external_cycles=" << devstone_workload::external_cycles
+               << " events=" << events
+               << " build_s=" << run.build_seconds
+               << " run_s=" << run.run_seconds
+               << " events_per_s=" << (run.run_seconds > 0 ? events / run.run_seconds : 0)
+               << " peak_rss_kb=" << peak_rss_kb()
+               << std::endl;
+        }
+
+        inline double seconds_since(std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+}
+
+#endif // CADMIUM_DEVSTONE_REPORT_HPP
@@ -0,0 +1,219 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_DEVSTONE_STATIC_MODELS_HPP
+#define CADMIUM_DEVSTONE_STATIC_MODELS_HPP
+
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <cadmium/modeling/coupled_model.hpp>
+#include "devstone_atomic.hpp"
+
+/**
+ * The DEVStone models for the static engine, the depth and width are template parameters.
+ *
+ * Each level of depth d > 1 is a coupled model with the level d - 1 and WIDTH - 1 atomic models, the level 1
+ * has a single atomic model. The levels differ in the couplings, see devstone_dynamic_models.hpp for the same
+ * models built at runtime. The levels are classes instead of aliases of coupled_model, the names of the types
+ * nesting them grow with the depth only.
+ */
+
+namespace cadmium {
+    namespace benchmark {
+
+        template<int ID>
+        struct devstone_atomic_at {
+            template<typename TIME>
+            using type = devstone_atomic<TIME, ID>;
+        };
+
+        template<typename... TUPLES>
+        using tuple_cat_t = decltype(std::tuple_cat(std::declval<TUPLES>()...));
+
+        /**
+         * LI: the input goes to the lower level and to all the atomic models, only the lower level output
+         * goes out.
+         */
+        template<int DEPTH, int WIDTH, typename = std::make_integer_sequence<int, WIDTH - 1>>
+        struct static_li;
+
+        template<int WIDTH, int... Is>
+        struct static_li<1, WIDTH, std::integer_sequence<int, Is...>> {
+            template<typename TIME>
+            struct type : cadmium::modeling::coupled_model<TIME,
+                    std::tuple<devstone_defs::in1>, std::tuple<devstone_defs::out1>,
+                    cadmium::modeling::models_tuple<devstone_atomic_at<0>::template type>,
+                    std::tuple<cadmium::modeling::EIC<devstone_defs::in1, devstone_atomic_at<0>::template type, devstone_defs::in>>,
+                    std::tuple<cadmium::modeling::EOC<devstone_atomic_at<0>::template type, devstone_defs::out, devstone_defs::out1>>,
+                    std::tuple<>> {};
+        };
+
+        template<int DEPTH, int WIDTH, int... Is>
+        struct static_li<DEPTH, WIDTH, std::integer_sequence<int, Is...>> {
+            using inner = static_li<DEPTH - 1, WIDTH>;
+
+            template<typename TIME>
+            struct type : cadmium::modeling::coupled_model<TIME,
+                    std::tuple<devstone_defs::in1>, std::tuple<devstone_defs::out1>,
+                    cadmium::modeling::models_tuple<inner::template type, devstone_atomic_at<Is + 1>::template type...>,
+                    std::tuple<
+                            cadmium::modeling::EIC<devstone_defs::in1, inner::template type, devstone_defs::in1>,
+                            cadmium::modeling::EIC<devstone_defs::in1, devstone_atomic_at<Is + 1>::template type, devstone_defs::in>...>,
+                    std::tuple<cadmium::modeling::EOC<inner::template type, devstone_defs::out1, devstone_defs::out1>>,
+                    std::tuple<>> {};
+        };
+
+        /**
+         * HI: LI with each atomic model also sending its output to the next one.
+         */
+        template<int DEPTH, int WIDTH, typename = std::make_integer_sequence<int, WIDTH - 1>>
+        struct static_hi;
+
+        template<int WIDTH, int... Is>
+        struct static_hi<1, WIDTH, std::integer_sequence<int, Is...>> : static_li<1, WIDTH> {};
+
+        template<int DEPTH, int WIDTH, int... Is>
+        struct static_hi<DEPTH, WIDTH, std::integer_sequence<int, Is...>> {
+            using inner = static_hi<DEPTH - 1, WIDTH>;
+
+            template<typename TIME>
+            struct type : cadmium::modeling::coupled_model<TIME,
+                    std::tuple<devstone_defs::in1>, std::tuple<devstone_defs::out1>,
+                    cadmium::modeling::models_tuple<inner::template type, devstone_atomic_at<Is + 1>::template type...>,
+                    std::tuple<
+                            cadmium::modeling::EIC<devstone_defs::in1, inner::template type, devstone_defs::in1>,
+                            cadmium::modeling::EIC<devstone_defs::in1, devstone_atomic_at<Is + 1>::template type, devstone_defs::in>...>,
+                    std::tuple<cadmium::modeling::EOC<inner::template type, devstone_defs::out1, devstone_defs::out1>>,
+                    tuple_cat_t<std::conditional_t<(Is + 2 < WIDTH),
+                            std::tuple<cadmium::modeling::IC<devstone_atomic_at<Is + 1>::template type, devstone_defs::out, devstone_atomic_at<Is + 2>::template type, devstone_defs::in>>,
+                            std::tuple<>>...>> {};
+        };
+
+        /**
+         * HO: HI with two inputs and two outputs, in1 only goes to the lower level, in2 goes to the lower level
+         * and to the atomic models, which output to out2.
+         */
+        template<int DEPTH, int WIDTH, typename = std::make_integer_sequence<int, WIDTH - 1>>
+        struct static_ho;
+
+        template<int WIDTH, int... Is>
+        struct static_ho<1, WIDTH, std::integer_sequence<int, Is...>> {
+            template<typename TIME>
+            struct type : cadmium::modeling::coupled_model<TIME,
+                    std::tuple<devstone_defs::in1, devstone_defs::in2>, std::tuple<devstone_defs::out1, devstone_defs::out2>,
+                    cadmium::modeling::models_tuple<devstone_atomic_at<0>::template type>,
+                    std::tuple<
+                            cadmium::modeling::EIC<devstone_defs::in1, devstone_atomic_at<0>::template type, devstone_defs::in>,
+                            cadmium::modeling::EIC<devstone_defs::in2, devstone_atomic_at<0>::template type, devstone_defs::in>>,
+                    std::tuple<
+                            cadmium::modeling::EOC<devstone_atomic_at<0>::template type, devstone_defs::out, devstone_defs::out1>,
+                            cadmium::modeling::EOC<devstone_atomic_at<0>::template type, devstone_defs::out, devstone_defs::out2>>,
+                    std::tuple<>> {};
+        };
+
+        template<int DEPTH, int WIDTH, int... Is>
+        struct static_ho<DEPTH, WIDTH, std::integer_sequence<int, Is...>> {
+            using inner = static_ho<DEPTH - 1, WIDTH>;
+
+            template<typename TIME>
+            struct type : cadmium::modeling::coupled_model<TIME,
+                    std::tuple<devstone_defs::in1, devstone_defs::in2>, std::tuple<devstone_defs::out1, devstone_defs::out2>,
+                    cadmium::modeling::models_tuple<inner::template type, devstone_atomic_at<Is + 1>::template type...>,
+                    std::tuple<
+                            cadmium::modeling::EIC<devstone_defs::in1, inner::template type, devstone_defs::in1>,
+                            cadmium::modeling::EIC<devstone_defs::in2, inner::template type, devstone_defs::in2>,
+                            cadmium::modeling::EIC<devstone_defs::in2, devstone_atomic_at<Is + 1>::template type, devstone_defs::in>...>,
+                    std::tuple<
+                            cadmium::modeling::EOC<inner::template type, devstone_defs::out1, devstone_defs::out1>,
+                            cadmium::modeling::EOC<inner::template type, devstone_defs::out2, devstone_defs::out2>,
+                            cadmium::modeling::EOC<devstone_atomic_at<Is + 1>::template type, devstone_defs::out, devstone_defs::out2>...>,
+                    tuple_cat_t<std::conditional_t<(Is + 2 < WIDTH),
+                            std::tuple<cadmium::modeling::IC<devstone_atomic_at<Is + 1>::template type, devstone_defs::out, devstone_atomic_at<Is + 2>::template type, devstone_defs::in>>,
+                            std::tuple<>>...>> {};
+        };
+
+        /**
+         * HOmod: in2 goes to a first row of atomic models, each one sends its output to the lower level in2 and
+         * to the atomic model below it in a second row, which also sends its output to the lower level in2.
+         * Only the lower level out1 goes out.
+         */
+        template<int DEPTH, int WIDTH, typename = std::make_integer_sequence<int, WIDTH - 1>>
+        struct static_homod;
+
+        template<int WIDTH, int... Is>
+        struct static_homod<1, WIDTH, std::integer_sequence<int, Is...>> {
+            template<typename TIME>
+            struct type : cadmium::modeling::coupled_model<TIME,
+                    std::tuple<devstone_defs::in1, devstone_defs::in2>, std::tuple<devstone_defs::out1>,
+                    cadmium::modeling::models_tuple<devstone_atomic_at<0>::template type>,
+                    std::tuple<
+                            cadmium::modeling::EIC<devstone_defs::in1, devstone_atomic_at<0>::template type, devstone_defs::in>,
+                            cadmium::modeling::EIC<devstone_defs::in2, devstone_atomic_at<0>::template type, devstone_defs::in>>,
+                    std::tuple<cadmium::modeling::EOC<devstone_atomic_at<0>::template type, devstone_defs::out, devstone_defs::out1>>,
+                    std::tuple<>> {};
+        };
+
+        template<int DEPTH, int WIDTH, int... Is>
+        struct static_homod<DEPTH, WIDTH, std::integer_sequence<int, Is...>> {
+            using inner = static_homod<DEPTH - 1, WIDTH>;
+
+            template<typename TIME>
+            struct type : cadmium::modeling::coupled_model<TIME,
+                    std::tuple<devstone_defs::in1, devstone_defs::in2>, std::tuple<devstone_defs::out1>,
+                    cadmium::modeling::models_tuple<inner::template type, devstone_atomic_at<Is + 1>::template type..., devstone_atomic_at<Is + WIDTH>::template type...>,
+                    std::tuple<
+                            cadmium::modeling::EIC<devstone_defs::in1, inner::template type, devstone_defs::in1>,
+                            cadmium::modeling::EIC<devstone_defs::in2, devstone_atomic_at<Is + 1>::template type, devstone_defs::in>...>,
+                    std::tuple<cadmium::modeling::EOC<inner::template type, devstone_defs::out1, devstone_defs::out1>>,
+                    std::tuple<
+                            cadmium::modeling::IC<devstone_atomic_at<Is + 1>::template type, devstone_defs::out, inner::template type, devstone_defs::in2>...,
+                            cadmium::modeling::IC<devstone_atomic_at<Is + 1>::template type, devstone_defs::out, devstone_atomic_at<Is + WIDTH>::template type, devstone_defs::in>...,
+                            cadmium::modeling::IC<devstone_atomic_at<Is + WIDTH>::template type, devstone_defs::out, inner::template type, devstone_defs::in2>...>> {};
+        };
+
+        /**
+         * @brief The model run by the benchmark, the seed sending one message to the inputs of the DEVStone
+         * model, in1 and in2 if TWO_INPUTS.
+         */
+        template<template<typename> class DEVSTONE, bool TWO_INPUTS>
+        struct static_devstone_top {
+            template<typename TIME>
+            struct type : cadmium::modeling::coupled_model<TIME,
+                    std::tuple<>, std::tuple<>,
+                    cadmium::modeling::models_tuple<devstone_seed, DEVSTONE>,
+                    std::tuple<>, std::tuple<>,
+                    std::conditional_t<TWO_INPUTS,
+                            std::tuple<
+                                    cadmium::modeling::IC<devstone_seed, devstone_defs::out, DEVSTONE, devstone_defs::in1>,
+                                    cadmium::modeling::IC<devstone_seed, devstone_defs::out, DEVSTONE, devstone_defs::in2>>,
+                            std::tuple<cadmium::modeling::IC<devstone_seed, devstone_defs::out, DEVSTONE, devstone_defs::in1>>>> {};
+        };
+    }
+}
+
+#endif // CADMIUM_DEVSTONE_STATIC_MODELS_HPP
@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//Compile time benchmark, a single wide static DEVStone HI model is checked, run by the static engine and
+//translated to the dynamic engine, the compile_time_benchmark target measures the time to compile it
+
+#include <iostream>
+#include <cadmium/concept/coupled_model_assert.hpp>
+#include <cadmium/engine/pdevs_runner.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include "devstone/devstone_static_models.hpp"
+
+#ifndef COMPILE_TIME_WIDTH
+#define COMPILE_TIME_WIDTH 20
+#endif
+
+using namespace cadmium::benchmark;
+
+template<typename TIME>
+using wide_model=static_hi<2, COMPILE_TIME_WIDTH>::template type<TIME>;
+
+template<typename TIME>
+using wide_top=static_devstone_top<static_hi<2, COMPILE_TIME_WIDTH>::template type, false>::template type<TIME>;
+
+int main() {
+    cadmium::concept::coupled_model_assert<wide_model>();
+
+    cadmium::engine::runner<double, wide_top, cadmium::logger::not_logger> r{0.0};
+    r.run_until_passivate();
+
+    auto translated = cadmium::dynamic::translate::make_dynamic_coupled_model<double, wide_top>();
+    std::cout << "width=" << COMPILE_TIME_WIDTH << " events=" << devstone_workload::events() << " translated_models=" << translated->_models.size() << std::endl;
+    return 0;
+}
@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//DEVStone benchmark of the dynamic engine, the models are built at runtime
+
+#include <string>
+#include <iostream>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include "devstone/devstone_dynamic_models.hpp"
+#include "devstone/devstone_report.hpp"
+
+using namespace cadmium::benchmark;
+
+/**
+ * Usage: devstone_dynamic TYPE DEPTH WIDTH [INTERNAL_CYCLES EXTERNAL_CYCLES]
+ *
+ * TYPE is LI, HI, HO or HOmod.
+ */
+
+int main(int argc, char** argv) {
+    if (argc != 4 && argc != 6) {
+        std::cerr << "Usage: " << argv[0] << " LI|HI|HO|HOmod DEPTH WIDTH [INTERNAL_CYCLES EXTERNAL_CYCLES]" << std::endl;
+        return 1;
+    }
+    std::string type = argv[1];
+    int depth = std::stoi(argv[2]);
+    int width = std::stoi(argv[3]);
+    if (argc == 6) {
+        devstone_workload::internal_cycles = std::stoul(argv[4]);
+        devstone_workload::external_cycles = std::stoul(argv[5]);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto top = devstone_dynamic_builder<double>(devstone_type_of(type), width).top(depth);
+    cadmium::dynamic::engine::runner<double, cadmium::logger::not_logger> r(top, 0.0);
+    double build_seconds = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    r.run_until_passivate();
+    report(std::cout, {"dynamic", type, depth, width, build_seconds, seconds_since(start)});
+    return 0;
+}
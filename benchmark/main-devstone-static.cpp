@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//DEVStone benchmark of the static engine, the depth and width are fixed at compile time
+
+#include <string>
+#include <iostream>
+#include <cadmium/engine/pdevs_runner.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include "devstone/devstone_static_models.hpp"
+#include "devstone/devstone_dynamic_models.hpp"
+#include "devstone/devstone_report.hpp"
+
+#ifndef DEVSTONE_DEPTH
+#define DEVSTONE_DEPTH 8
+#endif
+
+#ifndef DEVSTONE_WIDTH
+#define DEVSTONE_WIDTH 8
+#endif
+
+using namespace cadmium::benchmark;
+
+/**
+ * Usage: devstone_static TYPE [INTERNAL_CYCLES EXTERNAL_CYCLES]
+ *
+ * TYPE is LI, HI, HO or HOmod, the depth and width are DEVSTONE_DEPTH and DEVSTONE_WIDTH.
+ */
+
+template<template<typename> class TOP>
+devstone_run run(const std::string& type) {
+    auto start = std::chrono::steady_clock::now();
+    cadmium::engine::runner<double, TOP, cadmium::logger::not_logger> r{0.0};
+    double build_seconds = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    r.run_until_passivate();
+    return {"static", type, DEVSTONE_DEPTH, DEVSTONE_WIDTH, build_seconds, seconds_since(start)};
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2 && argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " LI|HI|HO|HOmod [INTERNAL_CYCLES EXTERNAL_CYCLES]" << std::endl;
+        return 1;
+    }
+    if (argc == 4) {
+        devstone_workload::internal_cycles = std::stoul(argv[2]);
+        devstone_workload::external_cycles = std::stoul(argv[3]);
+    }
+
+    std::string type = argv[1];
+    devstone_run result;
+    switch (devstone_type_of(type)) {
+        case devstone_type::li:
+            result = run<static_devstone_top<static_li<DEVSTONE_DEPTH, DEVSTONE_WIDTH>::template type, false>::template type>(type);
+            break;
+        case devstone_type::hi:
+            result = run<static_devstone_top<static_hi<DEVSTONE_DEPTH, DEVSTONE_WIDTH>::template type, false>::template type>(type);
+            break;
+        case devstone_type::ho:
+            result = run<static_devstone_top<static_ho<DEVSTONE_DEPTH, DEVSTONE_WIDTH>::template type, true>::template type>(type);
+            break;
+        case devstone_type::homod:
+            result = run<static_devstone_top<static_homod<DEVSTONE_DEPTH, DEVSTONE_WIDTH>::template type, true>::template type>(type);
+            break;
+    }
+    report(std::cout, result);
+    return 0;
+}
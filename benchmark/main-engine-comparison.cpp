@@ -0,0 +1,186 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//Static vs dynamic engine benchmark, the same static DEVStone model is run by the static engine, by the static
+//engine with its couplings flattened at compile time and by the dynamic engine after translating it with
+//dynamic_model_translator
+
+#include <string>
+#include <iomanip>
+#include <iostream>
+#include <streambuf>
+#include <cadmium/engine/pdevs_runner.hpp>
+#include <cadmium/engine/pdevs_flat_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include "devstone/devstone_static_models.hpp"
+#include "devstone/devstone_dynamic_models.hpp"
+#include "devstone/devstone_report.hpp"
+
+#ifndef DEVSTONE_DEPTH
+#define DEVSTONE_DEPTH 8
+#endif
+
+#ifndef DEVSTONE_WIDTH
+#define DEVSTONE_WIDTH 8
+#endif
+
+using namespace cadmium::benchmark;
+
+/**
+ * Usage: engine_comparison TYPE [none|state|routing] [INTERNAL_CYCLES EXTERNAL_CYCLES]
+ *
+ * TYPE is LI, HI, HO or HOmod, the depth and width are DEVSTONE_DEPTH and DEVSTONE_WIDTH. All the engines log
+ * the same source, formatted and written to a sink discarding the output, none by default.
+ */
+
+// the formatted logs are discarded to measure the logging cost without the output device
+struct null_sink_provider {
+    static std::ostream& sink() {
+        struct null_buffer : std::streambuf {
+            int overflow(int c) override {
+                return traits_type::not_eof(c);
+            }
+        };
+        static null_buffer buffer;
+        static std::ostream os(&buffer);
+        return os;
+    }
+};
+
+template<typename SOURCE>
+struct engine_loggers {
+    using static_logger = cadmium::logger::logger<SOURCE, cadmium::logger::formatter<double>, null_sink_provider>;
+    using dynamic_logger = cadmium::logger::logger<SOURCE, cadmium::dynamic::logger::formatter<double>, null_sink_provider>;
+};
+
+template<>
+struct engine_loggers<void> {
+    using static_logger = cadmium::logger::not_logger;
+    using dynamic_logger = cadmium::logger::not_logger;
+};
+
+struct engine_run {
+    double build_seconds;
+    double run_seconds;
+    std::uint64_t events;
+};
+
+template<template<typename, template<typename> class, typename> class RUNNER, template<typename> class TOP, typename LOGGERS>
+engine_run run_static() {
+    devstone_workload::reset();
+    auto start = std::chrono::steady_clock::now();
+    RUNNER<double, TOP, typename LOGGERS::static_logger> r{0.0};
+    double build_seconds = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    r.run_until_passivate();
+    return {build_seconds, seconds_since(start), devstone_workload::events()};
+}
+
+template<template<typename> class TOP, typename LOGGERS>
+engine_run run_dynamic() {
+    devstone_workload::reset();
+    auto start = std::chrono::steady_clock::now();
+    auto top = cadmium::dynamic::translate::make_dynamic_coupled_model<double, TOP>();
+    cadmium::dynamic::engine::runner<double, typename LOGGERS::dynamic_logger> r(top, 0.0);
+    double build_seconds = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    r.run_until_passivate();
+    return {build_seconds, seconds_since(start), devstone_workload::events()};
+}
+
+void print_row(std::ostream& os, const std::string& engine, const engine_run& run) {
+    os << std::left << std::setw(10) << engine << std::right
+       << std::setw(12) << run.build_seconds
+       << std::setw(12) << run.run_seconds
+       << std::setw(12) << run.events
+       << std::setw(16) << (run.run_seconds > 0 ? run.events / run.run_seconds : 0) << '\n';
+}
+
+template<template<typename> class TOP, typename LOGGERS>
+int compare(const std::string& type, const std::string& log) {
+    engine_run s = run_static<cadmium::engine::runner, TOP, LOGGERS>();
+    engine_run f = run_static<cadmium::engine::flat_runner, TOP, LOGGERS>();
+    engine_run d = run_dynamic<TOP, LOGGERS>();
+
+    std::cout << "model=" << type << " depth=" << DEVSTONE_DEPTH << " width=" << DEVSTONE_WIDTH
+              << " internal_cycles=" << devstone_workload::internal_cycles
+              << " external_cycles=" << devstone_workload::external_cycles << " log=" << log << '\n'
+              << std::left << std::setw(10) << "engine" << std::right << std::setw(12) << "build_s"
+              << std::setw(12) << "run_s" << std::setw(12) << "events" << std::setw(16) << "events_per_s" << '\n';
+    print_row(std::cout, "static", s);
+    print_row(std::cout, "flat", f);
+    print_row(std::cout, "dynamic", d);
+    std::cout << "dynamic/static run time ratio=" << (s.run_seconds > 0 ? d.run_seconds / s.run_seconds : 0) << std::endl;
+
+    // all the engines must simulate the same model
+    if (s.events != f.events || s.events != d.events) {
+        std::cerr << "The engines ran a different number of events" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+template<template<typename> class TOP>
+int compare_logging(const std::string& type, const std::string& log) {
+    if (log == "none") {
+        return compare<TOP, engine_loggers<void>>(type, log);
+    } else if (log == "state") {
+        return compare<TOP, engine_loggers<cadmium::logger::logger_state>>(type, log);
+    } else if (log == "routing") {
+        return compare<TOP, engine_loggers<cadmium::logger::logger_message_routing>>(type, log);
+    }
+    std::cerr << "Unknown log " << log << ", expected none, state or routing" << std::endl;
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 5 || argc == 4) {
+        std::cerr << "Usage: " << argv[0] << " LI|HI|HO|HOmod [none|state|routing] [INTERNAL_CYCLES EXTERNAL_CYCLES]" << std::endl;
+        return 1;
+    }
+    std::string type = argv[1];
+    std::string log = argc > 2 ? argv[2] : "none";
+    if (argc == 5) {
+        devstone_workload::internal_cycles = std::stoul(argv[3]);
+        devstone_workload::external_cycles = std::stoul(argv[4]);
+    }
+
+    switch (devstone_type_of(type)) {
+        case devstone_type::li:
+            return compare_logging<static_devstone_top<static_li<DEVSTONE_DEPTH, DEVSTONE_WIDTH>::template type, false>::template type>(type, log);
+        case devstone_type::hi:
+            return compare_logging<static_devstone_top<static_hi<DEVSTONE_DEPTH, DEVSTONE_WIDTH>::template type, false>::template type>(type, log);
+        case devstone_type::ho:
+            return compare_logging<static_devstone_top<static_ho<DEVSTONE_DEPTH, DEVSTONE_WIDTH>::template type, true>::template type>(type, log);
+        case devstone_type::homod:
+            return compare_logging<static_devstone_top<static_homod<DEVSTONE_DEPTH, DEVSTONE_WIDTH>::template type, true>::template type>(type, log);
+    }
+    return 1;
+}
@@ -0,0 +1,303 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//Micro-benchmarks of the dynamic engine data structures, each case times the previous implementation and the
+//current one of the same operation: the bag translation of the atomic models, the link routing, the
+//message_bags lookups and the next time of the coordinators
+
+#include <map>
+#include <tuple>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <typeindex>
+#include <algorithm>
+#include <utility>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_fel.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/dynamic_models_helpers.hpp>
+#include "devstone/devstone_atomic.hpp"
+#include "devstone/devstone_report.hpp"
+
+using namespace cadmium::benchmark;
+
+/**
+ * Usage: micro_benchmarks [ITERATIONS]
+ *
+ * Prints one line by case with the nanoseconds by operation of the previous and the current implementation,
+ * the best of a few repetitions of ITERATIONS operations, 100000 by default. The operations touch a sink
+ * printed at the end, then the compiler does not remove them.
+ */
+
+using bags = cadmium::dynamic::message_bags;
+using not_logger = cadmium::logger::not_logger;
+
+namespace {
+
+    std::size_t sink = 0;
+
+    template<std::size_t N>
+    struct bench_in : public cadmium::in_port<int> {};
+
+    template<std::size_t N>
+    struct bench_out : public cadmium::out_port<int> {};
+
+    template<template<std::size_t> class PORT, std::size_t... N>
+    std::tuple<PORT<N>...> ports_of(std::index_sequence<N...>);
+
+    template<template<std::size_t> class PORT, std::size_t N>
+    using ports_type = decltype(ports_of<PORT>(std::make_index_sequence<N>()));
+
+    template<std::size_t N>
+    using in_bags = typename cadmium::make_message_bags<ports_type<bench_in, N>>::type;
+
+    template<std::size_t N>
+    using out_bags = typename cadmium::make_message_bags<ports_type<bench_out, N>>::type;
+
+    // the best nanoseconds by operation of a few repetitions of iterations calls to f
+    template<typename F>
+    double ns_per_op(std::size_t iterations, F&& f) {
+        double best = 0;
+        for (int r = 0; r < 3; r++) {
+            auto start = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < iterations; i++) {
+                f();
+            }
+            double ns = seconds_since(start) * 1e9 / iterations;
+            best = r == 0 ? ns : std::min(best, ns);
+        }
+        return best;
+    }
+
+    void report(const std::string& group, const std::string& name, double previous, double current) {
+        std::cout << std::left << std::setw(12) << group << std::setw(30) << name << std::right << std::fixed
+                  << std::setprecision(1) << " previous_ns=" << std::setw(9) << previous
+                  << " current_ns=" << std::setw(9) << current
+                  << std::setprecision(2) << " speedup=" << (current > 0 ? previous / current : 0) << std::endl;
+    }
+
+    template<template<std::size_t> class PORT, std::size_t N>
+    cadmium::dynamic::modeling::Ports port_types() {
+        return cadmium::dynamic::modeling::create_dynamic_ports<ports_type<PORT, N>>();
+    }
+
+    // input translation, copying the bags of an inbox vs moving them out
+    template<std::size_t PORTS>
+    void bench_input_translation(std::size_t iterations, std::size_t messages) {
+        using tuple_type = in_bags<PORTS>;
+        bags inbox(port_types<bench_in, PORTS>());
+        auto refill = [&inbox, messages] {
+            auto& m = inbox.get_bag_in_slot<cadmium::message_bag<bench_in<0>>>(0).messages;
+            m.assign(messages, 1);
+        };
+        // both refill the inbox, the moved messages are gone
+        double previous = ns_per_op(iterations, [&] {
+            refill();
+            tuple_type t;
+            cadmium::dynamic::modeling::fill_bags_from_map(inbox, t);
+            sink += std::get<0>(t).messages.size();
+        });
+        double current = ns_per_op(iterations, [&] {
+            refill();
+            tuple_type t;
+            cadmium::dynamic::modeling::move_bags_from_map(std::move(inbox), t);
+            sink += std::get<0>(t).messages.size();
+        });
+        report("translation", "input ports=" + std::to_string(PORTS) + " messages=" + std::to_string(messages), previous, current);
+    }
+
+    // output translation, every port to a new bags vs the ports with messages moved to the outbox
+    template<std::size_t PORTS>
+    void bench_output_translation(std::size_t iterations, std::size_t messages) {
+        using tuple_type = out_bags<PORTS>;
+        bags outbox(port_types<bench_out, PORTS>());
+        auto output = [messages] {
+            tuple_type t;
+            std::get<0>(t).messages.assign(messages, 1);
+            return t;
+        };
+        double previous = ns_per_op(iterations, [&] {
+            tuple_type t = output();
+            bags b;
+            cadmium::dynamic::modeling::fill_map_from_bags(t, b);
+            outbox.clear();
+            for (auto& bag : b) {
+                outbox[bag.first] = std::move(bag.second);
+            }
+            sink += outbox.size();
+        });
+        double current = ns_per_op(iterations, [&] {
+            tuple_type t = output();
+            outbox.clear();
+            cadmium::dynamic::modeling::move_map_from_bags(t, outbox);
+            sink += outbox.size();
+        });
+        report("translation", "output ports=" + std::to_string(PORTS) + " messages=" + std::to_string(messages), previous, current);
+    }
+
+    // the links from one port to fan_out ports, routed by port lookup vs by a routing table
+    void bench_fan_out(std::size_t iterations, std::size_t messages, std::size_t fan_out) {
+        auto link = cadmium::dynamic::translate::make_link<bench_out<0>, bench_in<0>>();
+        bags from({cadmium::dynamic::port_key::of<bench_out<0>>()});
+        from.get_bag_in_slot<cadmium::message_bag<bench_out<0>>>(0).messages.assign(messages, 1);
+        std::vector<bags> to;
+        for (std::size_t i = 0; i < fan_out; i++) {
+            to.emplace_back(cadmium::dynamic::modeling::Ports{cadmium::dynamic::port_key::of<bench_in<0>>()});
+        }
+        cadmium::dynamic::engine::routing_table table;
+        for (auto& b : to) {
+            table.push_back(cadmium::dynamic::engine::make_routing_entry(from, b, *link, false));
+        }
+        auto clear = [&to] {
+            for (auto& b : to) {
+                b.clear();
+            }
+        };
+        double previous = ns_per_op(iterations, [&] {
+            clear();
+            for (auto& b : to) {
+                link->route_messages(from, b, false);
+            }
+            sink += to.back().size();
+        });
+        double current = ns_per_op(iterations, [&] {
+            clear();
+            cadmium::dynamic::engine::route_messages_by_table<not_logger>(table, false);
+            sink += to.back().size();
+        });
+        report("routing", "fan-out=" + std::to_string(fan_out) + " messages=" + std::to_string(messages), previous, current);
+    }
+
+    // the links from fan_in ports to one port, routed entry by entry vs bucket by bucket
+    void bench_fan_in(std::size_t iterations, std::size_t messages, std::size_t fan_in) {
+        auto link = cadmium::dynamic::translate::make_link<bench_out<0>, bench_in<0>>();
+        std::vector<bags> from;
+        for (std::size_t i = 0; i < fan_in; i++) {
+            from.emplace_back(cadmium::dynamic::modeling::Ports{cadmium::dynamic::port_key::of<bench_out<0>>()});
+        }
+        bags to({cadmium::dynamic::port_key::of<bench_in<0>>()});
+        cadmium::dynamic::engine::routing_table table;
+        for (auto& b : from) {
+            b.get_bag_in_slot<cadmium::message_bag<bench_out<0>>>(0).messages.assign(messages, 1);
+            table.push_back(cadmium::dynamic::engine::make_routing_entry(b, to, *link, false));
+        }
+        cadmium::dynamic::engine::routing_buckets buckets = cadmium::dynamic::engine::make_routing_buckets(table);
+        double previous = ns_per_op(iterations, [&] {
+            to.clear();
+            cadmium::dynamic::engine::route_messages_by_table<not_logger>(table, false);
+            sink += to.size();
+        });
+        double current = ns_per_op(iterations, [&] {
+            to.clear();
+            cadmium::dynamic::engine::route_messages_by_buckets<not_logger>(table, buckets, false);
+            sink += to.size();
+        });
+        report("routing", "fan-in=" + std::to_string(fan_in) + " messages=" + std::to_string(messages), previous, current);
+    }
+
+    // the bags of a model with PORTS ports, a std::map by port type vs the message_bags slots by port id
+    template<std::size_t PORTS>
+    void bench_bags_lookup(std::size_t iterations) {
+        cadmium::dynamic::modeling::Ports ports = port_types<bench_in, PORTS>();
+        std::vector<std::type_index> types;
+        for (const auto& p : ports) {
+            types.push_back(p.type());
+        }
+        std::map<std::type_index, cadmium::dynamic::erased_bag> map;
+        bags slots(ports);
+        double previous = ns_per_op(iterations, [&] {
+            map.clear();
+            map[types[PORTS / 2]] = cadmium::message_bag<bench_in<PORTS / 2>>();
+            for (const auto& t : types) {
+                sink += map.find(t) != map.end();
+            }
+        });
+        double current = ns_per_op(iterations, [&] {
+            slots.clear();
+            slots.get_bag_in_slot<cadmium::message_bag<bench_in<PORTS / 2>>>(PORTS / 2);
+            for (const auto& p : ports) {
+                sink += slots.find(p) != slots.end();
+            }
+        });
+        report("bags", "insert and find ports=" + std::to_string(PORTS), previous, current);
+    }
+
+    // the next time of children simulators, asking each one vs the lanes reduction of their next times
+    void bench_min_next(std::size_t iterations, std::size_t children) {
+        using simulator_type = cadmium::dynamic::engine::simulator<double, not_logger>;
+        cadmium::dynamic::engine::subcoordinators_type<double> engines;
+        std::vector<double> next_times;
+        for (std::size_t i = 0; i < children; i++) {
+            auto e = std::make_shared<simulator_type>(cadmium::dynamic::translate::make_dynamic_atomic_model<devstone_dynamic_atomic, double>("atomic_" + std::to_string(i)));
+            e->init(0.0);
+            next_times.push_back(e->next());
+            engines.push_back(e);
+        }
+        double previous = ns_per_op(iterations, [&] {
+            sink += cadmium::dynamic::engine::min_next_in_subcoordinators<double>(engines) == 0;
+        });
+        double current = ns_per_op(iterations, [&] {
+            sink += cadmium::dynamic::engine::min_time(next_times.data(), next_times.size()) == 0;
+        });
+        report("next", "children=" + std::to_string(children), previous, current);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    if (argc > 2 || iterations == 0) {
+        std::cerr << "Usage: " << argv[0] << " [ITERATIONS]" << std::endl;
+        return 1;
+    }
+
+    for (std::size_t messages : {1, 16, 256}) {
+        bench_input_translation<2>(iterations, messages);
+        bench_input_translation<16>(iterations, messages);
+        bench_output_translation<2>(iterations, messages);
+        bench_output_translation<16>(iterations, messages);
+    }
+    for (std::size_t messages : {1, 16, 256}) {
+        for (std::size_t links : {1, 8, 64}) {
+            bench_fan_out(iterations / links, messages, links);
+            bench_fan_in(iterations / links, messages, links);
+        }
+    }
+    bench_bags_lookup<4>(iterations);
+    bench_bags_lookup<16>(iterations);
+    bench_bags_lookup<64>(iterations);
+    for (std::size_t children : {8, 64, 512}) {
+        bench_min_next(iterations / 8, children);
+    }
+
+    std::cout << "sink=" << sink << std::endl;
+    return 0;
+}
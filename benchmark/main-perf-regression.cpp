@@ -0,0 +1,204 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//Performance regression test, runs fixed size DEVStone models and compares their events by second and
+//allocations with a baseline
+
+#include <new>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <cadmium/engine/pdevs_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include "devstone/devstone_static_models.hpp"
+#include "devstone/devstone_dynamic_models.hpp"
+#include "devstone/devstone_report.hpp"
+
+using namespace cadmium::benchmark;
+
+/**
+ * Usage: perf_regression BASELINE_JSON [--throughput] [--update]
+ *
+ * Runs every case of the baseline, the best of a few repetitions, and fails if a case simulates a different
+ * number of events or its allocations grow above the baseline by more than the allocations tolerance, the
+ * allocations of the model construction depend on the standard library and Boost versions. With --throughput
+ * it also fails if the events by second of a case drop below the baseline by more than the events_per_second
+ * tolerance. The tolerances are fractions of the baseline values. --update writes the measured values in the
+ * baseline.
+ *
+ * The events by second of the baseline are only meaningful for the build type and machine they were
+ * measured on.
+ */
+
+// the allocations of the whole process, the runs are measured by difference
+static std::atomic<std::uint64_t> allocations{0};
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+struct perf_measure {
+    std::uint64_t events = 0;
+    double events_per_second = 0;
+    std::uint64_t allocations = 0;
+};
+
+// runs a model built by run and returns the seconds of its simulation
+template<typename RUNNER, typename BUILD>
+perf_measure measure_once(const BUILD& build) {
+    devstone_workload::reset();
+    auto runner = build();
+    std::uint64_t allocations_before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    runner->run_until_passivate();
+    double seconds = seconds_since(start);
+    perf_measure ret;
+    ret.allocations = allocations.load() - allocations_before;
+    ret.events = devstone_workload::events();
+    ret.events_per_second = seconds > 0 ? ret.events / seconds : 0;
+    return ret;
+}
+
+template<typename RUNNER, typename BUILD>
+perf_measure measure(const BUILD& build, int repetitions) {
+    perf_measure best = measure_once<RUNNER>(build);
+    for (int i = 1; i < repetitions; i++) {
+        perf_measure m = measure_once<RUNNER>(build);
+        best.events_per_second = std::max(best.events_per_second, m.events_per_second);
+        best.allocations = std::min(best.allocations, m.allocations);
+    }
+    return best;
+}
+
+perf_measure run_case(const boost::property_tree::ptree& c, int repetitions) {
+    std::string engine = c.get<std::string>("engine");
+    std::string type = c.get<std::string>("type");
+    devstone_workload::internal_cycles = c.get<std::size_t>("internal_cycles", 0);
+    devstone_workload::external_cycles = c.get<std::size_t>("external_cycles", 0);
+
+    if (engine == "dynamic") {
+        using runner_type = cadmium::dynamic::engine::runner<double, cadmium::logger::not_logger>;
+        int depth = c.get<int>("depth");
+        int width = c.get<int>("width");
+        bool flatten = c.get<bool>("flatten", false);
+        return measure<runner_type>([&] {
+            auto top = devstone_dynamic_builder<double>(devstone_type_of(type), width).top(depth);
+            return std::make_unique<runner_type>(top, 0.0, flatten);
+        }, repetitions);
+    } else if (engine == "static" && type == "HI" && c.get<int>("depth") == 8 && c.get<int>("width") == 8) {
+        // the static models are sized at compile time, only this one is built
+        using runner_type = cadmium::engine::runner<double, static_devstone_top<static_hi<8, 8>::template type, false>::template type, cadmium::logger::not_logger>;
+        return measure<runner_type>([] { return std::make_unique<runner_type>(0.0); }, repetitions);
+    }
+    throw std::domain_error("Unsupported perf case " + c.get<std::string>("name"));
+}
+
+int main(int argc, char** argv) {
+    bool throughput = false;
+    bool update = false;
+    for (int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--throughput") {
+            throughput = true;
+        } else if (option == "--update") {
+            update = true;
+        } else {
+            argc = 0;
+        }
+    }
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " BASELINE_JSON [--throughput] [--update]" << std::endl;
+        return 1;
+    }
+    boost::property_tree::ptree baseline;
+    boost::property_tree::read_json(argv[1], baseline);
+
+    double events_tolerance = baseline.get<double>("tolerance.events_per_second");
+    double allocations_tolerance = baseline.get<double>("tolerance.allocations");
+    int repetitions = baseline.get<int>("repetitions", 3);
+
+    bool failed = false;
+    for (auto& entry : baseline.get_child("cases")) {
+        boost::property_tree::ptree& c = entry.second;
+        std::string name = c.get<std::string>("name");
+        perf_measure m = run_case(c, repetitions);
+
+        if (update) {
+            c.put("events", m.events);
+            c.put("events_per_second", static_cast<std::uint64_t>(m.events_per_second));
+            c.put("allocations", m.allocations);
+            std::cout << name << ": events=" << m.events << " events_per_s=" << m.events_per_second
+                      << " allocations=" << m.allocations << std::endl;
+            continue;
+        }
+
+        std::uint64_t events = c.get<std::uint64_t>("events");
+        double events_per_second = c.get<double>("events_per_second");
+        std::uint64_t allocs = c.get<std::uint64_t>("allocations");
+        std::vector<std::string> regressions;
+        if (m.events != events) {
+            regressions.push_back("events " + std::to_string(m.events) + " != " + std::to_string(events));
+        }
+        if (throughput && m.events_per_second < events_per_second * (1 - events_tolerance)) {
+            regressions.push_back("events_per_s " + std::to_string(m.events_per_second) + " < " + std::to_string(events_per_second));
+        }
+        if (m.allocations > allocs * (1 + allocations_tolerance)) {
+            regressions.push_back("allocations " + std::to_string(m.allocations) + " > " + std::to_string(allocs));
+        }
+
+        std::cout << (regressions.empty() ? "ok   " : "FAIL ") << name << ": events=" << m.events
+                  << " events_per_s=" << m.events_per_second << " (baseline " << events_per_second << ")"
+                  << " allocations=" << m.allocations << " (baseline " << allocs << ")" << std::endl;
+        for (const auto& r : regressions) {
+            std::cout << "     " << r << std::endl;
+        }
+        failed = failed || !regressions.empty();
+    }
+
+    if (update) {
+        boost::property_tree::write_json(argv[1], baseline);
+    }
+    return failed ? 1 : 0;
+}
@@ -34,6 +34,7 @@
 #include <cadmium/modeling/ports.hpp>
 #include <cadmium/concept/coupled_model_assert.hpp>
 #include <cadmium/engine/pdevs_runner.hpp>
+#include <cadmium/modeling/tick_time.hpp>
 using namespace std;
 
 using hclock=chrono::high_resolution_clock;
@@ -58,8 +59,8 @@ using tick_generator_base=cadmium::basic_models::generator<tick, TIME>;
 
 template<typename TIME>
 struct hour_generator : public tick_generator_base<TIME> {
-    float period() const override {
-        return 3600.0f; //using float for time in this example
+    TIME period() const override {
+        return 3600; //periods in seconds, tick_time stores exact millisecond ticks
     }
     tick output_message() const override {
         return tick();
@@ -68,8 +69,8 @@ struct hour_generator : public tick_generator_base<TIME> {
 
 template<typename TIME>
 struct minute_generator : public tick_generator_base<TIME> {
-    float period() const override {
-        return 60.0f; //using float for time in this example
+    TIME period() const override {
+        return 60; //periods in seconds, tick_time stores exact millisecond ticks
     }
     tick output_message() const override {
         return tick();
@@ -78,8 +79,8 @@ struct minute_generator : public tick_generator_base<TIME> {
 
 template<typename TIME>
 struct second_generator : public tick_generator_base<TIME> {
-    float period() const override {
-        return 1.0f; //using float for time in this example
+    TIME period() const override {
+        return 1; //periods in seconds, tick_time stores exact millisecond ticks
     }
     tick output_message() const override {
         return tick();
@@ -108,8 +109,8 @@ using clock_model=cadmium::modeling::coupled_model<TIME, iports, oports, submode
 int main(){
     auto start = hclock::now(); //to measure simulation execution time
 
-    cadmium::engine::runner<float, clock_model> r{0.0};
-    r.run_until(30000.0);
+    cadmium::engine::runner<cadmium::tick_time<>, clock_model> r{0};
+    r.run_until(30000);
 
     auto elapsed = std::chrono::duration_cast<std::chrono::duration<double, std::ratio<1>>>
                                                                                           (hclock::now() - start).count();
@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//counting until 5 and output every 5 seconds, running the generators and the accumulator in different MPI ranks.
+
+#include <iostream>
+#include <mpi.h>
+#include <cadmium/logger/tuple_to_ostream.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_dynamic_distributed_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_mpi_communicator.hpp>
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/basic_model/int_generator_one_sec.hpp>
+#include <cadmium/basic_model/reset_generator_five_sec.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+using namespace std;
+
+/**
+ * This example runs the count fives model of main-count-fives.cpp in two MPI ranks, the generators coupled
+ * model runs in the rank 0 and the accumulator coupled model in the rank 1.
+ * Each rank logs the messages output by its models.
+ *
+ * run it with: mpirun -n 2 distributed_count_fives_example
+ */
+
+
+template<typename TIME>
+using test_accumulator=cadmium::basic_models::accumulator<int, TIME>;
+using test_accumulator_defs=cadmium::basic_models::accumulator_defs<int>;
+
+using empty_iports = std::tuple<>;
+using empty_eic=std::tuple<>;
+using empty_ic=std::tuple<>;
+
+//2 generators doing output in 2 ports
+using generators_oports=std::tuple<cadmium::basic_models::int_generator_one_sec_defs::out, cadmium::basic_models::reset_generator_five_sec_defs::out>;
+using generators_submodels=cadmium::modeling::models_tuple<cadmium::basic_models::reset_generator_five_sec, cadmium::basic_models::int_generator_one_sec>;
+using generators_eoc=std::tuple<
+cadmium::modeling::EOC<cadmium::basic_models::reset_generator_five_sec, cadmium::basic_models::reset_generator_five_sec_defs::out, cadmium::basic_models::reset_generator_five_sec_defs::out>,
+cadmium::modeling::EOC<cadmium::basic_models::int_generator_one_sec, cadmium::basic_models::int_generator_one_sec_defs::out, cadmium::basic_models::int_generator_one_sec_defs::out>
+>;
+
+template<typename TIME>
+using coupled_generators_model=cadmium::modeling::coupled_model<TIME, empty_iports, generators_oports, generators_submodels, empty_eic, generators_eoc, empty_ic>;
+
+//1 accumulator wrapped in a coupled model
+using accumulator_eic=std::tuple<
+cadmium::modeling::EIC<test_accumulator_defs::add, test_accumulator, test_accumulator_defs::add>,
+cadmium::modeling::EIC<test_accumulator_defs::reset, test_accumulator, test_accumulator_defs::reset>
+>;
+using accumulator_eoc=std::tuple<
+cadmium::modeling::EOC<test_accumulator, test_accumulator_defs::sum, test_accumulator_defs::sum>
+>;
+
+using accumulator_submodels=cadmium::modeling::models_tuple<test_accumulator>;
+
+template<typename TIME>
+using coupled_accumulator_model=cadmium::modeling::coupled_model<TIME, typename test_accumulator<TIME>::input_ports, typename test_accumulator<TIME>::output_ports, accumulator_submodels, accumulator_eic, accumulator_eoc, empty_ic>;
+
+
+//top model interconnecting the 2 coupled models
+
+using top_outport = test_accumulator_defs::sum;
+using top_oports = std::tuple<top_outport>;
+using top_submodels=cadmium::modeling::models_tuple<coupled_generators_model, coupled_accumulator_model>;
+
+using top_eoc=std::tuple<
+cadmium::modeling::EOC<coupled_accumulator_model, test_accumulator_defs::sum, top_outport>
+>;
+using top_ic=std::tuple<
+cadmium::modeling::IC<coupled_generators_model, cadmium::basic_models::int_generator_one_sec_defs::out, coupled_accumulator_model, test_accumulator_defs::add>,
+cadmium::modeling::IC<coupled_generators_model, cadmium::basic_models::reset_generator_five_sec_defs::out , coupled_accumulator_model, test_accumulator_defs::reset>
+>;
+
+template<typename TIME>
+using top_model=cadmium::modeling::coupled_model<TIME, empty_iports, top_oports, top_submodels, empty_eic, top_eoc, top_ic>;
+
+using log_messages=cadmium::logger::logger<cadmium::logger::logger_messages, cadmium::dynamic::logger::formatter<float>, cadmium::logger::cout_sink_provider>;
+
+
+int main(int argc, char** argv){
+    MPI_Init(&argc, &argv);
+    {
+        cadmium::dynamic::engine::mpi_communicator communicator;
+        if (communicator.size() != 2) {
+            cerr << "The example must be run in 2 ranks" << endl;
+            MPI_Finalize();
+            return 1;
+        }
+
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        std::vector<std::vector<std::string>> partitions{{model->_models[0]->get_id()}, {model->_models[1]->get_id()}};
+
+        cadmium::dynamic::engine::distributed_runner<float, cadmium::dynamic::engine::mpi_communicator, log_messages> r(model, 0.0, communicator, partitions);
+        r.run_until(100.0);
+    }
+    MPI_Finalize();
+    return 0;
+}
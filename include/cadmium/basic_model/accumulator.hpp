@@ -30,6 +30,7 @@
 #include<cadmium/modeling/ports.hpp>
 #include<cadmium/modeling/message_bag.hpp>
 #include<limits>
+#include<stdexcept>
 #include<cadmium/logger/tuple_to_ostream.hpp> // included to allow the accumulator state to use the << operator
 
 
@@ -31,6 +31,7 @@
 #include<cadmium/modeling/ports.hpp>
 #include<cadmium/modeling/message_bag.hpp>
 #include<limits>
+#include<stdexcept>
 
 namespace cadmium {
     namespace basic_models {
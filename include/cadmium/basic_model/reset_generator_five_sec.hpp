@@ -32,6 +32,7 @@
 #include<cadmium/modeling/message_bag.hpp>
 #include <cadmium/basic_model/accumulator.hpp>
 #include<limits>
+#include<stdexcept>
 
 
 namespace cadmium {
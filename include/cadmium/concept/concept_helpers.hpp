@@ -28,6 +28,8 @@
 #define CADMIUM_HELPERS_HPP
 
 #include<tuple>
+#include<type_traits>
+#include<cstddef>
 
 namespace cadmium {
     namespace concept {
@@ -57,53 +59,43 @@ namespace cadmium {
                 return is_specialization<T, std::tuple>::value;
             }
             
-            template<typename T, int S>
-            struct check_unique_elem_types_impl {
-                static constexpr bool value() {
-                    using elem=typename std::tuple_element<S - 1, T>::type;
-                    std::get<elem>(T{});
-                    return check_unique_elem_types_impl<T, S - 1>::value();
+            //each element type appears once in the tuple, checked by a single fold over the elements
+            template<typename T>
+            struct check_unique_elem_types_impl;
+
+            template<typename... ELEMS>
+            struct check_unique_elem_types_impl<std::tuple<ELEMS...>> {
+                template<typename ELEM>
+                static constexpr std::size_t count() {
+                    return (std::size_t(0) + ... + std::size_t(std::is_same<ELEM, ELEMS>::value));
                 }
-            };
 
-            template<typename T>
-            struct check_unique_elem_types_impl<T, 0> {
                 static constexpr bool value() {
-                    return true;
+                    return ((count<ELEMS>() == 1) && ... && true);
                 }
             };
 
             template<typename T>
             struct check_unique_elem_types {
                 static constexpr bool value() {
-                    return check_unique_elem_types_impl<T, std::tuple_size<T>::value>::value();
-                }
-            };
-
-
-
-            template<typename PORT, typename TUPLE, int S>
-            struct has_port_in_tuple_impl{
-                static constexpr bool value(){
-                    if (std::is_same<PORT, typename std::tuple_element<S-1, TUPLE>::type>()){
-                        return true;
-                    } else {
-                        return has_port_in_tuple_impl<PORT, TUPLE, S-1>::value();
-                    }
+                    return check_unique_elem_types_impl<T>::value();
                 }
             };
 
             template<typename PORT, typename TUPLE>
-            struct has_port_in_tuple_impl<PORT, TUPLE, 0>{
+            struct has_port_in_tuple_impl;
+
+            template<typename PORT, typename... PORTS>
+            struct has_port_in_tuple_impl<PORT, std::tuple<PORTS...>>{
                 static constexpr bool value(){
-                    return false;
+                    return (std::is_same<PORT, PORTS>::value || ... || false);
                 }
             };
 
             template<typename PORT, typename TUPLE>
             struct has_port_in_tuple{
                 static constexpr bool value(){
-                    return has_port_in_tuple_impl<PORT, TUPLE, std::tuple_size<TUPLE>::value>::value();
+                    return has_port_in_tuple_impl<PORT, TUPLE>::value();
                 }
             };
 
@@ -32,6 +32,7 @@
 #include<cadmium/concept/atomic_model_assert.hpp>
 #include<cadmium/modeling/ports.hpp>
 #include<type_traits>
+#include<utility>
 
 namespace cadmium{
     namespace concept {
@@ -39,153 +40,130 @@ namespace cadmium{
         template<typename MODEL>
         constexpr void coupled_model_float_time_assert();
 
-        //static assert over the EIC descriptions
-        template<typename IN, typename EICs, int S>
-        struct assert_each_eic{
-            static constexpr bool value() {
-                using EP=typename std::tuple_element<S-1, EICs>::type::external_input_port;
-                using SUBMODEL=typename std::tuple_element<S-1,EICs>::type::template submodel<float>; //using float time, ports should not depend on time
-                using IP=typename std::tuple_element<S-1, EICs>::type::submodel_input_port;
-                //ports are input ports
-                static_assert(EP::kind == port_kind::in, "The external port in a EIC is not an input port");
-                static_assert(IP::kind == port_kind::in, "The internal port in a EIC is not an input port");
-                //check internal port is defined in submodel
-                static_assert(has_port_in_tuple<IP, typename SUBMODEL::input_ports>::value(), "External port in EIC is not defined as external port in the model");
-                //check external port is defined in the model
-                static_assert(has_port_in_tuple<EP, IN>::value(), "External port in EIC is not defined as external port in the model");
-                //check the internal port matches message type with the external port
-                static_assert(std::is_same<typename EP::message_type, typename IP::message_type>(), "The message type does not match in EIC description");
-
-                //recursive step
-                return assert_each_eic<IN, EICs, S-1>::value();
-            }
-        };
-
-        template<typename IN, typename EICs>
-        struct assert_each_eic<IN, EICs, 0>{
-            static constexpr bool value() {
-                return true;
-            }
-        };
+        //static assert over one EIC description
+        template<typename IN, typename EIC>
+        constexpr bool assert_one_eic() {
+            using EP=typename EIC::external_input_port;
+            using SUBMODEL=typename EIC::template submodel<float>; //using float time, ports should not depend on time
+            using IP=typename EIC::submodel_input_port;
+            //ports are input ports
+            static_assert(EP::kind == port_kind::in, "The external port in a EIC is not an input port");
+            static_assert(IP::kind == port_kind::in, "The internal port in a EIC is not an input port");
+            //check internal port is defined in submodel
+            static_assert(has_port_in_tuple<IP, typename SUBMODEL::input_ports>::value(), "External port in EIC is not defined as external port in the model");
+            //check external port is defined in the model
+            static_assert(has_port_in_tuple<EP, IN>::value(), "External port in EIC is not defined as external port in the model");
+            //check the internal port matches message type with the external port
+            static_assert(std::is_same<typename EP::message_type, typename IP::message_type>(), "The message type does not match in EIC description");
+            return true;
+        }
 
+        //static assert over the EIC descriptions, every coupling is checked by a single fold
+        template<typename IN, typename EICs, std::size_t... Is>
+        constexpr bool assert_each_eic(std::index_sequence<Is...>) {
+            return (assert_one_eic<IN, typename std::tuple_element<Is, EICs>::type>() && ... && true);
+        }
 
         template<typename IN, typename EICs>
         constexpr void assert_eic(IN p_in, EICs eics) {
-            assert_each_eic<IN, EICs, std::tuple_size<EICs>::value>::value();//check couple individually
             static_assert(is_tuple<EICs>(), "EIC is not a tuple");
+            assert_each_eic<IN, EICs>(std::make_index_sequence<std::tuple_size<EICs>::value>{});//check couple individually
         }
 
-        //static assert over the EOC descriptions
-        template<typename OUT, typename EOCs, int S>
-        struct assert_each_eoc{
-            static constexpr bool value() {
-                using EP=typename std::tuple_element<S-1, EOCs>::type::external_output_port;
-                using SUBMODEL=typename std::tuple_element<S-1,EOCs>::type::template submodel<float>; //using float time, ports should not depend on time
-                using IP=typename std::tuple_element<S-1, EOCs>::type::submodel_output_port;
-                //ports are output ports
-                static_assert(EP::kind == port_kind::out, "The external port in a EOC is not an output port");
-                static_assert(IP::kind == port_kind::out, "The internal port in a EOC is not an output port");
-                //check internal port is defined in submodel
-                static_assert(has_port_in_tuple<IP, typename SUBMODEL::output_ports>::value(), "Internal port in EOC is not defined as external port in the submodel");
-                //check external port is defined in the model
-                static_assert(has_port_in_tuple<EP, OUT>::value(), "External port in EIC is not defined as external port in the model");
-                //check the internal port matches message type with the external port
-                static_assert(std::is_same<typename EP::message_type, typename IP::message_type>(), "The message type does not match in EOC description");
-
-                //recursive step
-                return assert_each_eoc<OUT, EOCs, S-1>::value();
-            }
-        };
-
-        template<typename OUT, typename EOCs>
-        struct assert_each_eoc<OUT, EOCs, 0>{
-            static constexpr bool value() {
-                return true;
-            }
-        };
+        //static assert over one EOC description
+        template<typename OUT, typename EOC>
+        constexpr bool assert_one_eoc() {
+            using EP=typename EOC::external_output_port;
+            using SUBMODEL=typename EOC::template submodel<float>; //using float time, ports should not depend on time
+            using IP=typename EOC::submodel_output_port;
+            //ports are output ports
+            static_assert(EP::kind == port_kind::out, "The external port in a EOC is not an output port");
+            static_assert(IP::kind == port_kind::out, "The internal port in a EOC is not an output port");
+            //check internal port is defined in submodel
+            static_assert(has_port_in_tuple<IP, typename SUBMODEL::output_ports>::value(), "Internal port in EOC is not defined as external port in the submodel");
+            //check external port is defined in the model
+            static_assert(has_port_in_tuple<EP, OUT>::value(), "External port in EIC is not defined as external port in the model");
+            //check the internal port matches message type with the external port
+            static_assert(std::is_same<typename EP::message_type, typename IP::message_type>(), "The message type does not match in EOC description");
+            return true;
+        }
 
+        //static assert over the EOC descriptions
+        template<typename OUT, typename EOCs, std::size_t... Is>
+        constexpr bool assert_each_eoc(std::index_sequence<Is...>) {
+            return (assert_one_eoc<OUT, typename std::tuple_element<Is, EOCs>::type>() && ... && true);
+        }
 
         template<typename OUT, typename EOCs>
         constexpr void assert_eoc(OUT p_out, EOCs eocs) {
-            assert_each_eoc<OUT, EOCs, std::tuple_size<EOCs>::value>::value();//check couple individually
             static_assert(is_tuple<EOCs>(), "EOC is not a tuple");
+            assert_each_eoc<OUT, EOCs>(std::make_index_sequence<std::tuple_size<EOCs>::value>{});//check couple individually
         }
 
-        //static assert over the IC descriptions
-        template<typename ICs, int S>
-        struct assert_each_ic{
-            static constexpr bool value() {
-                using FROM_MODEL=typename std::tuple_element<S-1, ICs>::type::template from_model<float>;//using float time, ports should not depend on time
-                using FROM_PORT=typename std::tuple_element<S-1, ICs>::type::from_model_output_port;
-                using TO_MODEL=typename std::tuple_element<S-1,ICs>::type::template to_model<float>; //using float time, ports should not depend on time
-                using TO_PORT=typename std::tuple_element<S-1, ICs>::type::to_model_input_port;
-
-                //ports are proper kind
-                static_assert(FROM_PORT::kind == port_kind::out, "The port in from_model in a IC is not an output port");
-                static_assert(TO_PORT::kind == port_kind::in, "The port in a to_model in a IC is not an input port");
-
-                //check ports are defined in submodels
-                static_assert(has_port_in_tuple<FROM_PORT, typename FROM_MODEL::output_ports>::value(), "Output port used in IC is not defined in the submodel");
-                static_assert(has_port_in_tuple<TO_PORT, typename TO_MODEL::input_ports>::value(), "Input port in IC is not defined in the submodel");
-                //check the internal port matches message type with the external port
-                static_assert(std::is_same<typename TO_PORT::message_type, typename FROM_PORT::message_type>(), "The message type does not match in IC description");
-
-                //not loop in IC
-                static_assert(!std::is_same<FROM_MODEL, TO_MODEL>(), "The IC detected a coupling-to-self loop");
-
-                //recursive step
-                return assert_each_ic<ICs, S-1>::value();
-            }
-        };
-
-        template<typename ICs>
-        struct assert_each_ic<ICs, 0>{
-            static constexpr bool value() {
-                return true;
-            }
-        };
+        //static assert over one IC description
+        template<typename IC>
+        constexpr bool assert_one_ic() {
+            using FROM_MODEL=typename IC::template from_model<float>;//using float time, ports should not depend on time
+            using FROM_PORT=typename IC::from_model_output_port;
+            using TO_MODEL=typename IC::template to_model<float>; //using float time, ports should not depend on time
+            using TO_PORT=typename IC::to_model_input_port;
+
+            //ports are proper kind
+            static_assert(FROM_PORT::kind == port_kind::out, "The port in from_model in a IC is not an output port");
+            static_assert(TO_PORT::kind == port_kind::in, "The port in a to_model in a IC is not an input port");
+
+            //check ports are defined in submodels
+            static_assert(has_port_in_tuple<FROM_PORT, typename FROM_MODEL::output_ports>::value(), "Output port used in IC is not defined in the submodel");
+            static_assert(has_port_in_tuple<TO_PORT, typename TO_MODEL::input_ports>::value(), "Input port in IC is not defined in the submodel");
+            //check the internal port matches message type with the external port
+            static_assert(std::is_same<typename TO_PORT::message_type, typename FROM_PORT::message_type>(), "The message type does not match in IC description");
+
+            //not loop in IC
+            static_assert(!std::is_same<FROM_MODEL, TO_MODEL>(), "The IC detected a coupling-to-self loop");
+            return true;
+        }
 
+        //static assert over the IC descriptions
+        template<typename ICs, std::size_t... Is>
+        constexpr bool assert_each_ic(std::index_sequence<Is...>) {
+            return (assert_one_ic<typename std::tuple_element<Is, ICs>::type>() && ... && true);
+        }
 
         template<typename ICs>
         constexpr void assert_ic(ICs ics) {
-            assert_each_ic<ICs, std::tuple_size<ICs>::value>::value();//check couple individually
             static_assert(is_tuple<ICs>(), "ICs is not a tuple");
+            assert_each_ic<ICs>(std::make_index_sequence<std::tuple_size<ICs>::value>{});//check couple individually
         }
 
 
-        //asserting the submodels are proper coupled or atomic modes.
-        template<typename MODELs, int S>
-        struct assert_each_model{
-            using MODEL=typename std::tuple_element<S-1, MODELs>::type;
-            //testing if model has to be checked as atomic or coupled
-            using atomic_detected=char;
-            using coupled_detected=long;
-
-            template <typename M> static atomic_detected test( decltype(&M::time_advance)) ;
-            template <typename M> static coupled_detected test(...);
-
-            static constexpr bool value(){
-                if(sizeof(test<MODEL>)==sizeof(atomic_detected)){
-                    atomic_model_float_time_assert<MODEL>();
-                } else {
-                    coupled_model_float_time_assert<MODEL>();
-                }
-                return assert_each_model<MODELs, S-1>();
-            }
-        };
+        //asserting one submodel is a proper coupled or atomic model.
+        template<typename MODEL, typename=void>
+        struct is_atomic_model : std::false_type {};
 
-        template<typename MODELs>
-        struct assert_each_model<MODELs, 0>{
-            static constexpr bool value(){
-                return true;//TODO
+        template<typename MODEL>
+        struct is_atomic_model<MODEL, std::void_t<decltype(&MODEL::time_advance)>> : std::true_type {};
+
+        template<typename MODEL>
+        constexpr bool assert_one_model() {
+            //testing if model has to be checked as atomic or coupled
+            if constexpr (is_atomic_model<MODEL>::value) {
+                atomic_model_float_time_assert<MODEL>();
+            } else {
+                coupled_model_float_time_assert<MODEL>();
             }
-        };
+            return true;
+        }
 
+        //asserting the submodels are proper coupled or atomic modes.
+        template<typename MODELs, std::size_t... Is>
+        constexpr bool assert_each_model(std::index_sequence<Is...>) {
+            return (assert_one_model<typename std::tuple_element<Is, MODELs>::type>() && ... && true);
+        }
 
         template<typename MODELs>
         constexpr void assert_submodels(MODELs models) {
-            assert_each_model<MODELs, std::tuple_size<MODELs>::value>::value();//check couple individually
-            static_assert(is_tuple(models), "Submodels is not a tuple");
+            static_assert(is_tuple<MODELs>(), "Submodels is not a tuple");
+            assert_each_model<MODELs>(std::make_index_sequence<std::tuple_size<MODELs>::value>{});//check couple individually
         }
 
 
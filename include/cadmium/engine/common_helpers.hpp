@@ -42,7 +42,7 @@ namespace cadmium {
             std::apply(for_each_fold_expression, ts);
         }
 
-        std::string join(std::vector<std::string> v) {
+        inline std::string join(std::vector<std::string> v) {
             std::ostringstream oss;
             oss << "{";
             auto it = v.begin();
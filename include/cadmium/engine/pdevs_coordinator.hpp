@@ -28,6 +28,7 @@
 #ifndef CADMIUM_PDEVS_COORDINATOR_H
 #define CADMIUM_PDEVS_COORDINATOR_H
 #include <limits>
+#include <optional>
 #include <boost/type_index.hpp>
 
 #include <cadmium/engine/pdevs_engine_helpers.hpp>
@@ -50,12 +51,14 @@ namespace cadmium {
          * This kind of coordinator advances time by small certain steps.
          * There is never a rollback.
          * Each call to advanceSimulation advances internally a step and outputs are collected in separate method.
+         * The EXECUTION policy runs the outputs and transitions of the active subengines, see pdevs_execution.hpp,
+         * the parallel ones require a thread safe LOGGER, or the not_logger.
          */
 
 
             //TODO: migrate specialization FEL behavior from CDBoost. At this point, there is no parametrized FEL.
 
-        template<template<typename T> class MODEL, typename TIME, typename LOGGER>
+        template<template<typename T> class MODEL, typename TIME, typename LOGGER, typename EXECUTION>
         class coordinator {
 
             //types for subcoordination
@@ -63,7 +66,7 @@ namespace cadmium {
             using submodels_type=typename MODEL<TIME>::template models<P>;
             using in_bags_type=typename make_message_bags<typename MODEL<TIME>::input_ports>::type;
             using out_bags_type=typename make_message_bags<typename MODEL<TIME>::output_ports>::type;
-            using subcoordinators_type=typename coordinate_tuple<TIME, submodels_type, LOGGER>::type;
+            using subcoordinators_type=typename coordinate_tuple<TIME, submodels_type, LOGGER, EXECUTION>::type;
             using eic=typename MODEL<TIME>::external_input_couplings;
             using eoc=typename MODEL<TIME>::external_output_couplings;
             using ic=typename MODEL<TIME>::internal_couplings;
@@ -72,6 +75,9 @@ namespace cadmium {
             TIME _last; //last transition time
             TIME _next; // next transition scheduled
             subcoordinators_type _subcoordinators;
+            nexts_array<TIME, subcoordinators_type> _subcoordinators_next; //cached next of each subcoordinator
+            received_array<subcoordinators_type> _subcoordinators_received{}; //the subcoordinators receiving messages in the step
+            std::optional<EXECUTION> _execution; //set at init, shared with the subcoordinators
 
             //logging purposes
             std::string _model_id;
@@ -88,19 +94,30 @@ namespace cadmium {
              * @brief init function sets the start time
              * @param t is the start time
              */
-            void init(TIME t) noexcept {
+            void init(TIME t) {
+                init(t, EXECUTION());
+            }
 
-                //logging data
-                std::ostringstream oss;
-                oss << boost::typeindex::type_id<MODEL<TIME>>().pretty_name();
-                _model_id = oss.str();
+            /**
+             * @brief init function sets the start time and the policy running the subengines
+             * @param t is the start time
+             * @param execution is copied to the subcoordinators, the copies of the parallel policies share their pool
+             */
+            void init(TIME t, const EXECUTION& execution) {
+                _execution = execution;
+
+                //logging data, the id is only built when something is logged
+                if constexpr (cadmium::logger::logs_any_source<LOGGER>::value) {
+                    _model_id = boost::typeindex::type_id<MODEL<TIME>>().pretty_name();
+                }
                 LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::coor_info_init>(t, _model_id);
 
                 _last = t;
                 //init all subcoordinators and find next transition time.
-                cadmium::engine::init_subcoordinators<TIME, subcoordinators_type>(t, _subcoordinators);
+                cadmium::engine::init_subcoordinators<TIME, subcoordinators_type>(t, _subcoordinators, *_execution);
+                cadmium::engine::cache_nexts<TIME, subcoordinators_type>(_subcoordinators, _subcoordinators_next);
                 //find the one with the lowest next time
-                _next = cadmium::engine::min_next_in_tuple<subcoordinators_type>(_subcoordinators);
+                _next = cadmium::engine::min_next_in_array(_subcoordinators_next);
                 return ;
             }
 
@@ -129,27 +146,39 @@ namespace cadmium {
                 } else if (_next == t) {
                     //log EOC
                     LOGGER::template log<cadmium::logger::logger_message_routing, cadmium::logger::coor_routing_eoc_collect>(_model_id);
-                    //fill all outboxes and clean the inboxes in the lower levels recursively
-                    cadmium::engine::collect_outputs_in_subcoordinators<TIME, subcoordinators_type>(t, _subcoordinators);
-                    //use the EOC mapping to compose current level output
-                    _outbox = collect_messages_by_eoc<TIME, eoc, out_bags_type, subcoordinators_type, LOGGER>(_subcoordinators);
+                    //fill the outboxes of the imminent subcoordinators in the lower levels recursively
+                    cadmium::engine::collect_outputs_in_imminent_subengines<TIME, subcoordinators_type>(t, _subcoordinators, _subcoordinators_next, *_execution);
+                    //use the EOC mapping to compose current level output in place
+                    cadmium::engine::clear_bags(_outbox);
+                    collect_messages_by_eoc<TIME, eoc, out_bags_type, subcoordinators_type, LOGGER>(_outbox, _subcoordinators);
                 }
             }
 
             /**
              * @brief outbox keeps the output generated by the last call to collect_outputs
              */
-            out_bags_type outbox() const noexcept{
+            out_bags_type& outbox() noexcept{
                 return _outbox;
             }
 
+            const out_bags_type& outbox() const noexcept{
+                return _outbox;
+            }
+
+            /**
+             * @brief allows the upper level coordinator to route messages in place
+             */
+            in_bags_type& inbox() noexcept{
+                return _inbox;
+            }
+
             /**
              * @brief advanceSimulation advances the execution to t, at t introduces the messages into the system (if any).
              * @param t is the time the transition is expected to be run.
              */
             void advance_simulation(const TIME &t) {
                 //clean outbox because messages are routed before calling this funtion at a higher level
-                _outbox = out_bags_type{};
+                cadmium::engine::clear_bags(_outbox);
 
                 LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::coor_info_advance>(_last, t, _model_id);
 
@@ -159,20 +188,21 @@ namespace cadmium {
 
                     //Route the messages standing in the outboxes to mapped inboxes following ICs and EICs
                     LOGGER::template log<cadmium::logger::logger_message_routing, cadmium::logger::coor_routing_ic_collect>(_model_id);
-                    cadmium::engine::route_internal_coupled_messages_on_subcoordinators<TIME, subcoordinators_type, ic, LOGGER>(t, _subcoordinators);
+                    cadmium::engine::route_internal_coupled_messages_on_subcoordinators<TIME, subcoordinators_type, ic, LOGGER>(t, _subcoordinators, _subcoordinators_received);
 
                     LOGGER::template log<cadmium::logger::logger_message_routing, cadmium::logger::coor_routing_eic_collect>(_model_id);
-                    cadmium::engine::route_external_input_coupled_messages_on_subcoordinators<TIME, in_bags_type, subcoordinators_type, eic, LOGGER>(t, _inbox, _subcoordinators);
+                    cadmium::engine::route_external_input_coupled_messages_on_subcoordinators<TIME, in_bags_type, subcoordinators_type, eic, LOGGER>(t, _inbox, _subcoordinators, _subcoordinators_received);
 
-                    //recurse on advance_simulation
-                    cadmium::engine::advance_simulation_in_subengines<TIME, subcoordinators_type>(t, _subcoordinators);
+                    //recurse on advance_simulation, only in the imminent subcoordinators and the ones the routing gave messages,
+                    //the passive subcoordinators are not visited
+                    cadmium::engine::advance_simulation_in_active_subengines<TIME, subcoordinators_type>(t, _subcoordinators, _subcoordinators_next, _subcoordinators_received, *_execution);
 
                     //set _last and _next
                     _last = t;
-                    _next = cadmium::engine::min_next_in_tuple<subcoordinators_type>(_subcoordinators);
+                    _next = cadmium::engine::min_next_in_array(_subcoordinators_next);
 
                     //clean inbox because they were processed already
-                    _inbox = in_bags_type{};
+                    cadmium::engine::clear_bags(_inbox);
                 }
             }
         };
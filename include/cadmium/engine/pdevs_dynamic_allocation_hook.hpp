@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_ALLOCATION_HOOK_HPP
+#define CADMIUM_PDEVS_DYNAMIC_ALLOCATION_HOOK_HPP
+
+/**
+ * The global operator new and delete counting the heap allocations, see pdevs_dynamic_allocations.hpp.
+ * It replaces the operators of the whole program, then this header is included in exactly one translation
+ * unit, usually the one with main or with the allocation tests, and the other ones include
+ * pdevs_dynamic_allocations.hpp. The array and nothrow operators call these ones.
+ */
+
+#include <new>
+#include <cstdlib>
+#include <cadmium/engine/pdevs_dynamic_allocations.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+            namespace allocation_hook {
+                namespace {
+                    [[maybe_unused]] const bool registered = (hook_installed.store(true, std::memory_order_relaxed), true);
+
+                    void* allocate(std::size_t size, std::size_t alignment) {
+                        count(size);
+                        if (size == 0) {
+                            size = 1;
+                        }
+                        for (;;) {
+                            void* p = alignment <= alignof(std::max_align_t)
+                                      ? std::malloc(size)
+                                      : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+                            if (p != nullptr) {
+                                return p;
+                            }
+                            std::new_handler handler = std::get_new_handler();
+                            if (handler == nullptr) {
+                                throw std::bad_alloc();
+                            }
+                            handler();
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void* operator new(std::size_t size) {
+    return cadmium::dynamic::engine::allocation_hook::allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return cadmium::dynamic::engine::allocation_hook::allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+#endif // CADMIUM_PDEVS_DYNAMIC_ALLOCATION_HOOK_HPP
@@ -0,0 +1,334 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_ALLOCATIONS_HPP
+#define CADMIUM_PDEVS_DYNAMIC_ALLOCATIONS_HPP
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <ostream>
+#include <cadmium/engine/pdevs_dynamic_perf_counters.hpp>
+#include <cadmium/engine/pdevs_dynamic_profile.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            struct allocation_count {
+                std::uint64_t allocations = 0;
+                std::uint64_t bytes = 0;
+
+                allocation_count& operator+=(const allocation_count& o) noexcept {
+                    allocations += o.allocations;
+                    bytes += o.bytes;
+                    return *this;
+                }
+
+                friend allocation_count operator-(const allocation_count& a, const allocation_count& b) noexcept {
+                    return allocation_count{a.allocations - b.allocations, a.bytes - b.bytes};
+                }
+            };
+
+            /**
+             * @brief The counters of the heap allocations incremented by the global operator new of
+             * pdevs_dynamic_allocation_hook.hpp. Without the hook in the program they stay 0.
+             */
+            namespace allocation_hook {
+                inline std::atomic<bool> hook_installed{false};
+                inline std::atomic<std::uint64_t> total_allocations{0};
+                inline std::atomic<std::uint64_t> total_bytes{0};
+                inline thread_local allocation_count thread_count;
+
+                inline void count(std::size_t bytes) noexcept {
+                    thread_count.allocations++;
+                    thread_count.bytes += bytes;
+                    total_allocations.fetch_add(1, std::memory_order_relaxed);
+                    total_bytes.fetch_add(bytes, std::memory_order_relaxed);
+                }
+
+                inline bool installed() noexcept {
+                    return hook_installed.load(std::memory_order_relaxed);
+                }
+
+                // the allocations of all the threads
+                inline allocation_count total() noexcept {
+                    return allocation_count{total_allocations.load(std::memory_order_relaxed), total_bytes.load(std::memory_order_relaxed)};
+                }
+
+                // the allocations of the calling thread
+                inline allocation_count local() noexcept {
+                    return thread_count;
+                }
+            }
+
+            /**
+             * @brief The allocations of the collect_outputs and advance_simulation of an atomic model simulator.
+             */
+            struct model_allocations {
+                std::string model_id;
+                allocation_count collect;
+                allocation_count advance;
+            };
+
+            /**
+             * @brief The heap allocations of the collect, route and advance phases of the coordinators by level,
+             * as the hierarchy_counters, and of the simulators by model. The phases count the allocations of the
+             * thread that created the counters, the models count the allocations of the thread running them.
+             *
+             * The levels and the models are added when the counters are set to the engines, then counting a
+             * step does not allocate. They are kept in deques because the engines created while running add
+             * theirs while the scopes of the others are counting.
+             */
+            class allocation_counters {
+                std::deque<std::array<allocation_count, 3>> _levels;
+                std::deque<model_allocations> _models;
+                std::thread::id _owner = std::this_thread::get_id();
+                std::mutex _mutex;
+
+            public:
+                void add_level(std::size_t level) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    if (_levels.size() <= level) {
+                        _levels.resize(level + 1);
+                    }
+                }
+
+                // the slot of a simulator model in models()
+                std::size_t add_model(const std::string& model_id) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _models.push_back(model_allocations{model_id, {}, {}});
+                    return _models.size() - 1;
+                }
+
+                const std::deque<std::array<allocation_count, 3>>& levels() const noexcept {
+                    return _levels;
+                }
+
+                const std::deque<model_allocations>& models() const noexcept {
+                    return _models;
+                }
+
+                /**
+                 * @brief Adds the allocations between its construction and its destruction to a phase of a level.
+                 */
+                class phase_scope {
+                    allocation_counters* _counters;
+                    allocation_count* _count = nullptr;
+                    allocation_count _start;
+
+                public:
+                    phase_scope(allocation_counters* counters, std::size_t level, coordinator_phase phase) noexcept
+                    : _counters(counters) {
+                        if (_counters && _counters->_owner == std::this_thread::get_id()) {
+                            _count = &_counters->_levels[level][static_cast<std::size_t>(phase)];
+                            _start = allocation_hook::local();
+                        }
+                    }
+
+                    phase_scope(const phase_scope&) = delete;
+                    phase_scope& operator=(const phase_scope&) = delete;
+
+                    ~phase_scope() {
+                        if (_count) {
+                            *_count += allocation_hook::local() - _start;
+                        }
+                    }
+                };
+
+                /**
+                 * @brief Adds the allocations between its construction and its destruction to a phase of a model,
+                 * the collect or the advance.
+                 */
+                class model_scope {
+                    allocation_count* _count = nullptr;
+                    allocation_count _start;
+
+                public:
+                    model_scope(allocation_counters* counters, std::size_t slot, coordinator_phase phase) noexcept {
+                        if (counters) {
+                            model_allocations& m = counters->_models[slot];
+                            _count = phase == coordinator_phase::advance ? &m.advance : &m.collect;
+                            _start = allocation_hook::local();
+                        }
+                    }
+
+                    model_scope(const model_scope&) = delete;
+                    model_scope& operator=(const model_scope&) = delete;
+
+                    ~model_scope() {
+                        if (_count) {
+                            *_count += allocation_hook::local() - _start;
+                        }
+                    }
+                };
+            };
+
+            /**
+             * @brief The heap allocations of the simulation steps, by step and by engine and phase, to check the
+             * steps keep allocating nothing once the simulation is warm.
+             *
+             * The first warmup steps fill the capacities of the bags, FELs and routing buffers, their allocations
+             * are counted but they are not steady steps. A steady step allocating is kept, with the simulated time
+             * it happened at, up to the kept steps, and it is an error when fail_on_allocation.
+             */
+            template<typename TIME>
+            class step_allocations {
+            public:
+                struct allocating_step {
+                    TIME time;
+                    allocation_count count;
+                };
+
+            private:
+                allocation_counters _engines;
+                std::size_t _warmup_steps;
+                bool _fail_on_allocation;
+                std::size_t _kept;
+                std::uint64_t _steps = 0;
+                allocation_count _total;
+                allocation_count _steady;
+                std::uint64_t _allocating_steady_steps = 0;
+                std::uint64_t _max_step_allocations = 0;
+                std::vector<allocating_step> _allocating; // the first allocating steady steps
+
+            public:
+                explicit step_allocations(std::size_t warmup_steps = 1, bool fail_on_allocation = false, std::size_t kept = 10)
+                : _warmup_steps(warmup_steps), _fail_on_allocation(fail_on_allocation), _kept(kept) {
+                    _allocating.reserve(kept);
+                }
+
+                allocation_counters& engines() noexcept {
+                    return _engines;
+                }
+
+                const allocation_counters& engines() const noexcept {
+                    return _engines;
+                }
+
+                /**
+                 * @brief Records the allocations of the step at t.
+                 * @return false if it is a steady step allocating.
+                 */
+                bool record(const TIME& t, const allocation_count& count) {
+                    const bool steady = _steps >= _warmup_steps;
+                    _steps++;
+                    _total += count;
+                    if (!steady) {
+                        return true;
+                    }
+                    _steady += count;
+                    if (count.allocations > _max_step_allocations) {
+                        _max_step_allocations = count.allocations;
+                    }
+                    if (count.allocations == 0) {
+                        return true;
+                    }
+                    _allocating_steady_steps++;
+                    if (_allocating.size() < _kept) {
+                        _allocating.push_back(allocating_step{t, count});
+                    }
+                    return false;
+                }
+
+                bool fail_on_allocation() const noexcept {
+                    return _fail_on_allocation;
+                }
+
+                std::uint64_t steps() const noexcept {
+                    return _steps;
+                }
+
+                std::uint64_t steady_steps() const noexcept {
+                    return _steps > _warmup_steps ? _steps - _warmup_steps : 0;
+                }
+
+                // the allocations of all the steps, the warmup ones included
+                const allocation_count& total() const noexcept {
+                    return _total;
+                }
+
+                const allocation_count& steady() const noexcept {
+                    return _steady;
+                }
+
+                std::uint64_t allocating_steady_steps() const noexcept {
+                    return _allocating_steady_steps;
+                }
+
+                std::uint64_t max_step_allocations() const noexcept {
+                    return _max_step_allocations;
+                }
+
+                const std::vector<allocating_step>& allocating_steps() const noexcept {
+                    return _allocating;
+                }
+            };
+
+            /**
+             * @brief Writes the steps and their allocations in a line, a line by allocating steady step kept, then
+             * the allocations as CSV, a header line, a line by level and phase of the coordinators and a line by
+             * model and phase with allocations.
+             */
+            template<typename TIME>
+            void write_step_allocations(std::ostream& os, const step_allocations<TIME>& allocations) {
+                static const char* phases[] = {"collect", "route", "advance"};
+                os << "steps=" << allocations.steps() << " steady_steps=" << allocations.steady_steps()
+                   << " allocations=" << allocations.total().allocations << " bytes=" << allocations.total().bytes
+                   << " steady_allocations=" << allocations.steady().allocations
+                   << " allocating_steady_steps=" << allocations.allocating_steady_steps()
+                   << " max_step_allocations=" << allocations.max_step_allocations() << '\n';
+                for (const auto& s : allocations.allocating_steps()) {
+                    os << "time=" << s.time << " allocations=" << s.count.allocations << " bytes=" << s.count.bytes << '\n';
+                }
+                os << "engine,phase,allocations,bytes\n";
+                const allocation_counters& engines = allocations.engines();
+                for (std::size_t l = 0; l < engines.levels().size(); l++) {
+                    for (std::size_t p = 0; p < 3; p++) {
+                        const allocation_count& c = engines.levels()[l][p];
+                        os << "level " << l << ',' << phases[p] << ',' << c.allocations << ',' << c.bytes << '\n';
+                    }
+                }
+                for (const auto& m : engines.models()) {
+                    for (const auto* c : {&m.collect, &m.advance}) {
+                        if (c->allocations != 0) {
+                            write_csv_quoted(os, m.model_id);
+                            os << ',' << (c == &m.collect ? "collect" : "advance") << ',' << c->allocations << ',' << c->bytes << '\n';
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif // CADMIUM_PDEVS_DYNAMIC_ALLOCATIONS_HPP
@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_CHECKPOINT_HPP
+#define CADMIUM_PDEVS_DYNAMIC_CHECKPOINT_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+#include <cadmium/modeling/state_serializer.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * Checkpoints of the dynamic engine, the state of a simulation between two steps.
+             *
+             * A checkpoint starts with the magic "CDMK" and the format version, then each engine of the hierarchy
+             * writes in depth first order its model id, its last and next times and what it needs to continue:
+             * the coordinators their subengines, the simulators the state of their model. The times and the
+             * states are written with cadmium::state_serializer.
+             *
+             * Between two steps all the boxes are empty, the messages of a step are consumed by its transitions,
+             * then the checkpoint has no messages. It is restored in the engines of the same model hierarchy,
+             * their model ids are checked, the schedules of the coordinators are rebuilt from the times restored.
+             */
+            namespace checkpoint {
+
+                constexpr char magic[4] = {'C', 'D', 'M', 'K'};
+                constexpr std::uint32_t version = 1;
+
+                template<typename T>
+                void write_value(const T& value, std::string& buffer) {
+                    cadmium::state_serializer<T>::write(value, buffer);
+                }
+
+                template<typename T>
+                T read_value(const char*& data, const char* end) {
+                    T value{};
+                    cadmium::state_serializer<T>::read(data, end, value);
+                    return value;
+                }
+
+                inline void write_header(std::string& buffer) {
+                    buffer.append(magic, sizeof(magic));
+                    write_value(version, buffer);
+                }
+
+                inline void read_header(const char*& data, const char* end) {
+                    if (end - data < static_cast<std::ptrdiff_t>(sizeof(magic)) || std::memcmp(data, magic, sizeof(magic)) != 0) {
+                        throw std::domain_error("Not a checkpoint");
+                    }
+                    data += sizeof(magic);
+                    if (read_value<std::uint32_t>(data, end) != version) {
+                        throw std::domain_error("Unsupported checkpoint version");
+                    }
+                }
+
+                /**
+                 * @brief Starts the checkpoint of the engine of the model, its boxes must be empty.
+                 */
+                inline void write_engine(const std::string& model_id, const cadmium::dynamic::message_bags& inbox,
+                                         const cadmium::dynamic::message_bags& outbox, std::string& buffer) {
+                    if (!inbox.empty() || !outbox.empty()) {
+                        throw std::domain_error("The engine of " + model_id + " has messages in its boxes, checkpoints are saved between steps");
+                    }
+                    write_value(model_id, buffer);
+                }
+
+                /**
+                 * @brief Reads the start of the checkpoint of the engine of the model.
+                 */
+                inline void read_engine(const std::string& model_id, const char*& data, const char* end) {
+                    std::string saved = read_value<std::string>(data, end);
+                    if (saved != model_id) {
+                        throw std::domain_error("The checkpoint of " + saved + " does not match the model " + model_id);
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif //CADMIUM_PDEVS_DYNAMIC_CHECKPOINT_HPP
@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_COMMUNICATOR_HPP
+#define CADMIUM_PDEVS_DYNAMIC_COMMUNICATOR_HPP
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <condition_variable>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * Communicator concept used by the distributed runner to synchronize the ranks running a simulation.
+             * All the ranks must call the collective operations in the same order.
+             *
+             * - std::size_t rank() const: the rank of the caller, in [0, size()).
+             * - std::size_t size() const: the number of ranks.
+             * - std::vector<std::string> all_gather(const std::string& data): returns the data of every rank,
+             *   indexed by rank.
+             * - std::vector<std::string> all_to_all(std::vector<std::string> data): sends data[r] to each rank r,
+             *   returns the data sent to the caller indexed by the sender rank.
+             * - static constexpr bool threads_of_one_process, optional: true if the ranks are threads of the same
+             *   process, the distributed runner then only releases the message arena of its own thread after
+             *   each step, see message_arena::release_local.
+             *
+             * The MPI communicator is defined in pdevs_dynamic_mpi_communicator.hpp.
+             */
+
+            /**
+             * @brief The ranks of a group of local_communicator running in threads of the same process.
+             */
+            class local_group {
+                std::size_t _size;
+                std::mutex _mutex;
+                std::condition_variable _arrived_all;
+                std::size_t _arrived = 0;
+                std::size_t _generation = 0;
+                std::vector<std::vector<std::string>> _slots; // data sent by [from][to]
+
+                void barrier(std::unique_lock<std::mutex>& lock) {
+                    std::size_t generation = _generation;
+                    if (++_arrived == _size) {
+                        _arrived = 0;
+                        _generation++;
+                        _arrived_all.notify_all();
+                    } else {
+                        _arrived_all.wait(lock, [this, generation]() { return _generation != generation; });
+                    }
+                }
+
+            public:
+                explicit local_group(std::size_t size)
+                : _size(size), _slots(size) {}
+
+                std::size_t size() const noexcept {
+                    return _size;
+                }
+
+                std::vector<std::string> all_to_all(std::size_t rank, std::vector<std::string> data) {
+                    if (data.size() != _size) {
+                        throw std::domain_error("Sending data to an invalid number of ranks");
+                    }
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _slots[rank] = std::move(data);
+                    barrier(lock);
+
+                    std::vector<std::string> ret(_size);
+                    for (std::size_t from = 0; from < _size; from++) {
+                        ret[from] = std::move(_slots[from][rank]);
+                    }
+                    // nobody writes its slots again before all the ranks read them
+                    barrier(lock);
+                    return ret;
+                }
+            };
+
+            /**
+             * @brief Communicator between ranks run by threads of the same process, used to run distributed
+             * simulations in a single machine and to test them.
+             */
+            class local_communicator {
+                std::shared_ptr<local_group> _group;
+                std::size_t _rank;
+
+            public:
+                static constexpr bool threads_of_one_process = true;
+
+                local_communicator(std::shared_ptr<local_group> group, std::size_t rank)
+                : _group(std::move(group)), _rank(rank) {}
+
+                /**
+                 * @brief Creates the communicators of a group of size ranks, indexed by rank.
+                 */
+                static std::vector<local_communicator> group(std::size_t size) {
+                    auto shared_group = std::make_shared<local_group>(size);
+                    std::vector<local_communicator> ret;
+                    for (std::size_t r = 0; r < size; r++) {
+                        ret.emplace_back(shared_group, r);
+                    }
+                    return ret;
+                }
+
+                std::size_t rank() const noexcept {
+                    return _rank;
+                }
+
+                std::size_t size() const noexcept {
+                    return _group->size();
+                }
+
+                std::vector<std::string> all_gather(const std::string& data) {
+                    return _group->all_to_all(_rank, std::vector<std::string>(_group->size(), data));
+                }
+
+                std::vector<std::string> all_to_all(std::vector<std::string> data) {
+                    return _group->all_to_all(_rank, std::move(data));
+                }
+            };
+        }
+    }
+}
+
+#endif //CADMIUM_PDEVS_DYNAMIC_COMMUNICATOR_HPP
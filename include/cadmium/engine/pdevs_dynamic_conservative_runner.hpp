@@ -0,0 +1,649 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_CONSERVATIVE_RUNNER_HPP
+#define CADMIUM_PDEVS_DYNAMIC_CONSERVATIVE_RUNNER_HPP
+
+#include <map>
+#include <chrono>
+#include <vector>
+#include <limits>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <numeric>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_execution.hpp>
+#include <cadmium/engine/pdevs_dynamic_profile.hpp>
+#include <cadmium/engine/pdevs_dynamic_delivery_queue.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief The conservative runner runs the simulation partitioning the top coupled model submodels
+             * in logical processes, each one run by its own coordinator. The logical processes advance
+             * concurrently up to a safe time bound computed YAWNS style, in synchronous rounds:
+             *
+             * - All the logical processes with events at the lowest next time are run at that time, and the
+             *   messages between them are exchanged before the transitions.
+             * - The earliest output time of each logical process is computed from its next time, the messages
+             *   it has to receive and the earliest output time of the processes sending it messages, plus its
+             *   lookahead.
+             * - Each logical process runs by itself all its events scheduled before the lowest earliest output
+             *   time of the processes sending it messages. The messages sent meanwhile are only delivered at
+             *   the end of the round, they are never scheduled before the receiver current time.
+             *
+             * The messages are pushed by the sender thread in a lock-free delivery queue of the receiver, which
+             * drains it in its own thread, then the processes do not serialize on the delivery.
+             *
+             * The lookahead of a model is the minimum time between it receiving a message and generating an
+             * output, the lookahead of a logical process is the minimum among its models. The bigger the
+             * lookaheads and the weaker the coupling between processes, the more the processes advance alone.
+             *
+             * The busy time of each logical process is measured. When rebalancing is enabled, the runner checks
+             * the busy times every few rounds and moves engines of top model submodels from the busiest logical
+             * process to the least busy one, see set_rebalancing.
+             *
+             * @note The logical processes are run from different threads when using parallel_execution, then the
+             * LOGGER used must be thread safe, or the not_logger.
+             *
+             * @param TIME Representation of time to be used to run the simualtion
+             * @param LOGGER what, where and how to log from the simulation
+             * @param FEL the FEL used by the coordinators of the logical processes, see pdevs_dynamic_fel.hpp
+             * @param EXECUTION the policy used to run the logical processes, see pdevs_dynamic_execution.hpp
+             */
+            template<class TIME, typename LOGGER=default_logger<TIME>, typename FEL=cadmium::dynamic::engine::no_fel<TIME>, typename EXECUTION=cadmium::dynamic::engine::parallel_execution>
+            class conservative_runner {
+            public:
+                struct rebalance_options {
+                    std::size_t period = 0; // the rounds between two checks of the busy times, 0 disables rebalancing
+                    double tolerance = 0.1; // the busiest process takes at most (1 + tolerance) times the average busy time
+                    std::size_t max_migrations = 1; // the most engines moved by check
+                };
+
+                struct rebalance_statistics {
+                    std::size_t rounds = 0;
+                    std::size_t rebalances = 0; // checks that found the processes imbalanced
+                    std::size_t migrations = 0;
+                };
+
+            private:
+                using coordinator_type = cadmium::dynamic::engine::coordinator<TIME, LOGGER, FEL>;
+
+                // an IC of the top model, it crosses logical processes when its submodels are in different ones
+                struct cross_coupling {
+                    cadmium::dynamic::modeling::IC ic;
+                    std::size_t from_process;
+                    std::size_t from_engine;
+                    std::size_t to_process;
+                    std::size_t to_engine;
+
+                    bool crosses() const noexcept {
+                        return from_process != to_process;
+                    }
+                };
+
+                // the messages output at time in the from port of a cross coupling
+                struct timed_messages {
+                    TIME time;
+                    std::size_t coupling;
+                    std::uint64_t sequence; // the order the sender sent it
+                    cadmium::dynamic::message_bags bags;
+                };
+
+                struct logical_process {
+                    std::shared_ptr<coordinator_type> coordinator;
+                    TIME lookahead;
+                    std::vector<std::size_t> outputs; // cross couplings leaving the process
+                    std::vector<timed_messages> pending; // messages received not delivered yet
+                    delivery_queue<timed_messages> incoming; // messages sent in the current phase
+                    std::vector<timed_messages> received; // scratch list of the drained messages
+                    std::uint64_t sequence = 0;
+                    TIME earliest_output;
+                    TIME bound; // the process can run alone the events scheduled before bound
+                    std::chrono::nanoseconds busy{0};
+                    std::chrono::nanoseconds busy_at_check{0}; // busy time at the last rebalance check
+                };
+
+                std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> _model;
+                std::map<std::string, TIME> _lookaheads;
+                std::vector<cross_coupling> _couplings;
+                std::map<std::string, std::pair<std::size_t, std::size_t>> _location; // process and engine index of each submodel
+                std::map<std::string, std::vector<std::size_t>> _couplings_of; // the couplings of each submodel
+                std::vector<logical_process> _processes;
+                EXECUTION _execution;
+                TIME _next; //next scheduled event
+
+                rebalance_options _rebalance;
+                rebalance_statistics _rebalance_stats;
+                std::map<std::string, std::chrono::nanoseconds> _engine_costs; // profiled time of each engine at the last check
+
+                static TIME next_event(const logical_process& p) {
+                    TIME ret = p.coordinator->next();
+                    for (const auto& m : p.pending) {
+                        ret = std::min(ret, m.time);
+                    }
+                    return ret;
+                }
+
+                TIME global_next() const {
+                    TIME ret = std::numeric_limits<TIME>::infinity();
+                    for (const auto& p : _processes) {
+                        ret = std::min(ret, next_event(p));
+                    }
+                    return ret;
+                }
+
+                // collects the outputs at t and sends the ones for other logical processes
+                void collect_outputs(logical_process& p, const TIME& t) {
+                    p.coordinator->collect_outputs(t);
+                    for (std::size_t c : p.outputs) {
+                        const cross_coupling& coupling = _couplings[c];
+                        const auto& link = coupling.ic._link;
+                        const cadmium::dynamic::message_bags& outbox = p.coordinator->subengines()[coupling.from_engine]->outbox();
+                        if (link->has_messages(outbox)) {
+                            timed_messages m{t, c, p.sequence++, cadmium::dynamic::message_bags()};
+                            m.bags.emplace(link->from_port_key(), outbox.at(link->from_port_key()));
+                            _processes[coupling.to_process].incoming.push(std::move(m));
+                        }
+                    }
+                }
+
+                // places the messages received for t in the inboxes and advances the process to t
+                void advance_simulation(logical_process& p, const TIME& t) {
+                    for (const auto& m : p.pending) {
+                        if (m.time == t) {
+                            const cross_coupling& coupling = _couplings[m.coupling];
+                            coupling.ic._link->route_messages(m.bags, p.coordinator->subengines()[coupling.to_engine]->inbox(), false);
+                        }
+                    }
+                    p.pending.erase(
+                            std::remove_if(p.pending.begin(), p.pending.end(), [&t](const auto& m) { return m.time == t; }),
+                            p.pending.end()
+                    );
+                    p.coordinator->advance_simulation(t);
+                }
+
+                // moves the messages sent to the process to its pending ones, in sender process order and then
+                // in the order they were sent, so the inboxes are filled always in the same order
+                void receive_messages(logical_process& p) {
+                    p.incoming.drain([&p](timed_messages&& m) { p.received.push_back(std::move(m)); });
+                    if (p.received.empty()) {
+                        return;
+                    }
+                    std::sort(p.received.begin(), p.received.end(), [this](const auto& a, const auto& b) {
+                        std::size_t a_from = _couplings[a.coupling].from_process;
+                        std::size_t b_from = _couplings[b.coupling].from_process;
+                        return a_from != b_from ? a_from < b_from : a.sequence < b.sequence;
+                    });
+                    std::move(p.received.begin(), p.received.end(), std::back_inserter(p.pending));
+                    p.received.clear();
+                }
+
+                void compute_bounds(const TIME& t) {
+                    for (auto& p : _processes) {
+                        p.earliest_output = p.coordinator->next();
+                        for (const auto& m : p.pending) {
+                            p.earliest_output = std::min(p.earliest_output, m.time + p.lookahead);
+                        }
+                    }
+
+                    // the messages received also generate outputs, the earliest output times are propagated
+                    // through the cross couplings until they do not change
+                    bool changed = true;
+                    for (std::size_t i = 0; changed && i < _processes.size(); i++) {
+                        changed = false;
+                        for (const auto& from : _processes) {
+                            for (std::size_t c : from.outputs) {
+                                logical_process& to = _processes[_couplings[c].to_process];
+                                TIME received_output = from.earliest_output + to.lookahead;
+                                if (received_output < to.earliest_output) {
+                                    to.earliest_output = received_output;
+                                    changed = true;
+                                }
+                            }
+                        }
+                    }
+
+                    for (auto& p : _processes) {
+                        p.bound = t;
+                    }
+                    for (const auto& from : _processes) {
+                        for (std::size_t c : from.outputs) {
+                            logical_process& to = _processes[_couplings[c].to_process];
+                            to.bound = std::min(to.bound, from.earliest_output);
+                        }
+                    }
+                }
+
+                TIME lookahead_of(const logical_process& p) const {
+                    TIME ret = std::numeric_limits<TIME>::infinity();
+                    for (const auto& e : p.coordinator->subengines()) {
+                        auto it = _lookaheads.find(e->get_model_id());
+                        ret = std::min(ret, it == _lookaheads.end() ? TIME{} : it->second);
+                    }
+                    return ret;
+                }
+
+                // updates the process and engine index of the submodel in its couplings
+                void relocate(const std::string& model_id, std::size_t process, std::size_t engine) {
+                    _location[model_id] = std::make_pair(process, engine);
+                    for (std::size_t c : _couplings_of[model_id]) {
+                        cross_coupling& coupling = _couplings[c];
+                        if (coupling.ic._from == model_id) {
+                            coupling.from_process = process;
+                            coupling.from_engine = engine;
+                        }
+                        if (coupling.ic._to == model_id) {
+                            coupling.to_process = process;
+                            coupling.to_engine = engine;
+                        }
+                    }
+                }
+
+                /**
+                 * Moves the engine of a submodel to another logical process, between rounds, when all the messages
+                 * sent were received. The engine goes on with its state and times, it is not moved if the other
+                 * process is behind its process or ran past its next event or the messages it has to receive, nor
+                 * if it is the last engine of its process. Only the couplings of the moved engine are
+                 * changed: the coordinators patch their routing tables and the cross couplings are updated.
+                 * @return true if the engine was moved.
+                 */
+                bool move_engine(const std::string& model_id, std::size_t to) {
+                    const std::size_t from = _location.at(model_id).first;
+                    const std::size_t index = _location.at(model_id).second;
+                    logical_process& source = _processes[from];
+                    logical_process& target = _processes[to];
+                    if (from == to || source.coordinator->subengines().size() == 1) {
+                        return false;
+                    }
+                    // the coordinators advance their passive subengines too, the engine cannot go back in time
+                    const TIME target_last = target.coordinator->last();
+                    if (target_last < source.coordinator->last() || source.coordinator->subengines()[index]->next() < target_last) {
+                        return false;
+                    }
+                    for (const auto& m : source.pending) {
+                        if (_couplings[m.coupling].ic._to == model_id && m.time < target_last) {
+                            return false;
+                        }
+                    }
+
+                    // the couplings between the engine and other engines of the source are removed with it
+                    std::shared_ptr<cadmium::dynamic::engine::engine<TIME>> engine = source.coordinator->detach_subengine(model_id);
+                    if (index < source.coordinator->subengines().size()) {
+                        // the last engine of the source took the index of the moved one
+                        relocate(source.coordinator->subengines()[index]->get_model_id(), from, index);
+                    }
+
+                    std::vector<std::size_t> crossed;
+                    for (std::size_t c : _couplings_of[model_id]) {
+                        if (_couplings[c].crosses()) {
+                            crossed.push_back(c);
+                        }
+                    }
+                    relocate(model_id, to, target.coordinator->attach_subengine(engine));
+
+                    for (std::size_t c : _couplings_of[model_id]) {
+                        const cross_coupling& coupling = _couplings[c];
+                        bool was_crossing = std::find(crossed.begin(), crossed.end(), c) != crossed.end();
+                        if (was_crossing) {
+                            auto& outputs = _processes[coupling.ic._from == model_id ? from : coupling.from_process].outputs;
+                            outputs.erase(std::remove(outputs.begin(), outputs.end(), c), outputs.end());
+                        }
+                        if (coupling.crosses()) {
+                            _processes[coupling.from_process].outputs.push_back(c);
+                            _processes[coupling.to_process].coordinator->add_receiver(coupling.to_engine);
+                        } else {
+                            target.coordinator->add_coupling(coupling.ic);
+                        }
+                    }
+                    for (const auto& eic : _model->_eic) {
+                        if (eic._to == model_id) {
+                            target.coordinator->add_coupling(eic);
+                        }
+                    }
+                    for (const auto& eoc : _model->_eoc) {
+                        if (eoc._from == model_id) {
+                            target.coordinator->add_coupling(eoc);
+                        }
+                    }
+
+                    // the messages to be received by the moved engine go with it
+                    auto moved = std::stable_partition(source.pending.begin(), source.pending.end(), [this, from](const auto& m) {
+                        return _couplings[m.coupling].to_process == from;
+                    });
+                    std::move(moved, source.pending.end(), std::back_inserter(target.pending));
+                    source.pending.erase(moved, source.pending.end());
+
+                    source.lookahead = lookahead_of(source);
+                    target.lookahead = lookahead_of(target);
+                    _rebalance_stats.migrations++;
+                    return true;
+                }
+
+                // moves engines from the busiest process to the least busy one when they are imbalanced, the
+                // share of each engine in the busy time of its process is given by its profile
+                void rebalance() {
+                    std::vector<double> busy;
+                    for (auto& p : _processes) {
+                        busy.push_back(static_cast<double>((p.busy - p.busy_at_check).count()));
+                        p.busy_at_check = p.busy;
+                    }
+
+                    std::vector<model_profile> profiles;
+                    std::map<std::string, double> costs;
+                    for (const auto& p : _processes) {
+                        for (const auto& e : p.coordinator->subengines()) {
+                            profiles.clear();
+                            e->collect_profiles(profiles);
+                            std::chrono::nanoseconds total{0};
+                            for (const auto& mp : profiles) {
+                                total += mp.total_time();
+                            }
+                            std::chrono::nanoseconds& last = _engine_costs[e->get_model_id()];
+                            costs[e->get_model_id()] = static_cast<double>((total - last).count());
+                            last = total;
+                        }
+                    }
+
+                    std::size_t busiest = std::distance(busy.begin(), std::max_element(busy.begin(), busy.end()));
+                    std::size_t idlest = std::distance(busy.begin(), std::min_element(busy.begin(), busy.end()));
+                    double average = std::accumulate(busy.begin(), busy.end(), 0.0) / busy.size();
+                    if (busiest == idlest || busy[busiest] <= average * (1.0 + _rebalance.tolerance)) {
+                        return;
+                    }
+                    _rebalance_stats.rebalances++;
+
+                    std::vector<std::pair<double, std::string>> candidates;
+                    double total_cost = 0;
+                    for (const auto& e : _processes[busiest].coordinator->subengines()) {
+                        candidates.emplace_back(costs.at(e->get_model_id()), e->get_model_id());
+                        total_cost += candidates.back().first;
+                    }
+                    if (total_cost <= 0) {
+                        return;
+                    }
+                    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+                        return a.first != b.first ? a.first > b.first : a.second < b.second;
+                    });
+
+                    // the engines moved take at most half the difference, an engine too heavy would only move the imbalance
+                    double left = (busy[busiest] - busy[idlest]) / 2;
+                    std::size_t moved = 0;
+                    for (const auto& c : candidates) {
+                        double share = c.first / total_cost * busy[busiest];
+                        if (moved == _rebalance.max_migrations) {
+                            break;
+                        }
+                        if (share <= left && move_engine(c.second, idlest)) {
+                            left -= share;
+                            moved++;
+                        }
+                    }
+                }
+
+            public:
+                /**
+                 * @brief set the dynamic parameters for the simulation
+                 * @param coupled_model is the top model, its submodels are distributed in the logical processes.
+                 * @param init_time is the initial time of the simulation.
+                 * @param partitions are the ids of the top model submodels run by each logical process, each
+                 * submodel must be in exactly one partition.
+                 * @param lookaheads are the lookaheads of the top model submodels by id, zero if not defined.
+                 * @param execution is the execution policy used to run the logical processes.
+                 */
+                conservative_runner(
+                        std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> coupled_model,
+                        const TIME &init_time,
+                        const std::vector<std::vector<std::string>>& partitions,
+                        const std::map<std::string, TIME>& lookaheads = std::map<std::string, TIME>(),
+                        const EXECUTION& execution = EXECUTION()
+                ) : _model(coupled_model), _lookaheads(lookaheads), _execution(execution) {
+                    LOGGER::template log<cadmium::logger::logger_global_time, cadmium::logger::run_global_time>(init_time);
+                    LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Preparing model");
+
+                    std::map<std::string, std::shared_ptr<cadmium::dynamic::modeling::model>> models_by_id;
+                    for (const auto& m : coupled_model->_models) {
+                        models_by_id.insert(std::make_pair(m->get_id(), m));
+                    }
+
+                    for (std::size_t p = 0; p < partitions.size(); p++) {
+                        if (partitions[p].empty()) {
+                            throw std::domain_error("Empty partition for a logical process");
+                        }
+                        for (std::size_t e = 0; e < partitions[p].size(); e++) {
+                            if (models_by_id.find(partitions[p][e]) == models_by_id.end()) {
+                                throw std::domain_error("Partition with invalid model " + partitions[p][e]);
+                            }
+                            if (!_location.insert(std::make_pair(partitions[p][e], std::make_pair(p, e))).second) {
+                                throw std::domain_error("Model " + partitions[p][e] + " is in more than one partition");
+                            }
+                        }
+                    }
+                    if (_location.size() != models_by_id.size()) {
+                        throw std::domain_error("There are submodels not assigned to any partition");
+                    }
+
+                    for (std::size_t p = 0; p < partitions.size(); p++) {
+                        cadmium::dynamic::modeling::Models models;
+                        TIME lookahead = std::numeric_limits<TIME>::infinity();
+                        for (const auto& id : partitions[p]) {
+                            models.push_back(models_by_id.at(id));
+                            auto it = lookaheads.find(id);
+                            lookahead = std::min(lookahead, it == lookaheads.end() ? TIME{} : it->second);
+                        }
+
+                        cadmium::dynamic::modeling::EICs eics;
+                        for (const auto& eic : coupled_model->_eic) {
+                            if (_location.at(eic._to).first == p) {
+                                eics.push_back(eic);
+                            }
+                        }
+                        cadmium::dynamic::modeling::EOCs eocs;
+                        for (const auto& eoc : coupled_model->_eoc) {
+                            if (_location.at(eoc._from).first == p) {
+                                eocs.push_back(eoc);
+                            }
+                        }
+                        cadmium::dynamic::modeling::ICs ics;
+                        for (const auto& ic : coupled_model->_ic) {
+                            if (_location.at(ic._from).first == p && _location.at(ic._to).first == p) {
+                                ics.push_back(ic);
+                            }
+                        }
+
+                        auto process_model = std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
+                                coupled_model->get_id() + "[" + std::to_string(p) + "]",
+                                models,
+                                coupled_model->get_input_ports(),
+                                coupled_model->get_output_ports(),
+                                eics,
+                                eocs,
+                                ics,
+                                false // the links are a part of the checked ones
+                        );
+
+                        logical_process process;
+                        process.coordinator = std::make_shared<coordinator_type>(process_model);
+                        process.lookahead = lookahead;
+                        _processes.push_back(std::move(process));
+                    }
+
+                    for (const auto& ic : coupled_model->_ic) {
+                        auto from = _location.at(ic._from);
+                        auto to = _location.at(ic._to);
+                        _couplings_of[ic._from].push_back(_couplings.size());
+                        if (ic._to != ic._from) {
+                            _couplings_of[ic._to].push_back(_couplings.size());
+                        }
+                        if (from.first != to.first) {
+                            _processes[from.first].outputs.push_back(_couplings.size());
+                            _processes[to.first].coordinator->add_receiver(to.second);
+                        }
+                        _couplings.push_back(cross_coupling{ic, from.first, from.second, to.first, to.second});
+                    }
+
+                    for (auto& p : _processes) {
+                        p.coordinator->init(init_time);
+                    }
+                    _next = global_next();
+                }
+
+                /**
+                 * @brief runUntil starts the simulation and stops when the next event is scheduled after t.
+                 * @param t is the limit time for the simulation.
+                 * @return the TIME of the next event to happen when simulation stopped.
+                 */
+                TIME run_until(const TIME &t) {
+                    LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Starting run");
+                    while (_next < t) {
+                        LOGGER::template log<cadmium::logger::logger_global_time, cadmium::logger::run_global_time>(_next);
+                        const TIME now = _next;
+
+                        // all the processes with events at the lowest time are run together
+                        _execution.for_each_index(_processes.size(), [this, &now](std::size_t i) {
+                            if (_processes[i].coordinator->next() == now) {
+                                profile_timer timer(_processes[i].busy);
+                                this->collect_outputs(_processes[i], now);
+                            }
+                        });
+                        _execution.for_each_index(_processes.size(), [this, &now](std::size_t i) {
+                            profile_timer timer(_processes[i].busy);
+                            this->receive_messages(_processes[i]);
+                            if (next_event(_processes[i]) == now) {
+                                this->advance_simulation(_processes[i], now);
+                            }
+                        });
+
+                        // then each process runs alone the events no other process can interfere with
+                        compute_bounds(t);
+                        _execution.for_each_index(_processes.size(), [this](std::size_t i) {
+                            logical_process& p = _processes[i];
+                            profile_timer timer(p.busy);
+                            for (TIME e = next_event(p); e < p.bound; e = next_event(p)) {
+                                if (p.coordinator->next() == e) {
+                                    this->collect_outputs(p, e);
+                                }
+                                this->advance_simulation(p, e);
+                            }
+                        });
+                        _execution.for_each_index(_processes.size(), [this](std::size_t i) {
+                            this->receive_messages(_processes[i]);
+                        });
+                        // the bags left are in the process inboxes, the release is deferred until they are consumed
+                        cadmium::message_arena::instance().release();
+
+                        // all the messages sent were received, the engines can be moved
+                        _rebalance_stats.rounds++;
+                        if (_rebalance.period != 0 && _rebalance_stats.rounds % _rebalance.period == 0) {
+                            rebalance();
+                        }
+                        _next = global_next();
+                    }
+                    LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Finished run");
+                    return _next;
+                }
+
+                /**
+                 * @brief runUntilPassivate starts the simulation and stops when there is no next internal event to happen.
+                 */
+                void run_until_passivate() {
+                    run_until(std::numeric_limits<TIME>::infinity());
+                }
+
+                /**
+                 * @brief the number of logical processes.
+                 */
+                std::size_t processes() const noexcept {
+                    return _processes.size();
+                }
+
+                /**
+                 * @brief Enables the rebalancing of the logical processes, or disables it with a period of 0. The
+                 * coordinators of the logical processes are profiled to know the share of each engine in the
+                 * busy time of its process, the profiling is enabled with the rebalancing and left enabled.
+                 *
+                 * Every period rounds the busy times of the processes since the previous check are compared. If
+                 * the busiest process takes more than (1 + tolerance) times the average, its engines are moved
+                 * to the least busy process, the heaviest first, taking at most half the difference between their
+                 * busy times. The simulation results do not depend on the processes running each submodel.
+                 */
+                void set_rebalancing(const rebalance_options& options) {
+                    _rebalance = options;
+                    if (options.period != 0) {
+                        for (auto& p : _processes) {
+                            p.coordinator->set_profiling(true);
+                        }
+                    }
+                }
+
+                rebalance_statistics rebalance_stats() const noexcept {
+                    return _rebalance_stats;
+                }
+
+                /**
+                 * @brief The wall time the logical process spent stepping its coordinator and exchanging messages.
+                 */
+                std::chrono::nanoseconds busy_time(std::size_t process) const {
+                    return _processes.at(process).busy;
+                }
+
+                /**
+                 * @brief The logical process running a submodel of the top model.
+                 */
+                std::size_t process_of(const std::string& model_id) const {
+                    auto it = _location.find(model_id);
+                    if (it == _location.end()) {
+                        throw std::domain_error("Model " + model_id + " is not a submodel of the top model");
+                    }
+                    return it->second.first;
+                }
+
+                /**
+                 * @brief Moves a submodel to another logical process between runs, as the rebalancing does. It is
+                 * not moved if it is the last submodel of its process, or the other process is behind its process
+                 * or already ran past its next event or the messages it has to receive.
+                 * @return true if the submodel was moved.
+                 */
+                bool migrate(const std::string& model_id, std::size_t process) {
+                    process_of(model_id);
+                    if (process >= _processes.size()) {
+                        throw std::domain_error("Migrating to an invalid logical process");
+                    }
+                    return move_engine(model_id, process);
+                }
+            };
+        }
+    }
+}
+
+#endif //CADMIUM_PDEVS_DYNAMIC_CONSERVATIVE_RUNNER_HPP
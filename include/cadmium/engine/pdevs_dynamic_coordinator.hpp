@@ -27,31 +27,238 @@
 #ifndef CADMIUM_PDEVS_DYNAMIC_COORDINATOR_HPP
 #define CADMIUM_PDEVS_DYNAMIC_COORDINATOR_HPP
 
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <cadmium/modeling/dynamic_coupled.hpp>
 #include <cadmium/engine/pdevs_dynamic_simulator.hpp>
 #include <cadmium/engine/pdevs_dynamic_engine.hpp>
 #include <cadmium/modeling/dynamic_message_bag.hpp>
 #include <cadmium/logger/dynamic_common_loggers.hpp>
 #include <cadmium/engine/pdevs_dynamic_engine_helpers.hpp>
+#include <cadmium/engine/pdevs_dynamic_fel.hpp>
+#include <cadmium/engine/pdevs_dynamic_execution.hpp>
+#include <cadmium/engine/pdevs_dynamic_checkpoint.hpp>
 #include <cadmium/logger/common_loggers.hpp>
 
 namespace cadmium {
     namespace dynamic {
         namespace engine {
 
-            template<typename TIME, typename LOGGER>
+            template<typename TIME, typename LOGGER, typename FEL, typename EXECUTION>
+            class lazy_coordinator;
+
+            /**
+             * @brief The dynamic coordinator runs a dynamic coupled model.
+             *
+             * @tparam TIME - The simulation time type.
+             * @tparam LOGGER - The logger type used to log simulation information.
+             * @tparam FEL - The FEL type used to schedule the subengines, by default no FEL is used and all
+             * subengines are advanced on every step. The same FEL type is used by the subcoordinators.
+             * @tparam EXECUTION - The execution policy used to run the output functions and the transitions of
+             * the subengines, see pdevs_dynamic_execution.hpp. By default they are run sequentially.
+             *
+             * The coupled submodels marked as _lazy are run by a lazy_coordinator, which creates their coordinator
+             * when it is needed.
+             */
+            template<typename TIME, typename LOGGER, typename FEL=cadmium::dynamic::engine::no_fel<TIME>, typename EXECUTION=cadmium::dynamic::engine::sequential_execution>
             class coordinator : public cadmium::dynamic::engine::engine<TIME> {
 
+                using simulator_type = cadmium::dynamic::engine::simulator<TIME, LOGGER>;
+
                 //MODEL is assumed valid, the whole model tree is checked at "runner level" to fail fast
                 TIME _last; //last transition time
                 TIME _next; // next transition scheduled
 
                 std::string _model_id;
+                cadmium::dynamic::modeling::model_handle _model_handle;
+                bool _logged = true;
+                hierarchy_counters* _counters = nullptr;
+                allocation_counters* _allocations = nullptr;
+                std::size_t _level = 0;
+                // the settings given to the subengines added while running
+                std::unique_ptr<std::unordered_set<std::string>> _logged_models;
+                bool _profiling = false;
+                TIME _quantum = TIME();
+                state_store<TIME>* _store = nullptr;
 
                 subcoordinators_type<TIME> _subcoordinators;
+                subengine_dispatch<TIME, simulator_type> _dispatch{_subcoordinators}; // the steps call the subengines through it
                 external_couplings<TIME> _external_output_couplings;
                 external_couplings<TIME> _external_input_couplings;
                 internal_couplings<TIME> _internal_coupligns;
+                std::unordered_map<std::string, std::size_t> _indexes_by_id; // the index of each subengine
+
+                // the couplings resolved to the bag slots, they are routed in order. The table entries follow
+                // the links of the couplings, groups after groups, also when the structure is changed
+                routing_table _eoc_routing;
+                routing_table _eic_routing;
+                routing_table _ic_routing;
+                // the entries of the tables by destination port, made again when the structure is changed
+                routing_buckets _eoc_buckets;
+                routing_buckets _eic_buckets;
+                routing_buckets _ic_buckets;
+
+                FEL _fel;
+                EXECUTION _execution;
+                std::vector<std::size_t> _receivers; // subengines receiving messages placed in their inbox from outside
+                std::vector<std::size_t> _routed; // subengines the routing gave messages in the current step
+                std::vector<std::size_t> _active; // subengines visited in the current step
+                std::vector<std::size_t> _cascade; // subengines scheduled at _last, the imminents of the next steps at _last
+
+                // the routing profiles of the table entries, only when profiling
+                std::vector<link_profile> _eoc_profiles;
+                std::vector<link_profile> _eic_profiles;
+                std::vector<link_profile> _ic_profiles;
+
+                static link_profile* profiles_of(std::vector<link_profile>& profiles) noexcept {
+                    return profiles.empty() ? nullptr : profiles.data();
+                }
+
+                template<typename COUPLINGS>
+                static std::size_t couplings_bytes(const COUPLINGS& couplings) {
+                    std::size_t ret = couplings.capacity() * sizeof(typename COUPLINGS::value_type);
+                    for (const auto& c : couplings) {
+                        ret += c.second.capacity() * sizeof(c.second[0]);
+                        for (const auto& l : c.second) {
+                            ret += l->object_size();
+                        }
+                    }
+                    return ret;
+                }
+
+                // the atomic model of m if it is run by a simulator
+                static std::shared_ptr<cadmium::dynamic::modeling::atomic_abstract<TIME>> simulated_atomic(const std::shared_ptr<cadmium::dynamic::modeling::model>& m) {
+                    if (std::dynamic_pointer_cast<cadmium::dynamic::modeling::embedded_abstract<TIME>>(m) != nullptr ||
+                        std::dynamic_pointer_cast<cadmium::dynamic::modeling::coupled<TIME>>(m) != nullptr) {
+                        return nullptr;
+                    }
+                    return std::dynamic_pointer_cast<cadmium::dynamic::modeling::atomic_abstract<TIME>>(m);
+                }
+
+                static std::shared_ptr<cadmium::dynamic::engine::engine<TIME>> make_subengine(const std::shared_ptr<cadmium::dynamic::modeling::model>& m, const EXECUTION& execution) {
+                    std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> m_coupled = std::dynamic_pointer_cast<cadmium::dynamic::modeling::coupled<TIME>>(m);
+                    std::shared_ptr<cadmium::dynamic::modeling::atomic_abstract<TIME>> m_atomic = std::dynamic_pointer_cast<cadmium::dynamic::modeling::atomic_abstract<TIME>>(m);
+                    std::shared_ptr<cadmium::dynamic::modeling::embedded_abstract<TIME>> m_embedded = std::dynamic_pointer_cast<cadmium::dynamic::modeling::embedded_abstract<TIME>>(m);
+
+                    if (m_embedded != nullptr) {
+                        // the embedded models bring the engine simulating them
+                        return m_embedded->make_engine();
+                    } else if (m_coupled == nullptr) {
+                        if (m_atomic == nullptr) {
+                            throw std::domain_error("Invalid submodel is neither coupled nor atomic");
+                        }
+                        return std::make_shared<cadmium::dynamic::engine::simulator<TIME, LOGGER>>(m_atomic);
+                    } else {
+                        if (m_atomic != nullptr) {
+                            throw std::domain_error("Invalid submodel is defined as both coupled and atomic");
+                        }
+                        if (m_coupled->_lazy) {
+                            return std::make_shared<cadmium::dynamic::engine::lazy_coordinator<TIME, LOGGER, FEL, EXECUTION>>(m_coupled, execution);
+                        }
+                        return std::make_shared<cadmium::dynamic::engine::coordinator<TIME, LOGGER, FEL, EXECUTION>>(m_coupled, execution);
+                    }
+                }
+
+                std::size_t index_of(const std::string& model_id, const char* error) const {
+                    auto it = _indexes_by_id.find(model_id);
+                    if (it == _indexes_by_id.end()) {
+                        throw std::domain_error(error);
+                    }
+                    return it->second;
+                }
+
+                void update_routing_buckets() {
+                    _eoc_buckets = cadmium::dynamic::engine::make_routing_buckets(_eoc_routing);
+                    _eic_buckets = cadmium::dynamic::engine::make_routing_buckets(_eic_routing);
+                    _ic_buckets = cadmium::dynamic::engine::make_routing_buckets(_ic_routing);
+                }
+
+                // the move flags of the entries reading the same bag slot, they move if there is only one
+                static void update_moving_entries(routing_table& table, std::vector<link_profile>& profiles) {
+                    std::map<std::pair<const cadmium::dynamic::message_bags*, std::size_t>, std::size_t> readers;
+                    for (const auto& r : table) {
+                        readers[std::make_pair(r.from, r.from_slot)]++;
+                    }
+                    for (std::size_t i = 0; i < table.size(); i++) {
+                        table[i].move = readers.at(std::make_pair(table[i].from, table[i].from_slot)) == 1;
+                        if (!profiles.empty()) {
+                            profiles[i].moves = table[i].move;
+                        }
+                    }
+                }
+
+                // appends a coupling of a single link and its table entry, the table keeps the couplings order
+                template<typename COUPLING>
+                void append_link(const char* kind, std::vector<COUPLING>& couplings, COUPLING coupling, routing_table& table, const routing_entry& entry, std::vector<link_profile>& profiles) {
+                    couplings.push_back(std::move(coupling));
+                    table.push_back(entry);
+                    if (_profiling) {
+                        std::vector<COUPLING> added(1, couplings.back());
+                        if constexpr (std::is_same<COUPLING, internal_coupling<TIME>>::value) {
+                            profiles.push_back(cadmium::dynamic::engine::make_link_profiles<TIME>(_model_id, added, _subcoordinators, routing_table(1, entry)).front());
+                        } else {
+                            profiles.push_back(cadmium::dynamic::engine::make_link_profiles<TIME>(_model_id, kind, added, _subcoordinators, routing_table(1, entry)).front());
+                        }
+                    }
+                }
+
+                /**
+                 * Erases the links selected by removed, called with a coupling and one of its links, and their
+                 * table entries and profiles. The couplings left without links are erased.
+                 * @return the number of links erased.
+                 */
+                template<typename COUPLINGS, typename PREDICATE>
+                static std::size_t erase_links(COUPLINGS& couplings, routing_table& table, std::vector<link_profile>& profiles, PREDICATE removed) {
+                    std::size_t read = 0;
+                    std::size_t write = 0;
+                    std::size_t kept = 0;
+                    for (auto& c : couplings) {
+                        std::size_t kept_links = 0;
+                        for (auto& l : c.second) {
+                            if (!removed(c, *l)) {
+                                table[write] = table[read];
+                                if (!profiles.empty()) {
+                                    profiles[write] = std::move(profiles[read]);
+                                }
+                                c.second[kept_links++] = std::move(l);
+                                write++;
+                            }
+                            read++;
+                        }
+                        c.second.resize(kept_links);
+                        if (kept_links != 0) {
+                            couplings[kept++] = std::move(c);
+                        }
+                    }
+                    couplings.erase(couplings.begin() + kept, couplings.end());
+                    table.resize(write);
+                    if (!profiles.empty()) {
+                        profiles.resize(write);
+                    }
+                    return read - write;
+                }
+
+                // replaces the index from by to in the sorted indexes, dropping the index to
+                static void rename_index(std::vector<std::size_t>& indexes, std::size_t from, std::size_t to) {
+                    indexes.erase(std::remove(indexes.begin(), indexes.end(), to), indexes.end());
+                    std::replace(indexes.begin(), indexes.end(), from, to);
+                    std::sort(indexes.begin(), indexes.end());
+                }
+
+                static bool has_port(const cadmium::dynamic::message_bags& bags, const cadmium::dynamic::port_key& port) {
+                    return bags.slot_of(port) != cadmium::dynamic::message_bags::no_slot;
+                }
+
+                static bool same_ports(const link_abstract& l, const link_abstract& other) {
+                    return l.from_port_key() == other.from_port_key() && l.to_port_key() == other.to_port_key();
+                }
 
             public:
 
@@ -65,121 +272,529 @@ namespace cadmium {
                  */
                 coordinator() = delete;
 
-                coordinator(std::shared_ptr<model_type> coupled_model)
-                        : _model_id(coupled_model->get_id())
+                coordinator(std::shared_ptr<model_type> coupled_model, const EXECUTION& execution=EXECUTION())
+                        : _model_id(coupled_model->get_id()), _model_handle(cadmium::dynamic::modeling::intern_id(_model_id)), _execution(execution)
                 {
-
-                    std::map<std::string, std::shared_ptr<engine<TIME>>> enginges_by_id;
-
+                    cadmium::dynamic::port_registry::instance().check();
+                    _inbox = cadmium::dynamic::message_bags(coupled_model->get_input_ports());
+                    _outbox = cadmium::dynamic::message_bags(coupled_model->get_output_ports());
+
+                    // the simulators of the atomic submodels are allocated together in a pool, the subengines
+                    // share the ownership of the pool instead of owning each one its own heap node
+                    auto pool = std::make_shared<std::vector<simulator_type>>();
+                    pool->reserve(std::count_if(coupled_model->_models.begin(), coupled_model->_models.end(), [](const auto& m) {
+                        return simulated_atomic(m) != nullptr;
+                    }));
+                    _subcoordinators.reserve(coupled_model->_models.size());
+                    _indexes_by_id.reserve(coupled_model->_models.size());
                     for(auto& m : coupled_model->_models) {
-                        std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> m_coupled = std::dynamic_pointer_cast<cadmium::dynamic::modeling::coupled<TIME>>(m);
-                        std::shared_ptr<cadmium::dynamic::modeling::atomic_abstract<TIME>> m_atomic = std::dynamic_pointer_cast<cadmium::dynamic::modeling::atomic_abstract<TIME>>(m);
-
-                        if (m_coupled == nullptr) {
-                            if (m_atomic == nullptr) {
-                                throw std::domain_error("Invalid submodel is neither coupled nor atomic");
-                            }
-                            std::shared_ptr<cadmium::dynamic::engine::engine<TIME>> simulator = std::make_shared<cadmium::dynamic::engine::simulator<TIME, LOGGER>>(m_atomic);
-                            _subcoordinators.push_back(simulator);
+                        std::shared_ptr<cadmium::dynamic::modeling::atomic_abstract<TIME>> atomic = simulated_atomic(m);
+                        if (atomic != nullptr) {
+                            pool->emplace_back(atomic);
+                            _subcoordinators.emplace_back(pool, &pool->back());
                         } else {
-                            if (m_atomic != nullptr) {
-                                throw std::domain_error("Invalid submodel is defined as both coupled and atomic");
-                            }
-                            std::shared_ptr<cadmium::dynamic::engine::engine<TIME>> coordinator = std::make_shared<cadmium::dynamic::engine::coordinator<TIME, LOGGER>>(m_coupled);
-                            _subcoordinators.push_back(coordinator);
+                            _subcoordinators.push_back(make_subengine(m, _execution));
                         }
-
-                        enginges_by_id.insert(std::make_pair(_subcoordinators.back()->get_model_id(), _subcoordinators.back()));
+                        _indexes_by_id.emplace(_subcoordinators.back()->get_model_id(), _subcoordinators.size() - 1);
+                        _dispatch.update(_subcoordinators.size() - 1);
                     }
 
                     // Generates structures for direct access to external couplings to not iterate all coordinators each time.
-                    bool found;
+                    // The couplings are grouped by the indexes of their engines, each model id is hashed once by link.
+                    constexpr std::size_t no_group = std::numeric_limits<std::size_t>::max();
+                    auto index_of = [this](const std::string& model_id) {
+                        auto it = _indexes_by_id.find(model_id);
+                        return it == _indexes_by_id.end() ? no_group : it->second;
+                    };
+
+                    std::vector<std::size_t> eoc_groups(_subcoordinators.size(), no_group);
                     for (const auto& eoc : coupled_model->_eoc) {
-                        if (enginges_by_id.find(eoc._from) == enginges_by_id.end()) {
+                        std::size_t from = index_of(eoc._from);
+                        if (from == no_group) {
                             throw std::domain_error("External output coupling from invalid model");
                         }
 
-                        found = false;
-                        for (auto& coupling : _external_output_couplings) {
-                            if (coupling.first->get_model_id() == eoc._from) {
-                                coupling.second.push_back(eoc._link);
-                                found = true;
-                                break;
-                            }
-                        }
-
-                        if (!found) {
+                        if (eoc_groups[from] == no_group) {
+                            eoc_groups[from] = _external_output_couplings.size();
                             cadmium::dynamic::engine::external_coupling<TIME> new_eoc;
-                            new_eoc.first = enginges_by_id.at(eoc._from);
-                            new_eoc.second.push_back(eoc._link);
+                            new_eoc.first = from;
                             _external_output_couplings.push_back(new_eoc);
                         }
+                        _external_output_couplings[eoc_groups[from]].second.push_back(eoc._link);
                     }
 
+                    std::vector<std::size_t> eic_groups(_subcoordinators.size(), no_group);
                     for (const auto& eic : coupled_model->_eic) {
-                        if (enginges_by_id.find(eic._to) == enginges_by_id.end()) {
+                        std::size_t to = index_of(eic._to);
+                        if (to == no_group) {
                             throw std::domain_error("External input coupling to invalid model");
                         }
 
-                        found = false;
-                        for (auto& coupling : _external_input_couplings) {
-                            if (coupling.first->get_model_id() == eic._to) {
-                                coupling.second.push_back(eic._link);
-                                found = true;
-                                break;
-                            }
-                        }
-
-                        if (!found) {
+                        if (eic_groups[to] == no_group) {
+                            eic_groups[to] = _external_input_couplings.size();
                             cadmium::dynamic::engine::external_coupling<TIME> new_eic;
-                            new_eic.first = enginges_by_id.at(eic._to);
-                            new_eic.second.push_back(eic._link);
+                            new_eic.first = to;
                             _external_input_couplings.push_back(new_eic);
                         }
+                        _external_input_couplings[eic_groups[to]].second.push_back(eic._link);
                     }
 
+                    // the key of a pair of engines is from * engines + to
+                    std::unordered_map<std::size_t, std::size_t> ic_groups;
+                    ic_groups.reserve(coupled_model->_ic.size());
                     for (const auto& ic : coupled_model->_ic) {
-                        if (enginges_by_id.find(ic._from) == enginges_by_id.end() || enginges_by_id.find(ic._to) == enginges_by_id.end()) {
+                        std::size_t from = index_of(ic._from);
+                        std::size_t to = index_of(ic._to);
+                        if (from == no_group || to == no_group) {
                             throw std::domain_error("Internal coupling to invalid model");
                         }
 
-                        found = false;
-                        for (auto& coupling : _internal_coupligns) {
-                            if (coupling.first.first->get_model_id() == ic._from && coupling.first.second->get_model_id() == ic._to) {
-                                coupling.second.push_back(ic._link);
-                                found = true;
-                                break;
-                            }
-                        }
-
-                        if(!found) {
+                        auto group = ic_groups.emplace(from * _subcoordinators.size() + to, _internal_coupligns.size());
+                        if (group.second) {
                             cadmium::dynamic::engine::internal_coupling<TIME> new_ic;
-                            new_ic.first.first = enginges_by_id.at(ic._from);
-                            new_ic.first.second = enginges_by_id.at(ic._to);
-                            new_ic.second.push_back(ic._link);
+                            new_ic.first.first = from;
+                            new_ic.first.second = to;
                             _internal_coupligns.push_back(new_ic);
                         }
+                        _internal_coupligns[group.first->second].second.push_back(ic._link);
                     }
+
+                    std::vector<std::vector<bool>> moving_links = cadmium::dynamic::engine::find_moving_links<TIME>(_internal_coupligns);
+
+                    // the routing reports the subengines receiving messages, the passive ones are not visited otherwise
+                    _eoc_routing = cadmium::dynamic::engine::make_eoc_routing_table<TIME>(_external_output_couplings, _subcoordinators, _outbox);
+                    _eic_routing = cadmium::dynamic::engine::make_eic_routing_table<TIME>(_external_input_couplings, _subcoordinators, _inbox);
+                    _ic_routing = cadmium::dynamic::engine::make_ic_routing_table<TIME>(_internal_coupligns, _subcoordinators, moving_links);
+                    update_routing_buckets();
                 }
 
+                // the routing tables point to the boxes of this coordinator
+                coordinator(const coordinator&) = delete;
+                coordinator& operator=(const coordinator&) = delete;
+
                 /**
                  * @brief init function sets the start time
                  * @param initial_time is the start time
                  */
                 void init(TIME initial_time) override {
-                    LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::coor_info_init>(initial_time, _model_id);
+                    if (_logged) {
+                        LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::coor_info_init>(initial_time, _model_id);
+                    }
 
                     _last = initial_time;
                     //init all subcoordinators and find next transition time.
                     cadmium::dynamic::engine::init_subcoordinators<TIME>(initial_time, _subcoordinators);
-                    //find the one with the lowest next time
-                    _next = cadmium::dynamic::engine::min_next_in_subcoordinators<TIME>(_subcoordinators);
+                    //schedule them and find the one with the lowest next time
+                    cadmium::dynamic::engine::schedule_subcoordinators<TIME>(_dispatch, _fel);
+                    cadmium::dynamic::engine::find_cascading_subcoordinators<TIME>(initial_time, _dispatch, _cascade);
+                    _next = _fel.next();
                 }
 
-                std::string get_model_id() const override {
+                const std::string& get_model_id() const override {
                     return _model_id;
                 }
 
+                cadmium::dynamic::modeling::model_handle get_model_handle() const override {
+                    return _model_handle;
+                }
+
+                /**
+                 * @brief Sets the logged models of this coordinator and its subengines, the routing done by this
+                 * coordinator is logged with its own events.
+                 */
+                void set_logged_models(const std::unordered_set<std::string>& model_ids) override {
+                    _logged = model_ids.count(_model_id) != 0;
+                    _logged_models.reset(new std::unordered_set<std::string>(model_ids));
+                    for (auto& engine : _subcoordinators) {
+                        engine->set_logged_models(model_ids);
+                    }
+                }
+
+                void set_profiling(bool enabled) override {
+                    _profiling = enabled;
+                    if (enabled) {
+                        if (_eoc_profiles.empty() && _eic_profiles.empty() && _ic_profiles.empty()) {
+                            _eoc_profiles = cadmium::dynamic::engine::make_link_profiles<TIME>(_model_id, "EOC", _external_output_couplings, _subcoordinators, _eoc_routing);
+                            _eic_profiles = cadmium::dynamic::engine::make_link_profiles<TIME>(_model_id, "EIC", _external_input_couplings, _subcoordinators, _eic_routing);
+                            _ic_profiles = cadmium::dynamic::engine::make_link_profiles<TIME>(_model_id, _internal_coupligns, _subcoordinators, _ic_routing);
+                        }
+                    } else {
+                        _eoc_profiles.clear();
+                        _eic_profiles.clear();
+                        _ic_profiles.clear();
+                    }
+                    for (auto& engine : _subcoordinators) {
+                        engine->set_profiling(enabled);
+                    }
+                }
+
+                void collect_profiles(std::vector<model_profile>& profiles) const override {
+                    for (const auto& engine : _subcoordinators) {
+                        engine->collect_profiles(profiles);
+                    }
+                }
+
+                void collect_link_profiles(std::vector<link_profile>& profiles) const override {
+                    profiles.insert(profiles.end(), _eic_profiles.begin(), _eic_profiles.end());
+                    profiles.insert(profiles.end(), _ic_profiles.begin(), _ic_profiles.end());
+                    profiles.insert(profiles.end(), _eoc_profiles.begin(), _eoc_profiles.end());
+                    for (const auto& engine : _subcoordinators) {
+                        engine->collect_link_profiles(profiles);
+                    }
+                }
+
+                void set_counters(hierarchy_counters* counters, std::size_t level) override {
+                    _counters = counters;
+                    _level = level;
+                    for (auto& engine : _subcoordinators) {
+                        engine->set_counters(counters, level + 1);
+                    }
+                }
+
+                void set_allocation_counters(allocation_counters* counters, std::size_t level) override {
+                    _allocations = counters;
+                    _level = level;
+                    if (counters != nullptr) {
+                        counters->add_level(level);
+                    }
+                    for (auto& engine : _subcoordinators) {
+                        engine->set_allocation_counters(counters, level + 1);
+                    }
+                }
+
+                // the subengines quantize the next events they already scheduled, which are scheduled again
+                void set_time_quantum(const TIME& quantum) override {
+                    _quantum = quantum;
+                    for (auto& engine : _subcoordinators) {
+                        engine->set_time_quantum(quantum);
+                    }
+                    cadmium::dynamic::engine::schedule_subcoordinators<TIME>(_dispatch, _fel);
+                    cadmium::dynamic::engine::find_cascading_subcoordinators<TIME>(_last, _dispatch, _cascade);
+                    _next = _fel.next();
+                }
+
+                void set_state_store(state_store<TIME>* store) override {
+                    _store = store;
+                    for (auto& engine : _subcoordinators) {
+                        engine->set_state_store(store);
+                    }
+                }
+
+                void account_memory(memory_usage& usage, std::vector<model_memory>& coupled_models, std::size_t level) const override {
+                    std::size_t entry = coupled_models.size();
+                    coupled_models.push_back(model_memory{_model_id, level, memory_usage(), memory_usage()});
+
+                    memory_usage self;
+                    self.bags = _outbox.allocated_bytes() + _inbox.allocated_bytes();
+                    self.engines = sizeof(*this) + _subcoordinators.capacity() * sizeof(_subcoordinators[0])
+                            + (_receivers.capacity() + _routed.capacity() + _active.capacity() + _cascade.capacity()) * sizeof(std::size_t);
+                    self.links = (_eoc_routing.capacity() + _eic_routing.capacity() + _ic_routing.capacity()) * sizeof(routing_entry)
+                            + couplings_bytes(_external_output_couplings) + couplings_bytes(_external_input_couplings)
+                            + couplings_bytes(_internal_coupligns)
+                            + routing_buckets_bytes(_eoc_buckets) + routing_buckets_bytes(_eic_buckets) + routing_buckets_bytes(_ic_buckets);
+
+                    memory_usage subcoupled; // the coupled models below are accounted by their coordinators
+                    for (const auto& s : _subcoordinators) {
+                        std::size_t before = coupled_models.size();
+                        memory_usage sub;
+                        s->account_memory(sub, coupled_models, level + 1);
+                        (coupled_models.size() == before ? self : subcoupled) += sub;
+                    }
+                    coupled_models[entry].self = self;
+                    coupled_models[entry].total = self;
+                    coupled_models[entry].total += subcoupled;
+                    usage += coupled_models[entry].total;
+                }
+
+                void save_checkpoint(std::string& buffer) const override {
+                    checkpoint::write_engine(_model_id, _inbox, _outbox, buffer);
+                    checkpoint::write_value(_last, buffer);
+                    checkpoint::write_value(_next, buffer);
+                    for (const auto& engine : _subcoordinators) {
+                        engine->save_checkpoint(buffer);
+                    }
+                }
+
+                /**
+                 * @brief The FEL and the cascade of the subengines are rebuilt from their restored times.
+                 */
+                void restore_checkpoint(const char*& data, const char* end) override {
+                    checkpoint::read_engine(_model_id, data, end);
+                    _last = checkpoint::read_value<TIME>(data, end);
+                    _next = checkpoint::read_value<TIME>(data, end);
+                    for (auto& engine : _subcoordinators) {
+                        engine->restore_checkpoint(data, end);
+                    }
+                    cadmium::dynamic::engine::schedule_subcoordinators<TIME>(_dispatch, _fel);
+                    cadmium::dynamic::engine::find_cascading_subcoordinators<TIME>(_last, _dispatch, _cascade);
+                    _routed.clear();
+                    _active.clear();
+                }
+
+                /**
+                 * @brief The subengines in the same order than the coupled model submodels, used by the runners
+                 * routing messages between coordinators that do not share a parent coordinator.
+                 */
+                subcoordinators_type<TIME>& subengines() noexcept {
+                    return _subcoordinators;
+                }
+
+                /**
+                 * @brief Declares that the subengine will receive messages placed directly in its inbox from outside
+                 * this coordinator, so it is advanced when the inbox is not empty.
+                 * @param engine - The index of the subengine in subengines().
+                 */
+                void add_receiver(std::size_t engine) {
+                    auto it = std::lower_bound(_receivers.begin(), _receivers.end(), engine);
+                    if (it == _receivers.end() || *it != engine) {
+                        _receivers.insert(it, engine);
+                    }
+                }
+
+                // Structural changes, they are made between steps: after init or advance_simulation and before
+                // the next collect_outputs. The routing tables are patched in place and only the changed
+                // subengines are scheduled again, no other engine nor bag is rebuilt.
+                // The next time of the coordinator may change, the parent coordinator of a changed subcoordinator
+                // has to be told with reschedule_subengine. The coupled model the coordinator was built from
+                // is not changed.
+
+                /**
+                 * @brief Schedules again a subengine whose next time changed outside the steps of this coordinator.
+                 * @param engine - The index of the subengine in subengines().
+                 */
+                void reschedule_subengine(std::size_t engine) {
+                    TIME next = _subcoordinators.at(engine)->next();
+                    _fel.update(engine, next);
+                    auto it = std::lower_bound(_cascade.begin(), _cascade.end(), engine);
+                    bool in_cascade = it != _cascade.end() && *it == engine;
+                    if (next == _last && !in_cascade) {
+                        _cascade.insert(it, engine);
+                    } else if (next != _last && in_cascade) {
+                        _cascade.erase(it);
+                    }
+                    _next = _fel.next();
+                }
+
+                /**
+                 * @brief Adds a submodel, its engine is initialized at the last transition time of the coordinator.
+                 * It is appended to subengines() and it gets the logged models, profiling, counters, time quantum and state store settings.
+                 * @return the index of the new subengine.
+                 */
+                std::size_t add_submodel(const std::shared_ptr<cadmium::dynamic::modeling::model>& m) {
+                    if (_indexes_by_id.count(m->get_id()) != 0) {
+                        throw std::domain_error("Submodel " + m->get_id() + " already in coupled model " + _model_id);
+                    }
+                    std::shared_ptr<cadmium::dynamic::engine::engine<TIME>> engine = make_subengine(m, _execution);
+                    if (_logged_models) {
+                        engine->set_logged_models(*_logged_models);
+                    }
+                    if (_profiling) {
+                        engine->set_profiling(true);
+                    }
+                    if (_counters != nullptr) {
+                        engine->set_counters(_counters, _level + 1);
+                    }
+                    if (_allocations != nullptr) {
+                        engine->set_allocation_counters(_allocations, _level + 1);
+                    }
+                    engine->init(_last);
+                    if (TIME() < _quantum) {
+                        engine->set_time_quantum(_quantum);
+                    }
+                    if (_store != nullptr) {
+                        engine->set_state_store(_store);
+                    }
+                    return attach_subengine(engine);
+                }
+
+                /**
+                 * @brief Adds the running engine of a submodel detached from another coordinator, it keeps its state
+                 * and its times, then it cannot be scheduled before the last transition time of the coordinator.
+                 * It is appended to subengines(), it keeps the settings it had and no coupling is added.
+                 * @return the index of the new subengine.
+                 */
+                std::size_t attach_subengine(const std::shared_ptr<cadmium::dynamic::engine::engine<TIME>>& engine) {
+                    if (_indexes_by_id.count(engine->get_model_id()) != 0) {
+                        throw std::domain_error("Submodel " + engine->get_model_id() + " already in coupled model " + _model_id);
+                    }
+                    if (engine->next() < _last) {
+                        throw std::domain_error("Attaching submodel " + engine->get_model_id() + " scheduled before the last transition of " + _model_id);
+                    }
+
+                    std::size_t index = _subcoordinators.size();
+                    _subcoordinators.push_back(engine);
+                    _indexes_by_id.emplace(engine->get_model_id(), index);
+                    _dispatch.update(index);
+                    _fel.resize(_subcoordinators.size());
+                    reschedule_subengine(index);
+                    return index;
+                }
+
+                /**
+                 * @brief Removes a submodel and all its couplings, the messages left in its boxes are lost.
+                 * The last subengine takes its index in subengines().
+                 */
+                void remove_submodel(const std::string& model_id) {
+                    detach_subengine(model_id);
+                }
+
+                /**
+                 * @brief Removes a submodel and all its couplings as remove_submodel, but the engine is given back
+                 * running to be attached to another coordinator with attach_subengine.
+                 */
+                std::shared_ptr<cadmium::dynamic::engine::engine<TIME>> detach_subengine(const std::string& model_id) {
+                    std::size_t index = index_of(model_id, "Removing an invalid model");
+                    std::shared_ptr<cadmium::dynamic::engine::engine<TIME>> detached = _subcoordinators[index];
+
+                    erase_links(_external_output_couplings, _eoc_routing, _eoc_profiles, [index](const auto& c, const auto&) {
+                        return c.first == index;
+                    });
+                    if (erase_links(_external_input_couplings, _eic_routing, _eic_profiles, [index](const auto& c, const auto&) {
+                        return c.first == index;
+                    }) != 0) {
+                        update_moving_entries(_eic_routing, _eic_profiles);
+                    }
+                    if (erase_links(_internal_coupligns, _ic_routing, _ic_profiles, [index](const auto& c, const auto&) {
+                        return c.first.first == index || c.first.second == index;
+                    }) != 0) {
+                        update_moving_entries(_ic_routing, _ic_profiles);
+                    }
+
+                    std::size_t last = _subcoordinators.size() - 1;
+                    _indexes_by_id.erase(model_id);
+                    if (index != last) {
+                        _subcoordinators[index] = std::move(_subcoordinators[last]);
+                        _indexes_by_id[_subcoordinators[index]->get_model_id()] = index;
+                        for (routing_table* table : {&_eic_routing, &_ic_routing}) {
+                            for (auto& r : *table) {
+                                if (r.to_engine == last) {
+                                    r.to_engine = index;
+                                }
+                            }
+                        }
+                        auto rename = [last, index](std::size_t& engine) {
+                            if (engine == last) {
+                                engine = index;
+                            }
+                        };
+                        for (auto& c : _external_output_couplings) {
+                            rename(c.first);
+                        }
+                        for (auto& c : _external_input_couplings) {
+                            rename(c.first);
+                        }
+                        for (auto& c : _internal_coupligns) {
+                            rename(c.first.first);
+                            rename(c.first.second);
+                        }
+                        _fel.update(index, _subcoordinators[index]->next());
+                    }
+                    _subcoordinators.pop_back();
+                    _dispatch.update(index);
+                    _fel.update(last, std::numeric_limits<TIME>::infinity());
+                    _fel.resize(last);
+                    rename_index(_receivers, last, index);
+                    rename_index(_cascade, last, index);
+                    _routed.clear();
+                    _active.clear();
+                    _next = _fel.next();
+                    update_routing_buckets();
+                    return detached;
+                }
+
+                /**
+                 * @brief Adds a coupling of a link from the outbox of a submodel to the outbox of the coordinator.
+                 */
+                void add_coupling(const cadmium::dynamic::modeling::EOC& eoc) {
+                    std::size_t from = index_of(eoc._from, "External output coupling from invalid model");
+                    const auto& engine = _subcoordinators[from];
+                    if (!has_port(engine->outbox(), eoc._link->from_port_key()) || !has_port(_outbox, eoc._link->to_port_key())) {
+                        throw std::domain_error("External output coupling of invalid ports");
+                    }
+                    routing_entry entry = make_routing_entry(engine->outbox(), _outbox, *eoc._link, false);
+                    append_link("EOC", _external_output_couplings, external_coupling<TIME>(from, {eoc._link}), _eoc_routing, entry, _eoc_profiles);
+                    update_routing_buckets();
+                }
+
+                /**
+                 * @brief Adds a coupling of a link from the inbox of the coordinator to the inbox of a submodel.
+                 */
+                void add_coupling(const cadmium::dynamic::modeling::EIC& eic) {
+                    std::size_t to = index_of(eic._to, "External input coupling to invalid model");
+                    const auto& engine = _subcoordinators[to];
+                    if (!has_port(_inbox, eic._link->from_port_key()) || !has_port(engine->inbox(), eic._link->to_port_key())) {
+                        throw std::domain_error("External input coupling of invalid ports");
+                    }
+                    routing_entry entry = make_routing_entry(_inbox, engine->inbox(), *eic._link, false);
+                    entry.to_engine = to;
+                    append_link("EIC", _external_input_couplings, external_coupling<TIME>(to, {eic._link}), _eic_routing, entry, _eic_profiles);
+                    update_moving_entries(_eic_routing, _eic_profiles);
+                    update_routing_buckets();
+                }
+
+                /**
+                 * @brief Adds a coupling of a link from the outbox of a submodel to the inbox of another one.
+                 */
+                void add_coupling(const cadmium::dynamic::modeling::IC& ic) {
+                    std::size_t from = index_of(ic._from, "Internal coupling to invalid model");
+                    std::size_t to = index_of(ic._to, "Internal coupling to invalid model");
+                    const auto& from_engine = _subcoordinators[from];
+                    const auto& to_engine = _subcoordinators[to];
+                    if (!has_port(from_engine->outbox(), ic._link->from_port_key()) || !has_port(to_engine->inbox(), ic._link->to_port_key())) {
+                        throw std::domain_error("Internal coupling of invalid ports");
+                    }
+                    routing_entry entry = make_routing_entry(from_engine->outbox(), to_engine->inbox(), *ic._link, false);
+                    entry.to_engine = to;
+                    internal_coupling<TIME> coupling;
+                    coupling.first = std::make_pair(from, to);
+                    coupling.second.push_back(ic._link);
+                    append_link("IC", _internal_coupligns, std::move(coupling), _ic_routing, entry, _ic_profiles);
+                    update_moving_entries(_ic_routing, _ic_profiles);
+                    update_routing_buckets();
+                }
+
+                /**
+                 * @brief Removes the couplings of links between the same ports than the link of eoc.
+                 */
+                void remove_coupling(const cadmium::dynamic::modeling::EOC& eoc) {
+                    std::size_t from = index_of(eoc._from, "External output coupling from invalid model");
+                    if (erase_links(_external_output_couplings, _eoc_routing, _eoc_profiles, [from, &eoc](const auto& c, const auto& l) {
+                        return c.first == from && same_ports(l, *eoc._link);
+                    }) == 0) {
+                        throw std::domain_error("Removing an external output coupling not in the model");
+                    }
+                    update_routing_buckets();
+                }
+
+                /**
+                 * @brief Removes the couplings of links between the same ports than the link of eic.
+                 */
+                void remove_coupling(const cadmium::dynamic::modeling::EIC& eic) {
+                    std::size_t to = index_of(eic._to, "External input coupling to invalid model");
+                    if (erase_links(_external_input_couplings, _eic_routing, _eic_profiles, [to, &eic](const auto& c, const auto& l) {
+                        return c.first == to && same_ports(l, *eic._link);
+                    }) == 0) {
+                        throw std::domain_error("Removing an external input coupling not in the model");
+                    }
+                    update_moving_entries(_eic_routing, _eic_profiles);
+                    update_routing_buckets();
+                }
+
+                /**
+                 * @brief Removes the couplings of links between the same ports than the link of ic.
+                 */
+                void remove_coupling(const cadmium::dynamic::modeling::IC& ic) {
+                    std::size_t from = index_of(ic._from, "Internal coupling to invalid model");
+                    std::size_t to = index_of(ic._to, "Internal coupling to invalid model");
+                    if (erase_links(_internal_coupligns, _ic_routing, _ic_profiles, [from, to, &ic](const auto& c, const auto& l) {
+                        return c.first.first == from && c.first.second == to && same_ports(l, *ic._link);
+                    }) == 0) {
+                        throw std::domain_error("Removing an internal coupling not in the model");
+                    }
+                    update_moving_entries(_ic_routing, _ic_profiles);
+                    update_routing_buckets();
+                }
+
                 /**
                  * @brief Coordinator expected next internal transition time
                  */
@@ -187,6 +802,13 @@ namespace cadmium {
                     return _next;
                 }
 
+                /**
+                 * @brief Coordinator last transition time, the initial time before the first step
+                 */
+                TIME last() const noexcept {
+                    return _last;
+                }
+
                 /**
                  * @brief Collects outputs ready for output before advancing the simulation
                  * @param t time the simulation will be advanced to
@@ -195,20 +817,52 @@ namespace cadmium {
                  * @todo Merge the Collect output calls into the advance simulation as done with ICs and EICs routing
                  */
                 void collect_outputs(const TIME &t) override {
-                    LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::coor_info_collect>(t, _model_id);
+                    CADMIUM_TRACE_ZONE("coordinator_collect_outputs", &_model_id);
+                    hierarchy_counters::phase_scope phase(_counters, _level, coordinator_phase::collect);
+                    allocation_counters::phase_scope allocations(_allocations, _level, coordinator_phase::collect);
+                    if (_logged) {
+                        LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::coor_info_collect>(t, _model_id);
+                    }
 
                     //collecting if necessary
                     if (_next < t) {
                         throw std::domain_error("Trying to obtain output when not internal event is scheduled");
                     } else if (_next == t) {
                         //log EOC
-                        LOGGER::template log<cadmium::logger::logger_message_routing, cadmium::logger::coor_routing_eoc_collect>(t, _model_id);
+                        if (_logged) {
+                            LOGGER::template log<cadmium::logger::logger_message_routing, cadmium::logger::coor_routing_eoc_collect>(t, _model_id);
+                        }
 
-                        // Fill all outboxes and clean the inboxes in the lower levels recursively
-                        cadmium::dynamic::engine::collect_outputs_in_subcoordinators<TIME>(t, _subcoordinators);
+                        // Fill the outboxes of the imminent subengines in the lower levels recursively,
+                        // the others had their outbox cleaned when advanced and have nothing to output
+                        if (t == _last) {
+                            // a zero time cascade, the subengines scheduled at t by the last advance are the imminents
+                            _active.assign(_cascade.begin(), _cascade.end());
+                        } else {
+                            _active.clear();
+                            _fel.imminent(t, _active);
+                        }
+                        cadmium::dynamic::engine::collect_outputs_in_subcoordinators<TIME>(t, _dispatch, _active, _execution);
+
+                        // Use the EOC mapping to compose current level output, the outboxes are merged in
+                        // the EOC order once all of them are filled, then it does not depend on the policy
+                        // the outbox bags are cleared in place, they keep their capacity for the next outputs
+                        _outbox.clear();
+                        hierarchy_counters::phase_scope route(_counters, _level, coordinator_phase::route);
+                        allocation_counters::phase_scope route_allocations(_allocations, _level, coordinator_phase::route);
+                        cadmium::dynamic::engine::route_messages_by_buckets<LOGGER>(_eoc_routing, _eoc_buckets, _logged, profiles_of(_eoc_profiles));
+                    }
+                }
 
-                        // Use the EOC mapping to compose current level output
-                        _outbox = cadmium::dynamic::engine::collect_messages_by_eoc<TIME, LOGGER>(_external_output_couplings);
+                /**
+                 * @brief The number of imminent subengines in the last collect_outputs and the messages in their
+                 * outboxes, valid until advance_simulation is called.
+                 */
+                void last_outputs(std::uint64_t& imminents, std::uint64_t& messages) const {
+                    imminents = _active.size();
+                    messages = 0;
+                    for (std::size_t i : _active) {
+                        messages += cadmium::dynamic::engine::messages_count(_subcoordinators[i]->outbox());
                     }
                 }
 
@@ -232,31 +886,64 @@ namespace cadmium {
                  * @param t is the time the transition is expected to be run.
                  */
                 void advance_simulation(const TIME &t) override {
+                    CADMIUM_TRACE_ZONE("coordinator_advance_simulation", &_model_id);
+                    hierarchy_counters::phase_scope phase(_counters, _level, coordinator_phase::advance);
+                    allocation_counters::phase_scope allocations(_allocations, _level, coordinator_phase::advance);
                     //clean outbox because messages are routed before calling this function at a higher level
-                    _outbox = cadmium::dynamic::message_bags();
+                    _outbox.clear();
 
-                    LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::coor_info_advance>(_last, t, _model_id);
+                    if (_logged) {
+                        LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::coor_info_advance>(_last, t, _model_id);
+                    }
 
                     if (_next < t || t < _last ) {
                         throw std::domain_error("Trying to obtain output when out of the advance time scope");
                     } else {
 
+                        // a step at the time of the last one, only the subengines of the cascade can be imminent
+                        const bool cascade = t == _last;
+
                         //Route the messages standing in the outboxes to mapped inboxes following ICs and EICs
-                        LOGGER::template log<cadmium::logger::logger_message_routing, cadmium::logger::coor_routing_ic_collect>(t, _model_id);
-                        cadmium::dynamic::engine::route_internal_coupled_messages_on_subcoordinators<TIME, LOGGER>(_internal_coupligns);
+                        {
+                            hierarchy_counters::phase_scope route(_counters, _level, coordinator_phase::route);
+                            allocation_counters::phase_scope route_allocations(_allocations, _level, coordinator_phase::route);
+                            if (_logged) {
+                                LOGGER::template log<cadmium::logger::logger_message_routing, cadmium::logger::coor_routing_ic_collect>(t, _model_id);
+                            }
+                            std::vector<std::size_t>* routed = FEL::visit_all && !cascade ? nullptr : &_routed;
+                            cadmium::dynamic::engine::route_messages_by_buckets<LOGGER>(_ic_routing, _ic_buckets, _logged, profiles_of(_ic_profiles), routed);
 
-                        LOGGER::template log<cadmium::logger::logger_message_routing, cadmium::logger::coor_routing_eic_collect>(t, _model_id);
-                        cadmium::dynamic::engine::route_external_input_coupled_messages_on_subcoordinators<TIME, LOGGER>(_inbox, _external_input_couplings);
+                            if (_logged) {
+                                LOGGER::template log<cadmium::logger::logger_message_routing, cadmium::logger::coor_routing_eic_collect>(t, _model_id);
+                            }
+                            cadmium::dynamic::engine::route_messages_by_buckets<LOGGER>(_eic_routing, _eic_buckets, _logged, profiles_of(_eic_profiles), routed);
+                        }
 
-                        //recurse on advance_simulation
-                        cadmium::dynamic::engine::advance_simulation_in_subengines<TIME>(t, _subcoordinators);
+                        //recurse on advance_simulation, the policy returns when all subengines advanced
+                        if (FEL::visit_all && !cascade) {
+                            cadmium::dynamic::engine::advance_simulation_in_subengines<TIME>(t, _dispatch, _execution);
+                            cadmium::dynamic::engine::schedule_subcoordinators<TIME>(_dispatch, _fel);
+                            cadmium::dynamic::engine::find_cascading_subcoordinators<TIME>(t, _dispatch, _cascade);
+                        } else {
+                            // only imminent subengines and the ones receiving messages have something to do,
+                            // in a zero time cascade the imminents are known without looking at the FEL
+                            if (cascade) {
+                                cadmium::dynamic::engine::find_active_subcoordinators<TIME>(_cascade, _subcoordinators, _routed, _receivers, _active);
+                            } else {
+                                cadmium::dynamic::engine::find_active_subcoordinators<TIME>(t, _subcoordinators, _routed, _receivers, _fel, _active);
+                            }
+                            _routed.clear();
+                            cadmium::dynamic::engine::advance_simulation_in_subengines<TIME>(t, _dispatch, _active, _execution);
+                            cadmium::dynamic::engine::reschedule_subcoordinators<TIME>(_dispatch, _active, _fel);
+                            cadmium::dynamic::engine::find_cascading_subcoordinators<TIME>(t, _dispatch, _active, _cascade);
+                        }
 
                         //set _last and _next
                         _last = t;
-                        _next = cadmium::dynamic::engine::min_next_in_subcoordinators<TIME>(_subcoordinators);
+                        _next = _fel.next();
 
                         //clean inbox because they were processed already
-                        _inbox = cadmium::dynamic::message_bags();
+                        _inbox.clear();
                     }
                 }
             };
@@ -264,4 +951,6 @@ namespace cadmium {
     }
 }
 
+#include <cadmium/engine/pdevs_dynamic_lazy_coordinator.hpp>
+
 #endif //CADMIUM_PDEVS_DYNAMIC_COORDINATOR_HPP
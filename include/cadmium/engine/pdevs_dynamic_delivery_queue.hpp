@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_DELIVERY_QUEUE_HPP
+#define CADMIUM_PDEVS_DYNAMIC_DELIVERY_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief Lock-free multiple producers single consumer queue delivering values to an engine owned
+             * by another thread. The producers push with a compare and swap of the head of a list, the
+             * consumer takes the whole list at once, then it never races a producer on the same node.
+             *
+             * The values pushed by the same thread are drained in their push order, the values of different
+             * threads are interleaved in any order, the consumer sorts them if the order matters.
+             */
+            template<typename T>
+            class delivery_queue {
+                struct node {
+                    T value;
+                    node* next;
+                };
+
+                std::atomic<node*> _head{nullptr};
+
+                static void destroy(node* n) noexcept {
+                    while (n != nullptr) {
+                        node* next = n->next;
+                        delete n;
+                        n = next;
+                    }
+                }
+
+            public:
+                delivery_queue() = default;
+
+                delivery_queue(const delivery_queue&) = delete;
+                delivery_queue& operator=(const delivery_queue&) = delete;
+
+                // moving a queue is not thread safe, it is for the containers of queues built before the simulation
+                delivery_queue(delivery_queue&& other) noexcept
+                : _head(other._head.exchange(nullptr)) {}
+
+                ~delivery_queue() {
+                    destroy(_head.load(std::memory_order_relaxed));
+                }
+
+                void push(T value) {
+                    node* n = new node{std::move(value), _head.load(std::memory_order_relaxed)};
+                    while (!_head.compare_exchange_weak(n->next, n, std::memory_order_release, std::memory_order_relaxed)) {}
+                }
+
+                bool empty() const noexcept {
+                    return _head.load(std::memory_order_acquire) == nullptr;
+                }
+
+                /**
+                 * @brief Calls f with each value pushed so far, only the consumer thread drains the queue.
+                 * @return the number of values drained.
+                 */
+                template<typename F>
+                std::size_t drain(F&& f) {
+                    node* n = _head.exchange(nullptr, std::memory_order_acquire);
+                    // the list is in reverse push order
+                    node* reversed = nullptr;
+                    while (n != nullptr) {
+                        node* next = n->next;
+                        n->next = reversed;
+                        reversed = n;
+                        n = next;
+                    }
+                    std::size_t ret = 0;
+                    for (n = reversed; n != nullptr; ret++) {
+                        node* next = n->next;
+                        try {
+                            f(std::move(n->value));
+                        } catch (...) {
+                            destroy(n);
+                            throw;
+                        }
+                        delete n;
+                        n = next;
+                    }
+                    return ret;
+                }
+            };
+        }
+    }
+}
+
+#endif //CADMIUM_PDEVS_DYNAMIC_DELIVERY_QUEUE_HPP
@@ -0,0 +1,302 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_DISTRIBUTED_RUNNER_HPP
+#define CADMIUM_PDEVS_DYNAMIC_DISTRIBUTED_RUNNER_HPP
+
+#include <map>
+#include <vector>
+#include <limits>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include <cadmium/modeling/message_arena.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_communicator.hpp>
+#include <cadmium/engine/pdevs_dynamic_message_serializer.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief The distributed runner runs the simulation in several ranks, usually the processes of an MPI
+             * program. Every rank creates the same top model and runs with its own coordinator the submodels of its
+             * partition. The ICs between submodels of different ranks are remote links, the messages are serialized
+             * by the link in the sender rank and deserialized by the same link in the receiver rank, then the models
+             * do not change to be run distributed, but their message types need to be serializable, see
+             * pdevs_dynamic_message_serializer.hpp.
+             *
+             * The ranks advance the simulation at the same global time, in each step:
+             * - The ranks agree on the global next time, the lowest next time of all the ranks.
+             * - The ranks with imminent submodels collect their outputs and send the messages of the remote links.
+             * - The ranks with imminent submodels or receiving messages advance the simulation.
+             *
+             * @note The remote links are identified by their position in the top model ICs, then all the ranks must
+             * create the same model with the same partitions. The messages of a remote link are sent with the ids of
+             * its ports (see dynamic_port_key.hpp), which are the same in every binary, and the receiver checks them.
+             *
+             * @param TIME Representation of time to be used to run the simualtion, it must be serializable.
+             * @param COMMUNICATOR the communication between ranks, see pdevs_dynamic_communicator.hpp
+             * @param LOGGER what, where and how to log from the simulation of the rank
+             * @param FEL the FEL used by the coordinator of the rank, see pdevs_dynamic_fel.hpp
+             * @param EXECUTION the policy used by the coordinator of the rank, see pdevs_dynamic_execution.hpp
+             */
+            template<typename COMMUNICATOR, typename = void>
+            struct ranks_are_threads_of_one_process : std::false_type {};
+
+            template<typename COMMUNICATOR>
+            struct ranks_are_threads_of_one_process<COMMUNICATOR, std::void_t<decltype(COMMUNICATOR::threads_of_one_process)>>
+            : std::bool_constant<COMMUNICATOR::threads_of_one_process> {};
+
+            template<class TIME, typename COMMUNICATOR, typename LOGGER=default_logger<TIME>, typename FEL=cadmium::dynamic::engine::no_fel<TIME>, typename EXECUTION=cadmium::dynamic::engine::sequential_execution>
+            class distributed_runner {
+                using coordinator_type = cadmium::dynamic::engine::coordinator<TIME, LOGGER, FEL, EXECUTION>;
+
+                // an IC of the top model between submodels of different ranks
+                struct remote_link {
+                    std::size_t from_rank;
+                    std::size_t from_engine;
+                    std::size_t to_rank;
+                    std::size_t to_engine;
+                    std::shared_ptr<cadmium::dynamic::engine::link_abstract> link;
+                };
+
+                COMMUNICATOR _communicator;
+                std::shared_ptr<coordinator_type> _coordinator;
+                std::vector<remote_link> _links;
+                std::vector<std::size_t> _outputs; // remote links sending messages from this rank
+                TIME _next; //next scheduled event
+
+                TIME global_next() {
+                    std::string local_next;
+                    message_serializer<TIME>::write(std::vector<TIME>{_coordinator->next()}, local_next);
+
+                    TIME ret = std::numeric_limits<TIME>::infinity();
+                    for (const auto& data : _communicator.all_gather(local_next)) {
+                        std::vector<TIME> rank_next;
+                        const char* begin = data.data();
+                        message_serializer<TIME>::read(begin, data.data() + data.size(), rank_next);
+                        ret = std::min(ret, rank_next.at(0));
+                    }
+                    return ret;
+                }
+
+                // sends the outputs of the remote links and routes the received ones, returns true if some were received
+                bool exchange_messages(bool imminent) {
+                    std::vector<std::string> sent(_communicator.size());
+                    if (imminent) {
+                        for (std::size_t l : _outputs) {
+                            const remote_link& remote = _links[l];
+                            const cadmium::dynamic::message_bags& outbox = _coordinator->subengines()[remote.from_engine]->outbox();
+                            if (remote.link->has_messages(outbox)) {
+                                serialization::write_size(l, sent[remote.to_rank]);
+                                serialization::write_size(remote.link->from_port_key().id(), sent[remote.to_rank]);
+                                serialization::write_size(remote.link->to_port_key().id(), sent[remote.to_rank]);
+                                remote.link->serialize_messages(outbox, sent[remote.to_rank]);
+                            }
+                        }
+                    }
+
+                    bool received_messages = false;
+                    for (const auto& data : _communicator.all_to_all(std::move(sent))) {
+                        const char* it = data.data();
+                        const char* end = data.data() + data.size();
+                        while (it != end) {
+                            std::uint64_t l = serialization::read_size(it, end);
+                            if (l >= _links.size() || _links[l].to_rank != _communicator.rank()) {
+                                throw std::domain_error("Messages received for an invalid remote link");
+                            }
+                            const remote_link& remote = _links[l];
+                            std::uint64_t from_port = serialization::read_size(it, end);
+                            std::uint64_t to_port = serialization::read_size(it, end);
+                            if (from_port != remote.link->from_port_key().id() || to_port != remote.link->to_port_key().id()) {
+                                throw std::domain_error("Messages received for a remote link of other ports");
+                            }
+                            remote.link->deserialize_messages(it, end, _coordinator->subengines()[remote.to_engine]->inbox());
+                            received_messages = true;
+                        }
+                    }
+                    return received_messages;
+                }
+
+            public:
+                /**
+                 * @brief set the dynamic parameters for the simulation
+                 * @param coupled_model is the top model, its submodels are distributed in the ranks.
+                 * @param init_time is the initial time of the simulation.
+                 * @param communicator is the communicator of this rank.
+                 * @param partitions are the ids of the top model submodels run by each rank, indexed by rank. Each
+                 * submodel must be in exactly one partition.
+                 * @param execution is the execution policy used by the coordinator of this rank.
+                 */
+                distributed_runner(
+                        std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> coupled_model,
+                        const TIME &init_time,
+                        COMMUNICATOR communicator,
+                        const std::vector<std::vector<std::string>>& partitions,
+                        const EXECUTION& execution = EXECUTION()
+                ) : _communicator(std::move(communicator)) {
+                    LOGGER::template log<cadmium::logger::logger_global_time, cadmium::logger::run_global_time>(init_time);
+                    LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Preparing model");
+
+                    if (partitions.size() != _communicator.size()) {
+                        throw std::domain_error("There must be a partition by rank");
+                    }
+
+                    std::map<std::string, std::shared_ptr<cadmium::dynamic::modeling::model>> models_by_id;
+                    for (const auto& m : coupled_model->_models) {
+                        models_by_id.insert(std::make_pair(m->get_id(), m));
+                    }
+
+                    // rank and engine index of each submodel
+                    std::map<std::string, std::pair<std::size_t, std::size_t>> location;
+                    for (std::size_t r = 0; r < partitions.size(); r++) {
+                        for (std::size_t e = 0; e < partitions[r].size(); e++) {
+                            if (models_by_id.find(partitions[r][e]) == models_by_id.end()) {
+                                throw std::domain_error("Partition with invalid model " + partitions[r][e]);
+                            }
+                            if (!location.insert(std::make_pair(partitions[r][e], std::make_pair(r, e))).second) {
+                                throw std::domain_error("Model " + partitions[r][e] + " is in more than one partition");
+                            }
+                        }
+                    }
+                    if (location.size() != models_by_id.size()) {
+                        throw std::domain_error("There are submodels not assigned to any partition");
+                    }
+
+                    const std::size_t rank = _communicator.rank();
+                    cadmium::dynamic::modeling::Models models;
+                    for (const auto& id : partitions[rank]) {
+                        models.push_back(models_by_id.at(id));
+                    }
+                    cadmium::dynamic::modeling::EICs eics;
+                    for (const auto& eic : coupled_model->_eic) {
+                        if (location.at(eic._to).first == rank) {
+                            eics.push_back(eic);
+                        }
+                    }
+                    cadmium::dynamic::modeling::EOCs eocs;
+                    for (const auto& eoc : coupled_model->_eoc) {
+                        if (location.at(eoc._from).first == rank) {
+                            eocs.push_back(eoc);
+                        }
+                    }
+                    cadmium::dynamic::modeling::ICs ics;
+                    for (const auto& ic : coupled_model->_ic) {
+                        auto from = location.at(ic._from);
+                        auto to = location.at(ic._to);
+                        if (from.first == rank && to.first == rank) {
+                            ics.push_back(ic);
+                        } else if (from.first != to.first) {
+                            _links.push_back(remote_link{from.first, from.second, to.first, to.second, ic._link});
+                        }
+                    }
+
+                    auto rank_model = std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
+                            coupled_model->get_id() + "[" + std::to_string(rank) + "]",
+                            models,
+                            coupled_model->get_input_ports(),
+                            coupled_model->get_output_ports(),
+                            eics,
+                            eocs,
+                            ics,
+                            false // the links are a part of the checked ones
+                    );
+                    _coordinator = std::make_shared<coordinator_type>(rank_model, execution);
+
+                    for (std::size_t l = 0; l < _links.size(); l++) {
+                        if (_links[l].from_rank == rank) {
+                            _outputs.push_back(l);
+                        }
+                        if (_links[l].to_rank == rank) {
+                            _coordinator->add_receiver(_links[l].to_engine);
+                        }
+                    }
+
+                    _coordinator->init(init_time);
+                    _next = global_next();
+                }
+
+                /**
+                 * @brief runUntil starts the simulation and stops when the next event is scheduled after t.
+                 * All the ranks must call it with the same t.
+                 * @param t is the limit time for the simulation.
+                 * @return the TIME of the next event to happen when simulation stopped.
+                 */
+                TIME run_until(const TIME &t) {
+                    LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Starting run");
+                    while (_next < t) {
+                        LOGGER::template log<cadmium::logger::logger_global_time, cadmium::logger::run_global_time>(_next);
+                        bool imminent = _coordinator->next() == _next;
+                        if (imminent) {
+                            _coordinator->collect_outputs(_next);
+                        }
+                        if (exchange_messages(imminent) || imminent) {
+                            _coordinator->advance_simulation(_next);
+                        }
+                        // all the messages of the step were consumed, the in-process ranks step concurrently
+                        // and only release the arena of their own thread
+                        if constexpr (ranks_are_threads_of_one_process<COMMUNICATOR>::value) {
+                            cadmium::message_arena::instance().release_local();
+                        } else {
+                            cadmium::message_arena::instance().release();
+                        }
+                        _next = global_next();
+                    }
+                    LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Finished run");
+                    return _next;
+                }
+
+                /**
+                 * @brief runUntilPassivate starts the simulation and stops when there is no next internal event to happen.
+                 */
+                void run_until_passivate() {
+                    run_until(std::numeric_limits<TIME>::infinity());
+                }
+
+                /**
+                 * @brief the rank running this part of the simulation.
+                 */
+                std::size_t rank() const noexcept {
+                    return _communicator.rank();
+                }
+
+                /**
+                 * @brief the number of remote links of the top model, between submodels of different ranks.
+                 */
+                std::size_t remote_links() const noexcept {
+                    return _links.size();
+                }
+            };
+        }
+    }
+}
+
+#endif //CADMIUM_PDEVS_DYNAMIC_DISTRIBUTED_RUNNER_HPP
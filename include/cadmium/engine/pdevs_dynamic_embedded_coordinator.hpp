@@ -0,0 +1,202 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_EMBEDDED_COORDINATOR_HPP
+#define CADMIUM_PDEVS_DYNAMIC_EMBEDDED_COORDINATOR_HPP
+
+#include <stdexcept>
+#include <tuple>
+#include <string>
+#include <utility>
+#include <iterator>
+#include <boost/type_index.hpp>
+
+#include <cadmium/engine/pdevs_coordinator.hpp>
+#include <cadmium/engine/pdevs_dynamic_engine.hpp>
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+#include <cadmium/modeling/dynamic_models_helpers.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief The embedded coordinator runs a static coupled model as a single node of the dynamic engine.
+             * It wraps a cadmium::engine::coordinator, the whole subtree is simulated by the static engine and only
+             * the messages crossing its boundary are converted between its typed bags and the dynamic bags.
+             *
+             * The static coordinator logs through LOGGER by itself, the logged models selection and the profiling
+             * and hierarchy counters of the dynamic engine do not apply to the models of the subtree.
+             *
+             * @tparam MODEL - The static coupled model type.
+             * @tparam TIME - The simulation time type.
+             * @tparam LOGGER - The logger type used by the static coordinator.
+             */
+            template<template<typename T> class MODEL, typename TIME, typename LOGGER>
+            class embedded_coordinator : public engine<TIME> {
+                using coordinator_type=cadmium::engine::coordinator<MODEL, TIME, LOGGER>;
+                using input_ports=typename MODEL<TIME>::input_ports;
+                using output_ports=typename MODEL<TIME>::output_ports;
+
+                coordinator_type _coordinator;
+                std::string _model_id;
+
+                // the dynamic bags have a slot by port in the order of the ports tuple, the I-th slot is the I-th port
+                template<std::size_t I>
+                void move_input_messages() {
+                    using port_type=typename std::tuple_element<I, input_ports>::type;
+                    cadmium::dynamic::erased_bag& b = _inbox.slot(I);
+                    if (b.empty()) {
+                        return;
+                    }
+                    auto& from_messages = cadmium::dynamic::bag_cast<cadmium::message_bag<port_type>&>(b).messages;
+                    auto& to_messages = cadmium::get_messages<port_type>(_coordinator.inbox());
+                    to_messages.insert(to_messages.end(), std::make_move_iterator(from_messages.begin()), std::make_move_iterator(from_messages.end()));
+                }
+
+                template<std::size_t I>
+                void move_output_messages() {
+                    using port_type=typename std::tuple_element<I, output_ports>::type;
+                    auto& from_messages = cadmium::get_messages<port_type>(_coordinator.outbox());
+                    if (from_messages.empty()) {
+                        return;
+                    }
+                    auto& to_messages = _outbox.template get_bag_in_slot<cadmium::message_bag<port_type>>(I).messages;
+                    if (to_messages.empty()) {
+                        to_messages.swap(from_messages);
+                    } else {
+                        to_messages.insert(to_messages.end(), std::make_move_iterator(from_messages.begin()), std::make_move_iterator(from_messages.end()));
+                    }
+                    from_messages.clear();
+                }
+
+                template<std::size_t... Is>
+                void move_input_messages(std::index_sequence<Is...>) {
+                    (move_input_messages<Is>(), ...);
+                }
+
+                template<std::size_t... Is>
+                void move_output_messages(std::index_sequence<Is...>) {
+                    (move_output_messages<Is>(), ...);
+                }
+
+            public:
+
+                cadmium::dynamic::message_bags _inbox;
+                cadmium::dynamic::message_bags _outbox;
+
+                using model_type=MODEL<TIME>;
+
+                /**
+                 * @brief The model id is the name of the static model type, as the translated models have.
+                 */
+                embedded_coordinator()
+                : embedded_coordinator(boost::typeindex::type_id<MODEL<TIME>>().pretty_name()) {}
+
+                explicit embedded_coordinator(std::string model_id)
+                : _model_id(std::move(model_id)),
+                  _inbox(cadmium::dynamic::modeling::create_dynamic_ports<input_ports>()),
+                  _outbox(cadmium::dynamic::modeling::create_dynamic_ports<output_ports>()) {}
+
+                void init(TIME initial_time) override {
+                    _coordinator.init(initial_time);
+                }
+
+                const std::string& get_model_id() const override {
+                    return _model_id;
+                }
+
+                // the models of the subtree are logged by the static coordinator
+                void set_logged_models(const std::unordered_set<std::string>&) override {}
+
+                // the static engine is not profiled nor counted
+                void set_profiling(bool) override {}
+
+                void collect_profiles(std::vector<model_profile>&) const override {}
+
+                void collect_link_profiles(std::vector<link_profile>&) const override {}
+
+                void set_counters(hierarchy_counters*, std::size_t) override {}
+
+                /**
+                 * @brief The static coordinator keeps the whole subtree in place, its engines, bags and states are
+                 * accounted together as engines, the bags are the dynamic boundary bags.
+                 */
+                void account_memory(memory_usage& usage, std::vector<model_memory>& coupled_models, std::size_t level) const override {
+                    memory_usage self;
+                    self.bags = _outbox.allocated_bytes() + _inbox.allocated_bytes();
+                    self.engines = sizeof(*this);
+                    coupled_models.push_back(model_memory{_model_id, level, self, self});
+                    usage += self;
+                }
+
+                // the static engine keeps its times and states in the tuples of its coordinators
+                void save_checkpoint(std::string&) const override {
+                    throw std::domain_error("The embedded model " + _model_id + " can not be checkpointed");
+                }
+
+                void restore_checkpoint(const char*&, const char*) override {
+                    throw std::domain_error("The embedded model " + _model_id + " can not be checkpointed");
+                }
+
+                TIME next() const noexcept override {
+                    return _coordinator.next();
+                }
+
+                void collect_outputs(const TIME &t) override {
+                    _coordinator.collect_outputs(t);
+                    _outbox.clear();
+                    if (_coordinator.next() == t) {
+                        move_output_messages(std::make_index_sequence<std::tuple_size<output_ports>::value>{});
+                    }
+                }
+
+                /**
+                 * @brief outbox keeps the output generated by the last call to collect_outputs
+                 */
+                cadmium::dynamic::message_bags& outbox() override {
+                    return _outbox;
+                }
+
+                cadmium::dynamic::message_bags& inbox() override {
+                    return _inbox;
+                }
+
+                /**
+                 * @brief The input messages are moved to the inbox of the static coordinator, then it advances to t.
+                 */
+                void advance_simulation(const TIME &t) override {
+                    _outbox.clear();
+                    move_input_messages(std::make_index_sequence<std::tuple_size<input_ports>::value>{});
+                    _inbox.clear();
+                    _coordinator.advance_simulation(t);
+                }
+            };
+        }
+    }
+}
+
+#endif //CADMIUM_PDEVS_DYNAMIC_EMBEDDED_COORDINATOR_HPP
@@ -27,12 +27,59 @@
 #ifndef CADMIUM_PDEVS_DYNAMIC_ENGINE_HPP
 #define CADMIUM_PDEVS_DYNAMIC_ENGINE_HPP
 
+#include <cmath>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
 #include <cadmium/modeling/dynamic_message_bag.hpp>
+#include <cadmium/modeling/dynamic_id_table.hpp>
+#include <cadmium/engine/pdevs_dynamic_profile.hpp>
+#include <cadmium/engine/pdevs_dynamic_perf_counters.hpp>
+#include <cadmium/engine/pdevs_dynamic_allocations.hpp>
+#include <cadmium/engine/pdevs_dynamic_memory.hpp>
+#include <cadmium/engine/pdevs_dynamic_trace_zones.hpp>
 
 namespace cadmium {
     namespace dynamic {
         namespace engine {
 
+            template<typename TIME>
+            class state_store;
+
+            /**
+             * @brief The first time of the grid of step quantum at or after t, t itself when quantum is not
+             * positive or t is infinite. The times are never moved earlier, only up to one quantum later.
+             * The TIME types converting to and from double get the grid index by a division, the other ones
+             * add up the multiples of the quantum, and their times are expected not to be negative.
+             */
+            template<typename TIME>
+            TIME quantize_time(const TIME& t, const TIME& quantum) {
+                if (!(TIME() < quantum) || t == std::numeric_limits<TIME>::infinity()) {
+                    return t;
+                }
+                TIME ret = TIME();
+                if constexpr (std::is_constructible<double, TIME>::value && std::is_constructible<TIME, double>::value) {
+                    double k = std::floor(static_cast<double>(t) / static_cast<double>(quantum));
+                    ret = static_cast<TIME>(k * static_cast<double>(quantum));
+                } else {
+                    // the greatest multiple below t, adding the largest doubling of the quantum that fits each time
+                    while (ret + quantum < t) {
+                        TIME step = quantum;
+                        while (ret + step + step < t) {
+                            step = step + step;
+                        }
+                        ret = ret + step;
+                    }
+                }
+                // the division may round the grid index down by one
+                while (ret < t) {
+                    ret = ret + quantum;
+                }
+                return ret;
+            }
+
             /**
              * @brief Abstract class to allow pointer polymorphism between dynamic::coordinator
              * and dynamic::atomic
@@ -44,7 +91,82 @@ namespace cadmium {
             public:
                 virtual void init(TIME initial_time) = 0;
 
-                virtual std::string get_model_id() const = 0;
+                virtual const std::string& get_model_id() const = 0;
+
+                /**
+                 * @brief The handle of the model id in the id_table, the engines built from a model intern its
+                 * id once and keep the handle.
+                 */
+                virtual cadmium::dynamic::modeling::model_handle get_model_handle() const {
+                    return cadmium::dynamic::modeling::intern_id(get_model_id());
+                }
+
+                /**
+                 * @brief Logs only the events of the models with an id in model_ids, the engines of the other
+                 * models skip their log calls before formatting anything. Every model is logged by default.
+                 */
+                virtual void set_logged_models(const std::unordered_set<std::string>& model_ids) = 0;
+
+                /**
+                 * @brief Enables or disables the profiling of the atomic models, it is disabled by default.
+                 * Disabling it discards the profiles recorded.
+                 */
+                virtual void set_profiling(bool enabled) = 0;
+
+                /**
+                 * @brief Adds the profiles of the profiled atomic models to profiles.
+                 */
+                virtual void collect_profiles(std::vector<model_profile>& profiles) const = 0;
+
+                /**
+                 * @brief Adds the routing profiles of the links of the profiled coordinators to profiles.
+                 */
+                virtual void collect_link_profiles(std::vector<link_profile>& profiles) const = 0;
+
+                /**
+                 * @brief Counts the phases of the coordinators in counters, the coordinator of this engine is at
+                 * level of the hierarchy. Null counters disable the counting, the default.
+                 */
+                virtual void set_counters(hierarchy_counters* counters, std::size_t level) = 0;
+
+                /**
+                 * @brief Counts the heap allocations of the phases of the coordinators and of the simulators in
+                 * counters, see pdevs_dynamic_allocations.hpp, the coordinator of this engine is at level of the
+                 * hierarchy. Null counters disable the counting, the default. The engines not supporting it count
+                 * their allocations in the phases of their coordinator.
+                 */
+                virtual void set_allocation_counters(allocation_counters* counters, std::size_t level) {}
+
+                /**
+                 * @brief Schedules the next internal events of the atomic models at the first time of the grid of
+                 * step quantum after their time advance, see quantize_time, a zero quantum disables it, the default.
+                 * The engines not supporting it keep the exact times, which is the same simulation with less
+                 * events in the same steps.
+                 */
+                virtual void set_time_quantum(const TIME& quantum) {}
+
+                /**
+                 * @brief Pages the states of the atomic models in and out of store, see pdevs_dynamic_state_store.hpp,
+                 * nullptr keeps them in memory, the default. The engines not supporting it keep their states in memory.
+                 */
+                virtual void set_state_store(state_store<TIME>* store) {}
+
+                /**
+                 * @brief Adds the memory of this engine and its subengines to usage, and the memory of the
+                 * coupled models to coupled_models, the model of this engine is at level of the hierarchy.
+                 */
+                virtual void account_memory(memory_usage& usage, std::vector<model_memory>& coupled_models, std::size_t level) const = 0;
+
+                /**
+                 * @brief Appends to buffer the times of this engine and its subengines and the states of their
+                 * models, see pdevs_dynamic_checkpoint.hpp. It is called between steps, when the boxes are empty.
+                 */
+                virtual void save_checkpoint(std::string& buffer) const = 0;
+
+                /**
+                 * @brief Restores the times and states saved by save_checkpoint from data, and moves data after them.
+                 */
+                virtual void restore_checkpoint(const char*& data, const char* end) = 0;
 
                 virtual TIME next() const noexcept = 0;
 
@@ -31,7 +31,12 @@
 #include <cadmium/engine/pdevs_dynamic_engine.hpp>
 #include <cadmium/logger/common_loggers.hpp>
 
-#include <boost/any.hpp>
+#include <map>
+#include <vector>
+#include <utility>
+#include <typeindex>
+#include <limits>
+#include <algorithm>
 
 namespace cadmium {
     namespace dynamic {
@@ -43,8 +48,8 @@ namespace cadmium {
                     using bag_type = decltype(b);
                     using port_type = typename bag_type::port;
 
-                    if (dynamic_bag.find(typeid(port_type)) != dynamic_bag.cend()) {
-                        return boost::any_cast<bag_type>(dynamic_bag.at(typeid(port_type))).messages.empty();
+                    if (dynamic_bag.find(cadmium::dynamic::port_key::of<port_type>()) != dynamic_bag.cend()) {
+                        return cadmium::dynamic::bag_cast<const bag_type&>(dynamic_bag.at(cadmium::dynamic::port_key::of<port_type>())).messages.empty();
                     }
                     // A not declared bag in the dynamic_bag is the same as a bag with empty messages
                     return true;
@@ -62,19 +67,15 @@ namespace cadmium {
             using subcoordinators_type = typename std::vector<std::shared_ptr<cadmium::dynamic::engine::engine<TIME>>>;
             using external_port_couplings = typename std::map<std::string, std::vector<std::shared_ptr<cadmium::dynamic::engine::link_abstract>>>;
 
-            template<typename TIME>
-            using external_couplings = typename std::vector<
-                    std::pair<
-                            std::shared_ptr<cadmium::dynamic::engine::engine<TIME>>,
-                            std::vector<std::shared_ptr<cadmium::dynamic::engine::link_abstract>>
-                    >
-            >;
-
+            /**
+             * The couplings reference the subengines by their index in the subcoordinators of the coordinator,
+             * they do not share the ownership of the engines.
+             */
             template<typename TIME>
             using internal_coupling = std::pair<
                     std::pair<
-                            std::shared_ptr<cadmium::dynamic::engine::engine<TIME>>, // from model
-                            std::shared_ptr<cadmium::dynamic::engine::engine<TIME>> // to model
+                            std::size_t, // from model
+                            std::size_t // to model
                     >,
                     std::vector<std::shared_ptr<cadmium::dynamic::engine::link_abstract>>
             >;
@@ -84,13 +85,47 @@ namespace cadmium {
 
             template<typename TIME>
             using external_coupling = std::pair<
-                    std::shared_ptr<cadmium::dynamic::engine::engine<TIME>>,
+                    std::size_t,
                     std::vector<std::shared_ptr<cadmium::dynamic::engine::link_abstract>>
             >;
 
             template<typename TIME>
             using external_couplings = typename std::vector<external_coupling<TIME>>;
 
+            /**
+             * @brief Calls the subengines of a coordinator, the simulators through their final type SIMULATOR,
+             * then the calls to them are resolved at compile time and can be inlined in the loops over the
+             * subengines. The other engines are called through engine<TIME>.
+             */
+            template<typename TIME, typename SIMULATOR>
+            class subengine_dispatch {
+                const subcoordinators_type<TIME>& _engines;
+                std::vector<SIMULATOR*> _simulators; // by subengine index, nullptr for the other engines
+
+            public:
+                explicit subengine_dispatch(const subcoordinators_type<TIME>& engines) : _engines(engines) {}
+
+                /**
+                 * @brief Follows the subengines after the one at index i is added, replaced or removed.
+                 */
+                void update(std::size_t i) {
+                    _simulators.resize(_engines.size(), nullptr);
+                    if (i < _engines.size()) {
+                        _simulators[i] = dynamic_cast<SIMULATOR*>(_engines[i].get());
+                    }
+                }
+
+                std::size_t size() const noexcept {
+                    return _engines.size();
+                }
+
+                template<typename FUNC>
+                decltype(auto) visit(std::size_t i, FUNC&& f) const {
+                    SIMULATOR* simulator = _simulators[i];
+                    return simulator != nullptr ? f(*simulator) : f(*_engines[i]);
+                }
+            };
+
             template<typename TIME>
             void init_subcoordinators(TIME t, subcoordinators_type<TIME>& subcoordinators) {
                 auto init_coordinator = [&t](auto & c)->void { c->init(t); };
@@ -103,64 +138,577 @@ namespace cadmium {
                 std::for_each(subcoordinators.begin(), subcoordinators.end(), advance_time);
             }
 
+            template<typename TIME>
+            void advance_simulation_in_subengines(TIME t, subcoordinators_type<TIME>& subcoordinators, const std::vector<std::size_t>& engines) {
+                auto advance_time = [&t, &subcoordinators](std::size_t i)->void { subcoordinators[i]->advance_simulation(t); };
+                std::for_each(engines.begin(), engines.end(), advance_time);
+            }
+
+            /**
+             * @brief Advances the subengines using the EXECUTION policy, it returns when all of them advanced.
+             */
+            template<typename TIME, typename EXECUTION>
+            void advance_simulation_in_subengines(TIME t, subcoordinators_type<TIME>& subcoordinators, const EXECUTION& execution) {
+                auto advance_time = [&t, &subcoordinators](std::size_t i)->void { subcoordinators[i]->advance_simulation(t); };
+                execution.for_each_index(subcoordinators.size(), advance_time);
+            }
+
+            /**
+             * @brief Advances the subengines in engines using the EXECUTION policy, it returns when all of them advanced.
+             */
+            template<typename TIME, typename EXECUTION>
+            void advance_simulation_in_subengines(TIME t, subcoordinators_type<TIME>& subcoordinators, const std::vector<std::size_t>& engines, const EXECUTION& execution) {
+                auto advance_time = [&t, &subcoordinators, &engines](std::size_t i)->void { subcoordinators[engines[i]]->advance_simulation(t); };
+                execution.for_each_index(engines.size(), advance_time);
+            }
+
+            /**
+             * @brief Advances all the subengines of dispatch using the EXECUTION policy.
+             */
+            template<typename TIME, typename SIMULATOR, typename EXECUTION>
+            void advance_simulation_in_subengines(TIME t, const subengine_dispatch<TIME, SIMULATOR>& dispatch, const EXECUTION& execution) {
+                auto advance_time = [&t, &dispatch](std::size_t i)->void { dispatch.visit(i, [&t](auto& e) { e.advance_simulation(t); }); };
+                execution.for_each_index(dispatch.size(), advance_time);
+            }
+
+            /**
+             * @brief Advances the subengines of dispatch in engines using the EXECUTION policy.
+             */
+            template<typename TIME, typename SIMULATOR, typename EXECUTION>
+            void advance_simulation_in_subengines(TIME t, const subengine_dispatch<TIME, SIMULATOR>& dispatch, const std::vector<std::size_t>& engines, const EXECUTION& execution) {
+                auto advance_time = [&t, &dispatch, &engines](std::size_t i)->void { dispatch.visit(engines[i], [&t](auto& e) { e.advance_simulation(t); }); };
+                execution.for_each_index(engines.size(), advance_time);
+            }
+
             template<typename TIME>
             void collect_outputs_in_subcoordinators(TIME t, subcoordinators_type<TIME>& subcoordinators) {
                 auto collect_output = [&t](auto & c)->void { c->collect_outputs(t); };
                 std::for_each(subcoordinators.begin(), subcoordinators.end(), collect_output);
             }
 
+            template<typename TIME>
+            void collect_outputs_in_subcoordinators(TIME t, subcoordinators_type<TIME>& subcoordinators, const std::vector<std::size_t>& engines) {
+                auto collect_output = [&t, &subcoordinators](std::size_t i)->void { subcoordinators[i]->collect_outputs(t); };
+                std::for_each(engines.begin(), engines.end(), collect_output);
+            }
+
+            /**
+             * @brief Collects the outputs of the subengines in engines using the EXECUTION policy, it returns when
+             * all of them filled their outbox.
+             */
+            template<typename TIME, typename EXECUTION>
+            void collect_outputs_in_subcoordinators(TIME t, subcoordinators_type<TIME>& subcoordinators, const std::vector<std::size_t>& engines, const EXECUTION& execution) {
+                auto collect_output = [&t, &subcoordinators, &engines](std::size_t i)->void { subcoordinators[engines[i]]->collect_outputs(t); };
+                execution.for_each_index(engines.size(), collect_output);
+            }
+
+            /**
+             * @brief Collects the outputs of the subengines of dispatch in engines using the EXECUTION policy.
+             */
+            template<typename TIME, typename SIMULATOR, typename EXECUTION>
+            void collect_outputs_in_subcoordinators(TIME t, const subengine_dispatch<TIME, SIMULATOR>& dispatch, const std::vector<std::size_t>& engines, const EXECUTION& execution) {
+                auto collect_output = [&t, &dispatch, &engines](std::size_t i)->void { dispatch.visit(engines[i], [&t](auto& e) { e.collect_outputs(t); }); };
+                execution.for_each_index(engines.size(), collect_output);
+            }
+
+            /**
+             * @brief Tells if LOGGER logs the message routing, the links skip formatting the routed messages if not.
+             */
+            template<typename LOGGER>
+            using logs_routing = cadmium::logger::logs_source<LOGGER, cadmium::logger::logger_message_routing>;
+
+            template<typename LOGGER>
+            void log_routed_messages(const cadmium::dynamic::logger::routed_messages& message_to_log) {
+                if constexpr (logs_routing<LOGGER>::value) {
+                    LOGGER::template log<cadmium::logger::logger_message_routing, cadmium::logger::coor_routing_collect>(message_to_log.from_port, message_to_log.to_port, message_to_log.from_messages, message_to_log.to_messages);
+                }
+            }
+
+            /**
+             * @brief Routes the EOC messages in the bags of ret, the bags already in ret are kept.
+             */
             template<typename TIME, typename LOGGER>
-            cadmium::dynamic::message_bags collect_messages_by_eoc(const external_couplings<TIME>& coupling) {
-                cadmium::dynamic::message_bags ret;
-                auto collect_output = [&ret](auto & c)->void {
-                    cadmium::dynamic::message_bags outbox = c.first->outbox();
+            void collect_messages_by_eoc(const external_couplings<TIME>& coupling, const subcoordinators_type<TIME>& subcoordinators, cadmium::dynamic::message_bags& ret) {
+                auto collect_output = [&ret, &subcoordinators](auto & c)->void {
+                    const cadmium::dynamic::message_bags& outbox = subcoordinators[c.first]->outbox();
                     for (const auto& l : c.second) {
-                        cadmium::dynamic::logger::routed_messages message_to_log = l->route_messages(outbox, ret);
+                        cadmium::dynamic::logger::routed_messages message_to_log = l->route_messages(outbox, ret, logs_routing<LOGGER>::value);
 
-                        LOGGER::template log<cadmium::logger::logger_message_routing, cadmium::logger::coor_routing_collect>(message_to_log.from_port, message_to_log.to_port, message_to_log.from_messages, message_to_log.to_messages);
+                        log_routed_messages<LOGGER>(message_to_log);
                     }
                 };
                 std::for_each(coupling.begin(), coupling.end(), collect_output);
+            }
+
+            template<typename TIME, typename LOGGER>
+            cadmium::dynamic::message_bags collect_messages_by_eoc(const external_couplings<TIME>& coupling, const subcoordinators_type<TIME>& subcoordinators) {
+                cadmium::dynamic::message_bags ret;
+                collect_messages_by_eoc<TIME, LOGGER>(coupling, subcoordinators, ret);
                 return ret;
             }
 
             template<typename TIME, typename LOGGER>
-            void route_external_input_coupled_messages_on_subcoordinators(cadmium::dynamic::message_bags inbox, const external_couplings<TIME>& coupling) {
-                auto route_messages = [&inbox](auto & c)->void {
+            void route_external_input_coupled_messages_on_subcoordinators(const cadmium::dynamic::message_bags& inbox, const external_couplings<TIME>& coupling, const subcoordinators_type<TIME>& subcoordinators) {
+                auto route_messages = [&inbox, &subcoordinators](auto & c)->void {
                     for (const auto& l : c.second) {
-                        auto& to_inbox = c.first->inbox();
-                        cadmium::dynamic::logger::routed_messages message_to_log = l->route_messages(inbox, to_inbox);
+                        auto& to_inbox = subcoordinators[c.first]->inbox();
+                        cadmium::dynamic::logger::routed_messages message_to_log = l->route_messages(inbox, to_inbox, logs_routing<LOGGER>::value);
 
-                        LOGGER::template log<cadmium::logger::logger_message_routing, cadmium::logger::coor_routing_collect>(message_to_log.from_port, message_to_log.to_port, message_to_log.from_messages, message_to_log.to_messages);
+                        log_routed_messages<LOGGER>(message_to_log);
                     }
                 };
                 std::for_each(coupling.begin(), coupling.end(), route_messages);
             }
 
             template<typename TIME, typename LOGGER>
-            void route_internal_coupled_messages_on_subcoordinators(const internal_couplings<TIME>& coupling) {
-                auto route_messages = [](auto & c)->void {
+            void route_internal_coupled_messages_on_subcoordinators(const internal_couplings<TIME>& coupling, const subcoordinators_type<TIME>& subcoordinators) {
+                auto route_messages = [&subcoordinators](auto & c)->void {
                     for (const auto& l : c.second) {
-                        auto& from_outbox = c.first.first->outbox();
-                        auto& to_inbox = c.first.second->inbox();
-                        cadmium::dynamic::logger::routed_messages message_to_log = l->route_messages(from_outbox, to_inbox);
+                        auto& from_outbox = subcoordinators[c.first.first]->outbox();
+                        auto& to_inbox = subcoordinators[c.first.second]->inbox();
+                        cadmium::dynamic::logger::routed_messages message_to_log = l->route_messages(from_outbox, to_inbox, logs_routing<LOGGER>::value);
 
-                        LOGGER::template log<cadmium::logger::logger_message_routing, cadmium::logger::coor_routing_collect>(message_to_log.from_port, message_to_log.to_port, message_to_log.from_messages, message_to_log.to_messages);
+                        log_routed_messages<LOGGER>(message_to_log);
                     }
                 };
                 std::for_each(coupling.begin(), coupling.end(), route_messages);
             }
 
+            /**
+             * @brief Marks the IC links that are the only IC link reading their from port messages, they can move
+             * the messages instead of copying them. The EOCs read the outboxes before the ICs are routed, then they
+             * do not prevent moving the messages.
+             *
+             * @return a flag by link, with the same layout of the couplings.
+             */
+            template<typename TIME>
+            std::vector<std::vector<bool>> find_moving_links(const internal_couplings<TIME>& couplings) {
+                std::map<std::pair<std::size_t, cadmium::dynamic::port_key>, std::size_t> readers;
+                for (const auto& c : couplings) {
+                    for (const auto& l : c.second) {
+                        readers[std::make_pair(c.first.first, l->from_port_key())]++;
+                    }
+                }
+
+                std::vector<std::vector<bool>> ret;
+                for (const auto& c : couplings) {
+                    std::vector<bool> moving;
+                    for (const auto& l : c.second) {
+                        moving.push_back(readers.at(std::make_pair(c.first.first, l->from_port_key())) == 1);
+                    }
+                    ret.push_back(std::move(moving));
+                }
+                return ret;
+            }
+
+            /**
+             * @brief Routes the ICs messages moving them out of the outboxes for the links marked as moving.
+             */
+            template<typename TIME, typename LOGGER>
+            void route_internal_coupled_messages_on_subcoordinators(const internal_couplings<TIME>& coupling, const subcoordinators_type<TIME>& subcoordinators, const std::vector<std::vector<bool>>& moving) {
+                for (std::size_t c = 0; c < coupling.size(); c++) {
+                    auto& from_outbox = subcoordinators[coupling[c].first.first]->outbox();
+                    auto& to_inbox = subcoordinators[coupling[c].first.second]->inbox();
+                    for (std::size_t l = 0; l < coupling[c].second.size(); l++) {
+                        const auto& link = coupling[c].second[l];
+                        cadmium::dynamic::logger::routed_messages message_to_log = moving[c][l] ?
+                                link->move_messages(from_outbox, to_inbox, logs_routing<LOGGER>::value) :
+                                link->route_messages(from_outbox, to_inbox, logs_routing<LOGGER>::value);
+
+                        log_routed_messages<LOGGER>(message_to_log);
+                    }
+                }
+            }
+
+            /**
+             * @brief A link resolved to the slots of the bags it routes, the messages go from the bag in the
+             * from_slot of from to the bag in the to_slot of to. The link is kept alive by the couplings.
+             * The to_engine is the index of the subengine owning the to bags, no_engine for the EOCs.
+             */
+            struct routing_entry {
+                static constexpr std::size_t no_engine = static_cast<std::size_t>(-1);
+
+                cadmium::dynamic::message_bags* from;
+                std::size_t from_slot;
+                cadmium::dynamic::message_bags* to;
+                std::size_t to_slot;
+                const link_abstract* link;
+                bool move;
+                std::size_t to_engine = no_engine;
+            };
+
+            using routing_table = std::vector<routing_entry>;
+
+            inline routing_entry make_routing_entry(cadmium::dynamic::message_bags& from, cadmium::dynamic::message_bags& to, const link_abstract& link, bool move) {
+                return routing_entry{&from, from.ensure_slot(link.from_port_key()), &to, to.ensure_slot(link.to_port_key()), &link, move};
+            }
+
+            /**
+             * @brief The routing table of the EOCs, from the subengines outboxes to outbox.
+             */
+            template<typename TIME>
+            routing_table make_eoc_routing_table(const external_couplings<TIME>& couplings, const subcoordinators_type<TIME>& subcoordinators, cadmium::dynamic::message_bags& outbox) {
+                routing_table ret;
+                for (const auto& c : couplings) {
+                    for (const auto& l : c.second) {
+                        ret.push_back(make_routing_entry(subcoordinators[c.first]->outbox(), outbox, *l, false));
+                    }
+                }
+                return ret;
+            }
+
+            /**
+             * @brief The routing table of the EICs, from inbox to the subengines inboxes. The inbox is cleared
+             * once advanced, then the EICs that are the only EIC reading their port move the messages.
+             * The EOCs never move, the ICs and the runners read the subengines outboxes after them.
+             */
+            template<typename TIME>
+            routing_table make_eic_routing_table(const external_couplings<TIME>& couplings, const subcoordinators_type<TIME>& subcoordinators, cadmium::dynamic::message_bags& inbox) {
+                std::map<cadmium::dynamic::port_key, std::size_t> readers;
+                for (const auto& c : couplings) {
+                    for (const auto& l : c.second) {
+                        readers[l->from_port_key()]++;
+                    }
+                }
+
+                routing_table ret;
+                for (const auto& c : couplings) {
+                    for (const auto& l : c.second) {
+                        ret.push_back(make_routing_entry(inbox, subcoordinators[c.first]->inbox(), *l, readers.at(l->from_port_key()) == 1));
+                        ret.back().to_engine = c.first;
+                    }
+                }
+                return ret;
+            }
+
+            /**
+             * @brief The routing table of the ICs, the links marked in moving move the messages.
+             */
+            template<typename TIME>
+            routing_table make_ic_routing_table(const internal_couplings<TIME>& couplings, const subcoordinators_type<TIME>& subcoordinators, const std::vector<std::vector<bool>>& moving) {
+                routing_table ret;
+                for (std::size_t c = 0; c < couplings.size(); c++) {
+                    const auto& engines = couplings[c].first;
+                    for (std::size_t l = 0; l < couplings[c].second.size(); l++) {
+                        ret.push_back(make_routing_entry(subcoordinators[engines.first]->outbox(), subcoordinators[engines.second]->inbox(), *couplings[c].second[l], moving[c][l]));
+                        ret.back().to_engine = engines.second;
+                    }
+                }
+                return ret;
+            }
+
+            /**
+             * @brief The profiles of the links of couplings, in the order of the routing tables made from them.
+             * @param kind is EIC or EOC, the coupled model is on the from side of the EICs and the to side of the EOCs.
+             */
+            template<typename TIME>
+            std::vector<link_profile> make_link_profiles(const std::string& coupled_id, const std::string& kind, const external_couplings<TIME>& couplings, const subcoordinators_type<TIME>& subcoordinators, const routing_table& table) {
+                std::vector<link_profile> ret;
+                bool eic = kind == "EIC";
+                for (const auto& c : couplings) {
+                    for (const auto& l : c.second) {
+                        link_profile p;
+                        p.coupled_id = coupled_id;
+                        p.kind = kind;
+                        p.from_model = eic ? coupled_id : subcoordinators[c.first]->get_model_id();
+                        p.from_port = l->from_port_name();
+                        p.to_model = eic ? subcoordinators[c.first]->get_model_id() : coupled_id;
+                        p.to_port = l->to_port_name();
+                        p.moves = table[ret.size()].move;
+                        ret.push_back(std::move(p));
+                    }
+                }
+                return ret;
+            }
+
+            template<typename TIME>
+            std::vector<link_profile> make_link_profiles(const std::string& coupled_id, const internal_couplings<TIME>& couplings, const subcoordinators_type<TIME>& subcoordinators, const routing_table& table) {
+                std::vector<link_profile> ret;
+                for (const auto& c : couplings) {
+                    for (const auto& l : c.second) {
+                        link_profile p;
+                        p.coupled_id = coupled_id;
+                        p.kind = "IC";
+                        p.from_model = subcoordinators[c.first.first]->get_model_id();
+                        p.from_port = l->from_port_name();
+                        p.to_model = subcoordinators[c.first.second]->get_model_id();
+                        p.to_port = l->to_port_name();
+                        p.moves = table[ret.size()].move;
+                        ret.push_back(std::move(p));
+                    }
+                }
+                return ret;
+            }
+
+            // the messages in the slot, the slots without bag are told by the bitmask of the bags
+            inline std::size_t messages_in_slot(const cadmium::dynamic::message_bags& bags, std::size_t slot) {
+                return bags.may_have_bag(slot) ? bags.slot(slot).messages_size() : 0;
+            }
+
+            /**
+             * @brief Routes the messages of all the table entries in order, they are logged if log_messages is true.
+             * When the routing is neither logged nor profiled, the entries from a slot without bag are skipped.
+             * @param profiles are the profiles of the table entries to record the routing in, nullptr to not
+             * record it.
+             * @param receivers gets the to_engine of the entries routing messages, nullptr to not collect them.
+             * A subengine routed by several entries is added once by each one.
+             */
+            template<typename LOGGER>
+            void route_messages_by_table(const routing_table& table, bool log_messages = true, link_profile* profiles = nullptr, std::vector<std::size_t>* receivers = nullptr) {
+                CADMIUM_TRACE_ZONE("route_messages", nullptr);
+                bool log = logs_routing<LOGGER>::value && log_messages;
+                for (std::size_t i = 0; i < table.size(); i++) {
+                    const routing_entry& r = table[i];
+                    if (!log && profiles == nullptr && !r.from->may_have_bag(r.from_slot)) {
+                        continue;
+                    }
+                    if (receivers != nullptr && r.to_engine != routing_entry::no_engine && messages_in_slot(*r.from, r.from_slot) != 0) {
+                        receivers->push_back(r.to_engine);
+                    }
+                    auto route = [&r, log] {
+                        return r.move ?
+                                r.link->move_messages_in_slots(*r.from, r.from_slot, *r.to, r.to_slot, log) :
+                                r.link->route_messages_in_slots(*r.from, r.from_slot, *r.to, r.to_slot, log);
+                    };
+                    if (profiles == nullptr) {
+                        cadmium::dynamic::logger::routed_messages message_to_log = route();
+                        if (log) {
+                            log_routed_messages<LOGGER>(message_to_log);
+                        }
+                    } else {
+                        link_profile& p = profiles[i];
+                        std::uint64_t messages = messages_in_slot(*r.from, r.from_slot);
+                        cadmium::dynamic::logger::routed_messages message_to_log = timed(p.time, route);
+                        p.routings++;
+                        p.messages += messages;
+                        p.bytes_copied += r.move ? 0 : messages * r.link->message_size();
+                        if (log) {
+                            log_routed_messages<LOGGER>(message_to_log);
+                        }
+                    }
+                }
+            }
+
+            /**
+             * @brief The entries of a routing table giving messages to the same port bag, in table order.
+             */
+            struct routing_bucket {
+                cadmium::dynamic::message_bags* to;
+                std::size_t to_slot;
+                std::size_t to_engine;
+                std::vector<std::size_t> entries;
+            };
+
+            using routing_buckets = std::vector<routing_bucket>;
+
+            /**
+             * @brief Groups the entries of a table by the port bag they route to, the buckets follow the order of
+             * their first entry. They must be made again when the table changes.
+             */
+            inline routing_buckets make_routing_buckets(const routing_table& table) {
+                routing_buckets ret;
+                std::map<std::pair<const cadmium::dynamic::message_bags*, std::size_t>, std::size_t> buckets;
+                for (std::size_t i = 0; i < table.size(); i++) {
+                    const routing_entry& r = table[i];
+                    auto inserted = buckets.emplace(std::make_pair(r.to, r.to_slot), ret.size());
+                    if (inserted.second) {
+                        ret.push_back(routing_bucket{r.to, r.to_slot, r.to_engine, {}});
+                    }
+                    ret[inserted.first->second].entries.push_back(i);
+                }
+                return ret;
+            }
+
+            inline std::size_t routing_buckets_bytes(const routing_buckets& buckets) {
+                std::size_t ret = buckets.capacity() * sizeof(routing_bucket);
+                for (const auto& b : buckets) {
+                    ret += b.entries.capacity() * sizeof(std::size_t);
+                }
+                return ret;
+            }
+
+            /**
+             * @brief Routes the messages of the table bucket after bucket. Each destination port gets the
+             * messages of all its links at once: the buckets with no message are skipped, the destination bag
+             * makes room once for the messages of all the links of a high fan-in port, and its subengine
+             * is added once to receivers.
+             *
+             * The messages of a port are appended in the table order, as route_messages_by_table does. Only
+             * the order between different ports changes, then when the routing is logged or profiled the
+             * table is routed entry by entry to keep the lines and the profiles of the entries.
+             */
+            template<typename LOGGER>
+            void route_messages_by_buckets(const routing_table& table, const routing_buckets& buckets, bool log_messages = true, link_profile* profiles = nullptr, std::vector<std::size_t>* receivers = nullptr) {
+                if ((logs_routing<LOGGER>::value && log_messages) || profiles != nullptr) {
+                    route_messages_by_table<LOGGER>(table, log_messages, profiles, receivers);
+                    return;
+                }
+                CADMIUM_TRACE_ZONE("route_messages", nullptr);
+                for (const routing_bucket& b : buckets) {
+                    std::size_t messages = 0;
+                    std::size_t sources = 0;
+                    for (std::size_t i : b.entries) {
+                        std::size_t n = messages_in_slot(*table[i].from, table[i].from_slot);
+                        messages += n;
+                        sources += n != 0;
+                    }
+                    if (messages == 0) {
+                        continue;
+                    }
+                    if (sources > 1) {
+                        table[b.entries.front()].link->reserve_messages_in_slot(*b.to, b.to_slot, messages);
+                    }
+                    for (std::size_t i : b.entries) {
+                        const routing_entry& r = table[i];
+                        if (!r.from->may_have_bag(r.from_slot)) {
+                            continue;
+                        }
+                        if (r.move) {
+                            r.link->move_messages_in_slots(*r.from, r.from_slot, *r.to, r.to_slot, false);
+                        } else {
+                            r.link->route_messages_in_slots(*r.from, r.from_slot, *r.to, r.to_slot, false);
+                        }
+                    }
+                    if (receivers != nullptr && b.to_engine != routing_entry::no_engine) {
+                        receivers->push_back(b.to_engine);
+                    }
+                }
+            }
+
+            // the lowest next time of the subcoordinators, infinity if there is none
             template<typename TIME>
             TIME min_next_in_subcoordinators(const subcoordinators_type<TIME>& subcoordinators) {
-                std::vector<TIME> next_times(subcoordinators.size());
-                std::transform(
-                        subcoordinators.cbegin(),
-                        subcoordinators.cend(),
-                        next_times.begin(),
-                        [] (const auto& c) -> TIME { return c->next(); }
-                );
-                return *std::min_element(next_times.begin(), next_times.end());
+                TIME ret = std::numeric_limits<TIME>::infinity();
+                for (const auto& c : subcoordinators) {
+                    ret = std::min(ret, c->next());
+                }
+                return ret;
+            }
+
+            /**
+             * @brief Fills the FEL with the next times of all the subcoordinators.
+             */
+            template<typename TIME, typename FEL>
+            void schedule_subcoordinators(const subcoordinators_type<TIME>& subcoordinators, FEL& fel) {
+                fel.reset(subcoordinators.size());
+                for (std::size_t i = 0; i < subcoordinators.size(); i++) {
+                    fel.update(i, subcoordinators[i]->next());
+                }
+            }
+
+            /**
+             * @brief Updates in the FEL the next times of the subcoordinators in engines, the ones that just advanced.
+             */
+            template<typename TIME, typename FEL>
+            void reschedule_subcoordinators(const subcoordinators_type<TIME>& subcoordinators, const std::vector<std::size_t>& engines, FEL& fel) {
+                for (std::size_t i : engines) {
+                    fel.update(i, subcoordinators[i]->next());
+                }
+            }
+
+            template<typename TIME, typename SIMULATOR, typename FEL>
+            void schedule_subcoordinators(const subengine_dispatch<TIME, SIMULATOR>& dispatch, FEL& fel) {
+                fel.reset(dispatch.size());
+                for (std::size_t i = 0; i < dispatch.size(); i++) {
+                    fel.update(i, dispatch.visit(i, [](auto& e) { return e.next(); }));
+                }
+            }
+
+            template<typename TIME, typename SIMULATOR, typename FEL>
+            void reschedule_subcoordinators(const subengine_dispatch<TIME, SIMULATOR>& dispatch, const std::vector<std::size_t>& engines, FEL& fel) {
+                for (std::size_t i : engines) {
+                    fel.update(i, dispatch.visit(i, [](auto& e) { return e.next(); }));
+                }
+            }
+
+            // adds to active the subcoordinators receiving messages in this step, without repeating them
+            template<typename TIME>
+            void add_receiving_subcoordinators(const subcoordinators_type<TIME>& subcoordinators, const std::vector<std::size_t>& routed, const std::vector<std::size_t>& receivers, std::vector<std::size_t>& active) {
+                std::size_t imminents = active.size();
+                active.insert(active.end(), routed.begin(), routed.end());
+                for (std::size_t i : receivers) {
+                    if (!subcoordinators[i]->inbox().empty()) {
+                        active.push_back(i);
+                    }
+                }
+                if (active.size() != imminents) {
+                    std::sort(active.begin(), active.end());
+                    active.erase(std::unique(active.begin(), active.end()), active.end());
+                }
+            }
+
+            /**
+             * @brief Replaces the content of active with the indexes of the subcoordinators that must
+             * advance the simulation at t: the imminent ones and the ones with messages in the inbox.
+             * The passive subcoordinators are not visited, only the ones the routing gave messages are added.
+             *
+             * @param routed - the indexes of the subcoordinators the routing of this step gave messages.
+             * @param receivers - the indexes of the subcoordinators receiving messages placed in their inbox
+             * from outside the coordinator, their inbox is checked.
+             */
+            template<typename TIME, typename FEL>
+            void find_active_subcoordinators(const TIME& t, const subcoordinators_type<TIME>& subcoordinators, const std::vector<std::size_t>& routed, const std::vector<std::size_t>& receivers, const FEL& fel, std::vector<std::size_t>& active) {
+                active.clear();
+                fel.imminent(t, active);
+                add_receiving_subcoordinators<TIME>(subcoordinators, routed, receivers, active);
+            }
+
+            /**
+             * @brief Replaces the content of active with the imminent subcoordinators, already known, and the
+             * ones receiving messages, as find_active_subcoordinators does with the imminents of a FEL.
+             */
+            template<typename TIME>
+            void find_active_subcoordinators(const std::vector<std::size_t>& imminent, const subcoordinators_type<TIME>& subcoordinators, const std::vector<std::size_t>& routed, const std::vector<std::size_t>& receivers, std::vector<std::size_t>& active) {
+                active.assign(imminent.begin(), imminent.end());
+                add_receiving_subcoordinators<TIME>(subcoordinators, routed, receivers, active);
+            }
+
+            /**
+             * @brief Replaces the content of cascade with the subcoordinators in engines scheduled at t, the
+             * ones starting a zero time cascade. The other subcoordinators are not imminent in the next steps
+             * at t until they receive messages.
+             */
+            template<typename TIME>
+            void find_cascading_subcoordinators(const TIME& t, const subcoordinators_type<TIME>& subcoordinators, const std::vector<std::size_t>& engines, std::vector<std::size_t>& cascade) {
+                cascade.clear();
+                for (std::size_t i : engines) {
+                    if (subcoordinators[i]->next() == t) {
+                        cascade.push_back(i);
+                    }
+                }
+            }
+
+            /**
+             * @brief Replaces the content of cascade with all the subcoordinators scheduled at t.
+             */
+            template<typename TIME>
+            void find_cascading_subcoordinators(const TIME& t, const subcoordinators_type<TIME>& subcoordinators, std::vector<std::size_t>& cascade) {
+                cascade.clear();
+                for (std::size_t i = 0; i < subcoordinators.size(); i++) {
+                    if (subcoordinators[i]->next() == t) {
+                        cascade.push_back(i);
+                    }
+                }
+            }
+
+            template<typename TIME, typename SIMULATOR>
+            void find_cascading_subcoordinators(const TIME& t, const subengine_dispatch<TIME, SIMULATOR>& dispatch, const std::vector<std::size_t>& engines, std::vector<std::size_t>& cascade) {
+                cascade.clear();
+                for (std::size_t i : engines) {
+                    if (dispatch.visit(i, [](auto& e) { return e.next(); }) == t) {
+                        cascade.push_back(i);
+                    }
+                }
+            }
+
+            template<typename TIME, typename SIMULATOR>
+            void find_cascading_subcoordinators(const TIME& t, const subengine_dispatch<TIME, SIMULATOR>& dispatch, std::vector<std::size_t>& cascade) {
+                cascade.clear();
+                for (std::size_t i = 0; i < dispatch.size(); i++) {
+                    if (dispatch.visit(i, [](auto& e) { return e.next(); }) == t) {
+                        cascade.push_back(i);
+                    }
+                }
             }
         }
     }
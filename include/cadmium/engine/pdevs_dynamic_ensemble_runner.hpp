@@ -0,0 +1,276 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_ENSEMBLE_RUNNER_HPP
+#define CADMIUM_PDEVS_DYNAMIC_ENSEMBLE_RUNNER_HPP
+
+#include <map>
+#include <cmath>
+#include <mutex>
+#include <tuple>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <optional>
+#include <typeindex>
+#include <algorithm>
+#include <functional>
+#include <exception>
+#include <stdexcept>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief Keeps one link object by link type and ports, the replications of a model share them.
+             *
+             * The links do not change once made and route the messages of their ports only, the links of a
+             * same type between the same ports are interchangeable, a composed link included as its from and
+             * to ports carry the same message type.
+             */
+            class link_pool {
+                using key = std::tuple<std::type_index, cadmium::dynamic::port_key, cadmium::dynamic::port_key>;
+
+                std::map<key, std::shared_ptr<link_abstract>> _links;
+                std::size_t _reused = 0;
+
+                void intern(std::shared_ptr<link_abstract>& l) {
+                    const link_abstract& ref = *l;
+                    auto inserted = _links.emplace(key(typeid(ref), l->from_port_key(), l->to_port_key()), l);
+                    if (!inserted.second) {
+                        l = inserted.first->second;
+                        _reused++;
+                    }
+                }
+
+            public:
+                /**
+                 * @brief Replaces the links of the coupled models of the hierarchy by the links of the pool,
+                 * adding the ones it has not yet.
+                 */
+                template<typename TIME>
+                void share(const std::shared_ptr<cadmium::dynamic::modeling::model>& m) {
+                    auto c = std::dynamic_pointer_cast<cadmium::dynamic::modeling::coupled<TIME>>(m);
+                    if (c == nullptr) {
+                        return;
+                    }
+                    for (auto& eic : c->_eic) {
+                        intern(eic._link);
+                    }
+                    for (auto& eoc : c->_eoc) {
+                        intern(eoc._link);
+                    }
+                    for (auto& ic : c->_ic) {
+                        intern(ic._link);
+                    }
+                    for (const auto& sub : c->_models) {
+                        share<TIME>(sub);
+                    }
+                }
+
+                // the distinct links
+                std::size_t size() const noexcept {
+                    return _links.size();
+                }
+
+                // the links replaced by one of the pool
+                std::size_t reused() const noexcept {
+                    return _reused;
+                }
+            };
+
+            /**
+             * @brief The mean, variance and extremes of a result over the replications.
+             */
+            struct replication_statistics {
+                std::size_t count = 0;
+                double mean = 0;
+                double variance = 0; // the sample variance
+                double min = 0;
+                double max = 0;
+
+                // the half width of the confidence interval of the mean by the normal approximation
+                double confidence_half_width(double z = 1.96) const noexcept {
+                    return count < 2 ? 0 : z * std::sqrt(variance / count);
+                }
+            };
+
+            template<typename IT>
+            replication_statistics summarize(IT first, IT last) {
+                replication_statistics s;
+                double m2 = 0;
+                for (; first != last; ++first) {
+                    double x = static_cast<double>(*first);
+                    s.count++;
+                    s.min = s.count == 1 ? x : std::min(s.min, x);
+                    s.max = s.count == 1 ? x : std::max(s.max, x);
+                    // Welford's update, stable for the large replication counts
+                    double delta = x - s.mean;
+                    s.mean += delta / s.count;
+                    m2 += delta * (x - s.mean);
+                }
+                s.variance = s.count < 2 ? 0 : m2 / (s.count - 1);
+                return s;
+            }
+
+            /**
+             * @brief The ensemble runner runs replications of a model concurrently, each in its own runner.
+             *
+             * The factory makes the model of each replication, for instance seeding its random generators with
+             * the replication number, and it is never called concurrently. The links of each model are replaced by
+             * the links of the first replications made, then all the replications share their link objects, while the
+             * routing tables, bags and states point to the engines of each one and are built by each runner.
+             *
+             * The threads take the next replication as they finish one, and each replication runs in a single
+             * thread with a sequential execution, releasing only the message arena of its thread between steps.
+             * The observer reads the result of a replication from its runner when the run stops, it is called
+             * concurrently from the threads.
+             *
+             * @param TIME Representation of time to be used to run the simulation
+             * @param LOGGER what, where and how to log from the replications, by default nothing as the
+             * replications would interleave their logs
+             * @param FEL the FEL used by the coordinators of the replications, see pdevs_dynamic_fel.hpp
+             */
+            template<class TIME, typename LOGGER=cadmium::logger::not_logger, typename FEL=cadmium::dynamic::engine::no_fel<TIME>>
+            class ensemble_runner {
+            public:
+                using model_factory = std::function<std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>>(std::size_t)>;
+                using runner_type = cadmium::dynamic::engine::runner<TIME, LOGGER, FEL, cadmium::dynamic::engine::sequential_execution>;
+
+            private:
+                model_factory _factory;
+                std::size_t _replications;
+                TIME _init_time;
+                std::size_t _threads;
+                std::mutex _mutex; // guards the factory calls and the link pool
+                link_pool _links;
+
+                std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> make_model(std::size_t replication) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    auto m = _factory(replication);
+                    if (m == nullptr) {
+                        throw std::domain_error("The model factory of an ensemble returned no model");
+                    }
+                    _links.share<TIME>(m);
+                    return m;
+                }
+
+                template<typename RUN, typename OBSERVER>
+                auto run(RUN run_replication, OBSERVER& observe) {
+                    using result_type = decltype(observe(std::declval<runner_type&>(), std::size_t()));
+                    std::vector<std::optional<result_type>> results(_replications);
+                    std::atomic<std::size_t> next{0};
+                    std::exception_ptr error;
+                    std::mutex error_mutex;
+
+                    auto work = [&]() {
+                        for (std::size_t i = next++; i < _replications; i = next++) {
+                            try {
+                                runner_type r(make_model(i), _init_time);
+                                r.set_local_arena_release(true);
+                                run_replication(r);
+                                results[i].emplace(observe(r, i));
+                            } catch (...) {
+                                std::lock_guard<std::mutex> lock(error_mutex);
+                                if (!error) {
+                                    error = std::current_exception();
+                                }
+                                // the other threads stop after their current replication
+                                next = _replications;
+                            }
+                        }
+                    };
+
+                    std::vector<std::thread> workers;
+                    for (std::size_t i = 1; i < std::min(_threads, _replications); i++) {
+                        workers.emplace_back(work);
+                    }
+                    work();
+                    for (auto& w : workers) {
+                        w.join();
+                    }
+                    if (error) {
+                        std::rethrow_exception(error);
+                    }
+                    std::vector<result_type> ret;
+                    ret.reserve(_replications);
+                    for (auto& r : results) {
+                        ret.push_back(std::move(*r));
+                    }
+                    return ret;
+                }
+
+            public:
+                /**
+                 * @brief set the replications of the ensemble
+                 * @param factory makes the model of each replication from its number.
+                 * @param replications is the number of replications.
+                 * @param init_time is the initial time of every replication.
+                 * @param threads is the number of replications run concurrently, all the cores by default.
+                 */
+                ensemble_runner(model_factory factory, std::size_t replications, const TIME& init_time,
+                                std::size_t threads = std::thread::hardware_concurrency())
+                : _factory(std::move(factory)), _replications(replications), _init_time(init_time),
+                  _threads(std::max<std::size_t>(threads, 1)) {
+                    if (!_factory) {
+                        throw std::domain_error("An ensemble needs a model factory");
+                    }
+                }
+
+                /**
+                 * @brief Runs every replication until the next event is scheduled after t.
+                 * @param observe is called with the runner and the number of each replication when it stops.
+                 * @return the results of the observer, in the order of the replications.
+                 */
+                template<typename OBSERVER>
+                auto run_until(const TIME& t, OBSERVER observe) {
+                    return run([&t](runner_type& r) { r.run_until(t); }, observe);
+                }
+
+                /**
+                 * @brief Runs every replication until there is no next internal event to happen.
+                 */
+                template<typename OBSERVER>
+                auto run_until_passivate(OBSERVER observe) {
+                    return run([](runner_type& r) { r.run_until_passivate(); }, observe);
+                }
+
+                /**
+                 * @brief The links shared by the replications made so far.
+                 */
+                const link_pool& links() const noexcept {
+                    return _links;
+                }
+            };
+        }
+    }
+}
+
+#endif // CADMIUM_PDEVS_DYNAMIC_ENSEMBLE_RUNNER_HPP
@@ -0,0 +1,582 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_EXECUTION_HPP
+#define CADMIUM_PDEVS_DYNAMIC_EXECUTION_HPP
+
+#include <deque>
+#include <utility>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <condition_variable>
+
+#include <cadmium/logger/ordered_sink_provider.hpp>
+#include <cadmium/engine/pdevs_dynamic_placement.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * Execution policy concept used by the dynamic coordinator to visit its subengines.
+             *
+             * - template<typename F> void for_each_index(std::size_t n, const F& f): calls f(i) for each i in
+             *   [0, n) and returns when all the calls finished. The calls must be independent.
+             *
+             * The policy is copied from a coordinator to its subcoordinators.
+             */
+
+            /**
+             * @brief Visits the subengines one after another in the calling thread.
+             */
+            class sequential_execution {
+            public:
+                template<typename F>
+                void for_each_index(std::size_t n, const F& f) const {
+                    for (std::size_t i = 0; i < n; i++) {
+                        f(i);
+                    }
+                }
+            };
+
+            /**
+             * @brief Fixed size pool of threads running the iterations of a single loop at a time, the calling
+             * thread also runs iterations and waits for the others before returning. The threads take the
+             * next iteration to run from a shared counter, or their block of iterations when the placement is
+             * partitioned (see thread_placement).
+             */
+            class thread_pool {
+                std::vector<std::thread> _workers;
+                bool _partitioned = false;
+                std::size_t _pinned = 0;
+                std::mutex _mutex;
+                std::condition_variable _wake;
+                std::condition_variable _done;
+
+                const std::function<void(std::size_t)>* _task = nullptr;
+                std::size_t _size = 0;
+                std::atomic<std::size_t> _next_index{0};
+                std::size_t _busy = 0; // workers still running iterations of the current loop
+                std::size_t _generation = 0; // number of loops started, used to wake up the workers only once per loop
+                std::exception_ptr _error;
+                bool _stop = false;
+
+                static bool& inside_worker() {
+                    thread_local bool inside = false;
+                    return inside;
+                }
+
+                void run_iteration(const std::function<void(std::size_t)>& task, std::size_t i) {
+                    try {
+                        task(i);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        if (!_error) {
+                            _error = std::current_exception();
+                        }
+                    }
+                }
+
+                // thread is 0 for the calling thread and the worker index plus one for the workers
+                void run_iterations(const std::function<void(std::size_t)>& task, std::size_t size, std::size_t thread) {
+                    if (_partitioned) {
+                        std::size_t threads = _workers.size() + 1;
+                        for (std::size_t i = size * thread / threads; i < size * (thread + 1) / threads; i++) {
+                            run_iteration(task, i);
+                        }
+                        return;
+                    }
+                    for (std::size_t i = _next_index++; i < size; i = _next_index++) {
+                        run_iteration(task, i);
+                    }
+                }
+
+                void work(std::size_t thread) {
+                    inside_worker() = true;
+                    std::size_t seen_generation = 0;
+                    while (true) {
+                        const std::function<void(std::size_t)>* task;
+                        std::size_t size;
+                        {
+                            std::unique_lock<std::mutex> lock(_mutex);
+                            _wake.wait(lock, [this, seen_generation]() { return _stop || _generation != seen_generation; });
+                            if (_stop) {
+                                return;
+                            }
+                            seen_generation = _generation;
+                            task = _task;
+                            size = _size;
+                        }
+
+                        run_iterations(*task, size, thread);
+
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        if (--_busy == 0) {
+                            _done.notify_one();
+                        }
+                    }
+                }
+
+            public:
+                explicit thread_pool(std::size_t threads, const thread_placement& placement = thread_placement())
+                : _partitioned(placement.partitioned) {
+                    for (std::size_t i = 1; i < threads; i++) { // the calling thread is one of the threads
+                        _workers.emplace_back(&thread_pool::work, this, i);
+                        if (i - 1 < placement.worker_cpus.size() && pin_thread(_workers.back(), placement.worker_cpus[i - 1])) {
+                            _pinned++;
+                        }
+                    }
+                }
+
+                thread_pool(const thread_pool&) = delete;
+                thread_pool& operator=(const thread_pool&) = delete;
+
+                ~thread_pool() {
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _stop = true;
+                    }
+                    _wake.notify_all();
+                    for (auto& w : _workers) {
+                        w.join();
+                    }
+                }
+
+                std::size_t size() const noexcept {
+                    return _workers.size() + 1;
+                }
+
+                /**
+                 * @return the number of workers pinned to their cpu.
+                 */
+                std::size_t pinned() const noexcept {
+                    return _pinned;
+                }
+
+                bool partitioned() const noexcept {
+                    return _partitioned;
+                }
+
+                /**
+                 * @brief Calls task(i) for each i in [0, n) using all the threads of the pool. Nested calls from
+                 * inside an iteration run sequentially in the thread running the iteration.
+                 * @note The first exception thrown by an iteration is rethrown once all iterations finished.
+                 */
+                void parallel_for(std::size_t n, const std::function<void(std::size_t)>& task) {
+                    if (n < 2 || _workers.empty() || inside_worker()) {
+                        for (std::size_t i = 0; i < n; i++) {
+                            task(i);
+                        }
+                        return;
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _task = &task;
+                        _size = n;
+                        _next_index = 0;
+                        _busy = _workers.size();
+                        _error = nullptr;
+                        _generation++;
+                    }
+                    _wake.notify_all();
+
+                    inside_worker() = true;
+                    run_iterations(task, n, 0);
+                    inside_worker() = false;
+
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _done.wait(lock, [this]() { return _busy == 0; });
+                    _task = nullptr;
+                    if (_error) {
+                        std::exception_ptr error = _error;
+                        _error = nullptr;
+                        std::rethrow_exception(error);
+                    }
+                }
+            };
+
+            /**
+             * @brief Counters of the work done by a thread of a work_stealing_pool.
+             */
+            struct worker_statistics {
+                std::size_t loops = 0; // loops the thread took part in
+                std::size_t iterations = 0; // iterations run
+                std::size_t chunks = 0; // chunks run, including the stolen ones
+                std::size_t stolen_chunks = 0; // chunks taken from other threads queues
+                std::size_t failed_steals = 0; // visits to other threads queues that found them empty
+            };
+
+            /**
+             * @brief Pool of threads running the iterations of a single loop at a time using work stealing. The loop
+             * is split in chunks of grain size iterations, distributed evenly in a queue by thread. Each thread runs
+             * the chunks from the back of its queue, and when it is empty it steals chunks from the front of the
+             * other queues, then the threads finishing earlier help the ones with costly iterations.
+             * Loops smaller than the sequential threshold run in the calling thread without waking up the pool.
+             */
+            class work_stealing_pool {
+                using chunk = std::pair<std::size_t, std::size_t>; // [first, last) iterations
+
+                struct worker_queue {
+                    std::mutex mutex;
+                    std::deque<chunk> chunks;
+                };
+
+                std::vector<std::thread> _workers;
+                std::vector<std::unique_ptr<worker_queue>> _queues; // by thread, the calling thread is 0
+                std::vector<worker_statistics> _statistics; // by thread, only written by its thread
+                std::size_t _grain_size;
+                std::size_t _sequential_threshold;
+
+                std::mutex _mutex;
+                std::condition_variable _wake;
+                std::condition_variable _done;
+
+                const std::function<void(std::size_t)>* _task = nullptr;
+                std::size_t _busy = 0; // workers still running chunks of the current loop
+                std::size_t _generation = 0; // number of loops started, used to wake up the workers only once per loop
+                std::exception_ptr _error;
+                bool _stop = false;
+
+                static bool& inside_worker() {
+                    thread_local bool inside = false;
+                    return inside;
+                }
+
+                bool pop_own(std::size_t thread, chunk& c) {
+                    worker_queue& q = *_queues[thread];
+                    std::lock_guard<std::mutex> lock(q.mutex);
+                    if (q.chunks.empty()) {
+                        return false;
+                    }
+                    c = q.chunks.back();
+                    q.chunks.pop_back();
+                    return true;
+                }
+
+                bool steal(std::size_t thread, chunk& c) {
+                    for (std::size_t i = 1; i < _queues.size(); i++) {
+                        worker_queue& q = *_queues[(thread + i) % _queues.size()];
+                        std::lock_guard<std::mutex> lock(q.mutex);
+                        if (q.chunks.empty()) {
+                            _statistics[thread].failed_steals++;
+                            continue;
+                        }
+                        c = q.chunks.front();
+                        q.chunks.pop_front();
+                        _statistics[thread].stolen_chunks++;
+                        return true;
+                    }
+                    return false;
+                }
+
+                // all chunks are queued before the loop starts, once no queue has chunks the thread is done
+                void run_chunks(std::size_t thread, const std::function<void(std::size_t)>& task) {
+                    worker_statistics& statistics = _statistics[thread];
+                    statistics.loops++;
+                    chunk c;
+                    while (pop_own(thread, c) || steal(thread, c)) {
+                        statistics.chunks++;
+                        statistics.iterations += c.second - c.first;
+                        for (std::size_t i = c.first; i < c.second; i++) {
+                            try {
+                                task(i);
+                            } catch (...) {
+                                std::lock_guard<std::mutex> lock(_mutex);
+                                if (!_error) {
+                                    _error = std::current_exception();
+                                }
+                            }
+                        }
+                    }
+                }
+
+                void work(std::size_t thread) {
+                    inside_worker() = true;
+                    std::size_t seen_generation = 0;
+                    while (true) {
+                        const std::function<void(std::size_t)>* task;
+                        {
+                            std::unique_lock<std::mutex> lock(_mutex);
+                            _wake.wait(lock, [this, seen_generation]() { return _stop || _generation != seen_generation; });
+                            if (_stop) {
+                                return;
+                            }
+                            seen_generation = _generation;
+                            task = _task;
+                        }
+
+                        run_chunks(thread, *task);
+
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        if (--_busy == 0) {
+                            _done.notify_one();
+                        }
+                    }
+                }
+
+            public:
+                work_stealing_pool(std::size_t threads, std::size_t grain_size, std::size_t sequential_threshold)
+                : _grain_size(grain_size == 0 ? 1 : grain_size), _sequential_threshold(sequential_threshold) {
+                    threads = threads == 0 ? 1 : threads;
+                    for (std::size_t i = 0; i < threads; i++) {
+                        _queues.push_back(std::make_unique<worker_queue>());
+                    }
+                    _statistics.resize(threads);
+                    for (std::size_t i = 1; i < threads; i++) { // the calling thread is one of the threads
+                        _workers.emplace_back(&work_stealing_pool::work, this, i);
+                    }
+                }
+
+                work_stealing_pool(const work_stealing_pool&) = delete;
+                work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+                ~work_stealing_pool() {
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _stop = true;
+                    }
+                    _wake.notify_all();
+                    for (auto& w : _workers) {
+                        w.join();
+                    }
+                }
+
+                std::size_t size() const noexcept {
+                    return _queues.size();
+                }
+
+                std::size_t grain_size() const noexcept {
+                    return _grain_size;
+                }
+
+                std::size_t sequential_threshold() const noexcept {
+                    return _sequential_threshold;
+                }
+
+                /**
+                 * @brief The counters of each thread, indexed by thread, the calling thread is 0.
+                 * @note The counters are only consistent if no loop is running.
+                 */
+                const std::vector<worker_statistics>& statistics() const noexcept {
+                    return _statistics;
+                }
+
+                void reset_statistics() {
+                    _statistics.assign(_statistics.size(), worker_statistics());
+                }
+
+                /**
+                 * @brief Calls task(i) for each i in [0, n) using all the threads of the pool. Nested calls from
+                 * inside an iteration and loops smaller than the sequential threshold run sequentially in the calling
+                 * thread, and they are not counted in the statistics.
+                 * @note The first exception thrown by an iteration is rethrown once all iterations finished.
+                 */
+                void parallel_for(std::size_t n, const std::function<void(std::size_t)>& task) {
+                    if (n < 2 || n < _sequential_threshold || _workers.empty() || inside_worker()) {
+                        for (std::size_t i = 0; i < n; i++) {
+                            task(i);
+                        }
+                        return;
+                    }
+
+                    std::size_t chunks = (n + _grain_size - 1) / _grain_size;
+                    for (std::size_t t = 0; t < _queues.size(); t++) {
+                        std::size_t first = chunks * t / _queues.size();
+                        std::size_t last = chunks * (t + 1) / _queues.size();
+                        std::lock_guard<std::mutex> lock(_queues[t]->mutex);
+                        for (std::size_t c = first; c < last; c++) {
+                            _queues[t]->chunks.emplace_back(c * _grain_size, std::min(n, (c + 1) * _grain_size));
+                        }
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _task = &task;
+                        _busy = _workers.size();
+                        _error = nullptr;
+                        _generation++;
+                    }
+                    _wake.notify_all();
+
+                    inside_worker() = true;
+                    run_chunks(0, task);
+                    inside_worker() = false;
+
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _done.wait(lock, [this]() { return _busy == 0; });
+                    _task = nullptr;
+                    if (_error) {
+                        std::exception_ptr error = _error;
+                        _error = nullptr;
+                        std::rethrow_exception(error);
+                    }
+                }
+            };
+
+            /**
+             * @brief Visits the subengines concurrently on a thread pool shared by all the copies of the policy.
+             *
+             * @note The subengines are visited from different threads, then the LOGGER used with this policy must be
+             * thread safe, or the not_logger, and the order of the lines logged by the simulators is not fixed,
+             * see deterministic_execution to fix it.
+             * The message routing is done after all subengines were visited, then its order does not change.
+             */
+            class parallel_execution {
+                std::shared_ptr<thread_pool> _pool;
+
+            public:
+                parallel_execution()
+                : parallel_execution(std::thread::hardware_concurrency()) {}
+
+                explicit parallel_execution(std::size_t threads)
+                : _pool(std::make_shared<thread_pool>(threads == 0 ? 1 : threads)) {}
+
+                /**
+                 * @brief A pool placing its threads, for instance thread_placement::by_node(threads) to keep the
+                 * subengines of each block in the memory of one NUMA node.
+                 */
+                parallel_execution(std::size_t threads, const thread_placement& placement)
+                : _pool(std::make_shared<thread_pool>(threads == 0 ? 1 : threads, placement)) {}
+
+                std::size_t threads() const noexcept {
+                    return _pool->size();
+                }
+
+                std::size_t pinned_threads() const noexcept {
+                    return _pool->pinned();
+                }
+
+                template<typename F>
+                void for_each_index(std::size_t n, const F& f) const {
+                    _pool->parallel_for(n, std::function<void(std::size_t)>(std::cref(f)));
+                }
+            };
+
+            /**
+             * @brief Visits the subengines concurrently on a work stealing pool shared by all the copies of the
+             * policy. It balances steps where the cost of the subengines differ, and small steps run in the calling
+             * thread. The same thread safety notes of parallel_execution apply.
+             */
+            class work_stealing_execution {
+                std::shared_ptr<work_stealing_pool> _pool;
+
+            public:
+                work_stealing_execution()
+                : work_stealing_execution(std::thread::hardware_concurrency()) {}
+
+                /**
+                 * @param threads - The number of threads, including the calling thread.
+                 * @param grain_size - The number of consecutive indexes run as a single chunk.
+                 * @param sequential_threshold - Loops with less indexes run sequentially in the calling thread.
+                 */
+                explicit work_stealing_execution(std::size_t threads, std::size_t grain_size = 1, std::size_t sequential_threshold = 8)
+                : _pool(std::make_shared<work_stealing_pool>(threads, grain_size, sequential_threshold)) {}
+
+                std::size_t threads() const noexcept {
+                    return _pool->size();
+                }
+
+                std::size_t grain_size() const noexcept {
+                    return _pool->grain_size();
+                }
+
+                std::size_t sequential_threshold() const noexcept {
+                    return _pool->sequential_threshold();
+                }
+
+                const std::vector<worker_statistics>& statistics() const noexcept {
+                    return _pool->statistics();
+                }
+
+                void reset_statistics() const {
+                    _pool->reset_statistics();
+                }
+
+                template<typename F>
+                void for_each_index(std::size_t n, const F& f) const {
+                    _pool->parallel_for(n, std::function<void(std::size_t)>(std::cref(f)));
+                }
+            };
+
+            /**
+             * @brief Visits the subengines by another policy so that the runs are reproducible whatever the
+             * number of threads and their timing.
+             *
+             * The messages are already merged in a fixed order, the coordinators route them by their coupling
+             * tables once the loop finished. What changes between runs are the lines logged by the simulators
+             * and the exception rethrown. Here each iteration logs in a log capture of its own, replayed in index
+             * order after the loop, and the exception rethrown is the one of the lowest failing index. The loggers
+             * must write through an ordered_sink_provider (see ordered_sink_provider.hpp), then the trace is the
+             * same of a sequential_execution.
+             *
+             * @tparam EXECUTION - The policy running the iterations.
+             */
+            template<typename EXECUTION = parallel_execution>
+            class deterministic_execution {
+                EXECUTION _execution;
+
+            public:
+                deterministic_execution() = default;
+
+                explicit deterministic_execution(EXECUTION execution)
+                : _execution(std::move(execution)) {}
+
+                const EXECUTION& execution() const noexcept {
+                    return _execution;
+                }
+
+                template<typename F>
+                void for_each_index(std::size_t n, const F& f) const {
+                    std::vector<cadmium::logger::log_capture> captures(n);
+                    std::vector<std::exception_ptr> errors(n);
+                    _execution.for_each_index(n, [&f, &captures, &errors](std::size_t i) {
+                        cadmium::logger::log_capture::scope scope(captures[i]);
+                        try {
+                            f(i);
+                        } catch (...) {
+                            errors[i] = std::current_exception();
+                        }
+                    });
+                    for (std::size_t i = 0; i < n; i++) {
+                        if (errors[i]) {
+                            std::rethrow_exception(errors[i]);
+                        }
+                        captures[i].replay();
+                    }
+                }
+            };
+        }
+    }
+}
+
+#endif //CADMIUM_PDEVS_DYNAMIC_EXECUTION_HPP
@@ -0,0 +1,782 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_FEL_HPP
+#define CADMIUM_PDEVS_DYNAMIC_FEL_HPP
+
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * FEL concept used by the dynamic coordinator.
+             *
+             * A FEL keeps the next scheduled time of each subengine of a coordinator, the subengines
+             * are identified by their index in the coordinator subengines vector.
+             *
+             * - static constexpr bool visit_all: true if the coordinator has to advance every subengine
+             *   on each step (no scheduling at all), false if only imminent subengines and the ones
+             *   receiving messages have to be advanced. Outputs are always collected from the imminent
+             *   subengines only.
+             * - void reset(std::size_t size): clears the FEL and prepares it for size subengines.
+             * - void update(std::size_t engine, const TIME& next): sets the next time of a subengine.
+             * - void resize(std::size_t size): keeps the next times of the first size subengines, the new
+             *   ones are not scheduled. The dropped subengines must have been updated to infinity.
+             * - TIME next() const: the lowest next time, infinity if there is no subengine.
+             * - void imminent(const TIME& t, std::vector<std::size_t>& engines) const: appends in
+             *   ascending order the indexes of the subengines scheduled at t.
+             */
+
+            /**
+             * @brief The lowest of size times, infinity if size is 0. The arithmetic times are reduced in
+             * independent lanes of a 32 bytes vector, which the compiler turns into packed min instructions,
+             * while std::min_element keeps the position of the minimum and is not vectorized.
+             */
+            template<typename TIME>
+            TIME min_time(const TIME* times, std::size_t size) {
+                TIME ret = std::numeric_limits<TIME>::infinity();
+                std::size_t i = 0;
+                if constexpr (std::is_arithmetic<TIME>::value && sizeof(TIME) <= 32) {
+                    constexpr std::size_t lanes = 32 / sizeof(TIME);
+                    TIME lane[lanes];
+                    for (auto& l : lane) {
+                        l = ret;
+                    }
+                    for (; i + lanes <= size; i += lanes) {
+                        for (std::size_t j = 0; j < lanes; j++) {
+                            lane[j] = times[i + j] < lane[j] ? times[i + j] : lane[j];
+                        }
+                    }
+                    for (const auto& l : lane) {
+                        ret = l < ret ? l : ret;
+                    }
+                }
+                for (; i < size; i++) {
+                    ret = times[i] < ret ? times[i] : ret;
+                }
+                return ret;
+            }
+
+            /**
+             * @brief The absence of FEL. The next times are kept in a contiguous array updated by each
+             * subengine transition and reduced on each request, and the coordinator advances all its
+             * subengines on every step.
+             *
+             * @tparam TIME - The simulation time type.
+             */
+            template<typename TIME>
+            class no_fel {
+                std::vector<TIME> _next_times;
+
+            public:
+                static constexpr bool visit_all = true;
+
+                void reset(std::size_t size) {
+                    _next_times.assign(size, std::numeric_limits<TIME>::infinity());
+                }
+
+                void update(std::size_t engine, const TIME& next) {
+                    _next_times[engine] = next;
+                }
+
+                void resize(std::size_t size) {
+                    _next_times.resize(size, std::numeric_limits<TIME>::infinity());
+                }
+
+                TIME next() const {
+                    return min_time(_next_times.data(), _next_times.size());
+                }
+
+                void imminent(const TIME& t, std::vector<std::size_t>& engines) const {
+                    for (std::size_t i = 0; i < _next_times.size(); i++) {
+                        if (_next_times[i] == t) {
+                            engines.push_back(i);
+                        }
+                    }
+                }
+            };
+
+            /**
+             * @brief Indexed binary min heap keyed on the next time of each subengine. Updating the
+             * next time of a subengine is O(log n) and the imminent subengines are found visiting
+             * only the heap nodes scheduled at the requested time.
+             *
+             * @tparam TIME - The simulation time type.
+             */
+            template<typename TIME>
+            class heap_fel {
+                std::vector<TIME> _next_times; // next time by engine index
+                std::vector<std::size_t> _heap; // engine indexes ordered as a binary heap
+                std::vector<std::size_t> _positions; // position of each engine index in _heap
+                mutable std::vector<std::size_t> _pending; // heap nodes to visit while looking for imminents
+
+                bool lower(std::size_t a, std::size_t b) const {
+                    return _next_times[_heap[a]] < _next_times[_heap[b]];
+                }
+
+                void swap_nodes(std::size_t a, std::size_t b) {
+                    std::swap(_heap[a], _heap[b]);
+                    _positions[_heap[a]] = a;
+                    _positions[_heap[b]] = b;
+                }
+
+                void sift_up(std::size_t node) {
+                    while (node > 0) {
+                        std::size_t parent = (node - 1) / 2;
+                        if (!lower(node, parent)) {
+                            return;
+                        }
+                        swap_nodes(node, parent);
+                        node = parent;
+                    }
+                }
+
+                void sift_down(std::size_t node) {
+                    std::size_t size = _heap.size();
+                    while (true) {
+                        std::size_t left = 2 * node + 1;
+                        std::size_t right = left + 1;
+                        std::size_t lowest = node;
+
+                        if (left < size && lower(left, lowest)) {
+                            lowest = left;
+                        }
+                        if (right < size && lower(right, lowest)) {
+                            lowest = right;
+                        }
+                        if (lowest == node) {
+                            return;
+                        }
+                        swap_nodes(node, lowest);
+                        node = lowest;
+                    }
+                }
+
+            public:
+                static constexpr bool visit_all = false;
+
+                void reset(std::size_t size) {
+                    _next_times.assign(size, std::numeric_limits<TIME>::infinity());
+                    _heap.resize(size);
+                    _positions.resize(size);
+                    for (std::size_t i = 0; i < size; i++) {
+                        _heap[i] = i;
+                        _positions[i] = i;
+                    }
+                }
+
+                void update(std::size_t engine, const TIME& next) {
+                    if (next < _next_times[engine]) {
+                        _next_times[engine] = next;
+                        sift_up(_positions[engine]);
+                    } else if (_next_times[engine] < next) {
+                        _next_times[engine] = next;
+                        sift_down(_positions[engine]);
+                    }
+                }
+
+                // the new engines are leaves at infinity, the last engine node is replaced by the last heap node
+                void resize(std::size_t size) {
+                    while (_next_times.size() < size) {
+                        _positions.push_back(_heap.size());
+                        _heap.push_back(_next_times.size());
+                        _next_times.push_back(std::numeric_limits<TIME>::infinity());
+                    }
+                    while (_next_times.size() > size) {
+                        std::size_t node = _positions.back();
+                        swap_nodes(node, _heap.size() - 1);
+                        _heap.pop_back();
+                        _positions.pop_back();
+                        _next_times.pop_back();
+                        if (node < _heap.size()) {
+                            sift_up(node);
+                            sift_down(node);
+                        }
+                    }
+                }
+
+                TIME next() const {
+                    if (_heap.empty()) {
+                        return std::numeric_limits<TIME>::infinity();
+                    }
+                    return _next_times[_heap.front()];
+                }
+
+                void imminent(const TIME& t, std::vector<std::size_t>& engines) const {
+                    if (_heap.empty()) {
+                        return;
+                    }
+
+                    std::size_t first = engines.size();
+                    _pending.assign(1, 0);
+                    while (!_pending.empty()) {
+                        std::size_t node = _pending.back();
+                        _pending.pop_back();
+
+                        // children are never lower than their parent, below a later node there is nothing imminent.
+                        if (_next_times[_heap[node]] == t) {
+                            engines.push_back(_heap[node]);
+                            std::size_t left = 2 * node + 1;
+                            if (left < _heap.size()) {
+                                _pending.push_back(left);
+                            }
+                            if (left + 1 < _heap.size()) {
+                                _pending.push_back(left + 1);
+                            }
+                        }
+                    }
+                    std::sort(engines.begin() + first, engines.end());
+                }
+            };
+
+            /**
+             * @brief Tournament tree of the next times of the subengines, each inner node keeps the lowest time
+             * of its two children and the root is the lowest next time. Updating a subengine replays only the
+             * matches on the path from its leaf to the root, and stops at the first node its time does not
+             * change, then the update of a subengine that keeps winning or losing is O(1) and O(log n) at
+             * most. The imminent subengines are found visiting only the nodes scheduled at the requested time.
+             *
+             * Unlike the heap, the nodes do not move, the tree keeps a leaf by subengine index.
+             *
+             * @tparam TIME - The simulation time type.
+             */
+            template<typename TIME>
+            class tournament_fel {
+                std::size_t _size = 0; // subengines
+                std::size_t _leaves = 1; // leaves of the tree, a power of two, leaf i is node _leaves + i
+                std::vector<TIME> _tree = std::vector<TIME>(2, std::numeric_limits<TIME>::infinity()); // node 1 is the root
+                mutable std::vector<std::size_t> _pending; // nodes to visit while looking for imminents
+
+                static const TIME& lowest(const TIME& a, const TIME& b) {
+                    return b < a ? b : a;
+                }
+
+                // plays again the matches from node to the root until a winner time does not change
+                void replay(std::size_t node) {
+                    for (node /= 2; node != 0; node /= 2) {
+                        const TIME& winner = lowest(_tree[2 * node], _tree[2 * node + 1]);
+                        if (winner == _tree[node]) {
+                            return;
+                        }
+                        _tree[node] = winner;
+                    }
+                }
+
+                // makes a tree for size subengines keeping the next times of the current ones
+                void rebuild(std::size_t size) {
+                    std::size_t leaves = 1;
+                    while (leaves < size) {
+                        leaves *= 2;
+                    }
+                    std::vector<TIME> tree(2 * leaves, std::numeric_limits<TIME>::infinity());
+                    for (std::size_t i = 0; i < std::min(_size, size); i++) {
+                        tree[leaves + i] = _tree[_leaves + i];
+                    }
+                    for (std::size_t node = leaves - 1; node != 0; node--) {
+                        tree[node] = lowest(tree[2 * node], tree[2 * node + 1]);
+                    }
+                    _tree = std::move(tree);
+                    _leaves = leaves;
+                    _size = size;
+                }
+
+            public:
+                static constexpr bool visit_all = false;
+
+                void reset(std::size_t size) {
+                    _size = 0;
+                    rebuild(size);
+                }
+
+                void update(std::size_t engine, const TIME& next) {
+                    std::size_t node = _leaves + engine;
+                    if (next == _tree[node]) {
+                        return;
+                    }
+                    _tree[node] = next;
+                    replay(node);
+                }
+
+                // the tree grows when the subengines do not fit its leaves, the dropped ones are at infinity
+                void resize(std::size_t size) {
+                    if (size > _leaves) {
+                        rebuild(size);
+                    } else {
+                        _size = size;
+                    }
+                }
+
+                TIME next() const {
+                    return _tree[1];
+                }
+
+                // the left children are visited first, then the imminents are found in ascending order
+                void imminent(const TIME& t, std::vector<std::size_t>& engines) const {
+                    if (!(_tree[1] == t)) {
+                        return;
+                    }
+                    _pending.assign(1, 1);
+                    while (!_pending.empty()) {
+                        std::size_t node = _pending.back();
+                        _pending.pop_back();
+                        if (!(_tree[node] == t)) {
+                            continue;
+                        }
+                        if (node >= _leaves) {
+                            if (node - _leaves < _size) {
+                                engines.push_back(node - _leaves);
+                            }
+                        } else {
+                            _pending.push_back(2 * node + 1);
+                            _pending.push_back(2 * node);
+                        }
+                    }
+                }
+            };
+
+            /**
+             * @brief Calendar queue keyed on the next time of each subengine. The next times are hashed in buckets
+             * of a fixed width, like the days of a year, and the lowest time is found visiting the days in order
+             * from the last lowest time. The number of buckets follows the number of scheduled subengines and the
+             * width is estimated from the lowest next times, then updating and finding the next time are O(1) on
+             * average for next times spread uniformly.
+             *
+             * @note TIME must be convertible to double.
+             *
+             * @tparam TIME - The simulation time type.
+             */
+            template<typename TIME>
+            class calendar_fel {
+                static constexpr std::size_t not_scheduled = std::numeric_limits<std::size_t>::max();
+                static constexpr std::size_t width_sample = 25;
+
+                std::vector<TIME> _next_times; // next time by engine index
+                std::vector<std::size_t> _bucket_of; // bucket of each engine, not_scheduled if its next time is infinity
+                std::vector<std::size_t> _slot_of; // position of each engine in its bucket
+                std::vector<std::vector<std::size_t>> _buckets;
+                std::size_t _scheduled = 0;
+                double _width = 1.0;
+
+                mutable bool _lowest_valid = true;
+                mutable TIME _lowest = std::numeric_limits<TIME>::infinity();
+                mutable TIME _lower_bound = std::numeric_limits<TIME>::infinity(); // no next time is lower
+
+                double day(const TIME& t) const {
+                    return std::floor(static_cast<double>(t) / _width);
+                }
+
+                std::size_t bucket_of_day(double d) const {
+                    double b = std::fmod(d, static_cast<double>(_buckets.size()));
+                    if (b < 0) {
+                        b += static_cast<double>(_buckets.size());
+                    }
+                    return static_cast<std::size_t>(b);
+                }
+
+                void insert(std::size_t engine) {
+                    std::size_t b = bucket_of_day(day(_next_times[engine]));
+                    _bucket_of[engine] = b;
+                    _slot_of[engine] = _buckets[b].size();
+                    _buckets[b].push_back(engine);
+                }
+
+                void remove(std::size_t engine) {
+                    std::vector<std::size_t>& bucket = _buckets[_bucket_of[engine]];
+                    std::size_t moved = bucket.back();
+                    bucket[_slot_of[engine]] = moved;
+                    _slot_of[moved] = _slot_of[engine];
+                    bucket.pop_back();
+                    _bucket_of[engine] = not_scheduled;
+                }
+
+                // the width is a few times the average separation of the lowest next times
+                void rebuild(std::size_t buckets) {
+                    std::vector<TIME> lowest;
+                    for (std::size_t i = 0; i < _next_times.size(); i++) {
+                        if (_bucket_of[i] != not_scheduled) {
+                            lowest.push_back(_next_times[i]);
+                        }
+                    }
+                    std::size_t sample = std::min(lowest.size(), width_sample);
+                    std::partial_sort(lowest.begin(), lowest.begin() + sample, lowest.end());
+                    if (sample > 1) {
+                        double separation = (static_cast<double>(lowest[sample - 1]) - static_cast<double>(lowest[0])) / (sample - 1);
+                        if (separation > 0 && std::isfinite(separation)) {
+                            _width = 3.0 * separation;
+                        }
+                    }
+
+                    for (auto& b : _buckets) {
+                        b.clear();
+                    }
+                    _buckets.resize(buckets);
+                    for (std::size_t i = 0; i < _next_times.size(); i++) {
+                        if (_bucket_of[i] != not_scheduled) {
+                            insert(i);
+                        }
+                    }
+                }
+
+                // visits the days of a year from the lower bound, then falls back to visit all the subengines
+                TIME find_lowest() const {
+                    if (_scheduled == 0) {
+                        return std::numeric_limits<TIME>::infinity();
+                    }
+
+                    double first_day = day(_lower_bound);
+                    for (std::size_t k = 0; k < _buckets.size(); k++) {
+                        double d = first_day + k;
+                        TIME ret = std::numeric_limits<TIME>::infinity();
+                        for (std::size_t engine : _buckets[bucket_of_day(d)]) {
+                            if (_next_times[engine] < ret && day(_next_times[engine]) == d) {
+                                ret = _next_times[engine];
+                            }
+                        }
+                        if (ret != std::numeric_limits<TIME>::infinity()) {
+                            return ret;
+                        }
+                    }
+
+                    TIME ret = std::numeric_limits<TIME>::infinity();
+                    for (const auto& bucket : _buckets) {
+                        for (std::size_t engine : bucket) {
+                            ret = std::min(ret, _next_times[engine]);
+                        }
+                    }
+                    return ret;
+                }
+
+            public:
+                static constexpr bool visit_all = false;
+
+                void reset(std::size_t size) {
+                    _next_times.assign(size, std::numeric_limits<TIME>::infinity());
+                    _bucket_of.assign(size, not_scheduled);
+                    _slot_of.assign(size, 0);
+                    _buckets.assign(2, std::vector<std::size_t>());
+                    _scheduled = 0;
+                    _width = 1.0;
+                    _lowest_valid = true;
+                    _lowest = std::numeric_limits<TIME>::infinity();
+                    _lower_bound = std::numeric_limits<TIME>::infinity();
+                }
+
+                void update(std::size_t engine, const TIME& next) {
+                    TIME previous = _next_times[engine];
+                    if (previous == next) {
+                        return;
+                    }
+
+                    if (_bucket_of[engine] != not_scheduled) {
+                        remove(engine);
+                        _scheduled--;
+                    }
+                    _next_times[engine] = next;
+                    if (next != std::numeric_limits<TIME>::infinity()) {
+                        insert(engine);
+                        _scheduled++;
+                        _lower_bound = std::min(_lower_bound, next);
+                    }
+
+                    if (_lowest_valid) {
+                        if (next < _lowest) {
+                            _lowest = next;
+                        } else if (previous == _lowest) {
+                            _lowest_valid = false;
+                        }
+                    }
+
+                    if (_scheduled > 2 * _buckets.size()) {
+                        rebuild(2 * _buckets.size());
+                    } else if (_buckets.size() > 2 && _scheduled < _buckets.size() / 2) {
+                        rebuild(_buckets.size() / 2);
+                    }
+                }
+
+                void resize(std::size_t size) {
+                    _next_times.resize(size, std::numeric_limits<TIME>::infinity());
+                    _bucket_of.resize(size, not_scheduled);
+                    _slot_of.resize(size, 0);
+                }
+
+                TIME next() const {
+                    if (!_lowest_valid) {
+                        _lowest = find_lowest();
+                        _lowest_valid = true;
+                        if (_scheduled > 0) {
+                            _lower_bound = _lowest;
+                        }
+                    }
+                    return _lowest;
+                }
+
+                void imminent(const TIME& t, std::vector<std::size_t>& engines) const {
+                    if (_scheduled == 0 || t == std::numeric_limits<TIME>::infinity()) {
+                        return;
+                    }
+
+                    std::size_t first = engines.size();
+                    for (std::size_t engine : _buckets[bucket_of_day(day(t))]) {
+                        if (_next_times[engine] == t) {
+                            engines.push_back(engine);
+                        }
+                    }
+                    std::sort(engines.begin() + first, engines.end());
+                }
+            };
+
+            /**
+             * @brief Ladder queue keyed on the next time of each subengine. The next times are kept unsorted in the
+             * top until they are needed, then they are spread in the buckets of a rung, and a bucket with too many
+             * next times is spread again in a finer rung. Only the bucket holding the lowest next times is sorted,
+             * in the bottom. Updating a subengine leaves its old entry in the ladder, it is discarded when found.
+             * Updating and finding the next time are O(1) amortized for most next times distributions, including
+             * the skewed ones.
+             *
+             * @note TIME must be convertible to double.
+             *
+             * @tparam TIME - The simulation time type.
+             */
+            template<typename TIME>
+            class ladder_fel {
+                static constexpr std::size_t bucket_threshold = 50; // bigger buckets are spread in a new rung
+                static constexpr std::size_t max_rungs = 8;
+
+                struct entry {
+                    TIME time;
+                    std::size_t engine;
+                    std::size_t version;
+                };
+
+                struct rung {
+                    double start;
+                    double width;
+                    std::size_t current; // buckets before current are empty
+                    std::vector<std::vector<entry>> buckets;
+
+                    double current_start() const {
+                        return start + current * width;
+                    }
+                };
+
+                std::vector<TIME> _next_times; // next time by engine index
+                std::vector<std::size_t> _versions; // the valid entry of each engine has its current version
+
+                // the next times in top are not lower than the ones in the rungs, and those are not lower than the bottom ones
+                mutable std::vector<entry> _top;
+                mutable double _top_start;
+                mutable double _top_min;
+                mutable double _top_max;
+                mutable std::vector<rung> _rungs; // from the coarsest to the finest
+                mutable std::vector<entry> _bottom; // sorted from the highest to the lowest next time
+
+                bool valid(const entry& e) const {
+                    return _versions[e.engine] == e.version;
+                }
+
+                static bool higher(const entry& a, const entry& b) {
+                    return b.time < a.time;
+                }
+
+                void discard_invalid(std::vector<entry>& entries) const {
+                    entries.erase(std::remove_if(entries.begin(), entries.end(), [this](const entry& e) { return !this->valid(e); }), entries.end());
+                }
+
+                void enqueue(const entry& e) const {
+                    double t = static_cast<double>(e.time);
+                    if (t >= _top_start) {
+                        _top.push_back(e);
+                        _top_min = std::min(_top_min, t);
+                        _top_max = std::max(_top_max, t);
+                        return;
+                    }
+
+                    for (auto& r : _rungs) {
+                        if (t >= r.current_start()) {
+                            double b = std::floor((t - r.start) / r.width);
+                            std::size_t bucket = b < 0 ? 0 : static_cast<std::size_t>(b);
+                            bucket = std::min(std::max(bucket, r.current), r.buckets.size() - 1);
+                            r.buckets[bucket].push_back(e);
+                            return;
+                        }
+                    }
+
+                    _bottom.insert(std::upper_bound(_bottom.begin(), _bottom.end(), e, higher), e);
+                }
+
+                void spread_in_new_rung(std::vector<entry>& entries, double start, double width) const {
+                    rung r{start, width, 0, std::vector<std::vector<entry>>(entries.size() + 1)};
+                    for (const auto& e : entries) {
+                        double b = std::floor((static_cast<double>(e.time) - start) / width);
+                        std::size_t bucket = b < 0 ? 0 : static_cast<std::size_t>(b);
+                        r.buckets[std::min(bucket, r.buckets.size() - 1)].push_back(e);
+                    }
+                    _rungs.push_back(std::move(r));
+                }
+
+                void sort_in_bottom(std::vector<entry>& entries) const {
+                    std::sort(entries.begin(), entries.end(), higher);
+                    _bottom.insert(_bottom.begin(), entries.begin(), entries.end());
+                }
+
+                // moves the lowest valid entries to the bottom
+                void refill_bottom() const {
+                    while (!_bottom.empty() && !valid(_bottom.back())) {
+                        _bottom.pop_back();
+                    }
+
+                    while (_bottom.empty()) {
+                        if (_rungs.empty()) {
+                            discard_invalid(_top);
+                            if (_top.empty()) {
+                                return;
+                            }
+
+                            std::vector<entry> entries;
+                            entries.swap(_top);
+                            double width = (_top_max - _top_min) / entries.size();
+                            if (width > 0 && std::isfinite(width)) {
+                                spread_in_new_rung(entries, _top_min, width);
+                                _top_start = _rungs.back().start + _rungs.back().buckets.size() * width;
+                            } else {
+                                sort_in_bottom(entries);
+                                _top_start = std::nextafter(_top_max, std::numeric_limits<double>::infinity());
+                            }
+                            _top_min = std::numeric_limits<double>::infinity();
+                            _top_max = -std::numeric_limits<double>::infinity();
+                            continue;
+                        }
+
+                        rung& r = _rungs.back();
+                        while (r.current < r.buckets.size() && r.buckets[r.current].empty()) {
+                            r.current++;
+                        }
+                        if (r.current == r.buckets.size()) {
+                            _rungs.pop_back();
+                            continue;
+                        }
+
+                        std::vector<entry> entries;
+                        entries.swap(r.buckets[r.current]);
+                        double start = r.current_start();
+                        double width = r.width / entries.size();
+                        r.current++;
+                        discard_invalid(entries);
+                        if (entries.empty()) {
+                            continue;
+                        }
+
+                        auto bounds = std::minmax_element(entries.begin(), entries.end(), [](const entry& a, const entry& b) { return a.time < b.time; });
+                        bool same_time = !(bounds.first->time < bounds.second->time);
+                        if (entries.size() > bucket_threshold && _rungs.size() < max_rungs && !same_time && start + width > start) {
+                            spread_in_new_rung(entries, start, width);
+                        } else {
+                            sort_in_bottom(entries);
+                        }
+
+                        while (!_bottom.empty() && !valid(_bottom.back())) {
+                            _bottom.pop_back();
+                        }
+                    }
+                }
+
+            public:
+                static constexpr bool visit_all = false;
+
+                void reset(std::size_t size) {
+                    _next_times.assign(size, std::numeric_limits<TIME>::infinity());
+                    _versions.assign(size, 0);
+                    _top.clear();
+                    _top_start = -std::numeric_limits<double>::infinity();
+                    _top_min = std::numeric_limits<double>::infinity();
+                    _top_max = -std::numeric_limits<double>::infinity();
+                    _rungs.clear();
+                    _bottom.clear();
+                }
+
+                void update(std::size_t engine, const TIME& next) {
+                    if (_next_times[engine] == next) {
+                        return;
+                    }
+                    _next_times[engine] = next;
+                    _versions[engine]++;
+                    if (next != std::numeric_limits<TIME>::infinity()) {
+                        enqueue(entry{next, engine, _versions[engine]});
+                    }
+                }
+
+                // the versions are kept, the entries left by the dropped engines stay invalid if they come back
+                void resize(std::size_t size) {
+                    _next_times.resize(size, std::numeric_limits<TIME>::infinity());
+                    if (_versions.size() < size) {
+                        _versions.resize(size, 0);
+                    }
+                }
+
+                TIME next() const {
+                    refill_bottom();
+                    if (_bottom.empty()) {
+                        return std::numeric_limits<TIME>::infinity();
+                    }
+                    return _bottom.back().time;
+                }
+
+                void imminent(const TIME& t, std::vector<std::size_t>& engines) const {
+                    TIME lowest = next();
+                    if (t < lowest || t == std::numeric_limits<TIME>::infinity()) {
+                        return;
+                    }
+
+                    std::size_t first = engines.size();
+                    if (t == lowest) {
+                        // all the entries at the lowest next time are in the bottom
+                        for (auto it = _bottom.rbegin(); it != _bottom.rend() && it->time == t; ++it) {
+                            if (valid(*it)) {
+                                engines.push_back(it->engine);
+                            }
+                        }
+                    } else {
+                        for (std::size_t i = 0; i < _next_times.size(); i++) {
+                            if (_next_times[i] == t) {
+                                engines.push_back(i);
+                            }
+                        }
+                    }
+                    std::sort(engines.begin() + first, engines.end());
+                }
+            };
+        }
+    }
+}
+
+#endif //CADMIUM_PDEVS_DYNAMIC_FEL_HPP
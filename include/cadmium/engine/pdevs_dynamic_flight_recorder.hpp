@@ -0,0 +1,379 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_FLIGHT_RECORDER_HPP
+#define CADMIUM_PDEVS_DYNAMIC_FLIGHT_RECORDER_HPP
+
+#include <mutex>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <cadmium/modeling/dynamic_id_table.hpp>
+
+/**
+ * The flight recorder of the dynamic engine keeps the last events of each thread in a ring buffer, always on:
+ * the runner steps and the simulators outputs, transitions and failures. Recording an event stores 16 bytes
+ * in the ring of the calling thread, no formatting, no lock and no allocation. When an exception propagates
+ * out of a runner run, the rings are dumped to the failure path, then the events before a failure are known
+ * with the logging off.
+ *
+ * The dump is binary, it is converted to text by convert_flight_record. Defining CADMIUM_NO_FLIGHT_RECORDER
+ * removes the recording.
+ */
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            enum class flight_event : std::uint8_t {
+                run_step = 0,
+                collect_outputs = 1,
+                internal_transition = 2,
+                external_transition = 3,
+                confluence_transition = 4,
+                failure = 5
+            };
+
+            inline const char* flight_event_name(flight_event e) {
+                switch (e) {
+                    case flight_event::run_step: return "run_step";
+                    case flight_event::collect_outputs: return "collect_outputs";
+                    case flight_event::internal_transition: return "internal_transition";
+                    case flight_event::external_transition: return "external_transition";
+                    case flight_event::confluence_transition: return "confluence_transition";
+                    case flight_event::failure: return "failure";
+                }
+                return "unknown";
+            }
+
+            /**
+             * @brief An event of the flight recorder, the time is converted to double, NaN for the times
+             * without conversion, and the model is no_model for the events of the runner.
+             */
+            struct flight_record {
+                static constexpr cadmium::dynamic::modeling::model_handle no_model = std::numeric_limits<cadmium::dynamic::modeling::model_handle>::max();
+
+                double time;
+                cadmium::dynamic::modeling::model_handle model;
+                flight_event event;
+            };
+            static_assert(sizeof(flight_record) == 16, "The flight records are 16 bytes");
+
+            /**
+             * The flight record dump starts with the magic "CDMF", the format version, the size of a record
+             * and the number of threads as 32 bits integers. Then for each thread the number of records as a
+             * 32 bits integer followed by the records, the oldest first. It ends with the number of model ids
+             * as a 32 bits integer followed by each one as its 32 bits handle, 32 bits length and bytes.
+             * The integers are written in the byte order of the machine.
+             */
+            namespace flight_dump {
+                constexpr char magic[4] = {'C', 'D', 'M', 'F'};
+                constexpr std::uint32_t version = 1;
+
+                template<typename INT>
+                void write_int(std::ostream& os, INT value) {
+                    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+                }
+
+                template<typename T>
+                T read(std::istream& is) {
+                    T ret;
+                    if (!is.read(reinterpret_cast<char*>(&ret), sizeof(ret))) {
+                        throw std::domain_error("Truncated flight record");
+                    }
+                    return ret;
+                }
+            }
+
+            /**
+             * @brief Keeps the last events of all the threads, each thread in its own ring of capacity records.
+             * set_capacity(), dump() and records() must not be called while the simulation runs.
+             */
+            class flight_recorder {
+            public:
+                static constexpr std::size_t default_capacity = 1024;
+
+            private:
+                struct thread_ring {
+                    std::vector<flight_record> records;
+                    std::uint64_t count = 0; // the records ever written, the next one goes to count & mask
+                    std::uint64_t mask = 0;
+                };
+
+                // a finished thread gives its ring back with its records, the next thread continues it
+                struct thread_holder {
+                    thread_ring* ring = nullptr;
+                    std::uint64_t generation = 0;
+
+                    ~thread_holder() {
+                        if (ring != nullptr) {
+                            flight_recorder::instance().give_back(ring);
+                        }
+                    }
+                };
+
+                std::atomic<std::uint64_t> _generation{1};
+                std::size_t _capacity = default_capacity;
+                std::string _failure_path = "cadmium_flight_record.bin";
+                mutable std::mutex _mutex;
+                std::vector<std::unique_ptr<thread_ring>> _rings;
+                std::vector<thread_ring*> _free;
+
+                flight_recorder() = default;
+
+                thread_ring& ring() {
+                    thread_local thread_holder holder;
+                    std::uint64_t current = _generation.load(std::memory_order_acquire);
+                    if (holder.ring == nullptr || holder.generation != current) {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        holder.generation = current;
+                        if (!_free.empty()) {
+                            holder.ring = _free.back();
+                            _free.pop_back();
+                        } else {
+                            _rings.push_back(std::make_unique<thread_ring>());
+                            holder.ring = _rings.back().get();
+                            holder.ring->records.resize(_capacity);
+                            holder.ring->mask = _capacity - 1;
+                        }
+                    }
+                    return *holder.ring;
+                }
+
+                void give_back(thread_ring* r) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    for (const auto& owned : _rings) {
+                        if (owned.get() == r) {
+                            _free.push_back(r);
+                            return;
+                        }
+                    }
+                }
+
+                static std::vector<flight_record> ordered(const thread_ring& r) {
+                    std::vector<flight_record> ret;
+                    std::uint64_t size = r.count < r.records.size() ? r.count : r.records.size();
+                    ret.reserve(size);
+                    for (std::uint64_t i = r.count - size; i < r.count; i++) {
+                        ret.push_back(r.records[i & r.mask]);
+                    }
+                    return ret;
+                }
+
+            public:
+                static flight_recorder& instance() {
+                    static flight_recorder recorder;
+                    return recorder;
+                }
+
+                template<typename TIME>
+                static double time_of(const TIME& t) noexcept {
+                    if constexpr (std::is_constructible<double, TIME>::value) {
+                        return static_cast<double>(t);
+                    } else {
+                        return std::numeric_limits<double>::quiet_NaN();
+                    }
+                }
+
+                void record(flight_event event, double time, cadmium::dynamic::modeling::model_handle model) {
+                    thread_ring& r = ring();
+                    r.records[r.count & r.mask] = flight_record{time, model, event};
+                    r.count++;
+                }
+
+                template<typename TIME>
+                void record(flight_event event, const TIME& time, cadmium::dynamic::modeling::model_handle model = flight_record::no_model) {
+                    record(event, time_of(time), model);
+                }
+
+                /**
+                 * @brief Discards the records and keeps the last capacity events of each thread from now on, the
+                 * capacity is rounded up to a power of two.
+                 */
+                void set_capacity(std::size_t capacity) {
+                    if (capacity == 0) {
+                        throw std::domain_error("The flight recorder needs room for one record");
+                    }
+                    std::size_t rounded = 1;
+                    while (rounded < capacity) {
+                        rounded <<= 1;
+                    }
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _capacity = rounded;
+                    _rings.clear();
+                    _free.clear();
+                    _generation.fetch_add(1, std::memory_order_release);
+                }
+
+                std::size_t capacity() const {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    return _capacity;
+                }
+
+                /**
+                 * @brief The file the runners dump the records to when a run fails, an empty path disables it.
+                 */
+                void set_failure_path(const std::string& path) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _failure_path = path;
+                }
+
+                std::string failure_path() const {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    return _failure_path;
+                }
+
+                /**
+                 * @brief The records of each thread, the oldest first.
+                 */
+                std::vector<std::vector<flight_record>> records() const {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    std::vector<std::vector<flight_record>> ret;
+                    for (const auto& r : _rings) {
+                        ret.push_back(ordered(*r));
+                    }
+                    return ret;
+                }
+
+                /**
+                 * @brief Writes the records of all the threads and the ids of their models, see flight_dump.
+                 */
+                void dump(std::ostream& os) const {
+                    std::vector<std::vector<flight_record>> threads = records();
+                    os.write(flight_dump::magic, sizeof(flight_dump::magic));
+                    flight_dump::write_int<std::uint32_t>(os, flight_dump::version);
+                    flight_dump::write_int<std::uint32_t>(os, sizeof(flight_record));
+                    flight_dump::write_int<std::uint32_t>(os, static_cast<std::uint32_t>(threads.size()));
+                    std::unordered_set<cadmium::dynamic::modeling::model_handle> models;
+                    for (const auto& thread : threads) {
+                        flight_dump::write_int<std::uint32_t>(os, static_cast<std::uint32_t>(thread.size()));
+                        os.write(reinterpret_cast<const char*>(thread.data()), thread.size() * sizeof(flight_record));
+                        for (const auto& r : thread) {
+                            if (r.model != flight_record::no_model) {
+                                models.insert(r.model);
+                            }
+                        }
+                    }
+                    const auto& ids = cadmium::dynamic::modeling::id_table::instance();
+                    flight_dump::write_int<std::uint32_t>(os, static_cast<std::uint32_t>(models.size()));
+                    for (auto model : models) {
+                        const std::string& name = ids.name(model);
+                        flight_dump::write_int<std::uint32_t>(os, model);
+                        flight_dump::write_int<std::uint32_t>(os, static_cast<std::uint32_t>(name.size()));
+                        os.write(name.data(), name.size());
+                    }
+                }
+
+                /**
+                 * @brief Dumps the records to the failure path, it does not throw as it is called while an
+                 * exception propagates.
+                 * @return true if the records were written.
+                 */
+                bool dump_on_failure() noexcept {
+                    try {
+                        std::string path = failure_path();
+                        if (path.empty()) {
+                            return false;
+                        }
+                        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+                        dump(os);
+                        return static_cast<bool>(os);
+                    } catch (...) {
+                        return false;
+                    }
+                }
+            };
+
+            /**
+             * @brief Writes a flight record dump as text, a line by record with the thread, the time, the event
+             * and the model id.
+             */
+            inline void convert_flight_record(std::istream& is, std::ostream& os) {
+                char magic[sizeof(flight_dump::magic)];
+                if (!is.read(magic, sizeof(magic)) || std::memcmp(magic, flight_dump::magic, sizeof(magic)) != 0) {
+                    throw std::domain_error("Not a flight record");
+                }
+                if (flight_dump::read<std::uint32_t>(is) != flight_dump::version) {
+                    throw std::domain_error("Unsupported flight record version");
+                }
+                if (flight_dump::read<std::uint32_t>(is) != sizeof(flight_record)) {
+                    throw std::domain_error("The flight record was written with another record layout");
+                }
+                std::vector<std::vector<flight_record>> threads(flight_dump::read<std::uint32_t>(is));
+                for (auto& thread : threads) {
+                    thread.resize(flight_dump::read<std::uint32_t>(is));
+                    if (!is.read(reinterpret_cast<char*>(thread.data()), thread.size() * sizeof(flight_record))) {
+                        throw std::domain_error("Truncated flight record");
+                    }
+                }
+                std::unordered_map<cadmium::dynamic::modeling::model_handle, std::string> names;
+                for (std::uint32_t n = flight_dump::read<std::uint32_t>(is); n > 0; n--) {
+                    auto model = flight_dump::read<std::uint32_t>(is);
+                    std::string name(flight_dump::read<std::uint32_t>(is), '\0');
+                    if (!is.read(&name[0], name.size())) {
+                        throw std::domain_error("Truncated flight record");
+                    }
+                    names.emplace(model, std::move(name));
+                }
+                for (std::size_t tid = 0; tid < threads.size(); tid++) {
+                    for (const auto& r : threads[tid]) {
+                        os << tid << ' ' << r.time << ' ' << flight_event_name(r.event);
+                        if (r.model != flight_record::no_model) {
+                            auto it = names.find(r.model);
+                            os << ' ' << (it == names.end() ? std::to_string(r.model) : it->second);
+                        }
+                        os << '\n';
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Records an event in the flight recorder, TIME is the event time and MODEL the model handle.
+ */
+#if defined(CADMIUM_NO_FLIGHT_RECORDER)
+#define CADMIUM_FLIGHT_RECORD(EVENT, TIME, MODEL)
+#else
+#define CADMIUM_FLIGHT_RECORD(EVENT, TIME, MODEL) \
+    cadmium::dynamic::engine::flight_recorder::instance().record(cadmium::dynamic::engine::flight_event::EVENT, (TIME), (MODEL))
+#endif
+
+#endif // CADMIUM_PDEVS_DYNAMIC_FLIGHT_RECORDER_HPP
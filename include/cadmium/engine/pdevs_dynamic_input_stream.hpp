@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_INPUT_STREAM_HPP
+#define CADMIUM_PDEVS_DYNAMIC_INPUT_STREAM_HPP
+
+#include <vector>
+#include <utility>
+#include <optional>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <cadmium/modeling/message_bag.hpp>
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief A timestamped message for an input port of the top model, see make_input_event.
+             */
+            template<typename TIME>
+            struct input_event {
+                TIME time;
+                std::function<void(cadmium::dynamic::message_bags&)> deliver; // adds the message to the inbox
+            };
+
+            template<typename PORT, typename TIME>
+            input_event<TIME> make_input_event(const TIME& t, typename PORT::message_type message) {
+                return input_event<TIME>{t, [m = std::move(message)](cadmium::dynamic::message_bags& inbox) mutable {
+                    auto slot = inbox.slot_of(cadmium::dynamic::port_key::of<PORT>());
+                    if (slot == cadmium::dynamic::message_bags::no_slot) {
+                        throw std::domain_error("An input event is for a port the top model does not have");
+                    }
+                    inbox.get_bag_in_slot<cadmium::message_bag<PORT>>(slot).messages.push_back(std::move(m));
+                }};
+            }
+
+            /**
+             * @brief The input events of a producer, read in time order by the runner, see runner::add_input_stream.
+             *
+             * The source returns the next event of the producer, or nothing when it has no event for now, as a
+             * drained queue or a socket without data, then it is asked again at the next step. A file or a
+             * recorded sequence returns nothing once it ended. The events of a source do not go back in time.
+             */
+            template<typename TIME>
+            class input_stream {
+            public:
+                using source_type = std::function<std::optional<input_event<TIME>>()>;
+
+            private:
+                source_type _source;
+                std::optional<input_event<TIME>> _lookahead;
+
+            public:
+                explicit input_stream(source_type source)
+                : _source(std::move(source)) {
+                    if (!_source) {
+                        throw std::domain_error("An input stream needs a source");
+                    }
+                }
+
+                /**
+                 * @brief The next event of the stream, nullptr if the source has none for now.
+                 */
+                const input_event<TIME>* peek() {
+                    if (!_lookahead) {
+                        _lookahead = _source();
+                    }
+                    return _lookahead ? &*_lookahead : nullptr;
+                }
+
+                /**
+                 * @brief Delivers the next event to the inbox, it must have been peeked.
+                 */
+                void deliver(cadmium::dynamic::message_bags& inbox) {
+                    input_event<TIME> e = std::move(*_lookahead);
+                    _lookahead.reset();
+                    e.deliver(inbox);
+                }
+            };
+
+            /**
+             * @brief A stream replaying recorded events, sorted by time keeping the order of the simultaneous ones.
+             */
+            template<typename TIME>
+            std::shared_ptr<input_stream<TIME>> make_input_stream(std::vector<input_event<TIME>> events) {
+                std::stable_sort(events.begin(), events.end(), [](const input_event<TIME>& a, const input_event<TIME>& b) {
+                    return a.time < b.time;
+                });
+                auto recorded = std::make_shared<std::vector<input_event<TIME>>>(std::move(events));
+                return std::make_shared<input_stream<TIME>>([recorded, i = std::size_t(0)]() mutable -> std::optional<input_event<TIME>> {
+                    if (i == recorded->size()) {
+                        return std::nullopt;
+                    }
+                    return std::move((*recorded)[i++]);
+                });
+            }
+        }
+    }
+}
+
+#endif // CADMIUM_PDEVS_DYNAMIC_INPUT_STREAM_HPP
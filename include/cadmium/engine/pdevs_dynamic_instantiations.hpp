@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2018, Damian Vicino, Laouen M. L. Belloli
+ * Carleton University, Universite de Nice-Sophia Antipolis, Universidad de Buenos Aires
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_INSTANTIATIONS_HPP
+#define CADMIUM_PDEVS_DYNAMIC_INSTANTIATIONS_HPP
+
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+/**
+ * The dynamic engine instantiated for the common TIME and LOGGER types, the float and double times with the
+ * not_logger and the default logger, and the default FEL and execution policy.
+ *
+ * The CadmiumEngine library has these instantiations compiled, its users get CADMIUM_PREBUILT_DYNAMIC_ENGINE
+ * defined and pdevs_dynamic_runner.hpp declares them extern, then the translation units using these engines
+ * do not instantiate the simulator, coordinator and runner members again. The other types are instantiated
+ * in the translation units as usual.
+ */
+#define CADMIUM_DYNAMIC_ENGINE_INSTANTIATIONS(EXTERN, TIME, LOGGER) \
+    EXTERN template class cadmium::dynamic::engine::simulator<TIME, LOGGER>; \
+    EXTERN template class cadmium::dynamic::engine::coordinator<TIME, LOGGER>; \
+    EXTERN template class cadmium::dynamic::engine::runner<TIME, LOGGER>;
+
+#define CADMIUM_DYNAMIC_ENGINE_COMMON_INSTANTIATIONS(EXTERN) \
+    CADMIUM_DYNAMIC_ENGINE_INSTANTIATIONS(EXTERN, float, cadmium::logger::not_logger) \
+    CADMIUM_DYNAMIC_ENGINE_INSTANTIATIONS(EXTERN, double, cadmium::logger::not_logger) \
+    CADMIUM_DYNAMIC_ENGINE_INSTANTIATIONS(EXTERN, float, cadmium::dynamic::engine::default_logger<float>) \
+    CADMIUM_DYNAMIC_ENGINE_INSTANTIATIONS(EXTERN, double, cadmium::dynamic::engine::default_logger<double>)
+
+#ifdef CADMIUM_PREBUILT_DYNAMIC_ENGINE
+CADMIUM_DYNAMIC_ENGINE_COMMON_INSTANTIATIONS(extern)
+#endif
+
+#endif // CADMIUM_PDEVS_DYNAMIC_INSTANTIATIONS_HPP
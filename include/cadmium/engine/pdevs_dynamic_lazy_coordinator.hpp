@@ -0,0 +1,338 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_LAZY_COORDINATOR_HPP
+#define CADMIUM_PDEVS_DYNAMIC_LAZY_COORDINATOR_HPP
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <cadmium/engine/pdevs_dynamic_coordinator.hpp>
+#include <cadmium/engine/pdevs_dynamic_engine.hpp>
+#include <cadmium/engine/pdevs_dynamic_checkpoint.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief The lazy coordinator runs a dynamic coupled model creating its coordinator, and then the
+             * engines of the whole subtree, only when the subtree receives its first input or reaches its first
+             * event. Until then the subtree is dormant, it has only the boundary bags of the coupled model.
+             *
+             * The first event of a dormant subtree is found from the initial states of its atomic models, the
+             * coordinator is initialized at the initial time when created, then the elapsed times and the logged
+             * times are the ones of an eager coordinator. Only the order of the init logs changes, they are logged
+             * when the subtree is created. A subtree with embedded models is created on init, the time of their
+             * first event is only known by their engine.
+             *
+             * @tparam TIME - The simulation time type.
+             * @tparam LOGGER - The logger type used to log simulation information.
+             * @tparam FEL - The FEL type of the coordinator.
+             * @tparam EXECUTION - The execution policy of the coordinator.
+             */
+            template<typename TIME, typename LOGGER, typename FEL, typename EXECUTION>
+            class lazy_coordinator : public engine<TIME> {
+                using coordinator_type = cadmium::dynamic::engine::coordinator<TIME, LOGGER, FEL, EXECUTION>;
+                using coupled_type = cadmium::dynamic::modeling::coupled<TIME>;
+
+                std::shared_ptr<coupled_type> _model;
+                std::unique_ptr<coordinator_type> _coordinator;
+                std::string _model_id;
+                EXECUTION _execution;
+                TIME _initial;
+                TIME _next;
+
+                // the settings given to the dormant subtree, passed to its coordinator when created
+                std::unique_ptr<std::unordered_set<std::string>> _logged_models;
+                bool _profiling = false;
+                hierarchy_counters* _counters = nullptr;
+                allocation_counters* _allocations = nullptr;
+                std::size_t _level = 0;
+                state_store<TIME>* _store = nullptr;
+
+                // the first event of the subtree from the initial states, false if it has embedded models
+                static bool find_initial_next(const coupled_type& coupled, const TIME& initial_time, TIME& next) {
+                    for (const auto& m : coupled._models) {
+                        if (auto atomic = dynamic_cast<const cadmium::dynamic::modeling::atomic_abstract<TIME>*>(m.get())) {
+                            TIME n = initial_time + atomic->time_advance();
+                            if (n < next) {
+                                next = n;
+                            }
+                        } else if (auto sub = dynamic_cast<const coupled_type*>(m.get())) {
+                            if (!find_initial_next(*sub, initial_time, next)) {
+                                return false;
+                            }
+                        } else {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+
+                static std::size_t states_bytes(const coupled_type& coupled) {
+                    std::size_t ret = 0;
+                    for (const auto& m : coupled._models) {
+                        if (auto atomic = dynamic_cast<const cadmium::dynamic::modeling::atomic_abstract<TIME>*>(m.get())) {
+                            ret += atomic->state_bytes();
+                        } else if (auto sub = dynamic_cast<const coupled_type*>(m.get())) {
+                            ret += states_bytes(*sub);
+                        }
+                    }
+                    return ret;
+                }
+
+                void create_coordinator() {
+                    _coordinator.reset(new coordinator_type(_model, _execution));
+                    if (_logged_models) {
+                        _coordinator->set_logged_models(*_logged_models);
+                        _logged_models.reset();
+                    }
+                    if (_profiling) {
+                        _coordinator->set_profiling(true);
+                    }
+                    if (_counters != nullptr) {
+                        _coordinator->set_counters(_counters, _level);
+                    }
+                    if (_allocations != nullptr) {
+                        _coordinator->set_allocation_counters(_allocations, _level);
+                    }
+                    _coordinator->init(_initial);
+                    if (_store != nullptr) {
+                        _coordinator->set_state_store(_store);
+                    }
+                }
+
+                // the boundary bags have a slot by port of the coupled model, in the same order than the ones
+                // of the coordinator
+                static void move_messages(cadmium::dynamic::message_bags& from, cadmium::dynamic::message_bags& to) {
+                    for (std::size_t i = 0; i < from.slots(); i++) {
+                        from.slot(i).move_messages_into(to.slot(i));
+                    }
+                }
+
+            public:
+
+                cadmium::dynamic::message_bags _inbox;
+                cadmium::dynamic::message_bags _outbox;
+
+                using model_type = coupled_type;
+
+                lazy_coordinator() = delete;
+
+                lazy_coordinator(std::shared_ptr<coupled_type> coupled_model, const EXECUTION& execution=EXECUTION())
+                : _model(std::move(coupled_model)), _execution(execution)
+                {
+                    _model_id = _model->get_id();
+                    _inbox = cadmium::dynamic::message_bags(_model->get_input_ports());
+                    _outbox = cadmium::dynamic::message_bags(_model->get_output_ports());
+                }
+
+                // the routing tables of the parent point to the boundary bags
+                lazy_coordinator(const lazy_coordinator&) = delete;
+                lazy_coordinator& operator=(const lazy_coordinator&) = delete;
+
+                /**
+                 * @brief The subtree stays dormant if the time of its first event is known without its engines.
+                 */
+                void init(TIME initial_time) override {
+                    _initial = initial_time;
+                    _coordinator.reset();
+                    _next = std::numeric_limits<TIME>::infinity();
+                    if (!find_initial_next(*_model, initial_time, _next)) {
+                        create_coordinator();
+                    }
+                }
+
+                /**
+                 * @return true if the engines of the subtree were created.
+                 */
+                bool created() const noexcept {
+                    return _coordinator != nullptr;
+                }
+
+                const std::string& get_model_id() const override {
+                    return _model_id;
+                }
+
+                void set_logged_models(const std::unordered_set<std::string>& model_ids) override {
+                    if (_coordinator) {
+                        _coordinator->set_logged_models(model_ids);
+                    } else {
+                        _logged_models.reset(new std::unordered_set<std::string>(model_ids));
+                    }
+                }
+
+                void set_profiling(bool enabled) override {
+                    _profiling = enabled;
+                    if (_coordinator) {
+                        _coordinator->set_profiling(enabled);
+                    }
+                }
+
+                // a dormant subtree has no profiles
+                void collect_profiles(std::vector<model_profile>& profiles) const override {
+                    if (_coordinator) {
+                        _coordinator->collect_profiles(profiles);
+                    }
+                }
+
+                void collect_link_profiles(std::vector<link_profile>& profiles) const override {
+                    if (_coordinator) {
+                        _coordinator->collect_link_profiles(profiles);
+                    }
+                }
+
+                void set_counters(hierarchy_counters* counters, std::size_t level) override {
+                    _counters = counters;
+                    _level = level;
+                    if (_coordinator) {
+                        _coordinator->set_counters(counters, level);
+                    }
+                }
+
+                void set_allocation_counters(allocation_counters* counters, std::size_t level) override {
+                    _allocations = counters;
+                    _level = level;
+                    if (_coordinator) {
+                        _coordinator->set_allocation_counters(counters, level);
+                    }
+                }
+
+                // the states of a dormant subtree are only paged once it is created
+                void set_state_store(state_store<TIME>* store) override {
+                    _store = store;
+                    if (_coordinator) {
+                        _coordinator->set_state_store(store);
+                    }
+                }
+
+                /**
+                 * @brief A dormant subtree has its boundary bags and the states of its atomic models, once created
+                 * the boundary bags are accounted with its coordinator.
+                 */
+                void account_memory(memory_usage& usage, std::vector<model_memory>& coupled_models, std::size_t level) const override {
+                    memory_usage self;
+                    self.bags = _outbox.allocated_bytes() + _inbox.allocated_bytes();
+                    self.engines = sizeof(*this);
+                    if (_coordinator) {
+                        std::size_t entry = coupled_models.size();
+                        _coordinator->account_memory(usage, coupled_models, level);
+                        coupled_models[entry].self += self;
+                        coupled_models[entry].total += self;
+                    } else {
+                        self.states = states_bytes(*_model);
+                        coupled_models.push_back(model_memory{_model_id, level, self, self});
+                    }
+                    usage += self;
+                }
+
+                /**
+                 * @brief A dormant subtree saves its initial and next times, its models are in their initial states.
+                 */
+                void save_checkpoint(std::string& buffer) const override {
+                    checkpoint::write_engine(_model_id, _inbox, _outbox, buffer);
+                    checkpoint::write_value(_initial, buffer);
+                    checkpoint::write_value(_next, buffer);
+                    checkpoint::write_value(created(), buffer);
+                    if (_coordinator) {
+                        _coordinator->save_checkpoint(buffer);
+                    }
+                }
+
+                void restore_checkpoint(const char*& data, const char* end) override {
+                    checkpoint::read_engine(_model_id, data, end);
+                    _initial = checkpoint::read_value<TIME>(data, end);
+                    _next = checkpoint::read_value<TIME>(data, end);
+                    if (checkpoint::read_value<bool>(data, end)) {
+                        if (!_coordinator) {
+                            create_coordinator();
+                        }
+                        _coordinator->restore_checkpoint(data, end);
+                    } else {
+                        _coordinator.reset();
+                    }
+                }
+
+                TIME next() const noexcept override {
+                    return _coordinator ? _coordinator->next() : _next;
+                }
+
+                void collect_outputs(const TIME &t) override {
+                    if (!_coordinator) {
+                        if (t != _next) {
+                            return;
+                        }
+                        create_coordinator();
+                    }
+                    _coordinator->collect_outputs(t);
+                    if (_coordinator->next() == t) {
+                        _outbox.clear();
+                        move_messages(_coordinator->outbox(), _outbox);
+                    }
+                }
+
+                /**
+                 * @brief outbox keeps the output generated by the last call to collect_outputs
+                 */
+                cadmium::dynamic::message_bags& outbox() override {
+                    return _outbox;
+                }
+
+                cadmium::dynamic::message_bags& inbox() override {
+                    return _inbox;
+                }
+
+                /**
+                 * @brief A dormant subtree is created when it has input messages or an event at t, then the input
+                 * messages are moved to the inbox of its coordinator and it advances to t.
+                 */
+                void advance_simulation(const TIME &t) override {
+                    _outbox.clear();
+                    if (!_coordinator) {
+                        if (_next < t) {
+                            throw std::domain_error("Trying to obtain output when out of the advance time scope");
+                        }
+                        if (t != _next && _inbox.empty()) {
+                            return;
+                        }
+                        create_coordinator();
+                    }
+                    move_messages(_inbox, _coordinator->inbox());
+                    _inbox.clear();
+                    _coordinator->advance_simulation(t);
+                }
+            };
+        }
+    }
+}
+
+#endif //CADMIUM_PDEVS_DYNAMIC_LAZY_COORDINATOR_HPP
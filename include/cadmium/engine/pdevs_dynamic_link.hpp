@@ -27,33 +27,397 @@
 #ifndef CADMIUM_PDEVS_DYNAMIC_LINK_HPP
 #define CADMIUM_PDEVS_DYNAMIC_LINK_HPP
 
+#include <string>
 #include <typeindex>
 #include <memory>
+#include <vector>
+#include <stdexcept>
 
 #include <cadmium/logger/dynamic_common_loggers.hpp>
+#include <cadmium/modeling/message_bag.hpp>
 #include <cadmium/modeling/dynamic_message_bag.hpp>
 #include <cadmium/logger/common_loggers_helpers.hpp>
+#include <cadmium/engine/pdevs_dynamic_message_serializer.hpp>
 
 namespace cadmium {
     namespace dynamic {
         namespace engine {
 
-            class link_abstract {
+            class link_abstract : public std::enable_shared_from_this<link_abstract> {
             public:
                 virtual std::type_index from_type_index() const = 0;
 
-                virtual std::type_index from_port_type_index() const = 0;
+                virtual cadmium::dynamic::port_key from_port_key() const = 0;
 
                 virtual std::type_index to_type_index() const = 0;
 
-                virtual std::type_index to_port_type_index() const = 0;
+                virtual cadmium::dynamic::port_key to_port_key() const = 0;
 
+                std::type_index from_port_type_index() const {
+                    return from_port_key().type();
+                }
+
+                std::type_index to_port_type_index() const {
+                    return to_port_key().type();
+                }
+
+                /**
+                 * @brief Routes the messages of the from port bag of bags_from to the to port bag of bags_to.
+                 *
+                 * @param log_messages - If false, the returned routed_messages is empty and no message nor port
+                 * name is formatted, the engines pass false when their logger does not log the routing.
+                 * @return the ports and messages to log.
+                 */
+                virtual cadmium::dynamic::logger::routed_messages
+                route_messages(const cadmium::dynamic::message_bags& bags_from, cadmium::dynamic::message_bags& bags_to, bool log_messages = true) const = 0;
+
+                /**
+                 * @brief Routes the messages as route_messages does, but moving them out of the from port bag, that
+                 * is left empty. It is used when the link is the only one reading the from port messages.
+                 */
+                virtual cadmium::dynamic::logger::routed_messages
+                move_messages(cadmium::dynamic::message_bags& bags_from, cadmium::dynamic::message_bags& bags_to, bool log_messages = true) const = 0;
+
+                /**
+                 * @brief Routes the messages as route_messages does, with the port bags already found, from_slot
+                 * is the slot of the from port in bags_from and to_slot the slot of the to port in bags_to.
+                 */
                 virtual cadmium::dynamic::logger::routed_messages
-                route_messages(const cadmium::dynamic::message_bags& bags_from, cadmium::dynamic::message_bags& bags_to) const = 0;
+                route_messages_in_slots(const cadmium::dynamic::message_bags& bags_from, std::size_t from_slot,
+                                        cadmium::dynamic::message_bags& bags_to, std::size_t to_slot, bool log_messages = true) const = 0;
+
+                /**
+                 * @brief Moves the messages as move_messages does, with the port bags already found.
+                 */
+                virtual cadmium::dynamic::logger::routed_messages
+                move_messages_in_slots(cadmium::dynamic::message_bags& bags_from, std::size_t from_slot,
+                                       cadmium::dynamic::message_bags& bags_to, std::size_t to_slot, bool log_messages = true) const = 0;
+
+                /**
+                 * @brief Makes room in the to port bag for count more messages, before routing the messages
+                 * of several links to the same port.
+                 */
+                virtual void reserve_messages_in_slot(cadmium::dynamic::message_bags& bags_to, std::size_t to_slot, std::size_t count) const = 0;
+
+                /**
+                 * @brief Creates a link routing the messages directly from this link from port to the next link
+                 * to port, the next link from port must be the same port this link routes to.
+                 *
+                 * @param next - The link routing the messages this link leaves in its to port.
+                 * @return a single link equivalent to route using this link and then the next link.
+                 */
+                virtual std::shared_ptr<link_abstract> compose(const std::shared_ptr<link_abstract>& next) const = 0;
+
+                // the names are demangled once by link type
+                virtual const std::string& from_port_name() const = 0;
+
+                virtual const std::string& to_port_name() const = 0;
+
+                /**
+                 * @return the bytes of the link object, with the links it is composed of.
+                 */
+                virtual std::size_t object_size() const = 0;
+
+                /**
+                 * @return the size of the messages routed, the bytes copied by message when they are not moved.
+                 */
+                virtual std::size_t message_size() const = 0;
+
+                /**
+                 * @return true if there are messages to route in the from port bag of bags_from.
+                 */
+                virtual bool has_messages(const cadmium::dynamic::message_bags& bags_from) const = 0;
+
+                /**
+                 * @brief Appends to buffer the messages of the from port bag of bags_from, to be routed by the
+                 * same link in another memory space using deserialize_messages.
+                 * @throw std::domain_error if the from port has no port_serializer.
+                 */
+                virtual void serialize_messages(const cadmium::dynamic::message_bags& bags_from, std::string& buffer) const = 0;
+
+                /**
+                 * @brief Reads the messages serialized by serialize_messages from data and routes them to the
+                 * to port bag of bags_to, data is moved after the messages read.
+                 */
+                virtual cadmium::dynamic::logger::routed_messages
+                deserialize_messages(const char*& data, const char* end, cadmium::dynamic::message_bags& bags_to, bool log_messages = true) const = 0;
+            };
+
+            /**
+             * @brief Common base of the links carrying messages of type MSG, it allows routing the messages between any
+             * pair of ports of the same messages type without knowing the ports types.
+             *
+             * @tparam MSG - The message type of the from and to ports.
+             */
+            template<typename MSG>
+            class message_link_abstract : public link_abstract {
+            public:
+                /**
+                 * @return the messages of the from port in bags_from, nullptr if there is no bag for the from port.
+                 */
+                virtual const cadmium::bag<MSG>* messages_from(const cadmium::dynamic::message_bags& bags_from) const = 0;
+
+                std::size_t message_size() const override {
+                    return sizeof(MSG);
+                }
+
+                /**
+                 * @brief Appends the messages in the to port bag of bags_to.
+                 * @param from_port - The name of the port the messages come from, nullptr to skip the logged messages.
+                 */
+                virtual cadmium::dynamic::logger::routed_messages
+                append_messages(const cadmium::bag<MSG>& messages, cadmium::dynamic::message_bags& bags_to, const std::string* from_port) const = 0;
+
+                /**
+                 * @return the messages of the from port in bags_from to be moved, nullptr if there is no bag for the from port.
+                 */
+                virtual cadmium::bag<MSG>* mutable_messages_from(cadmium::dynamic::message_bags& bags_from) const = 0;
+
+                /**
+                 * @brief Moves the messages to the to port bag of bags_to, messages is left empty.
+                 * @param from_port - The name of the port the messages come from, nullptr to skip the logged messages.
+                 */
+                virtual cadmium::dynamic::logger::routed_messages
+                append_moved_messages(cadmium::bag<MSG>&& messages, cadmium::dynamic::message_bags& bags_to, const std::string* from_port) const = 0;
+
+                /**
+                 * @return the messages of the from port bag in the slot from_slot, nullptr if the slot has no bag.
+                 */
+                virtual const cadmium::bag<MSG>* messages_in_slot(const cadmium::dynamic::message_bags& bags_from, std::size_t from_slot) const = 0;
+
+                virtual cadmium::bag<MSG>* mutable_messages_in_slot(cadmium::dynamic::message_bags& bags_from, std::size_t from_slot) const = 0;
+
+                /**
+                 * @brief Appends the messages in the to port bag in the slot to_slot of bags_to.
+                 */
+                virtual cadmium::dynamic::logger::routed_messages
+                append_messages_in_slot(const cadmium::bag<MSG>& messages, cadmium::dynamic::message_bags& bags_to, std::size_t to_slot, const std::string* from_port) const = 0;
+
+                virtual cadmium::dynamic::logger::routed_messages
+                append_moved_messages_in_slot(cadmium::bag<MSG>&& messages, cadmium::dynamic::message_bags& bags_to, std::size_t to_slot, const std::string* from_port) const = 0;
+
+                /**
+                 * @brief The link reading the messages from the from port, used to avoid cascading composed links.
+                 */
+                virtual std::shared_ptr<const message_link_abstract<MSG>> source() const = 0;
+
+                /**
+                 * @brief The link writing the messages in the to port, used to avoid cascading composed links.
+                 */
+                virtual std::shared_ptr<const message_link_abstract<MSG>> sink() const = 0;
+
+                /**
+                 * @brief Appends messages to buffer with the port_serializer of the from port.
+                 */
+                virtual void write_messages(const cadmium::bag<MSG>& messages, std::string& buffer) const = 0;
+
+                /**
+                 * @brief Reads the messages written by write_messages with the port_serializer of the from port.
+                 */
+                virtual void read_messages(const char*& data, const char* end, cadmium::bag<MSG>& messages) const = 0;
+
+                cadmium::dynamic::logger::routed_messages
+                route_messages(const cadmium::dynamic::message_bags& bags_from, cadmium::dynamic::message_bags& bags_to, bool log_messages = true) const override {
+                    const cadmium::bag<MSG>* messages = this->messages_from(bags_from);
+                    return this->route_logging(log_messages, messages != nullptr, [&](const std::string* from_port) {
+                        return this->append_messages(*messages, bags_to, from_port);
+                    });
+                }
+
+                cadmium::dynamic::logger::routed_messages
+                move_messages(cadmium::dynamic::message_bags& bags_from, cadmium::dynamic::message_bags& bags_to, bool log_messages = true) const override {
+                    cadmium::bag<MSG>* messages = this->mutable_messages_from(bags_from);
+                    return this->route_logging(log_messages, messages != nullptr, [&](const std::string* from_port) {
+                        return this->append_moved_messages(std::move(*messages), bags_to, from_port);
+                    });
+                }
+
+                cadmium::dynamic::logger::routed_messages
+                route_messages_in_slots(const cadmium::dynamic::message_bags& bags_from, std::size_t from_slot,
+                                        cadmium::dynamic::message_bags& bags_to, std::size_t to_slot, bool log_messages = true) const override {
+                    const cadmium::bag<MSG>* messages = this->messages_in_slot(bags_from, from_slot);
+                    return this->route_logging(log_messages, messages != nullptr, [&](const std::string* from_port) {
+                        return this->append_messages_in_slot(*messages, bags_to, to_slot, from_port);
+                    });
+                }
+
+                cadmium::dynamic::logger::routed_messages
+                move_messages_in_slots(cadmium::dynamic::message_bags& bags_from, std::size_t from_slot,
+                                       cadmium::dynamic::message_bags& bags_to, std::size_t to_slot, bool log_messages = true) const override {
+                    cadmium::bag<MSG>* messages = this->mutable_messages_in_slot(bags_from, from_slot);
+                    return this->route_logging(log_messages, messages != nullptr, [&](const std::string* from_port) {
+                        return this->append_moved_messages_in_slot(std::move(*messages), bags_to, to_slot, from_port);
+                    });
+                }
+
+                std::shared_ptr<link_abstract> compose(const std::shared_ptr<link_abstract>& next) const override;
+
+                bool has_messages(const cadmium::dynamic::message_bags& bags_from) const override {
+                    const cadmium::bag<MSG>* messages = this->messages_from(bags_from);
+                    return messages != nullptr && !messages->empty();
+                }
+
+                void serialize_messages(const cadmium::dynamic::message_bags& bags_from, std::string& buffer) const override {
+                    const cadmium::bag<MSG>* messages = this->messages_from(bags_from);
+                    this->write_messages(messages == nullptr ? cadmium::bag<MSG>() : *messages, buffer);
+                }
+
+                // the messages read are moved to the to port, the bag takes their buffer if it is empty
+                cadmium::dynamic::logger::routed_messages
+                deserialize_messages(const char*& data, const char* end, cadmium::dynamic::message_bags& bags_to, bool log_messages = true) const override {
+                    cadmium::bag<MSG> messages;
+                    this->read_messages(data, end, messages);
+                    return this->route_logging(log_messages, true, [&](const std::string* from_port) {
+                        return this->append_moved_messages(std::move(messages), bags_to, from_port);
+                    });
+                }
+
+            protected:
+                /**
+                 * @brief Calls route with the from port name, or with nullptr if the messages are not logged, and
+                 * returns the routed messages to log. The port names are only formatted when logging.
+                 */
+                template<typename ROUTE>
+                cadmium::dynamic::logger::routed_messages route_logging(bool log_messages, bool has_bag, ROUTE&& route) const {
+                    if (!log_messages) {
+                        if (has_bag) {
+                            route(nullptr);
+                        }
+                        return cadmium::dynamic::logger::routed_messages();
+                    }
+                    const std::string& from_port = this->from_port_name();
+                    if (!has_bag) {
+                        return cadmium::dynamic::logger::routed_messages(from_port, this->to_port_name());
+                    }
+                    return route(&from_port);
+                }
+
+                /**
+                 * @brief The routed messages of a route without messages, nothing is formatted if from_port is nullptr.
+                 */
+                cadmium::dynamic::logger::routed_messages no_routed_messages(const std::string* from_port) const {
+                    if (from_port == nullptr) {
+                        return cadmium::dynamic::logger::routed_messages();
+                    }
+                    return cadmium::dynamic::logger::routed_messages(*from_port, this->to_port_name());
+                }
+            };
+
+            /**
+             * @brief A link made by two links, the messages are moved from the first link from port to the last
+             * link to port without passing through the intermediate port.
+             *
+             * @tparam MSG - The message type of the from and to ports.
+             */
+            template<typename MSG>
+            class composed_link : public message_link_abstract<MSG> {
+                std::shared_ptr<const message_link_abstract<MSG>> _first;
+                std::shared_ptr<const message_link_abstract<MSG>> _last;
+
+            public:
+                composed_link(std::shared_ptr<const message_link_abstract<MSG>> first, std::shared_ptr<const message_link_abstract<MSG>> last)
+                : _first(std::move(first)), _last(std::move(last)) {}
+
+                std::type_index from_type_index() const override {
+                    return _first->from_type_index();
+                }
+
+                cadmium::dynamic::port_key from_port_key() const override {
+                    return _first->from_port_key();
+                }
+
+                std::type_index to_type_index() const override {
+                    return _last->to_type_index();
+                }
+
+                cadmium::dynamic::port_key to_port_key() const override {
+                    return _last->to_port_key();
+                }
+
+                std::size_t object_size() const override {
+                    return sizeof(*this) + _first->object_size() + _last->object_size();
+                }
+
+                const cadmium::bag<MSG>* messages_from(const cadmium::dynamic::message_bags& bags_from) const override {
+                    return _first->messages_from(bags_from);
+                }
+
+                cadmium::dynamic::logger::routed_messages
+                append_messages(const cadmium::bag<MSG>& messages, cadmium::dynamic::message_bags& bags_to, const std::string* from_port) const override {
+                    return _last->append_messages(messages, bags_to, from_port);
+                }
+
+                cadmium::bag<MSG>* mutable_messages_from(cadmium::dynamic::message_bags& bags_from) const override {
+                    return _first->mutable_messages_from(bags_from);
+                }
+
+                cadmium::dynamic::logger::routed_messages
+                append_moved_messages(cadmium::bag<MSG>&& messages, cadmium::dynamic::message_bags& bags_to, const std::string* from_port) const override {
+                    return _last->append_moved_messages(std::move(messages), bags_to, from_port);
+                }
+
+                const cadmium::bag<MSG>* messages_in_slot(const cadmium::dynamic::message_bags& bags_from, std::size_t from_slot) const override {
+                    return _first->messages_in_slot(bags_from, from_slot);
+                }
+
+                cadmium::bag<MSG>* mutable_messages_in_slot(cadmium::dynamic::message_bags& bags_from, std::size_t from_slot) const override {
+                    return _first->mutable_messages_in_slot(bags_from, from_slot);
+                }
+
+                cadmium::dynamic::logger::routed_messages
+                append_messages_in_slot(const cadmium::bag<MSG>& messages, cadmium::dynamic::message_bags& bags_to, std::size_t to_slot, const std::string* from_port) const override {
+                    return _last->append_messages_in_slot(messages, bags_to, to_slot, from_port);
+                }
+
+                cadmium::dynamic::logger::routed_messages
+                append_moved_messages_in_slot(cadmium::bag<MSG>&& messages, cadmium::dynamic::message_bags& bags_to, std::size_t to_slot, const std::string* from_port) const override {
+                    return _last->append_moved_messages_in_slot(std::move(messages), bags_to, to_slot, from_port);
+                }
+
+                void reserve_messages_in_slot(cadmium::dynamic::message_bags& bags_to, std::size_t to_slot, std::size_t count) const override {
+                    _last->reserve_messages_in_slot(bags_to, to_slot, count);
+                }
+
+                const std::string& from_port_name() const override {
+                    return _first->from_port_name();
+                }
+
+                const std::string& to_port_name() const override {
+                    return _last->to_port_name();
+                }
+
+                std::shared_ptr<const message_link_abstract<MSG>> source() const override {
+                    return _first;
+                }
+
+                std::shared_ptr<const message_link_abstract<MSG>> sink() const override {
+                    return _last;
+                }
+
+                void write_messages(const cadmium::bag<MSG>& messages, std::string& buffer) const override {
+                    _first->write_messages(messages, buffer);
+                }
+
+                void read_messages(const char*& data, const char* end, cadmium::bag<MSG>& messages) const override {
+                    _first->read_messages(data, end, messages);
+                }
             };
 
+            template<typename MSG>
+            std::shared_ptr<link_abstract> message_link_abstract<MSG>::compose(const std::shared_ptr<link_abstract>& next) const {
+                if (next->from_port_key() != this->to_port_key()) {
+                    throw std::domain_error("Composing links not sharing the intermediate port");
+                }
+
+                std::shared_ptr<message_link_abstract<MSG>> typed_next = std::dynamic_pointer_cast<message_link_abstract<MSG>>(next);
+                if (typed_next == nullptr) {
+                    throw std::domain_error("Composing links of different message types");
+                }
+                return std::make_shared<composed_link<MSG>>(this->source(), typed_next->sink());
+            }
+
             template<typename PORT_FROM, typename PORT_TO>
-            class link : public link_abstract {
+            class link : public message_link_abstract<typename PORT_FROM::message_type> {
             public:
                 using from_message_type = typename PORT_FROM::message_type;
                 using from_message_bag_type = typename cadmium::message_bag<PORT_FROM>;
@@ -71,48 +435,20 @@ namespace cadmium {
                     return typeid(from_message_bag_type);
                 }
 
-                std::type_index from_port_type_index() const override {
-                    return typeid(PORT_FROM);
+                cadmium::dynamic::port_key from_port_key() const override {
+                    return cadmium::dynamic::port_key::of<PORT_FROM>();
                 }
 
                 std::type_index to_type_index() const override {
                     return typeid(to_message_bag_type);
                 }
 
-                std::type_index to_port_type_index() const override {
-                    return typeid(PORT_TO);
+                cadmium::dynamic::port_key to_port_key() const override {
+                    return cadmium::dynamic::port_key::of<PORT_TO>();
                 }
 
-                cadmium::dynamic::logger::routed_messages
-                pass_messages(const boost::any& bag_from, boost::any& bag_to) const {
-                    from_message_bag_type b_from = boost::any_cast<from_message_bag_type>(bag_from);
-                    to_message_bag_type *b_to = boost::any_cast<to_message_bag_type>(&bag_to);
-                    b_to->messages.insert(b_to->messages.end(), b_from.messages.begin(),
-                                          b_from.messages.end());
-
-                    return cadmium::dynamic::logger::routed_messages(
-                            cadmium::logger::messages_as_strings(b_from.messages),
-                            cadmium::logger::messages_as_strings(b_to->messages),
-                            boost::typeindex::type_id<PORT_FROM>().pretty_name(),
-                            boost::typeindex::type_id<PORT_TO>().pretty_name()
-                    );
-                }
-
-                cadmium::dynamic::logger::routed_messages
-                pass_messages_to_new_bag(const boost::any& bag_from,
-                                         cadmium::dynamic::message_bags& bags_to) const {
-                    from_message_bag_type b_from = boost::any_cast<from_message_bag_type>(bag_from);
-                    to_message_bag_type b_to;
-                    b_to.messages.insert(b_to.messages.end(), b_from.messages.begin(),
-                                         b_from.messages.end());
-                    bags_to[this->to_port_type_index()] = b_to;
-
-                    return cadmium::dynamic::logger::routed_messages(
-                            cadmium::logger::messages_as_strings(b_from.messages),
-                            cadmium::logger::messages_as_strings(b_to.messages),
-                            boost::typeindex::type_id<PORT_FROM>().pretty_name(),
-                            boost::typeindex::type_id<PORT_TO>().pretty_name()
-                    );
+                std::size_t object_size() const override {
+                    return sizeof(*this);
                 }
 
                 /**
@@ -123,30 +459,152 @@ namespace cadmium {
                  * @return true if there is messages, otherwise false
                  */
                 bool is_there_messages_to_route(const cadmium::dynamic::message_bags &bags) const {
-                    return boost::any_cast<from_message_bag_type>(
-                            bags.at(this->from_port_type_index())).messages.size() > 0;
+                    return !cadmium::dynamic::bag_cast<const from_message_bag_type&>(
+                            bags.at(cadmium::dynamic::port_key::of<PORT_FROM>())).messages.empty();
+                }
+
+                const cadmium::bag<from_message_type>* messages_from(const cadmium::dynamic::message_bags& bags_from) const override {
+                    std::size_t slot = bags_from.slot_of(cadmium::dynamic::port_key::of<PORT_FROM>());
+                    return slot == cadmium::dynamic::message_bags::no_slot ? nullptr : this->messages_in_slot(bags_from, slot);
                 }
 
                 cadmium::dynamic::logger::routed_messages
-                route_messages(const cadmium::dynamic::message_bags& bags_from, cadmium::dynamic::message_bags& bags_to) const override {
-                    if (bags_from.find(this->from_port_type_index()) != bags_from.cend()) {
+                append_messages(const cadmium::bag<to_message_type>& messages, cadmium::dynamic::message_bags& bags_to, const std::string* from_port) const override {
+                    if (messages.empty() && bags_to.find(cadmium::dynamic::port_key::of<PORT_TO>()) == bags_to.end()) {
+                        return this->no_routed_messages(from_port);
+                    }
+                    return this->append_messages_in_slot(messages, bags_to, bags_to.ensure_slot(cadmium::dynamic::port_key::of<PORT_TO>()), from_port);
+                }
 
-                        if (bags_to.find(this->to_port_type_index()) != bags_to.cend()) {
-                            return this->pass_messages(bags_from.at(this->from_port_type_index()),
-                                                       bags_to.at(this->to_port_type_index()));
-                        }
+                cadmium::bag<from_message_type>* mutable_messages_from(cadmium::dynamic::message_bags& bags_from) const override {
+                    std::size_t slot = bags_from.slot_of(cadmium::dynamic::port_key::of<PORT_FROM>());
+                    return slot == cadmium::dynamic::message_bags::no_slot ? nullptr : this->mutable_messages_in_slot(bags_from, slot);
+                }
 
-                        if (this->is_there_messages_to_route(bags_from)) {
-                            return this->pass_messages_to_new_bag(
-                                    bags_from.at(this->from_port_type_index()), bags_to);
-                        }
+                cadmium::dynamic::logger::routed_messages
+                append_moved_messages(cadmium::bag<to_message_type>&& messages, cadmium::dynamic::message_bags& bags_to, const std::string* from_port) const override {
+                    if (messages.empty() && bags_to.find(cadmium::dynamic::port_key::of<PORT_TO>()) == bags_to.end()) {
+                        return this->no_routed_messages(from_port);
+                    }
+                    return this->append_moved_messages_in_slot(std::move(messages), bags_to, bags_to.ensure_slot(cadmium::dynamic::port_key::of<PORT_TO>()), from_port);
+                }
+
+                const cadmium::bag<from_message_type>* messages_in_slot(const cadmium::dynamic::message_bags& bags_from, std::size_t from_slot) const override {
+                    const cadmium::dynamic::erased_bag& b = bags_from.slot(from_slot);
+                    return b.empty() ? nullptr : &cadmium::dynamic::bag_cast<const from_message_bag_type&>(b).messages;
+                }
+
+                cadmium::bag<from_message_type>* mutable_messages_in_slot(cadmium::dynamic::message_bags& bags_from, std::size_t from_slot) const override {
+                    cadmium::dynamic::erased_bag& b = bags_from.slot(from_slot);
+                    return b.empty() ? nullptr : &cadmium::dynamic::bag_cast<from_message_bag_type&>(b).messages;
+                }
+
+                void reserve_messages_in_slot(cadmium::dynamic::message_bags& bags_to, std::size_t to_slot, std::size_t count) const override {
+                    if constexpr (cadmium::has_port_combiner<PORT_TO>::value) {
+                        // the combined messages are a single one
+                        return;
+                    }
+                    to_message_bag_type& b_to = bags_to.template get_bag_in_slot<to_message_bag_type>(to_slot);
+                    b_to.messages.reserve(b_to.messages.size() + count);
+                }
+
+                cadmium::dynamic::logger::routed_messages
+                append_messages_in_slot(const cadmium::bag<to_message_type>& messages, cadmium::dynamic::message_bags& bags_to, std::size_t to_slot, const std::string* from_port) const override {
+                    if (messages.empty() && bags_to.slot(to_slot).empty()) {
+                        return this->no_routed_messages(from_port);
+                    }
+
+                    to_message_bag_type& b_to = bags_to.template get_bag_in_slot<to_message_bag_type>(to_slot);
+                    if constexpr (cadmium::has_port_combiner<PORT_TO>::value) {
+                        combine_messages(messages, b_to.messages);
+                    } else {
+                        b_to.messages.insert(b_to.messages.end(), messages.begin(), messages.end());
+                    }
+
+                    if (from_port == nullptr) {
+                        return cadmium::dynamic::logger::routed_messages();
+                    }
+                    return cadmium::dynamic::logger::routed_messages(
+                            cadmium::logger::messages_as_strings(messages),
+                            cadmium::logger::messages_as_strings(b_to.messages),
+                            *from_port,
+                            this->to_port_name()
+                    );
+                }
+
+                cadmium::dynamic::logger::routed_messages
+                append_moved_messages_in_slot(cadmium::bag<to_message_type>&& messages, cadmium::dynamic::message_bags& bags_to, std::size_t to_slot, const std::string* from_port) const override {
+                    if (messages.empty() && bags_to.slot(to_slot).empty()) {
+                        return this->no_routed_messages(from_port);
                     }
 
-                    cadmium::dynamic::logger::routed_messages empty_ret(
-                            boost::typeindex::type_id<PORT_FROM>().pretty_name(),
-                            boost::typeindex::type_id<PORT_TO>().pretty_name()
+                    std::vector<std::string> from_messages;
+                    if (from_port != nullptr) {
+                        from_messages = cadmium::logger::messages_as_strings(messages);
+                    }
+                    to_message_bag_type& b_to = bags_to.template get_bag_in_slot<to_message_bag_type>(to_slot);
+                    if constexpr (cadmium::has_port_combiner<PORT_TO>::value) {
+                        combine_messages(messages, b_to.messages);
+                    } else if (b_to.messages.empty()) {
+                        // the destination takes the buffer of the source
+                        b_to.messages.swap(messages);
+                    } else {
+                        b_to.messages.insert(b_to.messages.end(), std::make_move_iterator(messages.begin()), std::make_move_iterator(messages.end()));
+                    }
+                    messages.clear();
+
+                    if (from_port == nullptr) {
+                        return cadmium::dynamic::logger::routed_messages();
+                    }
+                    return cadmium::dynamic::logger::routed_messages(
+                            std::move(from_messages),
+                            cadmium::logger::messages_as_strings(b_to.messages),
+                            *from_port,
+                            this->to_port_name()
                     );
-                    return empty_ret; // if no messages where routed, it returns an empty vector
+                }
+
+                const std::string& from_port_name() const override {
+                    static const std::string name = boost::typeindex::type_id<PORT_FROM>().pretty_name();
+                    return name;
+                }
+
+                const std::string& to_port_name() const override {
+                    static const std::string name = boost::typeindex::type_id<PORT_TO>().pretty_name();
+                    return name;
+                }
+
+                std::shared_ptr<const message_link_abstract<from_message_type>> source() const override {
+                    return std::static_pointer_cast<const message_link_abstract<from_message_type>>(this->shared_from_this());
+                }
+
+                std::shared_ptr<const message_link_abstract<from_message_type>> sink() const override {
+                    return this->source();
+                }
+
+                void write_messages(const cadmium::bag<from_message_type>& messages, std::string& buffer) const override {
+                    buffer.reserve(buffer.size() + serialization::serialized_size<port_serializer<PORT_FROM>>(messages));
+                    port_serializer<PORT_FROM>::write(messages, buffer);
+                }
+
+                void read_messages(const char*& data, const char* end, cadmium::bag<from_message_type>& messages) const override {
+                    port_serializer<PORT_FROM>::read(data, end, messages);
+                }
+
+            private:
+                // folds the messages into the single message of the to port bag with its port_combiner
+                static void combine_messages(const cadmium::bag<to_message_type>& messages, cadmium::bag<to_message_type>& to_messages) {
+                    auto it = messages.begin();
+                    if (it == messages.end()) {
+                        return;
+                    }
+                    if (to_messages.empty()) {
+                        to_messages.push_back(*it);
+                        ++it;
+                    }
+                    for (; it != messages.end(); ++it) {
+                        cadmium::port_combiner<PORT_TO>::combine(to_messages.front(), *it);
+                    }
                 }
             };
         }
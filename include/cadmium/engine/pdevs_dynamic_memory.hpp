@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_MEMORY_HPP
+#define CADMIUM_PDEVS_DYNAMIC_MEMORY_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <ostream>
+#include <algorithm>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief The bytes allocated by the engines, by kind. They are estimated from the objects sizes and
+             * the containers capacities, the memory owned by the messages is not counted and the states only
+             * count their allocations when cadmium::state_memory is specialized for them.
+             * - bags: the inboxes and outboxes, with the bags kept for reuse.
+             * - engines: the simulators and coordinators, with their containers.
+             * - links: the link objects, the couplings and the routing tables.
+             * - states: the atomic models states.
+             */
+            struct memory_usage {
+                std::size_t bags = 0;
+                std::size_t engines = 0;
+                std::size_t links = 0;
+                std::size_t states = 0;
+
+                std::size_t total() const noexcept {
+                    return bags + engines + links + states;
+                }
+
+                memory_usage& operator+=(const memory_usage& other) noexcept {
+                    bags += other.bags;
+                    engines += other.engines;
+                    links += other.links;
+                    states += other.states;
+                    return *this;
+                }
+            };
+
+            /**
+             * @brief The memory of a coupled model, self counts its coordinator and its atomic models and
+             * total adds its coupled models. The top model is at level 0.
+             */
+            struct model_memory {
+                std::string model_id;
+                std::size_t level = 0;
+                memory_usage self;
+                memory_usage total;
+            };
+
+            /**
+             * @brief The highest memory usage seen in the steps since the tracking was enabled, peak is the
+             * maximum of each kind and peak_total the highest total, reached at peak_time.
+             */
+            template<typename TIME>
+            struct memory_high_water {
+                memory_usage peak;
+                std::size_t peak_total = 0;
+                TIME peak_time;
+                std::size_t steps = 0;
+
+                void update(const TIME& t, const memory_usage& usage) {
+                    peak.bags = std::max(peak.bags, usage.bags);
+                    peak.engines = std::max(peak.engines, usage.engines);
+                    peak.links = std::max(peak.links, usage.links);
+                    peak.states = std::max(peak.states, usage.states);
+                    if (steps == 0 || usage.total() > peak_total) {
+                        peak_total = usage.total();
+                        peak_time = t;
+                    }
+                    steps++;
+                }
+            };
+
+            /**
+             * @brief Writes the coupled models memory as CSV, a header line and a line by coupled model.
+             */
+            inline void write_memory_csv(std::ostream& os, const std::vector<model_memory>& models) {
+                os << "model_id,level,bags,engines,links,states,self_total,total\n";
+                for (const auto& m : models) {
+                    os << m.model_id << ',' << m.level << ',' << m.self.bags << ',' << m.self.engines << ','
+                       << m.self.links << ',' << m.self.states << ',' << m.self.total() << ',' << m.total.total() << '\n';
+                }
+            }
+        }
+    }
+}
+
+#endif // CADMIUM_PDEVS_DYNAMIC_MEMORY_HPP
@@ -0,0 +1,256 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_MESSAGE_SERIALIZER_HPP
+#define CADMIUM_PDEVS_DYNAMIC_MESSAGE_SERIALIZER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+
+#include <boost/type_index.hpp>
+
+#include <cadmium/modeling/message_bag.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * Serialization of the messages sent between simulations running in different memory spaces.
+             *
+             * message_serializer<MSG> has:
+             * - static constexpr bool serializable: false if the messages of type MSG can not be serialized.
+             * - static void write(const cadmium::bag<MSG>& messages, std::string& buffer): appends the messages
+             *   to buffer.
+             * - static void read(const char*& data, const char* end, cadmium::bag<MSG>& messages): appends the
+             *   messages read from data to messages, and moves data after them.
+             *
+             * - optionally, static std::size_t serialized_size(const cadmium::bag<MSG>& messages): the bytes
+             *   written by write, used to reserve the buffer once before writing.
+             *
+             * Trivially copyable messages are copied as raw bytes, std::string messages are copied with their
+             * length and the other messages are written and read with the stream operators if they are defined.
+             * Other message types have to specialize message_serializer to be sent.
+             *
+             * The links serialize the messages of their from port with port_serializer<PORT>, which is the
+             * message_serializer of the port message type unless it is specialized for the port, for instance
+             * to write a compact encoding of the values a port sends.
+             *
+             * @note The raw bytes are only valid between the same executable running in the same architecture.
+             */
+            namespace serialization {
+
+                inline void write_size(std::uint64_t size, std::string& buffer) {
+                    buffer.append(reinterpret_cast<const char*>(&size), sizeof(size));
+                }
+
+                inline std::uint64_t read_size(const char*& data, const char* end) {
+                    std::uint64_t size;
+                    if (end - data < static_cast<std::ptrdiff_t>(sizeof(size))) {
+                        throw std::domain_error("Truncated serialized messages");
+                    }
+                    std::memcpy(&size, data, sizeof(size));
+                    data += sizeof(size);
+                    return size;
+                }
+
+                inline std::string read_bytes(const char*& data, const char* end) {
+                    std::uint64_t size = read_size(data, end);
+                    if (static_cast<std::uint64_t>(end - data) < size) {
+                        throw std::domain_error("Truncated serialized messages");
+                    }
+                    std::string ret(data, size);
+                    data += size;
+                    return ret;
+                }
+
+                // the stream reused to write the messages as text, the formatting does not allocate a stream by message
+                inline std::ostringstream& text_stream() {
+                    thread_local std::ostringstream oss;
+                    oss.str(std::string());
+                    oss.clear();
+                    oss.precision(17);
+                    return oss;
+                }
+
+                template<typename SERIALIZER, typename BAG, typename = void>
+                struct has_serialized_size : std::false_type {};
+
+                template<typename SERIALIZER, typename BAG>
+                struct has_serialized_size<SERIALIZER, BAG, std::void_t<decltype(SERIALIZER::serialized_size(std::declval<const BAG&>()))>>
+                        : std::true_type {};
+
+                /**
+                 * @return the bytes SERIALIZER writes for messages, 0 if the serializer does not tell.
+                 */
+                template<typename SERIALIZER, typename BAG>
+                std::size_t serialized_size(const BAG& messages) {
+                    if constexpr (has_serialized_size<SERIALIZER, BAG>::value) {
+                        return SERIALIZER::serialized_size(messages);
+                    } else {
+                        return 0;
+                    }
+                }
+
+                template<typename MSG, typename = void>
+                struct is_streamable : std::false_type {};
+
+                template<typename MSG>
+                struct is_streamable<MSG, std::void_t<
+                        decltype(std::declval<std::ostream&>() << std::declval<const MSG&>()),
+                        decltype(std::declval<std::istream&>() >> std::declval<MSG&>())
+                >> : std::is_default_constructible<MSG> {};
+            }
+
+            template<typename MSG, typename = void>
+            struct message_serializer {
+                static constexpr bool serializable = false;
+
+                static void write(const cadmium::bag<MSG>&, std::string&) {
+                    throw std::domain_error("There is no message_serializer for " + boost::typeindex::type_id<MSG>().pretty_name());
+                }
+
+                static void read(const char*&, const char*, cadmium::bag<MSG>&) {
+                    throw std::domain_error("There is no message_serializer for " + boost::typeindex::type_id<MSG>().pretty_name());
+                }
+            };
+
+            template<typename MSG>
+            struct message_serializer<MSG, std::enable_if_t<std::is_trivially_copyable<MSG>::value>> {
+                static constexpr bool serializable = true;
+
+                static std::size_t serialized_size(const cadmium::bag<MSG>& messages) {
+                    return sizeof(std::uint64_t) + messages.size() * sizeof(MSG);
+                }
+
+                static void write(const cadmium::bag<MSG>& messages, std::string& buffer) {
+                    serialization::write_size(messages.size(), buffer);
+                    buffer.append(reinterpret_cast<const char*>(messages.data()), messages.size() * sizeof(MSG));
+                }
+
+                static void read(const char*& data, const char* end, cadmium::bag<MSG>& messages) {
+                    std::uint64_t size = serialization::read_size(data, end);
+                    if (static_cast<std::uint64_t>(end - data) / sizeof(MSG) < size) {
+                        throw std::domain_error("Truncated serialized messages");
+                    }
+                    std::size_t first = messages.size();
+                    messages.resize(first + size);
+                    std::memcpy(static_cast<void*>(messages.data() + first), data, size * sizeof(MSG));
+                    data += size * sizeof(MSG);
+                }
+            };
+
+            template<>
+            struct message_serializer<std::string> {
+                static constexpr bool serializable = true;
+
+                static std::size_t serialized_size(const cadmium::bag<std::string>& messages) {
+                    std::size_t ret = sizeof(std::uint64_t) * (1 + messages.size());
+                    for (const auto& m : messages) {
+                        ret += m.size();
+                    }
+                    return ret;
+                }
+
+                static void write(const cadmium::bag<std::string>& messages, std::string& buffer) {
+                    serialization::write_size(messages.size(), buffer);
+                    for (const auto& m : messages) {
+                        serialization::write_size(m.size(), buffer);
+                        buffer.append(m);
+                    }
+                }
+
+                static void read(const char*& data, const char* end, cadmium::bag<std::string>& messages) {
+                    std::uint64_t size = serialization::read_size(data, end);
+                    for (std::uint64_t i = 0; i < size; i++) {
+                        messages.push_back(serialization::read_bytes(data, end));
+                    }
+                }
+            };
+
+            template<typename MSG>
+            struct message_serializer<MSG, std::enable_if_t<!std::is_trivially_copyable<MSG>::value && serialization::is_streamable<MSG>::value>> {
+                static constexpr bool serializable = true;
+
+                static void write(const cadmium::bag<MSG>& messages, std::string& buffer) {
+                    serialization::write_size(messages.size(), buffer);
+                    for (const auto& m : messages) {
+                        std::ostringstream& oss = serialization::text_stream();
+                        oss << m;
+                        const std::string text = oss.str();
+                        serialization::write_size(text.size(), buffer);
+                        buffer.append(text);
+                    }
+                }
+
+                static void read(const char*& data, const char* end, cadmium::bag<MSG>& messages) {
+                    std::uint64_t size = serialization::read_size(data, end);
+                    for (std::uint64_t i = 0; i < size; i++) {
+                        std::istringstream iss(serialization::read_bytes(data, end));
+                        MSG m;
+                        if (!(iss >> m)) {
+                            throw std::domain_error("Invalid serialized " + boost::typeindex::type_id<MSG>().pretty_name() + " message");
+                        }
+                        messages.push_back(std::move(m));
+                    }
+                }
+            };
+
+            /**
+             * @brief The serializer of the messages sent by a port, the message_serializer of its message type
+             * unless it is specialized for the port. It has the members of message_serializer.
+             */
+            template<typename PORT>
+            struct port_serializer : message_serializer<typename PORT::message_type> {};
+
+            /**
+             * @brief Appends the messages of a bag to buffer with the serializer of its port, the buffer grows
+             * once when the serializer tells its size.
+             */
+            template<typename PORT>
+            void serialize_bag(const cadmium::message_bag<PORT>& bag, std::string& buffer) {
+                buffer.reserve(buffer.size() + serialization::serialized_size<port_serializer<PORT>>(bag.messages));
+                port_serializer<PORT>::write(bag.messages, buffer);
+            }
+
+            /**
+             * @brief Appends to a bag the messages written by serialize_bag, and moves data after them.
+             */
+            template<typename PORT>
+            void deserialize_bag(const char*& data, const char* end, cadmium::message_bag<PORT>& bag) {
+                port_serializer<PORT>::read(data, end, bag.messages);
+            }
+        }
+    }
+}
+
+#endif //CADMIUM_PDEVS_DYNAMIC_MESSAGE_SERIALIZER_HPP
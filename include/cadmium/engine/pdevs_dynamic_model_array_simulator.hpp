@@ -0,0 +1,443 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_MODEL_ARRAY_SIMULATOR_HPP
+#define CADMIUM_PDEVS_DYNAMIC_MODEL_ARRAY_SIMULATOR_HPP
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cadmium/modeling/message_bag.hpp>
+#include <cadmium/modeling/dynamic_atomic.hpp>
+#include <cadmium/modeling/dynamic_instance_ports.hpp>
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+#include <cadmium/modeling/dynamic_models_helpers.hpp>
+#include <cadmium/engine/pdevs_dynamic_engine.hpp>
+#include <cadmium/engine/pdevs_dynamic_checkpoint.hpp>
+#include <cadmium/engine/pdevs_dynamic_fel.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief Detects the batch transitions of an atomic model, static functions running the internal
+             * transitions and the time advances of count contiguous instances:
+             *
+             * static void internal_transition_batch(ATOMIC* instances, std::size_t count);
+             * static void time_advance_batch(const ATOMIC* instances, std::size_t count, TIME* advances);
+             *
+             * They are loops over contiguous states the compiler can vectorize.
+             */
+            template<typename ATOMIC, typename = void>
+            struct has_internal_transition_batch : std::false_type {};
+
+            template<typename ATOMIC>
+            struct has_internal_transition_batch<ATOMIC, std::void_t<decltype(ATOMIC::internal_transition_batch(std::declval<ATOMIC*>(), std::size_t{}))>>
+                    : std::true_type {};
+
+            template<typename ATOMIC, typename TIME, typename = void>
+            struct has_time_advance_batch : std::false_type {};
+
+            template<typename ATOMIC, typename TIME>
+            struct has_time_advance_batch<ATOMIC, TIME, std::void_t<decltype(ATOMIC::time_advance_batch(std::declval<const ATOMIC*>(), std::size_t{}, std::declval<TIME*>()))>>
+                    : std::true_type {};
+
+            /**
+             * @brief Backend running the batch transitions of the model array simulator, it calls them once for
+             * the whole run of instances in the simulator thread.
+             *
+             * A backend is default constructed by each simulator and has two member functions:
+             *
+             * template<typename ATOMIC> void internal_transitions(ATOMIC* instances, std::size_t count);
+             * template<typename ATOMIC, typename TIME> void time_advances(const ATOMIC* instances, std::size_t count, TIME* advances);
+             *
+             * They must return when the count instances transitioned and their advances are written, then a
+             * backend keeping the states in a device memory copies them back before returning.
+             */
+            struct inline_batch_backend {
+                template<typename ATOMIC>
+                void internal_transitions(ATOMIC* instances, std::size_t count) {
+                    ATOMIC::internal_transition_batch(instances, count);
+                }
+
+                template<typename ATOMIC, typename TIME>
+                void time_advances(const ATOMIC* instances, std::size_t count, TIME* advances) {
+                    ATOMIC::time_advance_batch(instances, count, advances);
+                }
+            };
+
+            /**
+             * @brief Backend splitting the runs of instances in chunks of GRAIN instances, the batch transitions of
+             * the chunks are called by the for_each_index of an execution policy (see pdevs_dynamic_execution.hpp).
+             * The runs shorter than a chunk are run by a single call as the inline backend does.
+             *
+             * @tparam EXECUTION - The execution policy, it is default constructed.
+             * @tparam GRAIN - The instances in a chunk.
+             */
+            template<typename EXECUTION, std::size_t GRAIN = 1024>
+            class chunked_batch_backend {
+                static_assert(GRAIN > 0, "The chunks need at least one instance");
+
+                EXECUTION _execution;
+
+            public:
+                template<typename ATOMIC>
+                void internal_transitions(ATOMIC* instances, std::size_t count) {
+                    _execution.for_each_index((count + GRAIN - 1) / GRAIN, [instances, count](std::size_t c) {
+                        std::size_t first = c * GRAIN;
+                        ATOMIC::internal_transition_batch(instances + first, std::min(GRAIN, count - first));
+                    });
+                }
+
+                template<typename ATOMIC, typename TIME>
+                void time_advances(const ATOMIC* instances, std::size_t count, TIME* advances) {
+                    _execution.for_each_index((count + GRAIN - 1) / GRAIN, [instances, count, advances](std::size_t c) {
+                        std::size_t first = c * GRAIN;
+                        ATOMIC::time_advance_batch(instances + first, std::min(GRAIN, count - first), advances + first);
+                    });
+                }
+            };
+
+            /**
+             * @brief The batch backend of the model arrays of an atomic model, specialize it to run them by
+             * another backend than the inline one:
+             *
+             *     template<> struct cadmium::dynamic::engine::model_array_backend<my_atomic<float>> {
+             *         using type = cadmium::dynamic::engine::chunked_batch_backend<parallel_execution>;
+             *     };
+             */
+            template<typename ATOMIC>
+            struct model_array_backend {
+                using type = inline_batch_backend;
+            };
+
+            /**
+             * @brief The model array simulator runs all the instances of a model array as a single engine.
+             *
+             * The instances are kept in a single vector and their last times in another one, the next times are
+             * kept by a heap FEL. The transitions of a step run in a loop over the imminent instances and the ones
+             * receiving messages, no instance has an engine, a shared pointer or boundary bags of its own.
+             * The input messages are given to the instance of their index, the output messages carry the index of
+             * the instance sending them.
+             *
+             * When the atomic model has batch transitions (see has_internal_transition_batch), the imminent
+             * instances receiving no messages are sorted and their runs of contiguous instances are given to
+             * the batch transitions at once, by the backend of the model (see model_array_backend).
+             *
+             * The instances are not logged nor profiled, as the models run by an engine of their own.
+             *
+             * @tparam ATOMIC - The atomic model type of the instances.
+             * @tparam TIME - The simulation time type.
+             */
+            template<template<typename T> class ATOMIC, typename TIME>
+            class model_array_simulator : public engine<TIME> {
+                using atomic_type = ATOMIC<TIME>;
+                using input_ports = typename atomic_type::input_ports;
+                using output_ports = typename atomic_type::output_ports;
+                using in_bags_type = typename make_message_bags<input_ports>::type;
+                using out_bags_type = typename make_message_bags<output_ports>::type;
+
+                static constexpr std::size_t no_bags = std::numeric_limits<std::size_t>::max();
+                static constexpr bool batch_internal = has_internal_transition_batch<atomic_type>::value;
+                static constexpr bool batch_time_advance = has_time_advance_batch<atomic_type, TIME>::value;
+
+                std::shared_ptr<std::vector<atomic_type>> _instances;
+                std::string _model_id;
+                std::vector<TIME> _last;
+                std::vector<TIME> _next;
+                heap_fel<TIME> _fel;
+
+                // the input bags of the instances receiving messages in the current step, they are reused
+                std::vector<std::size_t> _bags_of; // the input bags index by instance, no_bags if it receives none
+                std::vector<in_bags_type> _input_bags;
+                std::vector<std::size_t> _receivers;
+                std::vector<std::size_t> _imminent;
+                std::vector<TIME> _advances; // the time advances of a run of instances
+                typename model_array_backend<atomic_type>::type _backend;
+
+                // the I-th slot of the boxes is the one of the I-th port
+                template<std::size_t I>
+                void give_input_messages() {
+                    using port_type = typename std::tuple_element<I, input_ports>::type;
+                    using bag_type = cadmium::message_bag<cadmium::dynamic::modeling::instance_port<port_type>>;
+                    cadmium::dynamic::erased_bag& b = _inbox.slot(I);
+                    if (b.empty()) {
+                        return;
+                    }
+                    for (auto& m : cadmium::dynamic::bag_cast<bag_type&>(b).messages) {
+                        if (m.instance >= _instances->size()) {
+                            throw std::domain_error("Message to an invalid instance of the model array " + _model_id);
+                        }
+                        std::size_t& bags = _bags_of[m.instance];
+                        if (bags == no_bags) {
+                            bags = _receivers.size();
+                            _receivers.push_back(m.instance);
+                            if (_input_bags.size() <= bags) {
+                                _input_bags.emplace_back();
+                            }
+                        }
+                        cadmium::get_messages<port_type>(_input_bags[bags]).push_back(std::move(m.value));
+                    }
+                }
+
+                template<std::size_t I>
+                void take_output_messages(std::size_t instance, out_bags_type& outputs) {
+                    using port_type = typename std::tuple_element<I, output_ports>::type;
+                    using bag_type = cadmium::message_bag<cadmium::dynamic::modeling::instance_port<port_type>>;
+                    auto& messages = cadmium::get_messages<port_type>(outputs);
+                    if (messages.empty()) {
+                        return;
+                    }
+                    auto& to_messages = _outbox.template get_bag_in_slot<bag_type>(I).messages;
+                    for (auto& m : messages) {
+                        to_messages.push_back(cadmium::dynamic::modeling::instance_message<typename port_type::message_type>{instance, std::move(m)});
+                    }
+                }
+
+                template<std::size_t... Is>
+                void give_input_messages(std::index_sequence<Is...>) {
+                    (give_input_messages<Is>(), ...);
+                }
+
+                template<std::size_t... Is>
+                void take_output_messages(std::size_t instance, out_bags_type& outputs, std::index_sequence<Is...>) {
+                    (take_output_messages<Is>(instance, outputs), ...);
+                }
+
+                void schedule(std::size_t instance, const TIME& t) {
+                    _last[instance] = t;
+                    _next[instance] = t + (*_instances)[instance].time_advance();
+                    _fel.update(instance, _next[instance]);
+                }
+
+                // schedules the count instances from first after a transition at t
+                void schedule_run(std::size_t first, std::size_t count, const TIME& t) {
+                    if constexpr (batch_time_advance) {
+                        _advances.resize(count);
+                        _backend.time_advances(static_cast<const atomic_type*>(_instances->data() + first), count, _advances.data());
+                        for (std::size_t k = 0; k < count; k++) {
+                            _last[first + k] = t;
+                            _next[first + k] = t + _advances[k];
+                            _fel.update(first + k, _next[first + k]);
+                        }
+                    } else {
+                        for (std::size_t i = first; i < first + count; i++) {
+                            schedule(i, t);
+                        }
+                    }
+                }
+
+                // the internal transitions of the imminent instances receiving no messages
+                void run_internal_transitions(const TIME& t) {
+                    std::vector<atomic_type>& instances = *_instances;
+                    if constexpr (batch_internal) {
+                        std::sort(_imminent.begin(), _imminent.end());
+                        std::size_t k = 0;
+                        while (k < _imminent.size()) {
+                            if (_bags_of[_imminent[k]] != no_bags) {
+                                k++;
+                                continue;
+                            }
+                            std::size_t first = _imminent[k];
+                            std::size_t count = 1;
+                            while (k + count < _imminent.size() && _imminent[k + count] == first + count && _bags_of[first + count] == no_bags) {
+                                count++;
+                            }
+                            _backend.internal_transitions(instances.data() + first, count);
+                            schedule_run(first, count, t);
+                            k += count;
+                        }
+                    } else {
+                        for (std::size_t i : _imminent) {
+                            if (_bags_of[i] == no_bags) {
+                                instances[i].internal_transition();
+                                schedule(i, t);
+                            }
+                        }
+                    }
+                }
+
+            public:
+
+                cadmium::dynamic::message_bags _inbox;
+                cadmium::dynamic::message_bags _outbox;
+
+                model_array_simulator() = delete;
+
+                /**
+                 * @brief The simulator runs the instances in place, as the simulators run the atomic models.
+                 */
+                model_array_simulator(std::string model_id, std::shared_ptr<std::vector<atomic_type>> instances)
+                : _instances(std::move(instances)), _model_id(std::move(model_id)),
+                  _inbox(cadmium::dynamic::modeling::create_dynamic_ports<typename cadmium::dynamic::modeling::make_instance_ports<input_ports>::type>()),
+                  _outbox(cadmium::dynamic::modeling::create_dynamic_ports<typename cadmium::dynamic::modeling::make_instance_ports<output_ports>::type>()) {}
+
+                void init(TIME initial_time) override {
+                    std::size_t n = _instances->size();
+                    _last.assign(n, initial_time);
+                    _next.assign(n, std::numeric_limits<TIME>::infinity());
+                    _bags_of.assign(n, no_bags);
+                    _fel.reset(n);
+                    schedule_run(0, n, initial_time);
+                }
+
+                const std::string& get_model_id() const override {
+                    return _model_id;
+                }
+
+                void set_logged_models(const std::unordered_set<std::string>&) override {}
+
+                void set_profiling(bool) override {}
+
+                void collect_profiles(std::vector<model_profile>&) const override {}
+
+                void collect_link_profiles(std::vector<link_profile>&) const override {}
+
+                void set_counters(hierarchy_counters*, std::size_t) override {}
+
+                void account_memory(memory_usage& usage, std::vector<model_memory>&, std::size_t) const override {
+                    using state_type = typename atomic_type::state_type;
+                    usage.bags += _outbox.allocated_bytes() + _inbox.allocated_bytes() + _input_bags.capacity() * sizeof(in_bags_type);
+                    usage.engines += sizeof(*this) + (_last.capacity() + _next.capacity()) * sizeof(TIME)
+                            + (_bags_of.capacity() + _receivers.capacity() + _imminent.capacity()) * sizeof(std::size_t)
+                            + _advances.capacity() * sizeof(TIME)
+                            + _instances->size() * (sizeof(TIME) + 2 * sizeof(std::size_t)); // the heap FEL
+                    usage.states += _instances->capacity() * sizeof(atomic_type);
+                    for (const auto& instance : *_instances) {
+                        usage.states += cadmium::state_memory<state_type>::heap_bytes(instance.state);
+                    }
+                }
+
+                void save_checkpoint(std::string& buffer) const override {
+                    using state_type = typename atomic_type::state_type;
+                    checkpoint::write_engine(_model_id, _inbox, _outbox, buffer);
+                    checkpoint::write_value(static_cast<std::uint64_t>(_instances->size()), buffer);
+                    for (std::size_t i = 0; i < _instances->size(); i++) {
+                        checkpoint::write_value(_last[i], buffer);
+                        checkpoint::write_value(_next[i], buffer);
+                        cadmium::state_serializer<state_type>::write((*_instances)[i].state, buffer);
+                    }
+                }
+
+                void restore_checkpoint(const char*& data, const char* end) override {
+                    using state_type = typename atomic_type::state_type;
+                    checkpoint::read_engine(_model_id, data, end);
+                    std::size_t n = _instances->size();
+                    if (checkpoint::read_value<std::uint64_t>(data, end) != n) {
+                        throw std::domain_error("The checkpoint of " + _model_id + " has a different number of instances");
+                    }
+                    _last.resize(n);
+                    _next.resize(n);
+                    _bags_of.assign(n, no_bags);
+                    _receivers.clear();
+                    _fel.reset(n);
+                    for (std::size_t i = 0; i < n; i++) {
+                        _last[i] = checkpoint::read_value<TIME>(data, end);
+                        _next[i] = checkpoint::read_value<TIME>(data, end);
+                        cadmium::state_serializer<state_type>::read(data, end, (*_instances)[i].state);
+                        _fel.update(i, _next[i]);
+                    }
+                }
+
+                TIME next() const noexcept override {
+                    return _fel.next();
+                }
+
+                void collect_outputs(const TIME &t) override {
+                    _outbox.clear();
+                    if (_fel.next() < t) {
+                        throw std::domain_error("Trying to obtain output when not internal event is scheduled");
+                    } else if (_fel.next() == t) {
+                        _imminent.clear();
+                        _fel.imminent(t, _imminent);
+                        for (std::size_t i : _imminent) {
+                            out_bags_type outputs = (*_instances)[i].output();
+                            take_output_messages(i, outputs, std::make_index_sequence<std::tuple_size<output_ports>::value>{});
+                        }
+                    }
+                }
+
+                /**
+                 * @brief outbox keeps the output generated by the last call to collect_outputs
+                 */
+                cadmium::dynamic::message_bags& outbox() override {
+                    return _outbox;
+                }
+
+                cadmium::dynamic::message_bags& inbox() override {
+                    return _inbox;
+                }
+
+                /**
+                 * @brief Runs the transitions of the instances receiving messages and of the imminent ones.
+                 */
+                void advance_simulation(const TIME &t) override {
+                    _outbox.clear();
+                    if (_fel.next() < t) {
+                        throw std::domain_error("Event received for executing after next internal event");
+                    }
+
+                    give_input_messages(std::make_index_sequence<std::tuple_size<input_ports>::value>{});
+                    _inbox.clear();
+
+                    _imminent.clear();
+                    if (_fel.next() == t) {
+                        _fel.imminent(t, _imminent);
+                    }
+                    run_internal_transitions(t);
+                    std::vector<atomic_type>& instances = *_instances;
+                    for (std::size_t k = 0; k < _receivers.size(); k++) {
+                        std::size_t i = _receivers[k];
+                        in_bags_type& bags = _input_bags[k];
+                        if (t < _last[i]) {
+                            throw std::domain_error("Event received for executing in the past of current simulation time");
+                        }
+                        // the bags are moved to the transition, then left empty for the next step
+                        if (_next[i] == t) {
+                            instances[i].confluence_transition(t - _last[i], std::move(bags));
+                        } else {
+                            instances[i].external_transition(t - _last[i], std::move(bags));
+                        }
+                        bags = in_bags_type();
+                        _bags_of[i] = no_bags;
+                        schedule(i, t);
+                    }
+                    _receivers.clear();
+                }
+            };
+        }
+    }
+}
+
+#endif //CADMIUM_PDEVS_DYNAMIC_MODEL_ARRAY_SIMULATOR_HPP
@@ -0,0 +1,126 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_MPI_COMMUNICATOR_HPP
+#define CADMIUM_PDEVS_DYNAMIC_MPI_COMMUNICATOR_HPP
+
+#include <string>
+#include <vector>
+#include <numeric>
+#include <stdexcept>
+
+#include <mpi.h>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief Communicator between the ranks of an MPI communicator, see pdevs_dynamic_communicator.hpp.
+             *
+             * @note MPI must be initialized before creating the communicator and finalized after the last
+             * simulation using it finished.
+             */
+            class mpi_communicator {
+                MPI_Comm _comm;
+                std::size_t _rank;
+                std::size_t _size;
+
+                static void check(int result) {
+                    if (result != MPI_SUCCESS) {
+                        throw std::domain_error("MPI communication failed");
+                    }
+                }
+
+                static std::vector<int> displacements(const std::vector<int>& counts) {
+                    std::vector<int> ret(counts.size(), 0);
+                    std::partial_sum(counts.begin(), counts.end() - 1, ret.begin() + 1);
+                    return ret;
+                }
+
+                static std::vector<std::string> split(const std::vector<char>& data, const std::vector<int>& counts, const std::vector<int>& displs) {
+                    std::vector<std::string> ret(counts.size());
+                    for (std::size_t r = 0; r < counts.size(); r++) {
+                        ret[r].assign(data.data() + displs[r], counts[r]);
+                    }
+                    return ret;
+                }
+
+            public:
+                explicit mpi_communicator(MPI_Comm comm = MPI_COMM_WORLD)
+                : _comm(comm) {
+                    int rank, size;
+                    check(MPI_Comm_rank(_comm, &rank));
+                    check(MPI_Comm_size(_comm, &size));
+                    _rank = static_cast<std::size_t>(rank);
+                    _size = static_cast<std::size_t>(size);
+                }
+
+                std::size_t rank() const noexcept {
+                    return _rank;
+                }
+
+                std::size_t size() const noexcept {
+                    return _size;
+                }
+
+                std::vector<std::string> all_gather(const std::string& data) {
+                    int count = static_cast<int>(data.size());
+                    std::vector<int> counts(_size);
+                    check(MPI_Allgather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, _comm));
+
+                    std::vector<int> displs = displacements(counts);
+                    std::vector<char> received(displs.back() + counts.back());
+                    check(MPI_Allgatherv(data.data(), count, MPI_CHAR, received.data(), counts.data(), displs.data(), MPI_CHAR, _comm));
+                    return split(received, counts, displs);
+                }
+
+                std::vector<std::string> all_to_all(std::vector<std::string> data) {
+                    if (data.size() != _size) {
+                        throw std::domain_error("Sending data to an invalid number of ranks");
+                    }
+                    std::vector<int> send_counts(_size);
+                    std::string sent;
+                    for (std::size_t r = 0; r < _size; r++) {
+                        send_counts[r] = static_cast<int>(data[r].size());
+                        sent.append(data[r]);
+                    }
+                    std::vector<int> receive_counts(_size);
+                    check(MPI_Alltoall(send_counts.data(), 1, MPI_INT, receive_counts.data(), 1, MPI_INT, _comm));
+
+                    std::vector<int> send_displs = displacements(send_counts);
+                    std::vector<int> receive_displs = displacements(receive_counts);
+                    std::vector<char> received(receive_displs.back() + receive_counts.back());
+                    check(MPI_Alltoallv(sent.data(), send_counts.data(), send_displs.data(), MPI_CHAR,
+                                        received.data(), receive_counts.data(), receive_displs.data(), MPI_CHAR, _comm));
+                    return split(received, receive_counts, receive_displs);
+                }
+            };
+        }
+    }
+}
+
+#endif //CADMIUM_PDEVS_DYNAMIC_MPI_COMMUNICATOR_HPP
@@ -0,0 +1,428 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_OPTIMISTIC_RUNNER_HPP
+#define CADMIUM_PDEVS_DYNAMIC_OPTIMISTIC_RUNNER_HPP
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <limits>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/any.hpp>
+
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_execution.hpp>
+#include <cadmium/modeling/dynamic_model_flattener.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief The optimistic runner runs the simulation Time Warp style. The model hierarchy is flattened and
+             * its atomic models are distributed in logical processes that execute their events speculatively, without
+             * waiting for the other processes.
+             *
+             * Before each step a logical process saves the state of the atomic models it transitions. When a message
+             * arrives with a time the process already passed (a straggler), the process rolls back restoring the saved
+             * states, and sends anti-messages to cancel the messages it sent from the undone steps. The processes run
+             * in rounds, at the end of each round the messages are exchanged, the global virtual time (GVT) is computed
+             * and the saved states older than the GVT are discarded, no process can be rolled back before it.
+             *
+             * @note Only the committed events are reflected in the models when run_until returns. The LOGGER is only
+             * used for the runner information and the GVT, the speculative steps are not logged.
+             *
+             * @param TIME Representation of time to be used to run the simualtion
+             * @param LOGGER what, where and how to log from the simulation
+             * @param EXECUTION the policy used to run the logical processes, see pdevs_dynamic_execution.hpp
+             */
+            template<class TIME, typename LOGGER=default_logger<TIME>, typename EXECUTION=cadmium::dynamic::engine::parallel_execution>
+            class optimistic_runner {
+                using atomic_type = cadmium::dynamic::modeling::atomic_abstract<TIME>;
+
+                // an IC between two atomic models of the same logical process
+                struct local_coupling {
+                    std::size_t to_model;
+                    std::shared_ptr<cadmium::dynamic::engine::link_abstract> link;
+                };
+
+                // an IC between atomic models of different logical processes
+                struct cross_coupling {
+                    std::size_t to_process;
+                    std::size_t to_model;
+                    std::shared_ptr<cadmium::dynamic::engine::link_abstract> link;
+                };
+
+                // a message sent through a cross coupling, or the anti-message cancelling it
+                struct event_message {
+                    TIME time;
+                    std::size_t coupling;
+                    std::size_t source; // the process sending the message
+                    std::uint64_t id; // unique among the messages sent by the source
+                    bool anti;
+                    cadmium::dynamic::message_bags bags; // the bag of the coupling from port, empty for anti-messages
+                };
+
+                struct saved_model {
+                    std::size_t model;
+                    boost::any state;
+                    TIME last;
+                    TIME next;
+                };
+
+                struct processed_step {
+                    TIME time;
+                    std::vector<saved_model> saved; // the models as they were before the step
+                    std::vector<event_message> inputs; // the messages consumed by the step
+                    std::vector<event_message> sent; // anti-messages of the messages sent by the step
+                };
+
+                struct logical_process {
+                    std::vector<std::shared_ptr<atomic_type>> models;
+                    std::vector<TIME> last;
+                    std::vector<TIME> next;
+                    std::vector<cadmium::dynamic::message_bags> inboxes;
+                    std::vector<std::vector<local_coupling>> local_couplings; // by source model
+                    std::vector<std::vector<std::size_t>> cross_couplings; // by source model
+
+                    std::vector<event_message> incoming; // received at the end of the last round
+                    std::vector<event_message> inputs; // received and not consumed yet
+                    std::vector<event_message> outgoing; // sent in the current round
+                    std::deque<processed_step> history; // steps that can still be rolled back
+                    std::uint64_t sequence = 0;
+                    std::size_t rollbacks = 0;
+
+                    std::vector<std::size_t> active; // scratch list of models transitioning in a step
+                };
+
+                std::vector<cross_coupling> _couplings;
+                std::vector<logical_process> _processes;
+                std::size_t _batch;
+                EXECUTION _execution;
+                TIME _gvt;
+
+                static TIME next_time(const logical_process& p) {
+                    TIME ret = std::numeric_limits<TIME>::infinity();
+                    for (const TIME& n : p.next) {
+                        ret = std::min(ret, n);
+                    }
+                    for (const auto& m : p.inputs) {
+                        ret = std::min(ret, m.time);
+                    }
+                    return ret;
+                }
+
+                // undoes all the steps at ts or later
+                static void rollback(logical_process& p, const TIME& ts) {
+                    bool rolled_back = false;
+                    while (!p.history.empty() && ts <= p.history.back().time) {
+                        processed_step& step = p.history.back();
+                        for (auto& s : step.saved) {
+                            p.models[s.model]->set_state(s.state);
+                            p.last[s.model] = s.last;
+                            p.next[s.model] = s.next;
+                        }
+                        for (auto& m : step.inputs) {
+                            p.inputs.push_back(std::move(m));
+                        }
+                        for (auto& anti : step.sent) {
+                            p.outgoing.push_back(std::move(anti));
+                        }
+                        p.history.pop_back();
+                        rolled_back = true;
+                    }
+                    if (rolled_back) {
+                        p.rollbacks++;
+                    }
+                }
+
+                // stragglers and anti-messages roll back the process before being accepted
+                static void absorb_incoming(logical_process& p) {
+                    for (auto& m : p.incoming) {
+                        if (!p.history.empty() && m.time <= p.history.back().time) {
+                            rollback(p, m.time);
+                        }
+
+                        if (m.anti) {
+                            auto it = std::find_if(p.inputs.begin(), p.inputs.end(), [&m](const auto& i) {
+                                return i.source == m.source && i.id == m.id;
+                            });
+                            if (it == p.inputs.end()) {
+                                throw std::domain_error("Anti-message received for an unknown message");
+                            }
+                            p.inputs.erase(it);
+                        } else {
+                            p.inputs.push_back(std::move(m));
+                        }
+                    }
+                    p.incoming.clear();
+                }
+
+                void process_step(std::size_t process, const TIME& t) {
+                    logical_process& p = _processes[process];
+                    processed_step step;
+                    step.time = t;
+                    p.active.clear();
+
+                    // outputs of the imminent models
+                    std::vector<cadmium::dynamic::message_bags> outboxes(p.models.size());
+                    for (std::size_t i = 0; i < p.models.size(); i++) {
+                        if (p.next[i] != t) {
+                            continue;
+                        }
+                        p.active.push_back(i);
+                        cadmium::dynamic::message_bags& outbox = outboxes[i];
+                        p.models[i]->output(outbox);
+
+                        for (const auto& c : p.local_couplings[i]) {
+                            c.link->route_messages(outbox, p.inboxes[c.to_model], false);
+                        }
+
+                        for (std::size_t c : p.cross_couplings[i]) {
+                            const auto& link = _couplings[c].link;
+                            if (link->has_messages(outbox)) {
+                                event_message m{t, c, process, p.sequence++, false, cadmium::dynamic::message_bags()};
+                                m.bags.emplace(link->from_port_key(), outbox.at(link->from_port_key()));
+                                step.sent.push_back(event_message{t, c, process, m.id, true, cadmium::dynamic::message_bags()});
+                                p.outgoing.push_back(std::move(m));
+                            }
+                        }
+                    }
+
+                    // messages received from other processes
+                    auto consumed = std::stable_partition(p.inputs.begin(), p.inputs.end(), [&t](const auto& m) { return m.time != t; });
+                    for (auto it = consumed; it != p.inputs.end(); ++it) {
+                        const cross_coupling& c = _couplings[it->coupling];
+                        c.link->route_messages(it->bags, p.inboxes[c.to_model], false);
+                        step.inputs.push_back(std::move(*it));
+                    }
+                    p.inputs.erase(consumed, p.inputs.end());
+
+                    for (std::size_t i = 0; i < p.models.size(); i++) {
+                        if (!p.inboxes[i].empty() && p.next[i] != t) {
+                            p.active.push_back(i);
+                        }
+                    }
+
+                    // transitions
+                    for (std::size_t i : p.active) {
+                        step.saved.push_back(saved_model{i, p.models[i]->get_state(), p.last[i], p.next[i]});
+                        if (!p.inboxes[i].empty()) {
+                            if (p.next[i] == t) {
+                                p.models[i]->confluence_transition(t - p.last[i], std::move(p.inboxes[i]));
+                            } else {
+                                p.models[i]->external_transition(t - p.last[i], std::move(p.inboxes[i]));
+                            }
+                        } else {
+                            p.models[i]->internal_transition();
+                        }
+                        p.last[i] = t;
+                        p.next[i] = t + p.models[i]->time_advance();
+                        p.inboxes[i].clear();
+                    }
+
+                    p.history.push_back(std::move(step));
+                }
+
+                void exchange_messages() {
+                    for (auto& p : _processes) {
+                        for (auto& m : p.outgoing) {
+                            _processes[_couplings[m.coupling].to_process].incoming.push_back(std::move(m));
+                        }
+                        p.outgoing.clear();
+                    }
+                }
+
+                TIME compute_gvt() const {
+                    TIME ret = std::numeric_limits<TIME>::infinity();
+                    for (const auto& p : _processes) {
+                        ret = std::min(ret, next_time(p));
+                        for (const auto& m : p.incoming) {
+                            ret = std::min(ret, m.time);
+                        }
+                    }
+                    return ret;
+                }
+
+                // the steps before the GVT will never be rolled back
+                void collect_fossils() {
+                    for (auto& p : _processes) {
+                        while (!p.history.empty() && p.history.front().time < _gvt) {
+                            p.history.pop_front();
+                        }
+                    }
+                }
+
+            public:
+                /**
+                 * @brief set the dynamic parameters for the simulation
+                 * @param coupled_model is the top model, it is flattened and its atomic models are distributed in
+                 * the logical processes.
+                 * @param init_time is the initial time of the simulation.
+                 * @param partitions are the ids of the atomic models run by each logical process, each atomic model
+                 * must be in exactly one partition.
+                 * @param batch is the maximum number of steps a logical process runs on each round.
+                 * @param execution is the execution policy used to run the logical processes.
+                 */
+                optimistic_runner(
+                        std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> coupled_model,
+                        const TIME &init_time,
+                        const std::vector<std::vector<std::string>>& partitions,
+                        std::size_t batch = 64,
+                        const EXECUTION& execution = EXECUTION()
+                ) : _batch(batch == 0 ? 1 : batch), _execution(execution) {
+                    LOGGER::template log<cadmium::logger::logger_global_time, cadmium::logger::run_global_time>(init_time);
+                    LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Preparing model");
+
+                    std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> flat = cadmium::dynamic::modeling::flatten<TIME>(coupled_model);
+                    std::map<std::string, std::shared_ptr<atomic_type>> models_by_id;
+                    for (const auto& m : flat->_models) {
+                        models_by_id.insert(std::make_pair(m->get_id(), std::dynamic_pointer_cast<atomic_type>(m)));
+                    }
+
+                    // process and model index of each atomic model
+                    std::map<std::string, std::pair<std::size_t, std::size_t>> location;
+                    _processes.resize(partitions.size());
+                    for (std::size_t p = 0; p < partitions.size(); p++) {
+                        if (partitions[p].empty()) {
+                            throw std::domain_error("Empty partition for a logical process");
+                        }
+                        for (const auto& id : partitions[p]) {
+                            if (models_by_id.find(id) == models_by_id.end()) {
+                                throw std::domain_error("Partition with invalid atomic model " + id);
+                            }
+                            if (!location.insert(std::make_pair(id, std::make_pair(p, _processes[p].models.size()))).second) {
+                                throw std::domain_error("Atomic model " + id + " is in more than one partition");
+                            }
+                            _processes[p].models.push_back(models_by_id.at(id));
+                        }
+
+                        std::size_t size = _processes[p].models.size();
+                        _processes[p].last.assign(size, init_time);
+                        _processes[p].inboxes.resize(size);
+                        _processes[p].local_couplings.resize(size);
+                        _processes[p].cross_couplings.resize(size);
+                        for (const auto& m : _processes[p].models) {
+                            _processes[p].next.push_back(init_time + m->time_advance());
+                        }
+                    }
+                    if (location.size() != models_by_id.size()) {
+                        throw std::domain_error("There are atomic models not assigned to any partition");
+                    }
+
+                    for (const auto& ic : flat->_ic) {
+                        auto from = location.at(ic._from);
+                        auto to = location.at(ic._to);
+                        if (from.first == to.first) {
+                            _processes[from.first].local_couplings[from.second].push_back(local_coupling{to.second, ic._link});
+                        } else {
+                            _processes[from.first].cross_couplings[from.second].push_back(_couplings.size());
+                            _couplings.push_back(cross_coupling{to.first, to.second, ic._link});
+                        }
+                    }
+
+                    _gvt = compute_gvt();
+                }
+
+                /**
+                 * @brief runUntil starts the simulation and stops when the next event is scheduled after t.
+                 * @param t is the limit time for the simulation.
+                 * @return the TIME of the next event to happen when simulation stopped.
+                 */
+                TIME run_until(const TIME &t) {
+                    LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Starting run");
+                    while (_gvt < t) {
+                        LOGGER::template log<cadmium::logger::logger_global_time, cadmium::logger::run_global_time>(_gvt);
+
+                        _execution.for_each_index(_processes.size(), [this, &t](std::size_t i) {
+                            logical_process& p = _processes[i];
+                            absorb_incoming(p);
+                            for (std::size_t steps = 0; steps < _batch; steps++) {
+                                TIME e = next_time(p);
+                                if (!(e < t)) {
+                                    break;
+                                }
+                                this->process_step(i, e);
+                            }
+                        });
+
+                        exchange_messages();
+                        _gvt = compute_gvt();
+                        collect_fossils();
+                        // the saved steps keep their bags alive, the release is deferred until they are collected
+                        cadmium::message_arena::instance().release();
+                    }
+                    LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Finished run");
+                    return _gvt;
+                }
+
+                /**
+                 * @brief runUntilPassivate starts the simulation and stops when there is no next internal event to happen.
+                 */
+                void run_until_passivate() {
+                    run_until(std::numeric_limits<TIME>::infinity());
+                }
+
+                /**
+                 * @brief the number of logical processes.
+                 */
+                std::size_t processes() const noexcept {
+                    return _processes.size();
+                }
+
+                /**
+                 * @brief the number of rollbacks done by all the logical processes since the runner was created.
+                 */
+                std::size_t rollbacks() const noexcept {
+                    std::size_t ret = 0;
+                    for (const auto& p : _processes) {
+                        ret += p.rollbacks;
+                    }
+                    return ret;
+                }
+
+                /**
+                 * @brief the number of steps kept to be rolled back, it is bounded by the fossil collection.
+                 */
+                std::size_t saved_steps() const noexcept {
+                    std::size_t ret = 0;
+                    for (const auto& p : _processes) {
+                        ret += p.history.size();
+                    }
+                    return ret;
+                }
+            };
+        }
+    }
+}
+
+#endif //CADMIUM_PDEVS_DYNAMIC_OPTIMISTIC_RUNNER_HPP
@@ -0,0 +1,521 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_PARTITIONER_HPP
+#define CADMIUM_PDEVS_DYNAMIC_PARTITIONER_HPP
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/engine/pdevs_dynamic_profile.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief The coupling graph of a coupled model: a vertex by submodel and an undirected edge between
+             * the submodels coupled by ICs, weighted by their links. The EICs and EOCs do not couple submodels,
+             * they add their weight to the vertex of their submodel when it is weighted by a profiling run.
+             */
+            class coupling_graph {
+                std::string _model_id;
+                std::vector<std::string> _ids;
+                std::unordered_map<std::string, std::size_t> _indexes;
+                std::unordered_map<std::string, std::size_t> _atomic_owners; // the vertex of each atomic model
+                std::vector<double> _vertex_weights;
+                std::vector<std::map<std::size_t, double>> _edges;
+
+                template<typename TIME>
+                void add_atomics(const std::shared_ptr<cadmium::dynamic::modeling::model>& m, std::size_t vertex) {
+                    auto coupled = std::dynamic_pointer_cast<cadmium::dynamic::modeling::coupled<TIME>>(m);
+                    if (coupled == nullptr) {
+                        _atomic_owners.emplace(m->get_id(), vertex);
+                        return;
+                    }
+                    for (const auto& sub : coupled->_models) {
+                        add_atomics<TIME>(sub, vertex);
+                    }
+                }
+
+            public:
+                /**
+                 * @param link_weight is the weight of the edge of each IC link, the vertices weight 1.
+                 */
+                template<typename TIME>
+                explicit coupling_graph(const cadmium::dynamic::modeling::coupled<TIME>& model, double link_weight = 1.0)
+                : _model_id(model.get_id()) {
+                    for (const auto& m : model._models) {
+                        _indexes.emplace(m->get_id(), _ids.size());
+                        add_atomics<TIME>(m, _ids.size());
+                        _ids.push_back(m->get_id());
+                    }
+                    _vertex_weights.assign(_ids.size(), 1.0);
+                    _edges.resize(_ids.size());
+                    for (const auto& ic : model._ic) {
+                        add_edge_weight(ic._from, ic._to, link_weight);
+                    }
+                }
+
+                std::size_t size() const noexcept {
+                    return _ids.size();
+                }
+
+                const std::string& id(std::size_t vertex) const {
+                    return _ids.at(vertex);
+                }
+
+                std::size_t index_of(const std::string& id) const {
+                    auto it = _indexes.find(id);
+                    if (it == _indexes.end()) {
+                        throw std::domain_error("Model " + id + " is not a submodel of " + _model_id);
+                    }
+                    return it->second;
+                }
+
+                double vertex_weight(std::size_t vertex) const {
+                    return _vertex_weights.at(vertex);
+                }
+
+                // the neighbours of a vertex and the weight of their edge
+                const std::map<std::size_t, double>& edges(std::size_t vertex) const {
+                    return _edges.at(vertex);
+                }
+
+                void add_vertex_weight(const std::string& id, double weight) {
+                    _vertex_weights[index_of(id)] += weight;
+                }
+
+                // the couplings of a submodel with itself are not edges
+                void add_edge_weight(const std::string& from, const std::string& to, double weight) {
+                    std::size_t a = index_of(from);
+                    std::size_t b = index_of(to);
+                    if (a != b) {
+                        _edges[a][b] += weight;
+                        _edges[b][a] += weight;
+                    }
+                }
+
+                /**
+                 * @brief Adds the counters of a profiling run of the same model: the messages routed by the ICs
+                 * of the model to their edges, the ones routed by its EICs and EOCs and the transitions and
+                 * outputs of the atomic models to the vertex of their submodel. The profiles of other coupled
+                 * models and other atomic models are ignored.
+                 */
+                void weight_by_profiles(const std::vector<link_profile>& links, const std::vector<model_profile>& models = {}) {
+                    for (const auto& l : links) {
+                        if (l.coupled_id != _model_id) {
+                            continue;
+                        }
+                        if (l.kind == "IC") {
+                            add_edge_weight(l.from_model, l.to_model, static_cast<double>(l.messages));
+                        } else if (l.kind == "EIC") {
+                            add_vertex_weight(l.to_model, static_cast<double>(l.messages));
+                        } else if (l.kind == "EOC") {
+                            add_vertex_weight(l.from_model, static_cast<double>(l.messages));
+                        }
+                    }
+                    for (const auto& m : models) {
+                        auto it = _atomic_owners.find(m.model_id);
+                        if (it != _atomic_owners.end()) {
+                            _vertex_weights[it->second] += static_cast<double>(m.internal_transitions + m.external_transitions
+                                    + m.confluence_transitions + m.outputs);
+                        }
+                    }
+                }
+            };
+
+            struct partition_options {
+                std::size_t parts = 2;
+                double imbalance = 0.05; // a part weighs at most (1 + imbalance) times the average, or its heaviest vertex
+                std::size_t coarsest_size = 0; // the coarsening stops at this number of vertices, 16 by part if 0
+                std::size_t refinement_passes = 16; // the most passes of the refinement at each level
+                std::size_t initial_tries = 8; // the bisections of the coarsest graph grown from different seeds, the least cut is kept
+            };
+
+            namespace partitioner {
+
+                // a level of the multilevel partitioning, the coarser levels merge matched vertices
+                struct level {
+                    std::vector<double> weights;
+                    std::vector<std::vector<std::pair<std::size_t, double>>> edges;
+                    std::vector<std::size_t> coarse; // the vertex of the next coarser level of each vertex
+
+                    double total_weight() const {
+                        return std::accumulate(weights.begin(), weights.end(), 0.0);
+                    }
+                };
+
+                inline level make_level(const coupling_graph& graph) {
+                    level ret;
+                    for (std::size_t v = 0; v < graph.size(); v++) {
+                        ret.weights.push_back(graph.vertex_weight(v));
+                        ret.edges.emplace_back(graph.edges(v).begin(), graph.edges(v).end());
+                    }
+                    return ret;
+                }
+
+                // matches each vertex with its unmatched neighbour of heaviest edge, the merged vertices weigh
+                // at most limit, and makes the level of the merged vertices
+                inline level coarsen(level& fine, double limit) {
+                    const std::size_t none = static_cast<std::size_t>(-1);
+                    std::size_t n = fine.weights.size();
+                    fine.coarse.assign(n, none);
+                    std::size_t coarse_size = 0;
+                    for (std::size_t v = 0; v < n; v++) {
+                        if (fine.coarse[v] != none) {
+                            continue;
+                        }
+                        std::size_t best = none;
+                        double best_weight = 0.0;
+                        for (const auto& e : fine.edges[v]) {
+                            if (fine.coarse[e.first] == none && e.second > best_weight && fine.weights[v] + fine.weights[e.first] <= limit) {
+                                best = e.first;
+                                best_weight = e.second;
+                            }
+                        }
+                        fine.coarse[v] = coarse_size;
+                        if (best != none) {
+                            fine.coarse[best] = coarse_size;
+                        }
+                        coarse_size++;
+                    }
+
+                    level ret;
+                    ret.weights.assign(coarse_size, 0.0);
+                    std::vector<std::map<std::size_t, double>> edges(coarse_size);
+                    for (std::size_t v = 0; v < n; v++) {
+                        std::size_t c = fine.coarse[v];
+                        ret.weights[c] += fine.weights[v];
+                        for (const auto& e : fine.edges[v]) {
+                            std::size_t d = fine.coarse[e.first];
+                            if (d != c) {
+                                edges[c][d] += e.second;
+                            }
+                        }
+                    }
+                    for (auto& e : edges) {
+                        ret.edges.emplace_back(e.begin(), e.end());
+                    }
+                    return ret;
+                }
+
+                inline double cut(const level& l, const std::vector<std::size_t>& part) {
+                    double ret = 0.0;
+                    for (std::size_t v = 0; v < l.weights.size(); v++) {
+                        for (const auto& e : l.edges[v]) {
+                            if (v < e.first && part[v] != part[e.first]) {
+                                ret += e.second;
+                            }
+                        }
+                    }
+                    return ret;
+                }
+
+                // splits the vertices of the part first in the parts [first, first + parts) by recursive
+                // bisection, growing a region from a seed vertex, adding the frontier vertex most connected to
+                // it until it has the weight of the first half of the parts. The region of the least cut out of
+                // the ones grown from tries seeds is kept.
+                inline void bisect(const level& l, std::vector<std::size_t>& part, std::size_t first, std::size_t parts, std::size_t tries, std::size_t shift) {
+                    std::vector<std::size_t> members;
+                    double weight = 0.0;
+                    for (std::size_t v = 0; v < part.size(); v++) {
+                        if (part[v] == first) {
+                            members.push_back(v);
+                            weight += l.weights[v];
+                        }
+                    }
+                    if (parts < 2 || members.size() < 2) {
+                        return;
+                    }
+                    std::size_t half = parts / 2;
+                    double target = weight * static_cast<double>(half) / static_cast<double>(parts);
+                    std::size_t most = members.size() - std::min(members.size() - 1, parts - half); // leaves a vertex by part if possible
+
+                    std::vector<char> in_region(part.size(), 0);
+                    std::vector<std::size_t> best_region;
+                    double best_cut = 0.0;
+                    tries = std::max<std::size_t>(1, std::min(tries, members.size()));
+                    for (std::size_t t = 0; t < tries; t++) {
+                        std::vector<std::size_t> region;
+                        double region_weight = 0.0;
+                        std::map<std::size_t, double> frontier; // connection of the members out of the region to it
+                        std::size_t next_seed = (members.size() * t / tries + shift) % members.size();
+                        while (region.size() < most && region_weight < target) {
+                            std::size_t v = 0;
+                            if (frontier.empty()) {
+                                while (in_region[members[next_seed]]) {
+                                    next_seed = (next_seed + 1) % members.size();
+                                }
+                                v = members[next_seed];
+                            } else {
+                                v = std::max_element(frontier.begin(), frontier.end(), [](const auto& x, const auto& y) { return x.second < y.second; })->first;
+                            }
+                            if (!region.empty() && region_weight + l.weights[v] - target > target - region_weight) {
+                                break; // the region is closer to the target without v
+                            }
+                            frontier.erase(v);
+                            in_region[v] = 1;
+                            region.push_back(v);
+                            region_weight += l.weights[v];
+                            for (const auto& e : l.edges[v]) {
+                                if (part[e.first] == first && !in_region[e.first]) {
+                                    frontier[e.first] += e.second;
+                                }
+                            }
+                        }
+
+                        double cut = 0.0;
+                        for (std::size_t v : region) {
+                            for (const auto& e : l.edges[v]) {
+                                if (part[e.first] == first && !in_region[e.first]) {
+                                    cut += e.second;
+                                }
+                            }
+                        }
+                        if (t == 0 || cut < best_cut) {
+                            best_region = region;
+                            best_cut = cut;
+                        }
+                        for (std::size_t v : region) {
+                            in_region[v] = 0;
+                        }
+                    }
+
+                    for (std::size_t v : best_region) {
+                        in_region[v] = 1;
+                    }
+                    for (std::size_t v : members) {
+                        if (!in_region[v]) {
+                            part[v] = first + half;
+                        }
+                    }
+                    bisect(l, part, first, half, tries, shift);
+                    bisect(l, part, first + half, parts - half, tries, shift);
+                }
+
+                // moves boundary vertices to the neighbour part they are most connected to while it reduces
+                // the cut, or keeps it and improves the balance, without overweighting the part
+                inline void refine(const level& l, std::vector<std::size_t>& part, std::size_t parts, double max_weight, std::size_t passes) {
+                    std::size_t n = l.weights.size();
+                    std::vector<double> weights(parts, 0.0);
+                    std::vector<std::size_t> counts(parts, 0);
+                    for (std::size_t v = 0; v < n; v++) {
+                        weights[part[v]] += l.weights[v];
+                        counts[part[v]]++;
+                    }
+                    std::map<std::size_t, double> connection;
+                    for (std::size_t pass = 0; pass < passes; pass++) {
+                        bool moved = false;
+                        for (std::size_t v = 0; v < n; v++) {
+                            std::size_t own = part[v];
+                            if (counts[own] == 1) {
+                                continue;
+                            }
+                            connection.clear();
+                            for (const auto& e : l.edges[v]) {
+                                connection[part[e.first]] += e.second;
+                            }
+                            double internal = connection.count(own) != 0 ? connection[own] : 0.0;
+                            std::size_t best = own;
+                            double best_gain = 0.0;
+                            for (const auto& c : connection) {
+                                if (c.first == own || weights[c.first] + l.weights[v] > max_weight) {
+                                    continue;
+                                }
+                                double gain = c.second - internal;
+                                bool balances = weights[c.first] + l.weights[v] < weights[own];
+                                if (gain > best_gain || (gain == best_gain && gain >= 0.0 && balances && (best == own || weights[c.first] < weights[best]))) {
+                                    best = c.first;
+                                    best_gain = gain;
+                                }
+                            }
+                            if (best != own) {
+                                part[v] = best;
+                                weights[own] -= l.weights[v];
+                                weights[best] += l.weights[v];
+                                counts[own]--;
+                                counts[best]++;
+                                moved = true;
+                            }
+                        }
+                        if (!moved) {
+                            return;
+                        }
+                    }
+                }
+
+                // moves vertices out of the overweighted parts, and into the empty ones, cutting the fewest edges
+                inline void balance(const level& l, std::vector<std::size_t>& part, std::size_t parts, double max_weight) {
+                    std::size_t n = l.weights.size();
+                    for (std::size_t round = 0; round < n; round++) {
+                        std::vector<double> weights(parts, 0.0);
+                        std::vector<std::size_t> counts(parts, 0);
+                        for (std::size_t v = 0; v < n; v++) {
+                            weights[part[v]] += l.weights[v];
+                            counts[part[v]]++;
+                        }
+                        std::size_t heaviest = static_cast<std::size_t>(std::max_element(weights.begin(), weights.end()) - weights.begin());
+                        std::size_t empty = static_cast<std::size_t>(std::find(counts.begin(), counts.end(), 0) - counts.begin());
+                        if ((weights[heaviest] <= max_weight && empty == parts) || counts[heaviest] < 2) {
+                            return;
+                        }
+
+                        // the vertex of the heaviest part and the part to move it losing the least connection
+                        std::size_t best_vertex = n;
+                        std::size_t best_part = parts;
+                        double best_gain = 0.0;
+                        for (std::size_t v = 0; v < n; v++) {
+                            if (part[v] != heaviest) {
+                                continue;
+                            }
+                            std::map<std::size_t, double> connection;
+                            for (const auto& e : l.edges[v]) {
+                                connection[part[e.first]] += e.second;
+                            }
+                            double internal = connection[heaviest];
+                            for (std::size_t p = 0; p < parts; p++) {
+                                if (p == heaviest || (empty != parts && p != empty) || weights[p] + l.weights[v] >= weights[heaviest]) {
+                                    continue;
+                                }
+                                double gain = (connection.count(p) != 0 ? connection[p] : 0.0) - internal;
+                                if (best_vertex == n || gain > best_gain || (gain == best_gain && weights[p] < weights[best_part])) {
+                                    best_vertex = v;
+                                    best_part = p;
+                                    best_gain = gain;
+                                }
+                            }
+                        }
+                        if (best_vertex == n) {
+                            return;
+                        }
+                        part[best_vertex] = best_part;
+                    }
+                }
+            }
+
+            /**
+             * @brief Partitions the vertices of a coupling graph in balanced parts cutting edges of the least
+             * weight, with the multilevel scheme of METIS: the graph is coarsened merging vertices matched by
+             * their heaviest edges, the coarsest graph is partitioned by recursive bisection growing regions from seed vertices, and
+             * the partition is projected back level by level refining the boundary vertices at each one.
+             *
+             * @return the part of each vertex. Every part has a vertex.
+             * @throw std::domain_error if there are fewer vertices than parts.
+             */
+            inline std::vector<std::size_t> partition_vertices(const coupling_graph& graph, const partition_options& options = partition_options()) {
+                std::size_t parts = options.parts;
+                if (parts == 0 || graph.size() < parts) {
+                    throw std::domain_error("The coupling graph has fewer submodels than parts");
+                }
+                std::vector<partitioner::level> levels;
+                levels.push_back(partitioner::make_level(graph));
+                double total = levels.front().total_weight();
+                double heaviest = *std::max_element(levels.front().weights.begin(), levels.front().weights.end());
+                double max_weight = std::max(total / static_cast<double>(parts) * (1.0 + options.imbalance), heaviest);
+
+                std::size_t coarsest = options.coarsest_size != 0 ? options.coarsest_size : 16 * parts;
+                coarsest = std::max(coarsest, parts);
+                double limit = std::max(1.5 * total / static_cast<double>(coarsest), heaviest);
+                while (levels.back().weights.size() > coarsest) {
+                    partitioner::level coarse = partitioner::coarsen(levels.back(), limit);
+                    if (coarse.weights.size() * 20 > levels.back().weights.size() * 19) {
+                        levels.back().coarse.clear();
+                        break; // the matching does not progress, as in a graph of many disconnected vertices
+                    }
+                    levels.push_back(std::move(coarse));
+                }
+
+                // the coarsest graph is bisected from differently shifted seeds, and the partition of least
+                // cut once projected and refined up to the finest level is kept
+                std::size_t tries = std::max<std::size_t>(1, options.initial_tries);
+                std::vector<std::size_t> part;
+                double cut = 0.0;
+                for (std::size_t t = 0; t < tries; t++) {
+                    std::vector<std::size_t> tried(levels.back().weights.size(), 0);
+                    partitioner::bisect(levels.back(), tried, 0, parts, tries, t);
+                    partitioner::balance(levels.back(), tried, parts, max_weight);
+                    partitioner::refine(levels.back(), tried, parts, max_weight, options.refinement_passes);
+                    for (std::size_t i = levels.size() - 1; i > 0; i--) {
+                        const partitioner::level& fine = levels[i - 1];
+                        std::vector<std::size_t> fine_part(fine.weights.size());
+                        for (std::size_t v = 0; v < fine_part.size(); v++) {
+                            fine_part[v] = tried[fine.coarse[v]];
+                        }
+                        tried = std::move(fine_part);
+                        partitioner::balance(fine, tried, parts, max_weight);
+                        partitioner::refine(fine, tried, parts, max_weight, options.refinement_passes);
+                    }
+                    double tried_cut = partitioner::cut(levels.front(), tried);
+                    if (part.empty() || tried_cut < cut) {
+                        part = std::move(tried);
+                        cut = tried_cut;
+                    }
+                }
+                return part;
+            }
+
+            /**
+             * @brief Partitions the submodels of a coupling graph as partition_vertices does.
+             * @return the ids of the submodels of each part, the partitions of the distributed, conservative and
+             * optimistic runners.
+             */
+            inline std::vector<std::vector<std::string>> partition_models(const coupling_graph& graph, const partition_options& options = partition_options()) {
+                std::vector<std::size_t> part = partition_vertices(graph, options);
+                std::vector<std::vector<std::string>> ret(options.parts);
+                for (std::size_t v = 0; v < part.size(); v++) {
+                    ret[part[v]].push_back(graph.id(v));
+                }
+                return ret;
+            }
+
+            /**
+             * @brief The weight of the edges between vertices of different parts.
+             */
+            inline double edge_cut(const coupling_graph& graph, const std::vector<std::size_t>& part) {
+                double ret = 0.0;
+                for (std::size_t v = 0; v < graph.size(); v++) {
+                    for (const auto& e : graph.edges(v)) {
+                        if (v < e.first && part.at(v) != part.at(e.first)) {
+                            ret += e.second;
+                        }
+                    }
+                }
+                return ret;
+            }
+        }
+    }
+}
+
+#endif //CADMIUM_PDEVS_DYNAMIC_PARTITIONER_HPP
@@ -0,0 +1,248 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_PERF_COUNTERS_HPP
+#define CADMIUM_PDEVS_DYNAMIC_PERF_COUNTERS_HPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <thread>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief The hardware counters of the phases of a coordinator, summed over its calls.
+             */
+            struct phase_counters {
+                std::uint64_t calls = 0;
+                std::uint64_t cycles = 0;
+                std::uint64_t instructions = 0;
+                std::uint64_t cache_misses = 0;
+                std::uint64_t branch_misses = 0;
+            };
+
+            enum class coordinator_phase : std::size_t { collect = 0, route = 1, advance = 2 };
+
+            /**
+             * @brief The phases counters of the coordinators of a level of the hierarchy, the top coordinator
+             * is the level 0.
+             *
+             * The collect and advance phases include the phases of the lower levels, the route phase is only
+             * the routing done by the coordinators of the level.
+             */
+            struct level_counters {
+                std::array<phase_counters, 3> phases;
+
+                phase_counters& operator[](coordinator_phase p) noexcept {
+                    return phases[static_cast<std::size_t>(p)];
+                }
+
+                const phase_counters& operator[](coordinator_phase p) const noexcept {
+                    return phases[static_cast<std::size_t>(p)];
+                }
+            };
+
+            /**
+             * @brief A group of the cycles, instructions, cache misses and branch misses counters of the calling
+             * thread in user space, read with perf_event on Linux.
+             *
+             * When perf_event is not available, or not allowed, the counters are not opened and always read 0.
+             * The counters measure the thread that created the group, the phases run by other threads of a
+             * parallel execution are not counted.
+             */
+            class perf_counter_group {
+                static constexpr std::size_t counters = 4;
+                std::array<int, counters> _fds;
+                bool _available = false;
+
+#ifdef __linux__
+                static int open(std::uint64_t config, int group_fd) {
+                    perf_event_attr attr;
+                    std::memset(&attr, 0, sizeof(attr));
+                    attr.size = sizeof(attr);
+                    attr.type = PERF_TYPE_HARDWARE;
+                    attr.config = config;
+                    attr.disabled = group_fd == -1 ? 1 : 0;
+                    attr.exclude_kernel = 1;
+                    attr.exclude_hv = 1;
+                    attr.read_format = PERF_FORMAT_GROUP;
+                    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+                }
+#endif
+
+            public:
+                perf_counter_group() {
+                    _fds.fill(-1);
+#ifdef __linux__
+                    const std::array<std::uint64_t, counters> configs = {
+                            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+                    for (std::size_t i = 0; i < counters; i++) {
+                        _fds[i] = open(configs[i], i == 0 ? -1 : _fds[0]);
+                        if (_fds[i] < 0) {
+                            close();
+                            return;
+                        }
+                    }
+                    ioctl(_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                    ioctl(_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+                    _available = true;
+#endif
+                }
+
+                perf_counter_group(const perf_counter_group&) = delete;
+                perf_counter_group& operator=(const perf_counter_group&) = delete;
+
+                ~perf_counter_group() {
+                    close();
+                }
+
+                bool available() const noexcept {
+                    return _available;
+                }
+
+                /**
+                 * @brief The current values of the cycles, instructions, cache misses and branch misses counters.
+                 */
+                std::array<std::uint64_t, counters> read() const noexcept {
+                    std::array<std::uint64_t, counters> ret{};
+#ifdef __linux__
+                    if (_available) {
+                        std::uint64_t values[1 + counters];
+                        if (::read(_fds[0], values, sizeof(values)) == static_cast<ssize_t>(sizeof(values))) {
+                            for (std::size_t i = 0; i < counters; i++) {
+                                ret[i] = values[1 + i];
+                            }
+                        }
+                    }
+#endif
+                    return ret;
+                }
+
+            private:
+                void close() noexcept {
+#ifdef __linux__
+                    for (int& fd : _fds) {
+                        if (fd >= 0) {
+                            ::close(fd);
+                            fd = -1;
+                        }
+                    }
+#endif
+                    _available = false;
+                }
+            };
+
+            /**
+             * @brief The phases counters of all the levels of the hierarchy, shared by the coordinators. Only the
+             * phases run by the thread that created it are counted.
+             */
+            class hierarchy_counters {
+                perf_counter_group _group;
+                std::vector<level_counters> _levels;
+                std::thread::id _owner = std::this_thread::get_id();
+
+            public:
+                bool available() const noexcept {
+                    return _group.available();
+                }
+
+                const std::vector<level_counters>& levels() const noexcept {
+                    return _levels;
+                }
+
+                /**
+                 * @brief Adds the counters between its construction and its destruction to a phase of a level.
+                 */
+                class phase_scope {
+                    hierarchy_counters* _counters;
+                    std::size_t _level;
+                    coordinator_phase _phase;
+                    std::array<std::uint64_t, 4> _start;
+
+                public:
+                    phase_scope(hierarchy_counters* counters, std::size_t level, coordinator_phase phase)
+                    : _counters(counters), _level(level), _phase(phase) {
+                        if (_counters && _counters->_owner != std::this_thread::get_id()) {
+                            _counters = nullptr;
+                        }
+                        if (_counters) {
+                            _start = _counters->_group.read();
+                        }
+                    }
+
+                    phase_scope(const phase_scope&) = delete;
+                    phase_scope& operator=(const phase_scope&) = delete;
+
+                    ~phase_scope() {
+                        if (_counters) {
+                            auto end = _counters->_group.read();
+                            if (_counters->_levels.size() <= _level) {
+                                _counters->_levels.resize(_level + 1);
+                            }
+                            phase_counters& c = _counters->_levels[_level][_phase];
+                            c.calls++;
+                            c.cycles += end[0] - _start[0];
+                            c.instructions += end[1] - _start[1];
+                            c.cache_misses += end[2] - _start[2];
+                            c.branch_misses += end[3] - _start[3];
+                        }
+                    }
+                };
+            };
+
+            /**
+             * @brief Writes the counters as CSV, a header line and a line by level and phase.
+             */
+            inline void write_counters_csv(std::ostream& os, const hierarchy_counters& counters) {
+                static const char* phases[] = {"collect", "route", "advance"};
+                os << "level,phase,calls,cycles,instructions,cache_misses,branch_misses\n";
+                for (std::size_t l = 0; l < counters.levels().size(); l++) {
+                    for (std::size_t p = 0; p < 3; p++) {
+                        const phase_counters& c = counters.levels()[l].phases[p];
+                        os << l << ',' << phases[p] << ',' << c.calls << ',' << c.cycles << ',' << c.instructions
+                           << ',' << c.cache_misses << ',' << c.branch_misses << '\n';
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif // CADMIUM_PDEVS_DYNAMIC_PERF_COUNTERS_HPP
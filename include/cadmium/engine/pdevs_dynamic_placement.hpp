@@ -0,0 +1,172 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_PLACEMENT_HPP
+#define CADMIUM_PDEVS_DYNAMIC_PLACEMENT_HPP
+
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+#if defined(__linux__)
+            inline bool pin_native_thread(pthread_t thread, std::size_t cpu) {
+                if (cpu >= CPU_SETSIZE) {
+                    return false;
+                }
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+            }
+#endif
+
+            /**
+             * @brief Pins a thread to a cpu.
+             * @return false if the platform does not support it or the cpu is not available to the process.
+             */
+            inline bool pin_thread(std::thread& thread, std::size_t cpu) {
+#if defined(__linux__)
+                return pin_native_thread(thread.native_handle(), cpu);
+#else
+                (void) thread;
+                (void) cpu;
+                return false;
+#endif
+            }
+
+            /**
+             * @brief Pins the calling thread to a cpu, as pin_thread does.
+             */
+            inline bool pin_current_thread(std::size_t cpu) {
+#if defined(__linux__)
+                return pin_native_thread(pthread_self(), cpu);
+#else
+                (void) cpu;
+                return false;
+#endif
+            }
+
+            /**
+             * @brief The cpus of a list in the format of the Linux sysfs, as "0-3,8,10-11".
+             */
+            inline std::vector<std::size_t> parse_cpu_list(const std::string& list) {
+                std::vector<std::size_t> ret;
+                std::stringstream ss(list);
+                std::string range;
+                while (std::getline(ss, range, ',')) {
+                    if (range.find_first_of("0123456789") == std::string::npos) {
+                        continue;
+                    }
+                    std::size_t dash = range.find('-');
+                    std::size_t first = std::stoul(range.substr(0, dash));
+                    std::size_t last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+                    for (std::size_t cpu = first; cpu <= last; cpu++) {
+                        ret.push_back(cpu);
+                    }
+                }
+                return ret;
+            }
+
+            /**
+             * @brief The cpus of each NUMA node, read from the Linux sysfs. Without NUMA information there is a
+             * single node with hardware_concurrency cpus.
+             */
+            inline std::vector<std::vector<std::size_t>> numa_node_cpus() {
+                std::vector<std::vector<std::size_t>> ret;
+                for (std::size_t node = 0;; node++) {
+                    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+                    if (!file) {
+                        break;
+                    }
+                    std::string list;
+                    std::getline(file, list);
+                    std::vector<std::size_t> cpus = parse_cpu_list(list);
+                    if (!cpus.empty()) {
+                        ret.push_back(std::move(cpus));
+                    }
+                }
+                if (ret.empty()) {
+                    std::size_t n = std::thread::hardware_concurrency();
+                    ret.emplace_back();
+                    for (std::size_t cpu = 0; cpu < (n == 0 ? 1 : n); cpu++) {
+                        ret.back().push_back(cpu);
+                    }
+                }
+                return ret;
+            }
+
+            /**
+             * @brief Where the threads of a pool run and how they share the loops.
+             *
+             * The worker threads are pinned to worker_cpus, the first worker to the first cpu and so on, the
+             * calling thread is not pinned. The workers without cpu, or failing to pin, run anywhere.
+             *
+             * When partitioned, the loops of n iterations are split in a contiguous block by thread, the
+             * calling thread runs the first one, then an index always runs in the same thread and the
+             * subengines of a block stay in the memory of the node of its thread: the engines and states made
+             * in a loop of the pool are first touched there, and the messages are allocated in the message arena
+             * of the thread. The routing between blocks is done by the calling thread after the loop.
+             */
+            struct thread_placement {
+                std::vector<std::size_t> worker_cpus;
+                bool partitioned = false;
+
+                /**
+                 * @brief A partitioned placement filling the NUMA nodes one after another, then the
+                 * consecutive blocks, the ones coupled by the models most of the times, share a node. The
+                 * calling thread is expected to run in the first cpu of the first node.
+                 */
+                static thread_placement by_node(std::size_t threads) {
+                    thread_placement ret;
+                    ret.partitioned = true;
+                    std::vector<std::size_t> cpus;
+                    for (const auto& node : numa_node_cpus()) {
+                        cpus.insert(cpus.end(), node.begin(), node.end());
+                    }
+                    for (std::size_t i = 1; i < threads; i++) {
+                        ret.worker_cpus.push_back(cpus[i % cpus.size()]);
+                    }
+                    return ret;
+                }
+            };
+        }
+    }
+}
+
+#endif //CADMIUM_PDEVS_DYNAMIC_PLACEMENT_HPP
@@ -0,0 +1,218 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_PROFILE_HPP
+#define CADMIUM_PDEVS_DYNAMIC_PROFILE_HPP
+
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ostream>
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief The execution counters of an atomic model recorded by its simulator when profiling is
+             * enabled, the times are the wall time spent in the model functions.
+             */
+            struct model_profile {
+                std::string model_id;
+
+                std::uint64_t internal_transitions = 0;
+                std::uint64_t external_transitions = 0;
+                std::uint64_t confluence_transitions = 0;
+                std::uint64_t outputs = 0;
+                std::uint64_t messages_in = 0;
+                std::uint64_t messages_out = 0;
+
+                std::chrono::nanoseconds internal_time{0};
+                std::chrono::nanoseconds external_time{0};
+                std::chrono::nanoseconds confluence_time{0};
+                std::chrono::nanoseconds output_time{0};
+                std::chrono::nanoseconds time_advance_time{0};
+
+                std::chrono::nanoseconds total_time() const noexcept {
+                    return internal_time + external_time + confluence_time + output_time + time_advance_time;
+                }
+            };
+
+            /**
+             * @brief Adds the wall time from its construction to its destruction to a duration.
+             */
+            class profile_timer {
+                std::chrono::nanoseconds& _duration;
+                std::chrono::steady_clock::time_point _start;
+
+            public:
+                explicit profile_timer(std::chrono::nanoseconds& duration)
+                : _duration(duration), _start(std::chrono::steady_clock::now()) {}
+
+                profile_timer(const profile_timer&) = delete;
+                profile_timer& operator=(const profile_timer&) = delete;
+
+                ~profile_timer() {
+                    _duration += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start);
+                }
+            };
+
+            /**
+             * @brief The routing counters of a coupling link recorded by its coordinator when profiling is
+             * enabled. The bytes copied are the messages routed by copy times their size, the moved messages
+             * are not copied. The coupled model of an EOC or EIC is named by its own id.
+             */
+            struct link_profile {
+                std::string coupled_id;
+                std::string kind; // EIC, IC or EOC
+                std::string from_model;
+                std::string from_port;
+                std::string to_model;
+                std::string to_port;
+                bool moves = false;
+
+                std::uint64_t routings = 0; // the times the link was routed
+                std::uint64_t messages = 0;
+                std::uint64_t bytes_copied = 0;
+                std::chrono::nanoseconds time{0};
+            };
+
+            /**
+             * @brief Sorts the links by routing time, the most expensive first.
+             */
+            inline void rank_link_profiles(std::vector<link_profile>& profiles) {
+                std::stable_sort(profiles.begin(), profiles.end(), [] (const link_profile& a, const link_profile& b) {
+                    return a.time > b.time;
+                });
+            }
+
+            /**
+             * @brief Calls f adding its wall time to duration, and returns its result.
+             */
+            template<typename F>
+            auto timed(std::chrono::nanoseconds& duration, F&& f) {
+                profile_timer timer(duration);
+                return f();
+            }
+
+            inline std::uint64_t messages_count(const cadmium::dynamic::message_bags& bags) {
+                std::uint64_t ret = 0;
+                for (const auto& b : bags) {
+                    ret += b.second.messages_size();
+                }
+                return ret;
+            }
+
+            inline void write_csv_quoted(std::ostream& os, const std::string& field) {
+                os << '"';
+                for (char c : field) {
+                    if (c == '"') {
+                        os << '"';
+                    }
+                    os << c;
+                }
+                os << '"';
+            }
+
+            /**
+             * @brief Writes the profiles as CSV, a header line and a line by model, the times in nanoseconds.
+             */
+            inline void write_profiles_csv(std::ostream& os, const std::vector<model_profile>& profiles) {
+                os << "model_id,internal_transitions,external_transitions,confluence_transitions,outputs,messages_in,messages_out,"
+                      "internal_ns,external_ns,confluence_ns,output_ns,time_advance_ns,total_ns\n";
+                for (const auto& p : profiles) {
+                    write_csv_quoted(os, p.model_id);
+                    os << ',' << p.internal_transitions << ',' << p.external_transitions << ',' << p.confluence_transitions
+                       << ',' << p.outputs << ',' << p.messages_in << ',' << p.messages_out
+                       << ',' << p.internal_time.count() << ',' << p.external_time.count() << ',' << p.confluence_time.count()
+                       << ',' << p.output_time.count() << ',' << p.time_advance_time.count() << ',' << p.total_time().count()
+                       << '\n';
+                }
+            }
+
+            /**
+             * @brief Writes the link profiles as CSV, a header line and a line by link in the order given,
+             * see rank_link_profiles, the times in nanoseconds.
+             */
+            inline void write_link_profiles_csv(std::ostream& os, const std::vector<link_profile>& profiles) {
+                os << "coupled_id,kind,from_model,from_port,to_model,to_port,moves,routings,messages,bytes_copied,time_ns\n";
+                for (const auto& p : profiles) {
+                    for (const std::string* field : {&p.coupled_id, &p.kind, &p.from_model, &p.from_port, &p.to_model, &p.to_port}) {
+                        write_csv_quoted(os, *field);
+                        os << ',';
+                    }
+                    os << (p.moves ? 1 : 0) << ',' << p.routings << ',' << p.messages << ',' << p.bytes_copied
+                       << ',' << p.time.count() << '\n';
+                }
+            }
+
+            /**
+             * @brief Writes the profiles as a JSON array of objects, the times in nanoseconds.
+             */
+            inline void write_profiles_json(std::ostream& os, const std::vector<model_profile>& profiles) {
+                os << '[';
+                for (std::size_t i = 0; i < profiles.size(); i++) {
+                    const auto& p = profiles[i];
+                    os << (i == 0 ? "\n" : ",\n") << "  {\"model_id\": \"";
+                    for (char c : p.model_id) {
+                        switch (c) {
+                            case '"': os << "\\\""; break;
+                            case '\\': os << "\\\\"; break;
+                            case '\n': os << "\\n"; break;
+                            case '\t': os << "\\t"; break;
+                            default:
+                                if (static_cast<unsigned char>(c) < 0x20) {
+                                    const char* hex = "0123456789abcdef";
+                                    os << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+                                } else {
+                                    os << c;
+                                }
+                        }
+                    }
+                    os << "\", \"internal_transitions\": " << p.internal_transitions
+                       << ", \"external_transitions\": " << p.external_transitions
+                       << ", \"confluence_transitions\": " << p.confluence_transitions
+                       << ", \"outputs\": " << p.outputs
+                       << ", \"messages_in\": " << p.messages_in
+                       << ", \"messages_out\": " << p.messages_out
+                       << ", \"internal_ns\": " << p.internal_time.count()
+                       << ", \"external_ns\": " << p.external_time.count()
+                       << ", \"confluence_ns\": " << p.confluence_time.count()
+                       << ", \"output_ns\": " << p.output_time.count()
+                       << ", \"time_advance_ns\": " << p.time_advance_time.count()
+                       << ", \"total_ns\": " << p.total_time().count() << '}';
+                }
+                os << (profiles.empty() ? "]\n" : "\n]\n");
+            }
+        }
+    }
+}
+
+#endif // CADMIUM_PDEVS_DYNAMIC_PROFILE_HPP
@@ -0,0 +1,136 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_REALTIME_HPP
+#define CADMIUM_PDEVS_DYNAMIC_REALTIME_HPP
+
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+#include <cadmium/engine/pdevs_dynamic_step_latency.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief What a real-time run does with an event starting later than its deadline plus the tolerance.
+             */
+            enum class realtime_catch_up {
+                burst,   // the late events run back to back until the simulation is on time again
+                realign, // the wall origin moves by the lateness, the next events keep their spacing from it
+                fail     // a std::runtime_error is thrown before running the late event
+            };
+
+            struct realtime_options {
+                double seconds_per_time_unit = 1.0; // wall seconds of one unit of simulated time
+                std::chrono::nanoseconds spin = std::chrono::microseconds(200); // busy waited before each deadline
+                std::chrono::nanoseconds tolerance = std::chrono::microseconds(100); // lateness not counted as a miss
+                realtime_catch_up catch_up = realtime_catch_up::burst;
+            };
+
+            struct realtime_report {
+                latency_histogram<> lateness; // of every event from its deadline
+                std::uint64_t misses = 0; // the events later than the tolerance
+                std::chrono::nanoseconds realigned{0}; // the total the wall origin moved by
+            };
+
+            /**
+             * @brief Ties the simulated time to the steady clock, the wall deadline of a time t is the wall origin
+             * plus (t - origin) * seconds_per_time_unit.
+             *
+             * The wait sleeps until the spin duration before the deadline, as sleeping wakes up late by an amount
+             * the OS decides, then it busy waits until the deadline, getting a sub-millisecond jitter for the
+             * price of a core during the spin.
+             */
+            template<typename TIME>
+            class realtime_pacer {
+                realtime_options _options;
+                double _origin;
+                std::chrono::steady_clock::time_point _wall_origin;
+                realtime_report _report;
+
+            public:
+                realtime_pacer(const TIME& origin, const realtime_options& options,
+                               std::chrono::steady_clock::time_point wall_origin = std::chrono::steady_clock::now())
+                : _options(options), _origin(static_cast<double>(origin)), _wall_origin(wall_origin) {
+                    if (!(options.seconds_per_time_unit > 0) || !std::isfinite(options.seconds_per_time_unit)) {
+                        throw std::domain_error("The seconds per time unit of a real-time run must be positive");
+                    }
+                    if (options.spin.count() < 0 || options.tolerance.count() < 0) {
+                        throw std::domain_error("The spin and tolerance of a real-time run can not be negative");
+                    }
+                }
+
+                std::chrono::steady_clock::time_point deadline(const TIME& t) const {
+                    std::chrono::duration<double> seconds((static_cast<double>(t) - _origin) * _options.seconds_per_time_unit);
+                    return _wall_origin + std::chrono::duration_cast<std::chrono::steady_clock::duration>(seconds);
+                }
+
+                /**
+                 * @brief Waits for the deadline of t and records how late it returned.
+                 */
+                void wait(const TIME& t) {
+                    const auto target = deadline(t);
+                    auto now = std::chrono::steady_clock::now();
+                    if (now < target) {
+                        if (target - now > _options.spin) {
+                            std::this_thread::sleep_until(target - _options.spin);
+                        }
+                        while ((now = std::chrono::steady_clock::now()) < target) {}
+                    }
+                    const std::chrono::nanoseconds lateness = now - target;
+                    _report.lateness.record(lateness);
+                    if (lateness <= _options.tolerance) {
+                        return;
+                    }
+                    _report.misses++;
+                    switch (_options.catch_up) {
+                        case realtime_catch_up::burst:
+                            break;
+                        case realtime_catch_up::realign:
+                            _wall_origin += lateness;
+                            _report.realigned += lateness;
+                            break;
+                        case realtime_catch_up::fail:
+                            throw std::runtime_error("A real-time run missed a deadline by "
+                                                     + std::to_string(lateness.count()) + "ns");
+                    }
+                }
+
+                const realtime_report& report() const noexcept {
+                    return _report;
+                }
+            };
+        }
+    }
+}
+
+#endif // CADMIUM_PDEVS_DYNAMIC_REALTIME_HPP
@@ -27,7 +27,19 @@
 #ifndef CADMIUM_PDEVS_DYNAMIC_RUNNER_HPP
 #define CADMIUM_PDEVS_DYNAMIC_RUNNER_HPP
 
+#include <fstream>
+#include <sstream>
 #include <cadmium/engine/pdevs_dynamic_coordinator.hpp>
+#include <cadmium/engine/pdevs_dynamic_checkpoint.hpp>
+#include <cadmium/modeling/mapped_file.hpp>
+#include <cadmium/modeling/dynamic_model_flattener.hpp>
+#include <cadmium/modeling/message_arena.hpp>
+#include <cadmium/engine/pdevs_dynamic_telemetry.hpp>
+#include <cadmium/engine/pdevs_dynamic_step_latency.hpp>
+#include <cadmium/engine/pdevs_dynamic_realtime.hpp>
+#include <cadmium/engine/pdevs_dynamic_flight_recorder.hpp>
+#include <cadmium/engine/pdevs_dynamic_input_stream.hpp>
+#include <cadmium/engine/pdevs_dynamic_state_store.hpp>
 
 namespace cadmium {
     namespace dynamic {
@@ -41,61 +53,564 @@ namespace cadmium {
              * @param Model The model to be simulated
              * @param Time Representation of time to be used to run the simualtion
              * @param Logger what, where and how to log from the simulation
+             * @param FEL the FEL used by the coordinators to schedule their subengines, see pdevs_dynamic_fel.hpp
+             * @param EXECUTION the policy used by the coordinators to run the subengines outputs and transitions, see pdevs_dynamic_execution.hpp
              */
 
             //by default state changes get verbatim formatted and logged to cout
             template<typename TIME>
             using default_logger=cadmium::logger::logger<cadmium::logger::logger_state, cadmium::dynamic::logger::formatter<TIME>, cadmium::logger::cout_sink_provider>;
 
-            //TODO: migrate specialization FEL behavior from CDBoost. At this point, there is no parametrized FEL.
-            template<class TIME, typename LOGGER=default_logger<TIME>>
+            template<class TIME, typename LOGGER=default_logger<TIME>, typename FEL=cadmium::dynamic::engine::no_fel<TIME>, typename EXECUTION=cadmium::dynamic::engine::sequential_execution>
             class runner {
-                TIME _next; //next scheduled event
+                TIME _next; //next scheduled internal event
 
-                cadmium::dynamic::engine::coordinator<TIME, LOGGER> _top_coordinator; //this only works for coupled models.
+                std::shared_ptr<cadmium::dynamic::engine::state_store<TIME>> _store; // only when paging, it outlives the simulators
+                cadmium::dynamic::engine::coordinator<TIME, LOGGER, FEL, EXECUTION> _top_coordinator; //this only works for coupled models.
+                std::unique_ptr<cadmium::dynamic::engine::hierarchy_counters> _counters; // only when counting
+                std::unique_ptr<cadmium::dynamic::engine::step_allocations<TIME>> _allocations; // only when counting the allocations
+                std::unique_ptr<cadmium::dynamic::engine::telemetry<TIME>> _telemetry; // only when reporting
+                std::unique_ptr<cadmium::dynamic::engine::memory_high_water<TIME>> _memory_peak; // only when tracking
+                std::unique_ptr<cadmium::dynamic::engine::step_latency<TIME>> _latency; // only when timing the steps
+                std::unique_ptr<cadmium::dynamic::engine::realtime_pacer<TIME>> _pacer; // only after a real-time run
+                bool _local_arena_release = false; // only when other runners step concurrently
+                bool _stepped = false; // the time quantum is only set before the first step
+                std::vector<std::shared_ptr<cadmium::dynamic::engine::input_stream<TIME>>> _inputs; // merged with the internal events
+                std::vector<std::function<void(const TIME&, const cadmium::dynamic::message_bags&)>> _output_callbacks; // called with the top outbox
 
             public:
                 //contructors
                 /**
                  * @brief set the dynamic parameters for the simulation
                  * @param init_time is the initial time of the simulation.
+                 * @param flatten_hierarchy if true, the coupled model hierarchy is flattened and run by a single
+                 * coordinator routing the messages directly between atomic models, see dynamic_model_flattener.hpp
                  */
-                explicit runner(std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> coupled_model, const TIME &init_time)
-                : _top_coordinator(coupled_model) {
+                explicit runner(std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> coupled_model, const TIME &init_time, bool flatten_hierarchy=false)
+                : runner(coupled_model, init_time, EXECUTION(), flatten_hierarchy) {}
+
+                /**
+                 * @brief set the dynamic parameters for the simulation
+                 * @param init_time is the initial time of the simulation.
+                 * @param execution is the execution policy shared by all the coordinators, for instance a
+                 * parallel_execution with the number of threads to use.
+                 * @param flatten_hierarchy if true, the coupled model hierarchy is flattened and run by a single
+                 * coordinator routing the messages directly between atomic models, see dynamic_model_flattener.hpp
+                 */
+                runner(std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> coupled_model, const TIME &init_time, const EXECUTION& execution, bool flatten_hierarchy=false)
+                : _top_coordinator(flatten_hierarchy ? cadmium::dynamic::modeling::flatten<TIME>(coupled_model) : coupled_model, execution) {
+                    start(init_time);
+                }
+
+                /**
+                 * @brief set the dynamic parameters for the simulation, only the models in logged_models are logged
+                 * @param init_time is the initial time of the simulation.
+                 * @param logged_models are the ids of the models whose events are logged, the other models skip
+                 * their log calls before formatting, see engine::set_logged_models.
+                 * @param execution is the execution policy shared by all the coordinators.
+                 * @param flatten_hierarchy if true, the coupled model hierarchy is flattened and run by a single
+                 * coordinator routing the messages directly between atomic models, see dynamic_model_flattener.hpp
+                 */
+                runner(std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> coupled_model, const TIME &init_time, const std::unordered_set<std::string>& logged_models, const EXECUTION& execution=EXECUTION(), bool flatten_hierarchy=false)
+                : _top_coordinator(flatten_hierarchy ? cadmium::dynamic::modeling::flatten<TIME>(coupled_model) : coupled_model, execution) {
+                    _top_coordinator.set_logged_models(logged_models);
+                    start(init_time);
+                }
+
+            private:
+                void start(const TIME &init_time) {
                     LOGGER::template log<cadmium::logger::logger_global_time, cadmium::logger::run_global_time>(init_time);
                     LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Preparing model");
                     _top_coordinator.init(init_time);
                     _next = _top_coordinator.next();
                 }
 
+            public:
+
+                /**
+                 * @brief The TIME of the next event to happen, internal or from an input stream.
+                 */
+                TIME next() {
+                    TIME ret = _next;
+                    for (auto& input : _inputs) {
+                        const cadmium::dynamic::engine::input_event<TIME>* e = input->peek();
+                        if (e == nullptr) {
+                            continue;
+                        }
+                        if (e->time < _top_coordinator.last()) {
+                            throw std::domain_error("An input event is before the time of the simulation");
+                        }
+                        if (e->time < ret) {
+                            ret = e->time;
+                        }
+                    }
+                    return ret;
+                }
+
+                /**
+                 * @brief Runs the next event of the simulation and returns, for the hosts driving the simulation
+                 * from their own loop. Nothing is run when there is no next event.
+                 * @return the TIME of the next event after the step.
+                 */
+                TIME step() {
+                    const TIME t = next();
+                    if (t == std::numeric_limits<TIME>::infinity()) {
+                        return t;
+                    }
+                    // a step of the input events only has no outputs to collect
+                    const bool internal = t == _next;
+                    _stepped = true;
+                    LOGGER::template log<cadmium::logger::logger_global_time, cadmium::logger::run_global_time>(t);
+                    CADMIUM_FLIGHT_RECORD(run_step, t, cadmium::dynamic::engine::flight_record::no_model);
+                    // the step time does not count the output callbacks, the telemetry and memory tracking
+                    std::chrono::steady_clock::time_point step_start;
+                    std::chrono::nanoseconds step_time{0};
+                    cadmium::dynamic::engine::allocation_count allocations_start, step_allocated;
+                    if (_latency) {
+                        step_start = std::chrono::steady_clock::now();
+                    }
+                    if (_allocations) {
+                        allocations_start = cadmium::dynamic::engine::allocation_hook::total();
+                    }
+                    if (internal) {
+                        _top_coordinator.collect_outputs(t);
+                    }
+                    if (_allocations) {
+                        step_allocated = cadmium::dynamic::engine::allocation_hook::total() - allocations_start;
+                    }
+                    if (_latency) {
+                        step_time = std::chrono::steady_clock::now() - step_start;
+                    }
+                    if (internal) {
+                        for (const auto& callback : _output_callbacks) {
+                            callback(t, _top_coordinator.outbox());
+                        }
+                    }
+                    if (_telemetry) {
+                        std::uint64_t imminents = 0, messages = 0;
+                        if (internal) {
+                            _top_coordinator.last_outputs(imminents, messages);
+                        }
+                        _telemetry->step(t, imminents, messages);
+                    }
+                    if (_memory_peak) {
+                        // the outboxes of the step are filled
+                        _memory_peak->update(t, memory_total());
+                    }
+                    if (_latency) {
+                        step_start = std::chrono::steady_clock::now();
+                    }
+                    if (_allocations) {
+                        allocations_start = cadmium::dynamic::engine::allocation_hook::total();
+                    }
+                    for (auto& input : _inputs) {
+                        for (auto e = input->peek(); e != nullptr && e->time == t; e = input->peek()) {
+                            input->deliver(_top_coordinator.inbox());
+                        }
+                    }
+                    _top_coordinator.advance_simulation(t);
+                    // all the messages of the step were consumed
+                    if (_local_arena_release) {
+                        cadmium::message_arena::instance().release_local();
+                    } else {
+                        cadmium::message_arena::instance().release();
+                    }
+                    if (_latency) {
+                        _latency->record(t, step_time + (std::chrono::steady_clock::now() - step_start));
+                    }
+                    bool steady_allocation = false;
+                    if (_allocations) {
+                        step_allocated += cadmium::dynamic::engine::allocation_hook::total() - allocations_start;
+                        steady_allocation = !_allocations->record(t, step_allocated);
+                    }
+                    _next = _top_coordinator.next();
+                    if (_store) {
+                        // the dormant states of the next step are read ahead
+                        _store->prefetch(next());
+                    }
+                    if (steady_allocation && _allocations->fail_on_allocation()) {
+                        std::ostringstream oss;
+                        oss << "The step at time " << t << " allocated " << step_allocated.allocations << " times in steady state";
+                        throw std::domain_error(oss.str());
+                    }
+                    return next();
+                }
+
+                /**
+                 * @brief Runs the events scheduled until t, the ones at t included unlike run_until, then the
+                 * simulation is at t when a host advances its clock to t.
+                 * @return the TIME of the next event, after t.
+                 */
+                TIME advance_to(const TIME &t) {
+                    for (TIME n = next(); n <= t && n != std::numeric_limits<TIME>::infinity(); n = next()) {
+                        step();
+                    }
+                    return next();
+                }
+
                 /**
                  * @brief runUntil starts the simulation and stops when the next event is scheduled after t.
                  * @param t is the limit time for the simulation.
                  * @return the TIME of the next event to happen when simulation stopped.
                  */
                 TIME run_until(const TIME &t) {
+                    return run_while([]() { return true; }, t);
+                }
+
+                /**
+                 * @brief runWhile runs the simulation as run_until, and stops as well before the first step at which
+                 * keep_running returns false, for instance when an output callback saw a target being reached.
+                 * @param keep_running is called without arguments before each step, it should be cheap.
+                 * @param t is the limit time for the simulation, none by default.
+                 * @return the TIME of the next event to happen when simulation stopped.
+                 */
+                template<typename PREDICATE>
+                TIME run_while(PREDICATE keep_running, const TIME &t = std::numeric_limits<TIME>::infinity()) {
                     LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Starting run");
-                    while (_next < t) {
-                        LOGGER::template log<cadmium::logger::logger_global_time, cadmium::logger::run_global_time>(_next);
-                        _top_coordinator.collect_outputs(_next);
-                        _top_coordinator.advance_simulation(_next);
-                        _next = _top_coordinator.next();
+                    try {
+                        while (next() < t && keep_running()) {
+                            step();
+                        }
+                    } catch (...) {
+                        cadmium::dynamic::engine::flight_recorder::instance().dump_on_failure();
+                        throw;
+                    }
+                    if (_telemetry) {
+                        _telemetry->flush();
                     }
                     LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Finished run");
-                    return _next;
+                    return next();
                 }
 
                 /**
-                 * @brief runUntilPassivate starts the simulation and stops when there is no next internal event to happen.
+                 * @brief runRealtime runs the simulation as run_until, starting each event at its wall deadline,
+                 * see pdevs_dynamic_realtime.hpp. The deadlines are counted from the time the previous run stopped
+                 * at, taken as the wall time of the call, and the deadline misses are read with realtime_report().
+                 * @param t is the limit time for the simulation.
+                 * @param options are the wall seconds of a time unit, the spin before each deadline, the lateness
+                 * tolerated and what to do with the late events.
+                 * @return the TIME of the next event to happen when simulation stopped.
                  */
-                void run_until_passivate() {
+                TIME run_realtime(const TIME &t, const cadmium::dynamic::engine::realtime_options& options = cadmium::dynamic::engine::realtime_options()) {
+                    _pacer = std::make_unique<cadmium::dynamic::engine::realtime_pacer<TIME>>(_top_coordinator.last(), options);
                     LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Starting run");
-                    while (_next != std::numeric_limits<TIME>::infinity()) {
-                        LOGGER::template log<cadmium::logger::logger_global_time, TIME>(_next);
-                        _top_coordinator.advance_simulation(_next);
-                        _next = _top_coordinator.next();
+                    try {
+                        for (TIME n = next(); n < t; n = next()) {
+                            _pacer->wait(n);
+                            step();
+                        }
+                    } catch (...) {
+                        cadmium::dynamic::engine::flight_recorder::instance().dump_on_failure();
+                        throw;
+                    }
+                    if (_telemetry) {
+                        _telemetry->flush();
                     }
                     LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Finished run");
+                    return next();
+                }
+
+                /**
+                 * @brief The lateness of the events of the last real-time run, nullptr if there was none.
+                 */
+                const cadmium::dynamic::engine::realtime_report* realtime_report() const noexcept {
+                    return _pacer ? &_pacer->report() : nullptr;
+                }
+
+                /**
+                 * @brief runUntilPassivate starts the simulation and stops when there is no next internal event to happen.
+                 */
+                void run_until_passivate() {
+                    run_until(std::numeric_limits<TIME>::infinity());
+                }
+
+                /**
+                 * @brief Feeds the events of the stream to the input ports of the top model, the runs and steps
+                 * merge them with the internal events in time order, see pdevs_dynamic_input_stream.hpp. The
+                 * events of several streams at a same time are delivered in the order the streams were added.
+                 */
+                void add_input_stream(std::shared_ptr<cadmium::dynamic::engine::input_stream<TIME>> input) {
+                    if (input == nullptr) {
+                        throw std::domain_error("Adding a null input stream");
+                    }
+                    _inputs.push_back(std::move(input));
+                }
+
+                /**
+                 * @brief Calls callback with the time and the bag of the output port PORT of the top model after
+                 * the outputs of each step are collected, when the bag has messages. The bag is the one in the
+                 * outbox, valid during the call only, and the messages are not formatted as the logger does.
+                 */
+                template<typename PORT>
+                void add_output_callback(std::function<void(const TIME&, const cadmium::message_bag<PORT>&)> callback) {
+                    if (!callback) {
+                        throw std::domain_error("Adding a null output callback");
+                    }
+                    if (_top_coordinator.outbox().slot_of(cadmium::dynamic::port_key::of<PORT>()) == cadmium::dynamic::message_bags::no_slot) {
+                        throw std::domain_error("An output callback is for a port the top model does not have");
+                    }
+                    _output_callbacks.emplace_back([callback = std::move(callback)](const TIME& t, const cadmium::dynamic::message_bags& outbox) {
+                        auto slot = outbox.slot_of(cadmium::dynamic::port_key::of<PORT>());
+                        if (slot == cadmium::dynamic::message_bags::no_slot) {
+                            return;
+                        }
+                        const cadmium::message_bag<PORT>* bag = cadmium::dynamic::bag_cast<cadmium::message_bag<PORT>>(&outbox.slot(slot));
+                        if (bag != nullptr && !bag->messages.empty()) {
+                            callback(t, *bag);
+                        }
+                    });
+                }
+
+                /**
+                 * @brief Releases only the message arena of the calling thread after each step, for the runners
+                 * stepping concurrently in their own threads with a sequential execution, see
+                 * message_arena::release_local.
+                 */
+                void set_local_arena_release(bool local) noexcept {
+                    _local_arena_release = local;
+                }
+
+                /**
+                 * @brief Quantizes the simulation time, for the models scheduling events at nearly the same times,
+                 * as sensors sampling at 1.000001 and 1.000002, to run them in a single step.
+                 *
+                 * @details
+                 * The internal events are scheduled at the first time of the grid of step quantum at or after the
+                 * time the model asks for, see quantize_time, then all the events within a quantum happen together
+                 * at the end of it. It changes the semantics of the simulation: an internal event can be up to one
+                 * quantum late and never early, the elapsed times the models get in their external transitions
+                 * are measured from these quantized times, events which were ordered in time become simultaneous,
+                 * as confluent transitions or as messages in the same bags, and a time advance shorter than the
+                 * quantum lasts a whole quantum. The input stream events keep their time. A zero quantum runs the
+                 * exact times, the default.
+                 *
+                 * The simulators of the atomic models quantize their times, the model arrays and the lazy
+                 * coordinators keep the exact ones. The first events, already scheduled, are quantized too.
+                 * @throw std::domain_error if the quantum is negative, or the simulation already made a step or
+                 * was restored from a checkpoint.
+                 */
+                void set_time_quantum(const TIME& quantum) {
+                    if (quantum < TIME()) {
+                        throw std::domain_error("The time quantum is negative");
+                    }
+                    if (_stepped) {
+                        throw std::domain_error("The time quantum is set before the first step of the simulation");
+                    }
+                    _top_coordinator.set_time_quantum(quantum);
+                    _next = _top_coordinator.next();
+                }
+
+                /**
+                 * @brief Keeps only the most recently used states of the atomic models in memory, the other ones
+                 * are paged out to store and paged in when their model is imminent or receives messages, see
+                 * pdevs_dynamic_state_store.hpp. After each step the store reads ahead the states of the models
+                 * scheduled for the next one. A nullptr store pages in all the states and keeps them in memory.
+                 */
+                void set_state_store(std::shared_ptr<cadmium::dynamic::engine::state_store<TIME>> store) {
+                    _top_coordinator.set_state_store(store.get());
+                    _store = std::move(store);
+                    if (_store) {
+                        _store->prefetch(next());
+                    }
+                }
+
+                /**
+                 * @brief Appends to buffer the checkpoint of the simulation where the last run stopped, the times of
+                 * all the engines and the states of all the models, see pdevs_dynamic_checkpoint.hpp.
+                 */
+                void save_checkpoint(std::string& buffer) const {
+                    cadmium::dynamic::engine::checkpoint::write_header(buffer);
+                    _top_coordinator.save_checkpoint(buffer);
+                }
+
+                void save_checkpoint_file(const std::string& path) const {
+                    std::string buffer;
+                    save_checkpoint(buffer);
+                    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+                    if (!file || !file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()))) {
+                        throw std::runtime_error("Can not write the checkpoint " + path);
+                    }
+                }
+
+                /**
+                 * @brief Continues the simulation from a checkpoint saved by a runner of the same model hierarchy,
+                 * the next runs start where the run of the saved simulation stopped.
+                 */
+                void restore_checkpoint(const char* data, std::size_t size) {
+                    const char* end = data + size;
+                    cadmium::dynamic::engine::checkpoint::read_header(data, end);
+                    _top_coordinator.restore_checkpoint(data, end);
+                    if (data != end) {
+                        throw std::domain_error("The checkpoint has more engines than the model");
+                    }
+                    _next = _top_coordinator.next();
+                    _stepped = true;
+                }
+
+                /**
+                 * @brief Restores the checkpoint file mapped in memory, the states are read in place from it.
+                 */
+                void restore_checkpoint_file(const std::string& path) {
+                    cadmium::dynamic::modeling::mapped_file file(path);
+                    restore_checkpoint(file.data(), file.size());
+                }
+
+                /**
+                 * @brief Profiles the atomic models and the coupling links in the next runs, the counters and times
+                 * of each one are read with profiles() and link_profiles(), see pdevs_dynamic_profile.hpp.
+                 */
+                void enable_profiling() {
+                    _top_coordinator.set_profiling(true);
+                }
+
+                /**
+                 * @brief The profiles of the atomic models since profiling was enabled, in the order of the models.
+                 */
+                std::vector<cadmium::dynamic::engine::model_profile> profiles() const {
+                    std::vector<cadmium::dynamic::engine::model_profile> ret;
+                    _top_coordinator.collect_profiles(ret);
+                    return ret;
+                }
+
+                void write_profiles_csv(std::ostream& os) const {
+                    cadmium::dynamic::engine::write_profiles_csv(os, profiles());
+                }
+
+                void write_profiles_json(std::ostream& os) const {
+                    cadmium::dynamic::engine::write_profiles_json(os, profiles());
+                }
+
+                /**
+                 * @brief The routing profiles of the coupling links since profiling was enabled, the most
+                 * expensive first.
+                 */
+                std::vector<cadmium::dynamic::engine::link_profile> link_profiles() const {
+                    std::vector<cadmium::dynamic::engine::link_profile> ret;
+                    _top_coordinator.collect_link_profiles(ret);
+                    cadmium::dynamic::engine::rank_link_profiles(ret);
+                    return ret;
+                }
+
+                void write_link_profiles_csv(std::ostream& os) const {
+                    cadmium::dynamic::engine::write_link_profiles_csv(os, link_profiles());
+                }
+
+                /**
+                 * @brief Counts the hardware events of the collect, route and advance phases of the coordinators
+                 * by level in the next runs, see pdevs_dynamic_perf_counters.hpp. The counters are opened for the
+                 * calling thread, which must be the one running the simulation.
+                 * @return false if the hardware counters are not available, only the phases calls are counted.
+                 */
+                bool enable_counters() {
+                    if (!_counters) {
+                        _counters = std::make_unique<cadmium::dynamic::engine::hierarchy_counters>();
+                        _top_coordinator.set_counters(_counters.get(), 0);
+                    }
+                    return _counters->available();
+                }
+
+                /**
+                 * @brief The counters since enable_counters was called, nullptr if it was not called.
+                 */
+                const cadmium::dynamic::engine::hierarchy_counters* counters() const noexcept {
+                    return _counters.get();
+                }
+
+                /**
+                 * @brief Counts the heap allocations of the steps of the next runs, by step, by phase of the
+                 * coordinators and by atomic model, see pdevs_dynamic_allocations.hpp. The allocations are only
+                 * counted when the program includes pdevs_dynamic_allocation_hook.hpp. The step allocations do not
+                 * count the output callbacks, the telemetry and memory tracking.
+                 * @param warmup_steps are the first steps, which may allocate the capacities reused by the next ones.
+                 * @param fail_on_allocation if true, a steady step allocating throws a std::domain_error once run.
+                 * @return false if the allocation hook is not installed, then nothing is counted.
+                 */
+                bool enable_allocation_counting(std::size_t warmup_steps = 1, bool fail_on_allocation = false) {
+                    auto allocations = std::make_unique<cadmium::dynamic::engine::step_allocations<TIME>>(warmup_steps, fail_on_allocation);
+                    _top_coordinator.set_allocation_counters(&allocations->engines(), 0);
+                    _allocations = std::move(allocations);
+                    return cadmium::dynamic::engine::allocation_hook::installed();
+                }
+
+                void disable_allocation_counting() {
+                    _top_coordinator.set_allocation_counters(nullptr, 0);
+                    _allocations.reset();
+                }
+
+                /**
+                 * @brief The allocations since enable_allocation_counting was called, nullptr if it was not called.
+                 */
+                const cadmium::dynamic::engine::step_allocations<TIME>* allocations() const noexcept {
+                    return _allocations.get();
+                }
+
+                /**
+                 * @brief Reports the progress of the next runs to callback every interval and at the end of each
+                 * run, see pdevs_dynamic_telemetry.hpp. Without telemetry a step only checks it is disabled.
+                 */
+                void enable_telemetry(const cadmium::dynamic::engine::telemetry_options& options,
+                                      std::function<void(const cadmium::dynamic::engine::telemetry_sample<TIME>&)> callback) {
+                    _telemetry = std::make_unique<cadmium::dynamic::engine::telemetry<TIME>>(options, std::move(callback));
+                }
+
+                void disable_telemetry() noexcept {
+                    _telemetry.reset();
+                }
+
+                /**
+                 * @brief The memory of the coupled models, the top model first and the others in depth first
+                 * order, see pdevs_dynamic_memory.hpp.
+                 */
+                std::vector<cadmium::dynamic::engine::model_memory> memory() const {
+                    std::vector<cadmium::dynamic::engine::model_memory> ret;
+                    cadmium::dynamic::engine::memory_usage usage;
+                    _top_coordinator.account_memory(usage, ret, 0);
+                    return ret;
+                }
+
+                cadmium::dynamic::engine::memory_usage memory_total() const {
+                    std::vector<cadmium::dynamic::engine::model_memory> models;
+                    cadmium::dynamic::engine::memory_usage usage;
+                    _top_coordinator.account_memory(usage, models, 0);
+                    return usage;
+                }
+
+                void write_memory_csv(std::ostream& os) const {
+                    cadmium::dynamic::engine::write_memory_csv(os, memory());
+                }
+
+                /**
+                 * @brief Tracks the highest memory usage of the steps of the next runs, read with memory_peak().
+                 * The memory is accounted after the outputs of each step are collected, walking the whole
+                 * hierarchy, then it is meant for diagnosing runs rather than for production runs.
+                 */
+                void enable_memory_tracking() {
+                    if (!_memory_peak) {
+                        _memory_peak = std::make_unique<cadmium::dynamic::engine::memory_high_water<TIME>>();
+                    }
+                }
+
+                /**
+                 * @brief The highest memory usage since enable_memory_tracking was called, nullptr if it was not called.
+                 */
+                const cadmium::dynamic::engine::memory_high_water<TIME>* memory_peak() const noexcept {
+                    return _memory_peak.get();
+                }
+
+                /**
+                 * @brief Records the wall time of the collect_outputs and advance_simulation of every step of the
+                 * next runs in a histogram, keeping the slowest steps, see pdevs_dynamic_step_latency.hpp.
+                 * @param slowest_kept is the number of slowest steps whose simulated time is kept.
+                 */
+                void enable_step_latency(std::size_t slowest_kept = 10) {
+                    _latency = std::make_unique<cadmium::dynamic::engine::step_latency<TIME>>(slowest_kept);
+                }
+
+                /**
+                 * @brief The step wall times since enable_step_latency was called, nullptr if it was not called.
+                 */
+                const cadmium::dynamic::engine::step_latency<TIME>* step_latency() const noexcept {
+                    return _latency.get();
                 }
             };
         }
@@ -103,3 +618,8 @@ namespace cadmium {
 }
 
 #endif //CADMIUM_PDEVS_DYNAMIC_RUNNER_HPP
+
+// the engines compiled in the CadmiumEngine library, see pdevs_dynamic_instantiations.hpp
+#ifdef CADMIUM_PREBUILT_DYNAMIC_ENGINE
+#include <cadmium/engine/pdevs_dynamic_instantiations.hpp>
+#endif
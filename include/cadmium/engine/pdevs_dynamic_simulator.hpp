@@ -24,9 +24,16 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#ifndef CADMIUM_PDEVS_DYNAMIC_SIMULATOR_HPP
+#define CADMIUM_PDEVS_DYNAMIC_SIMULATOR_HPP
+
 #include <cadmium/modeling/dynamic_model.hpp>
 #include <cadmium/modeling/dynamic_message_bag.hpp>
 #include <cadmium/engine/pdevs_dynamic_engine.hpp>
+#include <cadmium/engine/pdevs_dynamic_state_store.hpp>
+#include <cadmium/engine/pdevs_dynamic_checkpoint.hpp>
+#include <cadmium/engine/pdevs_dynamic_profile.hpp>
+#include <cadmium/engine/pdevs_dynamic_flight_recorder.hpp>
 #include <cadmium/logger/dynamic_common_loggers.hpp>
 #include <cadmium/logger/common_loggers.hpp>
 
@@ -42,12 +49,110 @@ namespace cadmium {
              * @tparam LOGGER - The logger type used to log simulation information as model states.
              */
             template<typename TIME, typename LOGGER>
-            class simulator : public engine<TIME> {
+            class simulator final : public engine<TIME> {
                 using model_type=typename cadmium::dynamic::modeling::atomic_abstract<TIME>;
 
                 std::shared_ptr<cadmium::dynamic::modeling::atomic_abstract<TIME>> _model;
+                const std::string _model_id;
+                const cadmium::dynamic::modeling::model_handle _model_handle;
+                bool _logged = true;
+                std::unique_ptr<model_profile> _profile; // only when profiling
+                allocation_counters* _allocations = nullptr; // only when counting the allocations
+                std::size_t _allocation_slot = 0;
                 TIME _last;
                 TIME _next;
+                TIME _quantum = TIME(); // the next times are not quantized unless it is positive
+                TIME _requested_next; // the next time asked by the model, before quantizing it
+                // the model in the state store when the states are paged, it is removed with the simulator
+                class store_entry {
+                public:
+                    state_store<TIME>* store = nullptr;
+                    std::size_t id = 0;
+
+                    store_entry() = default;
+
+                    store_entry(store_entry&& o) noexcept : store(o.store), id(o.id) {
+                        o.store = nullptr;
+                    }
+
+                    store_entry& operator=(store_entry&& o) noexcept {
+                        if (this != &o) {
+                            reset();
+                            store = o.store;
+                            id = o.id;
+                            o.store = nullptr;
+                        }
+                        return *this;
+                    }
+
+                    ~store_entry() {
+                        reset();
+                    }
+
+                    void reset() {
+                        if (store != nullptr) {
+                            store->remove(id);
+                            store = nullptr;
+                        }
+                    }
+                };
+                store_entry _store;
+
+                // keeps the model state in memory while it is used, when the states are paged
+                class resident_state {
+                    const simulator& _s;
+                    const bool _paged;
+
+                public:
+                    resident_state(const simulator& s, bool used) : _s(s), _paged(used && s._store.store != nullptr) {
+                        if (_paged) {
+                            _s._store.store->page_in(_s._store.id);
+                        }
+                    }
+
+                    resident_state(const resident_state&) = delete;
+                    resident_state& operator=(const resident_state&) = delete;
+
+                    ~resident_state() {
+                        if (_paged) {
+                            _s._store.store->release(_s._store.id, _s._next);
+                        }
+                    }
+                };
+
+                // the next internal event at the time asked by the model, quantized
+                void schedule(const TIME& requested) {
+                    _requested_next = requested;
+                    _next = quantize_time<TIME>(requested, _quantum);
+                }
+
+                // the state logs of the logged models read the state at every advance
+                bool logs_state() const noexcept {
+                    return cadmium::logger::logs_source<LOGGER, cadmium::logger::logger_state>::value && _logged;
+                }
+
+                // calls the model function f, its wall time is added to the duration of the profile if profiling
+                template<typename F>
+                decltype(auto) profiled(std::chrono::nanoseconds model_profile::* duration, const F& f) {
+                    if (_profile) {
+                        profile_timer timer((*_profile).*duration);
+                        return f();
+                    }
+                    return f();
+                }
+
+                // the messages of each bag counted by the loggers counting messages, see cadmium::logger::counts_messages
+                void count_messages(bool output, const cadmium::dynamic::message_bags& bags) const {
+                    if constexpr (cadmium::logger::counts_messages<LOGGER>::value) {
+                        if (_logged) {
+                            for (std::size_t i = 0; i < bags.slots(); i++) {
+                                if (bags.may_have_bag(i)) {
+                                    LOGGER::count_messages(_model_id, output, bags.port_in_slot(i).type(), bags.slot(i).messages_size());
+                                }
+                            }
+                        }
+                    }
+                }
 
             public:
 
@@ -57,7 +162,7 @@ namespace cadmium {
                 simulator() = delete;
 
                 simulator(std::shared_ptr<cadmium::dynamic::modeling::atomic_abstract<TIME>> model)
-                : _model(model) {}
+                : _model(model), _model_id(model->get_id()), _model_handle(cadmium::dynamic::modeling::intern_id(_model_id)), _outbox(model->get_output_ports()), _inbox(model->get_input_ports()) {}
 
                 /**
                  * @brief sets the last and next times according to the initial_time parameter.
@@ -65,16 +170,98 @@ namespace cadmium {
                  * @param initial_time is the start time
                  */
                 void init(TIME initial_time) override {
-                    LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::sim_info_init>(initial_time, _model->get_id());
+                    if (_logged) {
+                        LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::sim_info_init>(initial_time, _model_id);
+                    }
 
+                    resident_state resident(*this, true);
                     _last = initial_time;
-                    _next = initial_time + _model->time_advance();
+                    schedule(initial_time + profiled(&model_profile::time_advance_time, [this]() { return _model->time_advance(); }));
 
-                    LOGGER::template log<cadmium::logger::logger_state, cadmium::logger::sim_state>(initial_time, _model->get_id(), _model->model_state_as_string());
+                    if constexpr (cadmium::logger::logs_source<LOGGER, cadmium::logger::logger_state>::value) {
+                        if (_logged) {
+                            LOGGER::template log<cadmium::logger::logger_state, cadmium::logger::sim_state>(initial_time, _model_id, _model->model_state_as_string());
+                        }
+                    }
                 }
 
-                std::string get_model_id() const override {
-                    return _model->get_id();
+                const std::string& get_model_id() const override {
+                    return _model_id;
+                }
+
+                cadmium::dynamic::modeling::model_handle get_model_handle() const override {
+                    return _model_handle;
+                }
+
+                void set_logged_models(const std::unordered_set<std::string>& model_ids) override {
+                    _logged = model_ids.count(_model_id) != 0;
+                }
+
+                // the next event already scheduled is quantized too, without asking the model again
+                void set_time_quantum(const TIME& quantum) override {
+                    _quantum = quantum;
+                    _next = quantize_time<TIME>(_requested_next, _quantum);
+                    if (_store.store != nullptr) {
+                        _store.store->reschedule(_store.id, _next);
+                    }
+                }
+
+                void set_state_store(state_store<TIME>* store) override {
+                    _store.reset();
+                    if (store != nullptr) {
+                        _store.id = store->add(*_model, _next);
+                        _store.store = store;
+                    }
+                }
+
+                void set_profiling(bool enabled) override {
+                    if (!enabled) {
+                        _profile.reset();
+                    } else if (!_profile) {
+                        _profile = std::make_unique<model_profile>();
+                        _profile->model_id = _model_id;
+                    }
+                }
+
+                void collect_profiles(std::vector<model_profile>& profiles) const override {
+                    if (_profile) {
+                        profiles.push_back(*_profile);
+                    }
+                }
+
+                // the simulators have no phases to count
+                void collect_link_profiles(std::vector<link_profile>&) const override {}
+
+                void set_counters(hierarchy_counters*, std::size_t) override {}
+
+                void set_allocation_counters(allocation_counters* counters, std::size_t) override {
+                    _allocations = counters;
+                    if (counters != nullptr) {
+                        _allocation_slot = counters->add_model(_model_id);
+                    }
+                }
+
+                void account_memory(memory_usage& usage, std::vector<model_memory>&, std::size_t) const override {
+                    usage.bags += _outbox.allocated_bytes() + _inbox.allocated_bytes();
+                    usage.engines += sizeof(*this) + (_profile ? sizeof(model_profile) : 0);
+                    usage.states += _model->state_bytes();
+                }
+
+                void save_checkpoint(std::string& buffer) const override {
+                    resident_state resident(*this, true);
+                    checkpoint::write_engine(_model_id, _inbox, _outbox, buffer);
+                    checkpoint::write_value(_last, buffer);
+                    checkpoint::write_value(_next, buffer);
+                    _model->write_state(buffer);
+                }
+
+                void restore_checkpoint(const char*& data, const char* end) override {
+                    resident_state resident(*this, true);
+                    checkpoint::read_engine(_model_id, data, end);
+                    _last = checkpoint::read_value<TIME>(data, end);
+                    _next = checkpoint::read_value<TIME>(data, end);
+                    _requested_next = _next;
+                    _model->read_state(data, end);
                 }
 
                 TIME next() const noexcept override {
@@ -82,21 +269,38 @@ namespace cadmium {
                 }
 
                 void collect_outputs(const TIME &t) override {
-                LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::sim_info_collect>(t, _model->get_id());
+                    allocation_counters::model_scope allocations(_allocations, _allocation_slot, coordinator_phase::collect);
+                    if (_logged) {
+                        LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::sim_info_collect>(t, _model_id);
+                    }
 
                     // Cleaning the inbox and producing outbox
-                    _inbox = cadmium::dynamic::message_bags();
+                    _inbox.clear();
 
                     if (_next < t) {
+                        CADMIUM_FLIGHT_RECORD(failure, t, _model_handle);
                         throw std::domain_error("Trying to obtain output in a higher time than the next scheduled internal event");
                     } else if (_next == t) {
-                        _outbox = _model->output();
+                        resident_state resident(*this, true);
+                        CADMIUM_TRACE_ZONE("output", &_model_id);
+                        CADMIUM_FLIGHT_RECORD(collect_outputs, t, _model_handle);
+                        _outbox.clear();
+                        profiled(&model_profile::output_time, [this]() { _model->output(_outbox); });
+                        count_messages(true, _outbox);
+                        if (_profile) {
+                            _profile->outputs++;
+                            _profile->messages_out += messages_count(_outbox);
+                        }
                     } else {
-                        _outbox = cadmium::dynamic::message_bags();
+                        _outbox.clear();
                     }
 
-                    std::string messages_by_port = _model->messages_by_port_as_string(_outbox);
-                    LOGGER::template log<cadmium::logger::logger_messages, cadmium::logger::sim_messages_collect>(t, _model->get_id(), messages_by_port);
+                    if constexpr (cadmium::logger::logs_source<LOGGER, cadmium::logger::logger_messages>::value) {
+                        if (_logged) {
+                            std::string messages_by_port = _model->messages_by_port_as_string(_outbox);
+                            LOGGER::template log<cadmium::logger::logger_messages, cadmium::logger::sim_messages_collect>(t, _model_id, messages_by_port);
+                        }
+                    }
                 }
 
                 /**
@@ -119,27 +323,47 @@ namespace cadmium {
                  * @param t is the time the transition is expected to be run.
                 */
                 void advance_simulation(const TIME &t) override {
+                    allocation_counters::model_scope allocations(_allocations, _allocation_slot, coordinator_phase::advance);
                     //clean outbox because messages are routed before calling this function at a higher level
-                    _outbox = cadmium::dynamic::message_bags();
+                    _outbox.clear();
+                    resident_state resident(*this, !_inbox.empty() || t == _next || logs_state());
 
-                    LOGGER::template log<cadmium::logger::logger_info,cadmium::logger::sim_info_advance>(_last, t, _model->get_id());
-                    LOGGER::template log<cadmium::logger::logger_local_time,cadmium::logger::sim_local_time>(_last, t, _model->get_id());
+                    if (_logged) {
+                        LOGGER::template log<cadmium::logger::logger_info,cadmium::logger::sim_info_advance>(_last, t, _model_id);
+                        LOGGER::template log<cadmium::logger::logger_local_time,cadmium::logger::sim_local_time>(_last, t, _model_id);
+                    }
 
                     if (t < _last) {
+                        CADMIUM_FLIGHT_RECORD(failure, t, _model_handle);
                         throw std::domain_error("Event received for executing in the past of current simulation time");
                     } else if (_next < t) {
+                        CADMIUM_FLIGHT_RECORD(failure, t, _model_handle);
                         throw std::domain_error("Event received for executing after next internal event");
                     } else {
                         if (!_inbox.empty()) { //input available
+                            count_messages(false, _inbox);
+                            if (_profile) {
+                                _profile->messages_in += messages_count(_inbox);
+                            }
                             if (t == _next) { //confluence
-                                _model->confluence_transition(t - _last, _inbox);
+                                CADMIUM_TRACE_ZONE("confluence_transition", &_model_id);
+                                CADMIUM_FLIGHT_RECORD(confluence_transition, t, _model_handle);
+                                if (_profile) {
+                                    _profile->confluence_transitions++;
+                                }
+                                profiled(&model_profile::confluence_time, [&]() { _model->confluence_transition(t - _last, std::move(_inbox)); });
                             } else { //external
-                                _model->external_transition(t - _last, _inbox);
+                                CADMIUM_TRACE_ZONE("external_transition", &_model_id);
+                                CADMIUM_FLIGHT_RECORD(external_transition, t, _model_handle);
+                                if (_profile) {
+                                    _profile->external_transitions++;
+                                }
+                                profiled(&model_profile::external_time, [&]() { _model->external_transition(t - _last, std::move(_inbox)); });
                             }
                             _last = t;
-                            _next = _last + _model->time_advance();
+                            schedule(_last + profiled(&model_profile::time_advance_time, [this]() { return _model->time_advance(); }));
                             //clean inbox because they were processed already
-                            _inbox = cadmium::dynamic::message_bags();
+                            _inbox.clear();
                         } else { //no input available
                             if (t != _next) {
                                 //throw std::domain_error("Trying to execute internal transition at wrong time");
@@ -147,21 +371,27 @@ namespace cadmium {
                                 //Then, it could reach the case nothing is there.
                                 //Just a nop is enough. And no _next or _last should be changed.
                             } else {
-                                _model->internal_transition();
+                                CADMIUM_TRACE_ZONE("internal_transition", &_model_id);
+                                CADMIUM_FLIGHT_RECORD(internal_transition, t, _model_handle);
+                                if (_profile) {
+                                    _profile->internal_transitions++;
+                                }
+                                profiled(&model_profile::internal_time, [this]() { _model->internal_transition(); });
                                 _last = t;
-                                _next = _last + _model->time_advance();
+                                schedule(_last + profiled(&model_profile::time_advance_time, [this]() { return _model->time_advance(); }));
                             }
                         }
                     }
 
-                    LOGGER::template log<cadmium::logger::logger_state,cadmium::logger::sim_state>(t, _model->get_id(), _model->model_state_as_string());
+                    if constexpr (cadmium::logger::logs_source<LOGGER, cadmium::logger::logger_state>::value) {
+                        if (_logged) {
+                            LOGGER::template log<cadmium::logger::logger_state,cadmium::logger::sim_state>(t, _model_id, _model->model_state_as_string());
+                        }
+                    }
                 }
             };
         }
     }
 }
 
-#ifndef CADMIUM_PDEVS_DYNAMIC_SIMULATOR_HPP
-#define CADMIUM_PDEVS_DYNAMIC_SIMULATOR_HPP
-
 #endif //CADMIUM_PDEVS_DYNAMIC_SIMULATOR_HPP
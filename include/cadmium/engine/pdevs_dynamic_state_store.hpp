@@ -0,0 +1,350 @@
+/**
+ * Copyright (c) 2018, Damian Vicino, Laouen M. L. Belloli
+ * Carleton University, Universite de Nice-Sophia Antipolis, Universidad de Buenos Aires
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_STATE_STORE_HPP
+#define CADMIUM_PDEVS_DYNAMIC_STATE_STORE_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <cadmium/modeling/dynamic_model.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief Backing store of the atomic model states kept out of memory, for the simulations whose states
+             * do not fit in memory while only a small working set of models is active at a time.
+             *
+             * @details
+             * At most resident_states states are in memory, the states of the other models, the least recently
+             * used ones, are written with their state_serializer in a file mapped in memory and the models get a
+             * default constructed state, which releases what the state allocated. The simulators page in the
+             * state of their model when it is imminent or receives messages, before calling it, and the runner
+             * asks the kernel to read ahead the pages of the dormant states scheduled for its next step.
+             *
+             * The states must have a state_serializer, the states which are not default constructible stay in
+             * memory. The memory accounting counts the resident states only. It is set with
+             * runner::set_state_store and must outlive the runner, the page ins are serialized by a mutex.
+             *
+             * @tparam TIME - The simulation time type.
+             */
+            template<typename TIME>
+            class state_store {
+            public:
+                struct statistics {
+                    std::size_t resident = 0;
+                    std::size_t dormant = 0;
+                    std::size_t page_ins = 0;
+                    std::size_t page_outs = 0;
+                    std::size_t prefetches = 0;
+                    std::size_t file_bytes = 0;
+                };
+
+            private:
+                using model_type = cadmium::dynamic::modeling::atomic_abstract<TIME>;
+                using dormant_index = std::multimap<TIME, std::size_t>;
+
+                struct entry {
+                    model_type* model = nullptr; // nullptr once removed
+                    std::size_t offset = 0;
+                    std::size_t size = 0;
+                    std::size_t capacity = 0;
+                    std::size_t pins = 0;
+                    bool resident = true;
+                    bool pageable = true;
+                    bool prefetched = false;
+                    TIME next = std::numeric_limits<TIME>::infinity();
+                    std::list<std::size_t>::iterator lru; // when resident and pageable
+                    typename dormant_index::iterator dormant; // when not resident
+                };
+
+                std::string _path;
+                int _fd = -1;
+                char* _data = nullptr;
+                std::size_t _mapped = 0;
+                std::size_t _end = 0;
+                std::size_t _resident_states;
+
+                std::vector<entry> _entries;
+                std::list<std::size_t> _lru; // the most recently used first
+                dormant_index _dormant; // by next event time, to prefetch the imminent ones
+                std::string _buffer;
+                statistics _stats;
+                mutable std::mutex _mutex;
+
+                void fail(const std::string& what) {
+                    throw std::runtime_error(what + " the state store " + _path + ": " + std::strerror(errno));
+                }
+
+                // the file and its mapping grow by doubling, the offsets do not change and the previous
+                // mapping stays valid if the file can not be mapped again
+                void reserve(std::size_t bytes) {
+                    if (bytes <= _mapped) {
+                        return;
+                    }
+                    std::size_t mapped = _mapped == 0 ? 1 << 20 : _mapped;
+                    while (mapped < bytes) {
+                        mapped *= 2;
+                    }
+                    if (::ftruncate(_fd, static_cast<off_t>(mapped)) == -1) {
+                        fail("Can not grow");
+                    }
+                    void* data = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+                    if (data == MAP_FAILED) {
+                        fail("Can not map");
+                    }
+                    if (_data != nullptr) {
+                        ::munmap(_data, _mapped);
+                    }
+                    _data = static_cast<char*>(data);
+                    _mapped = mapped;
+                    _stats.file_bytes = mapped;
+                }
+
+                // the state is written to the file before the entry changes and released last, a store that
+                // can not grow throws with the state and its entry as they were
+                void page_out(std::size_t id) {
+                    entry& e = _entries[id];
+                    _buffer.clear();
+                    e.model->write_state(_buffer);
+                    std::size_t offset = e.offset;
+                    std::size_t capacity = e.capacity;
+                    std::size_t end = _end;
+                    if (_buffer.size() > capacity) {
+                        // the states only grow in place, a larger state moves to the end of the file
+                        capacity = _buffer.size() + _buffer.size() / 2;
+                        offset = _end;
+                        end = _end + capacity;
+                        reserve(end);
+                    }
+                    if (!_buffer.empty()) {
+                        std::memcpy(_data + offset, _buffer.data(), _buffer.size());
+                    }
+                    e.offset = offset;
+                    e.capacity = capacity;
+                    _end = end;
+                    if (!e.model->release_state()) {
+                        // it stays resident without counting against the limit
+                        e.pageable = false;
+                        _lru.erase(e.lru);
+                        return;
+                    }
+                    e.size = _buffer.size();
+                    e.resident = false;
+                    e.prefetched = false;
+                    _lru.erase(e.lru);
+                    e.dormant = _dormant.emplace(e.next, id);
+                    _stats.page_outs++;
+                }
+
+                // pages out the least recently used states which are not in use beyond the limit
+                void evict(std::size_t room) {
+                    auto it = _lru.end();
+                    while (_lru.size() + room > _resident_states && it != _lru.begin()) {
+                        auto victim = std::prev(it);
+                        if (_entries[*victim].pins != 0) {
+                            it = victim;
+                        } else {
+                            page_out(*victim);
+                        }
+                    }
+                }
+
+            public:
+                /**
+                 * @param path - The file of the dormant states, it is created or truncated, and removed by the
+                 * destructor.
+                 * @param resident_states - The number of states kept in memory.
+                 */
+                state_store(const std::string& path, std::size_t resident_states)
+                : _path(path), _resident_states(resident_states) {
+                    if (resident_states == 0) {
+                        throw std::domain_error("The state store needs at least one resident state");
+                    }
+                    _fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+                    if (_fd == -1) {
+                        fail("Can not open");
+                    }
+                }
+
+                state_store(const state_store&) = delete;
+                state_store& operator=(const state_store&) = delete;
+
+                ~state_store() {
+                    if (_data != nullptr) {
+                        ::munmap(_data, _mapped);
+                    }
+                    if (_fd != -1) {
+                        ::close(_fd);
+                        ::unlink(_path.c_str());
+                    }
+                }
+
+                /**
+                 * @brief Adds the state of model with its next event time, it is resident until it is the least
+                 * recently used one.
+                 * @return the id of the model in the store.
+                 */
+                std::size_t add(model_type& model, const TIME& next) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    evict(1);
+                    std::size_t id = _entries.size();
+                    _entries.emplace_back();
+                    entry& e = _entries.back();
+                    e.model = &model;
+                    e.next = next;
+                    _lru.push_front(id);
+                    e.lru = _lru.begin();
+                    return id;
+                }
+
+                /**
+                 * @brief Removes the model, its state is paged in if it was dormant.
+                 */
+                void remove(std::size_t id) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    entry& e = _entries[id];
+                    if (!e.resident) {
+                        read(id);
+                    } else if (e.pageable) {
+                        _lru.erase(e.lru);
+                    }
+                    e.model = nullptr;
+                    e.pageable = false;
+                }
+
+                /**
+                 * @brief Makes the state of the model resident and keeps it in memory until released, the least
+                 * recently used states are paged out to make room for it.
+                 */
+                void page_in(std::size_t id) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    entry& e = _entries[id];
+                    e.pins++;
+                    if (e.resident) {
+                        if (e.pageable) {
+                            _lru.splice(_lru.begin(), _lru, e.lru);
+                        }
+                        return;
+                    }
+                    evict(1);
+                    read(id);
+                    _lru.push_front(id);
+                    e.lru = _lru.begin();
+                    _stats.page_ins++;
+                }
+
+                /**
+                 * @brief Ends the use of the state paged in by page_in, next is the next event time of the model.
+                 */
+                void release(std::size_t id, const TIME& next) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    entry& e = _entries[id];
+                    e.pins--;
+                    e.next = next;
+                }
+
+                /**
+                 * @brief Changes the next event time of the model, without paging its state in.
+                 */
+                void reschedule(std::size_t id, const TIME& next) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    entry& e = _entries[id];
+                    e.next = next;
+                    if (!e.resident) {
+                        _dormant.erase(e.dormant);
+                        e.dormant = _dormant.emplace(next, id);
+                    }
+                }
+
+                /**
+                 * @brief Asks the kernel to read the dormant states of the models scheduled until t.
+                 */
+                void prefetch(const TIME& t) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+                    for (auto it = _dormant.begin(); it != _dormant.end() && !(t < it->first); ++it) {
+                        entry& e = _entries[it->second];
+                        if (e.prefetched || e.size == 0) {
+                            continue;
+                        }
+                        std::size_t begin = e.offset / page * page;
+                        ::madvise(_data + begin, e.offset + e.size - begin, MADV_WILLNEED);
+                        e.prefetched = true;
+                        _stats.prefetches++;
+                    }
+                }
+
+                /**
+                 * @return true if the state of the model is in memory.
+                 */
+                bool resident(std::size_t id) const {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    return _entries[id].resident;
+                }
+
+                statistics stats() const {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    statistics ret = _stats;
+                    ret.dormant = _dormant.size();
+                    ret.resident = 0;
+                    for (const entry& e : _entries) {
+                        if (e.model != nullptr && e.resident) {
+                            ret.resident++;
+                        }
+                    }
+                    return ret;
+                }
+
+            private:
+                void read(std::size_t id) {
+                    entry& e = _entries[id];
+                    const char* data = _data + e.offset;
+                    e.model->read_state(data, data + e.size);
+                    e.resident = true;
+                    _dormant.erase(e.dormant);
+                }
+            };
+        }
+    }
+}
+
+#endif // CADMIUM_PDEVS_DYNAMIC_STATE_STORE_HPP
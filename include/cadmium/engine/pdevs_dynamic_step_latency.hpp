@@ -0,0 +1,215 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_STEP_LATENCY_HPP
+#define CADMIUM_PDEVS_DYNAMIC_STEP_LATENCY_HPP
+
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <algorithm>
+#include <stdexcept>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief A histogram of durations in nanoseconds with HDR-style buckets: the values below
+             * 2^PRECISION_BITS have a bucket each, and the others 2^(PRECISION_BITS - 1) buckets by power of
+             * two, then the values are recorded with a relative error below 2^(1 - PRECISION_BITS).
+             */
+            template<unsigned PRECISION_BITS = 7>
+            class latency_histogram {
+                static_assert(PRECISION_BITS >= 2 && PRECISION_BITS < 32, "Unsupported histogram precision");
+                static constexpr std::uint64_t linear = std::uint64_t(1) << PRECISION_BITS;
+                static constexpr std::uint64_t half = linear / 2;
+
+                std::vector<std::uint64_t> _counts;
+                std::uint64_t _total = 0;
+                std::uint64_t _max = 0;
+                std::uint64_t _min = 0;
+                long double _sum = 0;
+
+                static unsigned highest_bit(std::uint64_t v) noexcept {
+                    unsigned ret = 0;
+                    while (v >>= 1) {
+                        ret++;
+                    }
+                    return ret;
+                }
+
+                static std::size_t index_of(std::uint64_t v) noexcept {
+                    if (v < linear) {
+                        return static_cast<std::size_t>(v);
+                    }
+                    unsigned shift = highest_bit(v) - PRECISION_BITS + 1;
+                    return static_cast<std::size_t>(shift * half + (v >> shift));
+                }
+
+                // the highest value recorded in the bucket
+                static std::uint64_t highest_of(std::size_t index) noexcept {
+                    if (index < linear) {
+                        return index;
+                    }
+                    std::uint64_t shift = index / half - 1;
+                    std::uint64_t sub = index - shift * half;
+                    return ((sub + 1) << shift) - 1;
+                }
+
+            public:
+                latency_histogram()
+                : _counts(index_of(std::numeric_limits<std::uint64_t>::max()) + 1, 0) {}
+
+                void record(std::chrono::nanoseconds duration) noexcept {
+                    std::uint64_t v = duration.count() < 0 ? 0 : static_cast<std::uint64_t>(duration.count());
+                    _counts[index_of(v)]++;
+                    _min = _total == 0 ? v : std::min(_min, v);
+                    _max = std::max(_max, v);
+                    _sum += v;
+                    _total++;
+                }
+
+                std::uint64_t count() const noexcept {
+                    return _total;
+                }
+
+                std::chrono::nanoseconds min() const noexcept {
+                    return std::chrono::nanoseconds(_min);
+                }
+
+                std::chrono::nanoseconds max() const noexcept {
+                    return std::chrono::nanoseconds(_max);
+                }
+
+                std::chrono::nanoseconds mean() const noexcept {
+                    return std::chrono::nanoseconds(_total == 0 ? 0 : static_cast<std::int64_t>(_sum / _total));
+                }
+
+                /**
+                 * @brief The duration below or equal to which are the fraction q of the durations, up to the
+                 * histogram precision, and never above the max.
+                 */
+                std::chrono::nanoseconds percentile(double q) const {
+                    if (q < 0 || q > 1) {
+                        throw std::domain_error("The percentile fraction must be between 0 and 1");
+                    }
+                    if (_total == 0) {
+                        return std::chrono::nanoseconds(0);
+                    }
+                    std::uint64_t target = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(q * _total + 0.5));
+                    std::uint64_t seen = 0;
+                    for (std::size_t i = 0; i < _counts.size(); i++) {
+                        seen += _counts[i];
+                        if (seen >= target) {
+                            return std::chrono::nanoseconds(std::min(highest_of(i), _max));
+                        }
+                    }
+                    return max();
+                }
+            };
+
+            /**
+             * @brief The wall time of the simulation steps, their histogram and the slowest steps with the
+             * simulated time they happened at.
+             */
+            template<typename TIME>
+            class step_latency {
+            public:
+                struct slow_step {
+                    TIME time;
+                    std::chrono::nanoseconds duration;
+                };
+
+            private:
+                latency_histogram<> _histogram;
+                std::size_t _slowest_kept;
+                std::vector<slow_step> _slowest; // a min heap by duration
+
+                static bool faster(const slow_step& a, const slow_step& b) noexcept {
+                    return a.duration > b.duration;
+                }
+
+            public:
+                explicit step_latency(std::size_t slowest_kept = 10)
+                : _slowest_kept(slowest_kept) {
+                    _slowest.reserve(slowest_kept);
+                }
+
+                void record(const TIME& t, std::chrono::nanoseconds duration) {
+                    _histogram.record(duration);
+                    if (_slowest_kept == 0) {
+                        return;
+                    }
+                    if (_slowest.size() < _slowest_kept) {
+                        _slowest.push_back(slow_step{t, duration});
+                        std::push_heap(_slowest.begin(), _slowest.end(), faster);
+                    } else if (_slowest.front().duration < duration) {
+                        std::pop_heap(_slowest.begin(), _slowest.end(), faster);
+                        _slowest.back() = slow_step{t, duration};
+                        std::push_heap(_slowest.begin(), _slowest.end(), faster);
+                    }
+                }
+
+                const latency_histogram<>& histogram() const noexcept {
+                    return _histogram;
+                }
+
+                /**
+                 * @brief The slowest steps recorded, the slowest first.
+                 */
+                std::vector<slow_step> slowest() const {
+                    std::vector<slow_step> ret = _slowest;
+                    std::sort(ret.begin(), ret.end(), faster);
+                    return ret;
+                }
+            };
+
+            /**
+             * @brief Writes the steps, their p50, p99, p99.9 and max wall times in nanoseconds in a line, then
+             * a line by slow step with its simulated time.
+             */
+            template<typename TIME>
+            void write_step_latency(std::ostream& os, const step_latency<TIME>& latency) {
+                const auto& h = latency.histogram();
+                os << "steps=" << h.count()
+                   << " mean_ns=" << h.mean().count()
+                   << " p50_ns=" << h.percentile(0.5).count()
+                   << " p99_ns=" << h.percentile(0.99).count()
+                   << " p99.9_ns=" << h.percentile(0.999).count()
+                   << " max_ns=" << h.max().count() << '\n';
+                for (const auto& s : latency.slowest()) {
+                    os << "slow_step time=" << s.time << " ns=" << s.duration.count() << '\n';
+                }
+            }
+        }
+    }
+}
+
+#endif // CADMIUM_PDEVS_DYNAMIC_STEP_LATENCY_HPP
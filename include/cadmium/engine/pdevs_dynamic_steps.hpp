@@ -0,0 +1,195 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_STEPS_HPP
+#define CADMIUM_PDEVS_DYNAMIC_STEPS_HPP
+
+// the step generator needs the coroutines, of C++20 or of -fcoroutines, the runners step() and advance_to() do not
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <limits>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <coroutine>
+#include <exception>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief A coroutine generator of the simulated times, see steps(). It is started lazily, each
+             * resume runs the coroutine until its next co_yield, and it is iterated once.
+             */
+            template<typename TIME>
+            class step_generator {
+            public:
+                struct promise_type {
+                    TIME current;
+                    std::exception_ptr error;
+
+                    step_generator get_return_object() noexcept {
+                        return step_generator(std::coroutine_handle<promise_type>::from_promise(*this));
+                    }
+
+                    std::suspend_always initial_suspend() const noexcept {
+                        return {};
+                    }
+
+                    std::suspend_always final_suspend() const noexcept {
+                        return {};
+                    }
+
+                    std::suspend_always yield_value(const TIME& t) {
+                        current = t;
+                        return {};
+                    }
+
+                    void return_void() const noexcept {}
+
+                    void unhandled_exception() noexcept {
+                        error = std::current_exception();
+                    }
+                };
+
+                class iterator {
+                    step_generator* _generator = nullptr;
+
+                public:
+                    using iterator_category = std::input_iterator_tag;
+                    using value_type = TIME;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = const TIME*;
+                    using reference = const TIME&;
+
+                    iterator() = default;
+
+                    explicit iterator(step_generator* generator) : _generator(generator) {}
+
+                    reference operator*() const {
+                        return _generator->time();
+                    }
+
+                    iterator& operator++() {
+                        if (!_generator->advance()) {
+                            _generator = nullptr;
+                        }
+                        return *this;
+                    }
+
+                    void operator++(int) {
+                        ++*this;
+                    }
+
+                    friend bool operator==(const iterator& a, const iterator& b) noexcept {
+                        return a._generator == b._generator;
+                    }
+
+                    friend bool operator!=(const iterator& a, const iterator& b) noexcept {
+                        return a._generator != b._generator;
+                    }
+                };
+
+            private:
+                std::coroutine_handle<promise_type> _handle;
+
+                explicit step_generator(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) {}
+
+            public:
+                step_generator(step_generator&& other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+
+                step_generator& operator=(step_generator&& other) noexcept {
+                    if (this != &other) {
+                        if (_handle) {
+                            _handle.destroy();
+                        }
+                        _handle = std::exchange(other._handle, nullptr);
+                    }
+                    return *this;
+                }
+
+                step_generator(const step_generator&) = delete;
+                step_generator& operator=(const step_generator&) = delete;
+
+                ~step_generator() {
+                    if (_handle) {
+                        _handle.destroy();
+                    }
+                }
+
+                /**
+                 * @brief Runs the coroutine until it yields the next time, rethrowing the errors of the simulation.
+                 * @return false when the coroutine finished, then there is no time.
+                 */
+                bool advance() {
+                    if (!_handle || _handle.done()) {
+                        return false;
+                    }
+                    _handle.resume();
+                    if (_handle.promise().error) {
+                        std::rethrow_exception(std::exchange(_handle.promise().error, nullptr));
+                    }
+                    return !_handle.done();
+                }
+
+                // the last time yielded
+                const TIME& time() const {
+                    return _handle.promise().current;
+                }
+
+                iterator begin() {
+                    return advance() ? iterator(this) : iterator();
+                }
+
+                iterator end() noexcept {
+                    return iterator();
+                }
+            };
+
+            /**
+             * @brief Steps the runner in a coroutine until the next event is scheduled at or after t, yielding the
+             * time of each event after running it. The host resumes it from its own loop, between its I/O, and
+             * the steps run in the thread resuming it.
+             *
+             * @param runner is a runner with step() and next(), as the dynamic runner, it must outlive the generator.
+             */
+            template<typename RUNNER, typename TIME = decltype(std::declval<RUNNER&>().next())>
+            step_generator<TIME> steps(RUNNER& runner, std::common_type_t<TIME> until = std::numeric_limits<TIME>::infinity()) {
+                while (runner.next() < until) {
+                    const TIME now = runner.next();
+                    runner.step();
+                    co_yield now;
+                }
+            }
+        }
+    }
+}
+
+#endif // defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#endif // CADMIUM_PDEVS_DYNAMIC_STEPS_HPP
@@ -0,0 +1,229 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_TELEMETRY_HPP
+#define CADMIUM_PDEVS_DYNAMIC_TELEMETRY_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief The resident set size of the process in bytes, read from /proc/self/statm on Linux.
+             * @return 0 when it is not available.
+             */
+            inline std::uint64_t resident_set_size() {
+#ifdef __linux__
+                std::ifstream statm("/proc/self/statm");
+                std::uint64_t size = 0, resident = 0;
+                if (statm >> size >> resident) {
+                    return resident * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+                }
+#endif
+                return 0;
+            }
+
+            /**
+             * @brief What the runner reports every telemetry interval, the rates are measured over the interval.
+             * The events are the imminent subengines of the top coordinator, the atomic models when the
+             * hierarchy is flattened, and the messages are the ones they output.
+             */
+            template<typename TIME>
+            struct telemetry_sample {
+                TIME time; // simulated time of the last step
+                std::uint64_t steps = 0; // since the run started
+                std::uint64_t events = 0;
+                std::uint64_t messages = 0;
+                std::uint64_t imminents = 0; // in the last step
+                double steps_per_second = 0;
+                double events_per_second = 0;
+                double messages_per_second = 0;
+                std::uint64_t rss_bytes = 0;
+                std::chrono::nanoseconds elapsed{0}; // wall time since the telemetry was enabled
+            };
+
+            /**
+             * @brief When to report, every_steps steps or every wall time interval, whichever comes first,
+             * zero disables the condition.
+             */
+            struct telemetry_options {
+                std::uint64_t every_steps = 0;
+                std::chrono::milliseconds every{0};
+            };
+
+            /**
+             * @brief Accumulates the steps of a run and reports a sample to a callback every interval.
+             * The wall clock is only read when a time interval is set.
+             */
+            template<typename TIME>
+            class telemetry {
+                using clock = std::chrono::steady_clock;
+
+                telemetry_options _options;
+                std::function<void(const telemetry_sample<TIME>&)> _callback;
+
+                clock::time_point _start;
+                clock::time_point _last_report;
+                std::uint64_t _steps = 0;
+                std::uint64_t _events = 0;
+                std::uint64_t _messages = 0;
+                std::uint64_t _reported_steps = 0;
+                std::uint64_t _reported_events = 0;
+                std::uint64_t _reported_messages = 0;
+                std::uint64_t _last_imminents = 0;
+                TIME _last_time;
+
+            public:
+                telemetry(const telemetry_options& options, std::function<void(const telemetry_sample<TIME>&)> callback)
+                : _options(options), _callback(std::move(callback)), _start(clock::now()), _last_report(_start), _last_time() {
+                    if (!_callback) {
+                        throw std::domain_error("Telemetry without a callback");
+                    }
+                    if (_options.every_steps == 0 && _options.every.count() == 0) {
+                        throw std::domain_error("Telemetry without interval");
+                    }
+                }
+
+                /**
+                 * @brief Records a step, reports a sample if the interval is over.
+                 */
+                void step(const TIME& t, std::uint64_t imminents, std::uint64_t messages) {
+                    _steps++;
+                    _events += imminents;
+                    _messages += messages;
+                    _last_imminents = imminents;
+                    _last_time = t;
+                    bool due = _options.every_steps != 0 && _steps - _reported_steps >= _options.every_steps;
+                    if (!due && _options.every.count() != 0) {
+                        due = clock::now() - _last_report >= _options.every;
+                    }
+                    if (due) {
+                        report();
+                    }
+                }
+
+                /**
+                 * @brief Reports the steps recorded since the last sample, if any.
+                 */
+                void flush() {
+                    if (_steps != _reported_steps) {
+                        report();
+                    }
+                }
+
+            private:
+                void report() {
+                    clock::time_point now = clock::now();
+                    double seconds = std::chrono::duration<double>(now - _last_report).count();
+                    telemetry_sample<TIME> s;
+                    s.time = _last_time;
+                    s.steps = _steps;
+                    s.events = _events;
+                    s.messages = _messages;
+                    s.imminents = _last_imminents;
+                    if (seconds > 0) {
+                        s.steps_per_second = (_steps - _reported_steps) / seconds;
+                        s.events_per_second = (_events - _reported_events) / seconds;
+                        s.messages_per_second = (_messages - _reported_messages) / seconds;
+                    }
+                    s.rss_bytes = resident_set_size();
+                    s.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - _start);
+                    _last_report = now;
+                    _reported_steps = _steps;
+                    _reported_events = _events;
+                    _reported_messages = _messages;
+                    _callback(s);
+                }
+            };
+
+            /**
+             * @brief Writes a sample in the Prometheus text exposition format.
+             */
+            template<typename TIME>
+            void write_telemetry_prometheus(std::ostream& os, const telemetry_sample<TIME>& s) {
+                auto metric = [&os] (const char* name, const char* type, const char* help, const auto& value) {
+                    os << "# HELP " << name << ' ' << help << '\n'
+                       << "# TYPE " << name << ' ' << type << '\n'
+                       << name << ' ' << value << '\n';
+                };
+                metric("cadmium_simulated_time", "gauge", "Simulated time of the last step.", s.time);
+                metric("cadmium_steps_total", "counter", "Simulation steps run.", s.steps);
+                metric("cadmium_events_total", "counter", "Imminent subengines of the top coordinator.", s.events);
+                metric("cadmium_messages_total", "counter", "Messages output by the imminent subengines.", s.messages);
+                metric("cadmium_imminents", "gauge", "Imminent subengines in the last step.", s.imminents);
+                metric("cadmium_steps_per_second", "gauge", "Steps per wall second in the last interval.", s.steps_per_second);
+                metric("cadmium_events_per_second", "gauge", "Events per wall second in the last interval.", s.events_per_second);
+                metric("cadmium_messages_per_second", "gauge", "Messages per wall second in the last interval.", s.messages_per_second);
+                metric("cadmium_resident_memory_bytes", "gauge", "Resident set size of the process.", s.rss_bytes);
+                metric("cadmium_elapsed_seconds", "gauge", "Wall time since the telemetry was enabled.",
+                       std::chrono::duration<double>(s.elapsed).count());
+            }
+
+            /**
+             * @brief A telemetry callback rewriting a file with the last sample in the Prometheus text format,
+             * as read by the textfile collectors. The file is replaced by a rename so it is never read half written.
+             */
+            template<typename TIME>
+            class prometheus_textfile {
+                std::string _path;
+
+            public:
+                explicit prometheus_textfile(std::string path)
+                : _path(std::move(path)) {}
+
+                void operator()(const telemetry_sample<TIME>& s) const {
+                    std::string tmp = _path + ".tmp";
+                    {
+                        std::ofstream os(tmp, std::ios::trunc);
+                        if (!os) {
+                            throw std::domain_error("Cannot open the telemetry file " + tmp);
+                        }
+                        write_telemetry_prometheus(os, s);
+                    }
+                    if (std::rename(tmp.c_str(), _path.c_str()) != 0) {
+                        throw std::domain_error("Cannot replace the telemetry file " + _path);
+                    }
+                }
+            };
+        }
+    }
+}
+
+#endif // CADMIUM_PDEVS_DYNAMIC_TELEMETRY_HPP
@@ -0,0 +1,244 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_DYNAMIC_TRACE_ZONES_HPP
+#define CADMIUM_PDEVS_DYNAMIC_TRACE_ZONES_HPP
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+
+#ifdef CADMIUM_TRACY
+#include <tracy/Tracy.hpp>
+#endif
+
+/**
+ * The trace zones of the dynamic engine phases: the coordinators collect_outputs and advance_simulation, the
+ * routing by table and the simulators output and transitions.
+ *
+ * By default the zones are recorded by the trace_recorder while it is started, and written in the Chrome
+ * trace event format, to open in chrome://tracing or Perfetto. A stopped recorder costs a relaxed atomic load
+ * by zone. Defining CADMIUM_TRACY makes the zones Tracy zones instead, and CADMIUM_NO_TRACE_ZONES removes them.
+ */
+
+namespace cadmium {
+    namespace dynamic {
+        namespace engine {
+
+            /**
+             * @brief Records the trace zones of all the threads while started, each thread in its own buffer.
+             * start() and write_chrome_trace() must not be called while the simulation runs.
+             */
+            class trace_recorder {
+            public:
+                struct zone_event {
+                    const char* name;
+                    const std::string* detail; // the model id, it must outlive the recorder write
+                    std::int64_t start_ns;
+                    std::int64_t duration_ns;
+                };
+
+            private:
+                struct thread_buffer {
+                    std::vector<zone_event> events;
+                };
+
+                std::atomic<bool> _active{false};
+                std::atomic<std::uint64_t> _generation{0};
+                std::chrono::steady_clock::time_point _origin = std::chrono::steady_clock::now();
+                std::mutex _mutex;
+                std::vector<std::unique_ptr<thread_buffer>> _buffers;
+
+                trace_recorder() = default;
+
+                // the buffer of the calling thread, a new one after each start
+                thread_buffer& buffer() {
+                    thread_local thread_buffer* b = nullptr;
+                    thread_local std::uint64_t generation = 0;
+                    std::uint64_t current = _generation.load(std::memory_order_acquire);
+                    if (b == nullptr || generation != current) {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _buffers.push_back(std::make_unique<thread_buffer>());
+                        b = _buffers.back().get();
+                        generation = current;
+                    }
+                    return *b;
+                }
+
+                // the trace times are in microseconds
+                static void write_microseconds(std::ostream& os, std::int64_t ns) {
+                    char buffer[32];
+                    std::snprintf(buffer, sizeof(buffer), "%lld.%03lld", static_cast<long long>(ns / 1000), static_cast<long long>(ns % 1000));
+                    os << buffer;
+                }
+
+                static void write_json_string(std::ostream& os, const char* s, std::size_t size) {
+                    os << '"';
+                    for (std::size_t i = 0; i < size; i++) {
+                        char c = s[i];
+                        if (c == '"' || c == '\\') {
+                            os << '\\' << c;
+                        } else if (static_cast<unsigned char>(c) < 0x20) {
+                            const char* hex = "0123456789abcdef";
+                            os << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+                        } else {
+                            os << c;
+                        }
+                    }
+                    os << '"';
+                }
+
+            public:
+                static trace_recorder& instance() {
+                    static trace_recorder recorder;
+                    return recorder;
+                }
+
+                /**
+                 * @brief Discards the zones recorded and starts recording.
+                 */
+                void start() {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _buffers.clear();
+                    _generation.fetch_add(1, std::memory_order_release);
+                    _origin = std::chrono::steady_clock::now();
+                    _active.store(true, std::memory_order_release);
+                }
+
+                void stop() noexcept {
+                    _active.store(false, std::memory_order_release);
+                }
+
+                bool active() const noexcept {
+                    return _active.load(std::memory_order_relaxed);
+                }
+
+                std::int64_t now_ns() const noexcept {
+                    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _origin).count();
+                }
+
+                void record(const zone_event& e) {
+                    buffer().events.push_back(e);
+                }
+
+                std::size_t size() {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    std::size_t ret = 0;
+                    for (const auto& b : _buffers) {
+                        ret += b->events.size();
+                    }
+                    return ret;
+                }
+
+                /**
+                 * @brief Writes the zones recorded as complete events of the Chrome trace event JSON format,
+                 * a thread id by recording thread.
+                 */
+                void write_chrome_trace(std::ostream& os) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+                    bool first = true;
+                    for (std::size_t tid = 0; tid < _buffers.size(); tid++) {
+                        for (const auto& e : _buffers[tid]->events) {
+                            os << (first ? "\n" : ",\n") << "{\"name\": ";
+                            write_json_string(os, e.name, std::char_traits<char>::length(e.name));
+                            os << ", \"cat\": \"cadmium\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << tid
+                               << ", \"ts\": ";
+                            write_microseconds(os, e.start_ns);
+                            os << ", \"dur\": ";
+                            write_microseconds(os, e.duration_ns);
+                            if (e.detail != nullptr) {
+                                os << ", \"args\": {\"model\": ";
+                                write_json_string(os, e.detail->data(), e.detail->size());
+                                os << '}';
+                            }
+                            os << '}';
+                            first = false;
+                        }
+                    }
+                    os << "\n]}\n";
+                }
+            };
+
+            /**
+             * @brief Records a zone from its construction to its destruction if the recorder is started.
+             */
+            class trace_zone {
+                const char* _name;
+                const std::string* _detail;
+                std::int64_t _start = -1;
+
+            public:
+                explicit trace_zone(const char* name, const std::string* detail = nullptr) noexcept
+                : _name(name), _detail(detail) {
+                    trace_recorder& r = trace_recorder::instance();
+                    if (r.active()) {
+                        _start = r.now_ns();
+                    }
+                }
+
+                trace_zone(const trace_zone&) = delete;
+                trace_zone& operator=(const trace_zone&) = delete;
+
+                ~trace_zone() {
+                    trace_recorder& r = trace_recorder::instance();
+                    if (_start >= 0 && r.active()) {
+                        r.record(trace_recorder::zone_event{_name, _detail, _start, r.now_ns() - _start});
+                    }
+                }
+            };
+        }
+    }
+}
+
+#define CADMIUM_TRACE_ZONE_CONCAT_IMPL(A, B) A##B
+#define CADMIUM_TRACE_ZONE_CONCAT(A, B) CADMIUM_TRACE_ZONE_CONCAT_IMPL(A, B)
+
+/**
+ * @brief Opens a trace zone until the end of the scope, NAME is a string literal and DETAIL a pointer to the
+ * std::string of the model id or nullptr.
+ */
+#if defined(CADMIUM_NO_TRACE_ZONES)
+#define CADMIUM_TRACE_ZONE(NAME, DETAIL)
+#elif defined(CADMIUM_TRACY)
+#define CADMIUM_TRACE_ZONE(NAME, DETAIL) \
+    ZoneScopedN(NAME); \
+    if (const std::string* CADMIUM_TRACE_ZONE_CONCAT(cadmium_zone_detail_, __LINE__) = (DETAIL)) { \
+        ZoneText(CADMIUM_TRACE_ZONE_CONCAT(cadmium_zone_detail_, __LINE__)->data(), CADMIUM_TRACE_ZONE_CONCAT(cadmium_zone_detail_, __LINE__)->size()); \
+    }
+#else
+#define CADMIUM_TRACE_ZONE(NAME, DETAIL) \
+    cadmium::dynamic::engine::trace_zone CADMIUM_TRACE_ZONE_CONCAT(cadmium_trace_zone_, __LINE__)(NAME, DETAIL)
+#endif
+
+#endif // CADMIUM_PDEVS_DYNAMIC_TRACE_ZONES_HPP
@@ -30,6 +30,8 @@
 
 #include <type_traits>
 #include <tuple>
+#include <array>
+#include <utility>
 #include <algorithm>
 #include <iostream>
 #include <numeric>
@@ -40,55 +42,49 @@
 #include <cadmium/logger/common_loggers.hpp>
 #include <cadmium/logger/common_loggers_helpers.hpp>
 #include <cadmium/engine/common_helpers.hpp>
+#include <cadmium/engine/pdevs_execution.hpp>
 
 
 namespace cadmium {
     namespace engine {
         //forward declaration
-        template<template<typename T> class MODEL, typename TIME, typename LOGGER>
+        template<template<typename T> class MODEL, typename TIME, typename LOGGER, typename EXECUTION=sequential_execution>
         class coordinator;        //forward declaration
         template<template<typename T> class MODEL, typename TIME, typename LOGGER>
         class simulator;
 
         //finding the min next from a tuple of coordinators and simulators
-        template<typename T, std::size_t S>
-        struct min_next_in_tuple_impl {
-            static auto value(T& t) {
-                return std::min(std::get<S - 1>(t).next(), min_next_in_tuple_impl<T, S - 1>::value(t));
-            }
-        };
-
-        template<typename T>
-        struct min_next_in_tuple_impl<T, 1> {
-            static auto value(T& t) {
-                return std::get<0>(t).next();
-            }
-        };
-
         template<typename T>
         auto min_next_in_tuple(T& t) {
-            return min_next_in_tuple_impl<T, std::tuple_size<T>::value>::value(t);
+            auto min_next = [](auto& first, auto&... others) {
+                auto ret = first.next();
+                ((ret = std::min(ret, others.next())), ...);
+                return ret;
+            };
+            return std::apply(min_next, t);
         }
 
-        //We use COS to accumulate coordinators and simulators while iterating MT using the S index
-        template<typename TIME, template<typename> class MT, std::size_t S, typename LOGGER, typename... COS> //COS accumulates coords or sims
-        struct coordinate_tuple_impl {
+        //the coordinator or simulator of the I-th submodel in MT
+        template<typename TIME, template<typename> class MT, std::size_t I, typename LOGGER, typename EXECUTION>
+        struct coordinate_tuple_element {
             template<typename T>
-            using current=typename std::tuple_element<S - 1, MT<T>>::type;
-            using current_coordinated=typename std::conditional<cadmium::concept::is_atomic<current>::value(), simulator<current, TIME, LOGGER>, coordinator<current, TIME, LOGGER>>::type;
-            using type=typename coordinate_tuple_impl<TIME, MT, S - 1, LOGGER, current_coordinated, COS...>::type;
+            using current=typename std::tuple_element<I, MT<T>>::type;
+            using type=typename std::conditional<cadmium::concept::is_atomic<current>::value(), simulator<current, TIME, LOGGER>, coordinator<current, TIME, LOGGER, EXECUTION>>::type;
         };
 
-        //When the S reaches 0, all coordinators and simulators are put into a tuple for return
-        template<typename TIME, template<typename> class MT, typename LOGGER, typename... COS>
-        struct coordinate_tuple_impl<TIME, MT, 0, LOGGER, COS...> {
-            using type=std::tuple<COS...>;
+        //all coordinators and simulators are expanded at once from the indexes of MT
+        template<typename TIME, template<typename> class MT, typename LOGGER, typename EXECUTION, typename INDEXES>
+        struct coordinate_tuple_impl;
+
+        template<typename TIME, template<typename> class MT, typename LOGGER, typename EXECUTION, std::size_t... Is>
+        struct coordinate_tuple_impl<TIME, MT, LOGGER, EXECUTION, std::index_sequence<Is...>> {
+            using type=std::tuple<typename coordinate_tuple_element<TIME, MT, Is, LOGGER, EXECUTION>::type...>;
         };
 
-        template<typename TIME, template<typename> class MT, typename LOGGER>
+        template<typename TIME, template<typename> class MT, typename LOGGER, typename EXECUTION=sequential_execution>
         struct coordinate_tuple {
             //the size should not be affected by the type used for TIME, simplifying passing float
-            using type=typename coordinate_tuple_impl<TIME, MT, std::tuple_size<MT<float>>::value, LOGGER>::type;
+            using type=typename coordinate_tuple_impl<TIME, MT, LOGGER, EXECUTION, std::make_index_sequence<std::tuple_size<MT<float>>::value>>::type;
         };
 
         //initialize subcoordinators
@@ -99,6 +95,27 @@ namespace cadmium {
             cadmium::helper::for_each<CST>(cs, init_coordinator);
         }
 
+        //detects the subcoordinators initialized with an execution policy
+        template<typename ENGINE, typename TIME, typename EXECUTION, typename=void>
+        struct inits_with_execution : std::false_type {};
+
+        template<typename ENGINE, typename TIME, typename EXECUTION>
+        struct inits_with_execution<ENGINE, TIME, EXECUTION, std::void_t<decltype(std::declval<ENGINE&>().init(std::declval<TIME>(), std::declval<const EXECUTION&>()))>> : std::true_type {};
+
+        //initialize subcoordinators, the coordinators among them share the execution policy
+        template<typename TIME, typename CST, typename EXECUTION>
+        void init_subcoordinators(const TIME& t, CST& cs, const EXECUTION& execution) {
+
+            auto init_coordinator = [&t, &execution](auto & c)->void {
+                if constexpr (inits_with_execution<std::decay_t<decltype(c)>, TIME, EXECUTION>::value) {
+                    c.init(t, execution);
+                } else {
+                    c.init(t);
+                }
+            };
+            cadmium::helper::for_each<CST>(cs, init_coordinator);
+        }
+
         //populate the outbox of every subcoordinator recursively
         template<typename TIME, typename CST>
         void collect_outputs_in_subcoordinators(const TIME& t, CST& cs) {
@@ -108,84 +125,112 @@ namespace cadmium {
         }
 
         //get the engine  from a tuple of engines that is simulating the model provided
-        template<typename TIMED_MODEL, typename CST, size_t S>
-        struct get_engine_by_model_impl{
-            using current_engine=typename std::tuple_element<S-1, CST>::type;
-            using current_model=typename current_engine::model_type;
-            using type=typename std::conditional<std::is_same<current_model, TIMED_MODEL>::value, current_engine, typename get_engine_by_model_impl<TIMED_MODEL, CST, S-1>::type>::type;
-        };
-
         struct NO_SIMULATOR{};
 
+        //index of the engine simulating the model, the size of the tuple when there is none
         template<typename TIMED_MODEL, typename CST>
-        struct get_engine_by_model_impl<TIMED_MODEL, CST, 1>{
-            using current_engine=typename std::tuple_element<0, CST>::type;
-            using current_model=typename current_engine::model_type;
-            using type=typename std::conditional<std::is_same<current_model, TIMED_MODEL>::value, current_engine, NO_SIMULATOR>::type;
+        struct get_engine_index_by_model;
+
+        template<typename TIMED_MODEL, typename... ENGINES>
+        struct get_engine_index_by_model<TIMED_MODEL, std::tuple<ENGINES...>>{
+            static constexpr std::size_t find() {
+                //the leading false keeps the array non empty
+                constexpr bool matches[] = {false, std::is_same<typename ENGINES::model_type, TIMED_MODEL>::value...};
+                std::size_t index = sizeof...(ENGINES);
+                for (std::size_t i = 0; i < sizeof...(ENGINES); i++) {
+                    if (matches[i + 1]) {
+                        index = i;
+                    }
+                }
+                return index;
+            }
+
+            static constexpr std::size_t value = find();
+        };
+
+        template<typename CST, std::size_t I, bool FOUND=(I < std::tuple_size<CST>::value)>
+        struct get_engine_by_index_impl{
+            using type=typename std::tuple_element<I, CST>::type;
+        };
+
+        template<typename CST, std::size_t I>
+        struct get_engine_by_index_impl<CST, I, false>{
+            using type=NO_SIMULATOR;
         };
 
         template<typename TIMED_MODEL, typename CST>
         struct get_engine_type_by_model{
-            using type=typename get_engine_by_model_impl<TIMED_MODEL, CST, std::tuple_size<CST>::value>::type;
+            using type=typename get_engine_by_index_impl<CST, get_engine_index_by_model<TIMED_MODEL, CST>::value>::type;
         };
 
         template<typename TIMED_MODEL, typename CST>
-        //typename get_engine_type_by_model<TIMED_MODEL, CST>::type
         typename get_engine_type_by_model<TIMED_MODEL, CST>::type & get_engine_by_model(CST& cst){
-            return std::get<typename get_engine_type_by_model<TIMED_MODEL, CST>::type>(cst);
+            constexpr std::size_t index = get_engine_index_by_model<TIMED_MODEL, CST>::value;
+            static_assert(index < std::tuple_size<CST>::value, "No engine simulates the model in the tuple of engines");
+            return std::get<index>(cst);
         }
 
+        //the subengines that received messages in the current step, marked by the routing
+        template<typename CST>
+        using received_array=std::array<bool, std::tuple_size<CST>::value>;
+
         //map the messages in the outboxes of subengines to the messages in the outbox of current coordinator
-        template<typename TIME, typename EOC, std::size_t S, typename OUT_BAG, typename CST, typename LOGGER>
+        template<typename TIME, typename CURRENT_EOC, typename OUT_BAG, typename CST, typename LOGGER>
         struct collect_messages_by_eoc_impl{
-            using external_output_port=typename std::tuple_element<S-1, EOC>::type::external_output_port;
-            using submodel_from = typename std::tuple_element<S-1, EOC>::type::template submodel<TIME>;
-            using submodel_output_port=typename std::tuple_element<S-1, EOC>::type::submodel_output_port;
-            using submodel_out_messages_type=typename make_message_bags<typename std::tuple<submodel_output_port>>::type;
+            using external_output_port=typename CURRENT_EOC::external_output_port;
+            using submodel_from = typename CURRENT_EOC::template submodel<TIME>;
+            using submodel_output_port=typename CURRENT_EOC::submodel_output_port;
 
             static void fill(OUT_BAG& messages, CST& cst){
                 //process one coupling
-                auto from_bag = get_engine_by_model<submodel_from, CST>(cst).outbox();
+                const auto& from_bag = get_engine_by_model<submodel_from, CST>(cst).outbox();
                 auto& from_messages = get_messages<submodel_output_port>(from_bag);
                 auto& to_messages = get_messages<external_output_port>(messages);
                 to_messages.insert(to_messages.end(), from_messages.begin(), from_messages.end());
 
-                //logging data
-                std::ostringstream oss;
-                logger::implode(oss, from_messages);
-                std::string from_messages_str = oss.str();
-                std::string from_port_str = boost::typeindex::type_id<submodel_output_port >().pretty_name();
-
-                oss.clear();
-                oss.str("");
-                logger::implode(oss, to_messages);
-                std::string to_messages_str = oss.str();
-                std::string to_port_str = boost::typeindex::type_id<external_output_port>().pretty_name();
-
-                std::string from_model_str = boost::typeindex::type_id<submodel_from>().pretty_name();
-
-                LOGGER::template log<
-                        cadmium::logger::logger_message_routing,
-                        cadmium::logger::coor_routing_collect_eoc
-                >(from_messages_str, to_messages_str, from_port_str, to_port_str, from_model_str);
-
-                //iterate
-                collect_messages_by_eoc_impl<TIME, EOC, S-1, OUT_BAG, CST, LOGGER>::fill(messages, cst);
+                //logging data, only formatted when the routing is logged
+                if constexpr (cadmium::logger::logs_source<LOGGER, cadmium::logger::logger_message_routing>::value) {
+                    std::ostringstream oss;
+                    logger::implode(oss, from_messages);
+                    std::string from_messages_str = oss.str();
+                    std::string from_port_str = boost::typeindex::type_id<submodel_output_port >().pretty_name();
+
+                    oss.clear();
+                    oss.str("");
+                    logger::implode(oss, to_messages);
+                    std::string to_messages_str = oss.str();
+                    std::string to_port_str = boost::typeindex::type_id<external_output_port>().pretty_name();
+
+                    std::string from_model_str = boost::typeindex::type_id<submodel_from>().pretty_name();
+
+                    LOGGER::template log<
+                            cadmium::logger::logger_message_routing,
+                            cadmium::logger::coor_routing_collect_eoc
+                    >(from_messages_str, to_messages_str, from_port_str, to_port_str, from_model_str);
+                }
             }
         };
 
-        template<typename TIME, typename EOC, typename OUT_BAG, typename CST, typename LOGGER>
-        struct collect_messages_by_eoc_impl<TIME, EOC, 0, OUT_BAG, CST, LOGGER>{
-            static void fill(OUT_BAG& messages, CST& cst){} //nothing to do here
-        };
+        //the couplings are processed from the last to the first, keeping the order of the messages in the bags
+        template<typename TIME, typename EOC, typename OUT_BAG, typename CST, typename LOGGER, std::size_t... Is>
+        void collect_messages_by_eocs(OUT_BAG& messages, CST& cst, std::index_sequence<Is...>){
+            constexpr std::size_t last = sizeof...(Is) - 1;
+            (collect_messages_by_eoc_impl<TIME, typename std::tuple_element<last - Is, EOC>::type, OUT_BAG, CST, LOGGER>::fill(messages, cst), ...);
+        }
 
         template<typename TIME, typename EOC, typename OUT_BAG, typename CST,typename LOGGER>
         OUT_BAG collect_messages_by_eoc(CST& cst){
             OUT_BAG ret;//if the subcoordinators active are not connected by EOC, no output is generated
-            collect_messages_by_eoc_impl<TIME, EOC, std::tuple_size<EOC>::value, OUT_BAG, CST, LOGGER>::fill(ret, cst);
+            collect_messages_by_eocs<TIME, EOC, OUT_BAG, CST, LOGGER>(ret, cst, std::make_index_sequence<std::tuple_size<EOC>::value>{});
             return ret;
         }
 
+        //same as above, but appends to messages in place, keeping the capacity of its bags
+        template<typename TIME, typename EOC, typename OUT_BAG, typename CST,typename LOGGER>
+        void collect_messages_by_eoc(OUT_BAG& messages, CST& cst){
+            collect_messages_by_eocs<TIME, EOC, OUT_BAG, CST, LOGGER>(messages, cst, std::make_index_sequence<std::tuple_size<EOC>::value>{});
+        }
+
         //advance the simulation in every subengine
         template <typename TIME, typename CST>
         void advance_simulation_in_subengines(const TIME& t, CST& subcoordinators) {
@@ -195,112 +240,127 @@ namespace cadmium {
 
 
         //route messages following ICs
-        template<typename TIME, typename CST, typename ICs, std::size_t S, typename LOGGER>
+        template<typename TIME, typename CST, typename CURRENT_IC, typename LOGGER>
         struct route_internal_coupled_messages_on_subcoordinators_impl{
-            using current_IC=typename std::tuple_element<S-1, ICs>::type;
-            using from_model=typename current_IC::template from_model<TIME>;
-            using from_port=typename current_IC::from_model_output_port;
-            using to_model=typename current_IC::template to_model<TIME>;
-            using to_port=typename current_IC::to_model_input_port;
+            using from_model=typename CURRENT_IC::template from_model<TIME>;
+            using from_port=typename CURRENT_IC::from_model_output_port;
+            using to_model=typename CURRENT_IC::template to_model<TIME>;
+            using to_port=typename CURRENT_IC::to_model_input_port;
 
             using from_model_type=typename get_engine_type_by_model<from_model, CST>::type;
             using to_model_type=typename get_engine_type_by_model<to_model, CST>::type;
-            static void route(const TIME& t, CST& engines){
+            static constexpr std::size_t to_index=get_engine_index_by_model<to_model, CST>::value;
+
+            static void route(const TIME& t, CST& engines, received_array<CST>& received){
                 //route messages for 1 coupling
                 from_model_type& from_engine = get_engine_by_model<from_model, CST>(engines);
                 to_model_type& to_engine=get_engine_by_model<to_model, CST>(engines);
 
                 //add the messages
-                auto& from_messages = cadmium::get_messages<from_port>(from_engine._outbox);
-                auto& to_messages = cadmium::get_messages<to_port>(to_engine._inbox);
-                to_messages.insert(to_messages.end(), from_messages.begin(), from_messages.end());
-
-                //logging data
-                std::ostringstream oss;
-                logger::implode(oss, from_messages);
-                std::string from_messages_str = oss.str();
-                std::string from_port_str = boost::typeindex::type_id<from_port>().pretty_name();
-                std::string from_model_str = boost::typeindex::type_id<from_model>().pretty_name();
-
-                oss.clear();
-                oss.str("");
-                logger::implode(oss, to_messages);
-                std::string to_messages_str = oss.str();
-                std::string to_port_str = boost::typeindex::type_id<to_port>().pretty_name();
-                std::string to_model_str = boost::typeindex::type_id<to_model>().pretty_name();
-
-                LOGGER::template log<
-                        cadmium::logger::logger_message_routing,
-                        cadmium::logger::coor_routing_collect_ic
-                >(from_messages_str, to_messages_str, from_port_str, from_model_str, to_port_str, to_model_str);
-
-                //iterate
-                route_internal_coupled_messages_on_subcoordinators_impl<TIME, CST, ICs, S-1, LOGGER>::route(t, engines);
+                auto& from_messages = cadmium::get_messages<from_port>(from_engine.outbox());
+                auto& to_messages = cadmium::get_messages<to_port>(to_engine.inbox());
+                if (!from_messages.empty()) {
+                    to_messages.insert(to_messages.end(), from_messages.begin(), from_messages.end());
+                    received[to_index] = true;
+                }
+
+                //logging data, only formatted when the routing is logged
+                if constexpr (cadmium::logger::logs_source<LOGGER, cadmium::logger::logger_message_routing>::value) {
+                    std::ostringstream oss;
+                    logger::implode(oss, from_messages);
+                    std::string from_messages_str = oss.str();
+                    std::string from_port_str = boost::typeindex::type_id<from_port>().pretty_name();
+                    std::string from_model_str = boost::typeindex::type_id<from_model>().pretty_name();
+
+                    oss.clear();
+                    oss.str("");
+                    logger::implode(oss, to_messages);
+                    std::string to_messages_str = oss.str();
+                    std::string to_port_str = boost::typeindex::type_id<to_port>().pretty_name();
+                    std::string to_model_str = boost::typeindex::type_id<to_model>().pretty_name();
+
+                    LOGGER::template log<
+                            cadmium::logger::logger_message_routing,
+                            cadmium::logger::coor_routing_collect_ic
+                    >(from_messages_str, to_messages_str, from_port_str, from_model_str, to_port_str, to_model_str);
+                }
             }
         };
 
-        template<typename TIME, typename CST, typename ICs, typename LOGGER>
-        struct route_internal_coupled_messages_on_subcoordinators_impl<TIME, CST, ICs, 0, LOGGER>{
-            static void route(const TIME& t, CST& subcoordinators){
-            //nothing to do here
-            }
-        };
+        template <typename TIME, typename CST, typename ICs, typename LOGGER, std::size_t... Is>
+        void route_internal_coupled_messages_on_subcoordinators(const TIME& t, CST& cst, received_array<CST>& received, std::index_sequence<Is...>){
+            constexpr std::size_t last = sizeof...(Is) - 1;
+            (route_internal_coupled_messages_on_subcoordinators_impl<TIME, CST, typename std::tuple_element<last - Is, ICs>::type, LOGGER>::route(t, cst, received), ...);
+        }
+
+        //the subengines receiving messages are marked in received
+        template <typename TIME, typename CST, typename ICs, typename LOGGER >
+        void route_internal_coupled_messages_on_subcoordinators(const TIME& t, CST& cst, received_array<CST>& received){
+            route_internal_coupled_messages_on_subcoordinators<TIME, CST, ICs, LOGGER>(t, cst, received, std::make_index_sequence<std::tuple_size<ICs>::value>{});
+        }
 
         template <typename TIME, typename CST, typename ICs, typename LOGGER >
         void route_internal_coupled_messages_on_subcoordinators(const TIME& t, CST& cst){
-            route_internal_coupled_messages_on_subcoordinators_impl<TIME, CST, ICs, std::tuple_size<ICs>::value, LOGGER>::route(t, cst);
+            received_array<CST> received{};
+            route_internal_coupled_messages_on_subcoordinators<TIME, CST, ICs, LOGGER>(t, cst, received);
             return;
         }
 
-        template<typename TIME, typename INBAGS, typename CST, typename EICs, size_t S, typename LOGGER>
+        template<typename TIME, typename INBAGS, typename CST, typename CURRENT_EIC, typename LOGGER>
         struct route_external_input_coupled_messages_on_subcoordinators_impl{
-            using current_EIC=typename std::tuple_element<S-1, EICs>::type;
-            using from_port=typename current_EIC::external_input_port;
-            using to_model=typename current_EIC::template submodel<TIME>;
-            using to_port=typename current_EIC::submodel_input_port;
+            using from_port=typename CURRENT_EIC::external_input_port;
+            using to_model=typename CURRENT_EIC::template submodel<TIME>;
+            using to_port=typename CURRENT_EIC::submodel_input_port;
+            static constexpr std::size_t to_index=get_engine_index_by_model<to_model, CST>::value;
 
-            static void route(TIME t, const INBAGS& inbox, CST& engines){
+            static void route(TIME t, const INBAGS& inbox, CST& engines, received_array<CST>& received){
                 auto& to_engine=get_engine_by_model<to_model, CST>(engines);
                 auto& from_messages = cadmium::get_messages<from_port>(inbox);
-                auto& to_messages = cadmium::get_messages<to_port>(to_engine._inbox);
-                to_messages.insert(to_messages.end(), from_messages.begin(), from_messages.end());
-
-                //logging data
-                std::ostringstream oss;
-                logger::implode(oss, from_messages);
-                std::string from_messages_str = oss.str();
-                std::string from_port_str = boost::typeindex::type_id<from_port>().pretty_name();
-
-                oss.clear();
-                oss.str("");
-                logger::implode(oss, to_messages);
-                std::string to_messages_str = oss.str();
-                std::string to_port_str = boost::typeindex::type_id<to_port>().pretty_name();
-
-                std::string to_model_str = boost::typeindex::type_id<to_model>().pretty_name();
-
-                LOGGER::template log<
-                        cadmium::logger::logger_message_routing,
-                        cadmium::logger::coor_routing_collect_eic
-                >(from_messages_str, to_messages_str, to_port_str, to_model_str, from_port_str);
-
-                //iterate
-                route_external_input_coupled_messages_on_subcoordinators_impl<TIME, INBAGS, CST, EICs, S-1, LOGGER>::route(t, inbox, engines);
-
+                auto& to_messages = cadmium::get_messages<to_port>(to_engine.inbox());
+                if (!from_messages.empty()) {
+                    to_messages.insert(to_messages.end(), from_messages.begin(), from_messages.end());
+                    received[to_index] = true;
+                }
+
+                //logging data, only formatted when the routing is logged
+                if constexpr (cadmium::logger::logs_source<LOGGER, cadmium::logger::logger_message_routing>::value) {
+                    std::ostringstream oss;
+                    logger::implode(oss, from_messages);
+                    std::string from_messages_str = oss.str();
+                    std::string from_port_str = boost::typeindex::type_id<from_port>().pretty_name();
+
+                    oss.clear();
+                    oss.str("");
+                    logger::implode(oss, to_messages);
+                    std::string to_messages_str = oss.str();
+                    std::string to_port_str = boost::typeindex::type_id<to_port>().pretty_name();
+
+                    std::string to_model_str = boost::typeindex::type_id<to_model>().pretty_name();
+
+                    LOGGER::template log<
+                            cadmium::logger::logger_message_routing,
+                            cadmium::logger::coor_routing_collect_eic
+                    >(from_messages_str, to_messages_str, to_port_str, to_model_str, from_port_str);
+                }
             }
         };
 
-        template<typename TIME, typename INBAGS, typename CST, typename EICs, typename LOGGER>
-        struct route_external_input_coupled_messages_on_subcoordinators_impl<TIME, INBAGS, CST, EICs, 0, LOGGER>{
-            static void route(TIME T, const INBAGS& inbox, CST& engines){
-            //nothing to do here
-            }
-        };
+        template <typename TIME, typename INBAGS, typename CST, typename EICs, typename LOGGER, std::size_t... Is>
+        void route_external_input_coupled_messages_on_subcoordinators(const TIME& t, const INBAGS& inbox, CST& cst, received_array<CST>& received, std::index_sequence<Is...>){
+            constexpr std::size_t last = sizeof...(Is) - 1;
+            (route_external_input_coupled_messages_on_subcoordinators_impl<TIME, INBAGS, CST, typename std::tuple_element<last - Is, EICs>::type, LOGGER>::route(t, inbox, cst, received), ...);
+        }
 
+        //the subengines receiving messages are marked in received
+        template <typename TIME, typename INBAGS, typename CST, typename EICs, typename LOGGER >
+        void route_external_input_coupled_messages_on_subcoordinators(const TIME& t, const INBAGS& inbox, CST& cst, received_array<CST>& received){
+            route_external_input_coupled_messages_on_subcoordinators<TIME, INBAGS, CST, EICs, LOGGER>(t, inbox, cst, received, std::make_index_sequence<std::tuple_size<EICs>::value>{});
+        }
 
         template <typename TIME, typename INBAGS, typename CST, typename EICs, typename LOGGER >
         void route_external_input_coupled_messages_on_subcoordinators(const TIME& t, const INBAGS& inbox, CST& cst){
-                route_external_input_coupled_messages_on_subcoordinators_impl<TIME, INBAGS, CST, EICs, std::tuple_size<EICs>::value, LOGGER>::route(t, inbox, cst);
+                received_array<CST> received{};
+                route_external_input_coupled_messages_on_subcoordinators<TIME, INBAGS, CST, EICs, LOGGER>(t, inbox, cst, received);
             return;
         }
 
@@ -312,6 +372,90 @@ namespace cadmium {
             };
             return std::apply(check_empty, box);
         }
+
+        //Removing the messages of all the bags of inbox or outbox, their capacity is kept for the next step
+        template<typename BOX>
+        void clear_bags(BOX& box) {
+            auto clear_bag = [](auto&... b)->void {
+                (b.clear(), ...);
+            };
+            std::apply(clear_bag, box);
+        }
+
+        //calls f with the index and the subengine, for each subengine in the tuple
+        template<typename CST, typename FUNC, std::size_t... Is>
+        void for_each_indexed_impl(CST& cs, FUNC&& f, std::index_sequence<Is...>) {
+            (f(Is, std::get<Is>(cs)), ...);
+        }
+
+        template<typename CST, typename FUNC>
+        void for_each_indexed(CST& cs, FUNC&& f) {
+            for_each_indexed_impl(cs, std::forward<FUNC>(f), std::make_index_sequence<std::tuple_size<CST>::value>{});
+        }
+
+        //the next of every subengine, cached to be updated only when the subengine transitions
+        template<typename TIME, typename CST>
+        using nexts_array=std::array<TIME, std::tuple_size<CST>::value>;
+
+        template<typename TIME, typename CST>
+        void cache_nexts(const CST& cs, nexts_array<TIME, CST>& nexts) {
+            for_each_indexed(cs, [&nexts](std::size_t i, const auto& c)->void { nexts[i] = c.next(); });
+        }
+
+        template<typename TIME, std::size_t N>
+        TIME min_next_in_array(const std::array<TIME, N>& nexts) {
+            return *std::min_element(nexts.begin(), nexts.end());
+        }
+
+        //populate the outbox of the subcoordinators scheduled at t, the others outboxes are empty since their last advance
+        template<typename TIME, typename CST, typename EXECUTION=sequential_execution>
+        void collect_outputs_in_imminent_subengines(const TIME& t, CST& cs, const nexts_array<TIME, CST>& nexts, const EXECUTION& execution=EXECUTION()) {
+            if constexpr (std::is_same<EXECUTION, sequential_execution>::value) {
+                for_each_indexed(cs, [&t, &nexts](std::size_t i, auto& c)->void {
+                    if (nexts[i] == t) {
+                        c.collect_outputs(t);
+                    }
+                });
+            } else {
+                std::array<std::size_t, std::tuple_size<CST>::value> imminent;
+                std::size_t n = 0;
+                for (std::size_t i = 0; i < nexts.size(); i++) {
+                    if (nexts[i] == t) {
+                        imminent[n++] = i;
+                    }
+                }
+                for_each_subengine_at(cs, imminent, n, execution, [&t](auto& c)->void { c.collect_outputs(t); });
+            }
+        }
+
+        //advance the subengines scheduled at t or marked in received by the routing, and update their cached next,
+        //the passive subengines without messages are not visited and the marks are cleared for the next step
+        template<typename TIME, typename CST, typename EXECUTION=sequential_execution>
+        void advance_simulation_in_active_subengines(const TIME& t, CST& cs, nexts_array<TIME, CST>& nexts, received_array<CST>& received, const EXECUTION& execution=EXECUTION()) {
+            if constexpr (std::is_same<EXECUTION, sequential_execution>::value) {
+                for_each_indexed(cs, [&t, &nexts, &received](std::size_t i, auto& c)->void {
+                    if (nexts[i] == t || received[i]) {
+                        c.advance_simulation(t);
+                        nexts[i] = c.next();
+                        received[i] = false;
+                    }
+                });
+            } else {
+                //the active subengines are found before advancing them concurrently, each one updates its own next
+                std::array<std::size_t, std::tuple_size<CST>::value> active;
+                std::size_t n = 0;
+                for (std::size_t i = 0; i < nexts.size(); i++) {
+                    if (nexts[i] == t || received[i]) {
+                        active[n++] = i;
+                        received[i] = false;
+                    }
+                }
+                for_each_subengine_at(cs, active, n, execution, [&t](auto& c)->void { c.advance_simulation(t); });
+                for (std::size_t k = 0; k < n; k++) {
+                    visit_at(cs, active[k], [&nexts, i = active[k]](auto& c)->void { nexts[i] = c.next(); });
+                }
+            }
+        }
     }
 
 
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_EXECUTION_HPP
+#define CADMIUM_PDEVS_EXECUTION_HPP
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include <cadmium/engine/pdevs_dynamic_execution.hpp>
+
+/**
+ * Execution policies of the static engine, the same ones of the dynamic engine (see pdevs_dynamic_execution.hpp).
+ * A static coordinator runs the output and transition functions of its active subengines with the policy,
+ * the routing of the messages between them is always sequential.
+ */
+namespace cadmium {
+    namespace engine {
+        using sequential_execution=cadmium::dynamic::engine::sequential_execution;
+        using parallel_execution=cadmium::dynamic::engine::parallel_execution;
+        using work_stealing_execution=cadmium::dynamic::engine::work_stealing_execution;
+
+        //calls f with the element I of the tuple, I known at runtime
+        template<typename CST, typename FUNC, std::size_t... Is>
+        void visit_at_impl(CST& cs, std::size_t i, FUNC& f, std::index_sequence<Is...>) {
+            ((i == Is ? (f(std::get<Is>(cs)), true) : false) || ...);
+        }
+
+        template<typename CST, typename FUNC>
+        void visit_at(CST& cs, std::size_t i, FUNC&& f) {
+            visit_at_impl(cs, i, f, std::make_index_sequence<std::tuple_size<CST>::value>{});
+        }
+
+        //calls f with the subengines at the first n indexes, concurrently if the execution policy does
+        template<typename CST, typename EXECUTION, typename FUNC>
+        void for_each_subengine_at(CST& cs, const std::array<std::size_t, std::tuple_size<CST>::value>& indexes, std::size_t n, const EXECUTION& execution, FUNC f) {
+            execution.for_each_index(n, [&cs, &indexes, &f](std::size_t k) { visit_at(cs, indexes[k], f); });
+        }
+    }
+}
+
+#endif // CADMIUM_PDEVS_EXECUTION_HPP
@@ -0,0 +1,289 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_FLAT_COUPLINGS_HPP
+#define CADMIUM_PDEVS_FLAT_COUPLINGS_HPP
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Compile time flattening of a static coupled model. The atomic models of the hierarchy are
+ * numbered depth first and every output port of an atomic model is followed through the ICs,
+ * EOCs and EICs of the coupled models above it until the atomic input ports it reaches, the
+ * result is a tuple of flat_link between atomic models that needs no coordinator to be routed.
+ *
+ * Models are identified by their path, the indexes of the submodels taken from the top model,
+ * as the submodels of a coupled model are identified by type and the same atomic model type
+ * can appear under different coupled models.
+ */
+namespace cadmium {
+    namespace engine {
+
+        template<std::size_t... Is>
+        struct model_path {};
+
+        //a coupling between the output port of an atomic model and the input port of another one
+        template<std::size_t FROM, typename FROM_PORT, std::size_t TO, typename TO_PORT>
+        struct flat_link {
+            static constexpr std::size_t from_index = FROM;
+            using from_port=FROM_PORT;
+            static constexpr std::size_t to_index = TO;
+            using to_port=TO_PORT;
+        };
+
+        namespace flat_details {
+
+            template<typename... TUPLES>
+            using tuple_cat_t=decltype(std::tuple_cat(std::declval<TUPLES>()...));
+
+            //coupled models are the ones defining couplings
+            template<typename TIMED_MODEL, typename=void>
+            struct is_coupled : std::false_type {};
+
+            template<typename TIMED_MODEL>
+            struct is_coupled<TIMED_MODEL, std::void_t<typename TIMED_MODEL::internal_couplings>> : std::true_type {};
+
+            template<typename PATH, std::size_t I>
+            struct child_path;
+
+            template<std::size_t... Is, std::size_t I>
+            struct child_path<model_path<Is...>, I> {
+                using type=model_path<Is..., I>;
+            };
+
+            template<typename PATH, typename SEQ>
+            struct path_prefix;
+
+            template<std::size_t... Is, std::size_t... Ns>
+            struct path_prefix<model_path<Is...>, std::index_sequence<Ns...>> {
+                using type=model_path<std::get<Ns>(std::make_tuple(Is...))...>;
+            };
+
+            template<typename PATH>
+            struct parent_path;
+
+            template<std::size_t... Is>
+            struct parent_path<model_path<Is...>> {
+                using type=typename path_prefix<model_path<Is...>, std::make_index_sequence<sizeof...(Is) - 1>>::type;
+            };
+
+            //position of the first element of the tuple with type T
+            template<typename T, typename TUPLE>
+            struct index_of;
+
+            template<typename T, typename... Ts>
+            struct index_of<T, std::tuple<T, Ts...>> : std::integral_constant<std::size_t, 0> {};
+
+            template<typename T, typename U, typename... Ts>
+            struct index_of<T, std::tuple<U, Ts...>> : std::integral_constant<std::size_t, 1 + index_of<T, std::tuple<Ts...>>::value> {};
+
+            //the timed model found following the path from TIMED_MODEL
+            template<typename TIME, typename TIMED_MODEL, typename PATH>
+            struct model_at;
+
+            template<typename TIME, typename TIMED_MODEL>
+            struct model_at<TIME, TIMED_MODEL, model_path<>> {
+                using type=TIMED_MODEL;
+            };
+
+            template<typename TIME, typename TIMED_MODEL, std::size_t I, std::size_t... Is>
+            struct model_at<TIME, TIMED_MODEL, model_path<I, Is...>> {
+                using submodel=typename std::tuple_element<I, typename TIMED_MODEL::template models<TIME>>::type;
+                using type=typename model_at<TIME, submodel, model_path<Is...>>::type;
+            };
+
+            //the paths to the atomic models under the model at PATH, depth first
+            template<typename TIME, typename TOP, typename PATH, bool COUPLED=is_coupled<typename model_at<TIME, TOP, PATH>::type>::value>
+            struct leaves_of {
+                using type=std::tuple<PATH>;
+            };
+
+            template<typename TIME, typename TOP, typename PATH, typename SEQ>
+            struct leaves_of_children;
+
+            template<typename TIME, typename TOP, typename PATH, std::size_t... Ns>
+            struct leaves_of_children<TIME, TOP, PATH, std::index_sequence<Ns...>> {
+                using type=tuple_cat_t<typename leaves_of<TIME, TOP, typename child_path<PATH, Ns>::type>::type...>;
+            };
+
+            template<typename TIME, typename TOP, typename PATH>
+            struct leaves_of<TIME, TOP, PATH, true> {
+                using submodels=typename model_at<TIME, TOP, PATH>::type::template models<TIME>;
+                using type=typename leaves_of_children<TIME, TOP, PATH, std::make_index_sequence<std::tuple_size<submodels>::value>>::type;
+            };
+
+            //an input port of an atomic model
+            template<typename PATH, typename PORT>
+            struct endpoint {
+                using path=PATH;
+                using port=PORT;
+            };
+
+            //the atomic input ports reached by messages arriving to PORT of the model at PATH
+            template<typename TIME, typename TOP, typename PATH, typename PORT, bool COUPLED=is_coupled<typename model_at<TIME, TOP, PATH>::type>::value>
+            struct resolve_in {
+                using type=std::tuple<endpoint<PATH, PORT>>;
+            };
+
+            template<bool MATCH, typename TIME, typename TOP, typename PATH, typename EIC>
+            struct resolve_eic {
+                using type=std::tuple<>;
+            };
+
+            template<typename TIME, typename TOP, typename PATH, typename EIC>
+            struct resolve_eic<true, TIME, TOP, PATH, EIC> {
+                using submodels=typename model_at<TIME, TOP, PATH>::type::template models<TIME>;
+                using to_path=typename child_path<PATH, index_of<typename EIC::template submodel<TIME>, submodels>::value>::type;
+                using type=typename resolve_in<TIME, TOP, to_path, typename EIC::submodel_input_port>::type;
+            };
+
+            template<typename TIME, typename TOP, typename PATH, typename PORT, typename EICS>
+            struct resolve_eics;
+
+            template<typename TIME, typename TOP, typename PATH, typename PORT, typename... EICS>
+            struct resolve_eics<TIME, TOP, PATH, PORT, std::tuple<EICS...>> {
+                using type=tuple_cat_t<typename resolve_eic<std::is_same<PORT, typename EICS::external_input_port>::value, TIME, TOP, PATH, EICS>::type...>;
+            };
+
+            template<typename TIME, typename TOP, typename PATH, typename PORT>
+            struct resolve_in<TIME, TOP, PATH, PORT, true> {
+                using eics=typename model_at<TIME, TOP, PATH>::type::external_input_couplings;
+                using type=typename resolve_eics<TIME, TOP, PATH, PORT, eics>::type;
+            };
+
+            //the atomic input ports reached by messages leaving PORT of the model at PATH,
+            //the ones reaching the output ports of the top model are not routed
+            template<typename TIME, typename TOP, typename PATH, typename PORT>
+            struct resolve_out;
+
+            template<bool MATCH, typename TIME, typename TOP, typename PARENT, typename IC>
+            struct resolve_ic {
+                using type=std::tuple<>;
+            };
+
+            template<typename TIME, typename TOP, typename PARENT, typename IC>
+            struct resolve_ic<true, TIME, TOP, PARENT, IC> {
+                using submodels=typename model_at<TIME, TOP, PARENT>::type::template models<TIME>;
+                using to_path=typename child_path<PARENT, index_of<typename IC::template to_model<TIME>, submodels>::value>::type;
+                using type=typename resolve_in<TIME, TOP, to_path, typename IC::to_model_input_port>::type;
+            };
+
+            template<bool MATCH, typename TIME, typename TOP, typename PARENT, typename EOC>
+            struct resolve_eoc {
+                using type=std::tuple<>;
+            };
+
+            template<typename TIME, typename TOP, typename PARENT, typename EOC>
+            struct resolve_eoc<true, TIME, TOP, PARENT, EOC> {
+                using type=typename resolve_out<TIME, TOP, PARENT, typename EOC::external_output_port>::type;
+            };
+
+            template<typename TIME, typename TOP, typename PATH, typename PORT, typename ICS, typename EOCS>
+            struct resolve_out_couplings;
+
+            template<typename TIME, typename TOP, typename PATH, typename PORT, typename... ICS, typename... EOCS>
+            struct resolve_out_couplings<TIME, TOP, PATH, PORT, std::tuple<ICS...>, std::tuple<EOCS...>> {
+                using parent=typename parent_path<PATH>::type;
+                using from_model=typename model_at<TIME, TOP, PATH>::type;
+
+                template<typename FROM, typename FROM_PORT>
+                static constexpr bool from_here = std::is_same<FROM, from_model>::value && std::is_same<FROM_PORT, PORT>::value;
+
+                using type=tuple_cat_t<
+                        typename resolve_ic<from_here<typename ICS::template from_model<TIME>, typename ICS::from_model_output_port>, TIME, TOP, parent, ICS>::type...,
+                        typename resolve_eoc<from_here<typename EOCS::template submodel<TIME>, typename EOCS::submodel_output_port>, TIME, TOP, parent, EOCS>::type...
+                >;
+            };
+
+            template<typename TIME, typename TOP, typename PORT>
+            struct resolve_out<TIME, TOP, model_path<>, PORT> {
+                using type=std::tuple<>;
+            };
+
+            template<typename TIME, typename TOP, typename PATH, typename PORT>
+            struct resolve_out {
+                using parent_model=typename model_at<TIME, TOP, typename parent_path<PATH>::type>::type;
+                using type=typename resolve_out_couplings<
+                        TIME, TOP, PATH, PORT,
+                        typename parent_model::internal_couplings,
+                        typename parent_model::external_output_couplings
+                >::type;
+            };
+
+            //the flat links leaving one output port of the atomic model number FROM
+            template<typename TIME, typename TOP, typename LEAVES, std::size_t FROM, typename PORT, typename ENDPOINTS>
+            struct port_links;
+
+            template<typename TIME, typename TOP, typename LEAVES, std::size_t FROM, typename PORT, typename... ENDPOINTS>
+            struct port_links<TIME, TOP, LEAVES, FROM, PORT, std::tuple<ENDPOINTS...>> {
+                using type=std::tuple<flat_link<FROM, PORT, index_of<typename ENDPOINTS::path, LEAVES>::value, typename ENDPOINTS::port>...>;
+            };
+
+            template<typename TIME, typename TOP, typename LEAVES, std::size_t FROM, typename PORTS>
+            struct leaf_links;
+
+            template<typename TIME, typename TOP, typename LEAVES, std::size_t FROM, typename... PORTS>
+            struct leaf_links<TIME, TOP, LEAVES, FROM, std::tuple<PORTS...>> {
+                using path=typename std::tuple_element<FROM, LEAVES>::type;
+                using type=tuple_cat_t<typename port_links<TIME, TOP, LEAVES, FROM, PORTS, typename resolve_out<TIME, TOP, path, PORTS>::type>::type...>;
+            };
+
+            template<typename TIME, typename TOP, typename LEAVES, typename SEQ>
+            struct all_links;
+
+            template<typename TIME, typename TOP, typename LEAVES, std::size_t... Ls>
+            struct all_links<TIME, TOP, LEAVES, std::index_sequence<Ls...>> {
+                using type=tuple_cat_t<typename leaf_links<
+                        TIME, TOP, LEAVES, Ls,
+                        typename model_at<TIME, TOP, typename std::tuple_element<Ls, LEAVES>::type>::type::output_ports
+                >::type...>;
+            };
+        }
+
+        /**
+         * @brief flat_couplings is the flattened structure of a static coupled model
+         * leaves is a tuple with the model_path of every atomic model, depth first, and links
+         * a tuple of flat_link between the positions of the atomic models in leaves.
+         */
+        template<typename TIME, template<typename> class MODEL>
+        struct flat_couplings {
+            using leaves=typename flat_details::leaves_of<TIME, MODEL<TIME>, model_path<>>::type;
+            using links=typename flat_details::all_links<TIME, MODEL<TIME>, leaves, std::make_index_sequence<std::tuple_size<leaves>::value>>::type;
+
+            //the atomic model at position I of leaves, as the template simulators expect
+            template<std::size_t I>
+            struct leaf {
+                template<typename T>
+                using model=typename flat_details::model_at<T, MODEL<T>, typename std::tuple_element<I, leaves>::type>::type;
+            };
+        };
+    }
+}
+
+#endif // CADMIUM_PDEVS_FLAT_COUPLINGS_HPP
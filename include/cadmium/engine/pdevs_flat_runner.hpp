@@ -0,0 +1,182 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_PDEVS_FLAT_RUNNER_HPP
+#define CADMIUM_PDEVS_FLAT_RUNNER_HPP
+
+#include <limits>
+#include <sstream>
+#include <boost/type_index.hpp>
+
+#include <cadmium/engine/pdevs_runner.hpp>
+#include <cadmium/engine/pdevs_simulator.hpp>
+#include <cadmium/engine/pdevs_flat_couplings.hpp>
+#include <cadmium/engine/pdevs_engine_helpers.hpp>
+#include <cadmium/modeling/message_arena.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+namespace cadmium {
+    namespace engine {
+
+        template<typename TIME, template<typename> class MODEL, typename LOGGER, typename SEQ>
+        struct flat_simulators_impl;
+
+        template<typename TIME, template<typename> class MODEL, typename LOGGER, std::size_t... Is>
+        struct flat_simulators_impl<TIME, MODEL, LOGGER, std::index_sequence<Is...>> {
+            using type=std::tuple<simulator<flat_couplings<TIME, MODEL>::template leaf<Is>::template model, TIME, LOGGER>...>;
+        };
+
+        //one simulator for each atomic model in the hierarchy, in the order of flat_couplings::leaves
+        template<typename TIME, template<typename> class MODEL, typename LOGGER>
+        struct flat_simulators {
+            using type=typename flat_simulators_impl<TIME, MODEL, LOGGER, std::make_index_sequence<std::tuple_size<typename flat_couplings<TIME, MODEL>::leaves>::value>>::type;
+        };
+
+        /**
+         * @brief The flat runner runs a static coupled model without coordinators.
+         * The couplings of the hierarchy are flattened at compile time, see pdevs_flat_couplings.hpp,
+         * all the simulators are kept in a single tuple and every message is routed from the
+         * outbox of the simulator producing it directly to the inboxes of the simulators receiving it.
+         * The simulation is the same the runner produces, the messages reaching the output ports
+         * of the top model are not kept, as the runner does not read them either.
+         *
+         * @param Model The model to be simulated
+         * @param Time Representation of time to be used to run the simualtion
+         * @param Logger what, where and how to log from the simulation
+         * @param Execution the policy running the simulators outputs and transitions, see pdevs_execution.hpp
+         */
+        template <class TIME, template<class> class MODEL, typename LOGGER=default_logger<TIME>, typename EXECUTION=sequential_execution>
+        class flat_runner{
+            using couplings=flat_couplings<TIME, MODEL>;
+            using links=typename couplings::links;
+            using simulators_type=typename flat_simulators<TIME, MODEL, LOGGER>::type;
+
+            TIME _next; //next scheduled event
+            simulators_type _simulators;
+            nexts_array<TIME, simulators_type> _simulators_next; //cached next of each simulator
+            received_array<simulators_type> _simulators_received{}; //the simulators receiving messages in the step
+            EXECUTION _execution;
+
+        public:
+            /**
+             * @brief set the dynamic parameters for the simulation
+             * @param init_time is the initial time of the simulation.
+             */
+            explicit flat_runner(const TIME& init_time)
+            : flat_runner(init_time, EXECUTION()) {}
+
+            /**
+             * @brief set the dynamic parameters for the simulation
+             * @param init_time is the initial time of the simulation.
+             * @param execution is the policy running the simulators.
+             */
+            flat_runner(const TIME& init_time, const EXECUTION& execution)
+            : _execution(execution) {
+                LOGGER::template log<cadmium::logger::logger_global_time, cadmium::logger::run_global_time>(init_time);
+                LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Preparing model");
+                cadmium::engine::init_subcoordinators<TIME, simulators_type>(init_time, _simulators);
+                cadmium::engine::cache_nexts<TIME, simulators_type>(_simulators, _simulators_next);
+                _next = cadmium::engine::min_next_in_array(_simulators_next);
+            }
+
+            /**
+             * @brief runUntil starts the simulation and stops when the next event is scheduled after t.
+             * @param t is the limit time for the simulation.
+             * @return the TIME of the next event to happen when simulation stopped.
+             */
+            TIME run_until(const TIME &t) {
+                LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Starting run");
+                while (_next < t){
+                    LOGGER::template log<cadmium::logger::logger_global_time, cadmium::logger::run_global_time>(_next);
+                    const TIME now = _next;
+                    cadmium::engine::collect_outputs_in_imminent_subengines<TIME, simulators_type>(now, _simulators, _simulators_next, _execution);
+                    route_links(static_cast<links*>(nullptr));
+                    // the imminent simulators and the ones receiving messages, as the coordinators do
+                    cadmium::engine::advance_simulation_in_active_subengines<TIME, simulators_type>(now, _simulators, _simulators_next, _simulators_received, _execution);
+                    // all the messages of the step were consumed
+                    cadmium::message_arena::instance().release();
+                    _next = cadmium::engine::min_next_in_array(_simulators_next);
+                }
+                LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Finished run");
+                return _next;
+            }
+
+            /**
+             * @brief runUntilPassivate starts the simulation and stops when there is no next internal event to happen.
+             */
+            void run_until_passivate() {
+                LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Starting run");
+                static_assert(std::numeric_limits<TIME>::has_infinity, "TIME datatype has no infinity defined");
+                run_until(std::numeric_limits<TIME>::infinity());
+                LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Finished run");
+            }
+
+        private:
+            template<typename... LINKS>
+            void route_links(std::tuple<LINKS...>*) {
+                (route_link<LINKS>(), ...);
+            }
+
+            template<typename LINK>
+            void route_link() {
+                auto& from_engine = std::get<LINK::from_index>(_simulators);
+                auto& from_messages = cadmium::get_messages<typename LINK::from_port>(from_engine.outbox());
+                if (from_messages.empty()) {
+                    return;
+                }
+                auto& to_engine = std::get<LINK::to_index>(_simulators);
+                auto& to_messages = cadmium::get_messages<typename LINK::to_port>(to_engine.inbox());
+                to_messages.insert(to_messages.end(), from_messages.begin(), from_messages.end());
+                _simulators_received[LINK::to_index] = true;
+
+                //logging data, the link is logged as an IC between the two atomic models
+                if constexpr (cadmium::logger::logs_source<LOGGER, cadmium::logger::logger_message_routing>::value) {
+                    using from_model=typename std::decay_t<decltype(from_engine)>::model_type;
+                    using to_model=typename std::decay_t<decltype(to_engine)>::model_type;
+                    std::ostringstream oss;
+                    logger::implode(oss, from_messages);
+                    std::string from_messages_str = oss.str();
+                    oss.clear();
+                    oss.str("");
+                    logger::implode(oss, to_messages);
+                    std::string to_messages_str = oss.str();
+
+                    LOGGER::template log<
+                            cadmium::logger::logger_message_routing,
+                            cadmium::logger::coor_routing_collect_ic
+                    >(from_messages_str, to_messages_str,
+                      boost::typeindex::type_id<typename LINK::from_port>().pretty_name(),
+                      boost::typeindex::type_id<from_model>().pretty_name(),
+                      boost::typeindex::type_id<typename LINK::to_port>().pretty_name(),
+                      boost::typeindex::type_id<to_model>().pretty_name());
+                }
+            }
+        };
+    }
+}
+
+#endif // CADMIUM_PDEVS_FLAT_RUNNER_HPP
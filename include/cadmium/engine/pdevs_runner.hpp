@@ -28,6 +28,7 @@
 #define CADMIUM_PDEVS_RUNNER_HPP
 #include <iostream>
 #include <cadmium/engine/pdevs_coordinator.hpp>
+#include <cadmium/modeling/message_arena.hpp>
 #include <cadmium/concept/atomic_model_assert.hpp>
 #include <cadmium/logger/logger.hpp>
 #include <cadmium/logger/common_loggers.hpp>
@@ -44,6 +45,7 @@ namespace cadmium {
          * @param Model The model to be simulated
          * @param Time Representation of time to be used to run the simualtion
          * @param Logger what, where and how to log from the simulation
+         * @param Execution the policy used by the coordinators to run the submodels outputs and transitions, see pdevs_execution.hpp
          */
 
         //by default state changes get verbatim formatted and logged to cout
@@ -51,12 +53,12 @@ namespace cadmium {
         using default_logger=cadmium::logger::logger<cadmium::logger::logger_state, cadmium::logger::formatter<TIME>, cadmium::logger::cout_sink_provider>;
 
         //TODO: migrate specialization FEL behavior from CDBoost. At this point, there is no parametrized FEL.
-        template <class TIME, template<class> class MODEL, typename LOGGER=default_logger<TIME>>
+        template <class TIME, template<class> class MODEL, typename LOGGER=default_logger<TIME>, typename EXECUTION=sequential_execution>
         class runner{
             TIME _next; //next scheduled event
 
             //TODO: handle the case that the model received is an atomic model.
-            cadmium::engine::coordinator<MODEL, TIME, LOGGER> top_coordinator; //this only works for coupled models.
+            cadmium::engine::coordinator<MODEL, TIME, LOGGER, EXECUTION> top_coordinator; //this only works for coupled models.
 
         public:
             //contructors
@@ -64,10 +66,18 @@ namespace cadmium {
              * @brief set the dynamic parameters for the simulation
              * @param init_time is the initial time of the simulation.
              */
-            explicit runner(const TIME& init_time){
+            explicit runner(const TIME& init_time)
+            : runner(init_time, EXECUTION()) {}
+
+            /**
+             * @brief set the dynamic parameters for the simulation
+             * @param init_time is the initial time of the simulation.
+             * @param execution is the policy shared by all the coordinators.
+             */
+            runner(const TIME& init_time, const EXECUTION& execution){
                 LOGGER::template log<cadmium::logger::logger_global_time, cadmium::logger::run_global_time>(init_time);
                 LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Preparing model");
-                top_coordinator.init(init_time);
+                top_coordinator.init(init_time, execution);
                 _next = top_coordinator.next();
             }
 
@@ -82,6 +92,8 @@ namespace cadmium {
                     LOGGER::template log<cadmium::logger::logger_global_time, cadmium::logger::run_global_time>(_next);
                     top_coordinator.collect_outputs(_next);
                     top_coordinator.advance_simulation(_next);
+                    // all the messages of the step were consumed
+                    cadmium::message_arena::instance().release();
                     _next = top_coordinator.next();
                 }
                 LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::run_info>("Finished run");
@@ -77,15 +77,10 @@ namespace cadmium {
              */
             void init(TIME initial_time) {
 
-                //logging data
-                std::ostringstream oss;
-                oss << _model.state;
-                std::string model_state = oss.str();
-
-                oss.clear();
-                oss.str("");
-                oss << boost::typeindex::type_id<model_type>().pretty_name();
-                _model_id = oss.str();
+                //logging data, the id is only built when something is logged
+                if constexpr (cadmium::logger::logs_any_source<LOGGER>::value) {
+                    _model_id = boost::typeindex::type_id<model_type>().pretty_name();
+                }
 
                 LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::sim_info_init>(initial_time, _model_id);
 
@@ -93,7 +88,7 @@ namespace cadmium {
                 cadmium::concept::atomic_model_assert<MODEL>();
                 _next = initial_time + _model.time_advance();
 
-                LOGGER::template log<cadmium::logger::logger_state, cadmium::logger::sim_state>(model_state, _model_id);
+                log_state();
             }
 
 
@@ -106,7 +101,7 @@ namespace cadmium {
                 LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::sim_info_collect>(t, _model_id);
 
                 //cleanning the inbox and producing outbox
-                _inbox = in_bags_type{};
+                cadmium::engine::clear_bags(_inbox);
 
                 
                 if (_next < t){
@@ -114,18 +109,24 @@ namespace cadmium {
                 } else if (_next == t) {
                     _outbox = _model.output();
                 } else {
-                    _outbox = out_bags_type();
+                    cadmium::engine::clear_bags(_outbox);
                 }
                 //logging data
-                std::ostringstream oss;
-                cadmium::logger::print_messages_by_port(oss, _outbox);
-                LOGGER::template log<cadmium::logger::logger_messages, cadmium::logger::sim_messages_collect>(oss.str(), _model_id);
+                if constexpr (cadmium::logger::logs_source<LOGGER, cadmium::logger::logger_messages>::value) {
+                    std::ostringstream oss;
+                    cadmium::logger::print_messages_by_port(oss, _outbox);
+                    LOGGER::template log<cadmium::logger::logger_messages, cadmium::logger::sim_messages_collect>(oss.str(), _model_id);
+                }
             }
 
             /**
              * @brief outbox keeps the output generated by the last call to collect_outputs
              */
-            out_bags_type outbox() const noexcept{
+            out_bags_type& outbox() noexcept{
+                return _outbox;
+            }
+
+            const out_bags_type& outbox() const noexcept{
                 return _outbox;
             }
 
@@ -134,7 +135,14 @@ namespace cadmium {
              * @brief inbox keeps the input introduced by upper level coordinator for running next advance_simulation
              */
             void inbox(in_bags_type in) noexcept{
-                _inbox=in;
+                _inbox=std::move(in);
+            }
+
+            /**
+             * @brief allows the upper level coordinator to route messages in place
+             */
+            in_bags_type& inbox() noexcept{
+                return _inbox;
             }
 
             /**
@@ -143,7 +151,7 @@ namespace cadmium {
             */
             void advance_simulation(TIME t) {
                 //clean outbox because messages are routed before calling this funtion at a higher level
-                _outbox = out_bags_type{};
+                cadmium::engine::clear_bags(_outbox);
 
                 LOGGER::template log<cadmium::logger::logger_info, cadmium::logger::sim_info_advance>(_last, t, _model_id);
                 LOGGER::template log<cadmium::logger::logger_local_time, cadmium::logger::sim_local_time>(_last, t, _model_id);
@@ -162,7 +170,7 @@ namespace cadmium {
                         _last = t;
                         _next = _last + _model.time_advance();
                         //clean inbox because they were processed already
-                        _inbox = in_bags_type{};
+                        cadmium::engine::clear_bags(_inbox);
                     } else { //no input available
                         if (t != _next) {
                             //throw std::domain_error("Trying to execute internal transition at wrong time");
@@ -177,10 +185,17 @@ namespace cadmium {
                     }
                 }
 
-                //logging data
-                std::ostringstream oss;
-                oss << _model.state;
-                LOGGER::template log<cadmium::logger::logger_state, cadmium::logger::sim_state>(oss.str(), _model_id);
+                log_state();
+            }
+
+        private:
+            // the state is only printed if the LOGGER logs it
+            void log_state() const {
+                if constexpr (cadmium::logger::logs_source<LOGGER, cadmium::logger::logger_state>::value) {
+                    std::ostringstream oss;
+                    oss << _model.state;
+                    LOGGER::template log<cadmium::logger::logger_state, cadmium::logger::sim_state>(oss.str(), _model_id);
+                }
             }
     //TODO: use enable_if functions to give access to read state and messages in debug mode
         };
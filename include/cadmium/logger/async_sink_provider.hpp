@@ -0,0 +1,294 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_ASYNC_SINK_PROVIDER_HPP
+#define CADMIUM_ASYNC_SINK_PROVIDER_HPP
+
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <streambuf>
+
+namespace cadmium {
+    namespace logger {
+
+        /**
+         * @brief A bounded single producer single consumer ring buffer without locks.
+         *
+         * @tparam T - The element type, they are moved in and out of the ring.
+         */
+        template<typename T>
+        class spsc_ring {
+            std::vector<T> _slots;
+            std::size_t _mask;
+            std::atomic<std::size_t> _head{0}; // next slot to pop, written by the consumer
+            std::atomic<std::size_t> _tail{0}; // next slot to push, written by the producer
+
+        public:
+            /**
+             * @param capacity - The number of elements in the ring, rounded up to a power of two.
+             */
+            explicit spsc_ring(std::size_t capacity) {
+                std::size_t size = 1;
+                while (size < capacity) {
+                    size <<= 1;
+                }
+                _slots.resize(size);
+                _mask = size - 1;
+            }
+
+            std::size_t capacity() const noexcept {
+                return _slots.size();
+            }
+
+            /**
+             * @brief Called by the producer, moves value in the ring.
+             * @return false if the ring is full, value is not moved.
+             */
+            bool try_push(T& value) {
+                std::size_t tail = _tail.load(std::memory_order_relaxed);
+                if (tail - _head.load(std::memory_order_acquire) == _slots.size()) {
+                    return false;
+                }
+                _slots[tail & _mask] = std::move(value);
+                _tail.store(tail + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * @brief Called by the consumer, moves the oldest element to value.
+             * @return false if the ring is empty.
+             */
+            bool try_pop(T& value) {
+                std::size_t head = _head.load(std::memory_order_relaxed);
+                if (head == _tail.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                value = std::move(_slots[head & _mask]);
+                _head.store(head + 1, std::memory_order_release);
+                return true;
+            }
+
+            bool empty() const noexcept {
+                return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+            }
+        };
+
+        /**
+         * @brief A sink provider writing the log records in the sink of SINK_PROVIDER from a background thread,
+         * the logging threads only push the records in a ring buffer of their own.
+         *
+         * Each record is the text written in the sink between two flushes, a line for the loggers using
+         * std::endl. The records are stamped when pushed and the background thread writes them in stamp order,
+         * merging the records of all the threads, also the ones of the parallel executions. A thread waits for
+         * the background thread only when its ring is full.
+         *
+         * @note SINK_PROVIDER::sink() is only used by the background thread.
+         */
+        template<typename SINK_PROVIDER, std::size_t CAPACITY = 4096>
+        class async_sink_provider {
+            struct record {
+                std::uint64_t stamp = 0;
+                std::string text;
+            };
+
+            // the ring of a logging thread, in_flight is a lower bound of the stamp being pushed
+            struct thread_buffer {
+                spsc_ring<record> ring{CAPACITY};
+                std::atomic<std::uint64_t> in_flight{std::numeric_limits<std::uint64_t>::max()};
+            };
+
+            class drainer {
+                std::ostream& _sink;
+                std::atomic<std::uint64_t> _stamps{0};
+                std::atomic<std::uint64_t> _written{0}; // all the records with lower stamps are written
+                std::mutex _buffers_mutex;
+                std::vector<std::shared_ptr<thread_buffer>> _buffers;
+                std::vector<record> _pending; // popped records waiting for lower stamps
+                std::atomic<bool> _stop{false};
+                std::thread _thread;
+
+                // writes the records with a stamp below all the stamps that can still be pushed
+                bool drain(bool all) {
+                    std::uint64_t bound = all ? std::numeric_limits<std::uint64_t>::max() : _stamps.load();
+                    std::vector<std::shared_ptr<thread_buffer>> buffers;
+                    {
+                        std::lock_guard<std::mutex> lock(_buffers_mutex);
+                        // the buffers of finished threads are dropped once empty
+                        _buffers.erase(std::remove_if(_buffers.begin(), _buffers.end(), [](const auto& b) {
+                            return b.use_count() == 1 && b->ring.empty();
+                        }), _buffers.end());
+                        buffers = _buffers;
+                    }
+                    if (!all) {
+                        for (const auto& b : buffers) {
+                            bound = std::min(bound, b->in_flight.load());
+                        }
+                    }
+
+                    record r;
+                    for (const auto& b : buffers) {
+                        while (b->ring.try_pop(r)) {
+                            _pending.push_back(std::move(r));
+                        }
+                    }
+                    std::sort(_pending.begin(), _pending.end(), [](const record& a, const record& b) { return a.stamp < b.stamp; });
+                    auto last = std::find_if(_pending.begin(), _pending.end(), [bound](const record& p) { return p.stamp >= bound; });
+                    for (auto it = _pending.begin(); it != last; ++it) {
+                        _sink.write(it->text.data(), static_cast<std::streamsize>(it->text.size()));
+                    }
+                    bool wrote = last != _pending.begin();
+                    _pending.erase(_pending.begin(), last);
+                    if (wrote) {
+                        _sink.flush();
+                    }
+                    if (!all && bound > _written.load()) {
+                        _written.store(bound);
+                    }
+                    return wrote;
+                }
+
+                void run() {
+                    while (!_stop.load()) {
+                        if (!drain(false)) {
+                            std::this_thread::sleep_for(std::chrono::microseconds(200));
+                        }
+                    }
+                }
+
+            public:
+                drainer()
+                : _sink(SINK_PROVIDER::sink()), _thread([this]() { run(); }) {}
+
+                ~drainer() {
+                    _stop.store(true);
+                    _thread.join();
+                    drain(true);
+                }
+
+                std::shared_ptr<thread_buffer> register_thread() {
+                    auto ret = std::make_shared<thread_buffer>();
+                    std::lock_guard<std::mutex> lock(_buffers_mutex);
+                    _buffers.push_back(ret);
+                    return ret;
+                }
+
+                void push(thread_buffer& buffer, std::string&& text) {
+                    record r;
+                    r.text = std::move(text);
+                    buffer.in_flight.store(_stamps.load());
+                    r.stamp = _stamps.fetch_add(1);
+                    while (!buffer.ring.try_push(r)) {
+                        std::this_thread::yield();
+                    }
+                    buffer.in_flight.store(std::numeric_limits<std::uint64_t>::max());
+                }
+
+                void wait_written(std::uint64_t stamp) {
+                    while (_written.load() < stamp) {
+                        std::this_thread::yield();
+                    }
+                }
+
+                std::uint64_t stamps() const {
+                    return _stamps.load();
+                }
+            };
+
+            static drainer& the_drainer() {
+                static drainer d;
+                return d;
+            }
+
+            // the stream buffer of a logging thread, it pushes a record at every flush
+            class record_streambuf : public std::streambuf {
+                std::shared_ptr<thread_buffer> _buffer;
+                std::string _text;
+
+            protected:
+                int_type overflow(int_type c) override {
+                    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                        _text.push_back(traits_type::to_char_type(c));
+                    }
+                    return traits_type::not_eof(c);
+                }
+
+                std::streamsize xsputn(const char* s, std::streamsize n) override {
+                    _text.append(s, static_cast<std::size_t>(n));
+                    return n;
+                }
+
+                int sync() override {
+                    if (!_text.empty()) {
+                        the_drainer().push(*_buffer, std::move(_text));
+                        _text.clear();
+                    }
+                    return 0;
+                }
+
+            public:
+                record_streambuf()
+                : _buffer(the_drainer().register_thread()) {}
+
+                ~record_streambuf() override {
+                    sync();
+                }
+            };
+
+            struct thread_stream {
+                record_streambuf buf;
+                std::ostream os{&buf};
+            };
+
+        public:
+            static std::ostream& sink() {
+                thread_local thread_stream stream;
+                return stream.os;
+            }
+
+            /**
+             * @brief Waits until the records flushed by all the threads before the call are written in the sink
+             * of SINK_PROVIDER.
+             */
+            static void flush() {
+                sink().flush();
+                the_drainer().wait_written(the_drainer().stamps());
+            }
+        };
+    }
+}
+
+#endif // CADMIUM_ASYNC_SINK_PROVIDER_HPP
@@ -0,0 +1,454 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_BINARY_LOGGER_HPP
+#define CADMIUM_BINARY_LOGGER_HPP
+
+#include <tuple>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+
+#include <cadmium/logger/logger.hpp>
+
+namespace cadmium {
+    namespace logger {
+
+        /**
+         * The binary trace format, written by the binary_logger and converted back to text by
+         * convert_binary_trace.
+         *
+         * The trace starts with the magic "CDMT", the format version and the size of TIME as 32 bits integers.
+         * Then a sequence of records, each one starts with a fixed size header:
+         * - kind: 8 bits, trace_event or trace_name.
+         * - event: 8 bits, the index of the event in logger_events.
+         * - parameters: 16 bits, the number of parameters of the event.
+         * - size: 32 bits, the number of bytes after the header.
+         *
+         * A trace_name record defines a name, a 32 bits id followed by the name bytes. The names are the
+         * model ids and port names, they are defined once before the first event using them.
+         * A trace_event record has the parameters of the event, each one a 8 bits tag followed by:
+         * - param_time: the raw TIME bytes.
+         * - param_name: the 32 bits id of a name.
+         * - param_text: a 32 bits length followed by the bytes.
+         * - param_texts: a 32 bits count followed by texts as param_text.
+         *
+         * The integers are written in the byte order of the machine, the trace is read in the same architecture.
+         */
+        namespace binary_trace {
+            constexpr char magic[4] = {'C', 'D', 'M', 'T'};
+            constexpr std::uint32_t version = 1;
+
+            enum record_kind : std::uint8_t { trace_event = 0, trace_name = 1 };
+            enum param_tag : std::uint8_t { param_time = 0, param_name = 1, param_text = 2, param_texts = 3 };
+
+            struct record_header {
+                std::uint8_t kind;
+                std::uint8_t event;
+                std::uint16_t parameters;
+                std::uint32_t size;
+            };
+            static_assert(sizeof(record_header) == 8, "The record header has no padding");
+
+            template<typename INT>
+            void write_int(std::string& buffer, INT value) {
+                buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+            }
+
+            inline void write_text(std::string& buffer, const std::string& text) {
+                write_int<std::uint32_t>(buffer, static_cast<std::uint32_t>(text.size()));
+                buffer.append(text);
+            }
+
+            template<typename INT>
+            INT read_int(const char*& data, const char* end) {
+                INT ret;
+                if (end - data < static_cast<std::ptrdiff_t>(sizeof(ret))) {
+                    throw std::domain_error("Truncated binary trace");
+                }
+                std::memcpy(&ret, data, sizeof(ret));
+                data += sizeof(ret);
+                return ret;
+            }
+
+            inline std::string read_text(const char*& data, const char* end) {
+                std::uint32_t size = read_int<std::uint32_t>(data, end);
+                if (static_cast<std::uint32_t>(end - data) < size) {
+                    throw std::domain_error("Truncated binary trace");
+                }
+                std::string ret(data, size);
+                data += size;
+                return ret;
+            }
+
+            template<typename EVENT, typename EVENTS = logger_events>
+            struct event_id;
+
+            template<typename EVENT, typename... ES>
+            struct event_id<EVENT, std::tuple<EVENT, ES...>> : std::integral_constant<std::uint8_t, 0> {};
+
+            template<typename EVENT, typename E, typename... ES>
+            struct event_id<EVENT, std::tuple<E, ES...>>
+                    : std::integral_constant<std::uint8_t, 1 + event_id<EVENT, std::tuple<ES...>>::value> {};
+        }
+
+        /**
+         * @brief Writes the binary trace of the events logged in a sink. The records are buffered and written in
+         * blocks, the buffer is written when the writer is destroyed or flushed. There is a writer by sink
+         * provider, shared by all the binary loggers using it.
+         *
+         * @note The writer is not thread safe.
+         *
+         * @tparam TIME - The trivially copyable time type, it is written raw.
+         */
+        template<typename TIME>
+        class binary_trace_writer {
+            static_assert(std::is_trivially_copyable<TIME>::value, "The binary traces write TIME raw, it must be trivially copyable");
+
+            std::ostream& _os;
+            std::string _buffer;
+            std::unordered_map<std::string, std::uint32_t> _names;
+
+            void append_header(binary_trace::record_kind kind, std::uint8_t event, std::uint16_t parameters, std::size_t size) {
+                binary_trace::record_header h{kind, event, parameters, static_cast<std::uint32_t>(size)};
+                _buffer.append(reinterpret_cast<const char*>(&h), sizeof(h));
+            }
+
+            void append_string(std::string& params, const std::string& s, bool intern) {
+                auto it = _names.find(s);
+                if (it == _names.end() && intern) {
+                    std::uint32_t id = static_cast<std::uint32_t>(_names.size());
+                    it = _names.emplace(s, id).first;
+                    append_header(binary_trace::trace_name, 0, 0, sizeof(id) + s.size());
+                    binary_trace::write_int(_buffer, id);
+                    _buffer.append(s);
+                }
+                if (it != _names.end()) {
+                    params.push_back(static_cast<char>(binary_trace::param_name));
+                    binary_trace::write_int(params, it->second);
+                } else {
+                    params.push_back(static_cast<char>(binary_trace::param_text));
+                    binary_trace::write_text(params, s);
+                }
+            }
+
+            template<typename P>
+            void append_param(std::string& params, bool intern, const P& p) {
+                if constexpr (std::is_same<P, TIME>::value) {
+                    params.push_back(static_cast<char>(binary_trace::param_time));
+                    params.append(reinterpret_cast<const char*>(&p), sizeof(TIME));
+                } else if constexpr (std::is_convertible<const P&, std::string>::value) {
+                    append_string(params, p, intern);
+                } else if constexpr (std::is_same<P, std::vector<std::string>>::value) {
+                    params.push_back(static_cast<char>(binary_trace::param_texts));
+                    binary_trace::write_int<std::uint32_t>(params, static_cast<std::uint32_t>(p.size()));
+                    for (const auto& s : p) {
+                        binary_trace::write_text(params, s);
+                    }
+                } else {
+                    std::ostringstream oss;
+                    oss << p;
+                    params.push_back(static_cast<char>(binary_trace::param_text));
+                    binary_trace::write_text(params, oss.str());
+                }
+            }
+
+        public:
+            static constexpr std::size_t block_size = 1 << 16;
+
+            explicit binary_trace_writer(std::ostream& os)
+            : _os(os) {
+                _buffer.append(binary_trace::magic, sizeof(binary_trace::magic));
+                binary_trace::write_int(_buffer, binary_trace::version);
+                binary_trace::write_int<std::uint32_t>(_buffer, sizeof(TIME));
+            }
+
+            binary_trace_writer(const binary_trace_writer&) = delete;
+            binary_trace_writer& operator=(const binary_trace_writer&) = delete;
+
+            ~binary_trace_writer() {
+                flush();
+            }
+
+            /**
+             * @return the writer of the sink of SINK_PROVIDER, created on the first use.
+             */
+            template<typename SINK_PROVIDER>
+            static binary_trace_writer& of() {
+                static binary_trace_writer writer(SINK_PROVIDER::sink());
+                return writer;
+            }
+
+            /**
+             * @brief Writes the record of the event with id event, the new strings of the parameters are interned
+             * as names if intern is true.
+             */
+            template<typename... PARAMs>
+            void write_event(std::uint8_t event, bool intern, const PARAMs&... ps) {
+                std::string params;
+                (append_param(params, intern, ps), ...);
+                append_header(binary_trace::trace_event, event, sizeof...(PARAMs), params.size());
+                _buffer.append(params);
+                if (_buffer.size() >= block_size) {
+                    flush();
+                }
+            }
+
+            void flush() {
+                _os.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+                _os.flush();
+                _buffer.clear();
+            }
+        };
+
+        /**
+         * @brief A logger writing the events of LOGGER_SOURCE as a binary trace in the sink, a binary stream.
+         * The TIME parameters are written raw and the model ids and port names are interned, no text is
+         * formatted, the trace is converted to the text of a formatter by convert_binary_trace.
+         */
+        template<typename LOGGER_SOURCE, typename TIME, typename SINK_PROVIDER>
+        struct binary_logger {
+            template<typename DECLARED_SOURCE>
+            static constexpr bool enabled = std::is_same<LOGGER_SOURCE, DECLARED_SOURCE>::value;
+
+            template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
+            static void log(const PARAMs&... ps) {
+                if constexpr (enabled<DECLARED_SOURCE> && event_format<EVENT>::defined) {
+                    binary_trace_writer<TIME>::template of<SINK_PROVIDER>().write_event(
+                            binary_trace::event_id<EVENT>::value, event_format<EVENT>::interns_names, ps...);
+                }
+            }
+
+            /**
+             * @brief Writes the buffered records in the sink.
+             */
+            static void flush() {
+                binary_trace_writer<TIME>::template of<SINK_PROVIDER>().flush();
+            }
+        };
+
+        namespace binary_trace {
+
+            template<typename TIME>
+            struct param {
+                param_tag tag;
+                TIME time;
+                std::string text;
+                std::vector<std::string> texts;
+            };
+
+            template<typename F>
+            struct function_params;
+
+            template<typename R, typename... ARGS>
+            struct function_params<R(*)(ARGS...)> {
+                using type = std::tuple<std::decay_t<ARGS>...>;
+            };
+
+            template<typename TIME, typename T>
+            T param_as(const param<TIME>& p) {
+                if constexpr (std::is_same<T, TIME>::value) {
+                    if (p.tag == param_time) {
+                        return p.time;
+                    }
+                } else if constexpr (std::is_same<T, std::string>::value) {
+                    if (p.tag == param_name || p.tag == param_text) {
+                        return p.text;
+                    }
+                } else if constexpr (std::is_same<T, std::vector<std::string>>::value) {
+                    if (p.tag == param_texts) {
+                        return p.texts;
+                    }
+                }
+                throw std::domain_error("The binary trace parameters do not match the formatter");
+            }
+
+            template<typename FORMATTER, typename EVENT, typename = void>
+            struct has_format : std::false_type {};
+
+            template<typename FORMATTER, typename EVENT>
+            struct has_format<FORMATTER, EVENT, std::void_t<decltype(event_format<EVENT>::template function<FORMATTER>())>> : std::true_type {};
+
+            template<typename TIME, typename FORMATTER, typename EVENT, std::size_t... Is>
+            void format_event(std::ostream& os, const std::vector<param<TIME>>& ps, std::index_sequence<Is...>) {
+                using params_type = typename function_params<decltype(event_format<EVENT>::template function<FORMATTER>())>::type;
+                if (ps.size() != sizeof...(Is)) {
+                    throw std::domain_error("The binary trace parameters do not match the formatter");
+                }
+                os << event_format<EVENT>::template format<FORMATTER>(param_as<TIME, std::tuple_element_t<Is, params_type>>(ps[Is])...);
+                os << '\n';
+            }
+
+            template<typename TIME, typename FORMATTER, std::size_t I = 0>
+            void format_event(std::ostream& os, std::uint8_t event, const std::vector<param<TIME>>& ps) {
+                if constexpr (I == std::tuple_size<logger_events>::value) {
+                    throw std::domain_error("Unknown event in the binary trace");
+                } else if (event != I) {
+                    format_event<TIME, FORMATTER, I + 1>(os, event, ps);
+                } else {
+                    using event_type = std::tuple_element_t<I, logger_events>;
+                    if constexpr (has_format<FORMATTER, event_type>::value) {
+                        using params_type = typename function_params<decltype(event_format<event_type>::template function<FORMATTER>())>::type;
+                        format_event<TIME, FORMATTER, event_type>(os, ps, std::make_index_sequence<std::tuple_size<params_type>::value>());
+                    } else {
+                        throw std::domain_error("The formatter has no function for an event of the binary trace");
+                    }
+                }
+            }
+
+            /**
+             * @brief Reads the trace header at the start of is.
+             * @throw std::domain_error if is is not a binary trace of TIME.
+             */
+            template<typename TIME>
+            void read_trace_header(std::istream& is) {
+                char header[sizeof(magic) + 2 * sizeof(std::uint32_t)];
+                if (!is.read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(magic)) != 0) {
+                    throw std::domain_error("The stream is not a binary trace");
+                }
+                const char* h = header + sizeof(magic);
+                const char* h_end = header + sizeof(header);
+                if (read_int<std::uint32_t>(h, h_end) != version) {
+                    throw std::domain_error("Unsupported binary trace version");
+                }
+                if (read_int<std::uint32_t>(h, h_end) != sizeof(TIME)) {
+                    throw std::domain_error("The binary trace was written with another TIME");
+                }
+            }
+
+            /**
+             * @brief Reads the next record of is in rh and record.
+             * @return false at the end of the trace.
+             * @throw std::domain_error if the record is truncated.
+             */
+            inline bool read_record(std::istream& is, record_header& rh, std::string& record) {
+                if (!is.read(reinterpret_cast<char*>(&rh), sizeof(rh))) {
+                    if (!is.eof() || is.gcount() != 0) {
+                        throw std::domain_error("Truncated binary trace");
+                    }
+                    return false;
+                }
+                record.resize(rh.size);
+                if (!is.read(&record[0], static_cast<std::streamsize>(rh.size))) {
+                    throw std::domain_error("Truncated binary trace");
+                }
+                return true;
+            }
+
+            /**
+             * @brief Adds the name defined by a trace_name record to names.
+             */
+            inline void read_name(const std::string& record, std::vector<std::string>& names) {
+                const char* data = record.data();
+                const char* end = data + record.size();
+                std::uint32_t id = read_int<std::uint32_t>(data, end);
+                if (id != names.size()) {
+                    throw std::domain_error("Unordered names in the binary trace");
+                }
+                names.emplace_back(data, end);
+            }
+
+            /**
+             * @brief Reads the parameters of a trace_event record, the names are the ones defined before it.
+             */
+            template<typename TIME>
+            void read_params(const record_header& rh, const std::string& record, const std::vector<std::string>& names, std::vector<param<TIME>>& params) {
+                const char* data = record.data();
+                const char* end = data + record.size();
+                params.resize(rh.parameters);
+                for (auto& p : params) {
+                    p.tag = static_cast<param_tag>(read_int<std::uint8_t>(data, end));
+                    switch (p.tag) {
+                        case param_time:
+                            if (end - data < static_cast<std::ptrdiff_t>(sizeof(TIME))) {
+                                throw std::domain_error("Truncated binary trace");
+                            }
+                            std::memcpy(static_cast<void*>(&p.time), data, sizeof(TIME));
+                            data += sizeof(TIME);
+                            break;
+                        case param_name: {
+                            std::uint32_t id = read_int<std::uint32_t>(data, end);
+                            if (id >= names.size()) {
+                                throw std::domain_error("Undefined name in the binary trace");
+                            }
+                            p.text = names[id];
+                            break;
+                        }
+                        case param_text:
+                            p.text = read_text(data, end);
+                            break;
+                        case param_texts: {
+                            std::uint32_t count = read_int<std::uint32_t>(data, end);
+                            p.texts.clear();
+                            for (std::uint32_t i = 0; i < count; i++) {
+                                p.texts.push_back(read_text(data, end));
+                            }
+                            break;
+                        }
+                        default:
+                            throw std::domain_error("Unknown parameter in the binary trace");
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Converts a binary trace written by the binary_logger to the text each event would have been
+         * logged by a logger using FORMATTER, one line by event.
+         *
+         * @throw std::domain_error if the trace is not a binary trace of TIME, is truncated or has events
+         * FORMATTER cannot format.
+         */
+        template<typename TIME, typename FORMATTER>
+        void convert_binary_trace(std::istream& is, std::ostream& os) {
+            binary_trace::read_trace_header<TIME>(is);
+
+            std::vector<std::string> names;
+            std::vector<binary_trace::param<TIME>> params;
+            std::string record;
+            binary_trace::record_header rh;
+            while (binary_trace::read_record(is, rh, record)) {
+                if (rh.kind == binary_trace::trace_name) {
+                    binary_trace::read_name(record, names);
+                    continue;
+                }
+                binary_trace::read_params<TIME>(rh, record, names, params);
+                binary_trace::format_event<TIME, FORMATTER>(os, rh.event, params);
+            }
+        }
+    }
+}
+
+#endif // CADMIUM_BINARY_LOGGER_HPP
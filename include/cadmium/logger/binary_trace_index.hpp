@@ -0,0 +1,387 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_BINARY_TRACE_INDEX_HPP
+#define CADMIUM_BINARY_TRACE_INDEX_HPP
+
+#include <tuple>
+#include <string>
+#include <vector>
+#include <limits>
+#include <sstream>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <cadmium/logger/binary_logger.hpp>
+
+namespace cadmium {
+    namespace logger {
+
+        namespace binary_trace {
+            constexpr char index_magic[4] = {'C', 'D', 'M', 'I'};
+            constexpr std::uint32_t index_version = 1;
+
+            enum index_kind : std::uint8_t { index_model = 0, index_port = 1 };
+
+            /**
+             * @return the size of the TIME of the binary trace at the start of is, is is left after the header.
+             * @throw std::domain_error if is is not a binary trace.
+             */
+            inline std::uint32_t read_time_size(std::istream& is) {
+                char header[sizeof(magic) + 2 * sizeof(std::uint32_t)];
+                if (!is.read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(magic)) != 0) {
+                    throw std::domain_error("The stream is not a binary trace");
+                }
+                const char* h = header + sizeof(magic) + sizeof(std::uint32_t);
+                return read_int<std::uint32_t>(h, header + sizeof(header));
+            }
+        }
+
+        /**
+         * @brief The index of the event records of a binary trace by model id and simulated time, and by port.
+         *
+         * The event records starting with a time are indexed by their first string, the model id, and their
+         * first time. The other ones, the routing records, are indexed by each of their names, the ports, and
+         * the last time before them.
+         *
+         * The index keeps the names of the trace, the records are decoded after seeking to them without reading
+         * the records before. It is stored in a sidecar file, next to the trace, by load_or_build.
+         *
+         * @tparam TIME - The time type of the trace, it must be less than comparable.
+         */
+        template<typename TIME>
+        class binary_trace_index {
+        public:
+            struct entry {
+                binary_trace::index_kind kind;
+                std::uint8_t event;
+                std::uint32_t key;
+                TIME time;
+                std::uint64_t offset;
+            };
+
+        private:
+            std::uint64_t _trace_size = 0;
+            std::vector<std::string> _names;
+            std::vector<std::string> _keys;
+            std::unordered_map<std::string, std::uint32_t> _key_ids;
+            std::vector<entry> _entries; // sorted by kind, key, time and offset
+
+            std::uint32_t key_id(const std::string& key) {
+                auto it = _key_ids.find(key);
+                if (it == _key_ids.end()) {
+                    it = _key_ids.emplace(key, static_cast<std::uint32_t>(_keys.size())).first;
+                    _keys.push_back(key);
+                }
+                return it->second;
+            }
+
+            void sort() {
+                std::sort(_entries.begin(), _entries.end(), [](const entry& a, const entry& b) {
+                    if (a.kind != b.kind) return a.kind < b.kind;
+                    if (a.key != b.key) return a.key < b.key;
+                    if (a.time < b.time) return true;
+                    if (b.time < a.time) return false;
+                    return a.offset < b.offset;
+                });
+            }
+
+            std::vector<entry> range(binary_trace::index_kind kind, const std::string& key, const TIME* from, const TIME* to) const {
+                std::vector<entry> ret;
+                auto k = _key_ids.find(key);
+                if (k == _key_ids.end()) {
+                    return ret;
+                }
+                auto it = std::lower_bound(_entries.begin(), _entries.end(), std::make_tuple(kind, k->second), [from](const entry& e, const std::tuple<binary_trace::index_kind, std::uint32_t>& v) {
+                    if (e.kind != std::get<0>(v)) return e.kind < std::get<0>(v);
+                    if (e.key != std::get<1>(v)) return e.key < std::get<1>(v);
+                    return from != nullptr && e.time < *from;
+                });
+                for (; it != _entries.end() && it->kind == kind && it->key == k->second; ++it) {
+                    if (to != nullptr && *to < it->time) {
+                        break;
+                    }
+                    ret.push_back(*it);
+                }
+                return ret;
+            }
+
+            static void write_texts(std::string& buffer, const std::vector<std::string>& texts) {
+                binary_trace::write_int<std::uint32_t>(buffer, static_cast<std::uint32_t>(texts.size()));
+                for (const auto& t : texts) {
+                    binary_trace::write_text(buffer, t);
+                }
+            }
+
+            static std::vector<std::string> read_texts(const char*& data, const char* end) {
+                std::uint32_t count = binary_trace::read_int<std::uint32_t>(data, end);
+                std::vector<std::string> ret;
+                for (std::uint32_t i = 0; i < count; i++) {
+                    ret.push_back(binary_trace::read_text(data, end));
+                }
+                return ret;
+            }
+
+        public:
+            /**
+             * @brief Indexes a binary trace of TIME, reading it from its start.
+             * @throw std::domain_error if the trace is not a binary trace of TIME or is truncated.
+             */
+            static binary_trace_index build(std::istream& trace) {
+                binary_trace_index ret;
+                binary_trace::read_trace_header<TIME>(trace);
+
+                std::vector<binary_trace::param<TIME>> params;
+                std::string record;
+                binary_trace::record_header rh;
+                TIME last_time{};
+                std::uint64_t offset = static_cast<std::uint64_t>(trace.tellg());
+                while (binary_trace::read_record(trace, rh, record)) {
+                    std::uint64_t record_offset = offset;
+                    offset += sizeof(rh) + rh.size;
+                    if (rh.kind == binary_trace::trace_name) {
+                        binary_trace::read_name(record, ret._names);
+                        continue;
+                    }
+                    binary_trace::read_params<TIME>(rh, record, ret._names, params);
+                    if (!params.empty() && params.front().tag == binary_trace::param_time) {
+                        last_time = params.front().time;
+                        for (const auto& p : params) {
+                            if (p.tag == binary_trace::param_name || p.tag == binary_trace::param_text) {
+                                ret._entries.push_back({binary_trace::index_model, rh.event, ret.key_id(p.text), last_time, record_offset});
+                                break;
+                            }
+                        }
+                    } else {
+                        for (const auto& p : params) {
+                            if (p.tag == binary_trace::param_name) {
+                                ret._entries.push_back({binary_trace::index_port, rh.event, ret.key_id(p.text), last_time, record_offset});
+                            }
+                        }
+                    }
+                }
+                ret._trace_size = offset;
+                ret.sort();
+                return ret;
+            }
+
+            /**
+             * @brief Reads an index written by write.
+             * @throw std::domain_error if is is not an index of a binary trace of TIME or is truncated.
+             */
+            static binary_trace_index read(std::istream& is) {
+                std::string buffer((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+                const char* data = buffer.data();
+                const char* end = data + buffer.size();
+                if (buffer.size() < sizeof(binary_trace::index_magic) || std::memcmp(data, binary_trace::index_magic, sizeof(binary_trace::index_magic)) != 0) {
+                    throw std::domain_error("The stream is not a binary trace index");
+                }
+                data += sizeof(binary_trace::index_magic);
+                if (binary_trace::read_int<std::uint32_t>(data, end) != binary_trace::index_version) {
+                    throw std::domain_error("Unsupported binary trace index version");
+                }
+                if (binary_trace::read_int<std::uint32_t>(data, end) != sizeof(TIME)) {
+                    throw std::domain_error("The binary trace index was written with another TIME");
+                }
+
+                binary_trace_index ret;
+                ret._trace_size = binary_trace::read_int<std::uint64_t>(data, end);
+                ret._names = read_texts(data, end);
+                ret._keys = read_texts(data, end);
+                for (std::uint32_t i = 0; i < ret._keys.size(); i++) {
+                    ret._key_ids.emplace(ret._keys[i], i);
+                }
+                std::uint64_t count = binary_trace::read_int<std::uint64_t>(data, end);
+                for (std::uint64_t i = 0; i < count; i++) {
+                    entry e;
+                    e.kind = static_cast<binary_trace::index_kind>(binary_trace::read_int<std::uint8_t>(data, end));
+                    e.event = binary_trace::read_int<std::uint8_t>(data, end);
+                    e.key = binary_trace::read_int<std::uint32_t>(data, end);
+                    if (e.key >= ret._keys.size()) {
+                        throw std::domain_error("Undefined key in the binary trace index");
+                    }
+                    if (end - data < static_cast<std::ptrdiff_t>(sizeof(TIME))) {
+                        throw std::domain_error("Truncated binary trace index");
+                    }
+                    std::memcpy(static_cast<void*>(&e.time), data, sizeof(TIME));
+                    data += sizeof(TIME);
+                    e.offset = binary_trace::read_int<std::uint64_t>(data, end);
+                    ret._entries.push_back(e);
+                }
+                return ret;
+            }
+
+            void write(std::ostream& os) const {
+                std::string buffer(binary_trace::index_magic, sizeof(binary_trace::index_magic));
+                binary_trace::write_int(buffer, binary_trace::index_version);
+                binary_trace::write_int<std::uint32_t>(buffer, sizeof(TIME));
+                binary_trace::write_int(buffer, _trace_size);
+                write_texts(buffer, _names);
+                write_texts(buffer, _keys);
+                binary_trace::write_int<std::uint64_t>(buffer, _entries.size());
+                for (const auto& e : _entries) {
+                    binary_trace::write_int<std::uint8_t>(buffer, e.kind);
+                    binary_trace::write_int(buffer, e.event);
+                    binary_trace::write_int(buffer, e.key);
+                    buffer.append(reinterpret_cast<const char*>(&e.time), sizeof(TIME));
+                    binary_trace::write_int(buffer, e.offset);
+                }
+                os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            }
+
+            /**
+             * @brief Reads the sidecar index of the trace in trace_path, trace_path + ".idx", or builds it and
+             * writes it if there is none or the trace has grown since it was written.
+             */
+            static binary_trace_index load_or_build(const std::string& trace_path) {
+                std::ifstream trace(trace_path, std::ios::binary | std::ios::ate);
+                if (!trace) {
+                    throw std::domain_error("Opening the binary trace " + trace_path);
+                }
+                std::uint64_t trace_size = static_cast<std::uint64_t>(trace.tellg());
+                std::string index_path = trace_path + ".idx";
+                {
+                    std::ifstream is(index_path, std::ios::binary);
+                    if (is) {
+                        binary_trace_index ret = read(is);
+                        if (ret._trace_size == trace_size) {
+                            return ret;
+                        }
+                    }
+                }
+                trace.seekg(0);
+                binary_trace_index ret = build(trace);
+                std::ofstream os(index_path, std::ios::binary | std::ios::trunc);
+                ret.write(os);
+                return ret;
+            }
+
+            /**
+             * @return the entries of the records of model_id with a time in [from, to], ordered by time.
+             */
+            std::vector<entry> model_records(const std::string& model_id, const TIME& from, const TIME& to) const {
+                return range(binary_trace::index_model, model_id, &from, &to);
+            }
+
+            std::vector<entry> model_records(const std::string& model_id) const {
+                return range(binary_trace::index_model, model_id, nullptr, nullptr);
+            }
+
+            /**
+             * @return the entries of the routing records of port, ordered by time.
+             */
+            std::vector<entry> port_records(const std::string& port) const {
+                return range(binary_trace::index_port, port, nullptr, nullptr);
+            }
+
+            const std::vector<std::string>& names() const noexcept {
+                return _names;
+            }
+
+            std::uint64_t trace_size() const noexcept {
+                return _trace_size;
+            }
+
+            std::size_t size() const noexcept {
+                return _entries.size();
+            }
+        };
+
+        /**
+         * @brief Answers the queries of a binary trace with its index, seeking to the records found. The records
+         * are formatted as FORMATTER does, as convert_binary_trace.
+         */
+        template<typename TIME, typename FORMATTER>
+        class binary_trace_reader {
+            std::istream& _trace;
+            binary_trace_index<TIME> _index;
+
+            std::vector<std::string> format(const std::vector<typename binary_trace_index<TIME>::entry>& entries, const std::uint8_t* event) {
+                std::vector<std::string> ret;
+                std::vector<binary_trace::param<TIME>> params;
+                std::string record;
+                binary_trace::record_header rh;
+                for (const auto& e : entries) {
+                    if (event != nullptr && e.event != *event) {
+                        continue;
+                    }
+                    _trace.clear();
+                    _trace.seekg(static_cast<std::streamoff>(e.offset));
+                    if (!binary_trace::read_record(_trace, rh, record) || rh.kind != binary_trace::trace_event) {
+                        throw std::domain_error("The binary trace index does not match the trace");
+                    }
+                    binary_trace::read_params<TIME>(rh, record, _index.names(), params);
+                    std::ostringstream oss;
+                    binary_trace::format_event<TIME, FORMATTER>(oss, rh.event, params);
+                    std::string line = oss.str();
+                    line.pop_back();
+                    ret.push_back(std::move(line));
+                }
+                return ret;
+            }
+
+        public:
+            binary_trace_reader(std::istream& trace, binary_trace_index<TIME> index)
+            : _trace(trace), _index(std::move(index)) {}
+
+            const binary_trace_index<TIME>& index() const noexcept {
+                return _index;
+            }
+
+            /**
+             * @return the states of model_id logged in [from, to], ordered by time.
+             */
+            std::vector<std::string> model_states(const std::string& model_id, const TIME& from, const TIME& to) {
+                std::uint8_t event = binary_trace::event_id<sim_state>::value;
+                return format(_index.model_records(model_id, from, to), &event);
+            }
+
+            /**
+             * @return the events of model_id logged in [from, to], ordered by time.
+             */
+            std::vector<std::string> model_events(const std::string& model_id, const TIME& from, const TIME& to) {
+                return format(_index.model_records(model_id, from, to), nullptr);
+            }
+
+            /**
+             * @return the messages routed from or to port, ordered by time.
+             */
+            std::vector<std::string> port_messages(const std::string& port) {
+                return format(_index.port_records(port), nullptr);
+            }
+        };
+    }
+}
+
+#endif // CADMIUM_BINARY_TRACE_INDEX_HPP
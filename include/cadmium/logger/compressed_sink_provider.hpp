@@ -0,0 +1,273 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_COMPRESSED_SINK_PROVIDER_HPP
+#define CADMIUM_COMPRESSED_SINK_PROVIDER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <algorithm>
+#include <streambuf>
+#include <stdexcept>
+
+#include <zlib.h>
+
+namespace cadmium {
+    namespace logger {
+
+        /**
+         * The compressed log format, a sequence of frames each one decodable without the others.
+         *
+         * A frame starts with the magic "CDZF", the size of the compressed data and the size of the text it
+         * decompresses to as 32 bits integers, followed by the compressed data, a zlib stream.
+         * The integers are written in the byte order of the machine.
+         */
+        namespace compressed_log {
+            constexpr char frame_magic[4] = {'C', 'D', 'Z', 'F'};
+
+            struct frame_header {
+                char magic[4];
+                std::uint32_t compressed_size;
+                std::uint32_t size;
+            };
+            static_assert(sizeof(frame_header) == 12, "The frame header has no padding");
+
+            /**
+             * @brief The position of a frame in the compressed log and of its text in the decompressed log.
+             */
+            struct frame_position {
+                std::uint64_t offset;
+                std::uint64_t text_offset;
+                std::uint32_t compressed_size;
+                std::uint32_t size;
+            };
+
+            /**
+             * @brief Writes the frame of the text in os.
+             * @throw std::domain_error if zlib fails.
+             */
+            inline void write_frame(std::ostream& os, const char* text, std::size_t size, int level) {
+                uLongf compressed_size = compressBound(static_cast<uLong>(size));
+                std::string compressed(compressed_size, '\0');
+                if (compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressed_size, reinterpret_cast<const Bytef*>(text), static_cast<uLong>(size), level) != Z_OK) {
+                    throw std::domain_error("Compressing a log frame");
+                }
+                frame_header h;
+                std::memcpy(h.magic, frame_magic, sizeof(frame_magic));
+                h.compressed_size = static_cast<std::uint32_t>(compressed_size);
+                h.size = static_cast<std::uint32_t>(size);
+                os.write(reinterpret_cast<const char*>(&h), sizeof(h));
+                os.write(compressed.data(), static_cast<std::streamsize>(compressed_size));
+            }
+
+            /**
+             * @brief Reads the header of the frame at the position of is.
+             * @return false at the end of the log.
+             * @throw std::domain_error if is is not at a frame or it is truncated.
+             */
+            inline bool read_frame_header(std::istream& is, frame_header& h) {
+                if (!is.read(reinterpret_cast<char*>(&h), sizeof(h))) {
+                    if (!is.eof() || is.gcount() != 0) {
+                        throw std::domain_error("Truncated compressed log");
+                    }
+                    return false;
+                }
+                if (std::memcmp(h.magic, frame_magic, sizeof(frame_magic)) != 0) {
+                    throw std::domain_error("The stream is not a compressed log frame");
+                }
+                return true;
+            }
+
+            /**
+             * @brief Reads and decompresses the frame at the position of is in text.
+             * @return false at the end of the log.
+             * @throw std::domain_error if the frame is corrupted or truncated.
+             */
+            inline bool read_frame(std::istream& is, std::string& text) {
+                frame_header h;
+                if (!read_frame_header(is, h)) {
+                    return false;
+                }
+                std::string compressed(h.compressed_size, '\0');
+                if (!is.read(&compressed[0], static_cast<std::streamsize>(h.compressed_size))) {
+                    throw std::domain_error("Truncated compressed log");
+                }
+                text.resize(h.size);
+                uLongf size = h.size;
+                if (uncompress(reinterpret_cast<Bytef*>(&text[0]), &size, reinterpret_cast<const Bytef*>(compressed.data()), h.compressed_size) != Z_OK || size != h.size) {
+                    throw std::domain_error("Corrupted compressed log frame");
+                }
+                return true;
+            }
+
+            /**
+             * @brief Finds the frames of the compressed log in is reading only their headers.
+             */
+            inline std::vector<frame_position> index_frames(std::istream& is) {
+                std::vector<frame_position> ret;
+                std::uint64_t offset = 0;
+                std::uint64_t text_offset = 0;
+                is.seekg(0);
+                frame_header h;
+                while (read_frame_header(is, h)) {
+                    ret.push_back({offset, text_offset, h.compressed_size, h.size});
+                    offset += sizeof(h) + h.compressed_size;
+                    text_offset += h.size;
+                    is.seekg(static_cast<std::streamoff>(offset));
+                }
+                return ret;
+            }
+
+            /**
+             * @return the frame having the character at text_offset of the decompressed log, frames.end() if
+             * there is none.
+             */
+            inline std::vector<frame_position>::const_iterator find_frame(const std::vector<frame_position>& frames, std::uint64_t text_offset) {
+                auto it = std::upper_bound(frames.begin(), frames.end(), text_offset, [](std::uint64_t o, const frame_position& f) {
+                    return o < f.text_offset;
+                });
+                if (it == frames.begin()) {
+                    return frames.end();
+                }
+                --it;
+                return text_offset < it->text_offset + it->size ? it : frames.end();
+            }
+
+            /**
+             * @brief Decompresses the whole log in is to os.
+             */
+            inline void decompress(std::istream& is, std::ostream& os) {
+                std::string text;
+                while (read_frame(is, text)) {
+                    os.write(text.data(), static_cast<std::streamsize>(text.size()));
+                }
+            }
+        }
+
+        /**
+         * @brief A stream buffer compressing the text written in frames of frame_size characters, the frames
+         * are written in the target stream when they are full, when finish_frame is called and at destruction.
+         *
+         * The loggers flush the sink after each line, the flushes do not end the frame.
+         */
+        class compressed_streambuf : public std::streambuf {
+            std::ostream& _target;
+            std::vector<char> _frame;
+            int _level;
+
+            void write_frame() {
+                std::size_t size = static_cast<std::size_t>(pptr() - pbase());
+                if (size > 0) {
+                    compressed_log::write_frame(_target, pbase(), size, _level);
+                }
+                setp(_frame.data(), _frame.data() + _frame.size());
+            }
+
+        protected:
+            int_type overflow(int_type c) override {
+                write_frame();
+                if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                    *pptr() = traits_type::to_char_type(c);
+                    pbump(1);
+                }
+                return traits_type::not_eof(c);
+            }
+
+            int sync() override {
+                return 0;
+            }
+
+        public:
+            /**
+             * @param target - The stream the frames are written in.
+             * @param frame_size - The number of characters compressed by frame.
+             * @param level - The zlib compression level.
+             */
+            explicit compressed_streambuf(std::ostream& target, std::size_t frame_size = 1 << 20, int level = Z_DEFAULT_COMPRESSION)
+            : _target(target), _frame(std::max<std::size_t>(frame_size, 1)), _level(level) {
+                setp(_frame.data(), _frame.data() + _frame.size());
+            }
+
+            compressed_streambuf(const compressed_streambuf&) = delete;
+            compressed_streambuf& operator=(const compressed_streambuf&) = delete;
+
+            ~compressed_streambuf() override {
+                finish_frame();
+            }
+
+            /**
+             * @brief Writes the frame of the text written since the last frame and flushes the target.
+             */
+            void finish_frame() {
+                write_frame();
+                _target.flush();
+            }
+        };
+
+        /**
+         * @brief A sink provider compressing the text logged in frames written to the sink of SINK_PROVIDER,
+         * see compressed_streambuf.
+         *
+         * It is not thread safe, the loggers of several threads use it through an async_sink_provider, which
+         * also moves the compression to the drainer thread:
+         * async_sink_provider<compressed_sink_provider<FILE_SINK_PROVIDER>>.
+         *
+         * @tparam FRAME_SIZE - The number of characters compressed by frame.
+         * @tparam LEVEL - The zlib compression level.
+         */
+        template<typename SINK_PROVIDER, std::size_t FRAME_SIZE = (1 << 20), int LEVEL = Z_DEFAULT_COMPRESSION>
+        class compressed_sink_provider {
+            struct compressed_stream {
+                compressed_streambuf buf{SINK_PROVIDER::sink(), FRAME_SIZE, LEVEL};
+                std::ostream os{&buf};
+            };
+
+            static compressed_stream& stream() {
+                static compressed_stream s;
+                return s;
+            }
+
+        public:
+            static std::ostream& sink() {
+                return stream().os;
+            }
+
+            /**
+             * @brief Writes the frame of the text logged since the last frame in the sink of SINK_PROVIDER.
+             */
+            static void flush() {
+                stream().buf.finish_frame();
+            }
+        };
+    }
+}
+
+#endif // CADMIUM_COMPRESSED_SINK_PROVIDER_HPP
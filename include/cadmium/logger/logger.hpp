@@ -29,6 +29,8 @@
 
 #include <sstream>
 #include <iostream>
+#include <tuple>
+#include <type_traits>
 
 /**
   * Logging concepts
@@ -87,6 +89,74 @@ namespace cadmium {
         struct run_info : public cadmium::logger::logger_event{};
 
 
+        /**
+         * @brief How the loggers format an EVENT, FORMATTER has a static function named as the event formatting
+         * its parameters. The events in logger_events are defined, the loggers ignore the others.
+         * The events naming models and ports intern their strings in the binary traces (see binary_logger.hpp).
+         */
+        template<typename EVENT>
+        struct event_format {
+            static constexpr bool defined = false;
+        };
+
+        //all the events logged by the engines, their index identifies them in the binary traces
+        using logger_events = std::tuple<
+                cadmium::logger::coor_info_init,
+                cadmium::logger::coor_info_collect,
+                cadmium::logger::coor_routing_collect,
+                cadmium::logger::coor_routing_collect_ic,
+                cadmium::logger::coor_routing_collect_eic,
+                cadmium::logger::coor_routing_collect_eoc,
+                cadmium::logger::coor_info_advance,
+                cadmium::logger::coor_routing_ic_collect,
+                cadmium::logger::coor_routing_eic_collect,
+                cadmium::logger::coor_routing_eoc_collect,
+                cadmium::logger::sim_info_init,
+                cadmium::logger::sim_state,
+                cadmium::logger::sim_info_collect,
+                cadmium::logger::sim_messages_collect,
+                cadmium::logger::sim_info_advance,
+                cadmium::logger::sim_local_time,
+                cadmium::logger::run_global_time,
+                cadmium::logger::run_info
+        >;
+
+#define CADMIUM_LOGGER_EVENT_FORMAT(EVENT, INTERNS_NAMES) \
+        template<> \
+        struct event_format<cadmium::logger::EVENT> { \
+            static constexpr bool defined = true; \
+            static constexpr bool interns_names = INTERNS_NAMES; \
+            template<typename FORMATTER, typename... PARAMs> \
+            static decltype(auto) format(const PARAMs&... ps) { \
+                return FORMATTER::EVENT(ps...); \
+            } \
+            template<typename FORMATTER> \
+            static constexpr auto function() -> decltype(&FORMATTER::EVENT) { \
+                return &FORMATTER::EVENT; \
+            } \
+        };
+
+        CADMIUM_LOGGER_EVENT_FORMAT(coor_info_init, true)
+        CADMIUM_LOGGER_EVENT_FORMAT(coor_info_collect, true)
+        CADMIUM_LOGGER_EVENT_FORMAT(coor_routing_collect, true)
+        CADMIUM_LOGGER_EVENT_FORMAT(coor_routing_collect_ic, true)
+        CADMIUM_LOGGER_EVENT_FORMAT(coor_routing_collect_eic, true)
+        CADMIUM_LOGGER_EVENT_FORMAT(coor_routing_collect_eoc, true)
+        CADMIUM_LOGGER_EVENT_FORMAT(coor_info_advance, true)
+        CADMIUM_LOGGER_EVENT_FORMAT(coor_routing_ic_collect, true)
+        CADMIUM_LOGGER_EVENT_FORMAT(coor_routing_eic_collect, true)
+        CADMIUM_LOGGER_EVENT_FORMAT(coor_routing_eoc_collect, true)
+        CADMIUM_LOGGER_EVENT_FORMAT(sim_info_init, true)
+        CADMIUM_LOGGER_EVENT_FORMAT(sim_state, false)
+        CADMIUM_LOGGER_EVENT_FORMAT(sim_info_collect, true)
+        CADMIUM_LOGGER_EVENT_FORMAT(sim_messages_collect, false)
+        CADMIUM_LOGGER_EVENT_FORMAT(sim_info_advance, true)
+        CADMIUM_LOGGER_EVENT_FORMAT(sim_local_time, true)
+        CADMIUM_LOGGER_EVENT_FORMAT(run_global_time, true)
+        CADMIUM_LOGGER_EVENT_FORMAT(run_info, false)
+
+#undef CADMIUM_LOGGER_EVENT_FORMAT
+
         //source identifiers
         struct logger_info : public cadmium::logger::logger_source{};
         struct logger_debug : public cadmium::logger::logger_source{};
@@ -97,100 +167,60 @@ namespace cadmium {
 
         struct logger_local_time :  public cadmium::logger::logger_source{};
 
+        /**
+         * @brief Tells at compile time if LOGGER logs the events of the SOURCE, through its enabled member, the
+         * engines skip formatting what is not logged. The loggers without enabled are assumed to log every source.
+         */
+        template<typename LOGGER, typename SOURCE, typename = void>
+        struct logs_source : std::true_type {};
+
+        template<typename LOGGER, typename SOURCE>
+        struct logs_source<LOGGER, SOURCE, std::void_t<decltype(LOGGER::template enabled<SOURCE>)>>
+                : std::integral_constant<bool, LOGGER::template enabled<SOURCE>> {};
+
+        /**
+         * @brief Tells at compile time if LOGGER counts the messages of the models bags, through its static
+         * count_messages(model_id, output, port, messages), the dynamic simulators call it with the size of each
+         * bag of their inbox and outbox instead of formatting the messages.
+         */
+        template<typename LOGGER, typename = void>
+        struct counts_messages : std::false_type {};
+
+        template<typename LOGGER>
+        struct counts_messages<LOGGER, std::void_t<decltype(&LOGGER::count_messages)>> : std::true_type {};
+
+        //all the sources the engines log from
+        using logger_sources = std::tuple<
+                cadmium::logger::logger_info,
+                cadmium::logger::logger_debug,
+                cadmium::logger::logger_state,
+                cadmium::logger::logger_messages,
+                cadmium::logger::logger_message_routing,
+                cadmium::logger::logger_global_time,
+                cadmium::logger::logger_local_time
+        >;
+
+        /**
+         * @brief Tells at compile time if LOGGER logs any source, the engines skip building the model ids
+         * used by the events when it does not.
+         */
+        template<typename LOGGER, typename SOURCES=logger_sources>
+        struct logs_any_source;
+
+        template<typename LOGGER, typename... SOURCES>
+        struct logs_any_source<LOGGER, std::tuple<SOURCES...>>
+                : std::integral_constant<bool, (logs_source<LOGGER, SOURCES>::value || ... || false)> {};
+
         template<typename LOGGER_SOURCE, class FORMATTER, typename SINK_PROVIDER>
         struct logger{
+            template<typename DECLARED_SOURCE>
+            static constexpr bool enabled = std::is_same<LOGGER_SOURCE, DECLARED_SOURCE>::value;
+
             template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
             static void log(const PARAMs&... ps) {
-                if constexpr (std::is_same<LOGGER_SOURCE, DECLARED_SOURCE>::value) {
-                    if constexpr (std::is_same<EVENT, cadmium::logger::coor_info_init>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::coor_info_init(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::coor_info_collect>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::coor_info_collect(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::coor_routing_collect>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::coor_routing_collect(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::coor_routing_collect_ic>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::coor_routing_collect_ic(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::coor_routing_collect_eic>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::coor_routing_collect_eic(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::coor_routing_collect_eoc>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::coor_routing_collect_eoc(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::coor_info_advance>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::coor_info_advance(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::coor_routing_ic_collect>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::coor_routing_ic_collect(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::coor_routing_eic_collect>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::coor_routing_eic_collect(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::coor_routing_eoc_collect>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::coor_routing_eoc_collect(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::sim_info_init>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::sim_info_init(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::sim_state>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::sim_state(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::sim_info_collect>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::sim_info_collect(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::sim_messages_collect>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::sim_messages_collect(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::sim_info_advance>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::sim_info_advance(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::sim_local_time>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::sim_local_time(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::run_global_time>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::run_global_time(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
-
-                    if constexpr (std::is_same<EVENT, cadmium::logger::run_info>::value) {
-                        SINK_PROVIDER::sink() << FORMATTER::run_info(ps...);
-                        SINK_PROVIDER::sink() << std::endl;
-                    }
+                if constexpr (std::is_same<LOGGER_SOURCE, DECLARED_SOURCE>::value && event_format<EVENT>::defined) {
+                    SINK_PROVIDER::sink() << event_format<EVENT>::template format<FORMATTER>(ps...);
+                    SINK_PROVIDER::sink() << std::endl;
                 }
             }
         };
@@ -219,11 +249,42 @@ namespace cadmium {
 
         template<typename... LS>
         struct multilogger{
+            template<typename DECLARED_SOURCE>
+            static constexpr bool enabled = (logs_source<LS, DECLARED_SOURCE>::value || ... || false);
+
             template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
             static void log(const PARAMs&... ps) {
                 multilogger_impl<LS...>::template log<DECLARED_SOURCE, EVENT, PARAMs...>(ps...);
             }
         };
+
+        /**
+         * @brief A logger for several sources with a single sink, it replaces a multilogger of loggers sharing
+         * the formatter and sink. The events logged can be restricted to the ones in EVENTS, the log calls of
+         * other sources or events are discarded at compile time.
+         *
+         * @tparam SOURCES - A std::tuple of the sources to log.
+         * @tparam EVENTS - A std::tuple of the events to log, all the events by default.
+         */
+        template<typename SOURCES, class FORMATTER, typename SINK_PROVIDER, typename EVENTS=logger_events>
+        struct sources_logger;
+
+        template<typename... SOURCES, class FORMATTER, typename SINK_PROVIDER, typename... EVENTS>
+        struct sources_logger<std::tuple<SOURCES...>, FORMATTER, SINK_PROVIDER, std::tuple<EVENTS...>>{
+            template<typename DECLARED_SOURCE>
+            static constexpr bool enabled = (std::is_same<SOURCES, DECLARED_SOURCE>::value || ... || false);
+
+            template<typename EVENT>
+            static constexpr bool logs_event = (std::is_same<EVENTS, EVENT>::value || ... || false);
+
+            template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
+            static void log(const PARAMs&... ps) {
+                if constexpr (enabled<DECLARED_SOURCE> && logs_event<EVENT> && event_format<EVENT>::defined) {
+                    SINK_PROVIDER::sink() << event_format<EVENT>::template format<FORMATTER>(ps...);
+                    SINK_PROVIDER::sink() << std::endl;
+                }
+            }
+        };
     }
 }
 
@@ -0,0 +1,221 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_MMAP_SINK_PROVIDER_HPP
+#define CADMIUM_MMAP_SINK_PROVIDER_HPP
+
+#include <string>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ostream>
+#include <cstddef>
+#include <streambuf>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace cadmium {
+    namespace logger {
+
+        /**
+         * @brief A stream buffer writing in a file mapped in memory, the mapping grows by chunks.
+         *
+         * The characters are stored straight into the pre faulted pages of the mapping, when it is full the file
+         * is extended by a chunk and mapped again. While it is open the file has the size of the mapping, the tail
+         * not written yet is zeroed. It is truncated to the written size when it is closed.
+         */
+        class mmap_streambuf : public std::streambuf {
+            int _fd = -1;
+            char* _map = nullptr;
+            std::size_t _mapped = 0;
+            std::size_t _chunk;
+
+            [[noreturn]] static void fail(const std::string& what) {
+                throw std::domain_error(what + ": " + std::strerror(errno));
+            }
+
+            std::size_t written() const {
+                return static_cast<std::size_t>(pptr() - pbase());
+            }
+
+            void map(std::size_t size) {
+                if (ftruncate(_fd, static_cast<off_t>(size)) != 0) {
+                    fail("Extending the trace file");
+                }
+                int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+                flags |= MAP_POPULATE;
+#endif
+                void* m = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, _fd, 0);
+                if (m == MAP_FAILED) {
+                    fail("Mapping the trace file");
+                }
+                _map = static_cast<char*>(m);
+                _mapped = size;
+            }
+
+            void unmap() {
+                if (_map != nullptr) {
+                    munmap(_map, _mapped);
+                    _map = nullptr;
+                }
+            }
+
+            void grow() {
+                std::size_t offset = written();
+                unmap();
+                map(_mapped + _chunk);
+                setp(_map, _map + _mapped);
+                pbump_by(offset);
+            }
+
+            // pbump takes an int, the offset may not fit
+            void pbump_by(std::size_t offset) {
+                while (offset > 0) {
+                    int step = static_cast<int>(std::min<std::size_t>(offset, 1u << 30));
+                    pbump(step);
+                    offset -= static_cast<std::size_t>(step);
+                }
+            }
+
+        protected:
+            int_type overflow(int_type c) override {
+                if (_map == nullptr) {
+                    return traits_type::eof();
+                }
+                if (traits_type::eq_int_type(c, traits_type::eof())) {
+                    return traits_type::not_eof(c);
+                }
+                grow();
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+                return c;
+            }
+
+            std::streamsize xsputn(const char* s, std::streamsize n) override {
+                if (_map == nullptr) {
+                    return 0;
+                }
+                std::size_t size = static_cast<std::size_t>(n);
+                while (static_cast<std::size_t>(epptr() - pptr()) < size) {
+                    grow();
+                }
+                std::memcpy(pptr(), s, size);
+                pbump_by(size);
+                return n;
+            }
+
+            // the pages are shared with the file, the readers of the file already see the written characters
+            int sync() override {
+                return _map == nullptr ? -1 : 0;
+            }
+
+        public:
+            /**
+             * @param path - The trace file, it is truncated.
+             * @param chunk - The size of the mapping increments, rounded up to the page size.
+             */
+            explicit mmap_streambuf(const std::string& path, std::size_t chunk = 64u << 20) {
+                std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+                _chunk = (chunk + page - 1) / page * page;
+                if (_chunk == 0) {
+                    _chunk = page;
+                }
+                _fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+                if (_fd < 0) {
+                    fail("Opening the trace file " + path);
+                }
+                map(_chunk);
+                setp(_map, _map + _mapped);
+            }
+
+            mmap_streambuf(const mmap_streambuf&) = delete;
+            mmap_streambuf& operator=(const mmap_streambuf&) = delete;
+
+            ~mmap_streambuf() override {
+                close();
+            }
+
+            /**
+             * @brief Truncates the file to the written characters and closes it, the later writes fail.
+             */
+            void close() {
+                if (_fd < 0) {
+                    return;
+                }
+                std::size_t size = written();
+                unmap();
+                setp(nullptr, nullptr);
+                // the file keeps the mapped size if truncating fails, the tail is zeroed
+                (void) ftruncate(_fd, static_cast<off_t>(size));
+                ::close(_fd);
+                _fd = -1;
+            }
+
+            std::size_t mapped_size() const noexcept {
+                return _mapped;
+            }
+        };
+
+        /**
+         * @brief A sink provider writing in a file mapped in memory, see mmap_streambuf.
+         *
+         * @tparam PATH_PROVIDER - Has a static path() returning the path of the trace file.
+         * @tparam CHUNK - The size of the mapping increments.
+         */
+        template<typename PATH_PROVIDER, std::size_t CHUNK = (64u << 20)>
+        class mmap_sink_provider {
+            struct mapped_stream {
+                mmap_streambuf buf{PATH_PROVIDER::path(), CHUNK};
+                std::ostream os{&buf};
+            };
+
+            static mapped_stream& stream() {
+                static mapped_stream s;
+                return s;
+            }
+
+        public:
+            static std::ostream& sink() {
+                return stream().os;
+            }
+
+            /**
+             * @brief Truncates the trace file to the written size and closes it before the program exit.
+             */
+            static void close() {
+                stream().os.flush();
+                stream().buf.close();
+            }
+        };
+    }
+}
+
+#endif // CADMIUM_MMAP_SINK_PROVIDER_HPP
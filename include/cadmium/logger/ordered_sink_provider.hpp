@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_ORDERED_SINK_PROVIDER_HPP
+#define CADMIUM_ORDERED_SINK_PROVIDER_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <ostream>
+#include <utility>
+
+namespace cadmium {
+    namespace logger {
+
+        /**
+         * @brief The text logged through the ordered sink providers while the capture is the current one of a
+         * thread, kept by sink. A parallel loop gives a capture to each iteration and replays them in index
+         * order when the loop finished, then the lines logged do not depend on the threads timing.
+         */
+        class log_capture {
+            using sink_function = std::ostream& (*)();
+
+            std::vector<std::pair<sink_function, std::unique_ptr<std::ostringstream>>> _streams;
+
+        public:
+            static log_capture*& current() noexcept {
+                thread_local log_capture* capture = nullptr;
+                return capture;
+            }
+
+            /**
+             * @brief Makes a capture the current one of the calling thread until the scope ends.
+             */
+            class scope {
+                log_capture* _previous;
+
+            public:
+                explicit scope(log_capture& capture) noexcept
+                : _previous(current()) {
+                    current() = &capture;
+                }
+
+                ~scope() {
+                    current() = _previous;
+                }
+
+                scope(const scope&) = delete;
+                scope& operator=(const scope&) = delete;
+            };
+
+            std::ostream& stream(sink_function sink) {
+                for (auto& s : _streams) {
+                    if (s.first == sink) {
+                        return *s.second;
+                    }
+                }
+                _streams.emplace_back(sink, std::make_unique<std::ostringstream>());
+                return *_streams.back().second;
+            }
+
+            bool empty() const noexcept {
+                return _streams.empty();
+            }
+
+            /**
+             * @brief Writes the captured text in the current capture of the calling thread, or in the sinks if
+             * there is none, and empties the capture.
+             */
+            void replay() {
+                log_capture* to = current();
+                for (auto& s : _streams) {
+                    std::string text = s.second->str();
+                    if (text.empty()) {
+                        continue;
+                    }
+                    std::ostream& os = to != nullptr ? to->stream(s.first) : s.first();
+                    os.write(text.data(), static_cast<std::streamsize>(text.size()));
+                    os.flush();
+                }
+                _streams.clear();
+            }
+        };
+
+        /**
+         * @brief A sink provider writing in the current log capture of the thread if any, or in the sink of
+         * SINK_PROVIDER. It is the sink provider of the loggers used with the deterministic_execution policy.
+         */
+        template<typename SINK_PROVIDER>
+        struct ordered_sink_provider {
+            static std::ostream& sink() {
+                log_capture* capture = log_capture::current();
+                return capture != nullptr ? capture->stream(&SINK_PROVIDER::sink) : SINK_PROVIDER::sink();
+            }
+        };
+    }
+}
+
+#endif // CADMIUM_ORDERED_SINK_PROVIDER_HPP
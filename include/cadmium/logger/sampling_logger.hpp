@@ -0,0 +1,203 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_SAMPLING_LOGGER_HPP
+#define CADMIUM_SAMPLING_LOGGER_HPP
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <unordered_map>
+
+#include <cadmium/logger/logger.hpp>
+
+namespace cadmium {
+    namespace logger {
+
+        /**
+         * @brief A logger logging only the sim_state events accepted by all the POLICIES, the other events are
+         * logged by LOGGER as they are. The policies are applied in order, each one only sees the states accepted
+         * by the previous ones.
+         *
+         * A policy has a static accept(model_id) for the states logged by the static simulators and a static
+         * accept(model_id, time) for the ones logged by the dynamic simulators, that log the time of the state.
+         */
+        template<typename LOGGER, typename... POLICIES>
+        struct sampling_logger {
+            template<typename DECLARED_SOURCE>
+            static constexpr bool enabled = logs_source<LOGGER, DECLARED_SOURCE>::value;
+
+            template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
+            static void log(const PARAMs&... ps) {
+                if constexpr (enabled<DECLARED_SOURCE>) {
+                    if constexpr (std::is_same<EVENT, cadmium::logger::sim_state>::value) {
+                        if (!accept_state(ps...)) {
+                            return;
+                        }
+                    }
+                    LOGGER::template log<DECLARED_SOURCE, EVENT, PARAMs...>(ps...);
+                }
+            }
+
+        private:
+            // the static simulators log the state and the model id
+            template<typename STATE>
+            static bool accept_state(const STATE&, const std::string& model_id) {
+                return (POLICIES::accept(model_id) && ... && true);
+            }
+
+            // the dynamic simulators log the time, the model id and the state
+            template<typename TIME, typename STATE>
+            static bool accept_state(const TIME& t, const std::string& model_id, const STATE&) {
+                return (POLICIES::accept(model_id, t) && ... && true);
+            }
+        };
+
+        /**
+         * @brief Accepts one of every K states of each model, starting by the first one.
+         * @tparam TAG - Distinguishes the counters of policies used by different loggers.
+         */
+        template<std::size_t K, typename TAG=void>
+        struct every_kth_state {
+            static_assert(K > 0, "Sampling every 0 states");
+
+            template<typename... TIME>
+            static bool accept(const std::string& model_id, const TIME&...) {
+                std::lock_guard<std::mutex> lock(mutex());
+                return counts()[model_id]++ % K == 0;
+            }
+
+            static void reset() {
+                std::lock_guard<std::mutex> lock(mutex());
+                counts().clear();
+            }
+
+        private:
+            static std::mutex& mutex() {
+                static std::mutex m;
+                return m;
+            }
+
+            static std::unordered_map<std::string, std::size_t>& counts() {
+                static std::unordered_map<std::string, std::size_t> c;
+                return c;
+            }
+        };
+
+        /**
+         * @brief Accepts a state of each model by time window, the first state at least window() units of
+         * simulated time after the last accepted state of the model. The states without time are accepted.
+         * @tparam TAG - Distinguishes the windows of policies used by different loggers.
+         */
+        template<typename TIME, typename TAG=void>
+        struct state_time_window {
+            static void set_window(const TIME& window) {
+                std::lock_guard<std::mutex> lock(mutex());
+                data().window = window;
+            }
+
+            static TIME window() {
+                std::lock_guard<std::mutex> lock(mutex());
+                return data().window;
+            }
+
+            static bool accept(const std::string&) {
+                return true;
+            }
+
+            static bool accept(const std::string& model_id, const TIME& t) {
+                std::lock_guard<std::mutex> lock(mutex());
+                auto it = data().last.find(model_id);
+                if (it != data().last.end() && t < it->second + data().window) {
+                    return false;
+                }
+                data().last[model_id] = t;
+                return true;
+            }
+
+            static void reset() {
+                std::lock_guard<std::mutex> lock(mutex());
+                data().last.clear();
+            }
+
+        private:
+            struct window_data {
+                TIME window{};
+                std::unordered_map<std::string, TIME> last;
+            };
+
+            static std::mutex& mutex() {
+                static std::mutex m;
+                return m;
+            }
+
+            static window_data& data() {
+                static window_data d;
+                return d;
+            }
+        };
+
+        /**
+         * @brief Accepts the states of the models whose id starts with one of the prefixes set, an exact id is a
+         * prefix of itself. No state is accepted until the prefixes are set.
+         * @tparam TAG - Distinguishes the prefixes of policies used by different loggers.
+         */
+        template<typename TAG=void>
+        struct model_id_prefixes {
+            static void set_prefixes(std::vector<std::string> prefixes) {
+                std::lock_guard<std::mutex> lock(mutex());
+                values() = std::move(prefixes);
+            }
+
+            template<typename... TIME>
+            static bool accept(const std::string& model_id, const TIME&...) {
+                std::lock_guard<std::mutex> lock(mutex());
+                for (const auto& p : values()) {
+                    if (model_id.compare(0, p.size(), p) == 0) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+        private:
+            static std::mutex& mutex() {
+                static std::mutex m;
+                return m;
+            }
+
+            static std::vector<std::string>& values() {
+                static std::vector<std::string> v;
+                return v;
+            }
+        };
+    }
+}
+
+#endif // CADMIUM_SAMPLING_LOGGER_HPP
@@ -0,0 +1,382 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_STATISTICS_LOGGER_HPP
+#define CADMIUM_STATISTICS_LOGGER_HPP
+
+#include <cmath>
+#include <mutex>
+#include <atomic>
+#include <limits>
+#include <tuple>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <ostream>
+#include <algorithm>
+#include <typeindex>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <boost/core/demangle.hpp>
+
+#include <cadmium/logger/logger.hpp>
+
+namespace cadmium {
+    namespace logger {
+
+        /**
+         * @brief A histogram of positive values in power of two buckets, the bucket i > 0 counts the values in
+         * [2^(i - 1 + min_exponent), 2^(i + min_exponent)) and the bucket 0 the values below, zero included.
+         */
+        struct log2_histogram {
+            static constexpr int min_exponent = -32;
+            static constexpr std::size_t buckets_size = 66;
+
+            std::uint64_t buckets[buckets_size] = {};
+            std::uint64_t count = 0;
+            double sum = 0;
+            double min = std::numeric_limits<double>::infinity();
+            double max = -std::numeric_limits<double>::infinity();
+
+            static std::size_t bucket_of(double value) noexcept {
+                if (!(value > 0)) {
+                    return 0;
+                }
+                int exponent;
+                std::frexp(value, &exponent); // value in [2^(exponent - 1), 2^exponent)
+                long i = static_cast<long>(exponent) - min_exponent;
+                return i < 1 ? 0 : (i >= static_cast<long>(buckets_size) ? buckets_size - 1 : static_cast<std::size_t>(i));
+            }
+
+            // the upper bound of the values of the bucket i
+            static double bucket_limit(std::size_t i) noexcept {
+                return std::ldexp(1.0, static_cast<int>(i) + min_exponent);
+            }
+
+            void add(double value) noexcept {
+                if (std::isnan(value)) {
+                    return;
+                }
+                buckets[bucket_of(value)]++;
+                count++;
+                sum += value;
+                min = std::min(min, value);
+                max = std::max(max, value);
+            }
+
+            void merge(const log2_histogram& other) noexcept {
+                for (std::size_t i = 0; i < buckets_size; i++) {
+                    buckets[i] += other.buckets[i];
+                }
+                count += other.count;
+                sum += other.sum;
+                min = std::min(min, other.min);
+                max = std::max(max, other.max);
+            }
+
+            double mean() const noexcept {
+                return count == 0 ? 0 : sum / count;
+            }
+        };
+
+        /**
+         * @brief The counters of a model, the elapsed are the simulated times between its advances, only for
+         * the times converting to double.
+         */
+        struct model_statistics {
+            std::string model_id;
+            bool coordinator = false;
+            std::uint64_t collects = 0;
+            std::uint64_t advances = 0;
+            log2_histogram elapsed;
+
+            void merge(const model_statistics& other) noexcept {
+                coordinator = coordinator || other.coordinator;
+                collects += other.collects;
+                advances += other.advances;
+                elapsed.merge(other.elapsed);
+            }
+        };
+
+        /**
+         * @brief The messages of an input or output port of a model, the histogram has the sizes of its
+         * bags with messages, then its mean is the mean queue length of an input port.
+         */
+        struct port_statistics {
+            std::string model_id;
+            std::string port;
+            bool output = false;
+            std::uint64_t messages = 0;
+            log2_histogram bag_sizes;
+        };
+
+        struct statistics_summary {
+            std::uint64_t global_times = 0; // the initial time and the time of each step logged by the runner
+            std::vector<model_statistics> models; // by model id
+            std::vector<port_statistics> ports; // by model id, inputs first, then by port
+        };
+
+        inline void write_histogram_json(std::ostream& os, const log2_histogram& h) {
+            os << "{\"count\": " << h.count << ", \"mean\": " << h.mean();
+            if (h.count != 0) {
+                os << ", \"min\": " << h.min << ", \"max\": " << h.max;
+            }
+            os << ", \"buckets\": [";
+            bool first = true;
+            for (std::size_t i = 0; i < log2_histogram::buckets_size; i++) {
+                if (h.buckets[i] != 0) {
+                    os << (first ? "" : ", ") << "{\"below\": " << log2_histogram::bucket_limit(i) << ", \"count\": " << h.buckets[i] << "}";
+                    first = false;
+                }
+            }
+            os << "]}";
+        }
+
+        /**
+         * @brief Writes the summary as a JSON object with the global times, the models and the ports.
+         */
+        inline void write_statistics_json(std::ostream& os, const statistics_summary& summary) {
+            // the ids and port names are C++ names, they have no character to escape but the quotes of literals
+            auto write_string = [&os](const std::string& s) {
+                os << '"';
+                for (char c : s) {
+                    if (c == '"' || c == '\\') {
+                        os << '\\';
+                    }
+                    os << c;
+                }
+                os << '"';
+            };
+            os << "{\"global_times\": " << summary.global_times << ", \"models\": [";
+            for (std::size_t i = 0; i < summary.models.size(); i++) {
+                const model_statistics& m = summary.models[i];
+                os << (i == 0 ? "\n" : ",\n") << "{\"model_id\": ";
+                write_string(m.model_id);
+                os << ", \"coordinator\": " << (m.coordinator ? "true" : "false")
+                   << ", \"collects\": " << m.collects << ", \"advances\": " << m.advances << ", \"elapsed\": ";
+                write_histogram_json(os, m.elapsed);
+                os << "}";
+            }
+            os << "\n], \"ports\": [";
+            for (std::size_t i = 0; i < summary.ports.size(); i++) {
+                const port_statistics& p = summary.ports[i];
+                os << (i == 0 ? "\n" : ",\n") << "{\"model_id\": ";
+                write_string(p.model_id);
+                os << ", \"port\": ";
+                write_string(p.port);
+                os << ", \"output\": " << (p.output ? "true" : "false") << ", \"messages\": " << p.messages << ", \"bag_sizes\": ";
+                write_histogram_json(os, p.bag_sizes);
+                os << "}";
+            }
+            os << "\n]}\n";
+        }
+
+        /**
+         * @brief A logger reducing the events into counters and histograms by model and port, nothing is
+         * formatted nor written until the summary is asked for.
+         *
+         * It logs the info and global time sources, whose events only have times and model ids: the global times, the
+         * collects and advances of every simulator and coordinator and the elapsed times between the advances.
+         * The state, messages and routing sources are disabled, and the engines do not format them. The dynamic
+         * simulators count the messages of each bag of their inbox and outbox with count_messages.
+         *
+         * Each thread reduces in its own tables, they are merged by summary(). summary() and reset() must
+         * not be called while the simulation runs.
+         *
+         * @tparam TAG - Distinguishes the statistics of loggers used by different simulations.
+         */
+        template<typename TAG=void>
+        struct statistics_logger {
+            template<typename DECLARED_SOURCE>
+            static constexpr bool enabled = std::is_same<DECLARED_SOURCE, logger_info>::value || std::is_same<DECLARED_SOURCE, logger_global_time>::value;
+
+            template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
+            static void log(const PARAMs&... ps) {
+                if constexpr (enabled<DECLARED_SOURCE>) {
+                    reduce(EVENT(), ps...);
+                }
+            }
+
+            static void count_messages(const std::string& model_id, bool output, const std::type_index& port, std::size_t messages) {
+                if (messages == 0) {
+                    return;
+                }
+                port_counters& p = local().ports[port_key{model_id, port, output}];
+                p.messages += messages;
+                p.bag_sizes.add(static_cast<double>(messages));
+            }
+
+            static statistics_summary summary() {
+                std::lock_guard<std::mutex> lock(registry().mutex);
+                statistics_summary ret;
+                std::unordered_map<std::string, model_statistics> models;
+                std::unordered_map<port_key, port_counters, port_key_hash> ports;
+                for (const auto& t : registry().tables) {
+                    ret.global_times += t->global_times;
+                    for (const auto& m : t->models) {
+                        model_statistics& to = models[m.first];
+                        to.model_id = m.first;
+                        to.merge(m.second);
+                    }
+                    for (const auto& p : t->ports) {
+                        port_counters& to = ports[p.first];
+                        to.messages += p.second.messages;
+                        to.bag_sizes.merge(p.second.bag_sizes);
+                    }
+                }
+                for (auto& m : models) {
+                    ret.models.push_back(std::move(m.second));
+                }
+                std::sort(ret.models.begin(), ret.models.end(), [](const model_statistics& a, const model_statistics& b) {
+                    return a.model_id < b.model_id;
+                });
+                for (auto& p : ports) {
+                    ret.ports.push_back(port_statistics{p.first.model_id, boost::core::demangle(p.first.port.name()), p.first.output, p.second.messages, p.second.bag_sizes});
+                }
+                std::sort(ret.ports.begin(), ret.ports.end(), [](const port_statistics& a, const port_statistics& b) {
+                    return std::tie(a.model_id, a.output, a.port) < std::tie(b.model_id, b.output, b.port);
+                });
+                return ret;
+            }
+
+            static void write_summary_json(std::ostream& os) {
+                write_statistics_json(os, summary());
+            }
+
+            // discards the statistics, the threads start new tables
+            static void reset() {
+                std::lock_guard<std::mutex> lock(registry().mutex);
+                registry().tables.clear();
+                registry().generation.fetch_add(1, std::memory_order_release);
+            }
+
+        private:
+            struct port_key {
+                std::string model_id;
+                std::type_index port;
+                bool output;
+
+                bool operator==(const port_key& other) const {
+                    return output == other.output && port == other.port && model_id == other.model_id;
+                }
+            };
+
+            struct port_key_hash {
+                std::size_t operator()(const port_key& k) const {
+                    return std::hash<std::string>()(k.model_id) ^ (k.port.hash_code() * 31 + k.output);
+                }
+            };
+
+            struct port_counters {
+                std::uint64_t messages = 0;
+                log2_histogram bag_sizes;
+            };
+
+            struct thread_table {
+                std::uint64_t global_times = 0;
+                std::unordered_map<std::string, model_statistics> models;
+                std::unordered_map<port_key, port_counters, port_key_hash> ports;
+            };
+
+            struct table_registry {
+                std::mutex mutex;
+                std::atomic<std::uint64_t> generation{1};
+                std::vector<std::unique_ptr<thread_table>> tables;
+            };
+
+            static table_registry& registry() {
+                static table_registry r;
+                return r;
+            }
+
+            // the table of the calling thread, a new one after each reset
+            static thread_table& local() {
+                thread_local thread_table* t = nullptr;
+                thread_local std::uint64_t generation = 0;
+                table_registry& r = registry();
+                std::uint64_t current = r.generation.load(std::memory_order_acquire);
+                if (t == nullptr || generation != current) {
+                    std::lock_guard<std::mutex> lock(r.mutex);
+                    r.tables.push_back(std::make_unique<thread_table>());
+                    t = r.tables.back().get();
+                    generation = current;
+                }
+                return *t;
+            }
+
+            template<typename TIME>
+            static double elapsed(const TIME& from, const TIME& to) {
+                if constexpr (std::is_constructible<double, TIME>::value) {
+                    return static_cast<double>(to) - static_cast<double>(from);
+                } else {
+                    return std::numeric_limits<double>::quiet_NaN();
+                }
+            }
+
+            template<typename TIME>
+            static void reduce(run_global_time, const TIME&) {
+                local().global_times++;
+            }
+
+            template<typename TIME>
+            static void reduce(sim_info_collect, const TIME&, const std::string& model_id) {
+                local().models[model_id].collects++;
+            }
+
+            template<typename TIME>
+            static void reduce(coor_info_collect, const TIME&, const std::string& model_id) {
+                model_statistics& m = local().models[model_id];
+                m.coordinator = true;
+                m.collects++;
+            }
+
+            template<typename TIME>
+            static void reduce(sim_info_advance, const TIME& from, const TIME& to, const std::string& model_id) {
+                model_statistics& m = local().models[model_id];
+                m.advances++;
+                m.elapsed.add(elapsed(from, to));
+            }
+
+            template<typename TIME>
+            static void reduce(coor_info_advance, const TIME& from, const TIME& to, const std::string& model_id) {
+                model_statistics& m = local().models[model_id];
+                m.coordinator = true;
+                m.advances++;
+                m.elapsed.add(elapsed(from, to));
+            }
+
+            // the other events are not reduced
+            template<typename EVENT, typename... PARAMs>
+            static void reduce(EVENT, const PARAMs&...) {}
+        };
+    }
+}
+
+#endif // CADMIUM_STATISTICS_LOGGER_HPP
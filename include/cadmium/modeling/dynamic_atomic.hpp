@@ -28,14 +28,30 @@
 #define CADMIUM_DYNAMIC_ATOMIC_HPP
 
 #include <map>
+#include <stdexcept>
+#include <type_traits>
 #include <boost/any.hpp>
 #include <cadmium/modeling/dynamic_model.hpp>
 #include <cadmium/modeling/dynamic_message_bag.hpp>
+#include <cadmium/modeling/dynamic_input_view.hpp>
 #include <cadmium/concept/concept_helpers.hpp>
 #include <cadmium/concept/atomic_model_assert.hpp>
 #include <cadmium/modeling/dynamic_models_helpers.hpp>
+#include <cadmium/modeling/state_serializer.hpp>
 
 namespace cadmium {
+
+    /**
+     * @brief The bytes a model state allocates out of the model, 0 unless specialized. States holding
+     * containers can specialize it to have their memory accounted, see pdevs_dynamic_memory.hpp.
+     */
+    template<typename STATE>
+    struct state_memory {
+        static std::size_t heap_bytes(const STATE&) noexcept {
+            return 0;
+        }
+    };
+
     namespace dynamic {
         namespace modeling {
 
@@ -103,33 +119,84 @@ namespace cadmium {
                     return oss.str();
                 }
 
-                std::string messages_by_port_as_string(cadmium::dynamic::message_bags outbox) const override {
+                std::string messages_by_port_as_string(const cadmium::dynamic::message_bags& outbox) const override {
                     std::ostringstream oss;
                     print_dynamic_messages_by_port<output_ports>(oss, outbox);
                     return oss.str();
                 }
 
+                boost::any get_state() const override {
+                    return this->state;
+                }
+
+                void set_state(const boost::any& state) override {
+                    this->state = boost::any_cast<const typename model_type::state_type&>(state);
+                }
+
+                std::size_t state_bytes() const override {
+                    using state_type = typename model_type::state_type;
+                    return sizeof(state_type) + cadmium::state_memory<state_type>::heap_bytes(this->state);
+                }
+
+                std::shared_ptr<atomic_abstract<TIME>> clone() const override {
+                    if constexpr (std::is_copy_constructible<model_type>::value) {
+                        return std::make_shared<atomic>(*this);
+                    } else {
+                        throw std::logic_error("The atomic model " + _id + " can not be copied");
+                    }
+                }
+
+                void write_state(std::string& buffer) const override {
+                    cadmium::state_serializer<typename model_type::state_type>::write(this->state, buffer);
+                }
+
+                void read_state(const char*& data, const char* end) override {
+                    cadmium::state_serializer<typename model_type::state_type>::read(data, end, this->state);
+                }
+
+                bool release_state() override {
+                    using state_type = typename model_type::state_type;
+                    if constexpr (std::is_default_constructible<state_type>::value && std::is_move_assignable<state_type>::value) {
+                        this->state = state_type();
+                        return true;
+                    } else {
+                        return false;
+                    }
+                }
+
                 // This method must be declared to declare all atomic_abstract virtual methods are defined
                 void internal_transition() override {
                     model_type::internal_transition();
                 }
 
-                void external_transition(TIME e, cadmium::dynamic::message_bags bags) override {
-                    // Translate from dynamic_message_bag to template dependent input_bags type.
-                    input_bags tuple_bags;
-                    cadmium::dynamic::modeling::fill_bags_from_map(bags, tuple_bags);
-
-                    // Forwards the translated value to the wrapped model_type class method.
-                    model_type::external_transition(e, tuple_bags);
+                void external_transition(TIME e, cadmium::dynamic::message_bags&& bags) override {
+                    if constexpr (has_external_transition_view<model_type, TIME>::value) {
+                        // The model reads the bags of the ports it uses directly from bags.
+                        model_type::external_transition(e, input_view<input_ports>(bags));
+                    } else {
+                        // Translate from dynamic_message_bag to template dependent input_bags type,
+                        // the messages are moved out of bags, they are consumed by this transition.
+                        input_bags tuple_bags;
+                        cadmium::dynamic::modeling::move_bags_from_map(std::move(bags), tuple_bags);
+
+                        // Forwards the translated value to the wrapped model_type class method.
+                        model_type::external_transition(e, std::move(tuple_bags));
+                    }
                 }
 
-                void confluence_transition(TIME e, cadmium::dynamic::message_bags bags) override {
-                    // Translate from dynamic_message_bag to template dependent input_bags type.
-                    input_bags tuple_bags;
-                    cadmium::dynamic::modeling::fill_bags_from_map(bags, tuple_bags);
-
-                    // Forwards the translated value to the wrapped model_type class method.
-                    model_type::confluence_transition(e, tuple_bags);
+                void confluence_transition(TIME e, cadmium::dynamic::message_bags&& bags) override {
+                    if constexpr (has_confluence_transition_view<model_type, TIME>::value) {
+                        // The model reads the bags of the ports it uses directly from bags.
+                        model_type::confluence_transition(e, input_view<input_ports>(bags));
+                    } else {
+                        // Translate from dynamic_message_bag to template dependent input_bags type,
+                        // the messages are moved out of bags, they are consumed by this transition.
+                        input_bags tuple_bags;
+                        cadmium::dynamic::modeling::move_bags_from_map(std::move(bags), tuple_bags);
+
+                        // Forwards the translated value to the wrapped model_type class method.
+                        model_type::confluence_transition(e, std::move(tuple_bags));
+                    }
                 }
 
                 cadmium::dynamic::message_bags output() const override {
@@ -137,10 +204,17 @@ namespace cadmium {
                     output_bags tuple_bags = model_type::output();
 
                     // Translate from template dependent output_bags type to dynamic_message_bag.
-                    cadmium::dynamic::modeling::fill_map_from_bags(tuple_bags, bags);
+                    cadmium::dynamic::modeling::move_map_from_bags(tuple_bags, bags);
                     return bags;
                 }
 
+                void output(cadmium::dynamic::message_bags& outbox) const override {
+                    output_bags tuple_bags = model_type::output();
+
+                    // Moves the messages of the ports with messages to the outbox bags.
+                    cadmium::dynamic::modeling::move_map_from_bags(tuple_bags, outbox);
+                }
+
                 TIME time_advance() const override {
                     return model_type::time_advance();
                 }
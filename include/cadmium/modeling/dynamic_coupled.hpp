@@ -34,8 +34,34 @@ namespace cadmium {
     namespace dynamic {
         namespace modeling {
 
+            /**
+             * @brief A coupled model defined at runtime.
+             *
+             * The constructors check that the links connect ports of the submodels and of the coupled model,
+             * the ports of all the submodels are indexed once for all the links. The models built from parts
+             * of models already checked, as the flattened or partitioned ones, skip the check passing false as
+             * validate_links.
+             *
+             * Setting _lazy delays the creation of the engines of the model until they are needed, the models
+             * of the large regions of a hierarchy staying inactive then take no engines nor bags.
+             */
             template<typename TIME>
             class coupled : public cadmium::dynamic::modeling::model {
+                void check_links() const {
+                    model_ports_index index(_models);
+                    if (!valid_ic_links(index, _ic)) {
+                        throw std::domain_error("Coupled model" + _id + " has invalid IC links");
+                    }
+
+                    if (!valid_eic_links(index, _input_ports, _eic)) {
+                        throw std::domain_error("Coupled model" + _id + " has invalid EIC links");
+                    }
+
+                    if(!valid_eoc_links(index, _output_ports, _eoc)) {
+                        throw std::domain_error("Coupled model" + _id + " has invalid EOC links");
+                    }
+                }
+
             public:
                 Models _models;
                 Ports _input_ports;
@@ -46,6 +72,10 @@ namespace cadmium {
 
                 std::string _id;
 
+                // the engines of the model subtree are created when it receives its first input or reaches
+                // its first event, see cadmium::dynamic::engine::lazy_coordinator
+                bool _lazy = false;
+
                 coupled() = delete;
 
                 coupled(std::string id) : _id(id) {}
@@ -57,7 +87,8 @@ namespace cadmium {
                         Ports output_ports,
                         EICs eic,
                         EOCs eoc,
-                        ICs ic
+                        ICs ic,
+                        bool validate_links = true
                 ) :
                         _id(id),
                         _models(models),
@@ -67,16 +98,8 @@ namespace cadmium {
                         _eoc(eoc),
                         _ic(ic)
                 {
-                    if (!valid_ic_links(_models, _ic)) {
-                        throw std::domain_error("Coupled model" + _id + " has invalid IC links");
-                    }
-
-                    if (!valid_eic_links(_models, _input_ports, _eic)) {
-                        throw std::domain_error("Coupled model" + _id + " has invalid EIC links");
-                    }
-
-                    if(!valid_eoc_links(_models, _output_ports, _eoc)) {
-                        throw std::domain_error("Coupled model" + _id + " has invalid EOC links");
+                    if (validate_links) {
+                        check_links();
                     }
                 }
 
@@ -87,7 +110,8 @@ namespace cadmium {
                         initilizer_list_Ports output_ports,
                         initializer_list_EICs eic,
                         initializer_list_EOCs eoc,
-                        initializer_list_ICs ic
+                        initializer_list_ICs ic,
+                        bool validate_links = true
                 ) :
                         _id(id),
                         _models(models),
@@ -97,16 +121,8 @@ namespace cadmium {
                         _eoc(eoc),
                         _ic(ic)
                 {
-                    if (!valid_ic_links(_models, _ic)) {
-                        throw std::domain_error("Coupled model" + _id + " has invalid IC links");
-                    }
-
-                    if (!valid_eic_links(_models, _input_ports, _eic)) {
-                        throw std::domain_error("Coupled model" + _id + " has invalid EIC links");
-                    }
-
-                    if(!valid_eoc_links(_models, _output_ports, _eoc)) {
-                        throw std::domain_error("Coupled model" + _id + " has invalid EOC links");
+                    if (validate_links) {
+                        check_links();
                     }
                 }
 
@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_DYNAMIC_EMBEDDED_HPP
+#define CADMIUM_DYNAMIC_EMBEDDED_HPP
+
+#include <memory>
+#include <string>
+#include <boost/type_index.hpp>
+
+#include <cadmium/concept/coupled_model_assert.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_models_helpers.hpp>
+#include <cadmium/engine/pdevs_dynamic_embedded_coordinator.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace modeling {
+
+            /**
+             * @brief embedded makes a static coupled model a submodel of the dynamic coupled models. The dynamic
+             * coordinators run it with a cadmium::dynamic::engine::embedded_coordinator, the static engine
+             * simulates the whole subtree and the dynamic engine only sees its ports.
+             *
+             * @tparam MODEL - The static coupled model type.
+             * @tparam TIME - The class representing the model time.
+             * @tparam LOGGER - The logger type used by the static coordinator.
+             */
+            template<template<typename T> class MODEL, typename TIME, typename LOGGER=cadmium::logger::not_logger>
+            class embedded : public cadmium::dynamic::modeling::embedded_abstract<TIME> {
+                using input_ports=typename MODEL<TIME>::input_ports;
+                using output_ports=typename MODEL<TIME>::output_ports;
+
+                std::string _id;
+
+            public:
+                /**
+                 * @brief The model id is the name of the static model type, as the translated models have.
+                 */
+                embedded()
+                : embedded(boost::typeindex::type_id<MODEL<TIME>>().pretty_name()) {}
+
+                explicit embedded(std::string id)
+                : _id(std::move(id)) {
+                    cadmium::concept::coupled_model_assert<MODEL>();
+                }
+
+                std::string get_id() const override {
+                    return _id;
+                }
+
+                cadmium::dynamic::modeling::Ports get_input_ports() const override {
+                    return cadmium::dynamic::modeling::create_dynamic_ports<input_ports>();
+                }
+
+                cadmium::dynamic::modeling::Ports get_output_ports() const override {
+                    return cadmium::dynamic::modeling::create_dynamic_ports<output_ports>();
+                }
+
+                std::shared_ptr<cadmium::dynamic::engine::engine<TIME>> make_engine() const override {
+                    return std::make_shared<cadmium::dynamic::engine::embedded_coordinator<MODEL, TIME, LOGGER>>(_id);
+                }
+            };
+        }
+    }
+}
+
+#endif //CADMIUM_DYNAMIC_EMBEDDED_HPP
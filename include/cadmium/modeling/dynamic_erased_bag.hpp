@@ -0,0 +1,438 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_DYNAMIC_ERASED_BAG_HPP
+#define CADMIUM_DYNAMIC_ERASED_BAG_HPP
+
+#include <new>
+#include <string>
+#include <sstream>
+#include <utility>
+#include <iterator>
+#include <typeinfo>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include <cadmium/logger/common_loggers_helpers.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+
+        /**
+         * @brief Thrown by bag_cast when the bag is not of the requested type.
+         */
+        class bad_bag_cast : public std::bad_cast {
+        public:
+            const char* what() const noexcept override {
+                return "cadmium::dynamic::bad_bag_cast: the bag is not of the requested type";
+            }
+        };
+
+        /**
+         * @brief A message bag of any type, the message bag types have a messages member and a clear() method as
+         * cadmium::message_bag. It replaces boost::any in the dynamic message bags: the bag operations are calls
+         * through a vtable by bag type, the bag type check compares the vtable addresses without RTTI and the
+         * bags fitting in a few words are stored inline without allocating.
+         */
+        class erased_bag {
+            static constexpr std::size_t buffer_size = 6 * sizeof(void*);
+
+            union storage {
+                void* heap;
+                typename std::aligned_storage<buffer_size, alignof(std::max_align_t)>::type buffer;
+            };
+
+            struct vtable {
+                void (*construct_empty)(storage&);
+                void (*destroy)(storage&) noexcept;
+                void (*copy)(const storage& from, storage& to);
+                void (*move)(storage& from, storage& to) noexcept;
+                bool (*clear)(storage&) noexcept;
+                std::size_t (*size)(const storage&) noexcept;
+                std::size_t (*bytes)(const storage&) noexcept;
+                void (*append)(const storage& from, storage& to);
+                void (*move_into)(storage& from, storage& to);
+                std::string (*to_string)(const storage&);
+            };
+
+            template<typename BAG>
+            struct fits_inline : std::integral_constant<bool,
+                    sizeof(BAG) <= buffer_size &&
+                    alignof(std::max_align_t) % alignof(BAG) == 0 &&
+                    std::is_nothrow_move_constructible<BAG>::value> {};
+
+            template<typename BAG, bool INLINE = fits_inline<BAG>::value>
+            struct storage_of {
+                static BAG* get(storage& s) noexcept {
+                    return reinterpret_cast<BAG*>(&s.buffer);
+                }
+
+                static const BAG* get(const storage& s) noexcept {
+                    return reinterpret_cast<const BAG*>(&s.buffer);
+                }
+
+                template<typename... ARGS>
+                static void construct(storage& s, ARGS&&... args) {
+                    ::new (static_cast<void*>(&s.buffer)) BAG(std::forward<ARGS>(args)...);
+                }
+
+                static void destroy(storage& s) noexcept {
+                    get(s)->~BAG();
+                }
+
+                static void move(storage& from, storage& to) noexcept {
+                    construct(to, std::move(*get(from)));
+                    destroy(from);
+                }
+            };
+
+            template<typename BAG>
+            struct storage_of<BAG, false> {
+                static BAG* get(storage& s) noexcept {
+                    return static_cast<BAG*>(s.heap);
+                }
+
+                static const BAG* get(const storage& s) noexcept {
+                    return static_cast<const BAG*>(s.heap);
+                }
+
+                template<typename... ARGS>
+                static void construct(storage& s, ARGS&&... args) {
+                    s.heap = new BAG(std::forward<ARGS>(args)...);
+                }
+
+                static void destroy(storage& s) noexcept {
+                    delete get(s);
+                }
+
+                static void move(storage& from, storage& to) noexcept {
+                    to.heap = from.heap;
+                }
+            };
+
+            template<typename BAG>
+            struct bag_operations {
+                using stored = storage_of<BAG>;
+
+                static void construct_empty(storage& s) {
+                    stored::construct(s);
+                }
+
+                static void destroy(storage& s) noexcept {
+                    stored::destroy(s);
+                }
+
+                static void copy(const storage& from, storage& to) {
+                    stored::construct(to, *stored::get(from));
+                }
+
+                static void move(storage& from, storage& to) noexcept {
+                    stored::move(from, to);
+                }
+
+                static bool clear(storage& s) noexcept {
+                    return stored::get(s)->clear();
+                }
+
+                static std::size_t size(const storage& s) noexcept {
+                    return stored::get(s)->messages.size();
+                }
+
+                static std::size_t bytes(const storage& s) noexcept {
+                    return (fits_inline<BAG>::value ? 0 : sizeof(BAG)) + cadmium::allocated_bytes(stored::get(s)->messages);
+                }
+
+                static void append(const storage& from, storage& to) {
+                    const auto& f = stored::get(from)->messages;
+                    auto& t = stored::get(to)->messages;
+                    t.insert(t.end(), f.begin(), f.end());
+                }
+
+                static void move_into(storage& from, storage& to) {
+                    auto& f = stored::get(from)->messages;
+                    auto& t = stored::get(to)->messages;
+                    if (t.empty()) {
+                        t.swap(f);
+                    } else {
+                        t.insert(t.end(), std::make_move_iterator(f.begin()), std::make_move_iterator(f.end()));
+                    }
+                    f.clear();
+                }
+
+                static std::string to_string(const storage& s) {
+                    std::ostringstream oss;
+                    cadmium::logger::implode(oss, stored::get(s)->messages);
+                    return oss.str();
+                }
+            };
+
+            // the vtable address identifies the bag type
+            template<typename BAG>
+            static const vtable* vtable_of() noexcept {
+                static constexpr vtable v{
+                        &bag_operations<BAG>::construct_empty,
+                        &bag_operations<BAG>::destroy,
+                        &bag_operations<BAG>::copy,
+                        &bag_operations<BAG>::move,
+                        &bag_operations<BAG>::clear,
+                        &bag_operations<BAG>::size,
+                        &bag_operations<BAG>::bytes,
+                        &bag_operations<BAG>::append,
+                        &bag_operations<BAG>::move_into,
+                        &bag_operations<BAG>::to_string
+                };
+                return &v;
+            }
+
+            const vtable* _vtable = nullptr;
+            storage _storage;
+
+            template<typename T>
+            using if_bag = std::enable_if_t<!std::is_same<std::decay_t<T>, erased_bag>::value>;
+
+            void check_same_type(const erased_bag& other) const {
+                if (_vtable != other._vtable) {
+                    throw bad_bag_cast();
+                }
+            }
+
+        public:
+            erased_bag() noexcept = default;
+
+            template<typename BAG, typename = if_bag<BAG>>
+            erased_bag(BAG&& bag) {
+                emplace<std::decay_t<BAG>>(std::forward<BAG>(bag));
+            }
+
+            erased_bag(const erased_bag& other) {
+                if (other._vtable != nullptr) {
+                    other._vtable->copy(other._storage, _storage);
+                    _vtable = other._vtable;
+                }
+            }
+
+            erased_bag(erased_bag&& other) noexcept {
+                if (other._vtable != nullptr) {
+                    other._vtable->move(other._storage, _storage);
+                    _vtable = other._vtable;
+                    other._vtable = nullptr;
+                }
+            }
+
+            ~erased_bag() {
+                reset();
+            }
+
+            erased_bag& operator=(const erased_bag& other) {
+                if (this != &other) {
+                    erased_bag copy(other);
+                    *this = std::move(copy);
+                }
+                return *this;
+            }
+
+            erased_bag& operator=(erased_bag&& other) noexcept {
+                if (this != &other) {
+                    reset();
+                    if (other._vtable != nullptr) {
+                        other._vtable->move(other._storage, _storage);
+                        _vtable = other._vtable;
+                        other._vtable = nullptr;
+                    }
+                }
+                return *this;
+            }
+
+            template<typename BAG, typename = if_bag<BAG>>
+            erased_bag& operator=(BAG&& bag) {
+                emplace<std::decay_t<BAG>>(std::forward<BAG>(bag));
+                return *this;
+            }
+
+            /**
+             * @brief Replaces the bag by a BAG constructed from args.
+             */
+            template<typename BAG, typename... ARGS>
+            BAG& emplace(ARGS&&... args) {
+                reset();
+                storage_of<BAG>::construct(_storage, std::forward<ARGS>(args)...);
+                _vtable = vtable_of<BAG>();
+                return *storage_of<BAG>::get(_storage);
+            }
+
+            /**
+             * @brief Destroys the bag, the erased_bag is left empty.
+             */
+            void reset() noexcept {
+                if (_vtable != nullptr) {
+                    _vtable->destroy(_storage);
+                    _vtable = nullptr;
+                }
+            }
+
+            void swap(erased_bag& other) noexcept {
+                erased_bag tmp(std::move(other));
+                other = std::move(*this);
+                *this = std::move(tmp);
+            }
+
+            /**
+             * @return true if there is no bag, an empty bag of messages is not an empty erased_bag.
+             */
+            bool empty() const noexcept {
+                return _vtable == nullptr;
+            }
+
+            template<typename BAG>
+            bool holds() const noexcept {
+                return _vtable == vtable_of<BAG>();
+            }
+
+            /**
+             * @return the bag if it is a BAG, nullptr otherwise.
+             */
+            template<typename BAG>
+            BAG* get() noexcept {
+                return holds<BAG>() ? storage_of<BAG>::get(_storage) : nullptr;
+            }
+
+            template<typename BAG>
+            const BAG* get() const noexcept {
+                return holds<BAG>() ? storage_of<BAG>::get(_storage) : nullptr;
+            }
+
+            /**
+             * @return the number of messages in the bag, 0 if there is no bag.
+             */
+            std::size_t messages_size() const noexcept {
+                return _vtable == nullptr ? 0 : _vtable->size(_storage);
+            }
+
+            /**
+             * @brief The bytes the bag allocated, with the bag itself when it is not stored inline.
+             */
+            std::size_t allocated_bytes() const noexcept {
+                return _vtable == nullptr ? 0 : _vtable->bytes(_storage);
+            }
+
+            /**
+             * @brief Removes the messages as message_bag::clear does.
+             * @return true if the bag kept its capacity.
+             */
+            bool clear_messages() noexcept {
+                return _vtable != nullptr && _vtable->clear(_storage);
+            }
+
+            /**
+             * @brief Appends a copy of the messages of a bag of the same type, or copies it if there is no bag.
+             */
+            void append_messages_from(const erased_bag& other) {
+                if (other._vtable == nullptr) {
+                    return;
+                }
+                if (_vtable == nullptr) {
+                    *this = other;
+                    return;
+                }
+                check_same_type(other);
+                _vtable->append(other._storage, _storage);
+            }
+
+            /**
+             * @brief Appends the messages to the bag of the same type to, or moves the bag if to has no bag. The
+             * messages of this bag are left empty.
+             */
+            void move_messages_into(erased_bag& to) {
+                if (_vtable == nullptr || this == &to) {
+                    return;
+                }
+                if (to._vtable == nullptr) {
+                    _vtable->construct_empty(to._storage);
+                    to._vtable = _vtable;
+                }
+                check_same_type(to);
+                _vtable->move_into(_storage, to._storage);
+            }
+
+            /**
+             * @return the messages of the bag printed as cadmium::logger::implode does, an empty string if
+             * there is no bag.
+             */
+            std::string messages_as_string() const {
+                return _vtable == nullptr ? std::string() : _vtable->to_string(_storage);
+            }
+        };
+
+        /**
+         * @brief Casts an erased_bag as boost::any_cast casts a boost::any.
+         * @return the bag if it is a BAG, nullptr otherwise.
+         */
+        template<typename BAG>
+        BAG* bag_cast(erased_bag* b) noexcept {
+            return b == nullptr ? nullptr : b->template get<BAG>();
+        }
+
+        template<typename BAG>
+        const BAG* bag_cast(const erased_bag* b) noexcept {
+            return b == nullptr ? nullptr : b->template get<BAG>();
+        }
+
+        /**
+         * @brief Casts an erased_bag to a BAG, a BAG& or a const BAG&.
+         * @throw bad_bag_cast if the bag is not a BAG.
+         */
+        template<typename T>
+        T bag_cast(erased_bag& b) {
+            using bag_type = std::remove_cv_t<std::remove_reference_t<T>>;
+            bag_type* ret = b.template get<bag_type>();
+            if (ret == nullptr) {
+                throw bad_bag_cast();
+            }
+            return static_cast<T>(*ret);
+        }
+
+        template<typename T>
+        T bag_cast(const erased_bag& b) {
+            using bag_type = std::remove_cv_t<std::remove_reference_t<T>>;
+            static_assert(!std::is_lvalue_reference<T>::value || std::is_const<std::remove_reference_t<T>>::value,
+                          "A const erased_bag can only be cast to a const reference");
+            const bag_type* ret = b.template get<bag_type>();
+            if (ret == nullptr) {
+                throw bad_bag_cast();
+            }
+            return static_cast<T>(*ret);
+        }
+
+        inline void swap(erased_bag& a, erased_bag& b) noexcept {
+            a.swap(b);
+        }
+    }
+}
+
+#endif //CADMIUM_DYNAMIC_ERASED_BAG_HPP
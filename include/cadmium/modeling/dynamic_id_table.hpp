@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_DYNAMIC_ID_TABLE_HPP
+#define CADMIUM_DYNAMIC_ID_TABLE_HPP
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace modeling {
+
+            // the integer handle of an interned model id
+            using model_handle = std::uint32_t;
+
+            /**
+             * @brief The table of the interned model ids. An id is interned once, when its engine is built,
+             * then the engines compare and index the models by their handles instead of hashing their ids.
+             * The handles are given in interning order, the same id always has the same handle in a process.
+             *
+             * The interned ids are never removed, their references stay valid until the end of the process.
+             */
+            class id_table {
+                mutable std::mutex _mutex;
+                std::deque<std::string> _names; // a deque does not move the strings when it grows
+                std::unordered_map<std::string, model_handle> _handles;
+
+                id_table() = default;
+
+            public:
+                static id_table& instance() {
+                    static id_table table;
+                    return table;
+                }
+
+                model_handle intern(const std::string& id) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    auto it = _handles.find(id);
+                    if (it != _handles.end()) {
+                        return it->second;
+                    }
+                    model_handle handle = static_cast<model_handle>(_names.size());
+                    _names.push_back(id);
+                    _handles.emplace(id, handle);
+                    return handle;
+                }
+
+                /**
+                 * @return the id interned with handle.
+                 * @throw std::out_of_range if no id has the handle.
+                 */
+                const std::string& name(model_handle handle) const {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    if (handle >= _names.size()) {
+                        throw std::out_of_range("There is no model id with handle " + std::to_string(handle));
+                    }
+                    return _names[handle];
+                }
+
+                std::size_t size() const {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    return _names.size();
+                }
+            };
+
+            inline model_handle intern_id(const std::string& id) {
+                return id_table::instance().intern(id);
+            }
+        }
+    }
+}
+
+#endif // CADMIUM_DYNAMIC_ID_TABLE_HPP
@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2017, Laouen M. L. Belloli
+ * Carleton University, Universidad de Buenos Aires
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_DYNAMIC_INPUT_VIEW_HPP
+#define CADMIUM_DYNAMIC_INPUT_VIEW_HPP
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <typeindex>
+#include <utility>
+#include <cadmium/modeling/message_bag.hpp>
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace modeling {
+
+            /**
+             * @brief Read access to the input messages of an atomic model directly over the bags of the engine
+             * inbox, without building the input_bags tuple.
+             *
+             * @details
+             * The bag of a port is looked up when it is asked for, so the cost of a transition is proportional to
+             * the ports it reads and not to the ports the model has. A model gets a view defining the transitions
+             * external_transition(TIME, const input_view<input_ports>&) and confluence_transition(TIME, const
+             * input_view<input_ports>&) besides the usual ones, which are still required by the atomic model
+             * concept and used by the non dynamic engine. The view is only valid during the transition.
+             *
+             * @tparam INPUT_PORTS The tuple of the model input ports.
+             */
+            template<typename INPUT_PORTS>
+            class input_view {
+                const cadmium::dynamic::message_bags& _bags;
+
+                template<typename PORT, std::size_t... Is>
+                static constexpr std::size_t index_of(std::index_sequence<Is...>) {
+                    return (std::size_t(0) + ... + (std::is_same<PORT, std::tuple_element_t<Is, INPUT_PORTS>>::value ? Is : 0));
+                }
+
+                template<typename PORT, std::size_t... Is>
+                static constexpr bool has_port(std::index_sequence<Is...>) {
+                    return (false || ... || std::is_same<PORT, std::tuple_element_t<Is, INPUT_PORTS>>::value);
+                }
+
+                using ports_sequence = std::make_index_sequence<std::tuple_size<INPUT_PORTS>::value>;
+
+            public:
+                template<typename PORT>
+                using messages_type = decltype(cadmium::message_bag<PORT>::messages);
+
+                explicit input_view(const cadmium::dynamic::message_bags& bags) noexcept : _bags(bags) {}
+
+                /**
+                 * @return the messages received in PORT, an empty bag if there is none.
+                 */
+                template<typename PORT>
+                const messages_type<PORT>& messages() const {
+                    static_assert(has_port<PORT>(ports_sequence{}), "The port is not an input port of the model");
+                    static const messages_type<PORT> no_messages;
+
+                    const erased_bag* b = find<PORT>();
+                    return b == nullptr ? no_messages : cadmium::dynamic::bag_cast<const cadmium::message_bag<PORT>&>(*b).messages;
+                }
+
+                /**
+                 * @return true if PORT received messages.
+                 */
+                template<typename PORT>
+                bool has_messages() const {
+                    static_assert(has_port<PORT>(ports_sequence{}), "The port is not an input port of the model");
+                    const erased_bag* b = find<PORT>();
+                    return b != nullptr && !cadmium::dynamic::bag_cast<const cadmium::message_bag<PORT>&>(*b).messages.empty();
+                }
+
+            private:
+                template<typename PORT>
+                const erased_bag* find() const {
+                    // the inbox of the simulators has the port I in the slot I
+                    constexpr std::size_t i = index_of<PORT>(ports_sequence{});
+                    if (i < _bags.slots() && _bags.port_in_slot(i) == cadmium::dynamic::port_key::of<PORT>()) {
+                        const erased_bag& b = _bags.slot(i);
+                        return _bags.may_have_bag(i) && !b.empty() ? &b : nullptr;
+                    }
+                    auto it = _bags.find(cadmium::dynamic::port_key::of<PORT>());
+                    return it == _bags.end() ? nullptr : &it->second;
+                }
+            };
+
+            /**
+             * @brief Tells if MODEL has an external transition taking an input_view.
+             */
+            template<typename MODEL, typename TIME, typename = void>
+            struct has_external_transition_view : std::false_type {};
+
+            template<typename MODEL, typename TIME>
+            struct has_external_transition_view<MODEL, TIME, std::void_t<decltype(std::declval<MODEL&>().external_transition(
+                    std::declval<TIME>(), std::declval<const input_view<typename MODEL::input_ports>&>()))>>
+                    : std::true_type {};
+
+            /**
+             * @brief Tells if MODEL has a confluence transition taking an input_view.
+             */
+            template<typename MODEL, typename TIME, typename = void>
+            struct has_confluence_transition_view : std::false_type {};
+
+            template<typename MODEL, typename TIME>
+            struct has_confluence_transition_view<MODEL, TIME, std::void_t<decltype(std::declval<MODEL&>().confluence_transition(
+                    std::declval<TIME>(), std::declval<const input_view<typename MODEL::input_ports>&>()))>>
+                    : std::true_type {};
+        }
+    }
+
+    template<typename PORT, typename INPUT_PORTS>
+    const decltype(message_bag<PORT>::messages) & get_messages(dynamic::modeling::input_view<INPUT_PORTS>& view){
+        return view.template messages<PORT>();
+    }
+
+    template<typename PORT, typename INPUT_PORTS>
+    const decltype(message_bag<PORT>::messages) & get_messages(const dynamic::modeling::input_view<INPUT_PORTS>& view){
+        return view.template messages<PORT>();
+    }
+}
+
+#endif // CADMIUM_DYNAMIC_INPUT_VIEW_HPP
@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_DYNAMIC_INSTANCE_PORTS_HPP
+#define CADMIUM_DYNAMIC_INSTANCE_PORTS_HPP
+
+#include <cstddef>
+#include <tuple>
+#include <ostream>
+#include <type_traits>
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/logger/common_loggers_helpers.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace modeling {
+
+            /**
+             * @brief A message to or from one instance of a model array, the instance is its index in the array.
+             */
+            template<typename MSG>
+            struct instance_message {
+                std::size_t instance;
+                MSG value;
+            };
+
+            template<typename MSG>
+            bool operator==(const instance_message<MSG>& a, const instance_message<MSG>& b) {
+                return a.instance == b.instance && a.value == b.value;
+            }
+
+            // the values without operator<< are printed as the logged messages
+            template<typename MSG>
+            std::ostream& operator<<(std::ostream& os, const instance_message<MSG>& m) {
+                os << m.instance << ":";
+                cadmium::logger::value_or_name<MSG>::print(os, m.value);
+                return os;
+            }
+
+            /**
+             * @brief The port of a model array for the PORT of its atomic model, its messages carry the index
+             * of the instance sending or receiving them.
+             */
+            template<typename PORT>
+            struct instance_port : public std::conditional_t<PORT::kind == cadmium::port_kind::in,
+                    cadmium::in_port<instance_message<typename PORT::message_type>>,
+                    cadmium::out_port<instance_message<typename PORT::message_type>>> {
+                using port_type = PORT;
+            };
+
+            template<typename PORTS>
+            struct make_instance_ports;
+
+            template<typename... PORTS>
+            struct make_instance_ports<std::tuple<PORTS...>> {
+                using type = std::tuple<instance_port<PORTS>...>;
+            };
+        }
+    }
+}
+
+#endif //CADMIUM_DYNAMIC_INSTANCE_PORTS_HPP
@@ -27,14 +27,390 @@
 #ifndef CADMIUM_DYNAMIC_MESSAGE_BAG_HPP
 #define CADMIUM_DYNAMIC_MESSAGE_BAG_HPP
 
-#include <boost/any.hpp>
-#include <map>
-#include <typeindex>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+#include <cadmium/modeling/dynamic_erased_bag.hpp>
+#include <cadmium/modeling/dynamic_port_key.hpp>
 
 namespace cadmium {
     namespace dynamic {
-        using message_bags = std::map<std::type_index, boost::any>;
+
+        /**
+         * @brief The message bags of a model by port key, see dynamic_port_key.hpp. The bags are kept in a contiguous array of
+         * slots, one by port, and the ports are usually assigned to the slots when the bags are created from the
+         * model ports, then looking for a bag visits a few consecutive slots and clearing the bags keeps the slots.
+         * A slot with an empty erased_bag has no bag, the iteration, find and size only see the slots with a bag.
+         *
+         * The bags are kept when clear() removes them, emptied but with their capacity (see message_bag::clear),
+         * and the next get_bag of the port reuses them.
+         *
+         * The interface is the subset of the std::map<port_key, erased_bag> interface used by the dynamic
+         * models and engines, and the slot methods allow accessing a bag by its slot index. The bags are read
+         * with bag_cast.
+         *
+         * A bitmask keeps the slots that may have a bag, every access that can give a bag to a slot sets its
+         * bit and clear() resets them all. Then the routing skips the slots without bag with a bit test, and
+         * clearing bags that got no bag costs nothing. The last bit stands for all the slots from 63.
+         */
+        class message_bags {
+        public:
+            using key_type = port_key;
+            using mapped_type = erased_bag;
+            using value_type = std::pair<const port_key, erased_bag>;
+            using size_type = std::size_t;
+
+            static constexpr size_type no_slot = static_cast<size_type>(-1);
+
+        private:
+            using slots_type = std::vector<value_type>;
+            slots_type _slots;
+
+            // the cleared bags by slot
+            std::vector<erased_bag> _spares;
+
+            // the slots that may have a bag, a superset of the slots with a bag
+            std::uint64_t _filled = 0;
+
+            static std::uint64_t slot_bit(size_type i) noexcept {
+                return std::uint64_t(1) << (i < 63 ? i : 63);
+            }
+
+            void mark(size_type i) noexcept {
+                _filled |= slot_bit(i);
+            }
+
+            size_type add_slot(const port_key& port) {
+                _slots.emplace_back(port, erased_bag());
+                _spares.emplace_back();
+                return _slots.size() - 1;
+            }
+
+            template<typename SLOT_IT, typename VALUE>
+            class basic_iterator {
+                template<typename, typename> friend class basic_iterator;
+
+                SLOT_IT _it;
+                SLOT_IT _end;
+
+                void skip_empty() {
+                    while (_it != _end && _it->second.empty()) {
+                        ++_it;
+                    }
+                }
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = VALUE;
+                using difference_type = std::ptrdiff_t;
+                using pointer = VALUE*;
+                using reference = VALUE&;
+
+                basic_iterator() = default;
+
+                basic_iterator(SLOT_IT it, SLOT_IT end)
+                : _it(it), _end(end) {
+                    skip_empty();
+                }
+
+                // iterators convert to const iterators
+                template<typename OTHER_IT, typename OTHER_VALUE, typename = std::enable_if_t<std::is_convertible<OTHER_IT, SLOT_IT>::value>>
+                basic_iterator(const basic_iterator<OTHER_IT, OTHER_VALUE>& other)
+                : _it(other._it), _end(other._end) {}
+
+                reference operator*() const {
+                    return *_it;
+                }
+
+                pointer operator->() const {
+                    return &*_it;
+                }
+
+                basic_iterator& operator++() {
+                    ++_it;
+                    skip_empty();
+                    return *this;
+                }
+
+                basic_iterator operator++(int) {
+                    basic_iterator ret = *this;
+                    ++(*this);
+                    return ret;
+                }
+
+                template<typename OTHER_IT, typename OTHER_VALUE>
+                bool operator==(const basic_iterator<OTHER_IT, OTHER_VALUE>& other) const {
+                    return _it == other._it;
+                }
+
+                template<typename OTHER_IT, typename OTHER_VALUE>
+                bool operator!=(const basic_iterator<OTHER_IT, OTHER_VALUE>& other) const {
+                    return _it != other._it;
+                }
+            };
+
+        public:
+            using iterator = basic_iterator<slots_type::iterator, value_type>;
+            using const_iterator = basic_iterator<slots_type::const_iterator, const value_type>;
+
+            message_bags() = default;
+
+            /**
+             * @brief Creates the bags with a slot by port, in the ports order and without bags.
+             */
+            explicit message_bags(const std::vector<port_key>& ports) {
+                _slots.reserve(ports.size());
+                for (const auto& p : ports) {
+                    _slots.emplace_back(p, erased_bag());
+                }
+                _spares.resize(_slots.size());
+            }
+
+            // copying bags only copies the slots with a bag
+            message_bags(const message_bags& other) {
+                *this = other;
+            }
+
+            message_bags(message_bags&&) = default;
+
+            // assigning bags keeps the slots, the ports of other without a slot are added at the end
+            message_bags& operator=(const message_bags& other) {
+                if (this != &other) {
+                    for (auto& s : _slots) {
+                        s.second.reset();
+                    }
+                    _filled = 0;
+                    for (const auto& s : other) {
+                        size_type i = ensure_slot(s.first);
+                        _slots[i].second = s.second;
+                        mark(i);
+                    }
+                }
+                return *this;
+            }
+
+            message_bags& operator=(message_bags&&) = default;
+
+            iterator begin() noexcept {
+                return iterator(_slots.begin(), _slots.end());
+            }
+
+            iterator end() noexcept {
+                return iterator(_slots.end(), _slots.end());
+            }
+
+            const_iterator begin() const noexcept {
+                return const_iterator(_slots.cbegin(), _slots.cend());
+            }
+
+            const_iterator end() const noexcept {
+                return const_iterator(_slots.cend(), _slots.cend());
+            }
+
+            const_iterator cbegin() const noexcept {
+                return begin();
+            }
+
+            const_iterator cend() const noexcept {
+                return end();
+            }
+
+            bool empty() const noexcept {
+                return _filled == 0 || begin() == end();
+            }
+
+            size_type size() const noexcept {
+                return static_cast<size_type>(std::distance(begin(), end()));
+            }
+
+            /**
+             * @brief The bytes allocated by the slots and the bags, counting the bags kept for reuse.
+             */
+            std::size_t allocated_bytes() const noexcept {
+                std::size_t ret = _slots.capacity() * sizeof(value_type) + _spares.capacity() * sizeof(erased_bag);
+                for (size_type i = 0; i < _slots.size(); i++) {
+                    ret += _slots[i].second.allocated_bytes() + _spares[i].allocated_bytes();
+                }
+                return ret;
+            }
+
+            /**
+             * @brief Removes all the bags keeping the slots, the bags are kept for reuse.
+             */
+            void clear() noexcept {
+                if (_filled == 0) {
+                    return;
+                }
+                for (size_type i = 0; i < _slots.size(); i++) {
+                    erased_bag& b = _slots[i].second;
+                    if (!may_have_bag(i) || b.empty()) {
+                        continue;
+                    }
+                    if (b.clear_messages()) {
+                        _spares[i] = std::move(b);
+                    }
+                    b.reset();
+                }
+                _filled = 0;
+            }
+
+            /**
+             * @brief The bag of the port, if there is none, an empty BAG is created reusing the last bag of the
+             * port removed by clear(). A slot is added if the port has no slot.
+             */
+            template<typename BAG>
+            BAG& get_bag(const port_key& port) {
+                return get_bag_in_slot<BAG>(ensure_slot(port));
+            }
+
+            /**
+             * @brief The bag in the slot i, if there is none, an empty BAG is created as get_bag does.
+             */
+            template<typename BAG>
+            BAG& get_bag_in_slot(size_type i) {
+                mark(i);
+                erased_bag& b = _slots[i].second;
+                if (b.empty()) {
+                    erased_bag& spare = _spares[i];
+                    if (spare.holds<BAG>()) {
+                        b = std::move(spare);
+                    } else {
+                        b.emplace<BAG>();
+                    }
+                }
+                return bag_cast<BAG&>(b);
+            }
+
+            /**
+             * @return the slot index of the port, no_slot if the port has no slot.
+             */
+            size_type slot_of(const port_key& port) const noexcept {
+                for (size_type i = 0; i < _slots.size(); i++) {
+                    if (_slots[i].first == port) {
+                        return i;
+                    }
+                }
+                return no_slot;
+            }
+
+            /**
+             * @brief The bag in a slot, an empty erased_bag if the slot has no bag.
+             */
+            erased_bag& slot(size_type i) {
+                mark(i);
+                return _slots[i].second;
+            }
+
+            const erased_bag& slot(size_type i) const {
+                return _slots[i].second;
+            }
+
+            const port_key& port_in_slot(size_type i) const {
+                return _slots[i].first;
+            }
+
+            size_type slots() const noexcept {
+                return _slots.size();
+            }
+
+            /**
+             * @return false if the slot i has no bag, true if it may have one.
+             */
+            bool may_have_bag(size_type i) const noexcept {
+                return (_filled & slot_bit(i)) != 0;
+            }
+
+            /**
+             * @return false if no slot has a bag, true if some may have one.
+             */
+            bool may_have_bags() const noexcept {
+                return _filled != 0;
+            }
+
+            /**
+             * @return the slot index of the port, a slot without bag is added if the port has no slot. The slot
+             * indexes do not change while the bags exist, they can be kept to access the bags by slot.
+             */
+            size_type ensure_slot(const port_key& port) {
+                size_type i = slot_of(port);
+                return i == no_slot ? add_slot(port) : i;
+            }
+
+            iterator find(const port_key& port) {
+                size_type i = slot_of(port);
+                if (i == no_slot || _slots[i].second.empty()) {
+                    return end();
+                }
+                return iterator(_slots.begin() + i, _slots.end());
+            }
+
+            const_iterator find(const port_key& port) const {
+                size_type i = slot_of(port);
+                if (i == no_slot || _slots[i].second.empty()) {
+                    return end();
+                }
+                return const_iterator(_slots.cbegin() + i, _slots.cend());
+            }
+
+            size_type count(const port_key& port) const {
+                return find(port) == end() ? 0 : 1;
+            }
+
+            erased_bag& at(const port_key& port) {
+                iterator it = find(port);
+                if (it == end()) {
+                    throw std::out_of_range("There is no message bag for the port");
+                }
+                return it->second;
+            }
+
+            const erased_bag& at(const port_key& port) const {
+                const_iterator it = find(port);
+                if (it == end()) {
+                    throw std::out_of_range("There is no message bag for the port");
+                }
+                return it->second;
+            }
+
+            /**
+             * @brief The bag of the port, an empty erased_bag to assign the bag if there is no bag. A slot is added
+             * if the port has no slot.
+             */
+            erased_bag& operator[](const port_key& port) {
+                size_type i = ensure_slot(port);
+                mark(i);
+                return _slots[i].second;
+            }
+
+            template<typename BAG>
+            std::pair<iterator, bool> emplace(const port_key& port, BAG&& bag) {
+                iterator it = find(port);
+                if (it != end()) {
+                    return std::make_pair(it, false);
+                }
+                (*this)[port] = std::forward<BAG>(bag);
+                return std::make_pair(find(port), true);
+            }
+
+            template<typename PAIR>
+            std::pair<iterator, bool> insert(PAIR&& value) {
+                return emplace(value.first, std::forward<PAIR>(value).second);
+            }
+
+            size_type erase(const port_key& port) {
+                iterator it = find(port);
+                if (it == end()) {
+                    return 0;
+                }
+                it->second.reset();
+                return 1;
+            }
+        };
     }
 }
 
-#endif //CADMIUM_DYNAMIC_MESSAGE_BAG_HPP
\ No newline at end of file
+#endif //CADMIUM_DYNAMIC_MESSAGE_BAG_HPP
@@ -27,11 +27,18 @@
 #ifndef CADMIUM_ATOMIC_HPP
 #define CADMIUM_ATOMIC_HPP
 
+#include <boost/any.hpp>
 #include <cadmium/modeling/dynamic_message_bag.hpp>
 #include <cadmium/engine/pdevs_dynamic_link.hpp>
 
 namespace cadmium {
     namespace dynamic {
+        namespace engine {
+            //forward declaration
+            template<typename TIME>
+            class engine;
+        }
+
         namespace modeling {
 
             struct EOC {
@@ -74,12 +81,12 @@ namespace cadmium {
                         : _from(other._from), _to(other._to), _link(other._link) {}
             };
 
-            using Ports = std::vector<std::type_index>;
+            using Ports = std::vector<cadmium::dynamic::port_key>;
             using EICs = std::vector<EIC>;
             using EOCs = std::vector<EOC>;
             using ICs = std::vector<IC>;
 
-            using initilizer_list_Ports = std::initializer_list<std::type_index>;
+            using initilizer_list_Ports = std::initializer_list<cadmium::dynamic::port_key>;
             using initializer_list_EOCs = std::initializer_list<EOC>;
             using initializer_list_EICs = std::initializer_list<EIC>;
             using initializer_list_ICs = std::initializer_list<IC>;
@@ -116,16 +123,67 @@ namespace cadmium {
                 // Logging purpose methods, also because the model type is needed for logging the
                 // state and message bags.
                 virtual std::string model_state_as_string() const = 0;
-                virtual std::string messages_by_port_as_string(cadmium::dynamic::message_bags outbox) const = 0;
+                virtual std::string messages_by_port_as_string(const cadmium::dynamic::message_bags& outbox) const = 0;
+
+                // State saving purpose methods, used by the engines that restore a previous model state.
+                // The state is the model state member, wrapped in a boost::any.
+                virtual boost::any get_state() const = 0;
+                virtual void set_state(const boost::any& state) = 0;
+
+                // Memory accounting purpose method, the bytes of the model state including the ones it allocates.
+                virtual std::size_t state_bytes() const = 0;
+
+                // Prototype purpose method, a copy of the model with its current state, see dynamic_model_prototype.hpp.
+                virtual std::shared_ptr<atomic_abstract<TIME>> clone() const = 0;
 
-                // atomic model methods
+                // Checkpoint purpose methods, the state is written and read with cadmium::state_serializer.
+                virtual void write_state(std::string& buffer) const = 0;
+                virtual void read_state(const char*& data, const char* end) = 0;
+
+                // Out of core purpose method, replaces the state by a default constructed one releasing the memory
+                // it allocates, see pdevs_dynamic_state_store.hpp. False if the state is kept, it can not be released.
+                virtual bool release_state() {
+                    return false;
+                }
+
+                // atomic model methods, the transitions consume the input messages of dynamic_bags.
                 virtual void internal_transition() = 0;
-                virtual void external_transition(TIME e, cadmium::dynamic::message_bags dynamic_bags) = 0;
-                virtual void confluence_transition(TIME e, cadmium::dynamic::message_bags dynamic_bags) = 0;
+                virtual void external_transition(TIME e, cadmium::dynamic::message_bags&& dynamic_bags) = 0;
+                virtual void confluence_transition(TIME e, cadmium::dynamic::message_bags&& dynamic_bags) = 0;
                 virtual dynamic::message_bags output() const = 0;
+
+                // the output messages added to the outbox, only the ports with messages get a bag.
+                virtual void output(dynamic::message_bags& outbox) const {
+                    for (auto& bag : output()) {
+                        outbox[bag.first] = std::move(bag.second);
+                    }
+                }
                 virtual TIME time_advance() const = 0;
             };
 
+            /**
+             * @brief Abstract class of the models simulated by an engine of their own, as a single node of the
+             * dynamic engine, like the static coupled models embedded by cadmium::dynamic::modeling::embedded.
+             *
+             * @tparam TIME - The class representing the model time.
+             */
+            template<typename TIME>
+            class embedded_abstract : public cadmium::dynamic::modeling::model {
+            public:
+                virtual std::string get_id() const override = 0;
+                virtual cadmium::dynamic::modeling::Ports get_input_ports() const override = 0;
+                virtual cadmium::dynamic::modeling::Ports get_output_ports() const override = 0;
+
+                // the engine simulating the model, each call creates a new one.
+                virtual std::shared_ptr<cadmium::dynamic::engine::engine<TIME>> make_engine() const = 0;
+
+                // a copy of the model for another simulation, nullptr by default as the models whose state is kept
+                // by their engines can be shared by the simulations, see dynamic_model_prototype.hpp.
+                virtual std::shared_ptr<embedded_abstract<TIME>> clone() const {
+                    return nullptr;
+                }
+            };
+
             using Models = std::vector<std::shared_ptr<cadmium::dynamic::modeling::model>>;
             using initializer_list_Models = std::initializer_list<std::shared_ptr<cadmium::dynamic::modeling::model>>;
         }
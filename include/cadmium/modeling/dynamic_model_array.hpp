@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_DYNAMIC_MODEL_ARRAY_HPP
+#define CADMIUM_DYNAMIC_MODEL_ARRAY_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+#include <cadmium/concept/atomic_model_assert.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_instance_ports.hpp>
+#include <cadmium/modeling/dynamic_models_helpers.hpp>
+#include <cadmium/engine/pdevs_dynamic_model_array_simulator.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace modeling {
+
+            /**
+             * @brief model_array makes many instances of the same atomic model a single submodel of the dynamic
+             * coupled models. The dynamic coordinators run it with a cadmium::dynamic::engine::model_array_simulator,
+             * the instances are kept in a single vector and their transitions run in a loop.
+             *
+             * The model array has an instance_port for each port of the atomic model, their messages carry the
+             * index of the instance receiving or sending them.
+             *
+             * @tparam ATOMIC - The atomic model type of the instances.
+             * @tparam TIME - The class representing the model time.
+             */
+            template<template<typename T> class ATOMIC, typename TIME>
+            class model_array : public cadmium::dynamic::modeling::embedded_abstract<TIME> {
+                using input_ports=typename make_instance_ports<typename ATOMIC<TIME>::input_ports>::type;
+                using output_ports=typename make_instance_ports<typename ATOMIC<TIME>::output_ports>::type;
+
+                std::string _id;
+                std::shared_ptr<std::vector<ATOMIC<TIME>>> _instances;
+
+            public:
+                using atomic_type=ATOMIC<TIME>;
+
+                model_array() = delete;
+
+                /**
+                 * @brief A model array of size default constructed instances.
+                 */
+                model_array(std::string id, std::size_t size)
+                : model_array(std::move(id), std::vector<ATOMIC<TIME>>(size)) {}
+
+                /**
+                 * @brief A model array of the instances, their states are the initial states.
+                 */
+                model_array(std::string id, std::vector<ATOMIC<TIME>> instances)
+                : _id(std::move(id)), _instances(std::make_shared<std::vector<ATOMIC<TIME>>>(std::move(instances))) {
+                    cadmium::concept::atomic_model_assert<ATOMIC>();
+                }
+
+                std::string get_id() const override {
+                    return _id;
+                }
+
+                cadmium::dynamic::modeling::Ports get_input_ports() const override {
+                    return cadmium::dynamic::modeling::create_dynamic_ports<input_ports>();
+                }
+
+                cadmium::dynamic::modeling::Ports get_output_ports() const override {
+                    return cadmium::dynamic::modeling::create_dynamic_ports<output_ports>();
+                }
+
+                /**
+                 * @brief The instances, their states are updated in place by the engine while simulated.
+                 */
+                const std::vector<ATOMIC<TIME>>& instances() const noexcept {
+                    return *_instances;
+                }
+
+                std::vector<ATOMIC<TIME>>& instances() noexcept {
+                    return *_instances;
+                }
+
+                /**
+                 * @brief A model array with a copy of the instances, as the engines share the instances of a model.
+                 */
+                std::shared_ptr<cadmium::dynamic::modeling::embedded_abstract<TIME>> clone() const override {
+                    if constexpr (std::is_copy_constructible<ATOMIC<TIME>>::value) {
+                        return std::make_shared<model_array>(_id, *_instances);
+                    } else {
+                        throw std::logic_error("The instances of the model array " + _id + " can not be copied");
+                    }
+                }
+
+                /**
+                 * @brief The engine simulates the instances of the model array, all its engines share them.
+                 */
+                std::shared_ptr<cadmium::dynamic::engine::engine<TIME>> make_engine() const override {
+                    return std::make_shared<cadmium::dynamic::engine::model_array_simulator<ATOMIC, TIME>>(_id, _instances);
+                }
+            };
+        }
+    }
+}
+
+#endif //CADMIUM_DYNAMIC_MODEL_ARRAY_HPP
@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_DYNAMIC_MODEL_FLATTENER_HPP
+#define CADMIUM_DYNAMIC_MODEL_FLATTENER_HPP
+
+#include <set>
+#include <map>
+#include <memory>
+#include <stdexcept>
+
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/engine/pdevs_dynamic_link.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace modeling {
+
+            /**
+             * @brief A coupled model expressed only by its atomic models. The ICs connect atomic models, the EICs
+             * go from the coupled model input ports to atomic models and the EOCs go from atomic models to the
+             * coupled model output ports.
+             */
+            struct flat_couplings {
+                Models _models;
+                EICs _eic;
+                EOCs _eoc;
+                ICs _ic;
+            };
+
+            template<typename TIME>
+            flat_couplings flatten_couplings(const std::shared_ptr<coupled<TIME>>& coupled_model) {
+                flat_couplings ret;
+                std::map<std::string, flat_couplings> flat_submodels; // flattened coupled submodels by id
+
+                for (const auto& m : coupled_model->_models) {
+                    std::shared_ptr<coupled<TIME>> m_coupled = std::dynamic_pointer_cast<coupled<TIME>>(m);
+                    if (m_coupled == nullptr) {
+                        ret._models.push_back(m);
+                    } else {
+                        flat_couplings flat_m = flatten_couplings<TIME>(m_coupled);
+                        ret._models.insert(ret._models.end(), flat_m._models.begin(), flat_m._models.end());
+                        ret._ic.insert(ret._ic.end(), flat_m._ic.begin(), flat_m._ic.end());
+                        flat_submodels.emplace(m_coupled->get_id(), std::move(flat_m));
+                    }
+                }
+
+                // EOCs of a flattened submodel that end in the from port of the link, composed with the link
+                auto sources = [&flat_submodels](const std::string& from, const std::shared_ptr<cadmium::dynamic::engine::link_abstract>& l) -> EOCs {
+                    auto it = flat_submodels.find(from);
+                    if (it == flat_submodels.end()) {
+                        return EOCs{EOC(from, l)};
+                    }
+                    EOCs ret;
+                    for (const auto& eoc : it->second._eoc) {
+                        if (eoc._link->to_port_key() == l->from_port_key()) {
+                            ret.emplace_back(eoc._from, eoc._link->compose(l));
+                        }
+                    }
+                    return ret;
+                };
+
+                // EICs of a flattened submodel that start in the to port of the link, composed with the link
+                auto destinations = [&flat_submodels](const std::string& to, const std::shared_ptr<cadmium::dynamic::engine::link_abstract>& l) -> EICs {
+                    auto it = flat_submodels.find(to);
+                    if (it == flat_submodels.end()) {
+                        return EICs{EIC(to, l)};
+                    }
+                    EICs ret;
+                    for (const auto& eic : it->second._eic) {
+                        if (eic._link->from_port_key() == l->to_port_key()) {
+                            ret.emplace_back(eic._to, l->compose(eic._link));
+                        }
+                    }
+                    return ret;
+                };
+
+                for (const auto& ic : coupled_model->_ic) {
+                    for (const auto& source : sources(ic._from, ic._link)) {
+                        for (const auto& destination : destinations(ic._to, source._link)) {
+                            ret._ic.emplace_back(source._from, destination._to, destination._link);
+                        }
+                    }
+                }
+
+                for (const auto& eic : coupled_model->_eic) {
+                    EICs flat_eic = destinations(eic._to, eic._link);
+                    ret._eic.insert(ret._eic.end(), flat_eic.begin(), flat_eic.end());
+                }
+
+                for (const auto& eoc : coupled_model->_eoc) {
+                    EOCs flat_eoc = sources(eoc._from, eoc._link);
+                    ret._eoc.insert(ret._eoc.end(), flat_eoc.begin(), flat_eoc.end());
+                }
+
+                return ret;
+            }
+
+            /**
+             * @brief Flattens a coupled model hierarchy into a single coupled model with the same id and ports
+             * containing only the atomic models of the hierarchy. All the couplings are resolved atomic to atomic
+             * so a message crosses a single link no matter how deep the original hierarchy is.
+             *
+             * @note Atomic models are identified by id in the flattened model, then the ids must be unique in the
+             * whole hierarchy.
+             *
+             * @param coupled_model - The top coupled model of the hierarchy.
+             * @return the flattened coupled model, the atomic models are shared with the original hierarchy.
+             */
+            template<typename TIME>
+            std::shared_ptr<coupled<TIME>> flatten(const std::shared_ptr<coupled<TIME>>& coupled_model) {
+                flat_couplings flat = flatten_couplings<TIME>(coupled_model);
+
+                std::set<std::string> ids;
+                for (const auto& m : flat._models) {
+                    if (!ids.insert(m->get_id()).second) {
+                        throw std::domain_error("Flattening a hierarchy with repeated atomic model id " + m->get_id());
+                    }
+                }
+
+                return std::make_shared<coupled<TIME>>(
+                        coupled_model->get_id(),
+                        flat._models,
+                        coupled_model->get_input_ports(),
+                        coupled_model->get_output_ports(),
+                        flat._eic,
+                        flat._eoc,
+                        flat._ic,
+                        false // the links of a checked hierarchy
+                );
+            }
+        }
+    }
+}
+
+#endif //CADMIUM_DYNAMIC_MODEL_FLATTENER_HPP
@@ -0,0 +1,514 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_DYNAMIC_MODEL_LOADER_HPP
+#define CADMIUM_DYNAMIC_MODEL_LOADER_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <stdexcept>
+#include <typeindex>
+#include <unordered_map>
+
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_atomic.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/mapped_file.hpp>
+#include <cadmium/engine/pdevs_dynamic_link.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace modeling {
+
+            /**
+             * The binary model structure format, written by write_model_structure and read by load_model_structure.
+             *
+             * The structure starts with the magic "CDMS", the format version and the number of strings, models,
+             * ports and couplings as 32 bits integers. Then:
+             * - strings: the offsets of the strings ends, then all the string bytes, padded to 4 bytes.
+             * - models: id, type and parent; the type of an atomic model is the name it is registered with and
+             *   the one of a coupled model is no_index. The first model is the top coupled model, with no_index
+             *   as parent, and the parents are before their submodels.
+             * - ports: coupled model, name and direction of the coupled models ports.
+             * - couplings: coupled model, kind, from model, from port, to model and to port. The coupled model
+             *   is the from model of its EICs and the to model of its EOCs.
+             * The ids, types and names are indexes of strings and the models are indexes of models.
+             *
+             * All the records are 32 bits integers in the byte order of the machine, then the structure is read
+             * in place from a file mapped in memory in the same architecture.
+             */
+            namespace model_structure {
+                constexpr char magic[4] = {'C', 'D', 'M', 'S'};
+                constexpr std::uint32_t version = 1;
+                constexpr std::uint32_t no_index = 0xFFFFFFFF;
+
+                enum port_direction : std::uint32_t { input_port = 0, output_port = 1 };
+                enum coupling_kind : std::uint32_t { eic = 0, eoc = 1, ic = 2 };
+
+                struct model_record {
+                    std::uint32_t id;
+                    std::uint32_t type;
+                    std::uint32_t parent;
+                };
+
+                struct port_record {
+                    std::uint32_t coupled;
+                    std::uint32_t name;
+                    std::uint32_t direction;
+                };
+
+                struct coupling_record {
+                    std::uint32_t coupled;
+                    std::uint32_t kind;
+                    std::uint32_t from_model;
+                    std::uint32_t from_port;
+                    std::uint32_t to_model;
+                    std::uint32_t to_port;
+                };
+
+                template<typename RECORD>
+                void write_record(std::string& buffer, const RECORD& r) {
+                    buffer.append(reinterpret_cast<const char*>(&r), sizeof(r));
+                }
+
+                template<typename RECORD>
+                RECORD read_record(const char*& data, const char* end) {
+                    RECORD ret;
+                    if (end - data < static_cast<std::ptrdiff_t>(sizeof(ret))) {
+                        throw std::domain_error("Truncated model structure");
+                    }
+                    std::memcpy(&ret, data, sizeof(ret));
+                    data += sizeof(ret);
+                    return ret;
+                }
+
+                struct link_key_hash {
+                    std::size_t operator()(const std::pair<cadmium::dynamic::port_key, cadmium::dynamic::port_key>& k) const noexcept {
+                        return std::hash<cadmium::dynamic::port_key>()(k.first) * 31 + std::hash<cadmium::dynamic::port_key>()(k.second);
+                    }
+                };
+            }
+
+            /**
+             * @brief The atomic model types, ports and links a model structure is made of, by name.
+             *
+             * The atomic models are made by the factories registered with their type name, the ports are
+             * registered with their name and the links with the pair of ports they connect, as the links of
+             * cadmium::dynamic::translate::make_link<PORT_FROM, PORT_TO>.
+             */
+            template<typename TIME>
+            class model_registry {
+                using atomic_factory = std::function<std::shared_ptr<atomic_abstract<TIME>>(const std::string&)>;
+                using link_key = std::pair<cadmium::dynamic::port_key, cadmium::dynamic::port_key>;
+
+                std::unordered_map<std::string, atomic_factory> _atomics;
+                // the atomic models types are recognized by the ATOMIC<TIME> they wrap, the names found are cached
+                std::vector<std::pair<std::string, std::function<bool(const model&)>>> _atomic_types;
+                mutable std::unordered_map<std::type_index, std::string> _atomic_names;
+                std::unordered_map<std::string, cadmium::dynamic::port_key> _ports;
+                std::unordered_map<cadmium::dynamic::port_key, std::string> _port_names;
+                std::unordered_map<link_key, std::function<std::shared_ptr<cadmium::dynamic::engine::link_abstract>()>, model_structure::link_key_hash> _links;
+
+            public:
+                template<template<typename T> class ATOMIC>
+                void register_atomic(const std::string& type_name) {
+                    _atomics[type_name] = [](const std::string& model_id) {
+                        return cadmium::dynamic::translate::make_dynamic_atomic_model<ATOMIC, TIME>(model_id);
+                    };
+                    _atomic_types.emplace_back(type_name, [](const model& m) {
+                        return dynamic_cast<const ATOMIC<TIME>*>(&m) != nullptr;
+                    });
+                    _atomic_names.clear();
+                }
+
+                template<typename PORT>
+                void register_port(const std::string& name) {
+                    _ports.insert_or_assign(name, cadmium::dynamic::port_key::of<PORT>());
+                    _port_names.insert_or_assign(cadmium::dynamic::port_key::of<PORT>(), name);
+                }
+
+                template<typename PORT_FROM, typename PORT_TO>
+                void register_link() {
+                    _links[link_key(cadmium::dynamic::port_key::of<PORT_FROM>(), cadmium::dynamic::port_key::of<PORT_TO>())] = &cadmium::dynamic::translate::make_link<PORT_FROM, PORT_TO>;
+                }
+
+                std::shared_ptr<atomic_abstract<TIME>> make_atomic(const std::string& type_name, const std::string& model_id) const {
+                    auto it = _atomics.find(type_name);
+                    if (it == _atomics.end()) {
+                        throw std::domain_error("The atomic model type " + type_name + " is not registered");
+                    }
+                    return it->second(model_id);
+                }
+
+                cadmium::dynamic::port_key port(const std::string& name) const {
+                    auto it = _ports.find(name);
+                    if (it == _ports.end()) {
+                        throw std::domain_error("The port " + name + " is not registered");
+                    }
+                    return it->second;
+                }
+
+                std::shared_ptr<cadmium::dynamic::engine::link_abstract> make_link(const cadmium::dynamic::port_key& from, const cadmium::dynamic::port_key& to) const {
+                    auto it = _links.find(link_key(from, to));
+                    if (it == _links.end()) {
+                        throw std::domain_error("There is no link registered from port " + _port_names.at(from) + " to port " + _port_names.at(to));
+                    }
+                    return it->second();
+                }
+
+                /**
+                 * @brief The name of the type of an atomic model, the first type registered it is an instance of.
+                 */
+                const std::string& atomic_type_name(const model& m) const {
+                    auto it = _atomic_names.find(typeid(m));
+                    if (it == _atomic_names.end()) {
+                        auto type = std::find_if(_atomic_types.begin(), _atomic_types.end(), [&m](const auto& t) { return t.second(m); });
+                        if (type == _atomic_types.end()) {
+                            throw std::domain_error("The type of the atomic model " + m.get_id() + " is not registered");
+                        }
+                        it = _atomic_names.emplace(typeid(m), type->first).first;
+                    }
+                    return it->second;
+                }
+
+                const std::string& port_name(const cadmium::dynamic::port_key& port) const {
+                    auto it = _port_names.find(port);
+                    if (it == _port_names.end()) {
+                        throw std::domain_error(std::string("The port ") + port.type().name() + " is not registered");
+                    }
+                    return it->second;
+                }
+            };
+
+            namespace model_structure {
+
+                template<typename TIME>
+                class writer {
+                    const model_registry<TIME>& _registry;
+                    std::vector<std::string> _strings;
+                    std::unordered_map<std::string, std::uint32_t> _string_indexes;
+                    std::vector<model_record> _models;
+                    std::vector<port_record> _ports;
+                    std::vector<coupling_record> _couplings;
+
+                    std::uint32_t string_index(const std::string& s) {
+                        auto it = _string_indexes.emplace(s, static_cast<std::uint32_t>(_strings.size()));
+                        if (it.second) {
+                            _strings.push_back(s);
+                        }
+                        return it.first->second;
+                    }
+
+                    std::uint32_t port_index(const cadmium::dynamic::port_key& port) {
+                        return string_index(_registry.port_name(port));
+                    }
+
+                    void add_coupled(const coupled<TIME>& c, std::uint32_t index) {
+                        for (const auto& p : c._input_ports) {
+                            _ports.push_back(port_record{index, port_index(p), input_port});
+                        }
+                        for (const auto& p : c._output_ports) {
+                            _ports.push_back(port_record{index, port_index(p), output_port});
+                        }
+
+                        std::unordered_map<std::string, std::uint32_t> submodels;
+                        std::vector<std::pair<const coupled<TIME>*, std::uint32_t>> coupleds;
+                        for (const auto& m : c._models) {
+                            std::uint32_t m_index = static_cast<std::uint32_t>(_models.size());
+                            submodels.emplace(m->get_id(), m_index);
+                            const coupled<TIME>* m_coupled = dynamic_cast<const coupled<TIME>*>(m.get());
+                            if (m_coupled != nullptr) {
+                                _models.push_back(model_record{string_index(m->get_id()), no_index, index});
+                                coupleds.emplace_back(m_coupled, m_index);
+                            } else {
+                                _models.push_back(model_record{string_index(m->get_id()), string_index(_registry.atomic_type_name(*m)), index});
+                            }
+                        }
+
+                        for (const auto& eic : c._eic) {
+                            _couplings.push_back(coupling_record{index, model_structure::eic, index, port_index(eic._link->from_port_key()), submodels.at(eic._to), port_index(eic._link->to_port_key())});
+                        }
+                        for (const auto& eoc : c._eoc) {
+                            _couplings.push_back(coupling_record{index, model_structure::eoc, submodels.at(eoc._from), port_index(eoc._link->from_port_key()), index, port_index(eoc._link->to_port_key())});
+                        }
+                        for (const auto& ic : c._ic) {
+                            _couplings.push_back(coupling_record{index, model_structure::ic, submodels.at(ic._from), port_index(ic._link->from_port_key()), submodels.at(ic._to), port_index(ic._link->to_port_key())});
+                        }
+
+                        // the submodels of the submodels are after all the submodels, their parents are before them
+                        for (const auto& sub : coupleds) {
+                            add_coupled(*sub.first, sub.second);
+                        }
+                    }
+
+                public:
+                    explicit writer(const model_registry<TIME>& registry) : _registry(registry) {}
+
+                    void write(const coupled<TIME>& top, std::string& buffer) {
+                        _models.push_back(model_record{string_index(top.get_id()), no_index, no_index});
+                        add_coupled(top, 0);
+
+                        buffer.append(magic, sizeof(magic));
+                        write_record<std::uint32_t>(buffer, version);
+                        write_record<std::uint32_t>(buffer, static_cast<std::uint32_t>(_strings.size()));
+                        write_record<std::uint32_t>(buffer, static_cast<std::uint32_t>(_models.size()));
+                        write_record<std::uint32_t>(buffer, static_cast<std::uint32_t>(_ports.size()));
+                        write_record<std::uint32_t>(buffer, static_cast<std::uint32_t>(_couplings.size()));
+
+                        std::uint32_t end = 0;
+                        write_record<std::uint32_t>(buffer, end);
+                        for (const auto& s : _strings) {
+                            end += static_cast<std::uint32_t>(s.size());
+                            write_record<std::uint32_t>(buffer, end);
+                        }
+                        for (const auto& s : _strings) {
+                            buffer.append(s);
+                        }
+                        buffer.append((4 - end % 4) % 4, '\0');
+
+                        for (const auto& r : _models) {
+                            write_record(buffer, r);
+                        }
+                        for (const auto& r : _ports) {
+                            write_record(buffer, r);
+                        }
+                        for (const auto& r : _couplings) {
+                            write_record(buffer, r);
+                        }
+                    }
+                };
+            }
+
+            /**
+             * @brief Writes the structure of the model hierarchy in buffer, see model_structure.
+             * The atomic models types and the ports of the links must be registered in registry.
+             */
+            template<typename TIME>
+            void write_model_structure(const coupled<TIME>& top, const model_registry<TIME>& registry, std::string& buffer) {
+                model_structure::writer<TIME>(registry).write(top, buffer);
+            }
+
+            /**
+             * @brief Builds the model hierarchy described by the structure in data, see model_structure.
+             *
+             * The atomic models are made by the factories of registry, and each pair of ports of the links is
+             * looked up once in registry, all the couplings between the same ports share the same link.
+             *
+             * @param validate_links - if false, the coupled models do not check their links, for structures
+             * written from a valid hierarchy.
+             */
+            template<typename TIME>
+            std::shared_ptr<coupled<TIME>> load_model_structure(const char* data, std::size_t size, const model_registry<TIME>& registry, bool validate_links = true) {
+                using namespace model_structure;
+                const char* end = data + size;
+                if (size < sizeof(magic) || std::memcmp(data, magic, sizeof(magic)) != 0) {
+                    throw std::domain_error("Not a model structure");
+                }
+                data += sizeof(magic);
+                if (read_record<std::uint32_t>(data, end) != version) {
+                    throw std::domain_error("Unsupported model structure version");
+                }
+                const std::uint32_t strings = read_record<std::uint32_t>(data, end);
+                const std::uint32_t models = read_record<std::uint32_t>(data, end);
+                const std::uint32_t ports = read_record<std::uint32_t>(data, end);
+                const std::uint32_t couplings = read_record<std::uint32_t>(data, end);
+
+                // the strings are read in place
+                if (static_cast<std::uint64_t>(end - data) < (static_cast<std::uint64_t>(strings) + 1) * sizeof(std::uint32_t)) {
+                    throw std::domain_error("Truncated model structure");
+                }
+                const char* offsets = data;
+                data += (static_cast<std::size_t>(strings) + 1) * sizeof(std::uint32_t);
+                auto offset = [offsets](std::uint32_t i) {
+                    std::uint32_t ret;
+                    std::memcpy(&ret, offsets + i * sizeof(std::uint32_t), sizeof(ret));
+                    return ret;
+                };
+                const std::uint32_t chars = offset(strings);
+                if (static_cast<std::uint64_t>(end - data) < chars + (4 - chars % 4) % 4) {
+                    throw std::domain_error("Truncated model structure");
+                }
+                const char* blob = data;
+                data += chars + (4 - chars % 4) % 4;
+                auto string_at = [&](std::uint32_t i) {
+                    if (i >= strings || offset(i) > offset(i + 1) || offset(i + 1) > chars) {
+                        throw std::domain_error("Invalid string in model structure");
+                    }
+                    return std::string(blob + offset(i), offset(i + 1) - offset(i));
+                };
+
+                if (static_cast<std::uint64_t>(end - data) != static_cast<std::uint64_t>(models) * sizeof(model_record) + static_cast<std::uint64_t>(ports) * sizeof(port_record) + static_cast<std::uint64_t>(couplings) * sizeof(coupling_record)) {
+                    throw std::domain_error("Invalid model structure size");
+                }
+                if (models == 0) {
+                    throw std::domain_error("The model structure has no top model");
+                }
+
+                // the parts of each coupled model, indexed by coupled_of
+                struct coupled_parts {
+                    std::vector<std::uint32_t> submodels;
+                    Ports input_ports;
+                    Ports output_ports;
+                    EICs eics;
+                    EOCs eocs;
+                    ICs ics;
+                };
+                std::vector<model_record> records(models);
+                std::vector<std::shared_ptr<model>> built(models);
+                std::vector<std::uint32_t> coupled_of(models, no_index);
+                std::vector<coupled_parts> parts;
+                // the atomic factories are looked up once by type
+                std::unordered_map<std::uint32_t, std::string> type_names;
+
+                for (std::uint32_t i = 0; i < models; i++) {
+                    model_record r = read_record<model_record>(data, end);
+                    if ((i == 0) != (r.parent == no_index) || (i != 0 && (r.parent >= i || coupled_of[r.parent] == no_index))) {
+                        throw std::domain_error("Invalid parent in model structure");
+                    }
+                    records[i] = r;
+                    if (r.type == no_index) {
+                        coupled_of[i] = static_cast<std::uint32_t>(parts.size());
+                        parts.emplace_back();
+                    } else {
+                        auto type = type_names.find(r.type);
+                        if (type == type_names.end()) {
+                            type = type_names.emplace(r.type, string_at(r.type)).first;
+                        }
+                        built[i] = registry.make_atomic(type->second, string_at(r.id));
+                    }
+                    if (i != 0) {
+                        parts[coupled_of[r.parent]].submodels.push_back(i);
+                    }
+                }
+                if (records[0].type != no_index) {
+                    throw std::domain_error("The top model of the model structure is not coupled");
+                }
+
+                auto coupled_parts_of = [&](std::uint32_t coupled) -> coupled_parts& {
+                    if (coupled >= models || coupled_of[coupled] == no_index) {
+                        throw std::domain_error("Invalid coupled model in model structure");
+                    }
+                    return parts[coupled_of[coupled]];
+                };
+                auto id_of = [&](std::uint32_t m) {
+                    if (m >= models) {
+                        throw std::domain_error("Invalid model in model structure");
+                    }
+                    return string_at(records[m].id);
+                };
+
+                std::unordered_map<std::uint32_t, cadmium::dynamic::port_key> port_types;
+                auto port_of = [&](std::uint32_t name) {
+                    auto it = port_types.find(name);
+                    if (it == port_types.end()) {
+                        it = port_types.emplace(name, registry.port(string_at(name))).first;
+                    }
+                    return it->second;
+                };
+
+                for (std::uint32_t i = 0; i < ports; i++) {
+                    port_record r = read_record<port_record>(data, end);
+                    coupled_parts& p = coupled_parts_of(r.coupled);
+                    if (r.direction == input_port) {
+                        p.input_ports.push_back(port_of(r.name));
+                    } else if (r.direction == output_port) {
+                        p.output_ports.push_back(port_of(r.name));
+                    } else {
+                        throw std::domain_error("Invalid port direction in model structure");
+                    }
+                }
+
+                // the links by pair of port names
+                std::unordered_map<std::uint64_t, std::shared_ptr<cadmium::dynamic::engine::link_abstract>> links;
+                auto link_of = [&](std::uint32_t from, std::uint32_t to) {
+                    auto it = links.find((static_cast<std::uint64_t>(from) << 32) | to);
+                    if (it == links.end()) {
+                        it = links.emplace((static_cast<std::uint64_t>(from) << 32) | to, registry.make_link(port_of(from), port_of(to))).first;
+                    }
+                    return it->second;
+                };
+
+                for (std::uint32_t i = 0; i < couplings; i++) {
+                    coupling_record r = read_record<coupling_record>(data, end);
+                    coupled_parts& p = coupled_parts_of(r.coupled);
+                    if (r.kind == eic) {
+                        p.eics.emplace_back(id_of(r.to_model), link_of(r.from_port, r.to_port));
+                    } else if (r.kind == eoc) {
+                        p.eocs.emplace_back(id_of(r.from_model), link_of(r.from_port, r.to_port));
+                    } else if (r.kind == ic) {
+                        p.ics.emplace_back(id_of(r.from_model), id_of(r.to_model), link_of(r.from_port, r.to_port));
+                    } else {
+                        throw std::domain_error("Invalid coupling kind in model structure");
+                    }
+                }
+
+                // the submodels are after their parents, the coupled models are built from the last one
+                for (std::uint32_t i = models; i-- > 0;) {
+                    if (coupled_of[i] == no_index) {
+                        continue;
+                    }
+                    coupled_parts& p = parts[coupled_of[i]];
+                    Models submodels;
+                    submodels.reserve(p.submodels.size());
+                    for (std::uint32_t m : p.submodels) {
+                        submodels.push_back(std::move(built[m]));
+                    }
+                    built[i] = std::make_shared<coupled<TIME>>(
+                            string_at(records[i].id),
+                            std::move(submodels),
+                            std::move(p.input_ports),
+                            std::move(p.output_ports),
+                            std::move(p.eics),
+                            std::move(p.eocs),
+                            std::move(p.ics),
+                            validate_links
+                    );
+                    p = coupled_parts();
+                }
+                return std::static_pointer_cast<coupled<TIME>>(built[0]);
+            }
+
+            /**
+             * @brief Builds the model hierarchy described by the structure in the file at path, the file is mapped
+             * in memory and read in place.
+             */
+            template<typename TIME>
+            std::shared_ptr<coupled<TIME>> load_model_structure_file(const std::string& path, const model_registry<TIME>& registry, bool validate_links = true) {
+                cadmium::dynamic::modeling::mapped_file file(path);
+                return load_model_structure<TIME>(file.data(), file.size(), registry, validate_links);
+            }
+        }
+    }
+}
+
+#endif //CADMIUM_DYNAMIC_MODEL_LOADER_HPP
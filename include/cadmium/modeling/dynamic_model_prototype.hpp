@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_DYNAMIC_MODEL_PROTOTYPE_HPP
+#define CADMIUM_DYNAMIC_MODEL_PROTOTYPE_HPP
+
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace modeling {
+
+            /**
+             * @brief A coupled model the variants of a parameter sweep are made from.
+             *
+             * The couplings and ports of the prototype are checked once, the coupled models of the variants
+             * copy the couplings sharing the link objects and skip the check. The atomic models keep their state
+             * and the simulation updates it in place, then each variant has copies of the atomic models of the
+             * prototype, made by copy construction in their initial state, and of the model arrays, while the
+             * embedded models whose state is kept by their engines are shared. The models whose parameters
+             * change are given by the variant, replacing the ones of the prototype.
+             *
+             * The prototype models are never simulated, a runner of the prototype itself would change their states.
+             */
+            template<typename TIME>
+            class model_prototype {
+            public:
+                // the models by path, the ids of the models from a submodel of the prototype to the model joined by /
+                using replacements = std::unordered_map<std::string, std::shared_ptr<cadmium::dynamic::modeling::model>>;
+
+            private:
+                std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> _prototype;
+
+                static bool same_interface(const cadmium::dynamic::modeling::model& a, const cadmium::dynamic::modeling::model& b) {
+                    return a.get_id() == b.get_id() && a.get_input_ports() == b.get_input_ports()
+                           && a.get_output_ports() == b.get_output_ports();
+                }
+
+                std::shared_ptr<cadmium::dynamic::modeling::model> instantiate(
+                        const std::shared_ptr<cadmium::dynamic::modeling::model>& m, const std::string& path,
+                        const replacements& variant, std::size_t& replaced) const {
+                    auto found = variant.find(path);
+                    if (found != variant.end()) {
+                        if (found->second == nullptr || !same_interface(*m, *found->second)) {
+                            throw std::domain_error("The replacement of " + path + " has not the id and ports of the model it replaces");
+                        }
+                        replaced++;
+                        return found->second;
+                    }
+                    if (auto a = std::dynamic_pointer_cast<cadmium::dynamic::modeling::atomic_abstract<TIME>>(m)) {
+                        return a->clone();
+                    }
+                    if (auto e = std::dynamic_pointer_cast<cadmium::dynamic::modeling::embedded_abstract<TIME>>(m)) {
+                        auto copy = e->clone();
+                        return copy == nullptr ? m : copy;
+                    }
+                    auto c = std::dynamic_pointer_cast<cadmium::dynamic::modeling::coupled<TIME>>(m);
+                    if (c == nullptr) {
+                        throw std::domain_error("The model " + path + " is not a model a prototype can copy");
+                    }
+                    cadmium::dynamic::modeling::Models models;
+                    models.reserve(c->_models.size());
+                    bool changed = false;
+                    for (const auto& sub : c->_models) {
+                        models.push_back(instantiate(sub, path + "/" + sub->get_id(), variant, replaced));
+                        changed = changed || models.back() != sub;
+                    }
+                    if (!changed) {
+                        return m;
+                    }
+                    return copy_coupled(*c, std::move(models));
+                }
+
+                static std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> copy_coupled(
+                        const cadmium::dynamic::modeling::coupled<TIME>& c, cadmium::dynamic::modeling::Models models) {
+                    // the couplings were checked with the prototype
+                    auto ret = std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
+                            c._id, std::move(models), c._input_ports, c._output_ports, c._eic, c._eoc, c._ic, false);
+                    ret->_lazy = c._lazy;
+                    return ret;
+                }
+
+            public:
+                explicit model_prototype(std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> prototype)
+                : _prototype(std::move(prototype)) {
+                    if (_prototype == nullptr) {
+                        throw std::domain_error("A model prototype needs a coupled model");
+                    }
+                }
+
+                /**
+                 * @brief A variant of the prototype, the models of the paths in variant replace the ones of the
+                 * prototype, with the same id and ports, and the others are copies of the prototype ones.
+                 */
+                std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> instantiate(const replacements& variant = replacements()) const {
+                    cadmium::dynamic::modeling::Models models;
+                    models.reserve(_prototype->_models.size());
+                    std::size_t replaced = 0;
+                    for (const auto& sub : _prototype->_models) {
+                        models.push_back(instantiate(sub, sub->get_id(), variant, replaced));
+                    }
+                    if (replaced != variant.size()) {
+                        throw std::domain_error("A variant replaces models the prototype does not have");
+                    }
+                    return copy_coupled(*_prototype, std::move(models));
+                }
+
+                const std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>>& prototype() const noexcept {
+                    return _prototype;
+                }
+            };
+        }
+    }
+}
+
+#endif //CADMIUM_DYNAMIC_MODEL_PROTOTYPE_HPP
@@ -52,24 +52,21 @@ namespace cadmium {
             cadmium::dynamic::modeling::Ports make_ports() {
                 cadmium::dynamic::modeling::Ports ret;
                 auto add_port = [&ret] (auto &p) -> void {
-                    std::type_index port_type_index = typeid(p);
-                    ret.push_back(port_type_index);
+                    ret.push_back(cadmium::dynamic::port_key::of<std::decay_t<decltype(p)>>());
                 };
                 PORTS ports;
                 cadmium::helper::for_each<PORTS>(ports, add_port);
                 return ret;
             }
 
-            template<typename TIME, typename EIC_TUPLE, size_t S>
+            template<typename TIME, typename CURRENT_IC>
             struct make_dynamic_ic_impl{
-                using current_IC=typename std::tuple_element<S-1, EIC_TUPLE>::type;
-
                 template<typename T>
-                using from_model=typename current_IC::template from_model<T>;
-                using from_port=typename current_IC::from_model_output_port;
+                using from_model=typename CURRENT_IC::template from_model<T>;
+                using from_port=typename CURRENT_IC::from_model_output_port;
                 template<typename T>
-                using to_model=typename current_IC::template to_model<T>;
-                using to_port=typename current_IC::to_model_input_port;
+                using to_model=typename CURRENT_IC::template to_model<T>;
+                using to_port=typename CURRENT_IC::to_model_input_port;
 
                 static void value(models_by_type& translated_models, cadmium::dynamic::modeling::ICs& ret) {
 
@@ -87,18 +84,15 @@ namespace cadmium {
 
                     std::shared_ptr<cadmium::dynamic::engine::link_abstract> new_link = cadmium::dynamic::translate::make_link<from_port, to_port>();
                     ret.emplace_back(from_id, to_id, new_link);
-
-                    //iterate
-                    make_dynamic_ic_impl<TIME, EIC_TUPLE, S-1>::value(translated_models, ret);
                 }
             };
 
-            template<typename TIME, typename IC_TUPLE>
-            struct make_dynamic_ic_impl<TIME, IC_TUPLE, 0>{
-                static void value(models_by_type& translated_models, cadmium::dynamic::modeling::ICs& ret){
-                    //do nothing
-                }
-            };
+            //the couplings are translated from the last to the first, as the recursive translation always did
+            template<typename TIME, typename IC_TUPLE, std::size_t... Is>
+            void make_dynamic_ics(models_by_type& translated_models, cadmium::dynamic::modeling::ICs& ret, std::index_sequence<Is...>) {
+                constexpr std::size_t last = sizeof...(Is) - 1;
+                (make_dynamic_ic_impl<TIME, typename std::tuple_element<last - Is, IC_TUPLE>::type>::value(translated_models, ret), ...);
+            }
 
             /**
              * @brief Constructs the correct cadmium::dynamic::modeling::ICs object from the original cadmium std::tuple<IC..> type
@@ -115,17 +109,16 @@ namespace cadmium {
             template <typename TIME, typename IC_TUPLE>
             cadmium::dynamic::modeling::ICs make_dynamic_ic(models_by_type& translated_models){
                 cadmium::dynamic::modeling::ICs ret;
-                make_dynamic_ic_impl<TIME, IC_TUPLE, std::tuple_size<IC_TUPLE>::value>::value(translated_models, ret);
+                make_dynamic_ics<TIME, IC_TUPLE>(translated_models, ret, std::make_index_sequence<std::tuple_size<IC_TUPLE>::value>{});
                 return ret;
             }
 
-            template<typename TIME, typename EIC_TUPLE, size_t S>
+            template<typename TIME, typename CURRENT_EIC>
             struct make_dynamic_eic_impl{
-                using current_EIC=typename std::tuple_element<S-1, EIC_TUPLE>::type;
-                using from_port=typename current_EIC::external_input_port;
+                using from_port=typename CURRENT_EIC::external_input_port;
                 template <typename T>
-                using to_model=typename current_EIC::template submodel<T>;
-                using to_port=typename current_EIC::submodel_input_port;
+                using to_model=typename CURRENT_EIC::template submodel<T>;
+                using to_port=typename CURRENT_EIC::submodel_input_port;
 
                 static void value(models_by_type& translated_models, cadmium::dynamic::modeling::EICs& ret) {
 
@@ -137,18 +130,14 @@ namespace cadmium {
 
                     std::shared_ptr<cadmium::dynamic::engine::link_abstract> new_link = cadmium::dynamic::translate::make_link<from_port, to_port>();
                     ret.emplace_back(to_id, new_link);
-
-                    //iterate
-                    make_dynamic_eic_impl<TIME, EIC_TUPLE, S-1>::value(translated_models, ret);
                 }
             };
 
-            template<typename TIME, typename EIC_TUPLE>
-            struct make_dynamic_eic_impl<TIME, EIC_TUPLE, 0>{
-                static void value(models_by_type& translated_models, cadmium::dynamic::modeling::EICs& ret){
-                    //do nothing
-                }
-            };
+            template<typename TIME, typename EIC_TUPLE, std::size_t... Is>
+            void make_dynamic_eics(models_by_type& translated_models, cadmium::dynamic::modeling::EICs& ret, std::index_sequence<Is...>) {
+                constexpr std::size_t last = sizeof...(Is) - 1;
+                (make_dynamic_eic_impl<TIME, typename std::tuple_element<last - Is, EIC_TUPLE>::type>::value(translated_models, ret), ...);
+            }
 
             /**
              * @brief Constructs the correct cadmium::dynamic::modeling::EICs object from the original cadmium std::tuple<EIC..> type
@@ -165,17 +154,16 @@ namespace cadmium {
             template <typename TIME, typename EIC_TUPLE>
             cadmium::dynamic::modeling::EICs make_dynamic_eic(models_by_type& translated_models){
                 cadmium::dynamic::modeling::EICs ret;
-                make_dynamic_eic_impl<TIME, EIC_TUPLE, std::tuple_size<EIC_TUPLE>::value>::value(translated_models, ret);
+                make_dynamic_eics<TIME, EIC_TUPLE>(translated_models, ret, std::make_index_sequence<std::tuple_size<EIC_TUPLE>::value>{});
                 return ret;
             }
 
-            template<typename TIME, typename EOC_TUPLE, size_t S>
+            template<typename TIME, typename CURRENT_EOC>
             struct make_dynamic_eoc_impl{
-                using current_EIC=typename std::tuple_element<S-1, EOC_TUPLE>::type;
-                using from_port=typename current_EIC::submodel_output_port;
+                using from_port=typename CURRENT_EOC::submodel_output_port;
                 template<typename T>
-                using from_model=typename current_EIC::template submodel<T>;
-                using to_port=typename current_EIC::external_output_port;
+                using from_model=typename CURRENT_EOC::template submodel<T>;
+                using to_port=typename CURRENT_EOC::external_output_port;
 
                 static void value(const models_by_type& translated_models, cadmium::dynamic::modeling::EOCs& ret) {
 
@@ -187,18 +175,14 @@ namespace cadmium {
 
                     std::shared_ptr<cadmium::dynamic::engine::link_abstract> new_link = cadmium::dynamic::translate::make_link<from_port, to_port>();
                     ret.emplace_back(from_id, new_link);
-
-                    //iterate
-                    make_dynamic_eoc_impl<TIME, EOC_TUPLE, S-1>::value(translated_models, ret);
                 }
             };
 
-            template<typename TIME, typename EOC_TUPLE>
-            struct make_dynamic_eoc_impl<TIME, EOC_TUPLE, 0> {
-                static void value(const models_by_type& translated_models, cadmium::dynamic::modeling::EOCs& ret){
-                    //do nothing
-                }
-            };
+            template<typename TIME, typename EOC_TUPLE, std::size_t... Is>
+            void make_dynamic_eocs(const models_by_type& translated_models, cadmium::dynamic::modeling::EOCs& ret, std::index_sequence<Is...>) {
+                constexpr std::size_t last = sizeof...(Is) - 1;
+                (make_dynamic_eoc_impl<TIME, typename std::tuple_element<last - Is, EOC_TUPLE>::type>::value(translated_models, ret), ...);
+            }
 
             /**
              * @brief Constructs the correct cadmium::dynamic::modeling::EOCs object from the original cadmium std::tuple<EOC..> type
@@ -215,7 +199,7 @@ namespace cadmium {
             template <class TIME, typename EOC_TUPLE>
             cadmium::dynamic::modeling::EOCs make_dynamic_eoc(const models_by_type& translated_models) {
                 cadmium::dynamic::modeling::EOCs ret;
-                make_dynamic_eoc_impl<TIME, EOC_TUPLE, std::tuple_size<EOC_TUPLE>::value>::value(translated_models, ret);
+                make_dynamic_eocs<TIME, EOC_TUPLE>(translated_models, ret, std::make_index_sequence<std::tuple_size<EOC_TUPLE>::value>{});
                 return ret;
             }
 
@@ -264,34 +248,30 @@ namespace cadmium {
                 return sp_model;
             }
 
-            template<typename TIME, template<typename T> class MT, template<template<typename T2> class M> class COUPLED_TRANSLATOR, size_t S>
+            template<typename TIME, template<typename T> class MT, template<template<typename T2> class M> class COUPLED_TRANSLATOR, std::size_t I>
             struct make_dynamic_models_impl{
                 template<typename P>
-                using current = typename std::tuple_element<S - 1, MT<P>>::type;
+                using current = typename std::tuple_element<I, MT<P>>::type;
                 using current_translator = typename std::conditional<cadmium::concept::is_atomic<current>::value(), make_dynamic_atomic_model_impl<current, TIME>, COUPLED_TRANSLATOR<current>>::type;
 
-                static void make_models(models_by_type &ret) {
+                static void make_model(models_by_type &ret) {
 
                     current_translator translator;
                     std::shared_ptr<cadmium::dynamic::modeling::model> sp_current = translator.make();
                     ret.emplace(typeid(current<TIME>), sp_current);
-
-                    make_dynamic_models_impl<TIME, MT, COUPLED_TRANSLATOR, S - 1>::make_models(ret);
                 }
             };
 
-            template<typename TIME, template<typename T> class MT, template<template<typename T2> class M> class COUPLED_TRANSLATOR>
-            struct make_dynamic_models_impl<TIME, MT, COUPLED_TRANSLATOR, 0>{
-
-                static void make_models(models_by_type &ret) {
-                    // nothing to do here;
-                }
-            };
+            template <typename TIME, template<typename T> class MT, template<template<typename T2> class M> class COUPLED_TRANSLATOR, std::size_t... Is>
+            void make_dynamic_models(models_by_type &ret, std::index_sequence<Is...>) {
+                constexpr std::size_t last = sizeof...(Is) - 1;
+                (make_dynamic_models_impl<TIME, MT, COUPLED_TRANSLATOR, last - Is>::make_model(ret), ...);
+            }
 
             template <typename TIME, template<typename T> class MT, template<template<typename T2> class M> class COUPLED_TRANSLATOR>
             models_by_type make_dynamic_models() {
                 models_by_type ret;
-                make_dynamic_models_impl<TIME, MT, COUPLED_TRANSLATOR, std::tuple_size<MT<TIME>>::value>::make_models(ret);
+                make_dynamic_models<TIME, MT, COUPLED_TRANSLATOR>(ret, std::make_index_sequence<std::tuple_size<MT<TIME>>::value>{});
                 return ret;
             }
 
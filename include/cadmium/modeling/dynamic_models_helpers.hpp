@@ -29,10 +29,16 @@
 
 #include <tuple>
 #include <typeindex>
-#include <boost/any.hpp>
 #include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <memory>
 #include <algorithm>
+#include <iterator>
+#include <utility>
+#include <type_traits>
 
 #include <cadmium/modeling/dynamic_message_bag.hpp>
 #include <cadmium/modeling/dynamic_model.hpp>
@@ -57,14 +63,14 @@ namespace cadmium {
              * @param bags - the cadmium::dynamic::bag with the messages
              */
             template<typename BST>
-            void print_dynamic_messages_by_port(std::ostream& os, cadmium::dynamic::message_bags& bags) {
+            void print_dynamic_messages_by_port(std::ostream& os, const cadmium::dynamic::message_bags& bags) {
 
                 int a = 0; // to dynamically count tuple index
                 auto print_messages_fold_expr = [&a, &bags, &os](auto b) -> void {
                     using port_type = decltype(b);
                     using bag_type = typename cadmium::message_bag<port_type>;
 
-                    if (bags.find(typeid(port_type)) == bags.cend()) {
+                    if (bags.find(cadmium::dynamic::port_key::of<port_type>()) == bags.cend()) {
                         // there is no messages in the port
                         return;
                     }
@@ -73,7 +79,7 @@ namespace cadmium {
                         os << ", ";
                     }
 
-                    bag_type& casted_bag = boost::any_cast<bag_type&>(bags.at(typeid(port_type)));
+                    const bag_type& casted_bag = cadmium::dynamic::bag_cast<const bag_type&>(bags.at(cadmium::dynamic::port_key::of<port_type>()));
                     os << boost::typeindex::type_id<port_type>().pretty_name();
                     os << ": ";
                     cadmium::logger::implode(os, casted_bag.messages);
@@ -100,7 +106,7 @@ namespace cadmium {
                     using bag_type = decltype(b);
                     using port_type = typename bag_type::port;
 
-                    bags[typeid(port_type)] = b;
+                    bags[cadmium::dynamic::port_key::of<port_type>()] = b;
                 };
                 BST bs;
                 cadmium::helper::for_each<BST>(bs, create_empty_bag);
@@ -117,8 +123,7 @@ namespace cadmium {
 
                 cadmium::dynamic::modeling::Ports ret;
                 auto create_empty_bag = [&ret](auto b) -> void {
-                    std::type_index port_type_index = typeid(decltype(b));
-                    ret.push_back(port_type_index);
+                    ret.push_back(cadmium::dynamic::port_key::of<decltype(b)>());
                 };
                 BST bs;
                 cadmium::helper::for_each<BST>(bs, create_empty_bag);
@@ -133,16 +138,15 @@ namespace cadmium {
              * @param bs  - The BST message bags that will be filled with the bags messages.
              */
             template<typename BST>
-            void fill_bags_from_map(cadmium::dynamic::message_bags &bags, BST &bs) {
+            void fill_bags_from_map(const cadmium::dynamic::message_bags &bags, BST &bs) {
 
                 auto add_messages_to_bag = [&bags, &bs](auto b) -> void {
                     using bag_type = decltype(b);
                     using port_type = typename bag_type::port;
 
-                    bag_type& current_bag = std::get<bag_type>(bs);
-
-                    if (bags.find(typeid(port_type)) != bags.end()) {
-                        bag_type b2 = boost::any_cast<bag_type>(bags.at(typeid(port_type)));
+                    auto it = bags.find(cadmium::dynamic::port_key::of<port_type>());
+                    if (it != bags.end()) {
+                        const bag_type& b2 = cadmium::dynamic::bag_cast<const bag_type&>(it->second);
                         auto& current_bag = cadmium::get_messages<port_type>(bs);
                         current_bag.insert(
                                 current_bag.end(),
@@ -155,7 +159,40 @@ namespace cadmium {
             }
 
             /**
-             * @brief Insert all the message bs of bags in bags by an implicit conversion of them to boost::any.
+             * @brief Moves all the messages of bags in the typed bs message bags, the bags messages are left empty.
+             *
+             * @tparam BST The message bag tuple to fill from the cadmium::dynamic::message_bags.
+             * @param bags - The cadmium::dynamic::message_bags that carries the message to be moved in the bs parameter.
+             * @param bs  - The BST message bags that will be filled with the bags messages.
+             */
+            template<typename BST>
+            void move_bags_from_map(cadmium::dynamic::message_bags &&bags, BST &bs) {
+
+                auto move_messages_to_bag = [&bags, &bs](auto b) -> void {
+                    using bag_type = decltype(b);
+                    using port_type = typename bag_type::port;
+
+                    auto it = bags.find(cadmium::dynamic::port_key::of<port_type>());
+                    if (it != bags.end()) {
+                        auto& b2 = cadmium::dynamic::bag_cast<bag_type&>(it->second).messages;
+                        auto& current_bag = cadmium::get_messages<port_type>(bs);
+                        if (current_bag.empty()) {
+                            current_bag.swap(b2);
+                        } else {
+                            current_bag.insert(
+                                    current_bag.end(),
+                                    std::make_move_iterator(b2.begin()),
+                                    std::make_move_iterator(b2.end())
+                            );
+                        }
+                        b2.clear();
+                    }
+                };
+                cadmium::helper::for_each<BST>(bs, move_messages_to_bag);
+            }
+
+            /**
+             * @brief Insert all the message bs of bags in bags by an implicit conversion of them to erased_bag.
              *
              * @tparam BST The message bag tuple that carries the messages to fill the cadmium::dynamic::message_bags.
              * @param bags - The dynamic_message_bag that will be filled with the bs messages.
@@ -168,79 +205,149 @@ namespace cadmium {
                     using bag_type = decltype(b);
                     using port_type = typename bag_type::port;
 
-                    bags[typeid(port_type)] = b;
+                    bags[cadmium::dynamic::port_key::of<port_type>()] = b;
                 };
                 cadmium::helper::for_each<BST>(bs, add_messages_to_map);
             }
 
-            bool is_in(const std::type_index &port, const Ports &ports) {
+            template<typename BST, std::size_t... Is>
+            void move_map_from_bags(BST &bs, cadmium::dynamic::message_bags &bags, std::index_sequence<Is...>) {
+
+                // not called for the models without output ports
+                [[maybe_unused]] auto move_messages_to_map = [&bags](std::size_t i, auto& b) -> void {
+                    using bag_type = std::decay_t<decltype(b)>;
+                    using port_type = typename bag_type::port;
+
+                    if (b.messages.empty()) {
+                        return;
+                    }
+                    // the bags made from the model ports have the port I in the slot I
+                    std::size_t slot = i < bags.slots() && bags.port_in_slot(i) == cadmium::dynamic::port_key::of<port_type>() ?
+                                       i : bags.ensure_slot(cadmium::dynamic::port_key::of<port_type>());
+                    auto& to_messages = bags.template get_bag_in_slot<bag_type>(slot).messages;
+                    if (to_messages.empty()) {
+                        to_messages.swap(b.messages);
+                    } else {
+                        to_messages.insert(
+                                to_messages.end(),
+                                std::make_move_iterator(b.messages.begin()),
+                                std::make_move_iterator(b.messages.end())
+                        );
+                    }
+                    b.messages.clear();
+                };
+                (move_messages_to_map(Is, std::get<Is>(bs)), ...);
+            }
+
+            /**
+             * @brief Moves the messages of the non-empty bags of bs in bags, the ports without messages get no bag.
+             * The bs messages are left empty, a bag of bags without messages takes the buffer of its bs bag.
+             *
+             * @tparam BST The message bag tuple that carries the messages to move in the cadmium::dynamic::message_bags.
+             * @param bs  - The BST message bags that carries the message to be moved in the bags parameter.
+             * @param bags - The dynamic_message_bag that will be filled with the bs messages.
+             */
+            template<typename BST>
+            void move_map_from_bags(BST &bs, cadmium::dynamic::message_bags &bags) {
+                move_map_from_bags(bs, bags, std::make_index_sequence<std::tuple_size<BST>::value>{});
+            }
+
+            inline bool is_in(const cadmium::dynamic::port_key &port, const Ports &ports) {
                 return std::find(ports.cbegin(), ports.cend(), port) != ports.cend();
             }
 
-            bool valid_ic_links(const Models &models, const ICs &ic) {
-                return std::all_of(ic.cbegin(), ic.cend(), [&models](const auto &link) -> bool {
-                    return std::find_if(models.cbegin(), models.cend(),
-                                        [&link](const auto &m) -> bool {
-                                            cadmium::dynamic::modeling::Ports output_ports = m->get_output_ports();
-                                            std::type_index from_port_type = link._link->from_port_type_index();
-                                            return m->get_id() == link._from &&
-                                                    std::find(
-                                                            output_ports.begin(),
-                                                            output_ports.end(),
-                                                            from_port_type
-                                                    ) != output_ports.end();
-                                        }) != models.cend() &&
-                           std::find_if(models.cbegin(), models.cend(),
-                                        [&link](const auto &m) -> bool {
-                                            cadmium::dynamic::modeling::Ports input_ports = m->get_input_ports();
-                                            std::type_index to_port_type = link._link->to_port_type_index();
-                                            return m->get_id() == link._to &&
-                                                   std::find(
-                                                           input_ports.begin(),
-                                                           input_ports.end(),
-                                                           to_port_type
-                                                   ) != input_ports.end();
-                                        }) != models.cend();
+            /**
+             * @brief The ports of the models by model id, built once to validate all the links of a coupled model.
+             * The ports of all the models are kept in a single vector, each model has the ranges of its input and
+             * output ports. The models sharing an id are chained.
+             */
+            class model_ports_index {
+                struct model_ports {
+                    std::size_t input_first;
+                    std::size_t output_first;
+                    std::size_t output_last;
+                    std::size_t next; // the next model with the same id
+                };
+                static constexpr std::size_t no_model = static_cast<std::size_t>(-1);
+
+                std::unordered_map<std::string, std::size_t> _models_by_id;
+                std::vector<model_ports> _models;
+                Ports _ports;
+
+            public:
+                explicit model_ports_index(const Models &models) {
+                    _models_by_id.reserve(models.size());
+                    _models.reserve(models.size());
+                    for (const auto &m : models) {
+                        model_ports p;
+                        p.input_first = _ports.size();
+                        Ports input = m->get_input_ports();
+                        _ports.insert(_ports.end(), input.begin(), input.end());
+                        p.output_first = _ports.size();
+                        Ports output = m->get_output_ports();
+                        _ports.insert(_ports.end(), output.begin(), output.end());
+                        p.output_last = _ports.size();
+                        p.next = no_model;
+
+                        auto it = _models_by_id.try_emplace(m->get_id(), _models.size());
+                        if (!it.second) {
+                            std::size_t last = it.first->second;
+                            while (_models[last].next != no_model) {
+                                last = _models[last].next;
+                            }
+                            _models[last].next = _models.size();
+                        }
+                        _models.push_back(p);
+                    }
+                }
+
+                // the models have a few ports, they are searched linearly
+                bool has_port(const std::string &model_id, const cadmium::dynamic::port_key &port, bool input) const {
+                    auto it = _models_by_id.find(model_id);
+                    for (std::size_t i = it == _models_by_id.end() ? no_model : it->second; i != no_model; i = _models[i].next) {
+                        auto first = _ports.begin() + (input ? _models[i].input_first : _models[i].output_first);
+                        auto last = _ports.begin() + (input ? _models[i].output_first : _models[i].output_last);
+                        if (std::find(first, last, port) != last) {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+            };
+
+            inline bool valid_ic_links(const model_ports_index &index, const ICs &ic) {
+                return std::all_of(ic.cbegin(), ic.cend(), [&index](const auto &link) -> bool {
+                    return index.has_port(link._from, link._link->from_port_key(), false) &&
+                           index.has_port(link._to, link._link->to_port_key(), true);
+                });
+            }
+
+            inline bool valid_eic_links(const model_ports_index &index, const Ports &input_ports, const EICs &eic) {
+                std::unordered_set<cadmium::dynamic::port_key> coupled_ports(input_ports.cbegin(), input_ports.cend());
+                return std::all_of(eic.cbegin(), eic.cend(), [&index, &coupled_ports](const auto &link) -> bool {
+                    return index.has_port(link._to, link._link->to_port_key(), true) &&
+                           coupled_ports.count(link._link->from_port_key()) != 0;
+                });
+            }
+
+            inline bool valid_eoc_links(const model_ports_index &index, const Ports &output_ports, const EOCs &eoc) {
+                std::unordered_set<cadmium::dynamic::port_key> coupled_ports(output_ports.cbegin(), output_ports.cend());
+                return std::all_of(eoc.cbegin(), eoc.cend(), [&index, &coupled_ports](const auto &link) -> bool {
+                    return index.has_port(link._from, link._link->from_port_key(), false) &&
+                           coupled_ports.count(link._link->to_port_key()) != 0;
                 });
             }
 
-            bool valid_eic_links(const Models &models, const Ports &input_ports, const EICs &eic) {
-                return std::all_of(eic.cbegin(), eic.cend(),
-                                   [&models, &input_ports](const auto &link) -> bool {
-                                       return std::find_if(
-                                               models.cbegin(), models.cend(),
-                                               [&link](const auto &m) -> bool {
-                                                   cadmium::dynamic::modeling::Ports input_ports = m->get_input_ports();
-                                                   std::type_index to_port_type = link._link->to_port_type_index();
-                                                   return m->get_id() == link._to &&
-                                                           std::find(
-                                                                   input_ports.begin(),
-                                                                   input_ports.end(),
-                                                                   to_port_type
-                                                           ) != input_ports.end();
-                                               }) != models.cend() &&
-                                              is_in(link._link->from_port_type_index(), input_ports);
-                                   });
+            inline bool valid_ic_links(const Models &models, const ICs &ic) {
+                return valid_ic_links(model_ports_index(models), ic);
+            }
+
+            inline bool valid_eic_links(const Models &models, const Ports &input_ports, const EICs &eic) {
+                return valid_eic_links(model_ports_index(models), input_ports, eic);
             }
 
-            bool valid_eoc_links(const Models &models, const Ports &output_ports, const EOCs &eoc) {
-                return std::all_of(eoc.cbegin(), eoc.cend(),
-                                   [&models, &output_ports](const auto &link) -> bool {
-                                       return std::find_if(
-                                               models.cbegin(),
-                                               models.cend(),
-                                               [&link](const auto &m) -> bool { // searches for a model with the same id and port
-                                                   cadmium::dynamic::modeling::Ports output_ports = m->get_output_ports();
-                                                   std::type_index from_port_type = link._link->from_port_type_index();
-                                                   return m->get_id() == link._from &&
-                                                           std::find(
-                                                                   output_ports.begin(),
-                                                                   output_ports.end(),
-                                                                   from_port_type
-                                                           ) != output_ports.end();
-                                               }) != models.cend() &&
-                                              is_in(link._link->to_port_type_index(), output_ports);
-                                   });
+            inline bool valid_eoc_links(const Models &models, const Ports &output_ports, const EOCs &eoc) {
+                return valid_eoc_links(model_ports_index(models), output_ports, eoc);
             }
         }
     }
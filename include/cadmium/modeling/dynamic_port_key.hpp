@@ -0,0 +1,296 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_DYNAMIC_PORT_KEY_HPP
+#define CADMIUM_DYNAMIC_PORT_KEY_HPP
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <typeinfo>
+#include <typeindex>
+#include <stdexcept>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+#include <boost/core/demangle.hpp>
+
+namespace cadmium {
+
+    // the integer id of a port, the same in all the binaries built from the same sources by the same compiler
+    using port_id = std::uint64_t;
+
+    namespace port_ids {
+
+        // 64 bits FNV-1a
+        constexpr port_id hash(std::string_view s) noexcept {
+            port_id ret = 0xcbf29ce484222325ull;
+            for (char c : s) {
+                ret ^= static_cast<unsigned char>(c);
+                ret *= 0x100000001b3ull;
+            }
+            return ret;
+        }
+
+        // the name of T as the compiler writes it in the signature of this function
+        template<typename T>
+        constexpr std::string_view type_name() noexcept {
+#if defined(__clang__)
+            constexpr std::string_view signature = __PRETTY_FUNCTION__;
+            constexpr std::size_t begin = signature.find("[T = ") + 5;
+            return signature.substr(begin, signature.rfind(']') - begin);
+#elif defined(__GNUC__)
+            constexpr std::string_view signature = __PRETTY_FUNCTION__;
+            constexpr std::size_t begin = signature.find("[with T = ") + 10;
+            return signature.substr(begin, signature.find(';', begin) - begin);
+#else
+            return __FUNCSIG__;
+#endif
+        }
+
+        // the types in an anonymous namespace have the same name in all the translation units defining them
+        constexpr bool internal_linkage(std::string_view name) noexcept {
+            return name.find("{anonymous}") != std::string_view::npos
+                || name.find("(anonymous namespace)") != std::string_view::npos
+                || name.find("`anonymous namespace'") != std::string_view::npos;
+        }
+    }
+
+    /**
+     * @brief The id of a port, used as its key by the dynamic bags and routing and written in the serialized
+     * data. It is the hash of the port type name by default, then it is known at compile time and it does not
+     * depend on the order the types are seen, as std::type_index does. Specialize it to register a fixed id:
+     *
+     *     template<> struct cadmium::port_identifier<my_port> : std::integral_constant<cadmium::port_id, 42> {};
+     *
+     * The ports declared in an anonymous namespace are not keyed by the hash of their name, two translation
+     * units may declare different ports with the same name there. Each one gets a free id when it is first
+     * keyed instead, different among the ports of the program but not stable from one run to the next.
+     *
+     * Two ports registered with the same id are reported when the first coordinator is built.
+     */
+    template<typename PORT>
+    struct port_identifier : std::integral_constant<port_id, port_ids::hash(port_ids::type_name<PORT>())> {
+        static constexpr bool hashed = true;
+    };
+
+    template<typename PORT>
+    constexpr port_id port_id_v = port_identifier<PORT>::value;
+
+    namespace port_ids {
+
+        // the ports without a registered id whose name may be reused by another translation unit
+        template<typename PORT, typename = void>
+        struct keyed_at_run_time : std::false_type {};
+
+        template<typename PORT>
+        struct keyed_at_run_time<PORT, std::void_t<decltype(port_identifier<PORT>::hashed)>>
+        : std::bool_constant<internal_linkage(type_name<PORT>())> {};
+    }
+
+    namespace dynamic {
+
+        /**
+         * @brief The ids of the port types, for the ports known only by their std::type_index at run time.
+         * The ports keyed from their type at compile time are registered when the program starts, the ports
+         * never keyed at compile time get the hash of their demangled name when they are first looked up.
+         *
+         * The registrations made when the program starts do not throw, a throw there would terminate the
+         * program before main. Their conflicts are kept and check() reports them.
+         */
+        class port_registry {
+            mutable std::mutex _mutex;
+            std::unordered_map<std::type_index, port_id> _ids;
+            std::unordered_map<port_id, std::type_index> _types;
+            std::vector<std::string> _conflicts;
+
+            port_registry() = default;
+
+            std::string conflict(const std::type_index& type, port_id id) const {
+                auto it = _types.find(id);
+                if (it != _types.end() && it->second != type) {
+                    return "Ports " + boost::core::demangle(it->second.name()) + " and " + boost::core::demangle(type.name()) + " have the same id";
+                }
+                auto registered = _ids.find(type);
+                if (registered != _ids.end() && registered->second != id) {
+                    return "Port " + boost::core::demangle(type.name()) + " was looked up before its id was registered";
+                }
+                return std::string();
+            }
+
+            port_id insert(const std::type_index& type, port_id id) {
+                std::string error = conflict(type, id);
+                if (!error.empty()) {
+                    throw std::domain_error(error);
+                }
+                _ids.emplace(type, id);
+                _types.emplace(id, type);
+                return id;
+            }
+
+            port_id insert_unique(const std::type_index& type) {
+                auto it = _ids.find(type);
+                if (it != _ids.end()) {
+                    return it->second;
+                }
+                port_id id = port_ids::hash(boost::core::demangle(type.name()));
+                while (_types.count(id) != 0) {
+                    id = id * 0x100000001b3ull + 1;
+                }
+                _ids.emplace(type, id);
+                _types.emplace(id, type);
+                return id;
+            }
+
+        public:
+            static port_registry& instance() {
+                static port_registry registry;
+                return registry;
+            }
+
+            port_id add(const std::type_index& type, port_id id) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return insert(type, id);
+            }
+
+            // registers the id of a port when the program starts, keeping the conflict instead of throwing
+            port_id record(const std::type_index& type, port_id id) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                std::string error = conflict(type, id);
+                if (error.empty()) {
+                    _ids.emplace(type, id);
+                    _types.emplace(id, type);
+                } else {
+                    _conflicts.push_back(std::move(error));
+                }
+                return id;
+            }
+
+            // the id of a port, or a free one for a port whose name may be reused by another translation unit
+            port_id unique(const std::type_index& type) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return insert_unique(type);
+            }
+
+            port_id id_of(const std::type_index& type) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto it = _ids.find(type);
+                if (it != _ids.end()) {
+                    return it->second;
+                }
+                std::string name = boost::core::demangle(type.name());
+                if (port_ids::internal_linkage(name)) {
+                    return insert_unique(type);
+                }
+                return insert(type, port_ids::hash(name));
+            }
+
+            // throws the conflicts found among the ids registered when the program started
+            void check() const {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_conflicts.empty()) {
+                    std::string error = _conflicts.front();
+                    for (std::size_t i = 1; i < _conflicts.size(); ++i) {
+                        error += "; " + _conflicts[i];
+                    }
+                    throw std::domain_error(error);
+                }
+            }
+        };
+
+        template<typename PORT>
+        inline const port_id registered_port_id = port_registry::instance().record(typeid(PORT), port_id_v<PORT>);
+
+        /**
+         * @brief The key of a port in the dynamic bags and routing, its port_id and its type. The keys are
+         * compared, ordered and hashed by their id only.
+         *
+         * The engines make the keys from the port types with of<PORT>(), the keys are also converted from a
+         * std::type_index or a typeid, looking the id up in the port_registry.
+         */
+        class port_key {
+            port_id _id;
+            std::type_index _type;
+
+            port_key(port_id id, const std::type_index& type) noexcept
+            : _id(id), _type(type) {}
+
+        public:
+            port_key(const std::type_index& type)
+            : _id(port_registry::instance().id_of(type)), _type(type) {}
+
+            port_key(const std::type_info& type)
+            : port_key(std::type_index(type)) {}
+
+            template<typename PORT>
+            static port_key of() noexcept {
+                if constexpr (port_ids::keyed_at_run_time<PORT>::value) {
+                    static const port_id id = port_registry::instance().unique(typeid(PORT));
+                    return port_key(id, typeid(PORT));
+                } else {
+                    static_cast<void>(registered_port_id<PORT>);
+                    return port_key(port_id_v<PORT>, typeid(PORT));
+                }
+            }
+
+            port_id id() const noexcept {
+                return _id;
+            }
+
+            std::type_index type() const noexcept {
+                return _type;
+            }
+
+            friend bool operator==(const port_key& a, const port_key& b) noexcept {
+                return a._id == b._id;
+            }
+
+            friend bool operator!=(const port_key& a, const port_key& b) noexcept {
+                return a._id != b._id;
+            }
+
+            friend bool operator<(const port_key& a, const port_key& b) noexcept {
+                return a._id < b._id;
+            }
+        };
+    }
+}
+
+namespace std {
+
+    template<>
+    struct hash<cadmium::dynamic::port_key> {
+        std::size_t operator()(const cadmium::dynamic::port_key& k) const noexcept {
+            return static_cast<std::size_t>(k.id());
+        }
+    };
+}
+
+#endif // CADMIUM_DYNAMIC_PORT_KEY_HPP
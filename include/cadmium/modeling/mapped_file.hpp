@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_MAPPED_FILE_HPP
+#define CADMIUM_MAPPED_FILE_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace cadmium {
+    namespace dynamic {
+        namespace modeling {
+
+            /**
+             * @brief A read only mapping of a whole file, the model structures and the checkpoints are read in
+             * place from it.
+             */
+            class mapped_file {
+                void* _data = MAP_FAILED;
+                std::size_t _size = 0;
+
+            public:
+                explicit mapped_file(const std::string& path) {
+                    int fd = ::open(path.c_str(), O_RDONLY);
+                    if (fd == -1) {
+                        throw std::runtime_error("Can not open " + path + ": " + std::strerror(errno));
+                    }
+                    struct stat st;
+                    if (::fstat(fd, &st) == -1) {
+                        int error = errno;
+                        ::close(fd);
+                        throw std::runtime_error("Can not read " + path + ": " + std::strerror(error));
+                    }
+                    _size = static_cast<std::size_t>(st.st_size);
+                    if (_size != 0) {
+                        _data = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    }
+                    int error = errno;
+                    ::close(fd);
+                    if (_size != 0 && _data == MAP_FAILED) {
+                        throw std::runtime_error("Can not map " + path + ": " + std::strerror(error));
+                    }
+                }
+
+                mapped_file(const mapped_file&) = delete;
+                mapped_file& operator=(const mapped_file&) = delete;
+
+                ~mapped_file() {
+                    if (_data != MAP_FAILED) {
+                        ::munmap(_data, _size);
+                    }
+                }
+
+                const char* data() const noexcept {
+                    return _data == MAP_FAILED ? nullptr : static_cast<const char*>(_data);
+                }
+
+                std::size_t size() const noexcept {
+                    return _size;
+                }
+            };
+        }
+    }
+}
+
+#endif // CADMIUM_MAPPED_FILE_HPP
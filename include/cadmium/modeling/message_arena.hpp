@@ -0,0 +1,281 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_MESSAGE_ARENA_HPP
+#define CADMIUM_MESSAGE_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <type_traits>
+
+#include <cadmium/modeling/message_bag.hpp>
+
+namespace cadmium {
+
+    /**
+     * @brief Bump memory arena for the messages produced in one simulation step.
+     *
+     * Each thread bumps in its own list of blocks, so allocating does not need a lock nor an atomic. The
+     * memory is not given back one allocation at a time, the arena only counts the live allocations and
+     * release() reuses all the blocks at once when there is none left. When some bag outlives the step (for instance
+     * a bag copied into a model state) the release is deferred until it is destroyed.
+     *
+     * The runner, the conservative runner, the optimistic runner and the distributed runner of separate
+     * processes call release() after each step, the in-process ranks of the distributed runner step
+     * concurrently and call release_local() instead. release() must not be called while other threads
+     * allocate.
+     */
+    class message_arena {
+    public:
+        static constexpr std::size_t block_size = 64 * 1024;
+
+        struct statistics {
+            std::size_t allocations = 0;
+            std::size_t bytes = 0;
+            std::size_t blocks = 0;
+            std::size_t releases = 0;
+            std::size_t deferred_releases = 0;
+        };
+
+        static message_arena& instance() {
+            static message_arena arena;
+            return arena;
+        }
+
+        void* allocate(std::size_t bytes, std::size_t alignment) {
+            thread_arena& a = local();
+            a.live++;
+            a.allocations++;
+            a.bytes += bytes;
+
+            for (;;) {
+                if (a.current == a.blocks.size()) {
+                    // a new block big enough for the allocation
+                    std::size_t size = bytes + alignment > block_size ? bytes + alignment : block_size;
+                    a.blocks.push_back(block{std::unique_ptr<char[]>(new char[size]), size});
+                    a.offset = 0;
+                }
+                block& b = a.blocks[a.current];
+                std::uintptr_t base = reinterpret_cast<std::uintptr_t>(b.data.get());
+                std::size_t offset = (base + a.offset + alignment - 1) / alignment * alignment - base;
+                if (offset + bytes <= b.size) {
+                    a.offset = offset + bytes;
+                    return b.data.get() + offset;
+                }
+                a.current++;
+                a.offset = 0;
+            }
+        }
+
+        void deallocate(void*, std::size_t) noexcept {
+            local().live--;
+        }
+
+        /**
+         * @brief Makes all the arena memory available again if there is no live allocation.
+         * @return true if the memory was released, false if there was nothing to release or it was deferred.
+         */
+        bool release() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::ptrdiff_t live = 0;
+            bool used = false;
+            for (auto& a : _arenas) {
+                live += a->live;
+                used = used || a->current != 0 || a->offset != 0;
+            }
+            if (!used) {
+                return false;
+            }
+            if (live != 0) {
+                _deferred_releases++;
+                return false;
+            }
+            for (auto& a : _arenas) {
+                a->current = 0;
+                a->offset = 0;
+            }
+            _releases++;
+            return true;
+        }
+
+        /**
+         * @brief Makes the memory of the calling thread arena available again if it has no live allocation.
+         * It is for the runners stepping concurrently, each in its own thread and without sending messages to
+         * other threads, as the replications of the ensemble runner, while release() could reset the arena of a
+         * thread in the middle of its step.
+         * @return true if the memory was released, false if there was nothing to release or it was deferred.
+         */
+        bool release_local() {
+            thread_arena& a = local();
+            if (a.current == 0 && a.offset == 0) {
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (a.live != 0) {
+                _deferred_releases++;
+                return false;
+            }
+            a.current = 0;
+            a.offset = 0;
+            _releases++;
+            return true;
+        }
+
+        std::size_t live_allocations() const {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::ptrdiff_t live = 0;
+            for (auto& a : _arenas) {
+                live += a->live;
+            }
+            return static_cast<std::size_t>(live);
+        }
+
+        statistics stats() const {
+            std::lock_guard<std::mutex> lock(_mutex);
+            statistics s;
+            for (auto& a : _arenas) {
+                s.allocations += a->allocations;
+                s.bytes += a->bytes;
+                s.blocks += a->blocks.size();
+            }
+            s.releases = _releases;
+            s.deferred_releases = _deferred_releases;
+            return s;
+        }
+
+    private:
+        struct block {
+            std::unique_ptr<char[]> data;
+            std::size_t size;
+        };
+
+        // The counters are only written by the thread owning the arena, a deallocation in another
+        // thread is counted there, so the sum of live over all the arenas is the live allocations.
+        struct thread_arena {
+            std::vector<block> blocks;
+            std::size_t current = 0;
+            std::size_t offset = 0;
+            std::ptrdiff_t live = 0;
+            std::size_t allocations = 0;
+            std::size_t bytes = 0;
+        };
+
+        // The thread arenas are owned by the message_arena because the messages can outlive the
+        // thread that allocated them, a finished thread gives its arena back for reuse.
+        struct thread_holder {
+            thread_arena* arena = nullptr;
+
+            ~thread_holder() {
+                if (arena != nullptr) {
+                    message_arena::instance().give_back(arena);
+                }
+            }
+        };
+
+        message_arena() = default;
+
+        thread_arena& local() {
+            thread_local thread_holder holder;
+            if (holder.arena == nullptr) {
+                holder.arena = take();
+            }
+            return *holder.arena;
+        }
+
+        thread_arena* take() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_free.empty()) {
+                thread_arena* a = _free.back();
+                _free.pop_back();
+                return a;
+            }
+            _arenas.push_back(std::make_unique<thread_arena>());
+            return _arenas.back().get();
+        }
+
+        void give_back(thread_arena* a) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _free.push_back(a);
+        }
+
+        mutable std::mutex _mutex;
+        std::vector<std::unique_ptr<thread_arena>> _arenas;
+        std::vector<thread_arena*> _free;
+        std::size_t _releases = 0;
+        std::size_t _deferred_releases = 0;
+    };
+
+    /**
+     * @brief Standard allocator backed by the message_arena.
+     *
+     * To store the bags of a message type in the arena, specialize the message_allocator trait
+     * (see message_bag.hpp):
+     *
+     *     template<> struct cadmium::message_allocator<my_message> {
+     *         using type = cadmium::arena_allocator<my_message>;
+     *     };
+     */
+    template<typename T>
+    struct arena_allocator {
+        using value_type = T;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::true_type;
+
+        arena_allocator() noexcept = default;
+
+        template<typename U>
+        arena_allocator(const arena_allocator<U>&) noexcept {}
+
+        T* allocate(std::size_t n) {
+            return static_cast<T*>(message_arena::instance().allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* p, std::size_t n) noexcept {
+            message_arena::instance().deallocate(p, n * sizeof(T));
+        }
+    };
+
+    // the arena bags do not keep their capacity, it would defer the arena release forever
+    template<typename T>
+    struct keeps_capacity<arena_allocator<T>> : std::false_type {};
+
+    template<typename T, typename U>
+    bool operator==(const arena_allocator<T>&, const arena_allocator<U>&) noexcept {
+        return true;
+    }
+
+    template<typename T, typename U>
+    bool operator!=(const arena_allocator<T>&, const arena_allocator<U>&) noexcept {
+        return false;
+    }
+}
+
+#endif // CADMIUM_MESSAGE_ARENA_HPP
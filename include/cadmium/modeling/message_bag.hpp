@@ -31,22 +31,146 @@
 #include <tuple>
 #include <typeindex>
 #include <map>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <cadmium/modeling/small_vector.hpp>
 
 namespace cadmium {
 
+/**
+ * @brief Allocator used by the bags of messages of type T, std::allocator unless specialized.
+ * For instance, specializing it with cadmium::arena_allocator<T> (see message_arena.hpp) stores
+ * the bags of T in the per step message arena.
+ */
+template<typename T>
+struct message_allocator{
+    using type=std::allocator<T>;
+};
+
+/**
+ * @brief Number of messages of type T the bags store inline, 0 unless specialized.
+ * Specializing it for messages sent a few at a time, like clock ticks, makes their bags a
+ * cadmium::small_vector that only allocates memory for the messages beyond the inline ones.
+ */
+template<typename T>
+struct inline_messages : std::integral_constant<std::size_t, 0> {};
+
+template<typename T, typename ALLOCATOR=typename message_allocator<T>::type>
+using bag=typename std::conditional<
+        inline_messages<T>::value == 0,
+        std::vector<T, ALLOCATOR>,
+        small_vector<T, inline_messages<T>::value, ALLOCATOR>
+>::type;
+
+/**
+ * @brief The bytes a bag allocated for its messages, the memory owned by the messages is not counted.
+ */
+template<typename T, typename ALLOCATOR>
+std::size_t allocated_bytes(const std::vector<T, ALLOCATOR>& messages) noexcept {
+    return messages.capacity() * sizeof(T);
+}
+
+template<typename T, std::size_t N, typename ALLOCATOR>
+std::size_t allocated_bytes(const small_vector<T, N, ALLOCATOR>& messages) noexcept {
+    return messages.capacity() > N ? messages.capacity() * sizeof(T) : 0;
+}
+
+/**
+ * @brief Bags with a larger capacity are released when the engines clear their boxes, the others keep
+ * their capacity for the next step. A high water mark of 0 releases all the bags at every step.
+ */
+inline std::size_t& bag_high_water_mark_value(){
+    static std::size_t mark=1024;
+    return mark;
+}
+
+inline std::size_t bag_high_water_mark(){
+    return bag_high_water_mark_value();
+}
+
+inline void set_bag_high_water_mark(std::size_t mark){
+    bag_high_water_mark_value()=mark;
+}
+
+/**
+ * @brief Reduces the messages routed to a port to a single message, no combiner unless specialized.
+ * When it is specialized for an input port with a static combine(message_type& into, const message_type& m),
+ * the dynamic links delivering to the port fold each message into the first one of the port bag instead of
+ * appending it, the operation must be associative and commutative as the routing order is not specified.
+ * It is meant for the input ports of the atomic models, as the routing through coupled model ports can be
+ * composed into a single link. For instance, an accumulator adding its inputs:
+ *
+ *     template<> struct cadmium::port_combiner<cadmium::basic_models::accumulator_defs<int>::add>
+ *         : cadmium::sum_combiner<int> {};
+ */
+template<typename PORT>
+struct port_combiner {};
+
 template<typename T>
-using bag=std::vector<T>;
+struct sum_combiner {
+    static void combine(T& into, const T& m) {
+        into += m;
+    }
+};
+
+template<typename T>
+struct min_combiner {
+    static void combine(T& into, const T& m) {
+        if (m < into) {
+            into = m;
+        }
+    }
+};
+
+template<typename T>
+struct max_combiner {
+    static void combine(T& into, const T& m) {
+        if (into < m) {
+            into = m;
+        }
+    }
+};
+
+template<typename PORT, typename = void>
+struct has_port_combiner : std::false_type {};
 
 template<typename PORT>
+struct has_port_combiner<PORT, std::void_t<decltype(port_combiner<PORT>::combine(
+        std::declval<typename PORT::message_type&>(), std::declval<const typename PORT::message_type&>()))>>
+        : std::true_type {};
+
+/**
+ * @brief Tells if the bags using ALLOCATOR keep their capacity when cleared, the allocators releasing
+ * their memory in bulk at every step, like the arena_allocator, do not.
+ */
+template<typename ALLOCATOR>
+struct keeps_capacity : std::true_type {};
+
+template<typename PORT, typename ALLOCATOR=typename message_allocator<typename PORT::message_type>::type>
 struct message_bag{
     using port=PORT;
     using message_type=typename PORT::message_type;
+    using allocator_type=ALLOCATOR;
 
-    bag<message_type> messages;
+    bag<message_type, ALLOCATOR> messages;
 
     message_bag(){}
 
     message_bag(std::initializer_list<message_type> l) : messages{l} {}
+
+    /**
+     * @brief Removes the messages, the capacity is kept unless it is above the bag_high_water_mark.
+     * @return true if the capacity was kept.
+     */
+    bool clear(){
+        if (!keeps_capacity<ALLOCATOR>::value || messages.capacity() > bag_high_water_mark()) {
+            decltype(messages)().swap(messages);
+            return false;
+        }
+        messages.clear();
+        return true;
+    }
 };
 
 template<typename... Ps>
@@ -61,12 +185,12 @@ struct make_message_bags{
 
 
 template<typename PORT, typename T>
-bag<typename message_bag<PORT>::message_type> & get_messages(T& mbs){
+decltype(message_bag<PORT>::messages) & get_messages(T& mbs){
     return std::get<message_bag<PORT>>(mbs).messages;
 }
 
 template<typename PORT, typename T>
-const bag<typename message_bag<PORT>::message_type> & get_messages(const T& mbs){
+const decltype(message_bag<PORT>::messages) & get_messages(const T& mbs){
     return std::get<message_bag<PORT>>(mbs).messages;
 }
 
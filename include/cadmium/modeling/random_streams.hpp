@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_RANDOM_STREAMS_HPP
+#define CADMIUM_RANDOM_STREAMS_HPP
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace cadmium {
+
+    /**
+     * @brief The splitmix64 mix of a 64 bits value, two close values give unrelated seeds.
+     */
+    constexpr std::uint64_t mix_seed(std::uint64_t z) noexcept {
+        z += 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief The seed of the index-th stream split from seed, for instance the one of a replication.
+     */
+    constexpr std::uint64_t split_seed(std::uint64_t seed, std::uint64_t index) noexcept {
+        return mix_seed(seed ^ mix_seed(index));
+    }
+
+    /**
+     * @brief The seed of the stream of a model split from seed, keyed by the model id or by its path in
+     * the model tree. It depends only on the seed and the key, not on the order the models are built nor on
+     * the thread running them, and it is the same in every platform.
+     */
+    inline std::uint64_t split_seed(std::uint64_t seed, const std::string& key) noexcept {
+        std::uint64_t hash = 0xcbf29ce484222325ULL; // FNV-1a
+        for (unsigned char c : key) {
+            hash = (hash ^ c) * 0x100000001b3ULL;
+        }
+        return split_seed(seed, hash);
+    }
+
+    /**
+     * @brief The random engine of a model, seeded with its own stream split from seed. The models keep it
+     * in their state instead of sharing an engine, then their draws do not depend on the order they run.
+     */
+    inline std::mt19937_64 model_random_engine(std::uint64_t seed, const std::string& key) {
+        return std::mt19937_64(split_seed(seed, key));
+    }
+}
+
+#endif // CADMIUM_RANDOM_STREAMS_HPP
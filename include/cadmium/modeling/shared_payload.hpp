@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_SHARED_PAYLOAD_HPP
+#define CADMIUM_SHARED_PAYLOAD_HPP
+
+#include <memory>
+#include <utility>
+#include <istream>
+#include <ostream>
+
+namespace cadmium {
+
+    /**
+     * @brief Immutable message payload shared by all the copies of the message.
+     *
+     * Copying a shared_payload only increments a reference count, then when an output port is coupled to
+     * many input ports, each receiver gets a read only view of the same payload instead of a copy of it.
+     * Sending a whole batch of values in one shared_payload message makes the fan-out constant by receiver.
+     *
+     * A default constructed shared_payload has no payload.
+     *
+     * @tparam T - The type of the payload.
+     */
+    template<typename T>
+    class shared_payload {
+        std::shared_ptr<const T> _payload;
+
+    public:
+        using element_type = T;
+
+        shared_payload() = default;
+
+        explicit shared_payload(T value)
+        : _payload(std::make_shared<const T>(std::move(value))) {}
+
+        explicit shared_payload(std::shared_ptr<const T> payload) noexcept
+        : _payload(std::move(payload)) {}
+
+        const T& operator*() const noexcept {
+            return *_payload;
+        }
+
+        const T* operator->() const noexcept {
+            return _payload.get();
+        }
+
+        const T* get() const noexcept {
+            return _payload.get();
+        }
+
+        explicit operator bool() const noexcept {
+            return _payload != nullptr;
+        }
+
+        /**
+         * @return the number of messages sharing the payload.
+         */
+        long use_count() const noexcept {
+            return _payload.use_count();
+        }
+    };
+
+    template<typename T, typename... ARGS>
+    shared_payload<T> make_shared_payload(ARGS&&... args) {
+        return shared_payload<T>(std::make_shared<const T>(std::forward<ARGS>(args)...));
+    }
+
+    // two payloads are equal when they share the payload or their payloads are equal
+    template<typename T>
+    bool operator==(const shared_payload<T>& a, const shared_payload<T>& b) {
+        return a.get() == b.get() || (a && b && *a == *b);
+    }
+
+    template<typename T>
+    bool operator!=(const shared_payload<T>& a, const shared_payload<T>& b) {
+        return !(a == b);
+    }
+
+    // the payload is printed in the logs if it is printable
+    template<typename T>
+    auto operator<<(std::ostream& os, const shared_payload<T>& p) -> decltype(os << std::declval<const T&>()) {
+        if (p) {
+            return os << *p;
+        }
+        return os << "null";
+    }
+
+    // reading the payload allows sending it to another memory space with the text message_serializer
+    template<typename T>
+    auto operator>>(std::istream& is, shared_payload<T>& p) -> decltype(is >> std::declval<T&>()) {
+        T value;
+        is >> value;
+        p = shared_payload<T>(std::move(value));
+        return is;
+    }
+}
+
+#endif // CADMIUM_SHARED_PAYLOAD_HPP
@@ -0,0 +1,428 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CADMIUM_SMALL_VECTOR_HPP
+#define CADMIUM_SMALL_VECTOR_HPP
+
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+
+namespace cadmium {
+
+    /**
+     * @brief A contiguous container with the std::vector interface used by the message bags, that stores up
+     * to N elements inline and only allocates memory with ALLOCATOR when it grows beyond them.
+     *
+     * The allocator is not propagated on assignment or swap, it must be an allocator where all the instances
+     * are equal, as std::allocator and cadmium::arena_allocator.
+     *
+     * @tparam T - The element type.
+     * @tparam N - The number of elements stored inline, it must be greater than 0.
+     * @tparam ALLOCATOR - The allocator used for the elements beyond the inline ones.
+     */
+    template<typename T, std::size_t N, typename ALLOCATOR=std::allocator<T>>
+    class small_vector {
+        static_assert(N > 0, "A small_vector must have inline storage for at least one element");
+
+        using alloc_traits = std::allocator_traits<ALLOCATOR>;
+
+    public:
+        using value_type = T;
+        using allocator_type = ALLOCATOR;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using iterator = T*;
+        using const_iterator = const T*;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        static constexpr size_type inline_capacity = N;
+
+    private:
+        ALLOCATOR _alloc;
+        T* _data;
+        size_type _size = 0;
+        size_type _capacity = N;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type _inline[N];
+
+        T* inline_data() noexcept {
+            return reinterpret_cast<T*>(_inline);
+        }
+
+        void destroy_all() noexcept {
+            for (size_type i = 0; i < _size; i++) {
+                alloc_traits::destroy(_alloc, _data + i);
+            }
+            _size = 0;
+        }
+
+        void release() noexcept {
+            if (!is_inline()) {
+                alloc_traits::deallocate(_alloc, _data, _capacity);
+                _data = inline_data();
+                _capacity = N;
+            }
+        }
+
+        // moves the elements to a new storage of capacity elements, the element at position _size can
+        // be constructed in the new storage before the move, it allows growing with an element of this
+        template<typename... ARGS>
+        void reallocate(size_type capacity, bool emplace, ARGS&&... args) {
+            T* data = alloc_traits::allocate(_alloc, capacity);
+            try {
+                if (emplace) {
+                    alloc_traits::construct(_alloc, data + _size, std::forward<ARGS>(args)...);
+                }
+            } catch (...) {
+                alloc_traits::deallocate(_alloc, data, capacity);
+                throw;
+            }
+            for (size_type i = 0; i < _size; i++) {
+                alloc_traits::construct(_alloc, data + i, std::move_if_noexcept(_data[i]));
+                alloc_traits::destroy(_alloc, _data + i);
+            }
+            release();
+            _data = data;
+            _capacity = capacity;
+        }
+
+        size_type grown_capacity(size_type needed) const noexcept {
+            return std::max(needed, 2 * _capacity);
+        }
+
+        void steal(small_vector& other) noexcept {
+            _data = other._data;
+            _size = other._size;
+            _capacity = other._capacity;
+            other._data = other.inline_data();
+            other._size = 0;
+            other._capacity = N;
+        }
+
+    public:
+        small_vector() noexcept(std::is_nothrow_default_constructible<ALLOCATOR>::value)
+        : _alloc(), _data(inline_data()) {}
+
+        explicit small_vector(const ALLOCATOR& alloc) noexcept
+        : _alloc(alloc), _data(inline_data()) {}
+
+        explicit small_vector(size_type count, const T& value = T(), const ALLOCATOR& alloc = ALLOCATOR())
+        : small_vector(alloc) {
+            resize(count, value);
+        }
+
+        template<typename INPUT_IT, typename = typename std::iterator_traits<INPUT_IT>::iterator_category>
+        small_vector(INPUT_IT first, INPUT_IT last, const ALLOCATOR& alloc = ALLOCATOR())
+        : small_vector(alloc) {
+            insert(end(), first, last);
+        }
+
+        small_vector(std::initializer_list<T> l, const ALLOCATOR& alloc = ALLOCATOR())
+        : small_vector(l.begin(), l.end(), alloc) {}
+
+        small_vector(const small_vector& other)
+        : small_vector(alloc_traits::select_on_container_copy_construction(other._alloc)) {
+            insert(end(), other.begin(), other.end());
+        }
+
+        small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+        : _alloc(std::move(other._alloc)), _data(inline_data()) {
+            if (other.is_inline()) {
+                for (size_type i = 0; i < other._size; i++) {
+                    alloc_traits::construct(_alloc, _data + i, std::move(other._data[i]));
+                    _size++;
+                }
+                other.clear();
+            } else {
+                steal(other);
+            }
+        }
+
+        ~small_vector() {
+            destroy_all();
+            release();
+        }
+
+        small_vector& operator=(const small_vector& other) {
+            if (this != &other) {
+                assign(other.begin(), other.end());
+            }
+            return *this;
+        }
+
+        small_vector& operator=(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+            if (this != &other) {
+                destroy_all();
+                if (other.is_inline()) {
+                    // the inline elements fit in any storage of this
+                    for (size_type i = 0; i < other._size; i++) {
+                        alloc_traits::construct(_alloc, _data + i, std::move(other._data[i]));
+                        _size++;
+                    }
+                    other.clear();
+                } else {
+                    release();
+                    steal(other);
+                }
+            }
+            return *this;
+        }
+
+        small_vector& operator=(std::initializer_list<T> l) {
+            assign(l.begin(), l.end());
+            return *this;
+        }
+
+        allocator_type get_allocator() const noexcept {
+            return _alloc;
+        }
+
+        /**
+         * @return true if the elements are stored inline.
+         */
+        bool is_inline() const noexcept {
+            return _data == reinterpret_cast<const T*>(_inline);
+        }
+
+        iterator begin() noexcept { return _data; }
+        iterator end() noexcept { return _data + _size; }
+        const_iterator begin() const noexcept { return _data; }
+        const_iterator end() const noexcept { return _data + _size; }
+        const_iterator cbegin() const noexcept { return _data; }
+        const_iterator cend() const noexcept { return _data + _size; }
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+        bool empty() const noexcept { return _size == 0; }
+        size_type size() const noexcept { return _size; }
+        size_type capacity() const noexcept { return _capacity; }
+        size_type max_size() const noexcept { return alloc_traits::max_size(_alloc); }
+
+        T* data() noexcept { return _data; }
+        const T* data() const noexcept { return _data; }
+
+        reference operator[](size_type i) noexcept { return _data[i]; }
+        const_reference operator[](size_type i) const noexcept { return _data[i]; }
+
+        reference at(size_type i) {
+            if (i >= _size) {
+                throw std::out_of_range("small_vector index out of range");
+            }
+            return _data[i];
+        }
+
+        const_reference at(size_type i) const {
+            if (i >= _size) {
+                throw std::out_of_range("small_vector index out of range");
+            }
+            return _data[i];
+        }
+
+        reference front() noexcept { return _data[0]; }
+        const_reference front() const noexcept { return _data[0]; }
+        reference back() noexcept { return _data[_size - 1]; }
+        const_reference back() const noexcept { return _data[_size - 1]; }
+
+        void reserve(size_type capacity) {
+            if (capacity > _capacity) {
+                reallocate(capacity, false);
+            }
+        }
+
+        void shrink_to_fit() {
+            if (!is_inline() && _size <= N) {
+                T* data = _data;
+                size_type capacity = _capacity;
+                _data = inline_data();
+                _capacity = N;
+                for (size_type i = 0; i < _size; i++) {
+                    alloc_traits::construct(_alloc, _data + i, std::move(data[i]));
+                    alloc_traits::destroy(_alloc, data + i);
+                }
+                alloc_traits::deallocate(_alloc, data, capacity);
+            }
+        }
+
+        void clear() noexcept {
+            destroy_all();
+        }
+
+        template<typename... ARGS>
+        reference emplace_back(ARGS&&... args) {
+            if (_size == _capacity) {
+                reallocate(grown_capacity(_size + 1), true, std::forward<ARGS>(args)...);
+            } else {
+                alloc_traits::construct(_alloc, _data + _size, std::forward<ARGS>(args)...);
+            }
+            _size++;
+            return back();
+        }
+
+        void push_back(const T& value) {
+            emplace_back(value);
+        }
+
+        void push_back(T&& value) {
+            emplace_back(std::move(value));
+        }
+
+        void pop_back() noexcept {
+            _size--;
+            alloc_traits::destroy(_alloc, _data + _size);
+        }
+
+        void resize(size_type count) {
+            while (_size > count) {
+                pop_back();
+            }
+            reserve(count);
+            while (_size < count) {
+                emplace_back();
+            }
+        }
+
+        void resize(size_type count, const T& value) {
+            while (_size > count) {
+                pop_back();
+            }
+            reserve(count);
+            while (_size < count) {
+                emplace_back(value);
+            }
+        }
+
+        template<typename INPUT_IT, typename = typename std::iterator_traits<INPUT_IT>::iterator_category>
+        iterator insert(const_iterator pos, INPUT_IT first, INPUT_IT last) {
+            size_type index = static_cast<size_type>(pos - begin());
+            size_type old_size = _size;
+            if (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<INPUT_IT>::iterator_category>::value) {
+                size_type count = static_cast<size_type>(std::distance(first, last));
+                if (_size + count > _capacity) {
+                    reallocate(grown_capacity(_size + count), false);
+                }
+            }
+            for (; first != last; ++first) {
+                emplace_back(*first);
+            }
+            std::rotate(begin() + index, begin() + old_size, end());
+            return begin() + index;
+        }
+
+        iterator insert(const_iterator pos, const T& value) {
+            const T* first = &value;
+            return insert(pos, first, first + 1);
+        }
+
+        iterator insert(const_iterator pos, T&& value) {
+            size_type index = static_cast<size_type>(pos - begin());
+            emplace_back(std::move(value));
+            std::rotate(begin() + index, end() - 1, end());
+            return begin() + index;
+        }
+
+        iterator insert(const_iterator pos, std::initializer_list<T> l) {
+            return insert(pos, l.begin(), l.end());
+        }
+
+        iterator erase(const_iterator first, const_iterator last) {
+            iterator f = begin() + (first - begin());
+            iterator l = begin() + (last - begin());
+            iterator new_end = std::move(l, end(), f);
+            while (end() != new_end) {
+                pop_back();
+            }
+            return f;
+        }
+
+        iterator erase(const_iterator pos) {
+            return erase(pos, pos + 1);
+        }
+
+        template<typename INPUT_IT, typename = typename std::iterator_traits<INPUT_IT>::iterator_category>
+        void assign(INPUT_IT first, INPUT_IT last) {
+            clear();
+            insert(end(), first, last);
+        }
+
+        void assign(size_type count, const T& value) {
+            clear();
+            resize(count, value);
+        }
+
+        void assign(std::initializer_list<T> l) {
+            assign(l.begin(), l.end());
+        }
+
+        void swap(small_vector& other) {
+            if (this == &other) {
+                return;
+            }
+            if (!is_inline() && !other.is_inline()) {
+                std::swap(_data, other._data);
+                std::swap(_size, other._size);
+                std::swap(_capacity, other._capacity);
+            } else {
+                small_vector tmp(std::move(other));
+                other = std::move(*this);
+                *this = std::move(tmp);
+            }
+        }
+    };
+
+    template<typename T, std::size_t N, typename A>
+    bool operator==(const small_vector<T, N, A>& a, const small_vector<T, N, A>& b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+    }
+
+    template<typename T, std::size_t N, typename A>
+    bool operator!=(const small_vector<T, N, A>& a, const small_vector<T, N, A>& b) {
+        return !(a == b);
+    }
+
+    template<typename T, std::size_t N, typename A>
+    bool operator<(const small_vector<T, N, A>& a, const small_vector<T, N, A>& b) {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+    template<typename T, std::size_t N, typename A>
+    void swap(small_vector<T, N, A>& a, small_vector<T, N, A>& b) {
+        a.swap(b);
+    }
+}
+
+#endif // CADMIUM_SMALL_VECTOR_HPP
@@ -0,0 +1,175 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_STATE_SERIALIZER_HPP
+#define CADMIUM_STATE_SERIALIZER_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/type_index.hpp>
+
+#include <cadmium/engine/pdevs_dynamic_message_serializer.hpp>
+
+namespace cadmium {
+
+    /**
+     * @brief Serialization of the model states and times saved by the checkpoints.
+     *
+     * state_serializer<T> has, as cadmium::dynamic::engine::message_serializer:
+     * - static constexpr bool serializable: false if the values of type T can not be serialized.
+     * - static void write(const T& value, std::string& buffer): appends value to buffer.
+     * - static void read(const char*& data, const char* end, T& value): reads value from data, and moves data
+     *   after it.
+     *
+     * Trivially copyable values are copied as raw bytes, std::string values with their length, the tuples,
+     * pairs and vectors element by element, and the other values with the stream operators if they are
+     * defined. Other state types have to specialize state_serializer to be saved.
+     *
+     * @note The raw bytes are only valid between the same executable running in the same architecture.
+     */
+    template<typename T, typename = void>
+    struct state_serializer {
+        static constexpr bool serializable = false;
+
+        static void write(const T&, std::string&) {
+            throw std::domain_error("There is no state_serializer for " + boost::typeindex::type_id<T>().pretty_name());
+        }
+
+        static void read(const char*&, const char*, T&) {
+            throw std::domain_error("There is no state_serializer for " + boost::typeindex::type_id<T>().pretty_name());
+        }
+    };
+
+    template<typename T>
+    struct state_serializer<T, std::enable_if_t<std::is_trivially_copyable<T>::value>> {
+        static constexpr bool serializable = true;
+
+        static void write(const T& value, std::string& buffer) {
+            buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        static void read(const char*& data, const char* end, T& value) {
+            if (end - data < static_cast<std::ptrdiff_t>(sizeof(T))) {
+                throw std::domain_error("Truncated serialized state");
+            }
+            std::memcpy(static_cast<void*>(&value), data, sizeof(T));
+            data += sizeof(T);
+        }
+    };
+
+    template<>
+    struct state_serializer<std::string> {
+        static constexpr bool serializable = true;
+
+        static void write(const std::string& value, std::string& buffer) {
+            cadmium::dynamic::engine::serialization::write_size(value.size(), buffer);
+            buffer.append(value);
+        }
+
+        static void read(const char*& data, const char* end, std::string& value) {
+            value = cadmium::dynamic::engine::serialization::read_bytes(data, end);
+        }
+    };
+
+    template<typename... Ts>
+    struct state_serializer<std::tuple<Ts...>, std::enable_if_t<!std::is_trivially_copyable<std::tuple<Ts...>>::value>> {
+        static constexpr bool serializable = (state_serializer<Ts>::serializable && ... && true);
+
+        static void write(const std::tuple<Ts...>& value, std::string& buffer) {
+            std::apply([&buffer](const Ts&... elements) { (state_serializer<Ts>::write(elements, buffer), ...); }, value);
+        }
+
+        static void read(const char*& data, const char* end, std::tuple<Ts...>& value) {
+            std::apply([&data, end](Ts&... elements) { (state_serializer<Ts>::read(data, end, elements), ...); }, value);
+        }
+    };
+
+    template<typename A, typename B>
+    struct state_serializer<std::pair<A, B>, std::enable_if_t<!std::is_trivially_copyable<std::pair<A, B>>::value>> {
+        static constexpr bool serializable = state_serializer<A>::serializable && state_serializer<B>::serializable;
+
+        static void write(const std::pair<A, B>& value, std::string& buffer) {
+            state_serializer<A>::write(value.first, buffer);
+            state_serializer<B>::write(value.second, buffer);
+        }
+
+        static void read(const char*& data, const char* end, std::pair<A, B>& value) {
+            state_serializer<A>::read(data, end, value.first);
+            state_serializer<B>::read(data, end, value.second);
+        }
+    };
+
+    template<typename T, typename ALLOCATOR>
+    struct state_serializer<std::vector<T, ALLOCATOR>> {
+        static constexpr bool serializable = state_serializer<T>::serializable;
+
+        static void write(const std::vector<T, ALLOCATOR>& value, std::string& buffer) {
+            cadmium::dynamic::engine::serialization::write_size(value.size(), buffer);
+            for (const auto& v : value) {
+                state_serializer<T>::write(v, buffer);
+            }
+        }
+
+        static void read(const char*& data, const char* end, std::vector<T, ALLOCATOR>& value) {
+            std::uint64_t size = cadmium::dynamic::engine::serialization::read_size(data, end);
+            value.clear();
+            for (std::uint64_t i = 0; i < size; i++) {
+                T v{};
+                state_serializer<T>::read(data, end, v);
+                value.push_back(std::move(v));
+            }
+        }
+    };
+
+    template<typename T>
+    struct state_serializer<T, std::enable_if_t<!std::is_trivially_copyable<T>::value && cadmium::dynamic::engine::serialization::is_streamable<T>::value>> {
+        static constexpr bool serializable = true;
+
+        static void write(const T& value, std::string& buffer) {
+            std::ostringstream oss;
+            oss.precision(17);
+            oss << value;
+            state_serializer<std::string>::write(oss.str(), buffer);
+        }
+
+        static void read(const char*& data, const char* end, T& value) {
+            std::istringstream iss(cadmium::dynamic::engine::serialization::read_bytes(data, end));
+            if (!(iss >> value)) {
+                throw std::domain_error("Invalid serialized " + boost::typeindex::type_id<T>().pretty_name() + " state");
+            }
+        }
+    };
+}
+
+#endif // CADMIUM_STATE_SERIALIZER_HPP
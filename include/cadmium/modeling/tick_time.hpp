@@ -0,0 +1,239 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_TICK_TIME_HPP
+#define CADMIUM_TICK_TIME_HPP
+
+#include <cstdint>
+#include <limits>
+#include <ratio>
+#include <ostream>
+#include <type_traits>
+
+namespace cadmium {
+
+    /**
+     * @brief Simulation time counted in an integer number of ticks.
+     *
+     * The comparisons and additions of the engines are integer operations, then two times reached adding
+     * the same durations in different orders are always equal, what is not the case of float times.
+     * The greatest count of ticks is the infinity, adding or subtracting a duration from the infinity
+     * keeps it, and std::numeric_limits is specialized to give it to the engines.
+     * The arithmetic saturates, a result beyond the greatest finite time is the infinity and a result below
+     * the lowest time is std::numeric_limits lowest(), which is also a finite time minus the infinity.
+     *
+     * A tick_time is constructed from a number of seconds, which is rounded to the nearest tick, then the
+     * models written for float or double times return the same durations. The seconds out of the range of
+     * the ticks saturate as the arithmetic does.
+     * It is converted to double seconds explicitly, as required by the calendar and ladder FELs, and it is
+     * written in the logs as its seconds.
+     *
+     * @tparam RESOLUTION - A std::ratio with the seconds of one tick, one millisecond by default.
+     */
+    template<typename RESOLUTION = std::milli>
+    class tick_time {
+    public:
+        using rep = std::int64_t;
+        using resolution = typename RESOLUTION::type;
+
+        static constexpr rep infinite_ticks = std::numeric_limits<rep>::max();
+        static constexpr rep lowest_ticks = std::numeric_limits<rep>::min();
+
+    private:
+        rep _ticks = 0;
+
+        static constexpr rep ticks_of_seconds(double seconds) noexcept {
+            double ticks = seconds * resolution::den / resolution::num;
+            // both limits are powers of two, exact as doubles
+            if (ticks >= static_cast<double>(infinite_ticks)) {
+                return infinite_ticks;
+            }
+            if (ticks <= static_cast<double>(lowest_ticks)) {
+                return lowest_ticks;
+            }
+            return static_cast<rep>(ticks < 0 ? ticks - 0.5 : ticks + 0.5);
+        }
+
+        template<typename T>
+        static constexpr rep ticks_of_integral_seconds(T seconds) noexcept {
+            constexpr rep limit = infinite_ticks / resolution::den;
+            if (seconds > 0 && static_cast<std::uintmax_t>(seconds) > static_cast<std::uintmax_t>(limit)) {
+                return infinite_ticks;
+            }
+            if constexpr (std::is_signed<T>::value) {
+                if (static_cast<std::intmax_t>(seconds) < -limit) {
+                    return lowest_ticks;
+                }
+            }
+            return static_cast<rep>(seconds) * resolution::den;
+        }
+
+        // the finite sum of ticks, saturated to the infinity above and to the lowest ticks below
+        static constexpr rep saturated_sum(rep a, rep b) noexcept {
+            if (b > 0 && a > infinite_ticks - b) {
+                return infinite_ticks;
+            }
+            if (b < 0 && a < lowest_ticks - b) {
+                return lowest_ticks;
+            }
+            return a + b;
+        }
+
+        static constexpr bool exact_seconds = resolution::num == 1;
+
+    public:
+        constexpr tick_time() noexcept = default;
+
+        template<typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+        constexpr tick_time(T seconds) noexcept
+        : _ticks(std::is_integral<T>::value && exact_seconds
+                 ? ticks_of_integral_seconds(seconds)
+                 : ticks_of_seconds(static_cast<double>(seconds))) {}
+
+        static constexpr tick_time from_ticks(rep ticks) noexcept {
+            tick_time ret;
+            ret._ticks = ticks;
+            return ret;
+        }
+
+        static constexpr tick_time infinity() noexcept {
+            return from_ticks(infinite_ticks);
+        }
+
+        constexpr rep ticks() const noexcept {
+            return _ticks;
+        }
+
+        constexpr bool is_infinity() const noexcept {
+            return _ticks == infinite_ticks;
+        }
+
+        constexpr explicit operator double() const noexcept {
+            return is_infinity() ? std::numeric_limits<double>::infinity()
+                                 : static_cast<double>(_ticks) * resolution::num / resolution::den;
+        }
+
+        constexpr tick_time& operator+=(const tick_time& o) noexcept {
+            _ticks = (is_infinity() || o.is_infinity()) ? infinite_ticks : saturated_sum(_ticks, o._ticks);
+            return *this;
+        }
+
+        constexpr tick_time& operator-=(const tick_time& o) noexcept {
+            if (is_infinity()) {
+                return *this;
+            }
+            if (o.is_infinity()) {
+                _ticks = lowest_ticks;
+            } else if (o._ticks == lowest_ticks) {
+                // its negation is not a rep, one more tick than the largest one
+                _ticks = saturated_sum(saturated_sum(_ticks, infinite_ticks), 1);
+            } else {
+                _ticks = saturated_sum(_ticks, -o._ticks);
+            }
+            return *this;
+        }
+
+        friend constexpr tick_time operator+(tick_time a, const tick_time& b) noexcept {
+            return a += b;
+        }
+
+        friend constexpr tick_time operator-(tick_time a, const tick_time& b) noexcept {
+            return a -= b;
+        }
+
+        friend constexpr bool operator==(const tick_time& a, const tick_time& b) noexcept {
+            return a._ticks == b._ticks;
+        }
+
+        friend constexpr bool operator!=(const tick_time& a, const tick_time& b) noexcept {
+            return a._ticks != b._ticks;
+        }
+
+        friend constexpr bool operator<(const tick_time& a, const tick_time& b) noexcept {
+            return a._ticks < b._ticks;
+        }
+
+        friend constexpr bool operator<=(const tick_time& a, const tick_time& b) noexcept {
+            return a._ticks <= b._ticks;
+        }
+
+        friend constexpr bool operator>(const tick_time& a, const tick_time& b) noexcept {
+            return a._ticks > b._ticks;
+        }
+
+        friend constexpr bool operator>=(const tick_time& a, const tick_time& b) noexcept {
+            return a._ticks >= b._ticks;
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, const tick_time& t) {
+            return os << static_cast<double>(t);
+        }
+    };
+}
+
+namespace std {
+
+    template<typename RESOLUTION>
+    class numeric_limits<cadmium::tick_time<RESOLUTION>> {
+        using time_type = cadmium::tick_time<RESOLUTION>;
+        using rep = typename time_type::rep;
+
+    public:
+        static constexpr bool is_specialized = true;
+        static constexpr bool is_signed = true;
+        static constexpr bool is_integer = false;
+        static constexpr bool is_exact = true;
+        static constexpr bool has_infinity = true;
+        static constexpr bool has_quiet_NaN = false;
+        static constexpr bool has_signaling_NaN = false;
+        static constexpr bool is_bounded = true;
+        static constexpr bool is_modulo = false;
+
+        static constexpr time_type min() noexcept {
+            return time_type::from_ticks(time_type::lowest_ticks);
+        }
+
+        static constexpr time_type lowest() noexcept {
+            return min();
+        }
+
+        // the greatest finite time
+        static constexpr time_type max() noexcept {
+            return time_type::from_ticks(time_type::infinite_ticks - 1);
+        }
+
+        // one tick
+        static constexpr time_type epsilon() noexcept {
+            return time_type::from_ticks(1);
+        }
+
+        static constexpr time_type infinity() noexcept {
+            return time_type::infinity();
+        }
+    };
+}
+
+#endif // CADMIUM_TICK_TIME_HPP
@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2013-2017, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <map>
+#include <thread>
+#include <vector>
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+#include <cadmium/logger/logger.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include <cadmium/logger/async_sink_provider.hpp>
+
+namespace {
+    std::ostringstream oss;
+
+    struct oss_sink_provider{
+        static std::ostream& sink(){
+            return oss;
+        }
+    };
+
+    using async_sink=cadmium::logger::async_sink_provider<oss_sink_provider, 16>;
+    using async_logger=cadmium::logger::logger<cadmium::logger::logger_info, cadmium::logger::formatter<float>, async_sink>;
+}
+
+BOOST_AUTO_TEST_SUITE( async_sink_provider_test_suite )
+
+BOOST_AUTO_TEST_CASE( spsc_ring_is_bounded_test )
+{
+    cadmium::logger::spsc_ring<int> ring(3);
+    BOOST_CHECK_EQUAL(ring.capacity(), 4);
+
+    int pushed[] = {1, 2, 3, 4, 5};
+    for (int i = 0; i < 4; i++) {
+        BOOST_CHECK(ring.try_push(pushed[i]));
+    }
+    BOOST_CHECK(!ring.try_push(pushed[4]));
+
+    int v;
+    BOOST_CHECK(ring.try_pop(v));
+    BOOST_CHECK_EQUAL(v, 1);
+    BOOST_CHECK(ring.try_push(pushed[4]));
+    for (int expected = 2; expected <= 5; expected++) {
+        BOOST_CHECK(ring.try_pop(v));
+        BOOST_CHECK_EQUAL(v, expected);
+    }
+    BOOST_CHECK(!ring.try_pop(v));
+    BOOST_CHECK(ring.empty());
+}
+
+BOOST_AUTO_TEST_CASE( async_sink_writes_the_records_in_order_test )
+{
+    oss.str("");
+    // more records than the ring capacity
+    for (int i = 0; i < 100; i++) {
+        async_logger::log<cadmium::logger::logger_info, cadmium::logger::run_info>(std::to_string(i));
+    }
+    async_sink::flush();
+
+    std::ostringstream expected;
+    for (int i = 0; i < 100; i++) {
+        expected << i << std::endl;
+    }
+    BOOST_CHECK_EQUAL(oss.str(), expected.str());
+}
+
+BOOST_AUTO_TEST_CASE( async_sink_merges_the_records_of_all_the_threads_test )
+{
+    oss.str("");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < 200; i++) {
+                async_logger::log<cadmium::logger::logger_info, cadmium::logger::run_info>(std::to_string(t) + " " + std::to_string(i));
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    async_sink::flush();
+
+    // all the lines are written and the lines of each thread keep their order
+    std::istringstream lines(oss.str());
+    std::map<int, int> next;
+    int t, i, count = 0;
+    while (lines >> t >> i) {
+        BOOST_CHECK_EQUAL(i, next[t]);
+        next[t]++;
+        count++;
+    }
+    BOOST_CHECK_EQUAL(count, 800);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
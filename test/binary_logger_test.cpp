@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2013-2017, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+#include <cadmium/logger/logger.hpp>
+#include <cadmium/logger/binary_logger.hpp>
+#include <cadmium/logger/dynamic_common_loggers.hpp>
+
+namespace {
+    std::ostringstream text_oss;
+    std::ostringstream binary_oss;
+
+    struct text_sink_provider{
+        static std::ostream& sink(){
+            return text_oss;
+        }
+    };
+
+    struct binary_sink_provider{
+        static std::ostream& sink(){
+            return binary_oss;
+        }
+    };
+
+    using formatter=cadmium::dynamic::logger::formatter<float>;
+    using text_logger=cadmium::logger::logger<cadmium::logger::logger_info, formatter, text_sink_provider>;
+    using binary_logger=cadmium::logger::binary_logger<cadmium::logger::logger_info, float, binary_sink_provider>;
+    using both_loggers=cadmium::logger::multilogger<text_logger, binary_logger>;
+
+    std::string converted_binary_trace() {
+        binary_logger::flush();
+        std::istringstream is(binary_oss.str());
+        std::ostringstream os;
+        cadmium::logger::convert_binary_trace<float, formatter>(is, os);
+        return os.str();
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( binary_logger_test_suite )
+
+BOOST_AUTO_TEST_CASE( binary_trace_converts_to_the_text_trace_test )
+{
+    std::string model_id = "generator";
+    both_loggers::log<cadmium::logger::logger_info, cadmium::logger::sim_info_init>(0.0f, model_id);
+    both_loggers::log<cadmium::logger::logger_info, cadmium::logger::sim_state>(0.0f, model_id, std::string("state 1"));
+    both_loggers::log<cadmium::logger::logger_info, cadmium::logger::sim_info_advance>(0.0f, 1.5f, model_id);
+    both_loggers::log<cadmium::logger::logger_info, cadmium::logger::coor_routing_collect>(
+            std::string("out"), std::string("in"), std::vector<std::string>{"1", "2"}, std::vector<std::string>{"1", "2"});
+    both_loggers::log<cadmium::logger::logger_info, cadmium::logger::run_info>("Finished run");
+    // other sources are not logged
+    both_loggers::log<cadmium::logger::logger_debug, cadmium::logger::run_info>("ignored");
+
+    BOOST_CHECK_EQUAL(converted_binary_trace(), text_oss.str());
+}
+
+BOOST_AUTO_TEST_CASE( binary_trace_interns_the_model_ids_test )
+{
+    std::size_t before = binary_oss.str().size();
+    binary_logger::log<cadmium::logger::logger_info, cadmium::logger::sim_info_collect>(2.0f, std::string("a long model identifier"));
+    binary_logger::flush();
+    std::size_t first = binary_oss.str().size() - before;
+
+    binary_logger::log<cadmium::logger::logger_info, cadmium::logger::sim_info_collect>(3.0f, std::string("a long model identifier"));
+    binary_logger::flush();
+    std::size_t second = binary_oss.str().size() - before - first;
+
+    // the second event only refers to the name defined by the first one
+    BOOST_CHECK_EQUAL(second, 8 + 1 + sizeof(float) + 1 + 4);
+    BOOST_CHECK_EQUAL(first, second + 8 + 4 + std::string("a long model identifier").size());
+    BOOST_CHECK(converted_binary_trace().find("Simulator for model a long model identifier collecting output at time 3") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE( converting_invalid_binary_traces_throws_test )
+{
+    std::ostringstream os;
+    std::istringstream not_a_trace("not a binary trace");
+    BOOST_CHECK_THROW((cadmium::logger::convert_binary_trace<float, formatter>(not_a_trace, os)), std::domain_error);
+
+    std::istringstream other_time(binary_oss.str());
+    BOOST_CHECK_THROW((cadmium::logger::convert_binary_trace<double, cadmium::dynamic::logger::formatter<double>>(other_time, os)), std::domain_error);
+
+    binary_logger::flush();
+    std::string trace = binary_oss.str();
+    std::istringstream truncated(trace.substr(0, trace.size() - 3));
+    BOOST_CHECK_THROW((cadmium::logger::convert_binary_trace<float, formatter>(truncated, os)), std::domain_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
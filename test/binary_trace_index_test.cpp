@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) 2013-2017, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <boost/test/unit_test.hpp>
+#include <cadmium/logger/logger.hpp>
+#include <cadmium/logger/binary_logger.hpp>
+#include <cadmium/logger/binary_trace_index.hpp>
+#include <cadmium/logger/dynamic_common_loggers.hpp>
+
+namespace {
+    std::ostringstream binary_oss;
+
+    struct binary_sink_provider{
+        static std::ostream& sink(){
+            return binary_oss;
+        }
+    };
+
+    using formatter=cadmium::dynamic::logger::formatter<float>;
+    using binary_logger=cadmium::logger::binary_logger<cadmium::logger::logger_info, float, binary_sink_provider>;
+    using trace_index=cadmium::logger::binary_trace_index<float>;
+    using reader=cadmium::logger::binary_trace_reader<float, formatter>;
+
+    // a trace with the states of two models at times 0 to 9 and the routing of their messages at even times
+    std::string trace() {
+        static bool logged = false;
+        if (!logged) {
+            logged = true;
+            for (int i = 0; i < 10; i++) {
+                float t = static_cast<float>(i);
+                for (std::string model_id : {"a", "b"}) {
+                    binary_logger::log<cadmium::logger::logger_info, cadmium::logger::sim_info_collect>(t, model_id);
+                    binary_logger::log<cadmium::logger::logger_info, cadmium::logger::sim_state>(t, model_id, model_id + " state " + std::to_string(i));
+                }
+                if (i % 2 == 0) {
+                    binary_logger::log<cadmium::logger::logger_info, cadmium::logger::coor_routing_collect>(
+                            std::string("a_out"), std::string("b_in"), std::vector<std::string>{std::to_string(i)}, std::vector<std::string>{std::to_string(i)});
+                }
+            }
+            binary_logger::flush();
+        }
+        return binary_oss.str();
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( binary_trace_index_test_suite )
+
+BOOST_AUTO_TEST_CASE( model_states_are_queried_by_time_test )
+{
+    std::istringstream is(trace());
+    reader r(is, trace_index::build(is));
+
+    std::vector<std::string> states = r.model_states("a", 3.0f, 5.0f);
+    BOOST_REQUIRE_EQUAL(states.size(), 3);
+    BOOST_CHECK_EQUAL(states[0], formatter::sim_state(3.0f, "a", "a state 3"));
+    BOOST_CHECK_EQUAL(states[2], formatter::sim_state(5.0f, "a", "a state 5"));
+
+    BOOST_CHECK_EQUAL(r.model_events("b", 9.0f, 20.0f).size(), 2);
+    BOOST_CHECK(r.model_states("c", 0.0f, 20.0f).empty());
+}
+
+BOOST_AUTO_TEST_CASE( port_messages_are_queried_test )
+{
+    std::istringstream is(trace());
+    reader r(is, trace_index::build(is));
+
+    std::vector<std::string> messages = r.port_messages("b_in");
+    BOOST_REQUIRE_EQUAL(messages.size(), 5);
+    BOOST_CHECK_EQUAL(messages[1], formatter::coor_routing_collect("a_out", "b_in", {"2"}, {"2"}));
+    BOOST_CHECK_EQUAL(r.port_messages("a_out").size(), 5);
+    BOOST_CHECK(r.port_messages("a").empty());
+}
+
+BOOST_AUTO_TEST_CASE( index_is_stored_in_a_sidecar_file_test )
+{
+    std::string path = (std::filesystem::temp_directory_path() / "cadmium_binary_trace_index_test.bin").string();
+    {
+        std::ofstream os(path, std::ios::binary);
+        os << trace();
+    }
+    trace_index built = trace_index::load_or_build(path);
+    BOOST_CHECK(std::filesystem::exists(path + ".idx"));
+    BOOST_CHECK_EQUAL(built.trace_size(), trace().size());
+
+    trace_index loaded = trace_index::load_or_build(path);
+    BOOST_CHECK_EQUAL(loaded.size(), built.size());
+    BOOST_CHECK(loaded.names() == built.names());
+
+    std::ifstream is(path, std::ios::binary);
+    reader r(is, std::move(loaded));
+    BOOST_CHECK_EQUAL(r.model_states("b", 0.0f, 9.0f).size(), 10);
+    is.close();
+
+    std::istringstream not_an_index("not an index");
+    BOOST_CHECK_THROW(trace_index::read(not_an_index), std::domain_error);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".idx");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2013-2017, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <string>
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+#include <cadmium/logger/logger.hpp>
+#include <cadmium/logger/async_sink_provider.hpp>
+#include <cadmium/logger/compressed_sink_provider.hpp>
+#include <cadmium/logger/dynamic_common_loggers.hpp>
+
+namespace {
+    std::ostringstream compressed_oss;
+    std::ostringstream async_compressed_oss;
+
+    struct compressed_oss_sink_provider{
+        static std::ostream& sink(){
+            return compressed_oss;
+        }
+    };
+
+    struct async_compressed_oss_sink_provider{
+        static std::ostream& sink(){
+            return async_compressed_oss;
+        }
+    };
+
+    using formatter=cadmium::dynamic::logger::formatter<float>;
+    using compressed_sink=cadmium::logger::compressed_sink_provider<compressed_oss_sink_provider, 256>;
+    using compressed_logger=cadmium::logger::logger<cadmium::logger::logger_state, formatter, compressed_sink>;
+    using async_compressed_sink=cadmium::logger::compressed_sink_provider<async_compressed_oss_sink_provider, 256>;
+    using async_sink=cadmium::logger::async_sink_provider<async_compressed_sink>;
+    using async_compressed_logger=cadmium::logger::logger<cadmium::logger::logger_state, formatter, async_sink>;
+
+    template<typename LOGGER>
+    std::string log_states(int count) {
+        std::string expected;
+        for (int i = 0; i < count; i++) {
+            LOGGER::template log<cadmium::logger::logger_state, cadmium::logger::sim_state>(static_cast<float>(i), std::string("model"), std::to_string(i));
+            expected += formatter::sim_state(static_cast<float>(i), "model", std::to_string(i)) + "\n";
+        }
+        return expected;
+    }
+
+    std::string decompressed(const std::string& log) {
+        std::istringstream is(log);
+        std::ostringstream os;
+        cadmium::logger::compressed_log::decompress(is, os);
+        return os.str();
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( compressed_sink_provider_test_suite )
+
+BOOST_AUTO_TEST_CASE( compressed_log_decompresses_to_the_text_log_test )
+{
+    std::string expected = log_states<compressed_logger>(100);
+    // the line flushes do not end the frames
+    BOOST_CHECK(decompressed(compressed_oss.str()).size() < expected.size());
+
+    compressed_sink::flush();
+    BOOST_CHECK_EQUAL(decompressed(compressed_oss.str()), expected);
+    BOOST_CHECK(compressed_oss.str().size() < expected.size());
+}
+
+BOOST_AUTO_TEST_CASE( compressed_log_frames_are_decoded_independently_test )
+{
+    compressed_sink::flush();
+    std::string log = compressed_oss.str();
+    std::string text = decompressed(log);
+
+    std::istringstream is(log);
+    auto frames = cadmium::logger::compressed_log::index_frames(is);
+    BOOST_REQUIRE(frames.size() > 1);
+    BOOST_CHECK_EQUAL(frames.back().text_offset + frames.back().size, text.size());
+
+    // seeks to the frame of a character in the middle of the text and decodes it alone
+    std::uint64_t middle = text.size() / 2;
+    auto frame = cadmium::logger::compressed_log::find_frame(frames, middle);
+    BOOST_REQUIRE(frame != frames.end());
+    is.clear();
+    is.seekg(static_cast<std::streamoff>(frame->offset));
+    std::string frame_text;
+    BOOST_REQUIRE(cadmium::logger::compressed_log::read_frame(is, frame_text));
+    BOOST_CHECK_EQUAL(frame_text, text.substr(frame->text_offset, frame->size));
+    BOOST_CHECK(cadmium::logger::compressed_log::find_frame(frames, text.size()) == frames.end());
+
+    std::istringstream corrupted(log.substr(0, log.size() - 1));
+    std::ostringstream os;
+    BOOST_CHECK_THROW(cadmium::logger::compressed_log::decompress(corrupted, os), std::domain_error);
+}
+
+BOOST_AUTO_TEST_CASE( compressed_log_is_written_by_the_async_drainer_test )
+{
+    std::string expected = log_states<async_compressed_logger>(100);
+    async_sink::flush();
+    async_compressed_sink::flush();
+    BOOST_CHECK_EQUAL(decompressed(async_compressed_oss.str()), expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
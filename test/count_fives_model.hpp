@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CADMIUM_TEST_COUNT_FIVES_MODEL_HPP
+#define CADMIUM_TEST_COUNT_FIVES_MODEL_HPP
+
+#include <tuple>
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/basic_model/int_generator_one_sec.hpp>
+#include <cadmium/basic_model/reset_generator_five_sec.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+
+// count fives model: generators coupled model feeding an accumulator coupled model, the accumulator
+// sums the ticks of the one second generator and is reset every five seconds
+namespace count_fives {
+
+    template<typename TIME>
+    using test_accumulator=cadmium::basic_models::accumulator<int, TIME>;
+    using test_accumulator_defs=cadmium::basic_models::accumulator_defs<int>;
+    using int_generator_out=cadmium::basic_models::int_generator_one_sec_defs::out;
+    using reset_generator_out=cadmium::basic_models::reset_generator_five_sec_defs::out;
+
+    using empty_iports = std::tuple<>;
+    using empty_eic=std::tuple<>;
+    using empty_ic=std::tuple<>;
+
+    using generators_oports=std::tuple<int_generator_out, reset_generator_out>;
+    using generators_submodels=cadmium::modeling::models_tuple<cadmium::basic_models::reset_generator_five_sec, cadmium::basic_models::int_generator_one_sec>;
+    using generators_eoc=std::tuple<
+            cadmium::modeling::EOC<cadmium::basic_models::reset_generator_five_sec, reset_generator_out, reset_generator_out>,
+            cadmium::modeling::EOC<cadmium::basic_models::int_generator_one_sec, int_generator_out, int_generator_out>
+    >;
+    template<typename TIME>
+    using coupled_generators_model=cadmium::modeling::coupled_model<TIME, empty_iports, generators_oports, generators_submodels, empty_eic, generators_eoc, empty_ic>;
+
+    using accumulator_eic=std::tuple<
+            cadmium::modeling::EIC<test_accumulator_defs::add, test_accumulator, test_accumulator_defs::add>,
+            cadmium::modeling::EIC<test_accumulator_defs::reset, test_accumulator, test_accumulator_defs::reset>
+    >;
+    using accumulator_eoc=std::tuple<
+            cadmium::modeling::EOC<test_accumulator, test_accumulator_defs::sum, test_accumulator_defs::sum>
+    >;
+    using accumulator_submodels=cadmium::modeling::models_tuple<test_accumulator>;
+    template<typename TIME>
+    using coupled_accumulator_model=cadmium::modeling::coupled_model<TIME, typename test_accumulator<TIME>::input_ports, typename test_accumulator<TIME>::output_ports, accumulator_submodels, accumulator_eic, accumulator_eoc, empty_ic>;
+
+    using top_outport = test_accumulator_defs::sum;
+    using top_oports = std::tuple<top_outport>;
+    using top_submodels=cadmium::modeling::models_tuple<coupled_generators_model, coupled_accumulator_model>;
+    using top_eoc=std::tuple<
+            cadmium::modeling::EOC<coupled_accumulator_model, test_accumulator_defs::sum, top_outport>
+    >;
+    using top_ic=std::tuple<
+            cadmium::modeling::IC<coupled_generators_model, int_generator_out, coupled_accumulator_model, test_accumulator_defs::add>,
+            cadmium::modeling::IC<coupled_generators_model, reset_generator_out, coupled_accumulator_model, test_accumulator_defs::reset>
+    >;
+    template<typename TIME>
+    using top_model=cadmium::modeling::coupled_model<TIME, empty_iports, top_oports, top_submodels, empty_eic, top_eoc, top_ic>;
+}
+
+#endif // CADMIUM_TEST_COUNT_FIVES_MODEL_HPP
@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/modeling/dynamic_id_table.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_dynamic_coordinator.hpp>
+#include <cadmium/engine/pdevs_dynamic_link.hpp>
+
+BOOST_AUTO_TEST_SUITE( dynamic_id_table_test_suite )
+
+    template<typename TIME>
+    using int_accumulator=cadmium::basic_models::accumulator<int, TIME>;
+    using int_accumulator_defs=cadmium::basic_models::accumulator_defs<int>;
+
+    BOOST_AUTO_TEST_CASE( id_table_gives_the_same_handle_to_the_same_id ) {
+        auto& table = cadmium::dynamic::modeling::id_table::instance();
+        cadmium::dynamic::modeling::model_handle first = cadmium::dynamic::modeling::intern_id("interned_first");
+        cadmium::dynamic::modeling::model_handle second = cadmium::dynamic::modeling::intern_id("interned_second");
+        BOOST_CHECK_NE(first, second);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::modeling::intern_id("interned_first"), first);
+
+        // the interned ids keep their address while the table grows
+        const std::string& name = table.name(first);
+        for (int i = 0; i < 1000; i++) {
+            cadmium::dynamic::modeling::intern_id("interned_" + std::to_string(i));
+        }
+        BOOST_CHECK(&table.name(first) == &name);
+        BOOST_CHECK_EQUAL(name, "interned_first");
+        BOOST_CHECK_THROW(table.name(static_cast<cadmium::dynamic::modeling::model_handle>(table.size())), std::out_of_range);
+    }
+
+    BOOST_AUTO_TEST_CASE( engines_keep_the_handle_of_their_model_id ) {
+        auto accumulator = cadmium::dynamic::translate::make_dynamic_atomic_model<int_accumulator, float>("handled_accumulator");
+        cadmium::dynamic::engine::simulator<float, cadmium::logger::not_logger> s(accumulator);
+        BOOST_CHECK_EQUAL(s.get_model_handle(), cadmium::dynamic::modeling::intern_id("handled_accumulator"));
+
+        auto coupled = std::make_shared<cadmium::dynamic::modeling::coupled<float>>(
+                "handled_coupled", cadmium::dynamic::modeling::Models{accumulator}, cadmium::dynamic::modeling::Ports{}, cadmium::dynamic::modeling::Ports{},
+                cadmium::dynamic::modeling::EICs{}, cadmium::dynamic::modeling::EOCs{}, cadmium::dynamic::modeling::ICs{}
+        );
+        cadmium::dynamic::engine::coordinator<float, cadmium::logger::not_logger> c(coupled);
+        BOOST_CHECK_EQUAL(c.get_model_handle(), cadmium::dynamic::modeling::intern_id("handled_coupled"));
+        BOOST_CHECK_EQUAL(c.subengines().front()->get_model_handle(), s.get_model_handle());
+        BOOST_CHECK_EQUAL(cadmium::dynamic::modeling::id_table::instance().name(c.get_model_handle()), "handled_coupled");
+    }
+
+    BOOST_AUTO_TEST_CASE( links_demangle_their_port_names_once ) {
+        using sum_link = cadmium::dynamic::engine::link<int_accumulator_defs::sum, int_accumulator_defs::add>;
+        auto first = std::make_shared<sum_link>();
+        auto second = std::make_shared<sum_link>();
+        BOOST_CHECK(&first->from_port_name() == &second->from_port_name());
+        BOOST_CHECK(&first->to_port_name() == &second->to_port_name());
+        BOOST_CHECK_EQUAL(first->from_port_name(), boost::typeindex::type_id<int_accumulator_defs::sum>().pretty_name());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <stdexcept>
+#include <functional>
+#include <unordered_set>
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_port_key.hpp>
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+
+namespace port_key_test {
+    struct in_a : public cadmium::in_port<int> {};
+    struct in_b : public cadmium::in_port<int> {};
+    struct fixed_in : public cadmium::in_port<double> {};
+    struct only_looked_up : public cadmium::in_port<int> {};
+    struct taken_id : public cadmium::in_port<int> {};
+}
+
+namespace {
+    // another translation unit may declare a port with this same name
+    struct internal_in : public cadmium::in_port<int> {};
+    struct internal_looked_up : public cadmium::in_port<int> {};
+}
+
+template<>
+struct cadmium::port_identifier<port_key_test::fixed_in> : std::integral_constant<cadmium::port_id, 42> {};
+
+BOOST_AUTO_TEST_SUITE( dynamic_port_key_test_suite )
+
+    using cadmium::dynamic::port_key;
+
+    // the ids are known at compile time
+    static_assert(cadmium::port_id_v<port_key_test::in_a> != cadmium::port_id_v<port_key_test::in_b>, "different ports have different ids");
+    static_assert(cadmium::port_id_v<port_key_test::fixed_in> == 42, "the ids can be registered");
+    static_assert(cadmium::port_ids::type_name<port_key_test::in_a>() == "port_key_test::in_a", "the id is the hash of the port name");
+
+    BOOST_AUTO_TEST_CASE( port_keys_are_compared_by_id_test ) {
+        port_key a = port_key::of<port_key_test::in_a>();
+        port_key b = port_key::of<port_key_test::in_b>();
+        BOOST_CHECK_EQUAL(a.id(), cadmium::port_id_v<port_key_test::in_a>);
+        BOOST_CHECK(a.type() == typeid(port_key_test::in_a));
+        BOOST_CHECK(a == port_key::of<port_key_test::in_a>());
+        BOOST_CHECK(a != b);
+        BOOST_CHECK((a < b) == (a.id() < b.id()));
+        BOOST_CHECK_EQUAL(std::hash<port_key>()(a), static_cast<std::size_t>(a.id()));
+        BOOST_CHECK_EQUAL(port_key::of<port_key_test::fixed_in>().id(), 42);
+
+        std::unordered_set<port_key> keys{a, b, port_key::of<port_key_test::in_a>()};
+        BOOST_CHECK_EQUAL(keys.size(), 2);
+    }
+
+    BOOST_AUTO_TEST_CASE( port_keys_converted_from_typeid_have_the_same_id_test ) {
+        // a registered port gets its registered id
+        port_key fixed = typeid(port_key_test::fixed_in);
+        BOOST_CHECK(fixed == port_key::of<port_key_test::fixed_in>());
+        BOOST_CHECK_EQUAL(fixed.id(), 42);
+
+        port_key a = std::type_index(typeid(port_key_test::in_a));
+        BOOST_CHECK(a == port_key::of<port_key_test::in_a>());
+
+        // a port never keyed at compile time gets the hash of its name, as the keyed ones
+        port_key looked_up = typeid(port_key_test::only_looked_up);
+        BOOST_CHECK_EQUAL(looked_up.id(), cadmium::port_ids::hash("port_key_test::only_looked_up"));
+    }
+
+    BOOST_AUTO_TEST_CASE( port_registry_reports_ports_with_the_same_id_test ) {
+        auto& registry = cadmium::dynamic::port_registry::instance();
+        BOOST_CHECK_THROW(registry.add(typeid(port_key_test::in_b), 42), std::domain_error);
+        port_key looked_up = typeid(port_key_test::only_looked_up);
+        BOOST_CHECK_THROW(registry.add(typeid(port_key_test::only_looked_up), looked_up.id() + 1), std::domain_error);
+    }
+
+    BOOST_AUTO_TEST_CASE( ports_in_an_anonymous_namespace_get_a_free_id_test ) {
+        BOOST_CHECK(cadmium::port_ids::internal_linkage(cadmium::port_ids::type_name<internal_in>()));
+        BOOST_CHECK(!cadmium::port_ids::internal_linkage(cadmium::port_ids::type_name<port_key_test::in_a>()));
+        BOOST_CHECK(cadmium::port_ids::keyed_at_run_time<internal_in>::value);
+        BOOST_CHECK(!cadmium::port_ids::keyed_at_run_time<port_key_test::in_a>::value);
+
+        // the hash of the name is taken, as by a port with the same name in another translation unit
+        auto& registry = cadmium::dynamic::port_registry::instance();
+        registry.add(typeid(port_key_test::taken_id), cadmium::port_id_v<internal_in>);
+        port_key internal = port_key::of<internal_in>();
+        BOOST_CHECK_NE(internal.id(), cadmium::port_id_v<internal_in>);
+        BOOST_CHECK(internal == port_key::of<internal_in>());
+        BOOST_CHECK(internal == port_key(typeid(internal_in)));
+
+        port_key looked_up = typeid(internal_looked_up);
+        BOOST_CHECK(looked_up == port_key::of<internal_looked_up>());
+        BOOST_CHECK_NO_THROW(registry.check());
+    }
+
+    BOOST_AUTO_TEST_CASE( bags_find_the_ports_by_key_test ) {
+        cadmium::dynamic::message_bags bags({port_key::of<port_key_test::in_a>(), port_key::of<port_key_test::fixed_in>()});
+        BOOST_CHECK_EQUAL(bags.slot_of(typeid(port_key_test::fixed_in)), 1);
+        BOOST_CHECK_EQUAL(bags.slot_of(port_key::of<port_key_test::in_b>()), cadmium::dynamic::message_bags::no_slot);
+        BOOST_CHECK(bags.port_in_slot(0).type() == typeid(port_key_test::in_a));
+    }
+
+    // the last case, the conflict it records stays in the registry
+    BOOST_AUTO_TEST_CASE( port_registry_keeps_the_conflicts_found_when_the_program_starts_test ) {
+        auto& registry = cadmium::dynamic::port_registry::instance();
+        BOOST_CHECK_NO_THROW(registry.check());
+        BOOST_CHECK_NO_THROW(registry.record(typeid(port_key_test::in_b), 42));
+        BOOST_CHECK_THROW(registry.check(), std::domain_error);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -98,5 +98,42 @@ BOOST_AUTO_TEST_CASE( multiple_loggers_test )
 
 }
 
+BOOST_AUTO_TEST_CASE( logs_source_test )
+{
+    using log1=cadmium::logger::logger<cadmium::logger::logger_info, cadmium::logger::formatter<float>, oss_test_sink_provider>;
+    using log2=cadmium::logger::logger<cadmium::logger::logger_debug, cadmium::logger::formatter<float>, oss_test_second_sink_provider>;
+
+    BOOST_CHECK((cadmium::logger::logs_source<log1, cadmium::logger::logger_info>::value));
+    BOOST_CHECK((!cadmium::logger::logs_source<log1, cadmium::logger::logger_message_routing>::value));
+    BOOST_CHECK((cadmium::logger::logs_source<cadmium::logger::multilogger<log1, log2>, cadmium::logger::logger_debug>::value));
+    BOOST_CHECK((!cadmium::logger::logs_source<cadmium::logger::multilogger<log1, log2>, cadmium::logger::logger_state>::value));
+    BOOST_CHECK((!cadmium::logger::logs_source<cadmium::logger::not_logger, cadmium::logger::logger_message_routing>::value));
+
+    BOOST_CHECK(log1::enabled<cadmium::logger::logger_info>);
+    BOOST_CHECK(!log1::enabled<cadmium::logger::logger_debug>);
+    BOOST_CHECK((cadmium::logger::multilogger<log1, log2>::enabled<cadmium::logger::logger_debug>));
+    BOOST_CHECK(!cadmium::logger::multilogger<>::enabled<cadmium::logger::logger_info>);
+}
+
+BOOST_AUTO_TEST_CASE( sources_logger_test )
+{
+    oss.str("");
+    using sources=std::tuple<cadmium::logger::logger_info, cadmium::logger::logger_debug>;
+    using l=cadmium::logger::sources_logger<sources, cadmium::logger::formatter<float>, oss_test_sink_provider>;
+
+    l::log<cadmium::logger::logger_info, cadmium::logger::run_info>("some info");
+    l::log<cadmium::logger::logger_debug, cadmium::logger::run_info>("some debug");
+    l::log<cadmium::logger::logger_state, cadmium::logger::run_info>("some state");
+    BOOST_CHECK_EQUAL(oss.str(), "some info\nsome debug\n");
+    BOOST_CHECK(l::enabled<cadmium::logger::logger_debug>);
+    BOOST_CHECK(!l::enabled<cadmium::logger::logger_state>);
+
+    // only the listed events are logged
+    oss.str("");
+    using events_logger=cadmium::logger::sources_logger<sources, cadmium::logger::formatter<float>, oss_test_sink_provider, std::tuple<cadmium::logger::run_global_time>>;
+    events_logger::log<cadmium::logger::logger_info, cadmium::logger::run_info>("some info");
+    events_logger::log<cadmium::logger::logger_info, cadmium::logger::run_global_time>(1.5f);
+    BOOST_CHECK_EQUAL(oss.str(), "1.5\n");
+}
 
 BOOST_AUTO_TEST_SUITE_END()
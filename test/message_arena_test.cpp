@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <thread>
+#include <boost/test/unit_test.hpp>
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+#include <cadmium/modeling/message_arena.hpp>
+#include <cadmium/basic_model/generator.hpp>
+
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+
+// message stored in the message arena
+struct arena_tick {
+    int value;
+};
+
+namespace cadmium {
+    template<>
+    struct message_allocator<arena_tick> {
+        using type = cadmium::arena_allocator<arena_tick>;
+    };
+}
+
+BOOST_AUTO_TEST_SUITE( message_arena_test_suite )
+
+    struct arena_in : public cadmium::in_port<arena_tick> {};
+    struct int_in : public cadmium::in_port<int> {};
+
+    BOOST_AUTO_TEST_CASE( message_bags_use_the_allocator_of_their_message_type_test ) {
+        BOOST_CHECK((std::is_same<cadmium::message_bag<arena_in>::allocator_type, cadmium::arena_allocator<arena_tick>>::value));
+        BOOST_CHECK((std::is_same<cadmium::message_bag<int_in>::allocator_type, std::allocator<int>>::value));
+        BOOST_CHECK((std::is_same<cadmium::message_bag<int_in, cadmium::arena_allocator<int>>::allocator_type, cadmium::arena_allocator<int>>::value));
+    }
+
+    BOOST_AUTO_TEST_CASE( arena_release_is_deferred_while_messages_are_alive_test ) {
+        cadmium::message_arena& arena = cadmium::message_arena::instance();
+        arena.release();
+        auto releases = arena.stats().releases;
+
+        const arena_tick* first;
+        {
+            cadmium::message_bag<arena_in> b;
+            for (int i = 0; i < 100; i++) {
+                b.messages.push_back(arena_tick{i});
+            }
+            first = b.messages.data();
+            BOOST_CHECK_EQUAL(arena.live_allocations(), 1);
+            BOOST_CHECK(!arena.release());
+            BOOST_CHECK_EQUAL(arena.stats().releases, releases);
+            BOOST_CHECK_EQUAL(b.messages[99].value, 99);
+        }
+        BOOST_CHECK_EQUAL(arena.live_allocations(), 0);
+        BOOST_CHECK(arena.release());
+        BOOST_CHECK_EQUAL(arena.stats().releases, releases + 1);
+        // nothing allocated since the last release
+        BOOST_CHECK(!arena.release());
+
+        // the memory is reused after a release
+        cadmium::message_bag<arena_in> b;
+        b.messages.push_back(arena_tick{1});
+        cadmium::message_bag<arena_in> c;
+        c.messages.reserve(1000);
+        BOOST_CHECK(c.messages.data() != b.messages.data());
+        BOOST_CHECK(reinterpret_cast<const char*>(first) - reinterpret_cast<const char*>(b.messages.data()) < static_cast<std::ptrdiff_t>(cadmium::message_arena::block_size));
+    }
+
+    BOOST_AUTO_TEST_CASE( arena_local_release_only_resets_the_calling_thread_test ) {
+        cadmium::message_arena& arena = cadmium::message_arena::instance();
+        arena.release();
+        cadmium::message_bag<arena_in> kept;
+        kept.messages.push_back(arena_tick{7});
+        bool released = false;
+        std::thread other([&released]() {
+            {
+                cadmium::message_bag<arena_in> b;
+                b.messages.push_back(arena_tick{1});
+            }
+            // the bag kept by the main thread does not defer the release of this thread
+            released = cadmium::message_arena::instance().release_local();
+        });
+        other.join();
+        BOOST_CHECK(released);
+        BOOST_CHECK(!arena.release_local());
+        BOOST_CHECK_EQUAL(kept.messages[0].value, 7);
+    }
+
+    BOOST_AUTO_TEST_CASE( arena_allocates_larger_than_block_size_test ) {
+        cadmium::message_bag<arena_in> b;
+        b.messages.resize(cadmium::message_arena::block_size);
+        b.messages.back().value = 3;
+        BOOST_CHECK_EQUAL(b.messages.back().value, 3);
+        BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(b.messages.data()) % alignof(arena_tick), 0);
+    }
+
+    // generator of arena messages in a coupled model
+    using arena_out = cadmium::basic_models::generator_defs<arena_tick>::out;
+
+    template<typename TIME>
+    struct arena_generator : public cadmium::basic_models::generator<arena_tick, TIME> {
+        float period() const override {
+            return 1.0f;
+        }
+        arena_tick output_message() const override {
+            return arena_tick{1};
+        }
+    };
+
+    struct coupled_arena_out : public cadmium::out_port<arena_tick> {};
+
+    template<typename TIME>
+    using arena_coupled = cadmium::modeling::coupled_model<TIME, std::tuple<>, std::tuple<coupled_arena_out>,
+            cadmium::modeling::models_tuple<arena_generator>, std::tuple<>,
+            std::tuple<cadmium::modeling::EOC<arena_generator, arena_out, coupled_arena_out>>, std::tuple<>>;
+
+    BOOST_AUTO_TEST_CASE( dynamic_runner_releases_the_arena_after_each_step_test ) {
+        cadmium::message_arena& arena = cadmium::message_arena::instance();
+        arena.release();
+        auto before = arena.stats();
+
+        auto coupled = cadmium::dynamic::translate::make_dynamic_coupled_model<float, arena_coupled>();
+        cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(coupled, 0.0);
+        BOOST_CHECK_EQUAL(r.run_until(10.0), 10.0);
+
+        auto after = arena.stats();
+        BOOST_CHECK(after.allocations > before.allocations);
+        BOOST_CHECK(after.releases > before.releases);
+        // one block is enough because the memory is reused at each step
+        BOOST_CHECK(after.blocks <= before.blocks + 1);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
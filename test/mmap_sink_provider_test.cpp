@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2013-2017, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <boost/test/unit_test.hpp>
+#include <cadmium/logger/logger.hpp>
+#include <cadmium/logger/binary_logger.hpp>
+#include <cadmium/logger/mmap_sink_provider.hpp>
+#include <cadmium/logger/dynamic_common_loggers.hpp>
+
+namespace {
+    std::string temp_path(const std::string& name) {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    std::string file_contents(const std::string& path) {
+        std::ifstream is(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    }
+
+    struct trace_path {
+        static std::string path() {
+            return temp_path("cadmium_mmap_sink_provider_test.bin");
+        }
+    };
+
+    using formatter=cadmium::dynamic::logger::formatter<float>;
+    using mmap_sink=cadmium::logger::mmap_sink_provider<trace_path, 4096>;
+    using binary_logger=cadmium::logger::binary_logger<cadmium::logger::logger_info, float, mmap_sink>;
+
+    std::ostringstream text_oss;
+
+    struct text_sink_provider{
+        static std::ostream& sink(){
+            return text_oss;
+        }
+    };
+
+    using text_logger=cadmium::logger::logger<cadmium::logger::logger_info, formatter, text_sink_provider>;
+    using both_loggers=cadmium::logger::multilogger<text_logger, binary_logger>;
+}
+
+BOOST_AUTO_TEST_SUITE( mmap_sink_provider_test_suite )
+
+BOOST_AUTO_TEST_CASE( mmap_streambuf_grows_by_chunks_test )
+{
+    std::string path = temp_path("cadmium_mmap_streambuf_test.txt");
+    std::string expected;
+    {
+        cadmium::logger::mmap_streambuf buf(path, 1);
+        std::ostream os(&buf);
+        std::size_t first_map = buf.mapped_size();
+        BOOST_CHECK(first_map > 0);
+
+        for (int i = 0; i < 2000; i++) {
+            os << "record " << i << '\n';
+            expected += "record " + std::to_string(i) + '\n';
+        }
+        os.flush();
+        BOOST_CHECK(buf.mapped_size() > first_map);
+        BOOST_CHECK_EQUAL(buf.mapped_size() % first_map, 0);
+
+        // the written records are read from the file while it is open, the tail is zeroed
+        std::string open_contents = file_contents(path);
+        BOOST_CHECK_EQUAL(open_contents.size(), buf.mapped_size());
+        BOOST_CHECK_EQUAL(open_contents.substr(0, expected.size()), expected);
+        BOOST_CHECK(open_contents.find_first_not_of('\0', expected.size()) == std::string::npos);
+    }
+    BOOST_CHECK_EQUAL(file_contents(path), expected);
+    std::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE( mmap_sink_provider_stores_the_binary_trace_test )
+{
+    std::string model_id = "generator";
+    for (int i = 0; i < 500; i++) {
+        both_loggers::log<cadmium::logger::logger_info, cadmium::logger::sim_state>(static_cast<float>(i), model_id, std::to_string(i));
+        both_loggers::log<cadmium::logger::logger_info, cadmium::logger::sim_info_advance>(static_cast<float>(i), i + 1.0f, model_id);
+    }
+    binary_logger::flush();
+    mmap_sink::close();
+
+    std::ifstream is(trace_path::path(), std::ios::binary);
+    std::ostringstream os;
+    cadmium::logger::convert_binary_trace<float, formatter>(is, os);
+    BOOST_CHECK_EQUAL(os.str(), text_oss.str());
+    is.close();
+    std::filesystem::remove(trace_path::path());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
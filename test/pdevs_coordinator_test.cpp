@@ -295,6 +295,25 @@ BOOST_AUTO_TEST_CASE( generators_send_to_accumulator_and_output_in_two_coupled_m
 
 
 
+BOOST_AUTO_TEST_CASE( parallel_execution_matches_sequential_execution_test ){
+    cadmium::engine::coordinator<top_model, float, cadmium::logger::not_logger> sequential;
+    cadmium::engine::coordinator<top_model, float, cadmium::logger::not_logger, cadmium::engine::parallel_execution> parallel;
+    sequential.init(0);
+    parallel.init(0, cadmium::engine::parallel_execution(4));
+
+    //the generators are simultaneous every 5 seconds, their outputs and transitions run concurrently
+    for (int i=0; i < 30; i++) {
+        BOOST_REQUIRE_EQUAL(sequential.next(), parallel.next());
+        float t = sequential.next();
+        sequential.collect_outputs(t);
+        parallel.collect_outputs(t);
+        BOOST_CHECK(cadmium::get_messages<top_outport>(sequential.outbox()) == cadmium::get_messages<top_outport>(parallel.outbox()));
+        sequential.advance_simulation(t);
+        parallel.advance_simulation(t);
+    }
+    BOOST_CHECK_EQUAL(sequential.next(), parallel.next());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
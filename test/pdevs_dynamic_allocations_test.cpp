@@ -0,0 +1,218 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <limits>
+#include <sstream>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+#include <cadmium/basic_model/generator.hpp>
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_arena.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/dynamic_input_view.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+// this test binary counts its allocations
+#include <cadmium/engine/pdevs_dynamic_allocation_hook.hpp>
+
+// the samples are allocated in the message arena, which reuses its blocks at every step
+struct test_sample {
+    int value;
+};
+
+std::ostream& operator<<(std::ostream& os, const test_sample& s) {
+    return os << s.value;
+}
+
+template<>
+struct cadmium::message_allocator<test_sample> {
+    using type = cadmium::arena_allocator<test_sample>;
+};
+
+int value_of(int v) {
+    return v;
+}
+
+int value_of(const test_sample& s) {
+    return s.value;
+}
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_allocations_test_suite )
+
+    // a generator of MESSAGE every second
+    template<typename MESSAGE>
+    struct test_generator_of {
+        template<typename TIME>
+        struct type : public cadmium::basic_models::generator<MESSAGE, TIME> {
+            TIME period() const override {
+                return 1.0;
+            }
+            MESSAGE output_message() const override {
+                return MESSAGE{1};
+            }
+        };
+    };
+
+    template<typename TIME>
+    using test_int_generator = test_generator_of<int>::type<TIME>;
+    template<typename TIME>
+    using test_sample_generator = test_generator_of<test_sample>::type<TIME>;
+
+    // a passive model adding its inputs, read through an input_view
+    template<typename MESSAGE>
+    struct test_sum_of {
+        struct in : public cadmium::in_port<MESSAGE> {};
+
+        template<typename TIME>
+        struct type {
+            using input_ports = std::tuple<in>;
+            using output_ports = std::tuple<>;
+            using input_view = cadmium::dynamic::modeling::input_view<input_ports>;
+
+            using state_type = int;
+            state_type state = 0;
+
+            void internal_transition() {}
+
+            void external_transition(TIME, typename cadmium::make_message_bags<input_ports>::type) {}
+
+            void confluence_transition(TIME, typename cadmium::make_message_bags<input_ports>::type) {}
+
+            void external_transition(TIME, const input_view& view) {
+                for (const MESSAGE& m : cadmium::get_messages<in>(view)) {
+                    state += value_of(m);
+                }
+            }
+
+            void confluence_transition(TIME e, const input_view& view) {
+                external_transition(e, view);
+            }
+
+            typename cadmium::make_message_bags<output_ports>::type output() const {
+                return {};
+            }
+
+            TIME time_advance() const {
+                return std::numeric_limits<TIME>::infinity();
+            }
+        };
+    };
+
+    template<typename TIME>
+    using test_int_sum = test_sum_of<int>::type<TIME>;
+    template<typename TIME>
+    using test_sample_sum = test_sum_of<test_sample>::type<TIME>;
+
+    template<typename TIME>
+    using int_generator_to_sum = cadmium::modeling::coupled_model<TIME, std::tuple<>, std::tuple<>,
+            cadmium::modeling::models_tuple<test_int_generator, test_int_sum>, std::tuple<>, std::tuple<>,
+            std::tuple<cadmium::modeling::IC<test_int_generator, cadmium::basic_models::generator_defs<int>::out, test_int_sum, test_sum_of<int>::in>>>;
+
+    template<typename TIME>
+    using sample_generator_to_sum = cadmium::modeling::coupled_model<TIME, std::tuple<>, std::tuple<>,
+            cadmium::modeling::models_tuple<test_sample_generator, test_sample_sum>, std::tuple<>, std::tuple<>,
+            std::tuple<cadmium::modeling::IC<test_sample_generator, cadmium::basic_models::generator_defs<test_sample>::out, test_sample_sum, test_sum_of<test_sample>::in>>>;
+
+    using runner_type = cadmium::dynamic::engine::runner<double, cadmium::logger::not_logger>;
+
+    BOOST_AUTO_TEST_CASE( allocation_hook_counts_the_allocations_test ) {
+        BOOST_REQUIRE(cadmium::dynamic::engine::allocation_hook::installed());
+        auto before = cadmium::dynamic::engine::allocation_hook::local();
+        auto total_before = cadmium::dynamic::engine::allocation_hook::total();
+        std::vector<int>* v = new std::vector<int>(100);
+        auto after = cadmium::dynamic::engine::allocation_hook::local();
+        delete v;
+        BOOST_CHECK_EQUAL(after.allocations - before.allocations, 2);
+        BOOST_CHECK_EQUAL(after.bytes - before.bytes, sizeof(std::vector<int>) + 100 * sizeof(int));
+        BOOST_CHECK_GE(cadmium::dynamic::engine::allocation_hook::total().allocations - total_before.allocations, 2);
+    }
+
+    BOOST_AUTO_TEST_CASE( runner_counts_the_allocations_by_step_and_engine_test ) {
+        runner_type r(cadmium::dynamic::translate::make_dynamic_coupled_model<double, int_generator_to_sum>(), 0.0);
+        BOOST_CHECK(r.allocations() == nullptr);
+        BOOST_CHECK(r.enable_allocation_counting(2));
+        r.run_until(10.0);
+
+        const auto* allocations = r.allocations();
+        BOOST_REQUIRE(allocations != nullptr);
+        BOOST_CHECK_EQUAL(allocations->steps(), 9);
+        BOOST_CHECK_EQUAL(allocations->steady_steps(), 7);
+
+        // the bag returned by the generator output is allocated at every step, the engines reuse their buffers
+        BOOST_CHECK_EQUAL(allocations->allocating_steady_steps(), 7);
+        BOOST_CHECK_EQUAL(allocations->steady().allocations, 7);
+        BOOST_CHECK_EQUAL(allocations->max_step_allocations(), 1);
+        BOOST_REQUIRE_EQUAL(allocations->allocating_steps().size(), 7);
+        BOOST_CHECK_EQUAL(allocations->allocating_steps()[0].time, 3.0);
+        BOOST_CHECK_EQUAL(allocations->allocating_steps()[0].count.bytes, sizeof(int));
+
+        const auto& engines = allocations->engines();
+        BOOST_REQUIRE_EQUAL(engines.levels().size(), 1);
+        BOOST_CHECK_EQUAL(engines.levels()[0][1].allocations, 0); // route
+        BOOST_CHECK_EQUAL(engines.levels()[0][2].allocations, 0); // advance
+        BOOST_REQUIRE_EQUAL(engines.models().size(), 2);
+        const bool generator_first = engines.models()[0].model_id.find("generator") != std::string::npos;
+        const auto& generator = engines.models()[generator_first ? 0 : 1];
+        const auto& sum = engines.models()[generator_first ? 1 : 0];
+        BOOST_CHECK_EQUAL(generator.collect.allocations, 9);
+        BOOST_CHECK_EQUAL(generator.advance.allocations, 0);
+        BOOST_CHECK_EQUAL(sum.collect.allocations, 0);
+        BOOST_CHECK_EQUAL(sum.advance.allocations, 0);
+        BOOST_CHECK_GE(engines.levels()[0][0].allocations, 9); // collect
+
+        std::ostringstream os;
+        cadmium::dynamic::engine::write_step_allocations(os, *allocations);
+        BOOST_CHECK(os.str().find("steps=9 steady_steps=7 ") == 0);
+        BOOST_CHECK(os.str().find("time=3 allocations=1 bytes=4\n") != std::string::npos);
+        BOOST_CHECK(os.str().find("\"" + generator.model_id + "\",collect,9,36\n") != std::string::npos);
+        BOOST_CHECK(os.str().find(sum.model_id) == std::string::npos);
+    }
+
+    BOOST_AUTO_TEST_CASE( runner_fails_on_a_steady_step_allocating_test ) {
+        runner_type r(cadmium::dynamic::translate::make_dynamic_coupled_model<double, int_generator_to_sum>(), 0.0);
+        r.enable_allocation_counting(2, true);
+        r.run_until(2.5);
+        BOOST_CHECK_THROW(r.step(), std::domain_error);
+        // the step was run before failing
+        BOOST_CHECK_EQUAL(r.next(), 4.0);
+
+        r.disable_allocation_counting();
+        BOOST_CHECK(r.allocations() == nullptr);
+        BOOST_CHECK_EQUAL(r.run_until(10.0), 10.0);
+    }
+
+    BOOST_AUTO_TEST_CASE( runner_steady_steps_with_arena_messages_do_not_allocate_test ) {
+        runner_type r(cadmium::dynamic::translate::make_dynamic_coupled_model<double, sample_generator_to_sum>(), 0.0);
+        r.enable_allocation_counting(2, true);
+        BOOST_CHECK_EQUAL(r.run_until(100.0), 100.0);
+        BOOST_CHECK_EQUAL(r.allocations()->steady_steps(), 97);
+        BOOST_CHECK_EQUAL(r.allocations()->steady().allocations, 0);
+        BOOST_CHECK(r.allocations()->allocating_steps().empty());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -32,6 +32,7 @@
 #include <cadmium/basic_model/generator.hpp>
 #include <cadmium/modeling/dynamic_models_helpers.hpp>
 #include <typeindex>
+#include <vector>
 
 /**
   * This test is for some common helper functions used by the dynamic atomic class
@@ -51,7 +52,7 @@ BOOST_AUTO_TEST_SUITE( pdevs_dynamic_atomic_helpers_test_suite )
             bag_1.messages.push_back(1.5);
             bag_1.messages.push_back(2.5);
 
-            std::map<std::type_index, boost::any> bs_map;
+            cadmium::dynamic::message_bags bs_map;
             bs_map[typeid(test_in_0)] = bag_0;
             bs_map[typeid(test_in_1)] = bag_1;
 
@@ -64,6 +65,65 @@ BOOST_AUTO_TEST_SUITE( pdevs_dynamic_atomic_helpers_test_suite )
             BOOST_CHECK_EQUAL(bag_1.messages.size(), cadmium::get_messages<test_in_1>(bs_tuple).size());
     }
 
+    BOOST_AUTO_TEST_CASE(move_bags_from_map_test){
+
+            struct test_in_0: public cadmium::in_port<int>{};
+            struct test_in_1: public cadmium::in_port<double>{};
+
+            cadmium::message_bag<test_in_0> bag_0;
+            bag_0.messages.push_back(1);
+            bag_0.messages.push_back(2);
+
+            cadmium::dynamic::message_bags bs_map;
+            bs_map[typeid(test_in_0)] = bag_0;
+            const int* buffer = cadmium::dynamic::bag_cast<cadmium::message_bag<test_in_0>&>(bs_map.at(typeid(test_in_0))).messages.data();
+
+            using test_input_ports=std::tuple<test_in_0, test_in_1>;
+            using input_bags=typename cadmium::make_message_bags<test_input_ports>::type;
+
+            input_bags bs_tuple;
+            cadmium::dynamic::modeling::move_bags_from_map<input_bags>(std::move(bs_map), bs_tuple);
+            BOOST_CHECK(bag_0.messages == cadmium::get_messages<test_in_0>(bs_tuple));
+            BOOST_CHECK(cadmium::get_messages<test_in_1>(bs_tuple).empty());
+            // the messages buffer is moved, not copied
+            BOOST_CHECK(buffer == cadmium::get_messages<test_in_0>(bs_tuple).data());
+            BOOST_CHECK(cadmium::dynamic::bag_cast<cadmium::message_bag<test_in_0>&>(bs_map.at(typeid(test_in_0))).messages.empty());
+    }
+
+    BOOST_AUTO_TEST_CASE(move_map_from_bags_test){
+
+            struct test_out_0: public cadmium::out_port<int>{};
+            struct test_out_1: public cadmium::out_port<double>{};
+
+            using test_output_ports=std::tuple<test_out_0, test_out_1>;
+            using output_bags=typename cadmium::make_message_bags<test_output_ports>::type;
+
+            output_bags bs_tuple;
+            cadmium::get_messages<test_out_1>(bs_tuple).push_back(1.5);
+            const double* buffer = cadmium::get_messages<test_out_1>(bs_tuple).data();
+
+            cadmium::dynamic::message_bags bs_map({typeid(test_out_0), typeid(test_out_1)});
+            cadmium::dynamic::modeling::move_map_from_bags<output_bags>(bs_tuple, bs_map);
+
+            // only the port with messages gets a bag, the messages buffer is moved
+            BOOST_CHECK_EQUAL(bs_map.size(), 1);
+            BOOST_CHECK(bs_map.find(typeid(test_out_0)) == bs_map.end());
+            const auto& map_bag_1 = cadmium::dynamic::bag_cast<const cadmium::message_bag<test_out_1>&>(bs_map.at(typeid(test_out_1)));
+            BOOST_CHECK_EQUAL(map_bag_1.messages.size(), 1);
+            BOOST_CHECK(buffer == map_bag_1.messages.data());
+            BOOST_CHECK(cadmium::get_messages<test_out_1>(bs_tuple).empty());
+
+            // the messages are appended to a bag with messages, the ports without slot get one
+            cadmium::dynamic::message_bags sparse;
+            cadmium::get_messages<test_out_1>(bs_tuple).push_back(2.5);
+            cadmium::dynamic::modeling::move_map_from_bags<output_bags>(bs_tuple, sparse);
+            cadmium::get_messages<test_out_1>(bs_tuple).push_back(3.5);
+            cadmium::dynamic::modeling::move_map_from_bags<output_bags>(bs_tuple, sparse);
+            BOOST_CHECK_EQUAL(sparse.slots(), 1);
+            const auto& sparse_bag_1 = cadmium::dynamic::bag_cast<const cadmium::message_bag<test_out_1>&>(sparse.at(typeid(test_out_1)));
+            BOOST_CHECK(sparse_bag_1.messages == std::vector<double>({2.5, 3.5}));
+    }
+
     BOOST_AUTO_TEST_CASE(fill_map_from_bags_test){
 
             struct test_in_0: public cadmium::in_port<int>{};
@@ -82,16 +142,16 @@ BOOST_AUTO_TEST_SUITE( pdevs_dynamic_atomic_helpers_test_suite )
             cadmium::get_messages<test_in_1>(bs_tuple).push_back(1.5);
             cadmium::get_messages<test_in_1>(bs_tuple).push_back(2.5);
 
-            std::map<std::type_index, boost::any> bs_map;
+            cadmium::dynamic::message_bags bs_map;
 
             cadmium::dynamic::modeling::fill_map_from_bags<input_bags>(bs_tuple, bs_map);
 
             bag_0 tuple_bag_0 = std::get<0>(bs_tuple);
-            bag_0 map_bag_0 = boost::any_cast<bag_0>(bs_map.at(typeid(test_in_0)));
+            bag_0 map_bag_0 = cadmium::dynamic::bag_cast<bag_0>(bs_map.at(typeid(test_in_0)));
             BOOST_CHECK_EQUAL(map_bag_0.messages.size(), tuple_bag_0.messages.size());
 
             bag_1 tuple_bag_1 = std::get<1>(bs_tuple);
-            bag_1 map_bag_1 = boost::any_cast<bag_1>(bs_map.at(typeid(test_in_1)));
+            bag_1 map_bag_1 = cadmium::dynamic::bag_cast<bag_1>(bs_map.at(typeid(test_in_1)));
             BOOST_CHECK_EQUAL(map_bag_1.messages.size(), tuple_bag_1.messages.size());
     }
 
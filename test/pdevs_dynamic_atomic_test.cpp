@@ -30,6 +30,7 @@
 #include <cadmium/basic_model/accumulator.hpp>
 #include <cadmium/modeling/dynamic_atomic.hpp>
 #include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/ports.hpp>
 
 /**
   * This test is for the dynamic atomic class that wraps an atomic model to make it pointer friendly
@@ -45,6 +46,55 @@ struct test_custom_acumulator : public cadmium::basic_models::accumulator<int, T
     test_custom_acumulator(int a) {}
 };
 
+// an atomic model reading its inputs through an input_view, the state tells which transitions were used
+struct view_in_a : public cadmium::in_port<int> {};
+struct view_in_b : public cadmium::in_port<int> {};
+struct view_out : public cadmium::out_port<int> {};
+
+template<typename TIME>
+struct test_view_model {
+    using input_ports = std::tuple<view_in_a, view_in_b>;
+    using output_ports = std::tuple<view_out>;
+    using input_view = cadmium::dynamic::modeling::input_view<input_ports>;
+
+    struct state_type {
+        int sum = 0;
+        int view_transitions = 0;
+        bool b_received = false;
+    };
+    state_type state;
+
+    void internal_transition() {}
+
+    void external_transition(TIME, typename cadmium::make_message_bags<input_ports>::type) {}
+
+    void confluence_transition(TIME, typename cadmium::make_message_bags<input_ports>::type) {}
+
+    void external_transition(TIME, const input_view& view) {
+        for (int m : cadmium::get_messages<view_in_a>(view)) {
+            state.sum += m;
+        }
+        state.b_received = view.template has_messages<view_in_b>();
+        state.view_transitions++;
+    }
+
+    void confluence_transition(TIME e, const input_view& view) {
+        external_transition(e, view);
+    }
+
+    typename cadmium::make_message_bags<output_ports>::type output() const {
+        return {};
+    }
+
+    TIME time_advance() const {
+        return std::numeric_limits<TIME>::infinity();
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const state_type& s) {
+        return os << s.sum;
+    }
+};
+
 BOOST_AUTO_TEST_SUITE( pdevs_dynamic_atomic_test_suite )
 
     BOOST_AUTO_TEST_CASE(create_dynamic_atomic_test) {
@@ -59,4 +109,30 @@ BOOST_AUTO_TEST_SUITE( pdevs_dynamic_atomic_test_suite )
         std::shared_ptr<cadmium::dynamic::modeling::atomic_abstract<float>> atomic_model = cadmium::dynamic::translate::make_dynamic_atomic_model<test_custom_acumulator, float, int>("id_test", 2);
     }
 
+    BOOST_AUTO_TEST_CASE(transitions_get_an_input_view_test) {
+        cadmium::dynamic::modeling::atomic<test_view_model, float> wrapped_model;
+        static_assert(cadmium::dynamic::modeling::has_external_transition_view<test_view_model<float>, float>::value);
+        static_assert(!cadmium::dynamic::modeling::has_external_transition_view<int_accumulator<float>, float>::value);
+
+        // the inbox made from the model ports, as the simulators do
+        cadmium::dynamic::message_bags bags(wrapped_model.get_input_ports());
+        bags.get_bag<cadmium::message_bag<view_in_a>>(typeid(view_in_a)).messages = {1, 2, 3};
+        wrapped_model.external_transition(0.5f, std::move(bags));
+        BOOST_CHECK_EQUAL(wrapped_model.state.sum, 6);
+        BOOST_CHECK(!wrapped_model.state.b_received);
+
+        // bags in other slots than their ports
+        cadmium::dynamic::message_bags other_bags;
+        other_bags.get_bag<cadmium::message_bag<view_in_b>>(typeid(view_in_b)).messages = {5};
+        other_bags.get_bag<cadmium::message_bag<view_in_a>>(typeid(view_in_a)).messages = {4};
+        wrapped_model.confluence_transition(0.5f, std::move(other_bags));
+        BOOST_CHECK_EQUAL(wrapped_model.state.sum, 10);
+        BOOST_CHECK(wrapped_model.state.b_received);
+
+        // no bag at all
+        wrapped_model.external_transition(0.5f, cadmium::dynamic::message_bags());
+        BOOST_CHECK_EQUAL(wrapped_model.state.sum, 10);
+        BOOST_CHECK_EQUAL(wrapped_model.state.view_transitions, 3);
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,186 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <cadmium/logger/tuple_to_ostream.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/state_serializer.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/basic_model/int_generator_one_sec.hpp>
+#include <cadmium/basic_model/reset_generator_five_sec.hpp>
+
+/**
+ * The count fives model is checkpointed in the middle of a run, the runs continued from the checkpoint
+ * reach the same times and states than the uninterrupted run.
+ */
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_checkpoint_test_suite )
+
+    template<typename TIME>
+    using test_accumulator=cadmium::basic_models::accumulator<int, TIME>;
+    using test_accumulator_defs=cadmium::basic_models::accumulator_defs<int>;
+
+    using empty_iports=std::tuple<>;
+    using empty_eic=std::tuple<>;
+    using empty_ic=std::tuple<>;
+
+    using generators_oports=std::tuple<cadmium::basic_models::int_generator_one_sec_defs::out, cadmium::basic_models::reset_generator_five_sec_defs::out>;
+    using generators_submodels=cadmium::modeling::models_tuple<cadmium::basic_models::reset_generator_five_sec, cadmium::basic_models::int_generator_one_sec>;
+    using generators_eoc=std::tuple<
+            cadmium::modeling::EOC<cadmium::basic_models::reset_generator_five_sec, cadmium::basic_models::reset_generator_five_sec_defs::out, cadmium::basic_models::reset_generator_five_sec_defs::out>,
+            cadmium::modeling::EOC<cadmium::basic_models::int_generator_one_sec, cadmium::basic_models::int_generator_one_sec_defs::out, cadmium::basic_models::int_generator_one_sec_defs::out>
+    >;
+
+    template<typename TIME>
+    using coupled_generators_model=cadmium::modeling::coupled_model<TIME, empty_iports, generators_oports, generators_submodels, empty_eic, generators_eoc, empty_ic>;
+
+    using count_fives_submodels=cadmium::modeling::models_tuple<coupled_generators_model, test_accumulator>;
+    using count_fives_ic=std::tuple<
+            cadmium::modeling::IC<coupled_generators_model, cadmium::basic_models::int_generator_one_sec_defs::out, test_accumulator, test_accumulator_defs::add>,
+            cadmium::modeling::IC<coupled_generators_model, cadmium::basic_models::reset_generator_five_sec_defs::out, test_accumulator, test_accumulator_defs::reset>
+    >;
+
+    template<typename TIME>
+    using count_fives_model=cadmium::modeling::coupled_model<TIME, empty_iports, std::tuple<>, count_fives_submodels, empty_eic, std::tuple<>, count_fives_ic>;
+
+    using test_runner=cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger>;
+
+    std::shared_ptr<cadmium::dynamic::modeling::coupled<float>> make_count_fives() {
+        return cadmium::dynamic::translate::make_dynamic_coupled_model<float, count_fives_model>();
+    }
+
+    template<typename T>
+    T round_trip(const T& value) {
+        std::string buffer;
+        cadmium::state_serializer<T>::write(value, buffer);
+        const char* data = buffer.data();
+        T ret{};
+        cadmium::state_serializer<T>::read(data, buffer.data() + buffer.size(), ret);
+        BOOST_CHECK(data == buffer.data() + buffer.size());
+        return ret;
+    }
+
+    struct opaque_state {
+        std::string name;
+    };
+
+    BOOST_AUTO_TEST_CASE( state_serializer_round_trips_the_states ) {
+        BOOST_CHECK_EQUAL(round_trip(42), 42);
+        BOOST_CHECK_EQUAL(round_trip(std::string("state")), "state");
+        BOOST_CHECK((round_trip(std::make_tuple(3, true)) == std::make_tuple(3, true)));
+
+        std::vector<std::pair<int, std::string>> v = {{1, "one"}, {2, ""}, {3, "three"}};
+        BOOST_CHECK((round_trip(v) == v));
+
+        BOOST_CHECK(!cadmium::state_serializer<opaque_state>::serializable);
+        std::string buffer;
+        BOOST_CHECK_THROW(cadmium::state_serializer<opaque_state>::write(opaque_state{}, buffer), std::domain_error);
+
+        cadmium::state_serializer<int>::write(1, buffer);
+        const char* data = buffer.data();
+        std::string s;
+        BOOST_CHECK_THROW(cadmium::state_serializer<std::string>::read(data, buffer.data() + buffer.size(), s), std::domain_error);
+    }
+
+    BOOST_AUTO_TEST_CASE( runs_continue_from_a_checkpoint ) {
+        test_runner full(make_count_fives(), 0.0f);
+        BOOST_CHECK_EQUAL(full.run_until(30.0f), 30.0f);
+        std::string full_checkpoint;
+        full.save_checkpoint(full_checkpoint);
+
+        test_runner first(make_count_fives(), 0.0f);
+        first.run_until(12.5f);
+        std::string checkpoint;
+        first.save_checkpoint(checkpoint);
+
+        //the checkpoint is restored in a runner of a new model hierarchy
+        auto model = make_count_fives();
+        test_runner restored(model, 0.0f);
+        restored.restore_checkpoint(checkpoint.data(), checkpoint.size());
+        std::shared_ptr<cadmium::dynamic::modeling::atomic_abstract<float>> accumulator;
+        for (const auto& m : model->_models) {
+            if (auto a = std::dynamic_pointer_cast<cadmium::dynamic::modeling::atomic_abstract<float>>(m)) {
+                accumulator = a;
+            }
+        }
+        BOOST_REQUIRE(accumulator);
+        BOOST_CHECK((boost::any_cast<std::tuple<int, bool>>(accumulator->get_state()) == std::make_tuple(2, false)));
+
+        BOOST_CHECK_EQUAL(restored.run_until(30.0f), 30.0f);
+        std::string restored_checkpoint;
+        restored.save_checkpoint(restored_checkpoint);
+        BOOST_CHECK(restored_checkpoint == full_checkpoint);
+    }
+
+    BOOST_AUTO_TEST_CASE( checkpoint_files_are_restored_mapped ) {
+        std::string path = (std::filesystem::temp_directory_path() / "cadmium_checkpoint_test.cdmk").string();
+        test_runner first(make_count_fives(), 0.0f);
+        first.run_until(7.0f);
+        first.save_checkpoint_file(path);
+
+        test_runner restored(make_count_fives(), 0.0f);
+        restored.restore_checkpoint_file(path);
+        std::remove(path.c_str());
+        BOOST_CHECK_EQUAL(restored.run_until(30.0f), 30.0f);
+
+        test_runner full(make_count_fives(), 0.0f);
+        full.run_until(30.0f);
+        std::string full_checkpoint, restored_checkpoint;
+        full.save_checkpoint(full_checkpoint);
+        restored.save_checkpoint(restored_checkpoint);
+        BOOST_CHECK(restored_checkpoint == full_checkpoint);
+
+        BOOST_CHECK_THROW(restored.restore_checkpoint_file(path), std::runtime_error);
+    }
+
+    BOOST_AUTO_TEST_CASE( invalid_checkpoints_are_rejected ) {
+        test_runner first(make_count_fives(), 0.0f);
+        first.run_until(3.0f);
+        std::string checkpoint;
+        first.save_checkpoint(checkpoint);
+
+        test_runner restored(make_count_fives(), 0.0f);
+        BOOST_CHECK_THROW(restored.restore_checkpoint(checkpoint.data(), checkpoint.size() - 1), std::domain_error);
+        std::string not_checkpoint = "CDMS" + checkpoint.substr(4);
+        BOOST_CHECK_THROW(restored.restore_checkpoint(not_checkpoint.data(), not_checkpoint.size()), std::domain_error);
+        std::string longer = checkpoint + "x";
+        BOOST_CHECK_THROW(restored.restore_checkpoint(longer.data(), longer.size()), std::domain_error);
+
+        //the checkpoint of another model hierarchy does not match
+        test_runner other(cadmium::dynamic::translate::make_dynamic_coupled_model<float, coupled_generators_model>(), 0.0f);
+        BOOST_CHECK_THROW(other.restore_checkpoint(checkpoint.data(), checkpoint.size()), std::domain_error);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,216 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <algorithm>
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/basic_model/int_generator_one_sec.hpp>
+#include <cadmium/basic_model/reset_generator_five_sec.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/dynamic_model_flattener.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_conservative_runner.hpp>
+
+#include "count_fives_model.hpp"
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_conservative_runner_test_suite )
+
+    using namespace count_fives;
+
+    namespace {
+        std::ostringstream oss;
+
+        struct oss_test_sink_provider{
+            static std::ostream& sink(){
+                return oss;
+            }
+        };
+
+        std::vector<std::string> sorted_lines(const std::string& log) {
+            std::istringstream iss(log);
+            std::vector<std::string> ret;
+            std::string line;
+            while (std::getline(iss, line)) {
+                ret.push_back(line);
+            }
+            std::sort(ret.begin(), ret.end());
+            return ret;
+        }
+
+        std::vector<std::vector<std::string>> one_partition_by_model(const std::shared_ptr<cadmium::dynamic::modeling::coupled<float>>& model) {
+            std::vector<std::vector<std::string>> ret;
+            for (const auto& m : model->_models) {
+                ret.push_back({m->get_id()});
+            }
+            return ret;
+        }
+
+        int accumulated_value(const std::shared_ptr<cadmium::dynamic::modeling::coupled<float>>& model) {
+            // the dynamic atomic model derives from the atomic model class
+            using dynamic_accumulator = test_accumulator<float>;
+            auto accumulator_coupled = std::dynamic_pointer_cast<cadmium::dynamic::modeling::coupled<float>>(model->_models[1]);
+            auto accumulator = std::dynamic_pointer_cast<dynamic_accumulator>(accumulator_coupled->_models[0]);
+            BOOST_REQUIRE(accumulator != nullptr);
+            return std::get<int>(accumulator->state);
+        }
+    }
+
+    using log_messages=cadmium::logger::logger<cadmium::logger::logger_messages, cadmium::dynamic::logger::formatter<float>, oss_test_sink_provider>;
+    using sequential_conservative_runner=cadmium::dynamic::engine::conservative_runner<float, log_messages, cadmium::dynamic::engine::no_fel<float>, cadmium::dynamic::engine::sequential_execution>;
+
+    BOOST_AUTO_TEST_CASE( conservative_runner_rejects_invalid_partitions_test ) {
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        std::string generators_id = model->_models[0]->get_id();
+        std::string accumulator_id = model->_models[1]->get_id();
+
+        using partitions = std::vector<std::vector<std::string>>;
+        BOOST_CHECK_THROW(sequential_conservative_runner(model, 0.0, partitions{{generators_id}}), std::domain_error);
+        BOOST_CHECK_THROW(sequential_conservative_runner(model, 0.0, partitions{{generators_id}, {generators_id, accumulator_id}}), std::domain_error);
+        BOOST_CHECK_THROW(sequential_conservative_runner(model, 0.0, partitions{{generators_id}, {accumulator_id}, {}}), std::domain_error);
+        BOOST_CHECK_THROW(sequential_conservative_runner(model, 0.0, partitions{{generators_id}, {accumulator_id, "missing"}}), std::domain_error);
+        BOOST_CHECK_NO_THROW(sequential_conservative_runner(model, 0.0, partitions{{generators_id}, {accumulator_id}}));
+    }
+
+    BOOST_AUTO_TEST_CASE( conservative_runner_produces_the_same_outputs_than_runner_test ) {
+        oss.str("");
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        cadmium::dynamic::engine::runner<float, log_messages> r(model, 0.0);
+        float next = r.run_until(21.0);
+        std::vector<std::string> outputs = sorted_lines(oss.str());
+
+        oss.str("");
+        auto partitioned_model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        sequential_conservative_runner cr(partitioned_model, 0.0, one_partition_by_model(partitioned_model));
+        BOOST_CHECK_EQUAL(cr.processes(), 2);
+        float conservative_next = cr.run_until(21.0);
+        std::vector<std::string> conservative_outputs = sorted_lines(oss.str());
+
+        BOOST_CHECK_EQUAL(next, conservative_next);
+        BOOST_CHECK(!conservative_outputs.empty());
+        BOOST_CHECK(outputs == conservative_outputs);
+        BOOST_CHECK_EQUAL(accumulated_value(model), accumulated_value(partitioned_model));
+    }
+
+    BOOST_AUTO_TEST_CASE( conservative_runner_runs_a_logical_process_by_atomic_model_test ) {
+        oss.str("");
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        cadmium::dynamic::engine::runner<float, log_messages> r(model, 0.0, true);
+        r.run_until(33.0);
+        std::vector<std::string> outputs = sorted_lines(oss.str());
+
+        oss.str("");
+        auto flat_model = cadmium::dynamic::modeling::flatten<float>(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>());
+        std::map<std::string, float> lookaheads{{flat_model->_models[0]->get_id(), 1.0}};
+        sequential_conservative_runner cr(flat_model, 0.0, one_partition_by_model(flat_model), lookaheads);
+        BOOST_CHECK_EQUAL(cr.processes(), 3);
+        cr.run_until(33.0);
+        std::vector<std::string> conservative_outputs = sorted_lines(oss.str());
+
+        BOOST_CHECK(!conservative_outputs.empty());
+        BOOST_CHECK(outputs == conservative_outputs);
+    }
+
+    BOOST_AUTO_TEST_CASE( parallel_conservative_runner_reaches_the_same_state_than_runner_test ) {
+        using not_logger=cadmium::logger::not_logger;
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        cadmium::dynamic::engine::runner<float, not_logger> r(model, 0.0);
+        float next = r.run_until(23.0);
+
+        auto partitioned_model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        cadmium::dynamic::engine::conservative_runner<float, not_logger> cr(partitioned_model, 0.0, one_partition_by_model(partitioned_model), {}, cadmium::dynamic::engine::parallel_execution(2));
+        float conservative_next = cr.run_until(23.0);
+
+        BOOST_CHECK_EQUAL(next, conservative_next);
+        BOOST_CHECK_EQUAL(accumulated_value(model), accumulated_value(partitioned_model));
+        BOOST_CHECK_EQUAL(accumulated_value(model), 2); // reset at 20, then 21 and 22 were added
+    }
+
+    BOOST_AUTO_TEST_CASE( conservative_runner_migrates_submodels_between_runs_test ) {
+        oss.str("");
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        cadmium::dynamic::engine::runner<float, log_messages> r(model, 0.0, true);
+        r.run_until(33.0);
+        std::vector<std::string> outputs = sorted_lines(oss.str());
+
+        oss.str("");
+        auto flat_model = cadmium::dynamic::modeling::flatten<float>(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>());
+        std::string first_id = flat_model->_models[0]->get_id();
+        std::string second_id = flat_model->_models[1]->get_id();
+        std::string third_id = flat_model->_models[2]->get_id();
+        sequential_conservative_runner cr(flat_model, 0.0, {{first_id, second_id}, {third_id}});
+        cr.run_until(7.0);
+
+        BOOST_CHECK_THROW(cr.migrate("missing", 1), std::domain_error);
+        BOOST_CHECK_THROW(cr.migrate(first_id, 2), std::domain_error);
+        BOOST_CHECK(!cr.migrate(first_id, 0));
+        BOOST_CHECK(cr.migrate(second_id, 1));
+        BOOST_CHECK_EQUAL(cr.process_of(second_id), 1);
+        BOOST_CHECK(!cr.migrate(first_id, 1)); // the last submodel of its process
+        BOOST_CHECK_EQUAL(cr.rebalance_stats().migrations, 1);
+
+        cr.run_until(20.0);
+        BOOST_CHECK(cr.migrate(second_id, 0));
+        cr.run_until(33.0);
+        std::vector<std::string> conservative_outputs = sorted_lines(oss.str());
+
+        BOOST_CHECK(!conservative_outputs.empty());
+        BOOST_CHECK(outputs == conservative_outputs);
+    }
+
+    BOOST_AUTO_TEST_CASE( rebalanced_conservative_runner_reaches_the_same_state_than_runner_test ) {
+        using not_logger=cadmium::logger::not_logger;
+        auto model = cadmium::dynamic::modeling::flatten<float>(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>());
+        cadmium::dynamic::engine::runner<float, not_logger> r(model, 0.0);
+        float next = r.run_until(43.0);
+
+        auto flat_model = cadmium::dynamic::modeling::flatten<float>(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>());
+        cadmium::dynamic::engine::conservative_runner<float, not_logger> cr(flat_model, 0.0, {{flat_model->_models[0]->get_id(), flat_model->_models[1]->get_id()}, {flat_model->_models[2]->get_id()}}, {}, cadmium::dynamic::engine::parallel_execution(2));
+        using options = cadmium::dynamic::engine::conservative_runner<float, not_logger>::rebalance_options;
+        cr.set_rebalancing(options{1, 0.0, 1});
+        float conservative_next = cr.run_until(43.0);
+
+        BOOST_CHECK_EQUAL(next, conservative_next);
+        BOOST_CHECK_GT(cr.rebalance_stats().rounds, 0);
+        BOOST_CHECK_GT(cr.busy_time(0).count() + cr.busy_time(1).count(), 0);
+
+        auto accumulator_of = [](const std::shared_ptr<cadmium::dynamic::modeling::coupled<float>>& m) {
+            for (const auto& sub : m->_models) {
+                auto accumulator = std::dynamic_pointer_cast<test_accumulator<float>>(sub);
+                if (accumulator != nullptr) {
+                    return std::get<int>(accumulator->state);
+                }
+            }
+            BOOST_FAIL("no accumulator in the model");
+            return 0;
+        };
+        BOOST_CHECK_EQUAL(accumulator_of(model), accumulator_of(flat_model));
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
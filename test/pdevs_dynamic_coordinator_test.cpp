@@ -26,15 +26,25 @@
 
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <sstream>
 #include <cadmium/modeling/dynamic_coupled.hpp>
 #include <cadmium/engine/pdevs_dynamic_coordinator.hpp>
 #include <cadmium/logger/common_loggers.hpp>
+#include <cadmium/logger/dynamic_common_loggers.hpp>
 #include <cadmium/modeling/ports.hpp>
 #include <cadmium/basic_model/generator.hpp>
+#include <cadmium/basic_model/accumulator.hpp>
 #include <cadmium/modeling/coupled_model.hpp>
 #include <cadmium/modeling/dynamic_atomic.hpp>
 #include <cadmium/modeling/dynamic_model_translator.hpp>
 
+// the long accumulators add their inputs while they are routed
+template<>
+struct cadmium::port_combiner<cadmium::basic_models::accumulator_defs<long>::add> : cadmium::sum_combiner<long> {};
+
 BOOST_AUTO_TEST_SUITE( pdevs_dynamic_coordinator_test_suite )
 
     template <typename TIME>
@@ -121,7 +131,7 @@ BOOST_AUTO_TEST_SUITE( pdevs_dynamic_coordinator_test_suite )
         BOOST_REQUIRE(!output_bags.empty());
         BOOST_CHECK_EQUAL(output_bags.size(), 1);
         BOOST_REQUIRE(output_bags.find(typeid(coupled_out_port)) != output_bags.end());
-        BOOST_CHECK_EQUAL(boost::any_cast<cadmium::message_bag<coupled_out_port>>(output_bags.at(typeid(coupled_out_port))).messages.size(), 1); //only a tick happened.
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<coupled_out_port>>(output_bags.at(typeid(coupled_out_port))).messages.size(), 1); //only a tick happened.
 
         //second cycle, all same checks one second later produce same results
         cg.advance_simulation(1.0f);
@@ -137,7 +147,371 @@ BOOST_AUTO_TEST_SUITE( pdevs_dynamic_coordinator_test_suite )
         BOOST_REQUIRE(!output_bags.empty());
         BOOST_CHECK_EQUAL(output_bags.size(), 1);
         BOOST_REQUIRE(output_bags.find(typeid(coupled_out_port)) != output_bags.end());
-        BOOST_CHECK_EQUAL(boost::any_cast<cadmium::message_bag<coupled_out_port>>(output_bags.at(typeid(coupled_out_port))).messages.size(), 1); //only a tick happened.
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<coupled_out_port>>(output_bags.at(typeid(coupled_out_port))).messages.size(), 1); //only a tick happened.
+    }
+
+    // accumulators receiving the coupled inputs, one port fans out to two of them
+    using int_accumulator_defs = cadmium::basic_models::accumulator_defs<int>;
+
+    template<typename TIME>
+    struct accumulator_a : public cadmium::basic_models::accumulator<int, TIME> {};
+    template<typename TIME>
+    struct accumulator_b : public cadmium::basic_models::accumulator<int, TIME> {};
+    template<typename TIME>
+    struct accumulator_c : public cadmium::basic_models::accumulator<int, TIME> {};
+
+    struct fan_in : public cadmium::in_port<int>{};
+    struct single_in : public cadmium::in_port<int>{};
+
+    template<typename TIME>
+    using fan_out_coupled = cadmium::modeling::coupled_model<TIME, std::tuple<fan_in, single_in>, std::tuple<>,
+            cadmium::modeling::models_tuple<accumulator_a, accumulator_b, accumulator_c>,
+            std::tuple<
+                    cadmium::modeling::EIC<fan_in, accumulator_a, int_accumulator_defs::add>,
+                    cadmium::modeling::EIC<fan_in, accumulator_b, int_accumulator_defs::add>,
+                    cadmium::modeling::EIC<single_in, accumulator_c, int_accumulator_defs::add>
+            >, std::tuple<>, std::tuple<>>;
+
+    template<template<typename> class MODEL>
+    int accumulated(const cadmium::dynamic::modeling::Models& models) {
+        for (const auto& m : models) {
+            auto atomic = std::dynamic_pointer_cast<MODEL<float>>(m);
+            if (atomic != nullptr) {
+                return std::get<int>(atomic->state);
+            }
+        }
+        throw std::domain_error("Model not found");
+    }
+
+    BOOST_AUTO_TEST_CASE( coordinator_routes_eics_to_all_the_receivers ) {
+        auto coupled = cadmium::dynamic::translate::make_dynamic_coupled_model<float, fan_out_coupled>();
+        cadmium::dynamic::engine::coordinator<float, cadmium::logger::not_logger> cc(coupled);
+        cc.init(0);
+
+        for (int step = 1; step <= 2; step++) {
+            cadmium::message_bag<fan_in> fan_bag;
+            fan_bag.messages = {1, 2};
+            cadmium::message_bag<single_in> single_bag;
+            single_bag.messages = {5};
+            cc.inbox()[typeid(fan_in)] = fan_bag;
+            cc.inbox()[typeid(single_in)] = single_bag;
+            cc.advance_simulation(static_cast<float>(step));
+            BOOST_CHECK(cc.inbox().empty());
+        }
+
+        BOOST_CHECK_EQUAL(accumulated<accumulator_a>(coupled->_models), 6);
+        BOOST_CHECK_EQUAL(accumulated<accumulator_b>(coupled->_models), 6);
+        BOOST_CHECK_EQUAL(accumulated<accumulator_c>(coupled->_models), 10);
+    }
+
+    struct reset_in : public cadmium::in_port<int_accumulator_defs::reset_tick>{};
+    struct sums_out : public cadmium::out_port<int>{};
+
+    BOOST_AUTO_TEST_CASE( coordinator_groups_the_couplings_of_wide_models ) {
+        const int width = 1000;
+        cadmium::dynamic::modeling::Models models;
+        cadmium::dynamic::modeling::EICs eics;
+        cadmium::dynamic::modeling::EOCs eocs;
+        cadmium::dynamic::modeling::ICs ics;
+        for (int i = 0; i < width; i++) {
+            models.push_back(cadmium::dynamic::translate::make_dynamic_atomic_model<accumulator_a, float>("accumulator_" + std::to_string(i)));
+        }
+        // the couplings of each model are interleaved with the ones of the others
+        for (int i = 0; i < width; i++) {
+            eics.push_back(cadmium::dynamic::translate::make_EIC<fan_in, int_accumulator_defs::add>("accumulator_" + std::to_string(i)));
+            eocs.push_back(cadmium::dynamic::translate::make_EOC<int_accumulator_defs::sum, sums_out>("accumulator_" + std::to_string(i)));
+        }
+        for (int i = 0; i < width; i++) {
+            eics.push_back(cadmium::dynamic::translate::make_EIC<reset_in, int_accumulator_defs::reset>("accumulator_" + std::to_string(i)));
+            if (i + 1 < width) {
+                ics.push_back(cadmium::dynamic::translate::make_IC<int_accumulator_defs::sum, int_accumulator_defs::add>("accumulator_" + std::to_string(i), "accumulator_" + std::to_string(i + 1)));
+            }
+        }
+        auto coupled = std::make_shared<cadmium::dynamic::modeling::coupled<float>>(
+                "wide", models, cadmium::dynamic::modeling::Ports{typeid(fan_in), typeid(reset_in)}, cadmium::dynamic::modeling::Ports{typeid(sums_out)}, eics, eocs, ics
+        );
+        cadmium::dynamic::engine::coordinator<float, cadmium::logger::not_logger> cc(coupled);
+        cc.init(0);
+
+        cadmium::message_bag<fan_in> fan_bag;
+        fan_bag.messages = {1, 2};
+        cc.inbox()[typeid(fan_in)] = fan_bag;
+        cc.advance_simulation(1.0f);
+
+        cadmium::message_bag<reset_in> reset_bag;
+        reset_bag.messages = {int_accumulator_defs::reset_tick{}};
+        cc.inbox()[typeid(reset_in)] = reset_bag;
+        cc.advance_simulation(2.0f);
+
+        // all the accumulators output their sum in the EOC order
+        cc.collect_outputs(2.0f);
+        auto sums = cadmium::dynamic::bag_cast<cadmium::message_bag<sums_out>>(cc.outbox().at(typeid(sums_out))).messages;
+        BOOST_REQUIRE_EQUAL(sums.size(), width);
+        BOOST_CHECK(std::all_of(sums.begin(), sums.end(), [](int sum) { return sum == 3; }));
+
+        // every accumulator but the first one adds the sum of the previous one
+        cc.advance_simulation(2.0f);
+        BOOST_CHECK_EQUAL(cc.next(), std::numeric_limits<float>::infinity());
+        cc.inbox()[typeid(reset_in)] = reset_bag;
+        cc.advance_simulation(3.0f);
+        cc.collect_outputs(3.0f);
+        sums = cadmium::dynamic::bag_cast<cadmium::message_bag<sums_out>>(cc.outbox().at(typeid(sums_out))).messages;
+        BOOST_REQUIRE_EQUAL(sums.size(), width);
+        BOOST_CHECK_EQUAL(sums.front(), 0);
+        BOOST_CHECK(std::all_of(sums.begin() + 1, sums.end(), [](int sum) { return sum == 3; }));
+    }
+
+    namespace {
+        std::ostringstream routing_oss;
+
+        struct routing_sink_provider {
+            static std::ostream& sink() {
+                return routing_oss;
+            }
+        };
+    }
+
+    // the sums of width accumulators_a go to the single accumulator_b, the collect sums them
+    template<typename LOGGER>
+    int collected_sums(int width) {
+        cadmium::dynamic::modeling::Models models;
+        cadmium::dynamic::modeling::EICs eics;
+        cadmium::dynamic::modeling::ICs ics;
+        models.push_back(cadmium::dynamic::translate::make_dynamic_atomic_model<accumulator_b, float>("collect"));
+        for (int i = 0; i < width; i++) {
+            std::string id = "accumulator_" + std::to_string(i);
+            models.push_back(cadmium::dynamic::translate::make_dynamic_atomic_model<accumulator_a, float>(id));
+            eics.push_back(cadmium::dynamic::translate::make_EIC<fan_in, int_accumulator_defs::add>(id));
+            eics.push_back(cadmium::dynamic::translate::make_EIC<reset_in, int_accumulator_defs::reset>(id));
+            ics.push_back(cadmium::dynamic::translate::make_IC<int_accumulator_defs::sum, int_accumulator_defs::add>(id, "collect"));
+        }
+        auto coupled = std::make_shared<cadmium::dynamic::modeling::coupled<float>>(
+                "fan_in", models, cadmium::dynamic::modeling::Ports{typeid(fan_in), typeid(reset_in)}, cadmium::dynamic::modeling::Ports{}, eics, cadmium::dynamic::modeling::EOCs{}, ics
+        );
+        cadmium::dynamic::engine::coordinator<float, LOGGER> cc(coupled);
+        cc.init(0);
+
+        for (int step = 1; step <= 2; step++) {
+            cadmium::message_bag<fan_in> fan_bag;
+            fan_bag.messages = {step, 2};
+            cc.inbox()[typeid(fan_in)] = fan_bag;
+            cc.advance_simulation(static_cast<float>(2 * step - 1));
+
+            cadmium::message_bag<reset_in> reset_bag;
+            reset_bag.messages = {int_accumulator_defs::reset_tick{}};
+            cc.inbox()[typeid(reset_in)] = reset_bag;
+            cc.advance_simulation(static_cast<float>(2 * step));
+            cc.collect_outputs(static_cast<float>(2 * step));
+            cc.advance_simulation(static_cast<float>(2 * step));
+        }
+        return accumulated<accumulator_b>(coupled->_models);
+    }
+
+    BOOST_AUTO_TEST_CASE( coordinator_routes_high_fan_in_ports_at_once ) {
+        using log_routing=cadmium::logger::logger<cadmium::logger::logger_message_routing, cadmium::dynamic::logger::formatter<float>, routing_sink_provider>;
+        // the sums are 3 and then 4 in every accumulator_a
+        BOOST_CHECK_EQUAL(collected_sums<cadmium::logger::not_logger>(500), 500 * (3 + 4));
+        // the logged routing goes entry by entry and gives the same messages
+        routing_oss.str("");
+        BOOST_CHECK_EQUAL(collected_sums<log_routing>(50), 50 * (3 + 4));
+        BOOST_CHECK(!routing_oss.str().empty());
+    }
+
+    // an accumulator with a combiner in its add port, specialized above
+    using long_accumulator_defs = cadmium::basic_models::accumulator_defs<long>;
+
+    template<typename TIME>
+    struct long_accumulator : public cadmium::basic_models::accumulator<long, TIME> {};
+
+    struct long_in : public cadmium::in_port<long>{};
+    struct other_long_in : public cadmium::in_port<long>{};
+
+    BOOST_AUTO_TEST_CASE( links_combine_the_messages_of_ports_with_a_combiner ) {
+        static_assert(cadmium::has_port_combiner<long_accumulator_defs::add>::value);
+        static_assert(!cadmium::has_port_combiner<int_accumulator_defs::add>::value);
+
+        auto l = std::make_shared<cadmium::dynamic::engine::link<long_in, long_accumulator_defs::add>>();
+        cadmium::dynamic::message_bags from;
+        cadmium::dynamic::message_bags to;
+        from.get_bag<cadmium::message_bag<long_in>>(typeid(long_in)).messages = {1, 2, 3};
+        l->route_messages(from, to);
+        l->move_messages(from, to);
+        auto& combined = cadmium::dynamic::bag_cast<const cadmium::message_bag<long_accumulator_defs::add>&>(to.at(typeid(long_accumulator_defs::add))).messages;
+        BOOST_REQUIRE_EQUAL(combined.size(), 1);
+        BOOST_CHECK_EQUAL(combined.front(), 12);
+    }
+
+    BOOST_AUTO_TEST_CASE( coordinator_combines_the_messages_of_ports_with_a_combiner ) {
+        cadmium::dynamic::modeling::Models models{cadmium::dynamic::translate::make_dynamic_atomic_model<long_accumulator, float>("sum")};
+        cadmium::dynamic::modeling::EICs eics{
+                cadmium::dynamic::translate::make_EIC<long_in, long_accumulator_defs::add>("sum"),
+                cadmium::dynamic::translate::make_EIC<other_long_in, long_accumulator_defs::add>("sum")
+        };
+        auto coupled = std::make_shared<cadmium::dynamic::modeling::coupled<float>>(
+                "combined", models, cadmium::dynamic::modeling::Ports{typeid(long_in), typeid(other_long_in)}, cadmium::dynamic::modeling::Ports{},
+                eics, cadmium::dynamic::modeling::EOCs{}, cadmium::dynamic::modeling::ICs{}
+        );
+        cadmium::dynamic::engine::coordinator<float, cadmium::logger::not_logger> cc(coupled);
+        cc.init(0);
+
+        cadmium::message_bag<long_in> long_bag;
+        long_bag.messages = {1, 2, 3};
+        cadmium::message_bag<other_long_in> other_bag;
+        other_bag.messages = {4};
+        cc.inbox()[typeid(long_in)] = long_bag;
+        cc.inbox()[typeid(other_long_in)] = other_bag;
+        cc.advance_simulation(1.0f);
+
+        auto atomic = std::dynamic_pointer_cast<long_accumulator<float>>(coupled->_models.front());
+        BOOST_REQUIRE(atomic != nullptr);
+        BOOST_CHECK_EQUAL(std::get<long>(atomic->state), 10);
+    }
+
+    BOOST_AUTO_TEST_CASE( coordinator_allocates_the_simulators_contiguously ) {
+        cadmium::dynamic::modeling::Models models;
+        for (int i = 0; i < 10; i++) {
+            models.push_back(cadmium::dynamic::translate::make_dynamic_atomic_model<accumulator_a, float>("accumulator_" + std::to_string(i)));
+        }
+        auto coupled = std::make_shared<cadmium::dynamic::modeling::coupled<float>>(
+                "pooled", models, cadmium::dynamic::modeling::Ports{}, cadmium::dynamic::modeling::Ports{},
+                cadmium::dynamic::modeling::EICs{}, cadmium::dynamic::modeling::EOCs{}, cadmium::dynamic::modeling::ICs{}
+        );
+        cadmium::dynamic::engine::coordinator<float, cadmium::logger::not_logger> cc(coupled);
+
+        // the simulators are consecutive elements of one pool, owned together by the subengines
+        using simulator = cadmium::dynamic::engine::simulator<float, cadmium::logger::not_logger>;
+        const auto& engines = cc.subengines();
+        const simulator* first = dynamic_cast<const simulator*>(engines.front().get());
+        BOOST_REQUIRE(first != nullptr);
+        for (std::size_t i = 0; i < engines.size(); i++) {
+            BOOST_CHECK_EQUAL(dynamic_cast<const simulator*>(engines[i].get()), first + i);
+            BOOST_CHECK_EQUAL(engines[i].use_count(), static_cast<long>(engines.size()));
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( dispatch_calls_the_simulators_by_their_type ) {
+        using simulator = cadmium::dynamic::engine::simulator<float, cadmium::logger::not_logger>;
+        using coordinator = cadmium::dynamic::engine::coordinator<float, cadmium::logger::not_logger>;
+        cadmium::dynamic::engine::subcoordinators_type<float> engines{
+                std::make_shared<simulator>(cadmium::dynamic::translate::make_dynamic_atomic_model<accumulator_a, float>("accumulator")),
+                std::make_shared<coordinator>(std::make_shared<custom_id_coupled<float>>())
+        };
+        cadmium::dynamic::engine::subengine_dispatch<float, simulator> dispatch(engines);
+        dispatch.update(0);
+        dispatch.update(1);
+
+        auto is_simulator = [](auto& e) { return std::is_same<std::decay_t<decltype(e)>, simulator>::value; };
+        BOOST_CHECK(dispatch.visit(0, is_simulator));
+        BOOST_CHECK(!dispatch.visit(1, is_simulator));
+        BOOST_CHECK_EQUAL(dispatch.visit(1, [](auto& e) { return e.get_model_id(); }), "custom_id_coupled");
+
+        // the removed subengines are not visited
+        engines.erase(engines.begin());
+        dispatch.update(0);
+        BOOST_CHECK_EQUAL(dispatch.size(), 1);
+        BOOST_CHECK(!dispatch.visit(0, is_simulator));
+    }
+
+    BOOST_AUTO_TEST_CASE( coupled_checks_its_links_unless_they_are_already_checked ) {
+        cadmium::dynamic::modeling::Models models{cadmium::dynamic::translate::make_dynamic_atomic_model<accumulator_a, float>("accumulator")};
+        cadmium::dynamic::modeling::Ports iports{typeid(fan_in)};
+        cadmium::dynamic::modeling::Ports oports{typeid(sums_out)};
+        cadmium::dynamic::modeling::EICs eics{cadmium::dynamic::translate::make_EIC<fan_in, int_accumulator_defs::add>("accumulator")};
+        cadmium::dynamic::modeling::EOCs eocs{cadmium::dynamic::translate::make_EOC<int_accumulator_defs::sum, sums_out>("accumulator")};
+        cadmium::dynamic::modeling::ICs ics;
+        using dynamic_coupled = cadmium::dynamic::modeling::coupled<float>;
+        BOOST_CHECK_NO_THROW(dynamic_coupled("valid", models, iports, oports, eics, eocs, ics));
+
+        // an EIC from a port the coupled model does not have
+        cadmium::dynamic::modeling::EICs bad_eics{cadmium::dynamic::translate::make_EIC<reset_in, int_accumulator_defs::reset>("accumulator")};
+        BOOST_CHECK_THROW(dynamic_coupled("bad_eic", models, iports, oports, bad_eics, eocs, ics), std::domain_error);
+        // an EOC from a model that does not exist
+        cadmium::dynamic::modeling::EOCs bad_eocs{cadmium::dynamic::translate::make_EOC<int_accumulator_defs::sum, sums_out>("missing")};
+        BOOST_CHECK_THROW(dynamic_coupled("bad_eoc", models, iports, oports, eics, bad_eocs, ics), std::domain_error);
+        // an IC to an output port
+        cadmium::dynamic::modeling::ICs bad_ics{cadmium::dynamic::translate::make_IC<int_accumulator_defs::sum, sums_out>("accumulator", "accumulator")};
+        BOOST_CHECK_THROW(dynamic_coupled("bad_ic", models, iports, oports, eics, eocs, bad_ics), std::domain_error);
+
+        // the check is skipped on request
+        BOOST_CHECK_NO_THROW(dynamic_coupled("unchecked", models, iports, oports, bad_eics, bad_eocs, bad_ics, false));
+    }
+
+    BOOST_AUTO_TEST_CASE( coordinator_changes_its_structure_while_running ) {
+        using cadmium::dynamic::translate::make_EIC;
+        using cadmium::dynamic::translate::make_EOC;
+        using cadmium::dynamic::translate::make_IC;
+        auto first = cadmium::dynamic::translate::make_dynamic_atomic_model<accumulator_a, float>("first");
+        auto second = cadmium::dynamic::translate::make_dynamic_atomic_model<accumulator_b, float>("second");
+        auto coupled = std::make_shared<cadmium::dynamic::modeling::coupled<float>>(
+                "changing",
+                cadmium::dynamic::modeling::Models{first},
+                cadmium::dynamic::modeling::Ports{typeid(fan_in), typeid(reset_in)},
+                cadmium::dynamic::modeling::Ports{typeid(sums_out)},
+                cadmium::dynamic::modeling::EICs{make_EIC<fan_in, int_accumulator_defs::add>("first"), make_EIC<reset_in, int_accumulator_defs::reset>("first")},
+                cadmium::dynamic::modeling::EOCs{make_EOC<int_accumulator_defs::sum, sums_out>("first")},
+                cadmium::dynamic::modeling::ICs{}
+        );
+        cadmium::dynamic::engine::coordinator<float, cadmium::logger::not_logger, cadmium::dynamic::engine::heap_fel<float>> cc(coupled);
+        cc.init(0);
+        cc.set_profiling(true);
+
+        cadmium::message_bag<fan_in> fan_bag;
+        fan_bag.messages = {1, 2};
+        cc.inbox()[typeid(fan_in)] = fan_bag;
+        cc.advance_simulation(1.0f);
+
+        // the second accumulator receives the same inputs and adds the sums of the first one
+        BOOST_CHECK_EQUAL(cc.add_submodel(second), 1);
+        cc.add_coupling(make_EIC<fan_in, int_accumulator_defs::add>("second"));
+        cc.add_coupling(make_EIC<reset_in, int_accumulator_defs::reset>("second"));
+        cc.add_coupling(make_EOC<int_accumulator_defs::sum, sums_out>("second"));
+        cc.add_coupling(make_IC<int_accumulator_defs::sum, int_accumulator_defs::add>("first", "second"));
+        BOOST_CHECK_EQUAL(cc.next(), std::numeric_limits<float>::infinity());
+        BOOST_CHECK_THROW(cc.add_submodel(second), std::domain_error);
+        BOOST_CHECK_THROW(cc.add_coupling(make_EOC<int_accumulator_defs::sum, sums_out>("missing")), std::domain_error);
+        BOOST_CHECK_THROW(cc.add_coupling(make_IC<int_accumulator_defs::sum, sums_out>("first", "second")), std::domain_error);
+
+        fan_bag.messages = {4};
+        cc.inbox()[typeid(fan_in)] = fan_bag;
+        cc.advance_simulation(2.0f);
+        BOOST_CHECK_EQUAL(std::get<int>(std::dynamic_pointer_cast<accumulator_a<float>>(first)->state), 7);
+        BOOST_CHECK_EQUAL(std::get<int>(std::dynamic_pointer_cast<accumulator_b<float>>(second)->state), 4);
+
+        cadmium::message_bag<reset_in> reset_bag;
+        reset_bag.messages = {int_accumulator_defs::reset_tick{}};
+        cc.inbox()[typeid(reset_in)] = reset_bag;
+        cc.advance_simulation(3.0f);
+        BOOST_CHECK_EQUAL(cc.next(), 3.0f);
+        cc.collect_outputs(3.0f);
+        auto sums = cadmium::dynamic::bag_cast<cadmium::message_bag<sums_out>>(cc.outbox().at(typeid(sums_out))).messages;
+        BOOST_CHECK((sums == std::vector<int>{7, 4}));
+        cc.advance_simulation(3.0f);
+        BOOST_CHECK_EQUAL(std::get<int>(std::dynamic_pointer_cast<accumulator_b<float>>(second)->state), 7);
+
+        // the links added are profiled with the ones of the model
+        std::vector<cadmium::dynamic::engine::link_profile> profiles;
+        cc.collect_link_profiles(profiles);
+        BOOST_CHECK_EQUAL(profiles.size(), 7);
+
+        cc.remove_coupling(make_IC<int_accumulator_defs::sum, int_accumulator_defs::add>("first", "second"));
+        BOOST_CHECK_THROW(cc.remove_coupling(make_IC<int_accumulator_defs::sum, int_accumulator_defs::add>("first", "second")), std::domain_error);
+        cc.remove_submodel("first");
+        BOOST_REQUIRE_EQUAL(cc.subengines().size(), 1);
+        BOOST_CHECK_EQUAL(cc.subengines()[0]->get_model_id(), "second");
+        profiles.clear();
+        cc.collect_link_profiles(profiles);
+        BOOST_CHECK_EQUAL(profiles.size(), 3);
+
+        // the second accumulator took the index of the first one, it alone receives the inputs
+        fan_bag.messages = {1};
+        cc.inbox()[typeid(fan_in)] = fan_bag;
+        cc.advance_simulation(4.0f);
+        cc.inbox()[typeid(reset_in)] = reset_bag;
+        cc.advance_simulation(5.0f);
+        cc.collect_outputs(5.0f);
+        sums = cadmium::dynamic::bag_cast<cadmium::message_bag<sums_out>>(cc.outbox().at(typeid(sums_out))).messages;
+        BOOST_CHECK((sums == std::vector<int>{8}));
+        BOOST_CHECK_EQUAL(std::get<int>(std::dynamic_pointer_cast<accumulator_a<float>>(first)->state), 0);
     }
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <cadmium/engine/pdevs_dynamic_delivery_queue.hpp>
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_delivery_queue_test_suite )
+
+    BOOST_AUTO_TEST_CASE( delivery_queue_drains_in_push_order ) {
+        cadmium::dynamic::engine::delivery_queue<std::unique_ptr<int>> queue;
+        BOOST_CHECK(queue.empty());
+        for (int i = 0; i < 5; i++) {
+            queue.push(std::make_unique<int>(i));
+        }
+        BOOST_CHECK(!queue.empty());
+
+        std::vector<int> drained;
+        BOOST_CHECK_EQUAL(queue.drain([&drained](std::unique_ptr<int>&& v) { drained.push_back(*v); }), 5);
+        BOOST_CHECK(drained == std::vector<int>({0, 1, 2, 3, 4}));
+        BOOST_CHECK(queue.empty());
+        BOOST_CHECK_EQUAL(queue.drain([](std::unique_ptr<int>&&) {}), 0);
+    }
+
+    BOOST_AUTO_TEST_CASE( delivery_queue_keeps_the_order_of_each_producer ) {
+        const int producers = 4;
+        const int values = 20000;
+        cadmium::dynamic::engine::delivery_queue<std::pair<int, int>> queue;
+        std::atomic<int> done{0};
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; p++) {
+            threads.emplace_back([&queue, &done, p]() {
+                for (int v = 0; v < values; v++) {
+                    queue.push(std::make_pair(p, v));
+                }
+                done++;
+            });
+        }
+
+        // the consumer drains while the producers push
+        std::vector<int> next(producers, 0);
+        bool in_order = true;
+        auto consume = [&next, &in_order](std::pair<int, int>&& m) {
+            in_order = in_order && m.second == next[m.first];
+            next[m.first]++;
+        };
+        while (done < producers) {
+            queue.drain(consume);
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        queue.drain(consume);
+
+        BOOST_CHECK(in_order);
+        BOOST_CHECK(next == std::vector<int>(producers, values));
+    }
+
+    BOOST_AUTO_TEST_CASE( delivery_queue_releases_the_values_left_by_a_throwing_drain ) {
+        auto value = std::make_shared<int>(1);
+        {
+            cadmium::dynamic::engine::delivery_queue<std::shared_ptr<int>> queue;
+            queue.push(value);
+            queue.push(value);
+            BOOST_CHECK_THROW(queue.drain([](std::shared_ptr<int>&&) { throw std::runtime_error("drain"); }), std::runtime_error);
+            BOOST_CHECK(queue.empty());
+            queue.push(value);
+        }
+        BOOST_CHECK_EQUAL(value.use_count(), 1);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
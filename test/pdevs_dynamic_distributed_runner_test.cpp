@@ -0,0 +1,228 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <thread>
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/basic_model/int_generator_one_sec.hpp>
+#include <cadmium/basic_model/reset_generator_five_sec.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/message_arena.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_distributed_runner.hpp>
+
+#include "count_fives_model.hpp"
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_distributed_runner_test_suite )
+
+    struct test_port_defs {
+        struct in_strings : public cadmium::in_port<std::string> {};
+        struct out_strings : public cadmium::out_port<std::string> {};
+        struct in_vectors : public cadmium::in_port<std::vector<int>> {};
+        struct out_vectors : public cadmium::out_port<std::vector<int>> {};
+    };
+
+    BOOST_AUTO_TEST_CASE( links_serialize_and_deserialize_messages_test ) {
+        using string_link = cadmium::dynamic::engine::link<test_port_defs::out_strings, test_port_defs::in_strings>;
+        std::shared_ptr<cadmium::dynamic::engine::link_abstract> link = std::make_shared<string_link>();
+
+        cadmium::dynamic::message_bags bags_from;
+        cadmium::message_bag<test_port_defs::out_strings> bag;
+        bag.messages = {"first message", "", "third"};
+        bags_from[typeid(test_port_defs::out_strings)] = bag;
+
+        std::string buffer;
+        link->serialize_messages(bags_from, buffer);
+        link->serialize_messages(cadmium::dynamic::message_bags(), buffer);
+
+        cadmium::dynamic::message_bags bags_to;
+        const char* data = buffer.data();
+        link->deserialize_messages(data, buffer.data() + buffer.size(), bags_to);
+        link->deserialize_messages(data, buffer.data() + buffer.size(), bags_to);
+        BOOST_CHECK(data == buffer.data() + buffer.size());
+        auto received = cadmium::dynamic::bag_cast<cadmium::message_bag<test_port_defs::in_strings>>(bags_to.at(typeid(test_port_defs::in_strings)));
+        BOOST_CHECK(received.messages == bag.messages);
+
+        // truncated data is detected
+        data = buffer.data();
+        BOOST_CHECK_THROW(link->deserialize_messages(data, buffer.data() + 10, bags_to), std::domain_error);
+    }
+
+    BOOST_AUTO_TEST_CASE( links_of_not_serializable_messages_throw_test ) {
+        using vector_link = cadmium::dynamic::engine::link<test_port_defs::out_vectors, test_port_defs::in_vectors>;
+        static_assert(!cadmium::dynamic::engine::message_serializer<std::vector<int>>::serializable, "vectors have no serializer");
+        std::shared_ptr<cadmium::dynamic::engine::link_abstract> link = std::make_shared<vector_link>();
+        std::string buffer;
+        BOOST_CHECK_THROW(link->serialize_messages(cadmium::dynamic::message_bags(), buffer), std::domain_error);
+    }
+
+    struct byte_port_defs {
+        struct out_bytes : public cadmium::out_port<int> {};
+        struct in_bytes : public cadmium::in_port<int> {};
+        struct in_ints : public cadmium::in_port<int> {};
+    };
+
+BOOST_AUTO_TEST_SUITE_END()
+
+// the out_bytes port only sends values in [0, 256), they are written in a byte each
+template<>
+struct cadmium::dynamic::engine::port_serializer<pdevs_dynamic_distributed_runner_test_suite::byte_port_defs::out_bytes> {
+    static constexpr bool serializable = true;
+
+    static std::size_t serialized_size(const cadmium::bag<int>& messages) {
+        return sizeof(std::uint64_t) + messages.size();
+    }
+
+    static void write(const cadmium::bag<int>& messages, std::string& buffer) {
+        serialization::write_size(messages.size(), buffer);
+        for (int m : messages) {
+            buffer.push_back(static_cast<char>(static_cast<unsigned char>(m)));
+        }
+    }
+
+    static void read(const char*& data, const char* end, cadmium::bag<int>& messages) {
+        std::uint64_t size = serialization::read_size(data, end);
+        if (static_cast<std::uint64_t>(end - data) < size) {
+            throw std::domain_error("Truncated serialized messages");
+        }
+        for (std::uint64_t i = 0; i < size; i++) {
+            messages.push_back(static_cast<unsigned char>(*data++));
+        }
+    }
+};
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_distributed_runner_test_suite )
+
+    BOOST_AUTO_TEST_CASE( links_serialize_with_the_from_port_serializer_test ) {
+        using byte_link = cadmium::dynamic::engine::link<byte_port_defs::out_bytes, byte_port_defs::in_bytes>;
+        using int_link = cadmium::dynamic::engine::link<byte_port_defs::in_bytes, byte_port_defs::in_ints>;
+        std::shared_ptr<cadmium::dynamic::engine::link_abstract> link = std::make_shared<byte_link>();
+        // the composed link reads the from port of its first link
+        std::shared_ptr<cadmium::dynamic::engine::link_abstract> composed = link->compose(std::make_shared<int_link>());
+
+        cadmium::message_bag<byte_port_defs::out_bytes> bag;
+        bag.messages = {1, 200, 7};
+        cadmium::dynamic::message_bags bags_from;
+        bags_from[typeid(byte_port_defs::out_bytes)] = bag;
+
+        std::string buffer;
+        composed->serialize_messages(bags_from, buffer);
+        BOOST_CHECK_EQUAL(buffer.size(), sizeof(std::uint64_t) + 3);
+
+        cadmium::dynamic::message_bags bags_to;
+        const char* data = buffer.data();
+        composed->deserialize_messages(data, buffer.data() + buffer.size(), bags_to);
+        BOOST_CHECK(data == buffer.data() + buffer.size());
+        auto received = cadmium::dynamic::bag_cast<cadmium::message_bag<byte_port_defs::in_ints>>(bags_to.at(typeid(byte_port_defs::in_ints)));
+        BOOST_CHECK(received.messages == bag.messages);
+
+        // the bags of the other ports keep the raw bytes of their message type
+        cadmium::message_bag<byte_port_defs::in_bytes> raw;
+        raw.messages = {1, 200, 7};
+        std::string raw_buffer;
+        cadmium::dynamic::engine::serialize_bag(raw, raw_buffer);
+        BOOST_CHECK_EQUAL(raw_buffer.size(), cadmium::dynamic::engine::message_serializer<int>::serialized_size(raw.messages));
+        BOOST_CHECK_EQUAL(raw_buffer.size(), sizeof(std::uint64_t) + 3 * sizeof(int));
+        cadmium::message_bag<byte_port_defs::in_bytes> read;
+        data = raw_buffer.data();
+        cadmium::dynamic::engine::deserialize_bag(data, raw_buffer.data() + raw_buffer.size(), read);
+        BOOST_CHECK(read.messages == raw.messages);
+    }
+
+    using namespace count_fives;
+
+    namespace {
+        using not_logger = cadmium::logger::not_logger;
+        using local_distributed_runner = cadmium::dynamic::engine::distributed_runner<float, cadmium::dynamic::engine::local_communicator, not_logger>;
+
+        int accumulated_value(const std::shared_ptr<cadmium::dynamic::modeling::coupled<float>>& model) {
+            // the dynamic atomic model derives from the atomic model class
+            auto accumulator_coupled = std::dynamic_pointer_cast<cadmium::dynamic::modeling::coupled<float>>(model->_models[1]);
+            auto accumulator = std::dynamic_pointer_cast<test_accumulator<float>>(accumulator_coupled->_models[0]);
+            BOOST_REQUIRE(accumulator != nullptr);
+            return std::get<int>(accumulator->state);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( distributed_runner_rejects_invalid_partitions_test ) {
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        std::string generators_id = model->_models[0]->get_id();
+        std::string accumulator_id = model->_models[1]->get_id();
+        auto communicators = cadmium::dynamic::engine::local_communicator::group(1);
+
+        using partitions = std::vector<std::vector<std::string>>;
+        BOOST_CHECK_THROW(local_distributed_runner(model, 0.0, communicators[0], partitions{{generators_id}, {accumulator_id}}), std::domain_error);
+        BOOST_CHECK_THROW(local_distributed_runner(model, 0.0, communicators[0], partitions{{generators_id}}), std::domain_error);
+        BOOST_CHECK_THROW(local_distributed_runner(model, 0.0, communicators[0], partitions{{generators_id, accumulator_id, accumulator_id}}), std::domain_error);
+    }
+
+    BOOST_AUTO_TEST_CASE( distributed_runner_reaches_the_same_state_than_runner_test ) {
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        cadmium::dynamic::engine::runner<float, not_logger> r(model, 0.0);
+        float next = r.run_until(23.0);
+
+        // each rank creates its own copy of the model, as the processes of an MPI program do
+        const std::size_t ranks = 2;
+        auto communicators = cadmium::dynamic::engine::local_communicator::group(ranks);
+        std::vector<std::shared_ptr<cadmium::dynamic::modeling::coupled<float>>> rank_models;
+        for (std::size_t i = 0; i < ranks; i++) {
+            rank_models.push_back(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>());
+        }
+        std::vector<std::vector<std::string>> partitions{{model->_models[0]->get_id()}, {model->_models[1]->get_id()}};
+
+        std::size_t releases = cadmium::message_arena::instance().stats().releases;
+        std::vector<float> rank_next(ranks);
+        std::vector<std::size_t> rank_remote_links(ranks);
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < ranks; i++) {
+            threads.emplace_back([&, i]() {
+                local_distributed_runner dr(rank_models[i], 0.0, communicators[i], partitions);
+                // a consumed message in the arena of the rank thread
+                cadmium::message_arena& arena = cadmium::message_arena::instance();
+                arena.deallocate(arena.allocate(sizeof(int), alignof(int)), sizeof(int));
+                rank_remote_links[i] = dr.remote_links();
+                rank_next[i] = dr.run_until(23.0);
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        BOOST_CHECK_EQUAL(rank_remote_links[0], 2);
+        BOOST_CHECK_EQUAL(rank_remote_links[1], 2);
+        BOOST_CHECK_EQUAL(next, rank_next[0]);
+        BOOST_CHECK_EQUAL(next, rank_next[1]);
+        // the accumulator only runs in the second rank
+        BOOST_CHECK_EQUAL(accumulated_value(model), accumulated_value(rank_models[1]));
+        BOOST_CHECK_EQUAL(accumulated_value(rank_models[0]), 0);
+        // each rank released the arena of its thread after its steps
+        BOOST_CHECK_EQUAL(cadmium::message_arena::instance().stats().releases, releases + ranks);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
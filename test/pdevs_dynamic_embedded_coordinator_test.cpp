@@ -0,0 +1,153 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <limits>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_embedded.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_dynamic_coordinator.hpp>
+#include <cadmium/engine/pdevs_dynamic_embedded_coordinator.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/basic_model/int_generator_one_sec.hpp>
+#include <cadmium/basic_model/reset_generator_five_sec.hpp>
+
+/**
+ * The count fives model, a static coupled accumulator is embedded in a dynamic coupled model receiving
+ * the messages of the translated generators.
+ */
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_embedded_coordinator_test_suite )
+
+    template<typename TIME>
+    using test_accumulator=cadmium::basic_models::accumulator<int, TIME>;
+    using test_accumulator_defs=cadmium::basic_models::accumulator_defs<int>;
+    using reset_tick=test_accumulator_defs::reset_tick;
+
+    using empty_iports=std::tuple<>;
+    using empty_eic=std::tuple<>;
+    using empty_ic=std::tuple<>;
+
+    using generators_oports=std::tuple<cadmium::basic_models::int_generator_one_sec_defs::out, cadmium::basic_models::reset_generator_five_sec_defs::out>;
+    using generators_submodels=cadmium::modeling::models_tuple<cadmium::basic_models::reset_generator_five_sec, cadmium::basic_models::int_generator_one_sec>;
+    using generators_eoc=std::tuple<
+            cadmium::modeling::EOC<cadmium::basic_models::reset_generator_five_sec, cadmium::basic_models::reset_generator_five_sec_defs::out, cadmium::basic_models::reset_generator_five_sec_defs::out>,
+            cadmium::modeling::EOC<cadmium::basic_models::int_generator_one_sec, cadmium::basic_models::int_generator_one_sec_defs::out, cadmium::basic_models::int_generator_one_sec_defs::out>
+    >;
+
+    template<typename TIME>
+    using coupled_generators_model=cadmium::modeling::coupled_model<TIME, empty_iports, generators_oports, generators_submodels, empty_eic, generators_eoc, empty_ic>;
+
+    using accumulator_eic=std::tuple<
+            cadmium::modeling::EIC<test_accumulator_defs::add, test_accumulator, test_accumulator_defs::add>,
+            cadmium::modeling::EIC<test_accumulator_defs::reset, test_accumulator, test_accumulator_defs::reset>
+    >;
+    using accumulator_eoc=std::tuple<
+            cadmium::modeling::EOC<test_accumulator, test_accumulator_defs::sum, test_accumulator_defs::sum>
+    >;
+
+    template<typename TIME>
+    using coupled_accumulator_model=cadmium::modeling::coupled_model<TIME, typename test_accumulator<TIME>::input_ports, typename test_accumulator<TIME>::output_ports, cadmium::modeling::models_tuple<test_accumulator>, accumulator_eic, accumulator_eoc, empty_ic>;
+
+    using embedded_accumulator=cadmium::dynamic::engine::embedded_coordinator<coupled_accumulator_model, float, cadmium::logger::not_logger>;
+
+    BOOST_AUTO_TEST_CASE( embedded_coordinator_converts_the_boundary_bags ) {
+        embedded_accumulator e("accumulator");
+        BOOST_CHECK_EQUAL(e.get_model_id(), "accumulator");
+
+        e.init(0.0f);
+        BOOST_CHECK_EQUAL(e.next(), std::numeric_limits<float>::infinity());
+
+        //the added values are accumulated by the static accumulator
+        e.inbox().get_bag<cadmium::message_bag<test_accumulator_defs::add>>(typeid(test_accumulator_defs::add)).messages = {2, 3};
+        e.advance_simulation(1.0f);
+        BOOST_CHECK(e.inbox().empty());
+        BOOST_CHECK_EQUAL(e.next(), std::numeric_limits<float>::infinity());
+
+        //the reset schedules the output of the sum
+        e.inbox().get_bag<cadmium::message_bag<test_accumulator_defs::reset>>(typeid(test_accumulator_defs::reset)).messages = {reset_tick{}};
+        e.advance_simulation(2.0f);
+        BOOST_CHECK_EQUAL(e.next(), 2.0f);
+
+        e.collect_outputs(2.0f);
+        BOOST_REQUIRE_EQUAL(e.outbox().size(), 1);
+        const auto& sum = cadmium::dynamic::bag_cast<const cadmium::message_bag<test_accumulator_defs::sum>&>(e.outbox().at(typeid(test_accumulator_defs::sum)));
+        BOOST_REQUIRE_EQUAL(sum.messages.size(), 1);
+        BOOST_CHECK_EQUAL(sum.messages.front(), 5);
+
+        //the outbox is cleared by the next advance
+        e.advance_simulation(2.0f);
+        BOOST_CHECK(e.outbox().empty());
+        BOOST_CHECK_EQUAL(e.next(), std::numeric_limits<float>::infinity());
+    }
+
+    BOOST_AUTO_TEST_CASE( embedded_model_in_dynamic_coupled_model ) {
+        std::shared_ptr<cadmium::dynamic::modeling::model> generators = cadmium::dynamic::translate::make_dynamic_coupled_model<float, coupled_generators_model>();
+        std::shared_ptr<cadmium::dynamic::modeling::model> accumulator = std::make_shared<cadmium::dynamic::modeling::embedded<coupled_accumulator_model, float>>("accumulator");
+
+        cadmium::dynamic::modeling::Models submodels = {generators, accumulator};
+        cadmium::dynamic::modeling::EOCs eocs = {
+                cadmium::dynamic::translate::make_EOC<test_accumulator_defs::sum, test_accumulator_defs::sum>("accumulator")
+        };
+        cadmium::dynamic::modeling::ICs ics = {
+                cadmium::dynamic::translate::make_IC<cadmium::basic_models::int_generator_one_sec_defs::out, test_accumulator_defs::add>(generators->get_id(), "accumulator"),
+                cadmium::dynamic::translate::make_IC<cadmium::basic_models::reset_generator_five_sec_defs::out, test_accumulator_defs::reset>(generators->get_id(), "accumulator")
+        };
+        auto top = std::make_shared<cadmium::dynamic::modeling::coupled<float>>(
+                "top",
+                submodels,
+                cadmium::dynamic::translate::make_ports<empty_iports>(),
+                cadmium::dynamic::translate::make_ports<std::tuple<test_accumulator_defs::sum>>(),
+                cadmium::dynamic::modeling::EICs{},
+                eocs,
+                ics
+        );
+
+        cadmium::dynamic::engine::coordinator<float, cadmium::logger::not_logger> c(top);
+        c.init(0.0f);
+
+        //every five seconds, five values were added before the reset and the sum is output
+        std::vector<float> output_times;
+        std::vector<int> sums;
+        while (c.next() <= 10.0f) {
+            float t = c.next();
+            c.collect_outputs(t);
+            auto it = c.outbox().find(typeid(test_accumulator_defs::sum));
+            if (it != c.outbox().end()) {
+                for (int s : cadmium::dynamic::bag_cast<const cadmium::message_bag<test_accumulator_defs::sum>&>(it->second).messages) {
+                    output_times.push_back(t);
+                    sums.push_back(s);
+                }
+            }
+            c.advance_simulation(t);
+        }
+        BOOST_CHECK((output_times == std::vector<float>{5.0f, 10.0f}));
+        BOOST_CHECK((sums == std::vector<int>{5, 5}));
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_DYN_LINK
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/modeling/dynamic_atomic.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_dynamic_ensemble_runner.hpp>
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_ensemble_runner_test_suite )
+
+    struct ticks_out : public cadmium::out_port<int>{};
+
+    // sends a 1 every period, the period is set by the replication
+    template<typename TIME>
+    struct ticker {
+        using input_ports=std::tuple<>;
+        using output_ports=std::tuple<ticks_out>;
+        using state_type=std::tuple<float>;
+        state_type state = std::make_tuple(1.0f);
+
+        ticker() = default;
+
+        explicit ticker(float period) : state(std::make_tuple(period)) {}
+
+        void internal_transition() {}
+
+        void external_transition(TIME, typename cadmium::make_message_bags<input_ports>::type) {}
+
+        void confluence_transition(TIME, typename cadmium::make_message_bags<input_ports>::type) {}
+
+        typename cadmium::make_message_bags<output_ports>::type output() const {
+            typename cadmium::make_message_bags<output_ports>::type bags;
+            cadmium::get_messages<ticks_out>(bags).push_back(1);
+            return bags;
+        }
+
+        TIME time_advance() const {
+            return std::get<0>(state);
+        }
+    };
+
+    template<typename TIME>
+    using counter = cadmium::basic_models::accumulator<int, TIME>;
+    using counter_add = cadmium::basic_models::accumulator_defs<int>::add;
+
+    struct replications_fixture {
+        std::vector<std::shared_ptr<cadmium::dynamic::modeling::atomic<counter, float>>> counters;
+
+        explicit replications_fixture(std::size_t replications) : counters(replications) {}
+
+        std::shared_ptr<cadmium::dynamic::modeling::coupled<float>> make(std::size_t replication) {
+            float period = 1.0f + replication % 3;
+            auto first = std::make_shared<cadmium::dynamic::modeling::atomic<ticker, float, float>>("first", float(period));
+            auto second = std::make_shared<cadmium::dynamic::modeling::atomic<ticker, float, float>>("second", float(period));
+            counters[replication] = std::make_shared<cadmium::dynamic::modeling::atomic<counter, float>>("counter");
+            cadmium::dynamic::modeling::Models models{first, second, counters[replication]};
+            cadmium::dynamic::modeling::ICs ics{
+                    cadmium::dynamic::translate::make_IC<ticks_out, counter_add>("first", "counter"),
+                    cadmium::dynamic::translate::make_IC<ticks_out, counter_add>("second", "counter")
+            };
+            return std::make_shared<cadmium::dynamic::modeling::coupled<float>>(
+                    "top", models, cadmium::dynamic::modeling::Ports{}, cadmium::dynamic::modeling::Ports{},
+                    cadmium::dynamic::modeling::EICs{}, cadmium::dynamic::modeling::EOCs{}, ics);
+        }
+    };
+
+    BOOST_AUTO_TEST_CASE( ensemble_runs_every_replication_and_shares_the_links_test ) {
+        replications_fixture f(8);
+        cadmium::dynamic::engine::ensemble_runner<float> ensemble(
+                [&f](std::size_t i) { return f.make(i); }, 8, 0.0f, 3);
+        auto counts = ensemble.run_until(10.0f, [&f](auto&, std::size_t i) {
+            return std::get<int>(f.counters[i]->state);
+        });
+        BOOST_REQUIRE_EQUAL(counts.size(), 8);
+        // the two tickers of period 1, 2 and 3 send before 10 for 9, 4 and 3 ticks
+        std::vector<int> expected{18, 8, 6, 18, 8, 6, 18, 8};
+        BOOST_CHECK_EQUAL_COLLECTIONS(counts.begin(), counts.end(), expected.begin(), expected.end());
+        BOOST_CHECK_EQUAL(ensemble.links().size(), 1);
+        BOOST_CHECK_EQUAL(ensemble.links().reused(), 15);
+    }
+
+    BOOST_AUTO_TEST_CASE( ensemble_rethrows_the_errors_of_the_replications_test ) {
+        replications_fixture f(4);
+        cadmium::dynamic::engine::ensemble_runner<float> ensemble([&f](std::size_t i) {
+            if (i == 2) {
+                throw std::runtime_error("bad replication");
+            }
+            return f.make(i);
+        }, 4, 0.0f, 2);
+        BOOST_CHECK_THROW(ensemble.run_until(5.0f, [](auto&, std::size_t) { return 0; }), std::runtime_error);
+        BOOST_CHECK_THROW(cadmium::dynamic::engine::ensemble_runner<float>(nullptr, 1, 0.0f), std::domain_error);
+    }
+
+    BOOST_AUTO_TEST_CASE( replication_statistics_summarize_the_results_test ) {
+        std::vector<int> results{2, 4, 4, 4, 5, 5, 7, 9};
+        auto s = cadmium::dynamic::engine::summarize(results.begin(), results.end());
+        BOOST_CHECK_EQUAL(s.count, 8);
+        BOOST_CHECK_CLOSE(s.mean, 5.0, 1e-9);
+        BOOST_CHECK_CLOSE(s.variance, 32.0 / 7, 1e-9);
+        BOOST_CHECK_EQUAL(s.min, 2);
+        BOOST_CHECK_EQUAL(s.max, 9);
+        BOOST_CHECK_CLOSE(s.confidence_half_width(), 1.96 * std::sqrt(32.0 / 7 / 8), 1e-9);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::engine::summarize(results.begin(), results.begin()).count, 0);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,316 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <atomic>
+#include <thread>
+#include <stdexcept>
+#include <map>
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/basic_model/int_generator_one_sec.hpp>
+#include <cadmium/basic_model/reset_generator_five_sec.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_dynamic_execution.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/logger/ordered_sink_provider.hpp>
+
+#include "count_fives_model.hpp"
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_execution_test_suite )
+
+    BOOST_AUTO_TEST_CASE( parallel_execution_visits_each_index_once_test ) {
+        cadmium::dynamic::engine::parallel_execution execution(4);
+        BOOST_CHECK_EQUAL(execution.threads(), 4);
+
+        std::vector<std::atomic<int>> visits(1000);
+        for (int round = 0; round < 10; round++) {
+            execution.for_each_index(visits.size(), [&visits](std::size_t i) { visits[i]++; });
+        }
+        for (const auto& v : visits) {
+            BOOST_CHECK_EQUAL(v.load(), 10);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( parallel_execution_runs_nested_loops_test ) {
+        cadmium::dynamic::engine::parallel_execution execution(4);
+        std::atomic<int> total{0};
+        execution.for_each_index(8, [&execution, &total](std::size_t) {
+            execution.for_each_index(8, [&total](std::size_t) { total++; });
+        });
+        BOOST_CHECK_EQUAL(total.load(), 64);
+    }
+
+    BOOST_AUTO_TEST_CASE( parallel_execution_rethrows_iteration_exceptions_test ) {
+        cadmium::dynamic::engine::parallel_execution execution(4);
+        std::atomic<int> visited{0};
+        auto failing = [&visited](std::size_t i) {
+            visited++;
+            if (i == 17) {
+                throw std::domain_error("failing iteration");
+            }
+        };
+        BOOST_CHECK_THROW(execution.for_each_index(100, failing), std::domain_error);
+        // the other iterations still run and the pool can be reused
+        BOOST_CHECK_EQUAL(visited.load(), 100);
+        visited = 0;
+        execution.for_each_index(100, [&visited](std::size_t) { visited++; });
+        BOOST_CHECK_EQUAL(visited.load(), 100);
+    }
+
+    BOOST_AUTO_TEST_CASE( partitioned_execution_runs_each_index_in_the_same_thread_test ) {
+        cadmium::dynamic::engine::thread_placement placement;
+        placement.partitioned = true;
+        cadmium::dynamic::engine::parallel_execution execution(4, placement);
+
+        std::vector<std::thread::id> threads(100);
+        execution.for_each_index(threads.size(), [&threads](std::size_t i) { threads[i] = std::this_thread::get_id(); });
+        for (int round = 0; round < 5; round++) {
+            std::vector<std::thread::id> again(threads.size());
+            execution.for_each_index(again.size(), [&again](std::size_t i) { again[i] = std::this_thread::get_id(); });
+            BOOST_CHECK(again == threads);
+        }
+
+        // four contiguous blocks of 25 indexes, the calling thread runs the first one
+        BOOST_CHECK(threads.front() == std::this_thread::get_id());
+        std::map<std::thread::id, std::size_t> sizes;
+        for (std::size_t i = 0; i < threads.size(); i++) {
+            sizes[threads[i]]++;
+            if (i % 25 != 0) {
+                BOOST_CHECK(threads[i] == threads[i - 1]);
+            }
+        }
+        BOOST_CHECK_EQUAL(sizes.size(), 4);
+    }
+
+    BOOST_AUTO_TEST_CASE( placement_pins_the_workers_to_the_cpus_of_the_nodes_test ) {
+        BOOST_CHECK((cadmium::dynamic::engine::parse_cpu_list("0-3,8,10-11\n") == std::vector<std::size_t>{0, 1, 2, 3, 8, 10, 11}));
+        BOOST_CHECK(cadmium::dynamic::engine::parse_cpu_list("").empty());
+
+        auto nodes = cadmium::dynamic::engine::numa_node_cpus();
+        BOOST_REQUIRE(!nodes.empty());
+        BOOST_REQUIRE(!nodes.front().empty());
+
+        auto placement = cadmium::dynamic::engine::thread_placement::by_node(3);
+        BOOST_CHECK(placement.partitioned);
+        BOOST_CHECK_EQUAL(placement.worker_cpus.size(), 2);
+
+#if defined(__linux__)
+        // a worker pinned to the cpu the test runs on, the other ones can be unavailable to the process
+        placement.worker_cpus = {static_cast<std::size_t>(sched_getcpu())};
+        cadmium::dynamic::engine::parallel_execution execution(2, placement);
+        BOOST_CHECK_EQUAL(execution.pinned_threads(), 1);
+#else
+        cadmium::dynamic::engine::parallel_execution execution(2, placement);
+#endif
+        std::atomic<int> visited{0};
+        execution.for_each_index(10, [&visited](std::size_t) { visited++; });
+        BOOST_CHECK_EQUAL(visited.load(), 10);
+    }
+
+    BOOST_AUTO_TEST_CASE( work_stealing_execution_visits_each_index_once_test ) {
+        for (std::size_t grain : {1, 3, 64, 2000}) {
+            cadmium::dynamic::engine::work_stealing_execution execution(4, grain, 2);
+            BOOST_CHECK_EQUAL(execution.threads(), 4);
+            BOOST_CHECK_EQUAL(execution.grain_size(), grain);
+
+            std::vector<std::atomic<int>> visits(1000);
+            for (int round = 0; round < 10; round++) {
+                execution.for_each_index(visits.size(), [&visits](std::size_t i) { visits[i]++; });
+            }
+            for (const auto& v : visits) {
+                BOOST_CHECK_EQUAL(v.load(), 10);
+            }
+
+            // every chunk is run by exactly one thread
+            const auto& statistics = execution.statistics();
+            BOOST_CHECK_EQUAL(statistics.size(), 4);
+            std::size_t iterations = 0, chunks = 0;
+            for (const auto& s : statistics) {
+                iterations += s.iterations;
+                chunks += s.chunks;
+                BOOST_CHECK(s.stolen_chunks <= s.chunks);
+            }
+            BOOST_CHECK_EQUAL(iterations, 10000);
+            BOOST_CHECK_EQUAL(chunks, 10 * ((1000 + grain - 1) / grain));
+            BOOST_CHECK_EQUAL(statistics[0].loops, 10);
+
+            execution.reset_statistics();
+            BOOST_CHECK_EQUAL(execution.statistics()[0].iterations, 0);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( work_stealing_execution_runs_small_loops_in_the_calling_thread_test ) {
+        cadmium::dynamic::engine::work_stealing_execution execution(4, 1, 16);
+        std::thread::id caller = std::this_thread::get_id();
+        std::atomic<int> other_threads{0};
+        execution.for_each_index(15, [&caller, &other_threads](std::size_t) {
+            if (std::this_thread::get_id() != caller) {
+                other_threads++;
+            }
+        });
+        BOOST_CHECK_EQUAL(other_threads.load(), 0);
+        BOOST_CHECK_EQUAL(execution.statistics()[0].loops, 0);
+    }
+
+    BOOST_AUTO_TEST_CASE( work_stealing_execution_runs_nested_loops_and_rethrows_test ) {
+        cadmium::dynamic::engine::work_stealing_execution execution(4, 2, 2);
+        std::atomic<int> total{0};
+        execution.for_each_index(8, [&execution, &total](std::size_t) {
+            execution.for_each_index(8, [&total](std::size_t) { total++; });
+        });
+        BOOST_CHECK_EQUAL(total.load(), 64);
+
+        std::atomic<int> visited{0};
+        auto failing = [&visited](std::size_t i) {
+            visited++;
+            if (i == 17) {
+                throw std::domain_error("failing iteration");
+            }
+        };
+        BOOST_CHECK_THROW(execution.for_each_index(100, failing), std::domain_error);
+        BOOST_CHECK_EQUAL(visited.load(), 100);
+    }
+
+    using namespace count_fives;
+
+    namespace {
+        std::ostringstream oss;
+
+        struct oss_test_sink_provider{
+            static std::ostream& sink(){
+                return oss;
+            }
+        };
+    }
+
+    BOOST_AUTO_TEST_CASE( parallel_runner_routes_the_same_messages_than_sequential_runner_test ) {
+        // only the coordinator logs the routing, after the outputs of all imminent models were collected
+        using log_messages=cadmium::logger::logger<cadmium::logger::logger_message_routing, cadmium::dynamic::logger::formatter<float>, oss_test_sink_provider>;
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_messages> r_sequential(model, 0.0, true);
+        float sequential_next = r_sequential.run_until(21.0);
+        std::string sequential_outputs = oss.str();
+
+        oss.str("");
+        cadmium::dynamic::engine::parallel_execution execution(3);
+        cadmium::dynamic::engine::runner<float, log_messages, cadmium::dynamic::engine::no_fel<float>, cadmium::dynamic::engine::parallel_execution> r_parallel(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), 0.0, execution, true);
+        float parallel_next = r_parallel.run_until(21.0);
+        std::string parallel_outputs = oss.str();
+
+        BOOST_CHECK_EQUAL(sequential_next, parallel_next);
+        BOOST_CHECK(!parallel_outputs.empty());
+        BOOST_CHECK_EQUAL(sequential_outputs, parallel_outputs);
+    }
+
+    BOOST_AUTO_TEST_CASE( work_stealing_runner_routes_the_same_messages_than_sequential_runner_test ) {
+        using log_messages=cadmium::logger::logger<cadmium::logger::logger_message_routing, cadmium::dynamic::logger::formatter<float>, oss_test_sink_provider>;
+
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_messages> r_sequential(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), 0.0, true);
+        float sequential_next = r_sequential.run_until(21.0);
+        std::string sequential_outputs = oss.str();
+
+        oss.str("");
+        cadmium::dynamic::engine::work_stealing_execution execution(3, 1, 2);
+        cadmium::dynamic::engine::runner<float, log_messages, cadmium::dynamic::engine::no_fel<float>, cadmium::dynamic::engine::work_stealing_execution> r_parallel(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), 0.0, execution, true);
+        float parallel_next = r_parallel.run_until(21.0);
+        std::string parallel_outputs = oss.str();
+
+        BOOST_CHECK_EQUAL(sequential_next, parallel_next);
+        BOOST_CHECK(!parallel_outputs.empty());
+        BOOST_CHECK_EQUAL(sequential_outputs, parallel_outputs);
+        BOOST_CHECK(execution.statistics()[0].loops > 0);
+    }
+
+    BOOST_AUTO_TEST_CASE( deterministic_execution_replays_the_logs_in_index_order_and_rethrows_the_lowest_error_test ) {
+        using ordered_sink=cadmium::logger::ordered_sink_provider<oss_test_sink_provider>;
+        cadmium::dynamic::engine::deterministic_execution<> execution(cadmium::dynamic::engine::parallel_execution(4));
+
+        oss.str("");
+        execution.for_each_index(50, [&execution](std::size_t i) {
+            execution.for_each_index(2, [i](std::size_t j) {
+                ordered_sink::sink() << i << "." << j << std::endl;
+            });
+        });
+        std::ostringstream expected;
+        for (std::size_t i = 0; i < 50; i++) {
+            expected << i << ".0\n" << i << ".1\n";
+        }
+        BOOST_CHECK_EQUAL(oss.str(), expected.str());
+
+        oss.str("");
+        auto failing = [](std::size_t i) {
+            ordered_sink::sink() << i << std::endl;
+            if (i == 17 || i == 40) {
+                throw std::domain_error(std::to_string(i));
+            }
+        };
+        std::string error;
+        try {
+            execution.for_each_index(100, failing);
+        } catch (const std::domain_error& e) {
+            error = e.what();
+        }
+        BOOST_CHECK_EQUAL(error, "17");
+        // the lines of the iterations before the failing one, as a sequential loop logs them
+        expected.str("");
+        for (std::size_t i = 0; i < 17; i++) {
+            expected << i << "\n";
+        }
+        BOOST_CHECK_EQUAL(oss.str(), expected.str());
+    }
+
+    BOOST_AUTO_TEST_CASE( deterministic_runner_logs_the_same_trace_than_sequential_runner_test ) {
+        // the simulators log their states and outputs from the threads of the pool
+        using ordered_sink=cadmium::logger::ordered_sink_provider<oss_test_sink_provider>;
+        using log_all=cadmium::logger::multilogger<
+                cadmium::logger::logger<cadmium::logger::logger_state, cadmium::dynamic::logger::formatter<float>, ordered_sink>,
+                cadmium::logger::logger<cadmium::logger::logger_messages, cadmium::dynamic::logger::formatter<float>, ordered_sink>,
+                cadmium::logger::logger<cadmium::logger::logger_message_routing, cadmium::dynamic::logger::formatter<float>, ordered_sink>>;
+        using deterministic=cadmium::dynamic::engine::deterministic_execution<cadmium::dynamic::engine::work_stealing_execution>;
+
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_all> r_sequential(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), 0.0, true);
+        r_sequential.run_until(21.0);
+        std::string sequential_trace = oss.str();
+
+        for (std::size_t threads : {2, 4}) {
+            oss.str("");
+            deterministic execution(cadmium::dynamic::engine::work_stealing_execution(threads, 1, 1));
+            cadmium::dynamic::engine::runner<float, log_all, cadmium::dynamic::engine::no_fel<float>, deterministic> r_deterministic(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), 0.0, execution, true);
+            r_deterministic.run_until(21.0);
+            BOOST_CHECK(!sequential_trace.empty());
+            BOOST_CHECK_EQUAL(sequential_trace, oss.str());
+        }
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,396 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <random>
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/basic_model/int_generator_one_sec.hpp>
+#include <cadmium/basic_model/reset_generator_five_sec.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/tick_time.hpp>
+#include <cadmium/engine/pdevs_dynamic_fel.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+
+#include "count_fives_model.hpp"
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_fel_test_suite )
+
+    BOOST_AUTO_TEST_CASE( empty_fels_are_scheduled_at_infinity_test ) {
+        cadmium::dynamic::engine::no_fel<float> nf;
+        cadmium::dynamic::engine::heap_fel<float> hf;
+        cadmium::dynamic::engine::calendar_fel<float> cf;
+        cadmium::dynamic::engine::ladder_fel<float> lf;
+        cadmium::dynamic::engine::tournament_fel<float> tf;
+        nf.reset(0);
+        hf.reset(0);
+        cf.reset(0);
+        lf.reset(0);
+        tf.reset(0);
+        BOOST_CHECK_EQUAL(nf.next(), std::numeric_limits<float>::infinity());
+        BOOST_CHECK_EQUAL(hf.next(), std::numeric_limits<float>::infinity());
+        BOOST_CHECK_EQUAL(cf.next(), std::numeric_limits<float>::infinity());
+        BOOST_CHECK_EQUAL(lf.next(), std::numeric_limits<float>::infinity());
+        BOOST_CHECK_EQUAL(tf.next(), std::numeric_limits<float>::infinity());
+        std::vector<std::size_t> imminent;
+        tf.imminent(std::numeric_limits<float>::infinity(), imminent);
+        BOOST_CHECK(imminent.empty());
+    }
+
+    template<typename TIME>
+    void check_min_time_against_min_element(std::mt19937& gen) {
+        std::uniform_int_distribution<int> dist(0, 1000);
+        for (std::size_t size = 1; size < 70; size++) {
+            std::vector<TIME> times(size);
+            for (auto& t : times) {
+                t = static_cast<TIME>(dist(gen));
+            }
+            if (size % 3 == 0) {
+                times[size / 2] = std::numeric_limits<TIME>::infinity();
+            }
+            BOOST_CHECK(cadmium::dynamic::engine::min_time(times.data(), size) == *std::min_element(times.begin(), times.end()));
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( min_time_reduces_any_number_of_times_test ) {
+        std::mt19937 gen(7);
+        BOOST_CHECK(cadmium::dynamic::engine::min_time<float>(nullptr, 0) == std::numeric_limits<float>::infinity());
+        check_min_time_against_min_element<float>(gen);
+        check_min_time_against_min_element<double>(gen);
+        check_min_time_against_min_element<cadmium::tick_time<>>(gen);
+    }
+
+    BOOST_AUTO_TEST_CASE( heap_fel_keeps_lowest_next_and_imminents_test ) {
+        cadmium::dynamic::engine::heap_fel<float> fel;
+        fel.reset(6);
+        fel.update(0, 5.0f);
+        fel.update(1, 2.0f);
+        fel.update(2, 7.0f);
+        fel.update(3, 2.0f);
+        fel.update(4, 3.0f);
+        fel.update(5, 2.0f);
+        BOOST_CHECK_EQUAL(fel.next(), 2.0f);
+
+        std::vector<std::size_t> imminent;
+        fel.imminent(2.0f, imminent);
+        BOOST_CHECK((imminent == std::vector<std::size_t>{1, 3, 5}));
+
+        // rescheduling the imminents moves the next time forward
+        fel.update(1, 4.0f);
+        fel.update(3, 6.0f);
+        fel.update(5, std::numeric_limits<float>::infinity());
+        BOOST_CHECK_EQUAL(fel.next(), 3.0f);
+
+        imminent.clear();
+        fel.imminent(3.0f, imminent);
+        BOOST_CHECK((imminent == std::vector<std::size_t>{4}));
+
+        // moving an engine backward in time also works
+        fel.update(2, 1.0f);
+        BOOST_CHECK_EQUAL(fel.next(), 1.0f);
+
+        imminent.clear();
+        fel.imminent(2.0f, imminent);
+        BOOST_CHECK(imminent.empty());
+    }
+
+    // simulates a coordinator rescheduling its imminent subengines and some receivers, comparing with no_fel
+    template<typename FEL>
+    void check_fel_against_no_fel(std::size_t engines, float spread, unsigned seed) {
+        std::mt19937 generator(seed);
+        std::uniform_int_distribution<int> advance(0, static_cast<int>(spread));
+        std::uniform_int_distribution<std::size_t> engine(0, engines - 1);
+        const float infinity = std::numeric_limits<float>::infinity();
+
+        cadmium::dynamic::engine::no_fel<float> expected;
+        FEL fel;
+        expected.reset(engines);
+        fel.reset(engines);
+        for (std::size_t i = 0; i < engines; i++) {
+            float next = i % 7 == 0 ? infinity : static_cast<float>(advance(generator));
+            expected.update(i, next);
+            fel.update(i, next);
+        }
+
+        for (int step = 0; step < 2000 && expected.next() != infinity; step++) {
+            float now = expected.next();
+            BOOST_REQUIRE_EQUAL(fel.next(), now);
+
+            std::vector<std::size_t> expected_imminent, imminent;
+            expected.imminent(now, expected_imminent);
+            fel.imminent(now, imminent);
+            BOOST_REQUIRE(expected_imminent == imminent);
+
+            for (std::size_t i : imminent) {
+                float next = step % 11 == 0 ? infinity : now + 1 + advance(generator);
+                expected.update(i, next);
+                fel.update(i, next);
+            }
+            // receivers are rescheduled from now, passive ones are activated
+            for (int r = 0; r < 3; r++) {
+                std::size_t i = engine(generator);
+                float next = now + advance(generator) / 2;
+                expected.update(i, next);
+                fel.update(i, next);
+            }
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( scheduling_fels_keep_the_same_next_and_imminents_than_no_fel_test ) {
+        for (unsigned seed : {1u, 2u, 3u}) {
+            for (std::size_t engines : {1, 5, 300}) {
+                for (float spread : {0.0f, 3.0f, 1000.0f}) {
+                    check_fel_against_no_fel<cadmium::dynamic::engine::heap_fel<float>>(engines, spread, seed);
+                    check_fel_against_no_fel<cadmium::dynamic::engine::calendar_fel<float>>(engines, spread, seed);
+                    check_fel_against_no_fel<cadmium::dynamic::engine::ladder_fel<float>>(engines, spread, seed);
+                    check_fel_against_no_fel<cadmium::dynamic::engine::tournament_fel<float>>(engines, spread, seed);
+                }
+            }
+        }
+    }
+
+    // grows and shrinks the FEL as a coordinator adding and removing subengines, the last one takes the removed index
+    template<typename FEL>
+    void check_fel_resize() {
+        const float infinity = std::numeric_limits<float>::infinity();
+        FEL fel;
+        fel.reset(3);
+        fel.update(0, 4.0f);
+        fel.update(1, 2.0f);
+        fel.update(2, 3.0f);
+
+        fel.resize(5);
+        BOOST_CHECK_EQUAL(fel.next(), 2.0f);
+        fel.update(3, 1.0f);
+        fel.update(4, 2.0f);
+        BOOST_CHECK_EQUAL(fel.next(), 1.0f);
+
+        // removes the engine 3, the engine 4 takes its index
+        fel.update(3, 2.0f);
+        fel.update(4, infinity);
+        fel.resize(4);
+        BOOST_CHECK_EQUAL(fel.next(), 2.0f);
+        std::vector<std::size_t> imminent;
+        fel.imminent(2.0f, imminent);
+        BOOST_CHECK((imminent == std::vector<std::size_t>{1, 3}));
+
+        // removes the engine 1, then the last one
+        fel.update(1, 2.0f);
+        fel.update(3, infinity);
+        fel.resize(3);
+        fel.update(2, infinity);
+        fel.resize(2);
+        BOOST_CHECK_EQUAL(fel.next(), 2.0f);
+        imminent.clear();
+        fel.imminent(2.0f, imminent);
+        BOOST_CHECK((imminent == std::vector<std::size_t>{1}));
+
+        // a new engine at a removed index is not scheduled
+        fel.resize(3);
+        imminent.clear();
+        fel.imminent(2.0f, imminent);
+        BOOST_CHECK((imminent == std::vector<std::size_t>{1}));
+        fel.update(1, infinity);
+        BOOST_CHECK_EQUAL(fel.next(), 4.0f);
+    }
+
+    BOOST_AUTO_TEST_CASE( fels_keep_the_next_times_when_resized_test ) {
+        check_fel_resize<cadmium::dynamic::engine::no_fel<float>>();
+        check_fel_resize<cadmium::dynamic::engine::heap_fel<float>>();
+        check_fel_resize<cadmium::dynamic::engine::calendar_fel<float>>();
+        check_fel_resize<cadmium::dynamic::engine::ladder_fel<float>>();
+        check_fel_resize<cadmium::dynamic::engine::tournament_fel<float>>();
+    }
+
+    BOOST_AUTO_TEST_CASE( ladder_fel_finds_imminents_at_any_time_test ) {
+        cadmium::dynamic::engine::ladder_fel<float> fel;
+        fel.reset(4);
+        fel.update(0, 5.0f);
+        fel.update(1, 2.0f);
+        fel.update(2, 5.0f);
+        fel.update(1, 3.0f);
+
+        std::vector<std::size_t> imminent;
+        fel.imminent(2.0f, imminent);
+        BOOST_CHECK(imminent.empty());
+        fel.imminent(5.0f, imminent);
+        BOOST_CHECK((imminent == std::vector<std::size_t>{0, 2}));
+        BOOST_CHECK_EQUAL(fel.next(), 3.0f);
+    }
+
+    using namespace count_fives;
+
+    namespace {
+        std::ostringstream oss;
+
+        struct oss_test_sink_provider{
+            static std::ostream& sink(){
+                return oss;
+            }
+        };
+    }
+
+    using log_messages=cadmium::logger::logger<cadmium::logger::logger_messages, cadmium::dynamic::logger::formatter<float>, oss_test_sink_provider>;
+    using log_info=cadmium::logger::logger<cadmium::logger::logger_info, cadmium::dynamic::logger::formatter<float>, oss_test_sink_provider>;
+
+    BOOST_AUTO_TEST_CASE( heap_fel_runner_produces_the_same_outputs_than_no_fel_runner_test ) {
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_messages> r_no_fel(model, 0.0);
+        float no_fel_next = r_no_fel.run_until(21.0);
+        std::string no_fel_outputs = oss.str();
+
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_messages, cadmium::dynamic::engine::heap_fel<float>> r_heap_fel(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), 0.0);
+        float heap_fel_next = r_heap_fel.run_until(21.0);
+        std::string heap_fel_outputs = oss.str();
+
+        BOOST_CHECK_EQUAL(no_fel_next, heap_fel_next);
+        BOOST_CHECK(!heap_fel_outputs.empty());
+        BOOST_CHECK_EQUAL(no_fel_outputs, heap_fel_outputs);
+        // only imminent models are asked for output, with or without FEL
+        BOOST_CHECK(no_fel_outputs.find("[]") == std::string::npos);
+    }
+
+    BOOST_AUTO_TEST_CASE( heap_fel_runner_advances_only_active_models_test ) {
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        std::string accumulator_advance = "Simulator for model " + boost::typeindex::type_id<test_accumulator<float>>().pretty_name() + " advancing";
+
+        auto count_matches = [](const std::string& nail, const std::string& haystack) -> int {
+            int count = 0;
+            for (size_t pos = haystack.find(nail); pos != std::string::npos; pos = haystack.find(nail, pos + 1)) {
+                count++;
+            }
+            return count;
+        };
+
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_info> r_no_fel(model, 0.0);
+        r_no_fel.run_until(11.0);
+        // the accumulator is advanced on every step: 10 one second ticks plus 2 resets
+        BOOST_CHECK_EQUAL(count_matches(accumulator_advance, oss.str()), 12);
+
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_info, cadmium::dynamic::engine::heap_fel<float>> r_heap_fel(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), 0.0);
+        r_heap_fel.run_until(11.0);
+        // the accumulator receives messages on every step too, but passive generators are not visited
+        BOOST_CHECK_EQUAL(count_matches(accumulator_advance, oss.str()), 12);
+        std::string reset_generator_advance = "Simulator for model " + boost::typeindex::type_id<cadmium::basic_models::reset_generator_five_sec<float>>().pretty_name() + " advancing";
+        BOOST_CHECK_EQUAL(count_matches(reset_generator_advance, oss.str()), 2);
+    }
+
+    BOOST_AUTO_TEST_CASE( zero_time_cascades_advance_only_the_cascading_models_test ) {
+        std::string generator_advance = "Simulator for model " + boost::typeindex::type_id<cadmium::basic_models::int_generator_one_sec<float>>().pretty_name() + " advancing";
+        std::string accumulator_advance = "Simulator for model " + boost::typeindex::type_id<test_accumulator<float>>().pretty_name() + " advancing";
+
+        auto count_matches = [](const std::string& nail, const std::string& haystack) -> int {
+            int count = 0;
+            for (size_t pos = haystack.find(nail); pos != std::string::npos; pos = haystack.find(nail, pos + 1)) {
+                count++;
+            }
+            return count;
+        };
+
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_info> r(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), 0.0);
+        r.run_until(11.0);
+        // the accumulator outputs its sum at 5 and 10 in a second step at the same time, the generators
+        // are not visited in these steps even without FEL
+        BOOST_CHECK_EQUAL(count_matches(generator_advance, oss.str()), 10);
+        BOOST_CHECK_EQUAL(count_matches(accumulator_advance, oss.str()), 12);
+    }
+
+    // the accumulator only receives the resets, it is passive between them
+    using resets_ic=std::tuple<
+            cadmium::modeling::IC<coupled_generators_model, cadmium::basic_models::reset_generator_five_sec_defs::out , coupled_accumulator_model, test_accumulator_defs::reset>
+    >;
+    template<typename TIME>
+    using resets_model=cadmium::modeling::coupled_model<TIME, empty_iports, top_oports, top_submodels, empty_eic, top_eoc, resets_ic>;
+
+    BOOST_AUTO_TEST_CASE( heap_fel_runner_advances_passive_models_only_when_routed_test ) {
+        std::string accumulator_advance = "Simulator for model " + boost::typeindex::type_id<test_accumulator<float>>().pretty_name() + " advancing";
+        std::string accumulator_coordinator_advance = "Coordinator for model " + boost::typeindex::type_id<coupled_accumulator_model<float>>().pretty_name() + " advancing";
+
+        auto count_matches = [](const std::string& nail, const std::string& haystack) -> int {
+            int count = 0;
+            for (size_t pos = haystack.find(nail); pos != std::string::npos; pos = haystack.find(nail, pos + 1)) {
+                count++;
+            }
+            return count;
+        };
+
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_info, cadmium::dynamic::engine::heap_fel<float>> r(cadmium::dynamic::translate::make_dynamic_coupled_model<float, resets_model>(), 0.0);
+        r.run_until(11.0);
+        // 10 steps of the one second generator, the accumulator advances on the resets at 5 and 10
+        // and on the outputs of their sums at the same times
+        BOOST_CHECK_EQUAL(count_matches(accumulator_advance, oss.str()), 4);
+        BOOST_CHECK_EQUAL(count_matches(accumulator_coordinator_advance, oss.str()), 4);
+    }
+
+    BOOST_AUTO_TEST_CASE( calendar_and_ladder_fel_runners_produce_the_same_outputs_than_no_fel_runner_test ) {
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_messages> r_no_fel(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), 0.0, true);
+        float no_fel_next = r_no_fel.run_until(31.0);
+        std::string no_fel_outputs = oss.str();
+
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_messages, cadmium::dynamic::engine::calendar_fel<float>> r_calendar(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), 0.0, true);
+        float calendar_next = r_calendar.run_until(31.0);
+        std::string calendar_outputs = oss.str();
+
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_messages, cadmium::dynamic::engine::ladder_fel<float>> r_ladder(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), 0.0);
+        float ladder_next = r_ladder.run_until(31.0);
+        std::string ladder_outputs = oss.str();
+
+        BOOST_CHECK(!no_fel_outputs.empty());
+        BOOST_CHECK_EQUAL(no_fel_next, calendar_next);
+        BOOST_CHECK_EQUAL(no_fel_next, ladder_next);
+        BOOST_CHECK_EQUAL(no_fel_outputs, calendar_outputs);
+        BOOST_CHECK_EQUAL(no_fel_outputs, ladder_outputs);
+    }
+
+    BOOST_AUTO_TEST_CASE( tournament_fel_runner_produces_the_same_outputs_than_no_fel_runner_test ) {
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_messages> r_no_fel(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), 0.0, true);
+        float no_fel_next = r_no_fel.run_until(31.0);
+        std::string no_fel_outputs = oss.str();
+
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_messages, cadmium::dynamic::engine::tournament_fel<float>> r_tournament(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), 0.0, true);
+        float tournament_next = r_tournament.run_until(31.0);
+
+        BOOST_CHECK(!no_fel_outputs.empty());
+        BOOST_CHECK_EQUAL(no_fel_next, tournament_next);
+        BOOST_CHECK_EQUAL(no_fel_outputs, oss.str());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
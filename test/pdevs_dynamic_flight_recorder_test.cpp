@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_flight_recorder.hpp>
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_flight_recorder_test_suite )
+
+    using cadmium::dynamic::engine::flight_event;
+    using cadmium::dynamic::engine::flight_recorder;
+
+    struct test_recorder_out : public cadmium::out_port<int> {};
+
+    // an atomic model failing in its third internal transition
+    template<typename TIME>
+    struct test_failing_model {
+        using input_ports = std::tuple<>;
+        using output_ports = std::tuple<test_recorder_out>;
+        using state_type = int;
+        state_type state = 0;
+
+        void internal_transition() {
+            if (++state == 3) {
+                throw std::runtime_error("The model failed");
+            }
+        }
+
+        void external_transition(TIME, typename cadmium::make_message_bags<input_ports>::type) {}
+
+        void confluence_transition(TIME, typename cadmium::make_message_bags<input_ports>::type) {}
+
+        typename cadmium::make_message_bags<output_ports>::type output() const {
+            return typename cadmium::make_message_bags<output_ports>::type();
+        }
+
+        TIME time_advance() const {
+            return TIME(1);
+        }
+    };
+
+    template<typename TIME>
+    using test_failing_coupled = cadmium::modeling::coupled_model<TIME, std::tuple<>, std::tuple<>, cadmium::modeling::models_tuple<test_failing_model>, std::tuple<>, std::tuple<>, std::tuple<>>;
+
+    BOOST_AUTO_TEST_CASE( flight_recorder_keeps_the_last_records_of_the_thread_test ) {
+        flight_recorder& recorder = flight_recorder::instance();
+        recorder.set_capacity(3);
+        BOOST_CHECK_EQUAL(recorder.capacity(), 4);
+
+        for (int i = 0; i < 6; i++) {
+            recorder.record(flight_event::run_step, static_cast<double>(i));
+        }
+        auto records = recorder.records();
+        BOOST_REQUIRE_EQUAL(records.size(), 1);
+        BOOST_REQUIRE_EQUAL(records[0].size(), 4);
+        BOOST_CHECK_EQUAL(records[0].front().time, 2.0);
+        BOOST_CHECK_EQUAL(records[0].back().time, 5.0);
+        BOOST_CHECK(records[0].back().model == cadmium::dynamic::engine::flight_record::no_model);
+
+        recorder.set_capacity(flight_recorder::default_capacity);
+        BOOST_CHECK(recorder.records().empty());
+    }
+
+    BOOST_AUTO_TEST_CASE( flight_recorder_is_dumped_when_a_run_fails_test ) {
+        flight_recorder& recorder = flight_recorder::instance();
+        recorder.set_capacity(flight_recorder::default_capacity);
+        const std::string path = "pdevs_dynamic_flight_recorder_test.bin";
+        std::remove(path.c_str());
+        recorder.set_failure_path(path);
+
+        auto coupled = cadmium::dynamic::translate::make_dynamic_coupled_model<float, test_failing_coupled>();
+        cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(coupled, 0.0);
+        BOOST_CHECK_THROW(r.run_until(10.0), std::runtime_error);
+
+        std::ifstream is(path, std::ios::binary);
+        BOOST_REQUIRE(is);
+        std::ostringstream text;
+        cadmium::dynamic::engine::convert_flight_record(is, text);
+        const std::string model_id = cadmium::dynamic::translate::make_dynamic_atomic_model<test_failing_model, float>()->get_id();
+        const std::string expected = "0 1 run_step\n"
+                                     "0 1 collect_outputs " + model_id + "\n"
+                                     "0 1 internal_transition " + model_id + "\n"
+                                     "0 2 run_step\n"
+                                     "0 2 collect_outputs " + model_id + "\n"
+                                     "0 2 internal_transition " + model_id + "\n"
+                                     "0 3 run_step\n"
+                                     "0 3 collect_outputs " + model_id + "\n"
+                                     "0 3 internal_transition " + model_id + "\n";
+        BOOST_CHECK_EQUAL(text.str(), expected);
+
+        is.close();
+        std::remove(path.c_str());
+        recorder.set_failure_path("cadmium_flight_record.bin");
+    }
+
+    BOOST_AUTO_TEST_CASE( flight_recorder_rejects_other_files_test ) {
+        std::istringstream is("CDMT and more");
+        std::ostringstream os;
+        BOOST_CHECK_THROW(cadmium::dynamic::engine::convert_flight_record(is, os), std::domain_error);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_DYN_LINK
+#include <deque>
+#include <boost/test/unit_test.hpp>
+
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_input_stream.hpp>
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_input_stream_test_suite )
+
+    template<typename TIME>
+    struct input_accumulator : public cadmium::basic_models::accumulator<int, TIME> {};
+
+    using accumulator_defs = cadmium::basic_models::accumulator_defs<int>;
+
+    struct values_in : public cadmium::in_port<int>{};
+    struct reset_in : public cadmium::in_port<accumulator_defs::reset_tick>{};
+    struct unused_in : public cadmium::in_port<int>{};
+
+    struct input_fixture {
+        std::shared_ptr<cadmium::dynamic::modeling::model> accumulator =
+                cadmium::dynamic::translate::make_dynamic_atomic_model<input_accumulator, float>("accumulator");
+        cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> runner;
+
+        input_fixture()
+        : runner(std::make_shared<cadmium::dynamic::modeling::coupled<float>>(
+                "top", cadmium::dynamic::modeling::Models{accumulator},
+                cadmium::dynamic::modeling::Ports{typeid(values_in), typeid(reset_in)}, cadmium::dynamic::modeling::Ports{},
+                cadmium::dynamic::modeling::EICs{
+                        cadmium::dynamic::translate::make_EIC<values_in, accumulator_defs::add>("accumulator"),
+                        cadmium::dynamic::translate::make_EIC<reset_in, accumulator_defs::reset>("accumulator")},
+                cadmium::dynamic::modeling::EOCs{}, cadmium::dynamic::modeling::ICs{}), 0.0f) {}
+
+        int sum() const {
+            return std::get<int>(std::dynamic_pointer_cast<input_accumulator<float>>(accumulator)->state);
+        }
+    };
+
+    BOOST_AUTO_TEST_CASE( runner_merges_the_recorded_events_with_the_internal_ones_test ) {
+        input_fixture f;
+        std::vector<cadmium::dynamic::engine::input_event<float>> recorded;
+        recorded.push_back(cadmium::dynamic::engine::make_input_event<values_in>(3.0f, 5));
+        recorded.push_back(cadmium::dynamic::engine::make_input_event<values_in>(1.5f, 2));
+        recorded.push_back(cadmium::dynamic::engine::make_input_event<values_in>(3.0f, 1));
+        recorded.push_back(cadmium::dynamic::engine::make_input_event<reset_in>(4.0f, accumulator_defs::reset_tick{}));
+        recorded.push_back(cadmium::dynamic::engine::make_input_event<values_in>(6.0f, 7));
+        f.runner.add_input_stream(cadmium::dynamic::engine::make_input_stream(std::move(recorded)));
+
+        BOOST_CHECK_EQUAL(f.runner.next(), 1.5f);
+        BOOST_CHECK_EQUAL(f.runner.advance_to(2.0f), 3.0f);
+        BOOST_CHECK_EQUAL(f.sum(), 2);
+        // both events at 3 are delivered in the same step
+        BOOST_CHECK_EQUAL(f.runner.step(), 4.0f);
+        BOOST_CHECK_EQUAL(f.sum(), 8);
+        // the reset makes the accumulator imminent at 4, after its input
+        BOOST_CHECK_EQUAL(f.runner.run_until(5.0f), 6.0f);
+        BOOST_CHECK_EQUAL(f.sum(), 0);
+        f.runner.run_until_passivate();
+        BOOST_CHECK_EQUAL(f.sum(), 7);
+        BOOST_CHECK_EQUAL(f.runner.next(), std::numeric_limits<float>::infinity());
+    }
+
+    BOOST_AUTO_TEST_CASE( runner_asks_a_live_source_again_at_each_step_test ) {
+        input_fixture f;
+        std::deque<cadmium::dynamic::engine::input_event<float>> queue;
+        f.runner.add_input_stream(std::make_shared<cadmium::dynamic::engine::input_stream<float>>([&queue]() {
+            std::optional<cadmium::dynamic::engine::input_event<float>> ret;
+            if (!queue.empty()) {
+                ret.emplace(std::move(queue.front()));
+                queue.pop_front();
+            }
+            return ret;
+        }));
+        BOOST_CHECK_EQUAL(f.runner.next(), std::numeric_limits<float>::infinity());
+        queue.push_back(cadmium::dynamic::engine::make_input_event<values_in>(2.0f, 4));
+        BOOST_CHECK_EQUAL(f.runner.step(), std::numeric_limits<float>::infinity());
+        BOOST_CHECK_EQUAL(f.sum(), 4);
+        // the source went back in time
+        queue.push_back(cadmium::dynamic::engine::make_input_event<values_in>(1.0f, 4));
+        BOOST_CHECK_THROW(f.runner.next(), std::domain_error);
+    }
+
+    BOOST_AUTO_TEST_CASE( runner_rejects_the_events_of_ports_the_top_model_does_not_have_test ) {
+        input_fixture f;
+        std::vector<cadmium::dynamic::engine::input_event<float>> recorded;
+        recorded.push_back(cadmium::dynamic::engine::make_input_event<unused_in>(1.0f, 1));
+        f.runner.add_input_stream(cadmium::dynamic::engine::make_input_stream(std::move(recorded)));
+        BOOST_CHECK_THROW(f.runner.step(), std::domain_error);
+        BOOST_CHECK_THROW(f.runner.add_input_stream(nullptr), std::domain_error);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <cadmium/logger/tuple_to_ostream.hpp>
+#include <limits>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_dynamic_coordinator.hpp>
+#include <cadmium/engine/pdevs_dynamic_lazy_coordinator.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/basic_model/int_generator_one_sec.hpp>
+#include <cadmium/basic_model/reset_generator_five_sec.hpp>
+
+/**
+ * The count fives model with the generators and the accumulator in coupled models created lazily, and an
+ * accumulator receiving no messages which stays dormant.
+ */
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_lazy_coordinator_test_suite )
+
+    template<typename TIME>
+    using test_accumulator=cadmium::basic_models::accumulator<int, TIME>;
+    using test_accumulator_defs=cadmium::basic_models::accumulator_defs<int>;
+    using reset_tick=test_accumulator_defs::reset_tick;
+
+    using empty_iports=std::tuple<>;
+    using empty_eic=std::tuple<>;
+    using empty_ic=std::tuple<>;
+
+    using generators_oports=std::tuple<cadmium::basic_models::int_generator_one_sec_defs::out, cadmium::basic_models::reset_generator_five_sec_defs::out>;
+    using generators_submodels=cadmium::modeling::models_tuple<cadmium::basic_models::reset_generator_five_sec, cadmium::basic_models::int_generator_one_sec>;
+    using generators_eoc=std::tuple<
+            cadmium::modeling::EOC<cadmium::basic_models::reset_generator_five_sec, cadmium::basic_models::reset_generator_five_sec_defs::out, cadmium::basic_models::reset_generator_five_sec_defs::out>,
+            cadmium::modeling::EOC<cadmium::basic_models::int_generator_one_sec, cadmium::basic_models::int_generator_one_sec_defs::out, cadmium::basic_models::int_generator_one_sec_defs::out>
+    >;
+
+    template<typename TIME>
+    using coupled_generators_model=cadmium::modeling::coupled_model<TIME, empty_iports, generators_oports, generators_submodels, empty_eic, generators_eoc, empty_ic>;
+
+    using accumulator_eic=std::tuple<
+            cadmium::modeling::EIC<test_accumulator_defs::add, test_accumulator, test_accumulator_defs::add>,
+            cadmium::modeling::EIC<test_accumulator_defs::reset, test_accumulator, test_accumulator_defs::reset>
+    >;
+    using accumulator_eoc=std::tuple<
+            cadmium::modeling::EOC<test_accumulator, test_accumulator_defs::sum, test_accumulator_defs::sum>
+    >;
+
+    template<typename TIME>
+    using coupled_accumulator_model=cadmium::modeling::coupled_model<TIME, typename test_accumulator<TIME>::input_ports, typename test_accumulator<TIME>::output_ports, cadmium::modeling::models_tuple<test_accumulator>, accumulator_eic, accumulator_eoc, empty_ic>;
+
+    using lazy_type=cadmium::dynamic::engine::lazy_coordinator<float, cadmium::logger::not_logger, cadmium::dynamic::engine::no_fel<float>, cadmium::dynamic::engine::sequential_execution>;
+
+    std::shared_ptr<cadmium::dynamic::modeling::coupled<float>> make_accumulator(const std::string& id) {
+        auto accumulator = cadmium::dynamic::translate::make_dynamic_coupled_model<float, coupled_accumulator_model>();
+        accumulator->_id = id;
+        accumulator->_lazy = true;
+        return accumulator;
+    }
+
+    std::shared_ptr<cadmium::dynamic::modeling::coupled<float>> make_count_fives(bool lazy) {
+        auto generators = cadmium::dynamic::translate::make_dynamic_coupled_model<float, coupled_generators_model>();
+        generators->_lazy = lazy;
+        auto accumulator = make_accumulator("accumulator");
+        accumulator->_lazy = lazy;
+        auto idle = make_accumulator("idle");
+        idle->_lazy = lazy;
+
+        cadmium::dynamic::modeling::Models submodels = {generators, accumulator, idle};
+        cadmium::dynamic::modeling::EOCs eocs = {
+                cadmium::dynamic::translate::make_EOC<test_accumulator_defs::sum, test_accumulator_defs::sum>("accumulator")
+        };
+        cadmium::dynamic::modeling::ICs ics = {
+                cadmium::dynamic::translate::make_IC<cadmium::basic_models::int_generator_one_sec_defs::out, test_accumulator_defs::add>(generators->get_id(), "accumulator"),
+                cadmium::dynamic::translate::make_IC<cadmium::basic_models::reset_generator_five_sec_defs::out, test_accumulator_defs::reset>(generators->get_id(), "accumulator")
+        };
+        return std::make_shared<cadmium::dynamic::modeling::coupled<float>>(
+                "top",
+                submodels,
+                cadmium::dynamic::translate::make_ports<empty_iports>(),
+                cadmium::dynamic::translate::make_ports<std::tuple<test_accumulator_defs::sum>>(),
+                cadmium::dynamic::modeling::EICs{},
+                eocs,
+                ics
+        );
+    }
+
+    template<typename FEL>
+    std::vector<std::pair<float, int>> run_count_fives(cadmium::dynamic::engine::coordinator<float, cadmium::logger::not_logger, FEL>& c) {
+        std::vector<std::pair<float, int>> sums;
+        c.init(0.0f);
+        while (c.next() <= 10.0f) {
+            float t = c.next();
+            c.collect_outputs(t);
+            auto it = c.outbox().find(typeid(test_accumulator_defs::sum));
+            if (it != c.outbox().end()) {
+                for (int s : cadmium::dynamic::bag_cast<const cadmium::message_bag<test_accumulator_defs::sum>&>(it->second).messages) {
+                    sums.emplace_back(t, s);
+                }
+            }
+            c.advance_simulation(t);
+        }
+        return sums;
+    }
+
+    BOOST_AUTO_TEST_CASE( lazy_coordinator_is_created_by_its_first_input ) {
+        lazy_type l(make_accumulator("accumulator"));
+        BOOST_CHECK_EQUAL(l.get_model_id(), "accumulator");
+
+        //the passive accumulator has no event, it stays dormant until it receives messages
+        l.init(0.0f);
+        BOOST_CHECK(!l.created());
+        BOOST_CHECK_EQUAL(l.next(), std::numeric_limits<float>::infinity());
+        l.advance_simulation(1.0f);
+        BOOST_CHECK(!l.created());
+
+        l.inbox().get_bag<cadmium::message_bag<test_accumulator_defs::add>>(typeid(test_accumulator_defs::add)).messages = {2, 3};
+        l.advance_simulation(1.0f);
+        BOOST_CHECK(l.created());
+        BOOST_CHECK(l.inbox().empty());
+        BOOST_CHECK_EQUAL(l.next(), std::numeric_limits<float>::infinity());
+
+        //the reset schedules the output of the sum
+        l.inbox().get_bag<cadmium::message_bag<test_accumulator_defs::reset>>(typeid(test_accumulator_defs::reset)).messages = {reset_tick{}};
+        l.advance_simulation(2.0f);
+        BOOST_CHECK_EQUAL(l.next(), 2.0f);
+
+        l.collect_outputs(2.0f);
+        BOOST_REQUIRE_EQUAL(l.outbox().size(), 1);
+        const auto& sum = cadmium::dynamic::bag_cast<const cadmium::message_bag<test_accumulator_defs::sum>&>(l.outbox().at(typeid(test_accumulator_defs::sum)));
+        BOOST_REQUIRE_EQUAL(sum.messages.size(), 1);
+        BOOST_CHECK_EQUAL(sum.messages.front(), 5);
+
+        //the outbox is cleared by the next advance
+        l.advance_simulation(2.0f);
+        BOOST_CHECK(l.outbox().empty());
+    }
+
+    BOOST_AUTO_TEST_CASE( lazy_coordinators_run_as_the_eager_ones ) {
+        cadmium::dynamic::engine::coordinator<float, cadmium::logger::not_logger> eager(make_count_fives(false));
+        cadmium::dynamic::engine::coordinator<float, cadmium::logger::not_logger> lazy(make_count_fives(true));
+        cadmium::dynamic::engine::coordinator<float, cadmium::logger::not_logger, cadmium::dynamic::engine::heap_fel<float>> lazy_heap(make_count_fives(true));
+
+        std::vector<std::pair<float, int>> expected = {{5.0f, 5}, {10.0f, 5}};
+        BOOST_CHECK((run_count_fives(eager) == expected));
+        BOOST_CHECK((run_count_fives(lazy) == expected));
+        BOOST_CHECK((run_count_fives(lazy_heap) == expected));
+
+        //the generators are created by their first event and the accumulator by its first input, the idle one
+        //is still dormant and takes less memory than its coordinator
+        auto& subengines = lazy.subengines();
+        BOOST_REQUIRE_EQUAL(subengines.size(), 3);
+        BOOST_CHECK(std::dynamic_pointer_cast<lazy_type>(subengines[0])->created());
+        BOOST_CHECK(std::dynamic_pointer_cast<lazy_type>(subengines[1])->created());
+        BOOST_CHECK(!std::dynamic_pointer_cast<lazy_type>(subengines[2])->created());
+
+        cadmium::dynamic::engine::memory_usage eager_usage, lazy_usage;
+        std::vector<cadmium::dynamic::engine::model_memory> eager_models, lazy_models;
+        subengines[2]->account_memory(lazy_usage, lazy_models, 1);
+        eager.subengines()[2]->account_memory(eager_usage, eager_models, 1);
+        BOOST_REQUIRE_EQUAL(lazy_models.size(), 1);
+        BOOST_CHECK_EQUAL(lazy_models[0].model_id, "idle");
+        BOOST_CHECK_EQUAL(lazy_usage.states, eager_usage.states);
+        BOOST_CHECK_LT(lazy_usage.engines, eager_usage.engines);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,221 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <utility>
+#include <vector>
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_message_bag_test_suite )
+
+    struct test_in_0 : public cadmium::in_port<int> {};
+    struct test_in_1 : public cadmium::in_port<double> {};
+    struct test_in_2 : public cadmium::in_port<int> {};
+
+    template<std::size_t N>
+    struct test_many_in : public cadmium::in_port<int> {};
+
+    template<std::size_t... N>
+    std::vector<cadmium::dynamic::port_key> many_ports(std::index_sequence<N...>) {
+        return {cadmium::dynamic::port_key::of<test_many_in<N>>()...};
+    }
+
+    BOOST_AUTO_TEST_CASE( message_bags_assign_a_slot_by_port_test ) {
+        cadmium::dynamic::message_bags bags({typeid(test_in_0), typeid(test_in_1)});
+        BOOST_CHECK_EQUAL(bags.slots(), 2);
+        BOOST_CHECK_EQUAL(bags.slot_of(typeid(test_in_0)), 0);
+        BOOST_CHECK_EQUAL(bags.slot_of(typeid(test_in_1)), 1);
+        BOOST_CHECK_EQUAL(bags.slot_of(typeid(test_in_2)), cadmium::dynamic::message_bags::no_slot);
+
+        // slots without bag are not seen
+        BOOST_CHECK(bags.empty());
+        BOOST_CHECK_EQUAL(bags.size(), 0);
+        BOOST_CHECK(bags.find(typeid(test_in_0)) == bags.end());
+        BOOST_CHECK_THROW(bags.at(typeid(test_in_0)), std::out_of_range);
+
+        cadmium::message_bag<test_in_1> bag_1;
+        bag_1.messages.push_back(1.5);
+        bags[typeid(test_in_1)] = bag_1;
+        BOOST_CHECK(!bags.empty());
+        BOOST_CHECK_EQUAL(bags.size(), 1);
+        BOOST_CHECK(bags.begin()->first == typeid(test_in_1));
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<test_in_1>&>(bags.slot(1)).messages.size(), 1);
+
+        // ports without slot get a new one
+        BOOST_CHECK(bags.emplace(typeid(test_in_2), cadmium::message_bag<test_in_2>()).second);
+        BOOST_CHECK(!bags.emplace(typeid(test_in_2), cadmium::message_bag<test_in_2>()).second);
+        BOOST_CHECK_EQUAL(bags.slot_of(typeid(test_in_2)), 2);
+        BOOST_CHECK_EQUAL(bags.size(), 2);
+
+        bags.clear();
+        BOOST_CHECK(bags.empty());
+        BOOST_CHECK_EQUAL(bags.slots(), 3);
+    }
+
+    BOOST_AUTO_TEST_CASE( message_bags_copies_only_the_bags_test ) {
+        cadmium::dynamic::message_bags bags({typeid(test_in_0), typeid(test_in_1), typeid(test_in_2)});
+        cadmium::message_bag<test_in_2> bag_2;
+        bag_2.messages.push_back(3);
+        bags[typeid(test_in_2)] = bag_2;
+
+        const cadmium::dynamic::message_bags copy = bags;
+        BOOST_CHECK_EQUAL(copy.slots(), 1);
+        BOOST_CHECK(copy.find(typeid(test_in_2)) != copy.cend());
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<const cadmium::message_bag<test_in_2>&>(copy.at(typeid(test_in_2))).messages.front(), 3);
+
+        int visited = 0;
+        for (const auto& b : copy) {
+            BOOST_CHECK(b.first == typeid(test_in_2));
+            visited++;
+        }
+        BOOST_CHECK_EQUAL(visited, 1);
+        BOOST_CHECK_EQUAL(bags.erase(typeid(test_in_2)), 1);
+        BOOST_CHECK(bags.empty());
+    }
+
+    BOOST_AUTO_TEST_CASE( message_bags_reuse_the_cleared_bags_test ) {
+        cadmium::dynamic::message_bags bags({typeid(test_in_0)});
+
+        auto& b = bags.get_bag<cadmium::message_bag<test_in_0>>(typeid(test_in_0));
+        b.messages.assign(10, 1);
+        const int* buffer = b.messages.data();
+        BOOST_CHECK_EQUAL(bags.size(), 1);
+
+        bags.clear();
+        BOOST_CHECK(bags.empty());
+        BOOST_CHECK(bags.find(typeid(test_in_0)) == bags.end());
+
+        // the cleared bag comes back empty with its buffer
+        auto& reused = bags.get_bag<cadmium::message_bag<test_in_0>>(typeid(test_in_0));
+        BOOST_CHECK(reused.messages.empty());
+        BOOST_CHECK(reused.messages.data() == buffer);
+
+        // the ports without a slot get one
+        bags.get_bag<cadmium::message_bag<test_in_1>>(typeid(test_in_1)).messages.push_back(1.5);
+        BOOST_CHECK_EQUAL(bags.slots(), 2);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<test_in_1>&>(bags.at(typeid(test_in_1))).messages.size(), 1);
+    }
+
+    BOOST_AUTO_TEST_CASE( message_bags_mark_the_slots_that_may_have_a_bag_test ) {
+        cadmium::dynamic::message_bags bags({typeid(test_in_0), typeid(test_in_1), typeid(test_in_2)});
+        BOOST_CHECK(!bags.may_have_bags());
+        BOOST_CHECK(!bags.may_have_bag(0));
+
+        bags.get_bag<cadmium::message_bag<test_in_1>>(typeid(test_in_1)).messages.push_back(1.5);
+        BOOST_CHECK(bags.may_have_bags());
+        BOOST_CHECK(!bags.may_have_bag(0));
+        BOOST_CHECK(bags.may_have_bag(1));
+        BOOST_CHECK(!bags.may_have_bag(2));
+
+        bags[typeid(test_in_2)] = cadmium::message_bag<test_in_2>();
+        BOOST_CHECK(bags.may_have_bag(2));
+
+        // the copy marks only the slots it gets a bag in
+        cadmium::dynamic::message_bags copy({typeid(test_in_0), typeid(test_in_1), typeid(test_in_2)});
+        copy.get_bag<cadmium::message_bag<test_in_0>>(typeid(test_in_0));
+        bags.erase(typeid(test_in_2));
+        copy = bags;
+        BOOST_CHECK(!copy.may_have_bag(0));
+        BOOST_CHECK(copy.may_have_bag(copy.slot_of(typeid(test_in_1))));
+
+        bags.clear();
+        BOOST_CHECK(!bags.may_have_bags());
+        BOOST_CHECK(bags.empty());
+
+        // the slots from 63 share the last bit
+        cadmium::dynamic::message_bags many(many_ports(std::make_index_sequence<70>()));
+        BOOST_CHECK(!many.may_have_bag(69));
+        many.slot(64);
+        BOOST_CHECK(many.may_have_bag(63));
+        BOOST_CHECK(many.may_have_bag(69));
+        BOOST_CHECK(!many.may_have_bag(62));
+    }
+
+    BOOST_AUTO_TEST_CASE( erased_bag_checks_the_bag_type_on_cast_test ) {
+        cadmium::dynamic::erased_bag b;
+        BOOST_CHECK(b.empty());
+        BOOST_CHECK(cadmium::dynamic::bag_cast<cadmium::message_bag<test_in_0>>(&b) == nullptr);
+
+        b = cadmium::message_bag<test_in_0>{1, 2};
+        BOOST_CHECK(b.holds<cadmium::message_bag<test_in_0>>());
+        // ports with the same message type have different bag types
+        BOOST_CHECK(!b.holds<cadmium::message_bag<test_in_2>>());
+        BOOST_CHECK_THROW(cadmium::dynamic::bag_cast<cadmium::message_bag<test_in_2>&>(b), cadmium::dynamic::bad_bag_cast);
+        BOOST_CHECK_EQUAL(b.messages_size(), 2);
+        BOOST_CHECK_EQUAL(b.messages_as_string(), "{1, 2}");
+
+        cadmium::dynamic::erased_bag copy(b);
+        cadmium::dynamic::bag_cast<cadmium::message_bag<test_in_0>&>(copy).messages.push_back(3);
+        BOOST_CHECK_EQUAL(b.messages_size(), 2);
+        BOOST_CHECK_EQUAL(copy.messages_size(), 3);
+
+        b.reset();
+        BOOST_CHECK(b.empty());
+        BOOST_CHECK_EQUAL(b.messages_size(), 0);
+    }
+
+    BOOST_AUTO_TEST_CASE( erased_bag_appends_and_moves_messages_of_the_same_type_test ) {
+        cadmium::dynamic::erased_bag from(cadmium::message_bag<test_in_0>{1, 2});
+        cadmium::dynamic::erased_bag to;
+
+        to.append_messages_from(from);
+        to.append_messages_from(from);
+        BOOST_CHECK_EQUAL(to.messages_as_string(), "{1, 2, 1, 2}");
+
+        // moving into an empty bag takes the buffer of the messages
+        const int* buffer = cadmium::dynamic::bag_cast<const cadmium::message_bag<test_in_0>&>(from).messages.data();
+        cadmium::dynamic::erased_bag moved;
+        from.move_messages_into(moved);
+        BOOST_CHECK_EQUAL(from.messages_size(), 0);
+        BOOST_CHECK(cadmium::dynamic::bag_cast<const cadmium::message_bag<test_in_0>&>(moved).messages.data() == buffer);
+
+        moved.move_messages_into(to);
+        BOOST_CHECK_EQUAL(to.messages_as_string(), "{1, 2, 1, 2, 1, 2}");
+
+        cadmium::dynamic::erased_bag other(cadmium::message_bag<test_in_2>{5});
+        BOOST_CHECK_THROW(to.append_messages_from(other), cadmium::dynamic::bad_bag_cast);
+    }
+
+    BOOST_AUTO_TEST_CASE( message_bags_account_the_bytes_of_their_bags_test ) {
+        cadmium::dynamic::message_bags bags({typeid(test_in_0), typeid(test_in_1)});
+        std::size_t slots_bytes = bags.allocated_bytes();
+        BOOST_CHECK(slots_bytes > 0);
+
+        auto& bag_0 = bags.get_bag<cadmium::message_bag<test_in_0>>(typeid(test_in_0));
+        bag_0.messages.reserve(100);
+        BOOST_CHECK_EQUAL(bags.slot(0).allocated_bytes(), 100 * sizeof(int));
+        BOOST_CHECK_EQUAL(bags.allocated_bytes(), slots_bytes + 100 * sizeof(int));
+
+        // the cleared bags kept for reuse are still allocated
+        bags.clear();
+        BOOST_CHECK_EQUAL(bags.allocated_bytes(), slots_bytes + 100 * sizeof(int));
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
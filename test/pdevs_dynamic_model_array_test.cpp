@@ -0,0 +1,320 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <cadmium/logger/tuple_to_ostream.hpp>
+#include <algorithm>
+#include <limits>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_array.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_dynamic_coordinator.hpp>
+#include <cadmium/engine/pdevs_dynamic_execution.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/basic_model/int_generator_one_sec.hpp>
+#include <cadmium/basic_model/reset_generator_five_sec.hpp>
+
+/**
+ * The count fives model with arrays of generators and accumulators, each accumulator instance counts the
+ * messages of the generator instances of the same index.
+ */
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_model_array_test_suite )
+
+    template<typename TIME>
+    using test_accumulator=cadmium::basic_models::accumulator<int, TIME>;
+    using test_accumulator_defs=cadmium::basic_models::accumulator_defs<int>;
+    using reset_tick=test_accumulator_defs::reset_tick;
+
+    template<typename PORT>
+    using instance_port=cadmium::dynamic::modeling::instance_port<PORT>;
+    using add_message=cadmium::dynamic::modeling::instance_message<int>;
+    using reset_message=cadmium::dynamic::modeling::instance_message<reset_tick>;
+    using sum_bag=cadmium::message_bag<instance_port<test_accumulator_defs::sum>>;
+
+    using accumulators_array=cadmium::dynamic::modeling::model_array<test_accumulator, float>;
+
+    /**
+     * A mover advances its position by its velocity every second, the pushes add to its velocity.
+     */
+    struct mover_defs {
+        struct push : public cadmium::in_port<float> {};
+        struct position : public cadmium::out_port<float> {};
+    };
+
+    template<typename TIME>
+    struct mover {
+        struct state_type {
+            float position;
+            float velocity;
+        };
+        state_type state{0.0f, 1.0f};
+
+        using input_ports=std::tuple<mover_defs::push>;
+        using output_ports=std::tuple<mover_defs::position>;
+
+        void internal_transition() {
+            state.position += state.velocity;
+        }
+
+        void external_transition(TIME e, typename cadmium::make_message_bags<input_ports>::type mbs) {
+            state.position += state.velocity * e;
+            for (float v : cadmium::get_messages<mover_defs::push>(mbs)) {
+                state.velocity += v;
+            }
+        }
+
+        void confluence_transition(TIME e, typename cadmium::make_message_bags<input_ports>::type mbs) {
+            internal_transition();
+            external_transition(TIME{}, std::move(mbs));
+        }
+
+        typename cadmium::make_message_bags<output_ports>::type output() const {
+            typename cadmium::make_message_bags<output_ports>::type outmb;
+            cadmium::get_messages<mover_defs::position>(outmb).push_back(state.position + state.velocity);
+            return outmb;
+        }
+
+        TIME time_advance() const {
+            return 1;
+        }
+    };
+
+    std::ostream& operator<<(std::ostream& os, const mover<float>::state_type& s) {
+        return os << s.position << " " << s.velocity;
+    }
+
+    // the same mover with batch transitions, counting the instances given to them
+    template<typename TIME>
+    struct batch_mover : public mover<TIME> {
+        static std::size_t internal_batched;
+        static std::size_t runs;
+
+        static void internal_transition_batch(batch_mover* instances, std::size_t count) {
+            for (std::size_t i = 0; i < count; i++) {
+                instances[i].state.position += instances[i].state.velocity;
+            }
+            internal_batched += count;
+            runs++;
+        }
+
+        static void time_advance_batch(const batch_mover*, std::size_t count, TIME* advances) {
+            std::fill(advances, advances + count, TIME{1});
+        }
+    };
+
+    template<typename TIME>
+    std::size_t batch_mover<TIME>::internal_batched = 0;
+
+    template<typename TIME>
+    std::size_t batch_mover<TIME>::runs = 0;
+
+    // the batch mover run by a chunked backend, counting the chunks
+    template<typename TIME>
+    struct chunked_mover : public mover<TIME> {
+        static std::size_t internal_batched;
+        static std::size_t chunks;
+        static std::size_t advance_chunks;
+
+        static void internal_transition_batch(chunked_mover* instances, std::size_t count) {
+            for (std::size_t i = 0; i < count; i++) {
+                instances[i].state.position += instances[i].state.velocity;
+            }
+            internal_batched += count;
+            chunks++;
+        }
+
+        static void time_advance_batch(const chunked_mover*, std::size_t count, TIME* advances) {
+            std::fill(advances, advances + count, TIME{1});
+            advance_chunks++;
+        }
+    };
+
+    template<typename TIME>
+    std::size_t chunked_mover<TIME>::internal_batched = 0;
+
+    template<typename TIME>
+    std::size_t chunked_mover<TIME>::chunks = 0;
+
+    template<typename TIME>
+    std::size_t chunked_mover<TIME>::advance_chunks = 0;
+
+    template<template<typename T> class MOVER>
+    std::vector<std::pair<float, float>> run_movers(std::size_t size) {
+        using push_bag=cadmium::message_bag<instance_port<mover_defs::push>>;
+        cadmium::dynamic::modeling::model_array<MOVER, float> movers("movers", size);
+        auto engine = movers.make_engine();
+        engine->init(0.0f);
+        while (engine->next() <= 6.0f) {
+            float t = engine->next();
+            engine->collect_outputs(t);
+            if (t == 3.0f) {
+                engine->inbox().template get_bag<push_bag>(typeid(instance_port<mover_defs::push>)).messages = {
+                        cadmium::dynamic::modeling::instance_message<float>{5, 2.0f},
+                        cadmium::dynamic::modeling::instance_message<float>{20, -1.0f}
+                };
+            }
+            engine->advance_simulation(t);
+        }
+
+        std::vector<std::pair<float, float>> ret;
+        for (const auto& m : movers.instances()) {
+            ret.emplace_back(m.state.position, m.state.velocity);
+        }
+        return ret;
+    }
+
+    BOOST_AUTO_TEST_CASE( model_array_gives_the_messages_to_their_instances ) {
+        accumulators_array accumulators("accumulators", 4);
+        auto engine = accumulators.make_engine();
+        BOOST_CHECK_EQUAL(engine->get_model_id(), "accumulators");
+
+        engine->init(0.0f);
+        BOOST_CHECK_EQUAL(engine->next(), std::numeric_limits<float>::infinity());
+
+        //the added values are accumulated by their instances
+        engine->inbox().get_bag<cadmium::message_bag<instance_port<test_accumulator_defs::add>>>(typeid(instance_port<test_accumulator_defs::add>)).messages = {
+                add_message{0, 2}, add_message{3, 5}, add_message{0, 3}
+        };
+        engine->advance_simulation(1.0f);
+        BOOST_CHECK(engine->inbox().empty());
+        BOOST_CHECK_EQUAL(std::get<int>(accumulators.instances()[0].state), 5);
+        BOOST_CHECK_EQUAL(std::get<int>(accumulators.instances()[1].state), 0);
+        BOOST_CHECK_EQUAL(std::get<int>(accumulators.instances()[3].state), 5);
+        BOOST_CHECK_EQUAL(engine->next(), std::numeric_limits<float>::infinity());
+
+        //the resets schedule the output of the sums of their instances
+        engine->inbox().get_bag<cadmium::message_bag<instance_port<test_accumulator_defs::reset>>>(typeid(instance_port<test_accumulator_defs::reset>)).messages = {
+                reset_message{1, reset_tick{}}, reset_message{3, reset_tick{}}
+        };
+        engine->advance_simulation(2.0f);
+        BOOST_CHECK_EQUAL(engine->next(), 2.0f);
+
+        engine->collect_outputs(2.0f);
+        BOOST_REQUIRE_EQUAL(engine->outbox().size(), 1);
+        auto sums = cadmium::dynamic::bag_cast<const sum_bag&>(engine->outbox().at(typeid(instance_port<test_accumulator_defs::sum>))).messages;
+        std::sort(sums.begin(), sums.end(), [](const auto& a, const auto& b) { return a.instance < b.instance; });
+        BOOST_CHECK((sums == std::vector<cadmium::dynamic::modeling::instance_message<int>>{{1, 0}, {3, 5}}));
+
+        //the imminent instances receiving messages take the confluence transition
+        engine->inbox().get_bag<cadmium::message_bag<instance_port<test_accumulator_defs::add>>>(typeid(instance_port<test_accumulator_defs::add>)).messages = {
+                add_message{3, 1}
+        };
+        engine->advance_simulation(2.0f);
+        BOOST_CHECK(engine->outbox().empty());
+        BOOST_CHECK_EQUAL(std::get<int>(accumulators.instances()[3].state), 1);
+        BOOST_CHECK_EQUAL(engine->next(), std::numeric_limits<float>::infinity());
+
+        //the messages to instances out of the array are rejected
+        engine->inbox().get_bag<cadmium::message_bag<instance_port<test_accumulator_defs::add>>>(typeid(instance_port<test_accumulator_defs::add>)).messages = {
+                add_message{4, 1}
+        };
+        BOOST_CHECK_THROW(engine->advance_simulation(3.0f), std::domain_error);
+    }
+
+    BOOST_AUTO_TEST_CASE( model_arrays_in_dynamic_coupled_model ) {
+        constexpr std::size_t size = 1000;
+        auto generators = std::make_shared<cadmium::dynamic::modeling::model_array<cadmium::basic_models::int_generator_one_sec, float>>("generators", size);
+        auto resets = std::make_shared<cadmium::dynamic::modeling::model_array<cadmium::basic_models::reset_generator_five_sec, float>>("resets", size);
+        auto accumulators = std::make_shared<accumulators_array>("accumulators", size);
+
+        cadmium::dynamic::modeling::Models submodels = {generators, resets, accumulators};
+        cadmium::dynamic::modeling::EOCs eocs = {
+                cadmium::dynamic::translate::make_EOC<instance_port<test_accumulator_defs::sum>, instance_port<test_accumulator_defs::sum>>("accumulators")
+        };
+        cadmium::dynamic::modeling::ICs ics = {
+                cadmium::dynamic::translate::make_IC<instance_port<cadmium::basic_models::int_generator_one_sec_defs::out>, instance_port<test_accumulator_defs::add>>("generators", "accumulators"),
+                cadmium::dynamic::translate::make_IC<instance_port<cadmium::basic_models::reset_generator_five_sec_defs::out>, instance_port<test_accumulator_defs::reset>>("resets", "accumulators")
+        };
+        auto top = std::make_shared<cadmium::dynamic::modeling::coupled<float>>(
+                "top",
+                submodels,
+                cadmium::dynamic::modeling::Ports{},
+                cadmium::dynamic::translate::make_ports<std::tuple<instance_port<test_accumulator_defs::sum>>>(),
+                cadmium::dynamic::modeling::EICs{},
+                eocs,
+                ics
+        );
+
+        cadmium::dynamic::engine::coordinator<float, cadmium::logger::not_logger> c(top);
+        c.init(0.0f);
+
+        //every five seconds, each accumulator counted the five values of its generator
+        std::vector<float> output_times;
+        std::vector<std::size_t> counts(size, 0);
+        while (c.next() <= 10.0f) {
+            float t = c.next();
+            c.collect_outputs(t);
+            auto it = c.outbox().find(typeid(instance_port<test_accumulator_defs::sum>));
+            if (it != c.outbox().end()) {
+                output_times.push_back(t);
+                for (const auto& s : cadmium::dynamic::bag_cast<const sum_bag&>(it->second).messages) {
+                    BOOST_CHECK_EQUAL(s.value, 5);
+                    counts[s.instance]++;
+                }
+            }
+            c.advance_simulation(t);
+        }
+        BOOST_CHECK((output_times == std::vector<float>{5.0f, 10.0f}));
+        BOOST_CHECK(std::all_of(counts.begin(), counts.end(), [](std::size_t n) { return n == 2; }));
+    }
+
+    BOOST_AUTO_TEST_CASE( model_array_runs_the_batch_transitions_of_contiguous_instances ) {
+        auto single = run_movers<mover>(64);
+        auto batched = run_movers<batch_mover>(64);
+        BOOST_CHECK((single == batched));
+        BOOST_CHECK_EQUAL(single[5].first, 6.0f + 2 * 3.0f);
+        BOOST_CHECK_EQUAL(single[20].first, 3.0f);
+
+        //every instance took 6 internal transitions but the two receiving pushes at 3, which took a confluence
+        BOOST_CHECK_EQUAL(batch_mover<float>::internal_batched, 64 * 6 - 2);
+        //the instances are given in one run, but at 3 when the pushed ones split them in three runs
+        BOOST_CHECK_EQUAL(batch_mover<float>::runs, 5 + 3);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+
+template<>
+struct cadmium::dynamic::engine::model_array_backend<pdevs_dynamic_model_array_test_suite::chunked_mover<float>> {
+    using type = cadmium::dynamic::engine::chunked_batch_backend<cadmium::dynamic::engine::sequential_execution, 16>;
+};
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_model_array_test_suite )
+
+    BOOST_AUTO_TEST_CASE( model_array_runs_the_batch_transitions_in_chunks_by_its_backend ) {
+        auto single = run_movers<mover>(64);
+        auto chunked = run_movers<chunked_mover>(64);
+        BOOST_CHECK((single == chunked));
+        BOOST_CHECK_EQUAL(chunked_mover<float>::internal_batched, 64 * 6 - 2);
+
+        //the runs of 64 instances take 4 chunks, at 3 the runs of 5, 14 and 43 instances take 1, 1 and 3 chunks
+        BOOST_CHECK_EQUAL(chunked_mover<float>::chunks, 5 * 4 + 5);
+        //the time advances also take 4 chunks at the init
+        BOOST_CHECK_EQUAL(chunked_mover<float>::advance_chunks, 4 + 5 * 4 + 5);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
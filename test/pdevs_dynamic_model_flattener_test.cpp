@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/basic_model/int_generator_one_sec.hpp>
+#include <cadmium/basic_model/reset_generator_five_sec.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/dynamic_model_flattener.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+
+#include "count_fives_model.hpp"
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_model_flattener_test_suite )
+
+    using namespace count_fives;
+
+    // a top model receiving inputs that cross two levels before reaching the accumulator
+    struct top_add : public cadmium::in_port<int> {};
+    struct top_sum : public cadmium::out_port<int> {};
+
+    using wrapper_eic=std::tuple<
+            cadmium::modeling::EIC<test_accumulator_defs::add, coupled_accumulator_model, test_accumulator_defs::add>
+    >;
+    using wrapper_eoc=std::tuple<
+            cadmium::modeling::EOC<coupled_accumulator_model, test_accumulator_defs::sum, test_accumulator_defs::sum>
+    >;
+    template<typename TIME>
+    using wrapper_model=cadmium::modeling::coupled_model<TIME, std::tuple<test_accumulator_defs::add>, std::tuple<test_accumulator_defs::sum>, cadmium::modeling::models_tuple<coupled_accumulator_model>, wrapper_eic, wrapper_eoc, empty_ic>;
+
+    using deep_eic=std::tuple<
+            cadmium::modeling::EIC<top_add, wrapper_model, test_accumulator_defs::add>
+    >;
+    using deep_eoc=std::tuple<
+            cadmium::modeling::EOC<wrapper_model, test_accumulator_defs::sum, top_sum>
+    >;
+    template<typename TIME>
+    using deep_model=cadmium::modeling::coupled_model<TIME, std::tuple<top_add>, std::tuple<top_sum>, cadmium::modeling::models_tuple<wrapper_model>, deep_eic, deep_eoc, empty_ic>;
+
+    namespace {
+        std::ostringstream oss;
+
+        struct oss_test_sink_provider{
+            static std::ostream& sink(){
+                return oss;
+            }
+        };
+    }
+
+    BOOST_AUTO_TEST_CASE( flattened_model_has_only_atomic_models_and_direct_couplings_test ) {
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        auto flat = cadmium::dynamic::modeling::flatten<float>(model);
+
+        BOOST_CHECK_EQUAL(flat->get_id(), model->get_id());
+        BOOST_CHECK(flat->get_output_ports() == model->get_output_ports());
+        BOOST_CHECK_EQUAL(flat->_models.size(), 3);
+        for (const auto& m : flat->_models) {
+            BOOST_CHECK(std::dynamic_pointer_cast<cadmium::dynamic::modeling::atomic_abstract<float>>(m) != nullptr);
+        }
+        BOOST_CHECK_EQUAL(flat->_ic.size(), 2);
+        BOOST_CHECK_EQUAL(flat->_eic.size(), 0);
+        BOOST_REQUIRE_EQUAL(flat->_eoc.size(), 1);
+
+        std::string accumulator_id = boost::typeindex::type_id<test_accumulator<float>>().pretty_name();
+        BOOST_CHECK_EQUAL(flat->_eoc[0]._from, accumulator_id);
+        BOOST_CHECK(flat->_eoc[0]._link->from_port_type_index() == typeid(test_accumulator_defs::sum));
+        for (const auto& ic : flat->_ic) {
+            BOOST_CHECK_EQUAL(ic._to, accumulator_id);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( flattened_links_route_messages_across_levels_test ) {
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, deep_model>();
+        auto flat = cadmium::dynamic::modeling::flatten<float>(model);
+
+        BOOST_REQUIRE_EQUAL(flat->_eic.size(), 1);
+        BOOST_CHECK(flat->_eic[0]._link->from_port_type_index() == typeid(top_add));
+        BOOST_CHECK(flat->_eic[0]._link->to_port_type_index() == typeid(test_accumulator_defs::add));
+
+        cadmium::message_bag<top_add> input;
+        input.messages = {1, 2};
+        cadmium::dynamic::message_bags from_bags;
+        from_bags[typeid(top_add)] = input;
+        cadmium::dynamic::message_bags to_bags;
+        auto routed = flat->_eic[0]._link->route_messages(from_bags, to_bags);
+
+        auto output = cadmium::dynamic::bag_cast<cadmium::message_bag<test_accumulator_defs::add>>(to_bags.at(typeid(test_accumulator_defs::add)));
+        BOOST_CHECK((output.messages == std::vector<int>{1, 2}));
+        BOOST_CHECK_EQUAL(routed.from_port, boost::typeindex::type_id<top_add>().pretty_name());
+        BOOST_CHECK_EQUAL(routed.to_port, boost::typeindex::type_id<test_accumulator_defs::add>().pretty_name());
+
+        BOOST_REQUIRE_EQUAL(flat->_eoc.size(), 1);
+        BOOST_CHECK(flat->_eoc[0]._link->from_port_type_index() == typeid(test_accumulator_defs::sum));
+        BOOST_CHECK(flat->_eoc[0]._link->to_port_type_index() == typeid(top_sum));
+    }
+
+    BOOST_AUTO_TEST_CASE( composing_links_not_sharing_port_throws_test ) {
+        auto first = cadmium::dynamic::translate::make_link<test_accumulator_defs::sum, top_sum>();
+        auto second = cadmium::dynamic::translate::make_link<top_add, test_accumulator_defs::add>();
+        BOOST_CHECK_THROW(first->compose(second), std::domain_error);
+    }
+
+    BOOST_AUTO_TEST_CASE( flattened_runner_produces_the_same_outputs_than_hierarchical_runner_test ) {
+        using log_messages=cadmium::logger::logger<cadmium::logger::logger_messages, cadmium::dynamic::logger::formatter<float>, oss_test_sink_provider>;
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_messages> r_hierarchical(model, 0.0);
+        float hierarchical_next = r_hierarchical.run_until(21.0);
+        std::string hierarchical_outputs = oss.str();
+
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_messages> r_flat(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), 0.0, true);
+        float flat_next = r_flat.run_until(21.0);
+        std::string flat_outputs = oss.str();
+
+        BOOST_CHECK_EQUAL(hierarchical_next, flat_next);
+        BOOST_CHECK(!flat_outputs.empty());
+        BOOST_CHECK_EQUAL(hierarchical_outputs, flat_outputs);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -61,8 +61,8 @@ BOOST_AUTO_TEST_SUITE( test_links )
 
         BOOST_CHECK_EQUAL(bag_out.messages.size(), 1);
         BOOST_CHECK_EQUAL(bag_out.messages.front(), 3);
-        BOOST_CHECK_EQUAL(boost::any_cast<cadmium::message_bag<test_out>>(bag_from.at(link_test->from_port_type_index())).messages.size(), 1);
-        BOOST_CHECK_EQUAL(boost::any_cast<cadmium::message_bag<test_out>>(bag_from.at(link_test->from_port_type_index())).messages.front(), 3);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<test_out>>(bag_from.at(link_test->from_port_type_index())).messages.size(), 1);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<test_out>>(bag_from.at(link_test->from_port_type_index())).messages.front(), 3);
 
         cadmium::dynamic::message_bags bag_to;
         link_test->route_messages(bag_from, bag_to);
@@ -70,12 +70,12 @@ BOOST_AUTO_TEST_SUITE( test_links )
         // bag_from was not modified
         BOOST_CHECK_EQUAL(bag_out.messages.size(), 1);
         BOOST_CHECK_EQUAL(bag_out.messages.front(), 3);
-        BOOST_CHECK_EQUAL(boost::any_cast<cadmium::message_bag<test_out>>(bag_from.at(link_test->from_port_type_index())).messages.size(), 1);
-        BOOST_CHECK_EQUAL(boost::any_cast<cadmium::message_bag<test_out>>(bag_from.at(link_test->from_port_type_index())).messages.front(), 3);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<test_out>>(bag_from.at(link_test->from_port_type_index())).messages.size(), 1);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<test_out>>(bag_from.at(link_test->from_port_type_index())).messages.front(), 3);
 
         // bag_to has the new message
-        BOOST_CHECK_EQUAL(boost::any_cast<cadmium::message_bag<test_in>>(bag_to.at(link_test->to_port_type_index())).messages.size(), 1);
-        BOOST_CHECK_EQUAL(boost::any_cast<cadmium::message_bag<test_in>>(bag_to.at(link_test->to_port_type_index())).messages.front(), 3);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<test_in>>(bag_to.at(link_test->to_port_type_index())).messages.size(), 1);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<test_in>>(bag_to.at(link_test->to_port_type_index())).messages.front(), 3);
 
         // testing the pass_messages for defined bags
         link_test->route_messages(bag_from, bag_to);
@@ -83,13 +83,101 @@ BOOST_AUTO_TEST_SUITE( test_links )
         // bag_from was not modified
         BOOST_CHECK_EQUAL(bag_out.messages.size(), 1);
         BOOST_CHECK_EQUAL(bag_out.messages.front(), 3);
-        BOOST_CHECK_EQUAL(boost::any_cast<cadmium::message_bag<test_out>>(bag_from.at(link_test->from_port_type_index())).messages.size(), 1);
-        BOOST_CHECK_EQUAL(boost::any_cast<cadmium::message_bag<test_out>>(bag_from.at(link_test->from_port_type_index())).messages.front(), 3);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<test_out>>(bag_from.at(link_test->from_port_type_index())).messages.size(), 1);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<test_out>>(bag_from.at(link_test->from_port_type_index())).messages.front(), 3);
 
         // to_bag has one more new message
-        BOOST_CHECK_EQUAL(boost::any_cast<cadmium::message_bag<test_in>>(bag_to.at(link_test->to_port_type_index())).messages.size(), 2);
-        BOOST_CHECK_EQUAL(boost::any_cast<cadmium::message_bag<test_in>>(bag_to.at(link_test->to_port_type_index())).messages[0], 3);
-        BOOST_CHECK_EQUAL(boost::any_cast<cadmium::message_bag<test_in>>(bag_to.at(link_test->to_port_type_index())).messages[1], 3);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<test_in>>(bag_to.at(link_test->to_port_type_index())).messages.size(), 2);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<test_in>>(bag_to.at(link_test->to_port_type_index())).messages[0], 3);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<test_in>>(bag_to.at(link_test->to_port_type_index())).messages[1], 3);
+    }
+
+    BOOST_AUTO_TEST_CASE( test_moving_messages_between_bags_leaves_the_from_bag_empty ) {
+        struct test_out: public cadmium::out_port<int>{};
+        struct test_in: public cadmium::in_port<int>{};
+
+        std::shared_ptr<cadmium::dynamic::engine::link_abstract> link_test = cadmium::dynamic::translate::make_link<test_out, test_in>();
+
+        cadmium::message_bag<test_out> bag_out;
+        bag_out.messages = {3, 4};
+        cadmium::dynamic::message_bags bag_from;
+        bag_from[link_test->from_port_type_index()] = bag_out;
+        const int* buffer = cadmium::dynamic::bag_cast<cadmium::message_bag<test_out>&>(bag_from.at(link_test->from_port_type_index())).messages.data();
+
+        cadmium::dynamic::message_bags bag_to;
+        auto routed = link_test->move_messages(bag_from, bag_to);
+        BOOST_CHECK_EQUAL(routed.from_messages.size(), 2);
+        BOOST_CHECK(cadmium::dynamic::bag_cast<cadmium::message_bag<test_out>&>(bag_from.at(link_test->from_port_type_index())).messages.empty());
+
+        // the destination bag took the messages buffer, nothing was copied
+        auto& received = cadmium::dynamic::bag_cast<cadmium::message_bag<test_in>&>(bag_to.at(link_test->to_port_type_index())).messages;
+        BOOST_CHECK((received == std::vector<int>{3, 4}));
+        BOOST_CHECK(received.data() == buffer);
+
+        // moving to a bag with messages appends them
+        cadmium::dynamic::bag_cast<cadmium::message_bag<test_out>&>(bag_from.at(link_test->from_port_type_index())).messages.push_back(5);
+        link_test->move_messages(bag_from, bag_to);
+        BOOST_CHECK((cadmium::dynamic::bag_cast<cadmium::message_bag<test_in>&>(bag_to.at(link_test->to_port_type_index())).messages == std::vector<int>{3, 4, 5}));
+
+        // moving from a bag without the port does nothing
+        cadmium::dynamic::message_bags empty_from;
+        link_test->move_messages(empty_from, bag_to);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<test_in>&>(bag_to.at(link_test->to_port_type_index())).messages.size(), 3);
+    }
+
+    BOOST_AUTO_TEST_CASE( test_routing_messages_without_logging_formats_nothing ) {
+        struct test_out: public cadmium::out_port<int>{};
+        struct test_in: public cadmium::in_port<int>{};
+
+        std::shared_ptr<cadmium::dynamic::engine::link_abstract> link_test = cadmium::dynamic::translate::make_link<test_out, test_in>();
+
+        cadmium::dynamic::message_bags bag_from;
+        bag_from.get_bag<cadmium::message_bag<test_out>>(typeid(test_out)).messages = {3, 4};
+        cadmium::dynamic::message_bags bag_to;
+
+        auto routed = link_test->route_messages(bag_from, bag_to, false);
+        BOOST_CHECK(routed.from_port.empty());
+        BOOST_CHECK(routed.to_port.empty());
+        BOOST_CHECK(routed.from_messages.empty());
+        BOOST_CHECK(routed.to_messages.empty());
+        BOOST_CHECK((cadmium::dynamic::bag_cast<const cadmium::message_bag<test_in>&>(bag_to.at(typeid(test_in))).messages == std::vector<int>{3, 4}));
+
+        routed = link_test->move_messages(bag_from, bag_to, false);
+        BOOST_CHECK(routed.to_messages.empty());
+        BOOST_CHECK((cadmium::dynamic::bag_cast<const cadmium::message_bag<test_in>&>(bag_to.at(typeid(test_in))).messages == std::vector<int>{3, 4, 3, 4}));
+
+        // logging the routing formats the ports and messages
+        routed = link_test->route_messages(bag_from, bag_to);
+        BOOST_CHECK(!routed.to_port.empty());
+        BOOST_CHECK_EQUAL(routed.to_messages.size(), 4);
+    }
+
+    BOOST_AUTO_TEST_CASE( test_routing_messages_in_slots ) {
+        struct test_out: public cadmium::out_port<int>{};
+        struct test_other_out: public cadmium::out_port<int>{};
+        struct test_in: public cadmium::in_port<int>{};
+
+        std::shared_ptr<cadmium::dynamic::engine::link_abstract> link_test = cadmium::dynamic::translate::make_link<test_out, test_in>();
+
+        cadmium::dynamic::message_bags bag_from({typeid(test_other_out), typeid(test_out)});
+        cadmium::dynamic::message_bags bag_to({typeid(test_in)});
+        std::size_t from_slot = bag_from.ensure_slot(link_test->from_port_type_index());
+        std::size_t to_slot = bag_to.ensure_slot(link_test->to_port_type_index());
+        BOOST_CHECK_EQUAL(from_slot, 1);
+        BOOST_CHECK_EQUAL(to_slot, 0);
+
+        // nothing to route
+        auto routed = link_test->route_messages_in_slots(bag_from, from_slot, bag_to, to_slot);
+        BOOST_CHECK(routed.from_messages.empty());
+        BOOST_CHECK(bag_to.empty());
+
+        cadmium::message_bag<test_out> bag_out;
+        bag_out.messages = {1, 2};
+        bag_from[typeid(test_out)] = bag_out;
+        link_test->route_messages_in_slots(bag_from, from_slot, bag_to, to_slot);
+        link_test->move_messages_in_slots(bag_from, from_slot, bag_to, to_slot);
+        BOOST_CHECK((cadmium::dynamic::bag_cast<cadmium::message_bag<test_in>&>(bag_to.slot(to_slot)).messages == std::vector<int>{1, 2, 1, 2}));
+        BOOST_CHECK(cadmium::dynamic::bag_cast<cadmium::message_bag<test_out>&>(bag_from.slot(from_slot)).messages.empty());
     }
 
     BOOST_AUTO_TEST_CASE( make_ports_from_cadmium_tuple_port_type ) {
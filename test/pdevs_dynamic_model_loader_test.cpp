@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/basic_model/int_generator_one_sec.hpp>
+#include <cadmium/basic_model/reset_generator_five_sec.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/dynamic_model_loader.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+
+#include "count_fives_model.hpp"
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_model_loader_test_suite )
+
+    using namespace count_fives;
+
+    cadmium::dynamic::modeling::model_registry<float> count_fives_registry() {
+        cadmium::dynamic::modeling::model_registry<float> registry;
+        registry.register_atomic<test_accumulator>("accumulator");
+        registry.register_atomic<cadmium::basic_models::int_generator_one_sec>("int_generator");
+        registry.register_atomic<cadmium::basic_models::reset_generator_five_sec>("reset_generator");
+        registry.register_port<int_generator_out>("int_generator_out");
+        registry.register_port<reset_generator_out>("reset_generator_out");
+        registry.register_port<test_accumulator_defs::add>("add");
+        registry.register_port<test_accumulator_defs::reset>("reset");
+        registry.register_port<test_accumulator_defs::sum>("sum");
+        registry.register_link<int_generator_out, int_generator_out>();
+        registry.register_link<reset_generator_out, reset_generator_out>();
+        registry.register_link<int_generator_out, test_accumulator_defs::add>();
+        registry.register_link<reset_generator_out, test_accumulator_defs::reset>();
+        registry.register_link<test_accumulator_defs::add, test_accumulator_defs::add>();
+        registry.register_link<test_accumulator_defs::reset, test_accumulator_defs::reset>();
+        registry.register_link<test_accumulator_defs::sum, test_accumulator_defs::sum>();
+        return registry;
+    }
+
+    namespace {
+        std::ostringstream oss;
+
+        struct oss_test_sink_provider{
+            static std::ostream& sink(){
+                return oss;
+            }
+        };
+    }
+
+    using log_messages=cadmium::logger::logger<cadmium::logger::logger_messages, cadmium::dynamic::logger::formatter<float>, oss_test_sink_provider>;
+
+    std::string run_outputs(std::shared_ptr<cadmium::dynamic::modeling::coupled<float>> model) {
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, log_messages> r(model, 0.0);
+        r.run_until(21.0);
+        return oss.str();
+    }
+
+    BOOST_AUTO_TEST_CASE( loaded_structure_runs_as_the_model_it_was_written_from_test ) {
+        auto registry = count_fives_registry();
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        std::string structure;
+        cadmium::dynamic::modeling::write_model_structure<float>(*model, registry, structure);
+
+        auto loaded = cadmium::dynamic::modeling::load_model_structure<float>(structure.data(), structure.size(), registry);
+        BOOST_CHECK_EQUAL(loaded->get_id(), model->get_id());
+        BOOST_CHECK_EQUAL(loaded->_models.size(), 2);
+        BOOST_CHECK_EQUAL(loaded->_ic.size(), 2);
+        BOOST_CHECK_EQUAL(loaded->_eoc.size(), 1);
+
+        std::string expected = run_outputs(model);
+        BOOST_CHECK(!expected.empty());
+        BOOST_CHECK_EQUAL(run_outputs(loaded), expected);
+
+        // writing the loaded model gives the same structure
+        std::string rewritten;
+        cadmium::dynamic::modeling::write_model_structure<float>(*loaded, registry, rewritten);
+        BOOST_CHECK(rewritten == structure);
+    }
+
+    BOOST_AUTO_TEST_CASE( structure_file_is_loaded_in_place_test ) {
+        auto registry = count_fives_registry();
+        std::string structure;
+        cadmium::dynamic::modeling::write_model_structure<float>(*cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), registry, structure);
+
+        std::string path = "pdevs_dynamic_model_loader_test.cdms";
+        std::ofstream(path, std::ios::binary) << structure;
+        auto loaded = cadmium::dynamic::modeling::load_model_structure_file<float>(path, registry, false);
+        std::remove(path.c_str());
+
+        BOOST_CHECK_EQUAL(run_outputs(loaded), run_outputs(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>()));
+        BOOST_CHECK_THROW(cadmium::dynamic::modeling::load_model_structure_file<float>(path, registry), std::runtime_error);
+    }
+
+    BOOST_AUTO_TEST_CASE( invalid_structures_are_not_loaded_test ) {
+        auto registry = count_fives_registry();
+        std::string structure;
+        cadmium::dynamic::modeling::write_model_structure<float>(*cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), registry, structure);
+
+        BOOST_CHECK_THROW(cadmium::dynamic::modeling::load_model_structure<float>(structure.data(), structure.size() - 4, registry), std::domain_error);
+        std::string bad_magic = structure;
+        bad_magic[0] = 'X';
+        BOOST_CHECK_THROW(cadmium::dynamic::modeling::load_model_structure<float>(bad_magic.data(), bad_magic.size(), registry), std::domain_error);
+
+        // the atomic types and the links must be registered
+        cadmium::dynamic::modeling::model_registry<float> empty_registry;
+        BOOST_CHECK_THROW(cadmium::dynamic::modeling::load_model_structure<float>(structure.data(), structure.size(), empty_registry), std::domain_error);
+        cadmium::dynamic::modeling::model_registry<float> no_links_registry;
+        no_links_registry.register_atomic<test_accumulator>("accumulator");
+        no_links_registry.register_atomic<cadmium::basic_models::int_generator_one_sec>("int_generator");
+        no_links_registry.register_atomic<cadmium::basic_models::reset_generator_five_sec>("reset_generator");
+        no_links_registry.register_port<int_generator_out>("int_generator_out");
+        no_links_registry.register_port<reset_generator_out>("reset_generator_out");
+        no_links_registry.register_port<test_accumulator_defs::add>("add");
+        no_links_registry.register_port<test_accumulator_defs::reset>("reset");
+        no_links_registry.register_port<test_accumulator_defs::sum>("sum");
+        BOOST_CHECK_THROW(cadmium::dynamic::modeling::load_model_structure<float>(structure.data(), structure.size(), no_links_registry), std::domain_error);
+        BOOST_CHECK_THROW(cadmium::dynamic::modeling::write_model_structure<float>(*cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), empty_registry, structure), std::domain_error);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
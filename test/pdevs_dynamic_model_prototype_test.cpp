@@ -0,0 +1,140 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/modeling/dynamic_atomic.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/dynamic_model_prototype.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_model_prototype_test_suite )
+
+    struct sweep_out : public cadmium::out_port<int>{};
+
+    // sends a 1 every period, the parameter of the sweep
+    template<typename TIME>
+    struct sweep_ticker {
+        using input_ports=std::tuple<>;
+        using output_ports=std::tuple<sweep_out>;
+        using state_type=std::tuple<float>;
+        state_type state = std::make_tuple(1.0f);
+
+        sweep_ticker() = default;
+
+        explicit sweep_ticker(float period) : state(std::make_tuple(period)) {}
+
+        void internal_transition() {}
+
+        void external_transition(TIME, typename cadmium::make_message_bags<input_ports>::type) {}
+
+        void confluence_transition(TIME, typename cadmium::make_message_bags<input_ports>::type) {}
+
+        typename cadmium::make_message_bags<output_ports>::type output() const {
+            typename cadmium::make_message_bags<output_ports>::type bags;
+            cadmium::get_messages<sweep_out>(bags).push_back(1);
+            return bags;
+        }
+
+        TIME time_advance() const {
+            return std::get<0>(state);
+        }
+    };
+
+    template<typename TIME>
+    using sweep_counter = cadmium::basic_models::accumulator<int, TIME>;
+    using sweep_add = cadmium::basic_models::accumulator_defs<int>::add;
+
+    using ticker_model = cadmium::dynamic::modeling::atomic<sweep_ticker, float, float>;
+    using counter_model = cadmium::dynamic::modeling::atomic<sweep_counter, float>;
+    using coupled_model = cadmium::dynamic::modeling::coupled<float>;
+
+    // a region with a ticker and a counter, in a top model with another ticker sending to the region counter
+    std::shared_ptr<coupled_model> make_sweep_prototype() {
+        struct region_in : public cadmium::in_port<int>{};
+        auto region = std::make_shared<coupled_model>(
+                "region",
+                cadmium::dynamic::modeling::Models{std::make_shared<ticker_model>("ticker", 1.0f), std::make_shared<counter_model>("counter")},
+                cadmium::dynamic::modeling::Ports{typeid(region_in)}, cadmium::dynamic::modeling::Ports{},
+                cadmium::dynamic::modeling::EICs{cadmium::dynamic::translate::make_EIC<region_in, sweep_add>("counter")},
+                cadmium::dynamic::modeling::EOCs{},
+                cadmium::dynamic::modeling::ICs{cadmium::dynamic::translate::make_IC<sweep_out, sweep_add>("ticker", "counter")});
+        return std::make_shared<coupled_model>(
+                "top",
+                cadmium::dynamic::modeling::Models{std::make_shared<ticker_model>("ticker", 2.0f), region},
+                cadmium::dynamic::modeling::Ports{}, cadmium::dynamic::modeling::Ports{},
+                cadmium::dynamic::modeling::EICs{}, cadmium::dynamic::modeling::EOCs{},
+                cadmium::dynamic::modeling::ICs{cadmium::dynamic::translate::make_IC<sweep_out, region_in>("ticker", "region")});
+    }
+
+    int count_of(const std::shared_ptr<coupled_model>& top) {
+        auto region = std::dynamic_pointer_cast<coupled_model>(top->_models[1]);
+        return std::get<int>(std::dynamic_pointer_cast<counter_model>(region->_models[1])->state);
+    }
+
+    BOOST_AUTO_TEST_CASE( prototype_variants_share_the_links_and_copy_the_atomics_test ) {
+        cadmium::dynamic::modeling::model_prototype<float> prototype(make_sweep_prototype());
+        auto a = prototype.instantiate();
+        auto b = prototype.instantiate();
+        BOOST_CHECK(a != prototype.prototype());
+        BOOST_CHECK(a->_models[0] != b->_models[0]);
+        BOOST_CHECK(a->_ic[0]._link == b->_ic[0]._link);
+        BOOST_CHECK(a->_ic[0]._link == prototype.prototype()->_ic[0]._link);
+        auto region_a = std::dynamic_pointer_cast<coupled_model>(a->_models[1]);
+        auto region_b = std::dynamic_pointer_cast<coupled_model>(b->_models[1]);
+        BOOST_REQUIRE(region_a != nullptr && region_b != nullptr);
+        BOOST_CHECK(region_a != region_b);
+        BOOST_CHECK(region_a->_eic[0]._link == region_b->_eic[0]._link);
+
+        // the simulation of a variant does not change the others nor the prototype
+        cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(a, 0.0f);
+        r.run_until(5.0f);
+        // the region ticker at 1, 2, 3 and 4, the top one at 2 and 4
+        BOOST_CHECK_EQUAL(count_of(a), 6);
+        BOOST_CHECK_EQUAL(count_of(b), 0);
+        BOOST_CHECK_EQUAL(count_of(prototype.prototype()), 0);
+    }
+
+    BOOST_AUTO_TEST_CASE( prototype_variants_replace_the_models_of_their_paths_test ) {
+        cadmium::dynamic::modeling::model_prototype<float> prototype(make_sweep_prototype());
+        auto faster = std::make_shared<ticker_model>("ticker", 0.5f);
+        auto variant = prototype.instantiate({{"region/ticker", faster}});
+        auto region = std::dynamic_pointer_cast<coupled_model>(variant->_models[1]);
+        BOOST_CHECK(region->_models[0] == faster);
+        cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(variant, 0.0f);
+        r.run_until(5.0f);
+        // the region ticker at 0.5 to 4.5, the top one at 2 and 4
+        BOOST_CHECK_EQUAL(count_of(variant), 11);
+
+        BOOST_CHECK_THROW(prototype.instantiate({{"region/missing", faster}}), std::domain_error);
+        BOOST_CHECK_THROW(prototype.instantiate({{"region/counter", faster}}), std::domain_error);
+        BOOST_CHECK_THROW(cadmium::dynamic::modeling::model_prototype<float>(nullptr), std::domain_error);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
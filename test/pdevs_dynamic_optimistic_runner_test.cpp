@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/basic_model/int_generator_one_sec.hpp>
+#include <cadmium/basic_model/reset_generator_five_sec.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/dynamic_model_flattener.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_optimistic_runner.hpp>
+
+#include "count_fives_model.hpp"
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_optimistic_runner_test_suite )
+
+    using namespace count_fives;
+
+    namespace {
+        using dynamic_accumulator = test_accumulator<float>;
+        using not_logger = cadmium::logger::not_logger;
+        using sequential_optimistic_runner = cadmium::dynamic::engine::optimistic_runner<float, not_logger, cadmium::dynamic::engine::sequential_execution>;
+
+        std::string accumulator_id() {
+            return boost::typeindex::type_id<test_accumulator<float>>().pretty_name();
+        }
+
+        std::string int_generator_id() {
+            return boost::typeindex::type_id<cadmium::basic_models::int_generator_one_sec<float>>().pretty_name();
+        }
+
+        std::string reset_generator_id() {
+            return boost::typeindex::type_id<cadmium::basic_models::reset_generator_five_sec<float>>().pretty_name();
+        }
+
+        int accumulated_value(const std::shared_ptr<cadmium::dynamic::modeling::coupled<float>>& flat_model) {
+            // the dynamic atomic model derives from the atomic model class
+            for (const auto& m : flat_model->_models) {
+                auto accumulator = std::dynamic_pointer_cast<dynamic_accumulator>(m);
+                if (accumulator != nullptr) {
+                    return std::get<int>(accumulator->state);
+                }
+            }
+            BOOST_FAIL("No accumulator in the model");
+            return 0;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( atomic_state_can_be_saved_and_restored_test ) {
+        auto accumulator = cadmium::dynamic::translate::make_dynamic_atomic_model<test_accumulator, float>();
+        boost::any saved = accumulator->get_state();
+
+        cadmium::dynamic::message_bags bags;
+        cadmium::message_bag<test_accumulator_defs::add> add_bag;
+        add_bag.messages.push_back(3);
+        bags[typeid(test_accumulator_defs::add)] = add_bag;
+        accumulator->external_transition(1.0, std::move(bags));
+        BOOST_CHECK_EQUAL(std::get<int>(std::dynamic_pointer_cast<dynamic_accumulator>(accumulator)->state), 3);
+
+        accumulator->set_state(saved);
+        BOOST_CHECK_EQUAL(std::get<int>(std::dynamic_pointer_cast<dynamic_accumulator>(accumulator)->state), 0);
+        BOOST_CHECK_THROW(accumulator->set_state(boost::any(1)), boost::bad_any_cast);
+    }
+
+    BOOST_AUTO_TEST_CASE( optimistic_runner_rejects_invalid_partitions_test ) {
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        using partitions = std::vector<std::vector<std::string>>;
+        BOOST_CHECK_THROW(sequential_optimistic_runner(model, 0.0, partitions{{accumulator_id(), int_generator_id()}}), std::domain_error);
+        BOOST_CHECK_THROW(sequential_optimistic_runner(model, 0.0, partitions{{accumulator_id(), int_generator_id()}, {reset_generator_id(), accumulator_id()}}), std::domain_error);
+        BOOST_CHECK_THROW(sequential_optimistic_runner(model, 0.0, partitions{{accumulator_id(), int_generator_id(), reset_generator_id()}, {}}), std::domain_error);
+        BOOST_CHECK_THROW(sequential_optimistic_runner(model, 0.0, partitions{{accumulator_id(), int_generator_id(), reset_generator_id(), "unknown"}}), std::domain_error);
+    }
+
+    BOOST_AUTO_TEST_CASE( optimistic_runner_reaches_the_same_state_than_runner_test ) {
+        auto model = cadmium::dynamic::modeling::flatten<float>(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>());
+        cadmium::dynamic::engine::runner<float, not_logger> r(model, 0.0);
+        float next = r.run_until(23.0);
+
+        auto optimistic_model = cadmium::dynamic::modeling::flatten<float>(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>());
+        sequential_optimistic_runner opr(optimistic_model, 0.0, {{int_generator_id()}, {reset_generator_id()}, {accumulator_id()}});
+        BOOST_CHECK_EQUAL(opr.processes(), 3);
+        float optimistic_next = opr.run_until(23.0);
+
+        BOOST_CHECK_EQUAL(next, optimistic_next);
+        BOOST_CHECK_EQUAL(accumulated_value(model), accumulated_value(optimistic_model));
+        BOOST_CHECK_EQUAL(accumulated_value(model), 2); // reset at 20, then 21 and 22 were added
+    }
+
+    BOOST_AUTO_TEST_CASE( optimistic_runner_rolls_back_on_stragglers_test ) {
+        auto model = cadmium::dynamic::modeling::flatten<float>(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>());
+        cadmium::dynamic::engine::runner<float, not_logger> r(model, 0.0);
+        float next = r.run_until(33.0);
+
+        // the accumulator adds the ticks before knowing about the resets sent by the other process
+        auto optimistic_model = cadmium::dynamic::modeling::flatten<float>(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>());
+        cadmium::dynamic::engine::optimistic_runner<float, not_logger> opr(optimistic_model, 0.0, {{int_generator_id(), accumulator_id()}, {reset_generator_id()}}, 16, cadmium::dynamic::engine::parallel_execution(2));
+        float optimistic_next = opr.run_until(33.0);
+
+        BOOST_CHECK_GT(opr.rollbacks(), 0);
+        BOOST_CHECK_EQUAL(next, optimistic_next);
+        BOOST_CHECK_EQUAL(accumulated_value(model), accumulated_value(optimistic_model));
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,198 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/basic_model/int_generator_one_sec.hpp>
+#include <cadmium/basic_model/reset_generator_five_sec.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/dynamic_model_flattener.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_conservative_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_partitioner.hpp>
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_partitioner_test_suite )
+
+    template<typename TIME>
+    using int_accumulator=cadmium::basic_models::accumulator<int, TIME>;
+    using int_accumulator_defs=cadmium::basic_models::accumulator_defs<int>;
+
+    namespace {
+        std::string cell(int i) {
+            return "cell_" + std::to_string(i);
+        }
+
+        // accumulators coupled by the given pairs of their indexes
+        std::shared_ptr<cadmium::dynamic::modeling::coupled<float>> coupled_cells(int size, const std::vector<std::pair<int, int>>& couplings) {
+            cadmium::dynamic::modeling::Models models;
+            cadmium::dynamic::modeling::ICs ics;
+            for (int i = 0; i < size; i++) {
+                models.push_back(cadmium::dynamic::translate::make_dynamic_atomic_model<int_accumulator, float>(cell(i)));
+            }
+            for (const auto& c : couplings) {
+                ics.push_back(cadmium::dynamic::translate::make_IC<int_accumulator_defs::sum, int_accumulator_defs::add>(cell(c.first), cell(c.second)));
+            }
+            return std::make_shared<cadmium::dynamic::modeling::coupled<float>>(
+                    "cells", models, cadmium::dynamic::modeling::Ports{}, cadmium::dynamic::modeling::Ports{},
+                    cadmium::dynamic::modeling::EICs{}, cadmium::dynamic::modeling::EOCs{}, ics
+            );
+        }
+
+        // two rings of 8 cells joined by the coupling of cell 0 to cell 8
+        std::vector<std::pair<int, int>> two_rings() {
+            std::vector<std::pair<int, int>> ret;
+            for (int ring = 0; ring < 2; ring++) {
+                for (int i = 0; i < 8; i++) {
+                    ret.emplace_back(8 * ring + i, 8 * ring + (i + 1) % 8);
+                    ret.emplace_back(8 * ring + i, 8 * ring + (i + 3) % 8);
+                }
+            }
+            ret.emplace_back(0, 8);
+            return ret;
+        }
+
+        std::vector<std::pair<int, int>> grid(int side) {
+            std::vector<std::pair<int, int>> ret;
+            for (int row = 0; row < side; row++) {
+                for (int column = 0; column < side; column++) {
+                    if (column + 1 < side) {
+                        ret.emplace_back(row * side + column, row * side + column + 1);
+                    }
+                    if (row + 1 < side) {
+                        ret.emplace_back(row * side + column, (row + 1) * side + column);
+                    }
+                }
+            }
+            return ret;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( coupling_graph_has_an_edge_by_coupled_pair ) {
+        auto model = coupled_cells(3, {{0, 1}, {1, 0}, {1, 2}, {2, 2}});
+        cadmium::dynamic::engine::coupling_graph graph(*model);
+        BOOST_CHECK_EQUAL(graph.size(), 3);
+        BOOST_CHECK_EQUAL(graph.id(graph.index_of("cell_2")), "cell_2");
+        BOOST_CHECK_EQUAL(graph.edges(0).at(1), 2.0);
+        BOOST_CHECK_EQUAL(graph.edges(2).at(1), 1.0);
+        BOOST_CHECK(graph.edges(2).count(2) == 0);
+        BOOST_CHECK_THROW(graph.index_of("unknown"), std::domain_error);
+    }
+
+    BOOST_AUTO_TEST_CASE( coupling_graph_is_weighted_by_profiles ) {
+        auto model = coupled_cells(3, {{0, 1}, {1, 2}});
+        cadmium::dynamic::engine::coupling_graph graph(*model);
+
+        cadmium::dynamic::engine::link_profile ic;
+        ic.coupled_id = "cells";
+        ic.kind = "IC";
+        ic.from_model = "cell_1";
+        ic.to_model = "cell_2";
+        ic.messages = 10;
+        cadmium::dynamic::engine::link_profile other = ic;
+        other.coupled_id = "other";
+        cadmium::dynamic::engine::model_profile atomic;
+        atomic.model_id = "cell_0";
+        atomic.internal_transitions = 3;
+        atomic.outputs = 3;
+        graph.weight_by_profiles({ic, other}, {atomic});
+
+        BOOST_CHECK_EQUAL(graph.edges(1).at(2), 11.0);
+        BOOST_CHECK_EQUAL(graph.edges(0).at(1), 1.0);
+        BOOST_CHECK_EQUAL(graph.vertex_weight(0), 7.0);
+        BOOST_CHECK_EQUAL(graph.vertex_weight(1), 1.0);
+    }
+
+    BOOST_AUTO_TEST_CASE( partitioner_cuts_the_coupling_between_clusters ) {
+        auto model = coupled_cells(16, two_rings());
+        cadmium::dynamic::engine::coupling_graph graph(*model);
+        std::vector<std::size_t> part = cadmium::dynamic::engine::partition_vertices(graph);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::engine::edge_cut(graph, part), 1.0);
+        BOOST_CHECK_EQUAL(std::count(part.begin(), part.end(), 0), 8);
+        for (int i = 1; i < 8; i++) {
+            BOOST_CHECK_EQUAL(part[i], part[0]);
+            BOOST_CHECK_EQUAL(part[8 + i], part[8]);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( partitioner_balances_a_grid ) {
+        auto model = coupled_cells(400, grid(20));
+        cadmium::dynamic::engine::coupling_graph graph(*model);
+        cadmium::dynamic::engine::partition_options options;
+        options.parts = 4;
+        std::vector<std::size_t> part = cadmium::dynamic::engine::partition_vertices(graph, options);
+        for (std::size_t p = 0; p < 4; p++) {
+            BOOST_CHECK_LE(std::count(part.begin(), part.end(), p), 105);
+            BOOST_CHECK_GE(std::count(part.begin(), part.end(), p), 1);
+        }
+        // the quadrants cut 40 edges, the partition in bands of 5 rows 60
+        BOOST_CHECK_LE(cadmium::dynamic::engine::edge_cut(graph, part), 60.0);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::engine::partition_models(graph, options).size(), 4);
+    }
+
+    BOOST_AUTO_TEST_CASE( partitioner_needs_a_submodel_by_part ) {
+        auto model = coupled_cells(3, {{0, 1}});
+        cadmium::dynamic::engine::coupling_graph graph(*model);
+        cadmium::dynamic::engine::partition_options options;
+        options.parts = 4;
+        BOOST_CHECK_THROW(cadmium::dynamic::engine::partition_vertices(graph, options), std::domain_error);
+        // disconnected vertices are still spread on every part
+        options.parts = 3;
+        std::vector<std::size_t> part = cadmium::dynamic::engine::partition_vertices(graph, options);
+        std::sort(part.begin(), part.end());
+        BOOST_CHECK(part == std::vector<std::size_t>({0, 1, 2}));
+    }
+
+    // generators coupled to an accumulator, flattened to partition its atomic models
+    using generators_oports=std::tuple<cadmium::basic_models::int_generator_one_sec_defs::out, cadmium::basic_models::reset_generator_five_sec_defs::out>;
+    using top_submodels=cadmium::modeling::models_tuple<cadmium::basic_models::reset_generator_five_sec, cadmium::basic_models::int_generator_one_sec, int_accumulator>;
+    using top_ic=std::tuple<
+            cadmium::modeling::IC<cadmium::basic_models::int_generator_one_sec, cadmium::basic_models::int_generator_one_sec_defs::out, int_accumulator, int_accumulator_defs::add>,
+            cadmium::modeling::IC<cadmium::basic_models::reset_generator_five_sec, cadmium::basic_models::reset_generator_five_sec_defs::out, int_accumulator, int_accumulator_defs::reset>
+    >;
+    template<typename TIME>
+    using top_model=cadmium::modeling::coupled_model<TIME, std::tuple<>, std::tuple<>, top_submodels, std::tuple<>, std::tuple<>, top_ic>;
+
+    BOOST_AUTO_TEST_CASE( conservative_runner_runs_the_partitions ) {
+        using not_logger=cadmium::logger::not_logger;
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        cadmium::dynamic::engine::runner<float, not_logger> r(model, 0.0);
+        float next = r.run_until(23.0);
+
+        auto partitioned_model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        cadmium::dynamic::engine::coupling_graph graph(*partitioned_model);
+        auto partitions = cadmium::dynamic::engine::partition_models(graph);
+        cadmium::dynamic::engine::conservative_runner<float, not_logger, cadmium::dynamic::engine::no_fel<float>, cadmium::dynamic::engine::sequential_execution> cr(partitioned_model, 0.0, partitions);
+        BOOST_CHECK_EQUAL(cr.processes(), 2);
+        BOOST_CHECK_EQUAL(cr.run_until(23.0), next);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <cadmium/basic_model/generator.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+
+// This test is linked to the CadmiumEngine library and built with CADMIUM_PREBUILT_DYNAMIC_ENGINE defined,
+// then the runners below use the engines instantiated in the library.
+#ifndef CADMIUM_PREBUILT_DYNAMIC_ENGINE
+#error "the prebuilt engine test must be linked to the CadmiumEngine library"
+#endif
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_prebuilt_engine_test_suite )
+
+    struct test_tick{};
+
+    template<typename TIME>
+    struct test_generator : public cadmium::basic_models::generator<test_tick, TIME> {
+        TIME period() const override {
+            return TIME(1);
+        }
+        test_tick output_message() const override {
+            return test_tick();
+        }
+    };
+
+    template<typename TIME>
+    using top_model = cadmium::modeling::coupled_model<TIME, std::tuple<>, std::tuple<>,
+                                                       cadmium::modeling::models_tuple<test_generator>,
+                                                       std::tuple<>, std::tuple<>, std::tuple<>>;
+
+    BOOST_AUTO_TEST_CASE( float_not_logger_runner_test ) {
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>();
+        cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(model, 0.0f);
+        BOOST_CHECK_EQUAL(r.run_until(10.0f), 10.0f);
+    }
+
+    BOOST_AUTO_TEST_CASE( double_not_logger_runner_test ) {
+        auto model = cadmium::dynamic::translate::make_dynamic_coupled_model<double, top_model>();
+        cadmium::dynamic::engine::runner<double, cadmium::logger::not_logger> r(model, 0.0);
+        BOOST_CHECK_EQUAL(r.run_until(10.0), 10.0);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <cadmium/basic_model/generator.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_realtime.hpp>
+
+using namespace std::chrono;
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_realtime_test_suite )
+
+    struct rt_tick{};
+
+    using rt_out_port = cadmium::basic_models::generator_defs<rt_tick>::out;
+
+    template<typename TIME>
+    struct rt_generator : public cadmium::basic_models::generator<rt_tick, TIME> {
+        float period() const override {
+            return 1.0f;
+        }
+        rt_tick output_message() const override {
+            return rt_tick();
+        }
+    };
+
+    struct rt_coupled_out : public cadmium::out_port<rt_tick>{};
+
+    template<typename TIME>
+    using rt_coupled=cadmium::modeling::coupled_model<TIME, std::tuple<>, std::tuple<rt_coupled_out>,
+            cadmium::modeling::models_tuple<rt_generator>, std::tuple<>,
+            std::tuple<cadmium::modeling::EOC<rt_generator, rt_out_port, rt_coupled_out>>, std::tuple<>>;
+
+    BOOST_AUTO_TEST_CASE( realtime_pacer_maps_the_simulated_time_to_the_wall_time_test ) {
+        cadmium::dynamic::engine::realtime_options options;
+        options.seconds_per_time_unit = 0.5;
+        auto origin = steady_clock::now();
+        cadmium::dynamic::engine::realtime_pacer<double> pacer(2.0, options, origin);
+        BOOST_CHECK(pacer.deadline(2.0) == origin);
+        BOOST_CHECK(duration_cast<milliseconds>(pacer.deadline(5.0) - origin).count() == 1500);
+    }
+
+    BOOST_AUTO_TEST_CASE( realtime_pacer_waits_for_the_deadline_test ) {
+        cadmium::dynamic::engine::realtime_options options;
+        options.seconds_per_time_unit = 0.001;
+        cadmium::dynamic::engine::realtime_pacer<double> pacer(0.0, options);
+        for (int i = 1; i <= 5; i++) {
+            pacer.wait(i);
+            BOOST_CHECK(steady_clock::now() >= pacer.deadline(i));
+        }
+        BOOST_CHECK_EQUAL(pacer.report().lateness.count(), 5);
+    }
+
+    BOOST_AUTO_TEST_CASE( realtime_pacer_catches_up_by_its_policy_test ) {
+        cadmium::dynamic::engine::realtime_options options;
+        options.tolerance = milliseconds(1);
+        auto origin = steady_clock::now() - seconds(10);
+
+        cadmium::dynamic::engine::realtime_pacer<double> burst(0.0, options, origin);
+        burst.wait(1.0);
+        BOOST_CHECK_EQUAL(burst.report().misses, 1);
+        BOOST_CHECK(burst.report().lateness.max() >= seconds(9));
+        BOOST_CHECK(burst.deadline(2.0) == origin + seconds(2));
+
+        options.catch_up = cadmium::dynamic::engine::realtime_catch_up::realign;
+        cadmium::dynamic::engine::realtime_pacer<double> realign(0.0, options, origin);
+        realign.wait(1.0);
+        BOOST_CHECK_EQUAL(realign.report().misses, 1);
+        BOOST_CHECK(realign.report().realigned >= seconds(9));
+        // the next event is one second after the late one
+        BOOST_CHECK(realign.deadline(2.0) - steady_clock::now() > milliseconds(500));
+
+        options.catch_up = cadmium::dynamic::engine::realtime_catch_up::fail;
+        cadmium::dynamic::engine::realtime_pacer<double> fail(0.0, options, origin);
+        BOOST_CHECK_THROW(fail.wait(1.0), std::runtime_error);
+    }
+
+    BOOST_AUTO_TEST_CASE( realtime_pacer_rejects_invalid_options_test ) {
+        cadmium::dynamic::engine::realtime_options options;
+        options.seconds_per_time_unit = 0;
+        BOOST_CHECK_THROW(cadmium::dynamic::engine::realtime_pacer<double>(0.0, options), std::domain_error);
+        options.seconds_per_time_unit = 1;
+        options.spin = nanoseconds(-1);
+        BOOST_CHECK_THROW(cadmium::dynamic::engine::realtime_pacer<double>(0.0, options), std::domain_error);
+    }
+
+    BOOST_AUTO_TEST_CASE( dynamic_runner_runs_in_real_time_test ) {
+        auto coupled = cadmium::dynamic::translate::make_dynamic_coupled_model<float, rt_coupled>();
+        cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(coupled, 0.0);
+        BOOST_CHECK(r.realtime_report() == nullptr);
+        cadmium::dynamic::engine::realtime_options options;
+        options.seconds_per_time_unit = 0.002;
+        auto start = steady_clock::now();
+        BOOST_CHECK_EQUAL(r.run_realtime(6.0, options), 6.0);
+        // the event at 5 starts 10ms after the call
+        BOOST_CHECK(steady_clock::now() - start >= milliseconds(10));
+        BOOST_REQUIRE(r.realtime_report() != nullptr);
+        BOOST_CHECK_EQUAL(r.realtime_report()->lateness.count(), 5);
+        // the next run continues from the time the previous one stopped
+        start = steady_clock::now();
+        BOOST_CHECK_EQUAL(r.run_realtime(7.0, options), 7.0);
+        BOOST_CHECK(steady_clock::now() - start >= milliseconds(2));
+        BOOST_CHECK_EQUAL(r.realtime_report()->lateness.count(), 1);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
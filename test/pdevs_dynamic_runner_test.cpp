@@ -25,6 +25,7 @@
  */
 
 #define BOOST_TEST_DYN_LINK
+#include <algorithm>
 #include <boost/test/unit_test.hpp>
 
 #include <cadmium/basic_model/generator.hpp>
@@ -71,6 +72,99 @@ BOOST_AUTO_TEST_SUITE( pdevs_dynamic_runner_test_suite )
     template<typename TIME>
     using coupled_generator=cadmium::modeling::coupled_model<TIME, iports, oports, submodels, eics, eocs, ics>;
 
+    // two sensors sampling at nearly the same times
+    template<typename TIME>
+    struct test_sensor_a : public test_tick_generator_base<TIME> {
+        TIME period() const override {
+            return 1.000001;
+        }
+        test_tick output_message() const override {
+            return test_tick();
+        }
+    };
+
+    template<typename TIME>
+    struct test_sensor_b : public test_tick_generator_base<TIME> {
+        TIME period() const override {
+            return 1.000002;
+        }
+        test_tick output_message() const override {
+            return test_tick();
+        }
+    };
+
+    template<typename TIME>
+    using coupled_sensors=cadmium::modeling::coupled_model<TIME, iports, oports,
+            cadmium::modeling::models_tuple<test_sensor_a, test_sensor_b>, eics,
+            std::tuple<
+                    cadmium::modeling::EOC<test_sensor_a, out_port, coupled_out_port>,
+                    cadmium::modeling::EOC<test_sensor_b, out_port, coupled_out_port>
+            >, ics>;
+
+    // a countdown sending a tick each second until it passivates, and a counter of the ticks it receives
+    struct countdown_out : public cadmium::out_port<test_tick> {};
+    struct counter_in : public cadmium::in_port<test_tick> {};
+
+    template<typename TIME>
+    struct test_countdown {
+        using input_ports = std::tuple<>;
+        using output_ports = std::tuple<countdown_out>;
+        using state_type = int;
+        state_type state = 3;
+
+        void internal_transition() {
+            state--;
+        }
+
+        void external_transition(TIME, typename cadmium::make_message_bags<input_ports>::type) {}
+
+        void confluence_transition(TIME, typename cadmium::make_message_bags<input_ports>::type) {
+            internal_transition();
+        }
+
+        typename cadmium::make_message_bags<output_ports>::type output() const {
+            typename cadmium::make_message_bags<output_ports>::type bags;
+            cadmium::get_messages<countdown_out>(bags).emplace_back();
+            return bags;
+        }
+
+        TIME time_advance() const {
+            return state > 0 ? TIME(1) : std::numeric_limits<TIME>::infinity();
+        }
+    };
+
+    template<typename TIME>
+    struct test_counter {
+        using input_ports = std::tuple<counter_in>;
+        using output_ports = std::tuple<>;
+        using state_type = int;
+        state_type state = 0;
+
+        void internal_transition() {}
+
+        void external_transition(TIME, typename cadmium::make_message_bags<input_ports>::type mbs) {
+            state += cadmium::get_messages<counter_in>(mbs).size();
+        }
+
+        void confluence_transition(TIME e, typename cadmium::make_message_bags<input_ports>::type mbs) {
+            external_transition(e, std::move(mbs));
+        }
+
+        typename cadmium::make_message_bags<output_ports>::type output() const {
+            return {};
+        }
+
+        TIME time_advance() const {
+            return std::numeric_limits<TIME>::infinity();
+        }
+    };
+
+    template<typename TIME>
+    using coupled_countdown=cadmium::modeling::coupled_model<TIME, iports, oports,
+            cadmium::modeling::models_tuple<test_countdown, test_counter>, eics,
+            std::tuple<cadmium::modeling::EOC<test_countdown, countdown_out, coupled_out_port>>,
+            std::tuple<cadmium::modeling::IC<test_countdown, countdown_out, test_counter, counter_in>>>;
+
     // std::shared_ptr<cadmium::dynamic::modeling::coupled<float>>
     auto coupled = cadmium::dynamic::translate::make_dynamic_coupled_model<float, coupled_generator>();
 
@@ -85,6 +179,249 @@ BOOST_AUTO_TEST_SUITE( pdevs_dynamic_runner_test_suite )
             BOOST_CHECK_EQUAL(60.0, next_to_end_time);
         }
 
+        BOOST_AUTO_TEST_CASE( pdevs_dynamic_runner_profiles_the_atomic_models_test ){
+            cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(coupled, 0.0);
+            BOOST_CHECK(r.profiles().empty());
+
+            r.enable_profiling();
+            r.run_until(3.0);
+            auto profiles = r.profiles();
+            BOOST_REQUIRE_EQUAL(profiles.size(), 1);
+            BOOST_CHECK_EQUAL(profiles[0].model_id, sp_test_generator->get_id());
+            BOOST_CHECK_EQUAL(profiles[0].outputs, 2);
+            BOOST_CHECK_EQUAL(profiles[0].messages_out, 2);
+            BOOST_CHECK_EQUAL(profiles[0].internal_transitions, 2);
+            BOOST_CHECK_EQUAL(profiles[0].external_transitions, 0);
+            BOOST_CHECK_EQUAL(profiles[0].messages_in, 0);
+            BOOST_CHECK(profiles[0].total_time().count() > 0);
+
+            std::ostringstream csv;
+            r.write_profiles_csv(csv);
+            std::string csv_text = csv.str();
+            BOOST_CHECK_EQUAL(std::count(csv_text.begin(), csv_text.end(), '\n'), 2);
+            BOOST_CHECK(csv_text.find(",0,2,0,2,") != std::string::npos);
+
+            std::ostringstream json;
+            r.write_profiles_json(json);
+            BOOST_CHECK(json.str().find("\"internal_transitions\": 2, \"external_transitions\": 0") != std::string::npos);
+        }
+
+        BOOST_AUTO_TEST_CASE( pdevs_dynamic_runner_profiles_the_coupling_links_test ){
+            cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(coupled, 0.0);
+            BOOST_CHECK(r.link_profiles().empty());
+
+            r.enable_profiling();
+            r.run_until(3.0);
+            auto links = r.link_profiles();
+            BOOST_REQUIRE_EQUAL(links.size(), 1);
+            BOOST_CHECK_EQUAL(links[0].kind, "EOC");
+            BOOST_CHECK_EQUAL(links[0].coupled_id, coupled->get_id());
+            BOOST_CHECK_EQUAL(links[0].from_model, sp_test_generator->get_id());
+            BOOST_CHECK_EQUAL(links[0].to_model, coupled->get_id());
+            BOOST_CHECK(!links[0].moves);
+            BOOST_CHECK_EQUAL(links[0].routings, 2);
+            BOOST_CHECK_EQUAL(links[0].messages, 2);
+            BOOST_CHECK_EQUAL(links[0].bytes_copied, 2 * sizeof(test_tick));
+
+            std::ostringstream csv;
+            r.write_link_profiles_csv(csv);
+            BOOST_CHECK(csv.str().find("\"EOC\"") != std::string::npos);
+            BOOST_CHECK(csv.str().find(",0,2,2,2,") != std::string::npos);
+        }
+
+        BOOST_AUTO_TEST_CASE( link_profiles_are_ranked_by_time_test ){
+            std::vector<cadmium::dynamic::engine::link_profile> links(3);
+            links[0].time = std::chrono::nanoseconds(5);
+            links[1].time = std::chrono::nanoseconds(20);
+            links[2].time = std::chrono::nanoseconds(10);
+            links[0].from_port = "a";
+            links[1].from_port = "b";
+            links[2].from_port = "c";
+            cadmium::dynamic::engine::rank_link_profiles(links);
+            BOOST_CHECK_EQUAL(links[0].from_port, "b");
+            BOOST_CHECK_EQUAL(links[1].from_port, "c");
+            BOOST_CHECK_EQUAL(links[2].from_port, "a");
+        }
+
+        BOOST_AUTO_TEST_CASE( pdevs_dynamic_runner_records_the_step_latency_test ){
+            cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(coupled, 0.0);
+            BOOST_CHECK(r.step_latency() == nullptr);
+            r.enable_step_latency(1);
+            r.run_until(4.0);
+            BOOST_REQUIRE(r.step_latency() != nullptr);
+            BOOST_CHECK_EQUAL(r.step_latency()->histogram().count(), 3);
+            auto slowest = r.step_latency()->slowest();
+            BOOST_REQUIRE_EQUAL(slowest.size(), 1);
+            BOOST_CHECK(slowest[0].time >= 1.0 && slowest[0].time <= 3.0);
+            BOOST_CHECK_EQUAL(slowest[0].duration.count(), r.step_latency()->histogram().max().count());
+        }
+
+        BOOST_AUTO_TEST_CASE( pdevs_dynamic_runner_calls_the_output_callbacks_test ){
+            cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(coupled, 0.0);
+            std::vector<float> times;
+            std::size_t ticks = 0;
+            r.add_output_callback<coupled_out_port>([&](const float& t, const cadmium::message_bag<coupled_out_port>& bag) {
+                times.push_back(t);
+                ticks += bag.messages.size();
+            });
+            r.run_until(4.0);
+            std::vector<float> expected{1.0f, 2.0f, 3.0f};
+            BOOST_CHECK_EQUAL_COLLECTIONS(times.begin(), times.end(), expected.begin(), expected.end());
+            BOOST_CHECK_EQUAL(ticks, 3);
+            BOOST_CHECK_THROW(r.add_output_callback<out_port>([](const float&, const cadmium::message_bag<out_port>&) {}), std::domain_error);
+        }
+
+        BOOST_AUTO_TEST_CASE( pdevs_dynamic_runner_routes_the_messages_until_passivation_test ){
+            auto countdown = cadmium::dynamic::translate::make_dynamic_coupled_model<float, coupled_countdown>();
+            cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(countdown, 0.0);
+            std::vector<float> times;
+            r.add_output_callback<coupled_out_port>([&times](const float& t, const cadmium::message_bag<coupled_out_port>&) {
+                times.push_back(t);
+            });
+            r.run_until_passivate();
+            std::vector<float> expected{1.0f, 2.0f, 3.0f};
+            BOOST_CHECK_EQUAL_COLLECTIONS(times.begin(), times.end(), expected.begin(), expected.end());
+
+            // the ticks were also routed to the counter by the internal coupling
+            int received = -1;
+            for (const auto& m : countdown->_models) {
+                if (auto counter = std::dynamic_pointer_cast<test_counter<float>>(m)) {
+                    received = counter->state;
+                }
+            }
+            BOOST_CHECK_EQUAL(received, 3);
+        }
+
+        BOOST_AUTO_TEST_CASE( pdevs_dynamic_runner_stops_when_its_predicate_fails_test ){
+            cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(coupled, 0.0);
+            std::size_t ticks = 0;
+            r.add_output_callback<coupled_out_port>([&ticks](const float&, const cadmium::message_bag<coupled_out_port>& bag) {
+                ticks += bag.messages.size();
+            });
+            BOOST_CHECK_EQUAL(r.run_while([&ticks]() { return ticks < 5; }), 6.0f);
+            BOOST_CHECK_EQUAL(ticks, 5);
+            // the limit time stops it first
+            BOOST_CHECK_EQUAL(r.run_while([]() { return true; }, 8.0f), 8.0f);
+            BOOST_CHECK_EQUAL(ticks, 7);
+        }
+
+        BOOST_AUTO_TEST_CASE( quantize_time_moves_the_times_up_to_the_grid_test ){
+            using cadmium::dynamic::engine::quantize_time;
+            BOOST_CHECK_EQUAL(quantize_time(1.0, 0.001), 1.0);
+            BOOST_CHECK_EQUAL(quantize_time(1.000001, 0.001), 1.001);
+            BOOST_CHECK_EQUAL(quantize_time(1.000001, 0.0), 1.000001);
+            BOOST_CHECK_EQUAL(quantize_time(std::numeric_limits<double>::infinity(), 0.001), std::numeric_limits<double>::infinity());
+        }
+
+        BOOST_AUTO_TEST_CASE( pdevs_dynamic_runner_quantizes_the_near_simultaneous_events_test ){
+            auto sensors = cadmium::dynamic::translate::make_dynamic_coupled_model<double, coupled_sensors>();
+            auto count_steps = [&sensors](double quantum, std::size_t& ticks) {
+                cadmium::dynamic::engine::runner<double, cadmium::logger::not_logger> r(sensors, 0.0);
+                r.set_time_quantum(quantum);
+                r.add_output_callback<coupled_out_port>([&ticks](const double&, const cadmium::message_bag<coupled_out_port>& bag) {
+                    ticks += bag.messages.size();
+                });
+                std::size_t steps = 0;
+                for (double t = r.next(); t < 10.5; t = r.next()) {
+                    r.step();
+                    steps++;
+                }
+                BOOST_CHECK_THROW(r.set_time_quantum(quantum), std::domain_error);
+                return steps;
+            };
+            std::size_t exact_ticks = 0, quantized_ticks = 0;
+            BOOST_CHECK_EQUAL(count_steps(0.0, exact_ticks), 20);
+            // both sensors output in the same steps, at the multiples of the quantum
+            BOOST_CHECK_EQUAL(count_steps(0.01, quantized_ticks), 10);
+            BOOST_CHECK_EQUAL(exact_ticks, 20);
+            BOOST_CHECK_EQUAL(quantized_ticks, 20);
+
+            cadmium::dynamic::engine::runner<double, cadmium::logger::not_logger> r(sensors, 0.0);
+            BOOST_CHECK_THROW(r.set_time_quantum(-1.0), std::domain_error);
+            r.set_time_quantum(0.01);
+            BOOST_CHECK_CLOSE(r.next(), 1.01, 1e-9);
+        }
+
+        BOOST_AUTO_TEST_CASE( pdevs_dynamic_runner_counts_the_coordinator_phases_by_level_test ){
+            cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(coupled, 0.0);
+            BOOST_CHECK(r.counters() == nullptr);
+
+            bool available = r.enable_counters();
+            r.run_until(3.0);
+            const auto& levels = r.counters()->levels();
+            BOOST_REQUIRE_EQUAL(levels.size(), 1);
+            using phase = cadmium::dynamic::engine::coordinator_phase;
+            BOOST_CHECK_EQUAL(levels[0][phase::collect].calls, 2);
+            BOOST_CHECK_EQUAL(levels[0][phase::advance].calls, 2);
+            BOOST_CHECK_EQUAL(levels[0][phase::route].calls, 4); // the EOC and the IC and EIC routing
+            if (available) {
+                BOOST_CHECK(levels[0][phase::advance].instructions > 0);
+                BOOST_CHECK(levels[0][phase::advance].instructions >= levels[0][phase::route].instructions / 2);
+            } else {
+                BOOST_CHECK_EQUAL(levels[0][phase::advance].instructions, 0);
+            }
+
+            std::ostringstream csv;
+            cadmium::dynamic::engine::write_counters_csv(csv, *r.counters());
+            BOOST_CHECK(csv.str().find("0,route,4,") != std::string::npos);
+        }
+
+        BOOST_AUTO_TEST_CASE( pdevs_dynamic_runner_reports_telemetry_test ){
+            cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(coupled, 0.0);
+            std::vector<cadmium::dynamic::engine::telemetry_sample<float>> samples;
+            cadmium::dynamic::engine::telemetry_options options;
+            options.every_steps = 2;
+            r.enable_telemetry(options, [&samples] (const auto& s) { samples.push_back(s); });
+            r.run_until(4.0);
+            // a sample after the second step, the third one is flushed at the end of the run
+            BOOST_REQUIRE_EQUAL(samples.size(), 2);
+            BOOST_CHECK_EQUAL(samples[0].steps, 2);
+            BOOST_CHECK_EQUAL(samples[0].time, 2.0);
+            BOOST_CHECK_EQUAL(samples[1].steps, 3);
+            BOOST_CHECK_EQUAL(samples[1].time, 3.0);
+            BOOST_CHECK_EQUAL(samples[1].events, 3);
+            BOOST_CHECK_EQUAL(samples[1].messages, 3);
+            BOOST_CHECK_EQUAL(samples[1].imminents, 1);
+
+            std::ostringstream prometheus;
+            cadmium::dynamic::engine::write_telemetry_prometheus(prometheus, samples[1]);
+            BOOST_CHECK(prometheus.str().find("# TYPE cadmium_steps_total counter\ncadmium_steps_total 3\n") != std::string::npos);
+
+            r.disable_telemetry();
+            r.run_until(6.0);
+            BOOST_CHECK_EQUAL(samples.size(), 2);
+        }
+
+        BOOST_AUTO_TEST_CASE( pdevs_dynamic_runner_telemetry_needs_an_interval_test ){
+            cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(coupled, 0.0);
+            BOOST_CHECK_THROW(r.enable_telemetry(cadmium::dynamic::engine::telemetry_options(), [] (const auto&) {}), std::domain_error);
+        }
+
+        BOOST_AUTO_TEST_CASE( pdevs_dynamic_runner_accounts_the_memory_of_the_models_test ){
+            cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(coupled, 0.0);
+            BOOST_CHECK(r.memory_peak() == nullptr);
+            r.enable_memory_tracking();
+            r.run_until(3.0);
+
+            auto models = r.memory();
+            BOOST_REQUIRE_EQUAL(models.size(), 1);
+            BOOST_CHECK_EQUAL(models[0].model_id, coupled->get_id());
+            BOOST_CHECK_EQUAL(models[0].level, 0);
+            BOOST_CHECK(models[0].self.bags > 0);
+            BOOST_CHECK(models[0].self.engines > 0);
+            BOOST_CHECK(models[0].self.links > 0);
+            BOOST_CHECK(models[0].self.states > 0);
+            BOOST_CHECK_EQUAL(models[0].total.total(), models[0].self.total());
+            BOOST_CHECK_EQUAL(r.memory_total().total(), models[0].total.total());
+
+            const auto* peak = r.memory_peak();
+            BOOST_REQUIRE(peak != nullptr);
+            BOOST_CHECK_EQUAL(peak->steps, 2);
+            BOOST_CHECK(peak->peak_total > 0);
+            BOOST_CHECK(peak->peak_total >= peak->peak.states);
+            BOOST_CHECK(peak->peak.bags > 0);
+        }
+
     BOOST_AUTO_TEST_SUITE_END()
 
     BOOST_AUTO_TEST_SUITE( loggers_sources_dynamic_runner_test_suite )
@@ -169,6 +506,24 @@ BOOST_AUTO_TEST_SUITE( pdevs_dynamic_runner_test_suite )
             BOOST_CHECK_EQUAL(oss.str(), expected_oss.str());
         }
 
+        BOOST_AUTO_TEST_CASE( dynamic_simulation_logs_the_initialization_once_when_quantized_test )
+        {
+            oss.str("");
+            using log_all_to_oss=cadmium::logger::logger<cadmium::logger::logger_info, cadmium::dynamic::logger::formatter<float>, oss_test_sink_provider>;
+            using log_state_to_oss=cadmium::logger::logger<cadmium::logger::logger_state, cadmium::dynamic::logger::formatter<float>, oss_test_sink_provider>;
+
+            cadmium::dynamic::engine::runner<float, cadmium::logger::multilogger<log_all_to_oss, log_state_to_oss>> r(coupled, 0.0);
+            r.set_time_quantum(0.75f);
+            BOOST_CHECK_EQUAL(r.next(), 1.5f);
+            std::string log = oss.str();
+            std::string init = "Simulator for model " + sp_test_generator->get_id() + " initialized to time 0\n";
+            std::string state = "State for model " + sp_test_generator->get_id() + " is 0\n";
+            BOOST_CHECK_EQUAL(log.find(init), log.rfind(init));
+            BOOST_CHECK(log.find(init) != std::string::npos);
+            BOOST_CHECK_EQUAL(log.find(state), log.rfind(state));
+            BOOST_CHECK(log.find(state) != std::string::npos);
+        }
+
         BOOST_AUTO_TEST_CASE( dynamic_simulation_logs_state_only_show_state_changes_and_initial_state_test )
         {
             //This test integrates log output from runner, coordinator and simulator.
@@ -271,6 +626,29 @@ BOOST_AUTO_TEST_SUITE( pdevs_dynamic_runner_test_suite )
             BOOST_CHECK_EQUAL(oss.str(), expected_oss.str());
         }
 
+        BOOST_AUTO_TEST_CASE( dynamic_simulation_logs_only_the_logged_models_test )
+        {
+            oss.str("");
+            using log_state_to_oss=cadmium::logger::logger<cadmium::logger::logger_state, cadmium::dynamic::logger::formatter<float>, oss_test_sink_provider>;
+            using log_routing_to_oss=cadmium::logger::logger<cadmium::logger::logger_message_routing, cadmium::dynamic::logger::formatter<float>, oss_test_sink_provider>;
+
+            // the generator is logged, its coupled model is not
+            cadmium::dynamic::engine::runner<float, log_state_to_oss> r(coupled, 0.0, {sp_test_generator->get_id()});
+            r.run_until(3.0);
+            std::string states = oss.str();
+            BOOST_CHECK_EQUAL(std::count(states.begin(), states.end(), '\n'), 3);
+
+            oss.str("");
+            cadmium::dynamic::engine::runner<float, log_routing_to_oss> r_routing(coupled, 0.0, {sp_test_generator->get_id()});
+            r_routing.run_until(3.0);
+            BOOST_CHECK_EQUAL(oss.str(), "");
+
+            oss.str("");
+            cadmium::dynamic::engine::runner<float, log_state_to_oss> r_none(coupled, 0.0, std::unordered_set<std::string>{});
+            r_none.run_until(3.0);
+            BOOST_CHECK_EQUAL(oss.str(), "");
+        }
+
     BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -41,6 +41,42 @@ template<typename TIME>
 using int_accumulator=cadmium::basic_models::accumulator<int, TIME>;
 using int_accumulator_defs=cadmium::basic_models::accumulator_defs<int>;
 
+// a TIME counting integer ticks, which is not converted to or from double
+struct test_ticks {
+    long ticks = 0;
+
+    test_ticks() = default;
+    explicit test_ticks(long t) : ticks(t) {}
+
+    friend test_ticks operator+(const test_ticks& a, const test_ticks& b) {
+        return test_ticks(a.ticks == std::numeric_limits<long>::max() || b.ticks == std::numeric_limits<long>::max() ? std::numeric_limits<long>::max() : a.ticks + b.ticks);
+    }
+    friend test_ticks operator-(const test_ticks& a, const test_ticks& b) {
+        return test_ticks(a.ticks - b.ticks);
+    }
+    friend bool operator<(const test_ticks& a, const test_ticks& b) {
+        return a.ticks < b.ticks;
+    }
+    friend bool operator==(const test_ticks& a, const test_ticks& b) {
+        return a.ticks == b.ticks;
+    }
+    friend bool operator!=(const test_ticks& a, const test_ticks& b) {
+        return a.ticks != b.ticks;
+    }
+};
+
+namespace std {
+    template<>
+    class numeric_limits<test_ticks> {
+    public:
+        static constexpr bool is_specialized = true;
+        static constexpr bool has_infinity = true;
+        static test_ticks infinity() noexcept {
+            return test_ticks(std::numeric_limits<long>::max());
+        }
+    };
+}
+
 BOOST_AUTO_TEST_SUITE( pdevs_dynamic_simulator_suite )
 
 BOOST_AUTO_TEST_SUITE( pdevs_accumulator_suite )
@@ -92,7 +128,7 @@ BOOST_AUTO_TEST_CASE( accumulator_model_dynamic_simulation_test )
     //out provides the accumulated result
     s.collect_outputs(4.0f);
     auto o = s.outbox();
-    output = boost::any_cast<cadmium::message_bag<int_accumulator_defs::sum>>(o.at(typeid(int_accumulator_defs::sum)));
+    output = cadmium::dynamic::bag_cast<cadmium::message_bag<int_accumulator_defs::sum>>(o.at(typeid(int_accumulator_defs::sum)));
     BOOST_CHECK(output.messages.size() == 1);
     BOOST_CHECK(output.messages.at(0) == 10);
 
@@ -106,7 +142,7 @@ BOOST_AUTO_TEST_CASE( accumulator_model_dynamic_simulation_test )
     BOOST_CHECK(s.next() == 5.0f);
     s.collect_outputs(5.0f);
     o = s.outbox();
-    output = boost::any_cast<cadmium::message_bag<int_accumulator_defs::sum>>(o.at(typeid(int_accumulator_defs::sum)));
+    output = cadmium::dynamic::bag_cast<cadmium::message_bag<int_accumulator_defs::sum>>(o.at(typeid(int_accumulator_defs::sum)));
     BOOST_CHECK(output.messages.size() == 1);
     BOOST_CHECK(output.messages.at(0) == 0);
     s._inbox = empty_input;
@@ -122,7 +158,7 @@ BOOST_AUTO_TEST_CASE( accumulator_model_dynamic_simulation_test )
     BOOST_CHECK(s.next() == 6.0f);
     s.collect_outputs(6.0f);
     o = s.outbox();
-    output = boost::any_cast<cadmium::message_bag<int_accumulator_defs::sum>>(o.at(typeid(int_accumulator_defs::sum)));
+    output = cadmium::dynamic::bag_cast<cadmium::message_bag<int_accumulator_defs::sum>>(o.at(typeid(int_accumulator_defs::sum)));
     BOOST_CHECK(output.messages.size() == 1);
     BOOST_CHECK(output.messages.at(0) == 10);
 
@@ -134,6 +170,29 @@ BOOST_AUTO_TEST_CASE( accumulator_model_dynamic_simulation_test )
 #endif
 }
 
+BOOST_AUTO_TEST_CASE( accumulator_simulator_with_a_time_not_converted_to_double_test )
+{
+    auto model = cadmium::dynamic::translate::make_dynamic_atomic_model<int_accumulator, test_ticks>();
+    cadmium::dynamic::engine::simulator<test_ticks, cadmium::logger::not_logger> s(model);
+    s.init(test_ticks(0));
+    BOOST_CHECK(s.next() == std::numeric_limits<test_ticks>::infinity());
+
+    // the quantum only adds up ticks
+    s.set_time_quantum(test_ticks(10));
+    BOOST_CHECK(cadmium::dynamic::engine::quantize_time(test_ticks(0), test_ticks(10)) == test_ticks(0));
+    BOOST_CHECK(cadmium::dynamic::engine::quantize_time(test_ticks(1), test_ticks(10)) == test_ticks(10));
+    BOOST_CHECK(cadmium::dynamic::engine::quantize_time(test_ticks(10), test_ticks(10)) == test_ticks(10));
+    BOOST_CHECK(cadmium::dynamic::engine::quantize_time(test_ticks(12345), test_ticks(10)) == test_ticks(12350));
+    BOOST_CHECK(cadmium::dynamic::engine::quantize_time(test_ticks(12345), test_ticks()) == test_ticks(12345));
+
+    // a reset is scheduled after no time
+    cadmium::message_bag<int_accumulator_defs::reset> reset;
+    reset.messages.emplace_back();
+    s._inbox[typeid(int_accumulator_defs::reset)] = reset;
+    s.advance_simulation(test_ticks(7));
+    BOOST_CHECK(s.next() == test_ticks(10));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -0,0 +1,251 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <csignal>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_atomic.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/state_serializer.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_state_store.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+// the state of a sampler keeps all its samples
+struct sampler_state {
+    std::vector<int> samples;
+};
+
+std::ostream& operator<<(std::ostream& os, const sampler_state& s) {
+    return os << s.samples.size();
+}
+
+template<>
+struct cadmium::state_serializer<sampler_state> {
+    static constexpr bool serializable = true;
+
+    static void write(const sampler_state& value, std::string& buffer) {
+        cadmium::state_serializer<std::vector<int>>::write(value.samples, buffer);
+    }
+
+    static void read(const char*& data, const char* end, sampler_state& value) {
+        cadmium::state_serializer<std::vector<int>>::read(data, end, value.samples);
+    }
+};
+
+template<typename TIME>
+struct sampler {
+    using input_ports = std::tuple<>;
+    using output_ports = std::tuple<>;
+    using state_type = sampler_state;
+
+    state_type state;
+    int period = 1;
+
+    sampler() = default;
+
+    explicit sampler(int p) : period(p) {}
+
+    void internal_transition() {
+        state.samples.push_back(static_cast<int>(state.samples.size()) * period);
+    }
+
+    void external_transition(TIME, typename cadmium::make_message_bags<input_ports>::type) {}
+
+    void confluence_transition(TIME, typename cadmium::make_message_bags<input_ports>::type) {
+        internal_transition();
+    }
+
+    typename cadmium::make_message_bags<output_ports>::type output() const {
+        return {};
+    }
+
+    TIME time_advance() const {
+        return TIME(period);
+    }
+};
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_state_store_test_suite )
+
+    const int samplers = 10;
+
+    std::shared_ptr<cadmium::dynamic::modeling::coupled<double>> make_samplers() {
+        cadmium::dynamic::modeling::Models models;
+        for (int i = 0; i < samplers; i++) {
+            models.push_back(cadmium::dynamic::translate::make_dynamic_atomic_model<sampler, double, int>("sampler_" + std::to_string(i), i + 1));
+        }
+        return std::make_shared<cadmium::dynamic::modeling::coupled<double>>(
+                "samplers", models, cadmium::dynamic::modeling::Ports{}, cadmium::dynamic::modeling::Ports{},
+                cadmium::dynamic::modeling::EICs{}, cadmium::dynamic::modeling::EOCs{}, cadmium::dynamic::modeling::ICs{}
+        );
+    }
+
+    std::vector<int> samples_of(const cadmium::dynamic::modeling::coupled<double>& coupled, int i) {
+        return std::dynamic_pointer_cast<sampler<double>>(coupled._models[i])->state.samples;
+    }
+
+    BOOST_AUTO_TEST_CASE( paged_states_give_the_same_simulation ) {
+        auto exact = make_samplers();
+        cadmium::dynamic::engine::runner<double, cadmium::logger::not_logger> exact_runner(exact, 0.0);
+        exact_runner.run_until(60.0);
+
+        std::string path = (std::filesystem::temp_directory_path() / "cadmium_state_store_test.bin").string();
+        auto paged = make_samplers();
+        cadmium::dynamic::engine::runner<double, cadmium::logger::not_logger> paged_runner(paged, 0.0);
+        auto store = std::make_shared<cadmium::dynamic::engine::state_store<double>>(path, 2);
+        paged_runner.set_state_store(store);
+        BOOST_CHECK_EQUAL(store->stats().resident, 2);
+        BOOST_CHECK_EQUAL(store->stats().dormant, samplers - 2);
+
+        paged_runner.run_until(60.0);
+        auto stats = store->stats();
+        BOOST_CHECK_EQUAL(stats.resident, 2);
+        BOOST_CHECK(stats.page_ins > 0);
+        BOOST_CHECK(stats.page_outs >= stats.page_ins);
+        BOOST_CHECK(stats.prefetches > 0);
+        BOOST_CHECK(std::filesystem::exists(path));
+
+        // the dormant models have an empty state until they are paged in
+        int empty = 0;
+        for (int i = 0; i < samplers; i++) {
+            empty += samples_of(*paged, i).empty() ? 1 : 0;
+        }
+        BOOST_CHECK_EQUAL(empty, samplers - 2);
+
+        // removing the store pages in all the states
+        paged_runner.set_state_store(nullptr);
+        BOOST_CHECK_EQUAL(store->stats().resident, 0);
+        for (int i = 0; i < samplers; i++) {
+            BOOST_CHECK(samples_of(*paged, i) == samples_of(*exact, i));
+            BOOST_CHECK_EQUAL(samples_of(*paged, i).size(), 59 / (i + 1));
+        }
+        store.reset();
+        BOOST_CHECK(!std::filesystem::exists(path));
+    }
+
+    BOOST_AUTO_TEST_CASE( paged_states_keep_their_schedule_when_quantized ) {
+        auto exact = make_samplers();
+        cadmium::dynamic::engine::runner<double, cadmium::logger::not_logger> exact_runner(exact, 0.0);
+        exact_runner.set_time_quantum(0.75);
+        exact_runner.run_until(30.0);
+
+        std::string path = (std::filesystem::temp_directory_path() / "cadmium_state_store_quantum_test.bin").string();
+        auto paged = make_samplers();
+        cadmium::dynamic::engine::runner<double, cadmium::logger::not_logger> paged_runner(paged, 0.0);
+        auto store = std::make_shared<cadmium::dynamic::engine::state_store<double>>(path, 2);
+        paged_runner.set_state_store(store);
+        // the scheduled events are quantized without paging the dormant states in
+        paged_runner.set_time_quantum(0.75);
+        BOOST_CHECK_EQUAL(paged_runner.next(), 1.5);
+        BOOST_CHECK_EQUAL(store->stats().page_ins, 0);
+        BOOST_CHECK_EQUAL(store->stats().dormant, samplers - 2);
+
+        paged_runner.run_until(30.0);
+        paged_runner.set_state_store(nullptr);
+        for (int i = 0; i < samplers; i++) {
+            BOOST_CHECK(samples_of(*paged, i) == samples_of(*exact, i));
+            BOOST_CHECK(!samples_of(*paged, i).empty());
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( paged_states_are_saved_in_the_checkpoints ) {
+        std::string path = (std::filesystem::temp_directory_path() / "cadmium_state_store_checkpoint_test.bin").string();
+        auto exact = make_samplers();
+        cadmium::dynamic::engine::runner<double, cadmium::logger::not_logger> exact_runner(exact, 0.0);
+        exact_runner.run_until(20.0);
+        std::string exact_checkpoint;
+        exact_runner.save_checkpoint(exact_checkpoint);
+
+        auto paged = make_samplers();
+        cadmium::dynamic::engine::runner<double, cadmium::logger::not_logger> paged_runner(paged, 0.0);
+        auto store = std::make_shared<cadmium::dynamic::engine::state_store<double>>(path, 3);
+        paged_runner.set_state_store(store);
+        paged_runner.run_until(20.0);
+        std::string paged_checkpoint;
+        paged_runner.save_checkpoint(paged_checkpoint);
+        BOOST_CHECK(paged_checkpoint == exact_checkpoint);
+        BOOST_CHECK(store->stats().resident <= 3);
+    }
+
+    BOOST_AUTO_TEST_CASE( states_are_kept_when_the_store_can_not_grow ) {
+        // each state takes more than the first mapping of the file
+        auto coupled = make_samplers();
+        std::vector<int> large(300000, 7);
+        for (int i = 0; i < 2; i++) {
+            std::dynamic_pointer_cast<sampler<double>>(coupled->_models[i])->state.samples = large;
+        }
+        auto atomic = [&coupled](int i) -> cadmium::dynamic::modeling::atomic_abstract<double>& {
+            return *std::dynamic_pointer_cast<cadmium::dynamic::modeling::atomic_abstract<double>>(coupled->_models[i]);
+        };
+        std::string path = (std::filesystem::temp_directory_path() / "cadmium_state_store_full_test.bin").string();
+        cadmium::dynamic::engine::state_store<double> store(path, 1);
+        std::size_t first = store.add(atomic(0), 1.0);
+
+        // the file can not grow beyond its first mapping
+        struct rlimit previous;
+        ::getrlimit(RLIMIT_FSIZE, &previous);
+        struct rlimit limited = previous;
+        limited.rlim_cur = 1 << 20;
+        auto handler = std::signal(SIGXFSZ, SIG_IGN);
+        ::setrlimit(RLIMIT_FSIZE, &limited);
+        BOOST_CHECK_THROW(store.add(atomic(1), 2.0), std::runtime_error);
+        ::setrlimit(RLIMIT_FSIZE, &previous);
+        std::signal(SIGXFSZ, handler);
+
+        BOOST_CHECK(store.resident(first));
+        BOOST_CHECK(samples_of(*coupled, 0) == large);
+        BOOST_CHECK_EQUAL(store.stats().page_outs, 0);
+
+        // the store is usable again once it can grow
+        std::size_t second = store.add(atomic(1), 2.0);
+        BOOST_CHECK(!store.resident(first));
+        BOOST_CHECK(samples_of(*coupled, 0).empty());
+        store.page_in(first);
+        store.release(first, 1.0);
+        BOOST_CHECK(!store.resident(second));
+        BOOST_CHECK(samples_of(*coupled, 0) == large);
+        store.page_in(second);
+        BOOST_CHECK(samples_of(*coupled, 1) == large);
+    }
+
+    BOOST_AUTO_TEST_CASE( state_store_needs_a_resident_state ) {
+        std::string path = (std::filesystem::temp_directory_path() / "cadmium_state_store_empty_test.bin").string();
+        BOOST_CHECK_THROW(cadmium::dynamic::engine::state_store<double>(path, 0), std::domain_error);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#define BOOST_TEST_DYN_LINK
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+
+#include <cadmium/engine/pdevs_dynamic_step_latency.hpp>
+
+using namespace std::chrono;
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_step_latency_test_suite )
+
+    BOOST_AUTO_TEST_CASE( latency_histogram_percentiles_are_within_its_precision_test ) {
+        cadmium::dynamic::engine::latency_histogram<> h;
+        BOOST_CHECK_EQUAL(h.percentile(0.5).count(), 0);
+        for (int i = 1; i <= 10000; i++) {
+            h.record(microseconds(i));
+        }
+        BOOST_CHECK_EQUAL(h.count(), 10000);
+        BOOST_CHECK_EQUAL(h.min().count(), 1000);
+        BOOST_CHECK_EQUAL(h.max().count(), 10000000);
+        BOOST_CHECK_CLOSE(static_cast<double>(h.mean().count()), 5000500.0, 0.01);
+        BOOST_CHECK_CLOSE(static_cast<double>(h.percentile(0.5).count()), 5000000.0, 2.0);
+        BOOST_CHECK_CLOSE(static_cast<double>(h.percentile(0.99).count()), 9900000.0, 2.0);
+        BOOST_CHECK_CLOSE(static_cast<double>(h.percentile(0.999).count()), 9990000.0, 2.0);
+        BOOST_CHECK_EQUAL(h.percentile(1.0).count(), 10000000);
+        BOOST_CHECK_THROW(h.percentile(1.5), std::domain_error);
+    }
+
+    BOOST_AUTO_TEST_CASE( latency_histogram_records_small_values_exactly_test ) {
+        cadmium::dynamic::engine::latency_histogram<> h;
+        for (int i = 0; i < 100; i++) {
+            h.record(nanoseconds(i));
+        }
+        BOOST_CHECK_EQUAL(h.percentile(0.5).count(), 49);
+        BOOST_CHECK_EQUAL(h.percentile(0.1).count(), 9);
+    }
+
+    BOOST_AUTO_TEST_CASE( step_latency_keeps_the_slowest_steps_test ) {
+        cadmium::dynamic::engine::step_latency<double> latency(2);
+        latency.record(1.0, nanoseconds(30));
+        latency.record(2.0, nanoseconds(10));
+        latency.record(3.0, nanoseconds(50));
+        latency.record(4.0, nanoseconds(20));
+        auto slowest = latency.slowest();
+        BOOST_REQUIRE_EQUAL(slowest.size(), 2);
+        BOOST_CHECK_EQUAL(slowest[0].time, 3.0);
+        BOOST_CHECK_EQUAL(slowest[1].time, 1.0);
+        BOOST_CHECK_EQUAL(latency.histogram().count(), 4);
+
+        std::ostringstream os;
+        cadmium::dynamic::engine::write_step_latency(os, latency);
+        BOOST_CHECK(os.str().find("steps=4 ") == 0);
+        BOOST_CHECK(os.str().find("slow_step time=3 ns=50\n") != std::string::npos);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_DYN_LINK
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+#include <cadmium/basic_model/generator.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_steps.hpp>
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_steps_test_suite )
+
+    struct steps_tick{};
+
+    using steps_out_port = cadmium::basic_models::generator_defs<steps_tick>::out;
+
+    template<typename TIME>
+    struct steps_generator : public cadmium::basic_models::generator<steps_tick, TIME> {
+        float period() const override {
+            return 1.0f;
+        }
+        steps_tick output_message() const override {
+            return steps_tick();
+        }
+    };
+
+    struct steps_coupled_out : public cadmium::out_port<steps_tick>{};
+
+    template<typename TIME>
+    using steps_coupled=cadmium::modeling::coupled_model<TIME, std::tuple<>, std::tuple<steps_coupled_out>,
+            cadmium::modeling::models_tuple<steps_generator>, std::tuple<>,
+            std::tuple<cadmium::modeling::EOC<steps_generator, steps_out_port, steps_coupled_out>>, std::tuple<>>;
+
+    using steps_runner = cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger>;
+
+    BOOST_AUTO_TEST_CASE( runner_steps_one_event_at_a_time_test ) {
+        steps_runner r(cadmium::dynamic::translate::make_dynamic_coupled_model<float, steps_coupled>(), 0.0);
+        BOOST_CHECK_EQUAL(r.next(), 1.0f);
+        BOOST_CHECK_EQUAL(r.step(), 2.0f);
+        BOOST_CHECK_EQUAL(r.step(), 3.0f);
+        BOOST_CHECK_EQUAL(r.next(), 3.0f);
+    }
+
+    BOOST_AUTO_TEST_CASE( runner_advances_to_a_time_including_its_events_test ) {
+        steps_runner r(cadmium::dynamic::translate::make_dynamic_coupled_model<float, steps_coupled>(), 0.0);
+        BOOST_CHECK_EQUAL(r.advance_to(0.5f), 1.0f);
+        BOOST_CHECK_EQUAL(r.advance_to(3.0f), 4.0f);
+        BOOST_CHECK_EQUAL(r.advance_to(3.5f), 4.0f);
+        // the steps continue a run where it stopped
+        BOOST_CHECK_EQUAL(r.run_until(6.0f), 6.0f);
+        BOOST_CHECK_EQUAL(r.advance_to(6.0f), 7.0f);
+    }
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+    BOOST_AUTO_TEST_CASE( step_generator_yields_after_each_event_test ) {
+        steps_runner r(cadmium::dynamic::translate::make_dynamic_coupled_model<float, steps_coupled>(), 0.0);
+        std::vector<float> times;
+        for (float t : cadmium::dynamic::engine::steps(r, 4.0f)) {
+            times.push_back(t);
+            // the event yielded already ran
+            BOOST_CHECK_EQUAL(r.next(), t + 1);
+        }
+        std::vector<float> expected{1.0f, 2.0f, 3.0f};
+        BOOST_CHECK_EQUAL_COLLECTIONS(times.begin(), times.end(), expected.begin(), expected.end());
+        BOOST_CHECK_EQUAL(r.next(), 4.0f);
+    }
+
+    BOOST_AUTO_TEST_CASE( step_generator_is_resumed_by_the_host_test ) {
+        steps_runner r(cadmium::dynamic::translate::make_dynamic_coupled_model<float, steps_coupled>(), 0.0);
+        auto steps = cadmium::dynamic::engine::steps(r);
+        // nothing runs before the first resume
+        BOOST_CHECK_EQUAL(r.next(), 1.0f);
+        BOOST_REQUIRE(steps.advance());
+        BOOST_CHECK_EQUAL(steps.time(), 1.0f);
+        BOOST_REQUIRE(steps.advance());
+        BOOST_CHECK_EQUAL(steps.time(), 2.0f);
+        BOOST_CHECK_EQUAL(r.next(), 3.0f);
+    }
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#define BOOST_TEST_DYN_LINK
+#include <set>
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <cadmium/basic_model/generator.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+
+BOOST_AUTO_TEST_SUITE( pdevs_dynamic_trace_zones_test_suite )
+
+    struct trace_tick{};
+
+    using trace_out_port = cadmium::basic_models::generator_defs<trace_tick>::out;
+
+    template<typename TIME>
+    struct trace_generator : public cadmium::basic_models::generator<trace_tick, TIME> {
+        float period() const override {
+            return 1.0f;
+        }
+        trace_tick output_message() const override {
+            return trace_tick();
+        }
+    };
+
+    struct trace_coupled_out : public cadmium::out_port<trace_tick>{};
+
+    template<typename TIME>
+    using trace_coupled=cadmium::modeling::coupled_model<TIME, std::tuple<>, std::tuple<trace_coupled_out>,
+            cadmium::modeling::models_tuple<trace_generator>, std::tuple<>,
+            std::tuple<cadmium::modeling::EOC<trace_generator, trace_out_port, trace_coupled_out>>, std::tuple<>>;
+
+    using recorder = cadmium::dynamic::engine::trace_recorder;
+
+    BOOST_AUTO_TEST_CASE( trace_zones_are_recorded_only_while_started_test ) {
+        auto coupled = cadmium::dynamic::translate::make_dynamic_coupled_model<float, trace_coupled>();
+        cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(coupled, 0.0);
+
+        recorder::instance().start();
+        recorder::instance().stop();
+        r.run_until(2.0);
+        BOOST_CHECK_EQUAL(recorder::instance().size(), 0);
+
+        recorder::instance().start();
+        r.run_until(4.0);
+        recorder::instance().stop();
+        // two steps of collect, output, routing, advance and internal transition
+        BOOST_CHECK_EQUAL(recorder::instance().size(), 2 * 7);
+    }
+
+    BOOST_AUTO_TEST_CASE( trace_zones_are_written_in_the_chrome_trace_format_test ) {
+        auto coupled = cadmium::dynamic::translate::make_dynamic_coupled_model<float, trace_coupled>();
+        cadmium::dynamic::engine::runner<float, cadmium::logger::not_logger> r(coupled, 0.0);
+
+        recorder::instance().start();
+        r.run_until(2.0);
+        recorder::instance().stop();
+
+        std::stringstream json;
+        recorder::instance().write_chrome_trace(json);
+        boost::property_tree::ptree trace;
+        boost::property_tree::read_json(json, trace);
+
+        std::set<std::string> names;
+        std::set<std::string> models;
+        for (const auto& e : trace.get_child("traceEvents")) {
+            names.insert(e.second.get<std::string>("name"));
+            BOOST_CHECK_EQUAL(e.second.get<std::string>("ph"), "X");
+            BOOST_CHECK(e.second.get<double>("dur") >= 0);
+            if (auto model = e.second.get_optional<std::string>("args.model")) {
+                models.insert(*model);
+            }
+        }
+        std::set<std::string> expected{"coordinator_collect_outputs", "coordinator_advance_simulation", "route_messages", "output", "internal_transition"};
+        BOOST_CHECK(names == expected);
+        BOOST_CHECK(models.count(coupled->get_id()) == 1);
+        BOOST_CHECK_EQUAL(models.size(), 2);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
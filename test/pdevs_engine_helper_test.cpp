@@ -92,5 +92,23 @@ BOOST_AUTO_TEST_CASE(get_engine_by_model_two_elements_get_last_test){
     auto eng_b=cadmium::engine::get_engine_by_model<floating_generator_b<float>, tuple_sim_gens>(st);
 }
 
+BOOST_AUTO_TEST_CASE(clear_bags_keeps_capacity_under_the_high_water_mark_test){
+    using in_bags=typename cadmium::make_message_bags<std::tuple<floating_accumulator_defs::add, floating_accumulator_defs::reset>>::type;
+    in_bags bags;
+    cadmium::get_messages<floating_accumulator_defs::add>(bags).assign(10, 1.0f);
+    cadmium::get_messages<floating_accumulator_defs::reset>(bags).resize(2000);
+
+    cadmium::engine::clear_bags(bags);
+    BOOST_CHECK(cadmium::engine::all_bags_empty(bags));
+    BOOST_CHECK_GE(cadmium::get_messages<floating_accumulator_defs::add>(bags).capacity(), 10);
+    // above the default high water mark the memory is released
+    BOOST_CHECK_EQUAL(cadmium::get_messages<floating_accumulator_defs::reset>(bags).capacity(), 0);
+
+    cadmium::set_bag_high_water_mark(0);
+    cadmium::get_messages<floating_accumulator_defs::add>(bags).push_back(1.0f);
+    cadmium::engine::clear_bags(bags);
+    BOOST_CHECK_EQUAL(cadmium::get_messages<floating_accumulator_defs::add>(bags).capacity(), 0);
+    cadmium::set_bag_high_water_mark(1024);
+}
 
 BOOST_AUTO_TEST_SUITE_END()
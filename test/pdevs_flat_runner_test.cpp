@@ -0,0 +1,201 @@
+/**
+ * Copyright (c) 2013-2017, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <cadmium/logger/tuple_to_ostream.hpp>
+#include <cadmium/basic_model/int_generator_one_sec.hpp>
+#include <cadmium/basic_model/reset_generator_five_sec.hpp>
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/engine/pdevs_runner.hpp>
+#include <cadmium/engine/pdevs_flat_runner.hpp>
+#include <mutex>
+#include <set>
+
+/**
+  This test suite checks the flat runner simulates the same as the runner on a model with
+  two levels of coupled models and the same atomic model type under different coupled models.
+  */
+
+BOOST_AUTO_TEST_SUITE( pdevs_flat_runner_test_suite )
+
+template<typename TIME>
+using test_accumulator=cadmium::basic_models::accumulator<int, TIME>;
+using test_accumulator_defs=cadmium::basic_models::accumulator_defs<int>;
+
+using empty_iports = std::tuple<>;
+using empty_eic=std::tuple<>;
+using empty_ic=std::tuple<>;
+
+//2 generators doing output in 2 ports
+using generators_oports=std::tuple<cadmium::basic_models::int_generator_one_sec_defs::out, cadmium::basic_models::reset_generator_five_sec_defs::out>;
+using generators_submodels=cadmium::modeling::models_tuple<cadmium::basic_models::reset_generator_five_sec, cadmium::basic_models::int_generator_one_sec>;
+using generators_eoc=std::tuple<
+cadmium::modeling::EOC<cadmium::basic_models::reset_generator_five_sec, cadmium::basic_models::reset_generator_five_sec_defs::out, cadmium::basic_models::reset_generator_five_sec_defs::out>,
+cadmium::modeling::EOC<cadmium::basic_models::int_generator_one_sec, cadmium::basic_models::int_generator_one_sec_defs::out, cadmium::basic_models::int_generator_one_sec_defs::out>
+>;
+
+template<typename TIME>
+using coupled_generators_model=cadmium::modeling::coupled_model<TIME, empty_iports, generators_oports, generators_submodels, empty_eic, generators_eoc, empty_ic>;
+
+//1 accumulator wrapped in a coupled model
+using accumulator_eic=std::tuple<
+cadmium::modeling::EIC<test_accumulator_defs::add, test_accumulator, test_accumulator_defs::add>,
+cadmium::modeling::EIC<test_accumulator_defs::reset, test_accumulator, test_accumulator_defs::reset>
+>;
+using accumulator_eoc=std::tuple<
+cadmium::modeling::EOC<test_accumulator, test_accumulator_defs::sum, test_accumulator_defs::sum>
+>;
+using accumulator_submodels=cadmium::modeling::models_tuple<test_accumulator>;
+
+template<typename TIME>
+using coupled_accumulator_model=cadmium::modeling::coupled_model<TIME, typename test_accumulator<TIME>::input_ports, typename test_accumulator<TIME>::output_ports, accumulator_submodels, accumulator_eic, accumulator_eoc, empty_ic>;
+
+//top model, the sums of the coupled accumulator are accumulated by a second accumulator never reset
+using top_outport = test_accumulator_defs::sum;
+using top_oports = std::tuple<top_outport>;
+using top_submodels=cadmium::modeling::models_tuple<coupled_generators_model, coupled_accumulator_model, test_accumulator>;
+using top_eoc=std::tuple<
+cadmium::modeling::EOC<coupled_accumulator_model, test_accumulator_defs::sum, top_outport>
+>;
+using top_ic=std::tuple<
+cadmium::modeling::IC<coupled_generators_model, cadmium::basic_models::int_generator_one_sec_defs::out, coupled_accumulator_model, test_accumulator_defs::add>,
+cadmium::modeling::IC<coupled_generators_model, cadmium::basic_models::reset_generator_five_sec_defs::out , coupled_accumulator_model, test_accumulator_defs::reset>,
+cadmium::modeling::IC<coupled_accumulator_model, test_accumulator_defs::sum, test_accumulator, test_accumulator_defs::add>
+>;
+
+template<typename TIME>
+using top_model=cadmium::modeling::coupled_model<TIME, empty_iports, top_oports, top_submodels, empty_eic, top_eoc, top_ic>;
+
+BOOST_AUTO_TEST_CASE( flat_couplings_link_atomic_models_directly_test )
+{
+    using couplings=cadmium::engine::flat_couplings<float, top_model>;
+    using leaves=couplings::leaves;
+    using links=couplings::links;
+
+    //reset generator, int generator, nested accumulator and top accumulator
+    BOOST_CHECK_EQUAL(std::tuple_size<leaves>::value, 4);
+    BOOST_CHECK((std::is_same<std::tuple_element<2, leaves>::type, cadmium::engine::model_path<1, 0>>::value));
+    BOOST_CHECK((std::is_same<couplings::leaf<3>::model<float>, test_accumulator<float>>::value));
+
+    //the EOC to the top output port is not routed
+    BOOST_CHECK((std::is_same<links, std::tuple<
+            cadmium::engine::flat_link<0, cadmium::basic_models::reset_generator_five_sec_defs::out, 2, test_accumulator_defs::reset>,
+            cadmium::engine::flat_link<1, cadmium::basic_models::int_generator_one_sec_defs::out, 2, test_accumulator_defs::add>,
+            cadmium::engine::flat_link<2, test_accumulator_defs::sum, 3, test_accumulator_defs::add>
+    >>::value));
+}
+
+namespace {
+    std::ostringstream oss;
+
+    struct oss_test_sink_provider{
+        static std::ostream& sink(){
+            return oss;
+        }
+    };
+}
+
+BOOST_AUTO_TEST_CASE( flat_runner_logs_the_same_states_than_runner_test )
+{
+    using log_states_to_oss=cadmium::logger::logger<cadmium::logger::logger_state, cadmium::logger::formatter<float>, oss_test_sink_provider>;
+
+    oss.str("");
+    cadmium::engine::runner<float, top_model, log_states_to_oss> r{0.0};
+    float runner_next = r.run_until(22.0);
+    std::string runner_states = oss.str();
+
+    oss.str("");
+    cadmium::engine::flat_runner<float, top_model, log_states_to_oss> fr{0.0};
+    float flat_runner_next = fr.run_until(22.0);
+    std::string flat_runner_states = oss.str();
+
+    BOOST_CHECK_EQUAL(runner_next, flat_runner_next);
+    BOOST_CHECK_EQUAL(runner_states, flat_runner_states);
+    //the top accumulator received the sums of the 4 resets
+    BOOST_CHECK(flat_runner_states.find("is [20, 0]") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE( flat_runner_routes_messages_between_atomic_models_test )
+{
+    using log_routing_to_oss=cadmium::logger::logger<cadmium::logger::logger_message_routing, cadmium::logger::formatter<float>, oss_test_sink_provider>;
+
+    oss.str("");
+    cadmium::engine::flat_runner<float, top_model, log_routing_to_oss> fr{0.0};
+    fr.run_until(2.0);
+
+    //only the int generator outputs at time 1, routed straight to the nested accumulator
+    std::ostringstream expected_oss;
+    expected_oss << " in port ";
+    expected_oss << boost::typeindex::type_id<test_accumulator_defs::add>().pretty_name();
+    expected_oss << " of model ";
+    expected_oss << boost::typeindex::type_id<test_accumulator<float>>().pretty_name();
+    expected_oss << " has {1} routed from ";
+    expected_oss << boost::typeindex::type_id<cadmium::basic_models::int_generator_one_sec_defs::out>().pretty_name();
+    expected_oss << " of model ";
+    expected_oss << boost::typeindex::type_id<cadmium::basic_models::int_generator_one_sec<float>>().pretty_name();
+    expected_oss << " with messages {1}\n";
+    BOOST_CHECK_EQUAL(oss.str(), expected_oss.str());
+}
+
+namespace {
+    //collects the states logged from any thread, their order depends on the threads
+    std::mutex states_mutex;
+    std::multiset<std::string> logged_states;
+
+    struct locked_state_logger {
+        template<typename DECLARED_SOURCE>
+        static constexpr bool enabled = std::is_same<DECLARED_SOURCE, cadmium::logger::logger_state>::value;
+
+        template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
+        static void log(const PARAMs&... ps) {
+            if constexpr (enabled<DECLARED_SOURCE>) {
+                std::lock_guard<std::mutex> lock(states_mutex);
+                logged_states.insert(cadmium::logger::event_format<EVENT>::template format<cadmium::logger::formatter<float>>(ps...));
+            }
+        }
+    };
+}
+
+BOOST_AUTO_TEST_CASE( runners_in_parallel_log_the_same_states_test )
+{
+    logged_states.clear();
+    cadmium::engine::runner<float, top_model, locked_state_logger> sequential{0.0};
+    float sequential_next = sequential.run_until(22.0);
+    std::multiset<std::string> sequential_states = logged_states;
+
+    logged_states.clear();
+    cadmium::engine::runner<float, top_model, locked_state_logger, cadmium::engine::parallel_execution> parallel{0.0, cadmium::engine::parallel_execution(4)};
+    BOOST_CHECK_EQUAL(parallel.run_until(22.0), sequential_next);
+    BOOST_CHECK(logged_states == sequential_states);
+
+    logged_states.clear();
+    cadmium::engine::flat_runner<float, top_model, locked_state_logger, cadmium::engine::work_stealing_execution> flat{0.0, cadmium::engine::work_stealing_execution(4, 1, 2)};
+    BOOST_CHECK_EQUAL(flat.run_until(22.0), sequential_next);
+    BOOST_CHECK(logged_states == sequential_states);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -31,6 +31,7 @@
 #include <cadmium/basic_model/reset_generator_five_sec.hpp>
 #include <cadmium/basic_model/generator.hpp>
 #include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/basic_model/passive.hpp>
 #include <cadmium/modeling/coupled_model.hpp>
 #include <cadmium/engine/pdevs_runner.hpp>
 
@@ -274,6 +275,33 @@ BOOST_AUTO_TEST_CASE( simulation_logs_routing_of_eoc_in_coordinator_test )
 
 
 
+//2 generators with different periods and no couplings
+using two_periods_submodels=cadmium::modeling::models_tuple<cadmium::basic_models::reset_generator_five_sec, cadmium::basic_models::int_generator_one_sec>;
+template<typename TIME>
+using two_periods_model=cadmium::modeling::coupled_model<TIME, std::tuple<>, std::tuple<>, two_periods_submodels, std::tuple<>, std::tuple<>, std::tuple<>>;
+
+BOOST_AUTO_TEST_CASE( only_imminent_simulators_advance_test )
+{
+    oss.str("");
+    using log_info_to_oss=cadmium::logger::logger<cadmium::logger::logger_info, cadmium::logger::formatter<float>, oss_test_sink_provider>;
+
+    cadmium::engine::runner<float, two_periods_model, log_info_to_oss> r{0.0};
+    r.run_until(10.0);
+
+    auto advances_of = [](const std::string& model_id) {
+        std::string log = oss.str();
+        std::string line = "Simulator for model " + model_id + " advancing simulation";
+        int count = 0;
+        for (auto pos = log.find(line); pos != std::string::npos; pos = log.find(line, pos + 1)) {
+            ++count;
+        }
+        return count;
+    };
+    //9 steps, the five seconds generator is only imminent in one of them
+    BOOST_CHECK_EQUAL(advances_of(boost::typeindex::type_id<cadmium::basic_models::int_generator_one_sec<float>>().pretty_name()), 9);
+    BOOST_CHECK_EQUAL(advances_of(boost::typeindex::type_id<cadmium::basic_models::reset_generator_five_sec<float>>().pretty_name()), 1);
+}
+
 //2 generators connected to an infinite_counter are coordinated and routing messages correctly
 //connecting generators to acumm coupled model definition
 
@@ -356,5 +384,117 @@ BOOST_AUTO_TEST_CASE( simulation_logs_routing_of_all_couplings_in_coordinator_te
 
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE( disabled_log_sources_cost_test_suite )
+
+//the messages and states count how many times they are formatted
+namespace {
+    int formatted = 0;
+    std::ostringstream counted_oss;
+
+    struct counted_sink_provider{
+        static std::ostream& sink(){
+            return counted_oss;
+        }
+    };
+}
+
+struct counted_message {};
+
+std::ostream& operator<<(std::ostream& os, const counted_message&) {
+    ++formatted;
+    return os << "counted";
+}
+
+//ticks a counted message every second, its state is counted too when formatted
+template<typename TIME>
+struct counted_ticker {
+    struct counted_state {
+        int ticks = 0;
+    };
+
+    friend std::ostream& operator<<(std::ostream& os, const counted_state& s) {
+        ++formatted;
+        return os << s.ticks;
+    }
+
+    struct out : public cadmium::out_port<counted_message> {};
+
+    using state_type=counted_state;
+    state_type state;
+
+    using input_ports=std::tuple<>;
+    using output_ports=std::tuple<out>;
+
+    void internal_transition() {
+        ++state.ticks;
+    }
+
+    void external_transition(TIME e, typename cadmium::make_message_bags<input_ports>::type mbs) {}
+
+    void confluence_transition(TIME e, typename cadmium::make_message_bags<input_ports>::type mbs) {}
+
+    typename cadmium::make_message_bags<output_ports>::type output() const {
+        typename cadmium::make_message_bags<output_ports>::type bags;
+        cadmium::get_messages<out>(bags).emplace_back();
+        return bags;
+    }
+
+    TIME time_advance() const {
+        return TIME{1};
+    }
+};
+
+template<typename TIME>
+using counted_receiver=cadmium::basic_models::passive<counted_message, TIME>;
+using counted_receiver_in=cadmium::basic_models::passive_defs<counted_message>::in;
+
+struct counted_out_port : public cadmium::out_port<counted_message>{};
+using counted_submodels=cadmium::modeling::models_tuple<counted_ticker, counted_receiver>;
+using counted_eocs=std::tuple<
+    cadmium::modeling::EOC<counted_ticker, counted_ticker<float>::out, counted_out_port>
+>;
+using counted_ics=std::tuple<
+    cadmium::modeling::IC<counted_ticker, counted_ticker<float>::out, counted_receiver, counted_receiver_in>
+>;
+
+template<typename TIME>
+using counted_model=cadmium::modeling::coupled_model<TIME, std::tuple<>, std::tuple<counted_out_port>, counted_submodels, std::tuple<>, counted_eocs, counted_ics>;
+
+template<typename LOGGER>
+int formatted_running_counted_model() {
+    formatted = 0;
+    cadmium::engine::runner<float, counted_model, LOGGER> r{0.0};
+    r.run_until(10.0);
+    return formatted;
+}
+
+BOOST_AUTO_TEST_CASE( disabled_sources_are_not_formatted_test )
+{
+    static_assert(!cadmium::logger::logs_any_source<cadmium::logger::not_logger>::value, "not_logger logs no source");
+
+    BOOST_CHECK_EQUAL(formatted_running_counted_model<cadmium::logger::not_logger>(), 0);
+
+    //only the global time is logged, no state or message is formatted for the disabled sources
+    counted_oss.str("");
+    using log_gt_to_oss=cadmium::logger::logger<cadmium::logger::logger_global_time, cadmium::logger::formatter<float>, counted_sink_provider>;
+    BOOST_CHECK_EQUAL(formatted_running_counted_model<log_gt_to_oss>(), 0);
+    BOOST_CHECK(!counted_oss.str().empty());
+}
+
+BOOST_AUTO_TEST_CASE( enabled_sources_are_formatted_test )
+{
+    using log_state_to_oss=cadmium::logger::logger<cadmium::logger::logger_state, cadmium::logger::formatter<float>, counted_sink_provider>;
+    using log_routing_to_oss=cadmium::logger::logger<cadmium::logger::logger_message_routing, cadmium::logger::formatter<float>, counted_sink_provider>;
+
+    //initial state and 9 transitions
+    counted_oss.str("");
+    BOOST_CHECK_EQUAL(formatted_running_counted_model<log_state_to_oss>(), 10);
+    //9 messages, routed by the EOC and the IC, are formatted in the origin and destination bags
+    counted_oss.str("");
+    BOOST_CHECK_EQUAL(formatted_running_counted_model<log_routing_to_oss>(), 36);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE_END()
 
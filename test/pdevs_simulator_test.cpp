@@ -110,6 +110,29 @@ BOOST_AUTO_TEST_CASE( accumulator_model_simulation_test )
     BOOST_CHECK(s.next() == std::numeric_limits<float>::infinity());
 }
 
+BOOST_AUTO_TEST_CASE( accumulator_boxes_are_accessed_by_reference_test )
+{
+    using simulator_t=cadmium::engine::simulator<int_accumulator, float, cadmium::logger::not_logger>;
+    simulator_t s;
+    s.init(0.0f);
+
+    //messages routed in place into the inbox are processed by the next advance
+    cadmium::get_messages<int_accumulator_defs::add>(s.inbox()).assign(std::initializer_list<int>{1, 2, 3});
+    cadmium::get_messages<int_accumulator_defs::reset>(s.inbox()).emplace_back();
+    s.advance_simulation(1.0f);
+    BOOST_CHECK(cadmium::engine::all_bags_empty(s.inbox()));
+    BOOST_CHECK(s.next() == 1.0f);
+
+    //the outbox is the simulator one, not a copy
+    s.collect_outputs(1.0f);
+    const simulator_t& cs = s;
+    BOOST_CHECK_EQUAL(&cs.outbox(), &s.outbox());
+    BOOST_REQUIRE(cadmium::get_messages<int_accumulator_defs::sum>(cs.outbox()).size() == 1);
+    BOOST_CHECK(cadmium::get_messages<int_accumulator_defs::sum>(cs.outbox()).at(0) == 6);
+    s.advance_simulation(1.0f);
+    BOOST_CHECK(cadmium::engine::all_bags_empty(cs.outbox()));
+}
+
 BOOST_AUTO_TEST_CASE( accumulator_simulation_throws_test ){
     //construct a simulator for an accumulator
     using simulator_t= cadmium::engine::simulator<int_accumulator, float, cadmium::logger::not_logger>;
@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+#include <string>
+#include <cadmium/modeling/random_streams.hpp>
+
+BOOST_AUTO_TEST_SUITE( random_streams_test_suite )
+
+    BOOST_AUTO_TEST_CASE( split_seeds_depend_only_on_the_seed_and_the_key_test ) {
+        BOOST_CHECK_EQUAL(cadmium::split_seed(42, std::string("top/generator")), cadmium::split_seed(42, std::string("top/generator")));
+        BOOST_CHECK(cadmium::split_seed(42, std::string("top/generator")) != cadmium::split_seed(43, std::string("top/generator")));
+
+        std::set<std::uint64_t> seeds;
+        for (std::uint64_t i = 0; i < 1000; i++) {
+            seeds.insert(cadmium::split_seed(42, i));
+            seeds.insert(cadmium::split_seed(42, "model_" + std::to_string(i)));
+        }
+        BOOST_CHECK_EQUAL(seeds.size(), 2000);
+    }
+
+    BOOST_AUTO_TEST_CASE( model_random_engines_draw_independent_streams_test ) {
+        auto a = cadmium::model_random_engine(7, "a");
+        auto b = cadmium::model_random_engine(7, "b");
+        auto a_again = cadmium::model_random_engine(7, "a");
+        // drawing from b does not change the stream of a
+        b();
+        BOOST_CHECK(a() == a_again());
+        BOOST_CHECK(a() != b());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
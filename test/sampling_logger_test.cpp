@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2013-2017, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+#include <cadmium/logger/logger.hpp>
+#include <cadmium/logger/sampling_logger.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include <cadmium/logger/dynamic_common_loggers.hpp>
+
+namespace {
+    std::ostringstream oss;
+
+    struct oss_sink_provider{
+        static std::ostream& sink(){
+            return oss;
+        }
+    };
+
+    using state_logger=cadmium::logger::logger<cadmium::logger::logger_state, cadmium::dynamic::logger::formatter<float>, oss_sink_provider>;
+    using static_state_logger=cadmium::logger::logger<cadmium::logger::logger_state, cadmium::logger::formatter<float>, oss_sink_provider>;
+
+    template<typename LOGGER>
+    void log_states(const std::string& model_id, int count) {
+        for (int i = 0; i < count; i++) {
+            LOGGER::template log<cadmium::logger::logger_state, cadmium::logger::sim_state>(static_cast<float>(i), model_id, std::to_string(i));
+        }
+    }
+
+    std::size_t lines() {
+        std::string s = oss.str();
+        return static_cast<std::size_t>(std::count(s.begin(), s.end(), '\n'));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( sampling_logger_test_suite )
+
+BOOST_AUTO_TEST_CASE( every_kth_state_is_sampled_by_model_test )
+{
+    oss.str("");
+    struct tag{};
+    using l=cadmium::logger::sampling_logger<state_logger, cadmium::logger::every_kth_state<3, tag>>;
+
+    log_states<l>("a", 7);
+    log_states<l>("b", 2);
+    BOOST_CHECK_EQUAL(lines(), 4); // a: 0, 3, 6 and b: 0
+    BOOST_CHECK(oss.str().find("State for model a is 3") != std::string::npos);
+
+    // the other events are not sampled
+    oss.str("");
+    l::log<cadmium::logger::logger_state, cadmium::logger::sim_info_init>(0.0f, std::string("a"));
+    l::log<cadmium::logger::logger_state, cadmium::logger::sim_info_init>(0.0f, std::string("a"));
+    BOOST_CHECK_EQUAL(lines(), 2);
+    BOOST_CHECK(l::enabled<cadmium::logger::logger_state>);
+    BOOST_CHECK(!l::enabled<cadmium::logger::logger_info>);
+}
+
+BOOST_AUTO_TEST_CASE( states_are_sampled_by_time_window_test )
+{
+    oss.str("");
+    struct tag{};
+    using window=cadmium::logger::state_time_window<float, tag>;
+    using l=cadmium::logger::sampling_logger<state_logger, window>;
+    window::set_window(2.5f);
+
+    log_states<l>("a", 10); // 0, 3, 6, 9
+    BOOST_CHECK_EQUAL(lines(), 4);
+
+    // the static simulators states have no time
+    oss.str("");
+    using static_l=cadmium::logger::sampling_logger<static_state_logger, window>;
+    static_l::log<cadmium::logger::logger_state, cadmium::logger::sim_state>(std::string("state"), std::string("a"));
+    BOOST_CHECK_EQUAL(lines(), 1);
+}
+
+BOOST_AUTO_TEST_CASE( states_are_filtered_by_model_id_prefix_test )
+{
+    oss.str("");
+    struct tag{};
+    using prefixes=cadmium::logger::model_id_prefixes<tag>;
+    using l=cadmium::logger::sampling_logger<state_logger, prefixes, cadmium::logger::every_kth_state<2, tag>>;
+
+    log_states<l>("generator", 1);
+    BOOST_CHECK_EQUAL(lines(), 0);
+
+    prefixes::set_prefixes({"gen", "processor_1"});
+    log_states<l>("generator", 4);
+    log_states<l>("processor_1", 1);
+    log_states<l>("processor_2", 4);
+    // the counter only sees the states of the accepted models
+    BOOST_CHECK_EQUAL(lines(), 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <sstream>
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+#include <cadmium/modeling/shared_payload.hpp>
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/logger/common_loggers_helpers.hpp>
+
+BOOST_AUTO_TEST_SUITE( shared_payload_test_suite )
+
+    using payload = cadmium::shared_payload<std::string>;
+
+    struct broadcast_out : public cadmium::out_port<payload> {};
+    struct sensor_in_0 : public cadmium::in_port<payload> {};
+    struct sensor_in_1 : public cadmium::in_port<payload> {};
+    struct sensor_in_2 : public cadmium::in_port<payload> {};
+
+    BOOST_AUTO_TEST_CASE( shared_payload_copies_share_the_payload_test ) {
+        payload p = cadmium::make_shared_payload<std::string>("reading");
+        payload q = p;
+        BOOST_CHECK(q.get() == p.get());
+        BOOST_CHECK_EQUAL(p.use_count(), 2);
+        BOOST_CHECK_EQUAL(*q, "reading");
+        BOOST_CHECK_EQUAL(q->size(), 7);
+        BOOST_CHECK(q == payload(std::string("reading")));
+        BOOST_CHECK(q != payload(std::string("other")));
+        BOOST_CHECK(!payload());
+    }
+
+    BOOST_AUTO_TEST_CASE( fan_out_links_route_the_same_payload_test ) {
+        std::vector<std::shared_ptr<cadmium::dynamic::engine::link_abstract>> links = {
+                cadmium::dynamic::translate::make_link<broadcast_out, sensor_in_0>(),
+                cadmium::dynamic::translate::make_link<broadcast_out, sensor_in_1>(),
+                cadmium::dynamic::translate::make_link<broadcast_out, sensor_in_2>()
+        };
+
+        cadmium::message_bag<broadcast_out> out;
+        out.messages.push_back(payload(std::string(1000, 'x')));
+        const std::string* shared = out.messages.front().get();
+        cadmium::dynamic::message_bags bags_from;
+        bags_from[typeid(broadcast_out)] = out;
+        out.messages.clear();
+
+        cadmium::dynamic::message_bags bags_to;
+        for (const auto& l : links) {
+            l->route_messages(bags_from, bags_to);
+        }
+
+        BOOST_CHECK(cadmium::dynamic::bag_cast<cadmium::message_bag<sensor_in_0>&>(bags_to.at(typeid(sensor_in_0))).messages.front().get() == shared);
+        BOOST_CHECK(cadmium::dynamic::bag_cast<cadmium::message_bag<sensor_in_1>&>(bags_to.at(typeid(sensor_in_1))).messages.front().get() == shared);
+        BOOST_CHECK(cadmium::dynamic::bag_cast<cadmium::message_bag<sensor_in_2>&>(bags_to.at(typeid(sensor_in_2))).messages.front().get() == shared);
+        BOOST_CHECK_EQUAL(cadmium::dynamic::bag_cast<cadmium::message_bag<sensor_in_2>&>(bags_to.at(typeid(sensor_in_2))).messages.front().use_count(), 4);
+    }
+
+    BOOST_AUTO_TEST_CASE( shared_payload_is_logged_and_serialized_as_its_payload_test ) {
+        cadmium::bag<payload> messages = {payload(std::string("a")), payload()};
+        BOOST_CHECK((cadmium::logger::messages_as_strings(messages) == std::vector<std::string>{"a", "null"}));
+
+        std::string buffer;
+        cadmium::bag<payload> sent = {payload(std::string("hello"))};
+        cadmium::dynamic::engine::message_serializer<payload>::write(sent, buffer);
+        cadmium::bag<payload> received;
+        const char* data = buffer.data();
+        cadmium::dynamic::engine::message_serializer<payload>::read(data, buffer.data() + buffer.size(), received);
+        BOOST_CHECK(received == sent);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
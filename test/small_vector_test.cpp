@@ -0,0 +1,211 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <iterator>
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+#include <cadmium/modeling/small_vector.hpp>
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_dynamic_message_serializer.hpp>
+
+// allocator counting the allocations made by the small vectors
+template<typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    static int& allocations() {
+        static int count = 0;
+        return count;
+    }
+
+    counting_allocator() = default;
+
+    template<typename U>
+    counting_allocator(const counting_allocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        allocations()++;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) {
+        std::allocator<T>().deallocate(p, n);
+    }
+};
+
+template<typename T, typename U>
+bool operator==(const counting_allocator<T>&, const counting_allocator<U>&) { return true; }
+
+template<typename T, typename U>
+bool operator!=(const counting_allocator<T>&, const counting_allocator<U>&) { return false; }
+
+// message sent one at a time, its bags keep it inline
+struct inline_tick {
+    int value;
+};
+
+namespace cadmium {
+    template<>
+    struct inline_messages<inline_tick> : std::integral_constant<std::size_t, 1> {};
+
+    template<>
+    struct message_allocator<inline_tick> {
+        using type = counting_allocator<inline_tick>;
+    };
+}
+
+BOOST_AUTO_TEST_SUITE( small_vector_test_suite )
+
+    using small_ints = cadmium::small_vector<int, 2, counting_allocator<int>>;
+
+    BOOST_AUTO_TEST_CASE( small_vector_does_not_allocate_up_to_its_inline_capacity_test ) {
+        counting_allocator<int>::allocations() = 0;
+        small_ints v;
+        BOOST_CHECK(v.empty());
+        BOOST_CHECK_EQUAL(v.capacity(), 2);
+        v.push_back(1);
+        v.emplace_back(2);
+        BOOST_CHECK(v.is_inline());
+        BOOST_CHECK_EQUAL(counting_allocator<int>::allocations(), 0);
+        BOOST_CHECK((std::vector<int>(v.begin(), v.end()) == std::vector<int>{1, 2}));
+
+        v.clear();
+        v.push_back(3);
+        BOOST_CHECK(v.is_inline());
+        BOOST_CHECK_EQUAL(counting_allocator<int>::allocations(), 0);
+    }
+
+    BOOST_AUTO_TEST_CASE( small_vector_spills_to_the_allocator_beyond_its_inline_capacity_test ) {
+        counting_allocator<int>::allocations() = 0;
+        small_ints v{1, 2};
+        v.push_back(v.front());
+        BOOST_CHECK(!v.is_inline());
+        BOOST_CHECK_EQUAL(v.size(), 3);
+        BOOST_CHECK_EQUAL(v[2], 1);
+
+        // the spilt storage is kept when cleared and released when shrunk back inline
+        v.clear();
+        v.push_back(4);
+        BOOST_CHECK(!v.is_inline());
+        v.shrink_to_fit();
+        BOOST_CHECK(v.is_inline());
+        BOOST_CHECK_EQUAL(v.front(), 4);
+        BOOST_CHECK_EQUAL(counting_allocator<int>::allocations(), 1);
+    }
+
+    BOOST_AUTO_TEST_CASE( small_vector_copies_moves_and_swaps_inline_and_spilt_elements_test ) {
+        small_ints in{1};
+        small_ints out{1, 2, 3, 4};
+        const int* buffer = out.data();
+
+        small_ints copy(out);
+        BOOST_CHECK(copy == out);
+        BOOST_CHECK(copy.data() != buffer);
+
+        small_ints moved(std::move(out));
+        BOOST_CHECK(moved.data() == buffer);
+        BOOST_CHECK(out.empty());
+        BOOST_CHECK(out.is_inline());
+
+        moved.swap(in);
+        BOOST_CHECK((moved == small_ints{1}));
+        BOOST_CHECK(in.data() == buffer);
+        BOOST_CHECK((in == small_ints{1, 2, 3, 4}));
+
+        in.insert(in.begin() + 1, {7, 8});
+        BOOST_CHECK((in == small_ints{1, 7, 8, 2, 3, 4}));
+        in.erase(in.begin(), in.begin() + 2);
+        BOOST_CHECK((in == small_ints{8, 2, 3, 4}));
+        moved.insert(moved.end(), std::make_move_iterator(in.begin()), std::make_move_iterator(in.end()));
+        BOOST_CHECK((moved == small_ints{1, 8, 2, 3, 4}));
+    }
+
+    BOOST_AUTO_TEST_CASE( small_vector_of_strings_destroys_its_elements_test ) {
+        cadmium::small_vector<std::string, 1> v;
+        v.push_back("a long string that does not fit in the small string buffer");
+        v.push_back("b");
+        v.resize(1);
+        BOOST_CHECK_EQUAL(v.size(), 1);
+        BOOST_CHECK_EQUAL(v[0], "a long string that does not fit in the small string buffer");
+        cadmium::small_vector<std::string, 1> other{"c"};
+        v = std::move(other);
+        BOOST_CHECK_EQUAL(v.size(), 1);
+        BOOST_CHECK_EQUAL(v[0], "c");
+    }
+
+    struct tick_out : public cadmium::out_port<inline_tick> {};
+    struct tick_in : public cadmium::in_port<inline_tick> {};
+    struct int_in : public cadmium::in_port<int> {};
+
+    BOOST_AUTO_TEST_CASE( message_bags_store_inline_messages_in_small_vectors_test ) {
+        BOOST_CHECK((std::is_same<decltype(cadmium::message_bag<tick_in>::messages), cadmium::small_vector<inline_tick, 1, counting_allocator<inline_tick>>>::value));
+        BOOST_CHECK((std::is_same<decltype(cadmium::message_bag<int_in>::messages), std::vector<int>>::value));
+
+        counting_allocator<inline_tick>::allocations() = 0;
+        cadmium::message_bag<tick_in> b;
+        b.messages.push_back(inline_tick{1});
+        BOOST_CHECK(b.clear());
+        BOOST_CHECK_EQUAL(counting_allocator<inline_tick>::allocations(), 0);
+    }
+
+    BOOST_AUTO_TEST_CASE( inline_messages_are_routed_through_dynamic_links_test ) {
+        auto link = cadmium::dynamic::translate::make_link<tick_out, tick_in>();
+
+        cadmium::dynamic::message_bags from;
+        cadmium::dynamic::message_bags to;
+        counting_allocator<inline_tick>::allocations() = 0;
+        from.get_bag<cadmium::message_bag<tick_out>>(typeid(tick_out)).messages.push_back(inline_tick{5});
+        link->route_messages(from, to);
+        link->move_messages(from, to);
+
+        auto& received = to.get_bag<cadmium::message_bag<tick_in>>(typeid(tick_in)).messages;
+        BOOST_CHECK_EQUAL(received.size(), 2);
+        BOOST_CHECK_EQUAL(received[0].value, 5);
+        BOOST_CHECK_EQUAL(received[1].value, 5);
+        // only the second message delivered to the input spills
+        BOOST_CHECK_EQUAL(counting_allocator<inline_tick>::allocations(), 1);
+    }
+
+    BOOST_AUTO_TEST_CASE( inline_messages_are_serialized_test ) {
+        cadmium::bag<inline_tick> sent{inline_tick{1}, inline_tick{2}};
+        std::string buffer;
+        cadmium::dynamic::engine::message_serializer<inline_tick>::write(sent, buffer);
+
+        cadmium::bag<inline_tick> received;
+        const char* data = buffer.data();
+        cadmium::dynamic::engine::message_serializer<inline_tick>::read(data, buffer.data() + buffer.size(), received);
+        BOOST_CHECK_EQUAL(received.size(), 2);
+        BOOST_CHECK_EQUAL(received[1].value, 2);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
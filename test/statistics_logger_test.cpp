@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <sstream>
+
+#include <cadmium/basic_model/generator.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/logger/statistics_logger.hpp>
+
+BOOST_AUTO_TEST_SUITE( statistics_logger_test_suite )
+
+    struct test_statistics_tick {};
+
+    using test_statistics_out = cadmium::basic_models::generator_defs<test_statistics_tick>::out;
+
+    template<typename TIME>
+    struct test_statistics_generator : public cadmium::basic_models::generator<test_statistics_tick, TIME> {
+        float period() const override {
+            return 1.0f;
+        }
+        test_statistics_tick output_message() const override {
+            return test_statistics_tick();
+        }
+    };
+
+    struct test_statistics_coupled_out : public cadmium::out_port<test_statistics_tick> {};
+
+    template<typename TIME>
+    using test_statistics_coupled = cadmium::modeling::coupled_model<TIME, std::tuple<>, std::tuple<test_statistics_coupled_out>,
+            cadmium::modeling::models_tuple<test_statistics_generator>, std::tuple<>,
+            std::tuple<cadmium::modeling::EOC<test_statistics_generator, test_statistics_out, test_statistics_coupled_out>>, std::tuple<>>;
+
+    struct test_statistics_tag {};
+    using test_logger = cadmium::logger::statistics_logger<test_statistics_tag>;
+
+    BOOST_AUTO_TEST_CASE( log2_histogram_buckets_by_powers_of_two_test ) {
+        cadmium::logger::log2_histogram h;
+        h.add(0);
+        h.add(1);
+        h.add(1.5);
+        h.add(8);
+        BOOST_CHECK_EQUAL(h.count, 4);
+        BOOST_CHECK_EQUAL(h.mean(), 10.5 / 4);
+        BOOST_CHECK_EQUAL(h.min, 0);
+        BOOST_CHECK_EQUAL(h.max, 8);
+        BOOST_CHECK_EQUAL(h.buckets[0], 1);
+        std::size_t one = cadmium::logger::log2_histogram::bucket_of(1);
+        BOOST_CHECK_EQUAL(h.buckets[one], 2);
+        BOOST_CHECK_EQUAL(cadmium::logger::log2_histogram::bucket_limit(one), 2);
+        BOOST_CHECK_EQUAL(h.buckets[cadmium::logger::log2_histogram::bucket_of(8)], 1);
+        BOOST_CHECK_EQUAL(cadmium::logger::log2_histogram::bucket_of(1e300), cadmium::logger::log2_histogram::buckets_size - 1);
+    }
+
+    BOOST_AUTO_TEST_CASE( statistics_logger_reduces_the_run_events_test ) {
+        static_assert(!cadmium::logger::logs_source<test_logger, cadmium::logger::logger_state>::value, "The states are not formatted");
+        static_assert(cadmium::logger::counts_messages<test_logger>::value, "The messages are counted");
+        test_logger::reset();
+
+        auto coupled = cadmium::dynamic::translate::make_dynamic_coupled_model<float, test_statistics_coupled>();
+        cadmium::dynamic::engine::runner<float, test_logger> r(coupled, 0.0);
+        r.run_until(3.0);
+
+        cadmium::logger::statistics_summary summary = test_logger::summary();
+        // the initial time and the steps at 1 and 2
+        BOOST_CHECK_EQUAL(summary.global_times, 3);
+
+        const std::string generator_id = cadmium::dynamic::translate::make_dynamic_atomic_model<test_statistics_generator, float>()->get_id();
+        auto generator = std::find_if(summary.models.begin(), summary.models.end(), [&](const auto& m) { return m.model_id == generator_id; });
+        BOOST_REQUIRE(generator != summary.models.end());
+        BOOST_CHECK(!generator->coordinator);
+        BOOST_CHECK_EQUAL(generator->collects, 2);
+        BOOST_CHECK_EQUAL(generator->advances, 2);
+        BOOST_CHECK_EQUAL(generator->elapsed.mean(), 1);
+        BOOST_CHECK(std::any_of(summary.models.begin(), summary.models.end(), [](const auto& m) { return m.coordinator; }));
+
+        BOOST_REQUIRE_EQUAL(summary.ports.size(), 1);
+        BOOST_CHECK_EQUAL(summary.ports[0].model_id, generator_id);
+        BOOST_CHECK(summary.ports[0].output);
+        BOOST_CHECK(summary.ports[0].port.find("out") != std::string::npos);
+        BOOST_CHECK_EQUAL(summary.ports[0].messages, 2);
+        BOOST_CHECK_EQUAL(summary.ports[0].bag_sizes.mean(), 1);
+
+        std::ostringstream json;
+        test_logger::write_summary_json(json);
+        BOOST_CHECK(json.str().find("\"global_times\": 3") != std::string::npos);
+
+        test_logger::reset();
+        BOOST_CHECK_EQUAL(test_logger::summary().global_times, 0);
+        BOOST_CHECK(test_logger::summary().models.empty());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,185 @@
+/**
+ * Copyright (c) 2018, Laouen M. L. Belloli, Damian Vicino
+ * Carleton University, Universidad de Buenos Aires, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <limits>
+#include <cstdint>
+#include <sstream>
+#include <cadmium/modeling/tick_time.hpp>
+#include <cadmium/basic_model/accumulator.hpp>
+#include <cadmium/basic_model/int_generator_one_sec.hpp>
+#include <cadmium/basic_model/reset_generator_five_sec.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_runner.hpp>
+#include <cadmium/engine/pdevs_dynamic_fel.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+
+#include "count_fives_model.hpp"
+
+BOOST_AUTO_TEST_SUITE( tick_time_test_suite )
+
+    using ms_time = cadmium::tick_time<>;
+    using us_time = cadmium::tick_time<std::micro>;
+
+    BOOST_AUTO_TEST_CASE( tick_time_rounds_seconds_to_ticks_test ) {
+        BOOST_CHECK_EQUAL(ms_time().ticks(), 0);
+        BOOST_CHECK_EQUAL(ms_time(5).ticks(), 5000);
+        BOOST_CHECK_EQUAL(ms_time(0.25).ticks(), 250);
+        BOOST_CHECK_EQUAL(ms_time(0.0004).ticks(), 0);
+        BOOST_CHECK_EQUAL(ms_time(0.0006).ticks(), 1);
+        BOOST_CHECK_EQUAL(ms_time(-1.5).ticks(), -1500);
+        BOOST_CHECK_EQUAL(us_time(0.25f).ticks(), 250000);
+        BOOST_CHECK_EQUAL(static_cast<double>(ms_time::from_ticks(1500)), 1.5);
+        BOOST_CHECK(ms_time(std::numeric_limits<double>::infinity()).is_infinity());
+    }
+
+    BOOST_AUTO_TEST_CASE( tick_time_sums_are_exact_test ) {
+        ms_time t;
+        float f = 0;
+        for (int i = 0; i < 10; i++) {
+            t += 0.1;
+            f += 0.1f;
+        }
+        BOOST_CHECK(t == ms_time(1));
+        BOOST_CHECK(f != 1.0f);
+        BOOST_CHECK(ms_time(0.1) + ms_time(0.2) == ms_time(0.3));
+        BOOST_CHECK(ms_time(3) - ms_time(1) == ms_time(2));
+        BOOST_CHECK(ms_time(1) < ms_time(1.001));
+        BOOST_CHECK(ms_time(2) >= ms_time(2));
+    }
+
+    BOOST_AUTO_TEST_CASE( tick_time_infinity_absorbs_durations_test ) {
+        const ms_time infinity = std::numeric_limits<ms_time>::infinity();
+        BOOST_CHECK(std::numeric_limits<ms_time>::has_infinity);
+        BOOST_CHECK(std::numeric_limits<ms_time>::is_exact);
+        BOOST_CHECK(infinity.is_infinity());
+        BOOST_CHECK(infinity + ms_time(10) == infinity);
+        BOOST_CHECK(ms_time(10) + infinity == infinity);
+        BOOST_CHECK(infinity - ms_time(10) == infinity);
+        BOOST_CHECK(std::numeric_limits<ms_time>::max() < infinity);
+        BOOST_CHECK(!(std::numeric_limits<ms_time>::max() + ms_time::from_ticks(0)).is_infinity());
+        BOOST_CHECK_EQUAL(std::numeric_limits<ms_time>::epsilon().ticks(), 1);
+        BOOST_CHECK_EQUAL(static_cast<double>(infinity), std::numeric_limits<double>::infinity());
+    }
+
+    BOOST_AUTO_TEST_CASE( tick_time_saturates_out_of_range_test ) {
+        const ms_time infinity = std::numeric_limits<ms_time>::infinity();
+        const ms_time lowest = std::numeric_limits<ms_time>::lowest();
+        const ms_time max = std::numeric_limits<ms_time>::max();
+
+        // seconds beyond the ticks
+        BOOST_CHECK(ms_time(std::numeric_limits<std::int64_t>::max()) == infinity);
+        BOOST_CHECK(ms_time(std::numeric_limits<std::uint64_t>::max()) == infinity);
+        BOOST_CHECK(ms_time(std::numeric_limits<std::int64_t>::min()) == lowest);
+        BOOST_CHECK(ms_time(-1e300) == lowest);
+        BOOST_CHECK(ms_time(-std::numeric_limits<double>::infinity()) == lowest);
+        BOOST_CHECK(ms_time(1e300) == infinity);
+        BOOST_CHECK_EQUAL(ms_time(std::int64_t(10000000000000000)).ticks(), ms_time::infinite_ticks);
+        BOOST_CHECK_EQUAL(ms_time(std::int64_t(9000000000000)).ticks(), 9000000000000000);
+        BOOST_CHECK_EQUAL(ms_time(std::int64_t(-9000000000000)).ticks(), -9000000000000000);
+
+        // sums and differences beyond the ticks
+        BOOST_CHECK(max + max == infinity);
+        BOOST_CHECK(max + ms_time::from_ticks(1) == infinity);
+        BOOST_CHECK(!(max + ms_time::from_ticks(0)).is_infinity());
+        BOOST_CHECK(lowest + lowest == lowest);
+        BOOST_CHECK(lowest - max == lowest);
+        BOOST_CHECK(max - lowest == infinity);
+        BOOST_CHECK_EQUAL((ms_time(-1) - lowest).ticks(), ms_time::infinite_ticks - 999);
+        BOOST_CHECK(ms_time(10) - infinity == lowest);
+        BOOST_CHECK(infinity - infinity == infinity);
+        BOOST_CHECK(ms_time(10) - ms_time(20) == ms_time(-10));
+    }
+
+    BOOST_AUTO_TEST_CASE( tick_time_is_written_as_seconds_test ) {
+        std::ostringstream oss;
+        oss << ms_time(5) << " " << ms_time(0.25) << " " << std::numeric_limits<ms_time>::infinity();
+        BOOST_CHECK_EQUAL(oss.str(), "5 0.25 inf");
+    }
+
+    using namespace count_fives;
+
+    namespace {
+        std::ostringstream oss;
+
+        struct oss_test_sink_provider{
+            static std::ostream& sink(){
+                return oss;
+            }
+        };
+    }
+
+    template<typename TIME>
+    using log_gt=cadmium::logger::logger<cadmium::logger::logger_global_time, cadmium::logger::formatter<TIME>, oss_test_sink_provider>;
+    template<typename TIME>
+    using dynamic_log_gt=cadmium::logger::logger<cadmium::logger::logger_global_time, cadmium::dynamic::logger::formatter<TIME>, oss_test_sink_provider>;
+
+    BOOST_AUTO_TEST_CASE( static_runner_runs_on_tick_time_as_on_float_test ) {
+        oss.str("");
+        cadmium::engine::runner<float, top_model, log_gt<float>> r_float{0.0};
+        float float_next = r_float.run_until(21.0);
+        std::string float_times = oss.str();
+
+        oss.str("");
+        cadmium::engine::runner<ms_time, top_model, log_gt<ms_time>> r_ticks{0};
+        ms_time ticks_next = r_ticks.run_until(21);
+        std::string ticks_times = oss.str();
+
+        BOOST_CHECK(!float_times.empty());
+        BOOST_CHECK_EQUAL(float_times, ticks_times);
+        BOOST_CHECK_EQUAL(static_cast<double>(ticks_next), float_next);
+    }
+
+    template<typename FEL>
+    std::string dynamic_global_times(ms_time& next) {
+        oss.str("");
+        cadmium::dynamic::engine::runner<ms_time, dynamic_log_gt<ms_time>, FEL> r(cadmium::dynamic::translate::make_dynamic_coupled_model<ms_time, top_model>(), 0);
+        next = r.run_until(31);
+        return oss.str();
+    }
+
+    BOOST_AUTO_TEST_CASE( dynamic_runner_fels_run_on_tick_time_test ) {
+        oss.str("");
+        cadmium::dynamic::engine::runner<float, dynamic_log_gt<float>> r_float(cadmium::dynamic::translate::make_dynamic_coupled_model<float, top_model>(), 0.0);
+        float float_next = r_float.run_until(31.0);
+        std::string float_times = oss.str();
+        BOOST_CHECK(!float_times.empty());
+
+        ms_time next;
+        BOOST_CHECK_EQUAL(dynamic_global_times<cadmium::dynamic::engine::no_fel<ms_time>>(next), float_times);
+        BOOST_CHECK_EQUAL(static_cast<double>(next), float_next);
+        BOOST_CHECK_EQUAL(dynamic_global_times<cadmium::dynamic::engine::heap_fel<ms_time>>(next), float_times);
+        BOOST_CHECK_EQUAL(static_cast<double>(next), float_next);
+        BOOST_CHECK_EQUAL(dynamic_global_times<cadmium::dynamic::engine::calendar_fel<ms_time>>(next), float_times);
+        BOOST_CHECK_EQUAL(static_cast<double>(next), float_next);
+        BOOST_CHECK_EQUAL(dynamic_global_times<cadmium::dynamic::engine::ladder_fel<ms_time>>(next), float_times);
+        BOOST_CHECK_EQUAL(static_cast<double>(next), float_next);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
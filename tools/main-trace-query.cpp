@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//Queries a binary trace written by the binary_logger through its sidecar index
+
+#include <limits>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <cadmium/logger/binary_trace_index.hpp>
+#include <cadmium/logger/dynamic_common_loggers.hpp>
+
+/**
+ * Usage:
+ *   trace-query TRACE states MODEL [FROM TO]
+ *   trace-query TRACE events MODEL [FROM TO]
+ *   trace-query TRACE port PORT
+ *
+ * The index is built the first time in TRACE.idx and reused while the trace does not grow.
+ * The traces of float and double times are supported, they are printed with the dynamic formatter.
+ */
+
+int usage() {
+    std::cerr << "Usage: trace-query TRACE states|events MODEL [FROM TO]" << std::endl;
+    std::cerr << "       trace-query TRACE port PORT" << std::endl;
+    return 1;
+}
+
+template<typename TIME>
+int query(const std::string& path, const std::vector<std::string>& args) {
+    std::ifstream trace(path, std::ios::binary);
+    cadmium::logger::binary_trace_reader<TIME, cadmium::dynamic::logger::formatter<TIME>> reader(
+            trace, cadmium::logger::binary_trace_index<TIME>::load_or_build(path));
+
+    TIME from = std::numeric_limits<TIME>::lowest();
+    TIME to = std::numeric_limits<TIME>::max();
+    if (args.size() == 4) {
+        from = static_cast<TIME>(std::stod(args[2]));
+        to = static_cast<TIME>(std::stod(args[3]));
+    } else if (args.size() != 2) {
+        return usage();
+    }
+
+    std::vector<std::string> lines;
+    if (args[0] == "states") {
+        lines = reader.model_states(args[1], from, to);
+    } else if (args[0] == "events") {
+        lines = reader.model_events(args[1], from, to);
+    } else if (args[0] == "port" && args.size() == 2) {
+        lines = reader.port_messages(args[1]);
+    } else {
+        return usage();
+    }
+    for (const auto& l : lines) {
+        std::cout << l << '\n';
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        return usage();
+    }
+    std::string path = argv[1];
+    std::vector<std::string> args(argv + 2, argv + argc);
+    try {
+        std::ifstream trace(path, std::ios::binary);
+        switch (cadmium::logger::binary_trace::read_time_size(trace)) {
+            case sizeof(float):
+                return query<float>(path, args);
+            case sizeof(double):
+                return query<double>(path, args);
+            default:
+                std::cerr << "Unsupported time type in " << path << std::endl;
+                return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}